@@ -0,0 +1,566 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// A compressed file format made of independently deflated chunks, so that large files can be
+// decompressed on several threads at once and read in order while later chunks are still being
+// decompressed.  Only zlib and the standard library are used.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../3rdParty/zlib-win64/zlib.h"
+
+namespace Utility
+{
+	// Worker threads that run short tasks in the order they were submitted.  A thread waiting
+	// on tasks it submitted should help with TryRunOne() rather than block, so that waiting
+	// from a worker thread (or on a pool with no workers) cannot deadlock.
+	class TaskPool
+	{
+	public:
+
+		explicit TaskPool( size_t WorkerCount ) : m_Exit(false)
+		{
+			for (size_t i = 0; i < WorkerCount; ++i)
+				m_Workers.emplace_back([this] { WorkerMain(); });
+		}
+
+		~TaskPool()
+		{
+			{
+				std::lock_guard<std::mutex> Lock(m_Mutex);
+				m_Exit = true;
+			}
+			m_Wake.notify_all();
+
+			for (auto& Worker : m_Workers)
+				Worker.join();
+		}
+
+		// Shared by all file reads.  Leaves one hardware thread for the caller.
+		static TaskPool& Default( void )
+		{
+			static TaskPool s_Pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+			return s_Pool;
+		}
+
+		size_t GetWorkerCount( void ) const { return m_Workers.size(); }
+
+		void Submit( std::function<void()> Task )
+		{
+			{
+				std::lock_guard<std::mutex> Lock(m_Mutex);
+				m_Queue.push_back(std::move(Task));
+			}
+			m_Wake.notify_one();
+		}
+
+		// Runs the oldest queued task on the calling thread.  Returns false if there was none.
+		bool TryRunOne( void )
+		{
+			std::function<void()> Task;
+			{
+				std::lock_guard<std::mutex> Lock(m_Mutex);
+				if (m_Queue.empty())
+					return false;
+				Task = std::move(m_Queue.front());
+				m_Queue.pop_front();
+			}
+			Task();
+			return true;
+		}
+
+	private:
+
+		void WorkerMain( void )
+		{
+			for (;;)
+			{
+				std::function<void()> Task;
+				{
+					std::unique_lock<std::mutex> Lock(m_Mutex);
+					m_Wake.wait(Lock, [this] { return m_Exit || !m_Queue.empty(); });
+					if (m_Queue.empty())
+						return;
+					Task = std::move(m_Queue.front());
+					m_Queue.pop_front();
+				}
+				Task();
+			}
+		}
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Wake;
+		std::deque< std::function<void()> > m_Queue;
+		std::vector<std::thread> m_Workers;
+		bool m_Exit;
+	};
+
+	// Calls Body(Index) for every index below Count, on the pool's workers and the calling
+	// thread, and returns when all calls have finished.
+	template <typename BodyFn>
+	inline void ParallelFor( TaskPool& Pool, size_t Count, BodyFn Body )
+	{
+		struct SharedState
+		{
+			std::atomic<size_t> NextIndex;
+			size_t HelpersRunning;
+			std::mutex Mutex;
+			std::condition_variable Done;
+		};
+
+		auto State = std::make_shared<SharedState>();
+		State->NextIndex = 0;
+
+		auto RunBody = [State, Count, &Body]
+		{
+			for (size_t Index = State->NextIndex++; Index < Count; Index = State->NextIndex++)
+				Body(Index);
+		};
+
+		const size_t HelperCount = Count > 1 ? std::min(Pool.GetWorkerCount(), Count - 1) : 0;
+		State->HelpersRunning = HelperCount;
+
+		for (size_t i = 0; i < HelperCount; ++i)
+		{
+			Pool.Submit([State, RunBody]
+			{
+				RunBody();
+				std::lock_guard<std::mutex> Lock(State->Mutex);
+				if (--State->HelpersRunning == 0)
+					State->Done.notify_all();
+			});
+		}
+
+		RunBody();
+
+		// Helpers still in the queue have nothing left to do, but they capture Body by reference
+		// so they must finish before returning.
+		for (;;)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(State->Mutex);
+				if (State->HelpersRunning == 0)
+					return;
+			}
+
+			if (!Pool.TryRunOne())
+			{
+				std::unique_lock<std::mutex> Lock(State->Mutex);
+				State->Done.wait(Lock, [&] { return State->HelpersRunning == 0; });
+				return;
+			}
+		}
+	}
+
+	// The chunked file layout is a Header, then one ChunkInfo per chunk, then the chunk data.
+	// Every chunk but the last holds ChunkSize bytes once decompressed.  A chunk is a zlib stream,
+	// or the bytes themselves when deflating it would not make it smaller.
+	namespace ChunkedFile
+	{
+		const uint32_t kMagic = 0x4B434D45;	// "EMCK"
+		const uint32_t kVersion = 1;
+		const uint32_t kDefaultChunkSize = 256 * 1024;
+		const uint32_t kMinChunkSize = 4 * 1024;
+		const uint32_t kMaxChunkSize = 64 * 1024 * 1024;
+
+		// Deflate cannot expand data by more than about 1032:1, so a file claiming more is corrupt.
+		const uint64_t kMaxCompressionRatio = 1032;
+
+		inline uint64_t ChunksFor( uint64_t Size, uint32_t ChunkSize )
+		{
+			return Size / ChunkSize + (Size % ChunkSize != 0);
+		}
+
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t ChunkSize;
+			uint32_t ChunkCount;
+			uint64_t UncompressedSize;
+		};
+
+		struct ChunkInfo
+		{
+			uint64_t Offset;
+			uint32_t CompressedSize;
+			uint32_t UncompressedSize;
+		};
+
+		// Copies Size bytes at Offset into Dest.  Called from several threads at once.
+		typedef std::function<bool (uint64_t Offset, void* Dest, size_t Size)> ReadFn;
+
+		inline ReadFn MemoryReader( const void* Data, uint64_t DataSize )
+		{
+			return [=]( uint64_t Offset, void* Dest, size_t Size ) -> bool
+			{
+				if (Offset > DataSize || Size > DataSize - Offset)
+					return false;
+				memcpy(Dest, (const uint8_t*)Data + Offset, Size);
+				return true;
+			};
+		}
+
+		inline bool IsChunkedFile( const void* Data, size_t Size )
+		{
+			uint32_t Magic;
+			if (Size < sizeof(Header))
+				return false;
+			memcpy(&Magic, Data, sizeof(Magic));
+			return Magic == kMagic;
+		}
+
+		// Reads and validates the header and chunk index.  Returns false if the file is not in
+		// the chunked format or any chunk lies outside it.
+		inline bool ReadIndex( const ReadFn& Read, uint64_t FileSize, Header& FileHeader, std::vector<ChunkInfo>& Chunks )
+		{
+			Chunks.clear();
+
+			if (FileSize < sizeof(Header) || !Read(0, &FileHeader, sizeof(Header)))
+				return false;
+
+			if (FileHeader.Magic != kMagic || FileHeader.Version != kVersion ||
+				FileHeader.ChunkSize < kMinChunkSize || FileHeader.ChunkSize > kMaxChunkSize)
+				return false;
+
+			if (FileHeader.UncompressedSize > (uint64_t)FileHeader.ChunkCount * FileHeader.ChunkSize ||
+				FileHeader.UncompressedSize / kMaxCompressionRatio > FileSize ||
+				FileHeader.ChunkCount != ChunksFor(FileHeader.UncompressedSize, FileHeader.ChunkSize))
+				return false;
+
+			const uint64_t DataStart = sizeof(Header) + (uint64_t)FileHeader.ChunkCount * sizeof(ChunkInfo);
+			if (DataStart > FileSize)
+				return false;
+
+			Chunks.resize(FileHeader.ChunkCount);
+			if (FileHeader.ChunkCount > 0 && !Read(sizeof(Header), Chunks.data(), Chunks.size() * sizeof(ChunkInfo)))
+				return false;
+
+			uint64_t Remaining = FileHeader.UncompressedSize;
+			for (auto& Chunk : Chunks)
+			{
+				const uint64_t ExpectedSize = std::min<uint64_t>(Remaining, FileHeader.ChunkSize);
+				Remaining -= ExpectedSize;
+
+				if (Chunk.UncompressedSize != ExpectedSize || Chunk.CompressedSize == 0 ||
+					Chunk.CompressedSize > Chunk.UncompressedSize || Chunk.Offset < DataStart ||
+					Chunk.Offset > FileSize || Chunk.CompressedSize > FileSize - Chunk.Offset)
+				{
+					Chunks.clear();
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		inline bool InflateChunk( const uint8_t* Source, size_t SourceSize, uint8_t* Dest, size_t DestSize )
+		{
+			if (SourceSize == DestSize)
+			{
+				memcpy(Dest, Source, DestSize);
+				return true;
+			}
+
+			uLongf InflatedSize = (uLongf)DestSize;
+			return uncompress(Dest, &InflatedSize, Source, (uLong)SourceSize) == Z_OK && InflatedSize == DestSize;
+		}
+
+		// Decompresses a whole chunked file into Dest, which must hold FileHeader.UncompressedSize bytes.
+		inline bool Decompress( const ReadFn& Read, const Header& FileHeader, const std::vector<ChunkInfo>& Chunks,
+			uint8_t* Dest, TaskPool& Pool = TaskPool::Default() )
+		{
+			std::atomic<bool> Succeeded(true);
+
+			ParallelFor(Pool, Chunks.size(), [&]( size_t i )
+			{
+				const ChunkInfo& Chunk = Chunks[i];
+				uint8_t* ChunkDest = Dest + i * (size_t)FileHeader.ChunkSize;
+
+				if (Chunk.CompressedSize == Chunk.UncompressedSize)
+				{
+					if (!Read(Chunk.Offset, ChunkDest, Chunk.UncompressedSize))
+						Succeeded = false;
+					return;
+				}
+
+				std::vector<uint8_t> Compressed(Chunk.CompressedSize);
+				if (!Read(Chunk.Offset, Compressed.data(), Compressed.size()) ||
+					!InflateChunk(Compressed.data(), Compressed.size(), ChunkDest, Chunk.UncompressedSize))
+					Succeeded = false;
+			});
+
+			return Succeeded;
+		}
+
+		// Writes Data in the chunked format, deflating the chunks in parallel.
+		inline bool Compress( const void* Data, size_t Size, std::vector<uint8_t>& Out,
+			uint32_t ChunkSize = kDefaultChunkSize, int Level = Z_BEST_COMPRESSION, TaskPool& Pool = TaskPool::Default() )
+		{
+			if (ChunkSize < kMinChunkSize || ChunkSize > kMaxChunkSize)
+				return false;
+
+			const size_t ChunkCount = (size_t)ChunksFor(Size, ChunkSize);
+			if (ChunkCount > UINT32_MAX)
+				return false;
+
+			std::vector< std::vector<uint8_t> > Deflated(ChunkCount);
+			std::atomic<bool> Succeeded(true);
+
+			ParallelFor(Pool, ChunkCount, [&]( size_t i )
+			{
+				const uint8_t* Source = (const uint8_t*)Data + i * ChunkSize;
+				const size_t SourceSize = std::min<size_t>(ChunkSize, Size - i * ChunkSize);
+
+				std::vector<uint8_t>& Chunk = Deflated[i];
+				uLongf DeflatedSize = compressBound((uLong)SourceSize);
+				Chunk.resize(DeflatedSize);
+
+				if (compress2(Chunk.data(), &DeflatedSize, Source, (uLong)SourceSize, Level) != Z_OK)
+					Succeeded = false;
+				else if (DeflatedSize < SourceSize)
+					Chunk.resize(DeflatedSize);
+				else
+					Chunk.assign(Source, Source + SourceSize);
+			});
+
+			if (!Succeeded)
+				return false;
+
+			Header FileHeader = { kMagic, kVersion, ChunkSize, (uint32_t)ChunkCount, (uint64_t)Size };
+			std::vector<ChunkInfo> Chunks(ChunkCount);
+
+			uint64_t Offset = sizeof(Header) + ChunkCount * sizeof(ChunkInfo);
+			for (size_t i = 0; i < ChunkCount; ++i)
+			{
+				Chunks[i].Offset = Offset;
+				Chunks[i].CompressedSize = (uint32_t)Deflated[i].size();
+				Chunks[i].UncompressedSize = (uint32_t)std::min<size_t>(ChunkSize, Size - i * ChunkSize);
+				Offset += Deflated[i].size();
+			}
+
+			Out.clear();
+			Out.reserve((size_t)Offset);
+			Out.insert(Out.end(), (const uint8_t*)&FileHeader, (const uint8_t*)(&FileHeader + 1));
+			Out.insert(Out.end(), (const uint8_t*)Chunks.data(), (const uint8_t*)(Chunks.data() + ChunkCount));
+			for (auto& Chunk : Deflated)
+				Out.insert(Out.end(), Chunk.begin(), Chunk.end());
+
+			return true;
+		}
+
+		// Hands out the contents of a file in order, one chunk at a time.  A few chunks ahead of
+		// the reader are read and decompressed on the task pool, so only those are held in memory.
+		// Plain files can be read the same way with OpenStored().
+		class Stream
+		{
+		public:
+
+			explicit Stream( TaskPool& Pool = TaskPool::Default(), uint32_t MaxChunksInFlight = 8 ) :
+				m_Pool(Pool), m_Slots(std::max(2u, MaxChunksInFlight)), m_FileSize(0), m_UncompressedSize(0),
+				m_NextToSubmit(0), m_NextToRead(0), m_HoldingChunk(false), m_Pending(0), m_Failed(false)
+			{
+			}
+
+			~Stream() { Close(); }
+
+			Stream( const Stream& ) = delete;
+			Stream& operator=( const Stream& ) = delete;
+
+			// Returns false if the file is not in the chunked format.
+			bool OpenChunked( ReadFn Read, uint64_t FileSize )
+			{
+				Close();
+
+				Header FileHeader;
+				if (!ReadIndex(Read, FileSize, FileHeader, m_Chunks))
+					return false;
+
+				return Start(std::move(Read), FileSize, FileHeader.UncompressedSize);
+			}
+
+			bool OpenStored( ReadFn Read, uint64_t FileSize, uint32_t ChunkSize = kDefaultChunkSize )
+			{
+				Close();
+
+				if (ChunkSize == 0)
+					return false;
+
+				m_Chunks.resize((size_t)ChunksFor(FileSize, ChunkSize));
+				for (size_t i = 0; i < m_Chunks.size(); ++i)
+				{
+					m_Chunks[i].Offset = i * (uint64_t)ChunkSize;
+					m_Chunks[i].UncompressedSize = (uint32_t)std::min<uint64_t>(ChunkSize, FileSize - m_Chunks[i].Offset);
+					m_Chunks[i].CompressedSize = m_Chunks[i].UncompressedSize;
+				}
+
+				return Start(std::move(Read), FileSize, FileSize);
+			}
+
+			// Waits for the next chunk, which stays valid until the next call.  Returns false at
+			// the end of the file, or if a chunk could not be read (see HasFailed).
+			bool Next( const uint8_t*& Data, size_t& Size )
+			{
+				if (m_HoldingChunk)
+				{
+					// The reader is done with the previous chunk, so its slot can decompress a later one.
+					m_HoldingChunk = false;
+					if (m_NextToSubmit < m_Chunks.size())
+						Submit((m_NextToRead - 1) % m_Slots.size(), m_NextToSubmit++);
+				}
+
+				if (m_Failed || m_NextToRead >= m_Chunks.size())
+					return false;
+
+				Slot& Current = m_Slots[m_NextToRead % m_Slots.size()];
+				WaitFor([&] { return Current.State != kPending; });
+
+				if (Current.State == kFailed)
+				{
+					m_Failed = true;
+					return false;
+				}
+
+				Data = Current.Data.data();
+				Size = Current.Data.size();
+				++m_NextToRead;
+				m_HoldingChunk = true;
+				return true;
+			}
+
+			// Waits for chunks being decompressed and releases the file.
+			void Close( void )
+			{
+				WaitFor([&] { return m_Pending == 0; });
+
+				m_Read = nullptr;
+				m_Chunks.clear();
+				for (auto& S : m_Slots)
+					S.State = kIdle;
+				m_FileSize = m_UncompressedSize = 0;
+				m_NextToSubmit = m_NextToRead = 0;
+				m_HoldingChunk = false;
+				m_Failed = false;
+			}
+
+			uint64_t GetSize( void ) const { return m_UncompressedSize; }
+			bool HasFailed( void ) const { return m_Failed; }
+
+		private:
+
+			enum SlotState { kIdle, kPending, kReady, kFailed };
+
+			struct Slot
+			{
+				Slot() : Chunk(0), State(kIdle) {}
+				std::vector<uint8_t> Data;
+				std::vector<uint8_t> Compressed;
+				size_t Chunk;
+				SlotState State;
+			};
+
+			bool Start( ReadFn Read, uint64_t FileSize, uint64_t UncompressedSize )
+			{
+				m_Read = std::move(Read);
+				m_FileSize = FileSize;
+				m_UncompressedSize = UncompressedSize;
+
+				while (m_NextToSubmit < m_Chunks.size() && m_NextToSubmit < m_Slots.size())
+				{
+					Submit(m_NextToSubmit, m_NextToSubmit);
+					++m_NextToSubmit;
+				}
+
+				return true;
+			}
+
+			void Submit( size_t SlotIndex, size_t Chunk )
+			{
+				{
+					std::lock_guard<std::mutex> Lock(m_Mutex);
+					m_Slots[SlotIndex].Chunk = Chunk;
+					m_Slots[SlotIndex].State = kPending;
+					++m_Pending;
+				}
+
+				m_Pool.Submit([this, SlotIndex] { Decode(m_Slots[SlotIndex]); });
+			}
+
+			void Decode( Slot& S )
+			{
+				const ChunkInfo& Chunk = m_Chunks[S.Chunk];
+				S.Data.resize(Chunk.UncompressedSize);
+
+				bool Succeeded;
+				if (Chunk.CompressedSize == Chunk.UncompressedSize)
+					Succeeded = m_Read(Chunk.Offset, S.Data.data(), S.Data.size());
+				else
+				{
+					S.Compressed.resize(Chunk.CompressedSize);
+					Succeeded = m_Read(Chunk.Offset, S.Compressed.data(), S.Compressed.size()) &&
+						InflateChunk(S.Compressed.data(), S.Compressed.size(), S.Data.data(), S.Data.size());
+				}
+
+				std::lock_guard<std::mutex> Lock(m_Mutex);
+				S.State = Succeeded ? kReady : kFailed;
+				--m_Pending;
+				m_Ready.notify_all();
+			}
+
+			// Helps the pool until the condition holds, so waiting from a pool thread cannot deadlock.
+			template <typename ConditionFn>
+			void WaitFor( ConditionFn Condition )
+			{
+				for (;;)
+				{
+					{
+						std::lock_guard<std::mutex> Lock(m_Mutex);
+						if (Condition())
+							return;
+					}
+
+					if (!m_Pool.TryRunOne())
+					{
+						std::unique_lock<std::mutex> Lock(m_Mutex);
+						m_Ready.wait(Lock, Condition);
+						return;
+					}
+				}
+			}
+
+			TaskPool& m_Pool;
+			ReadFn m_Read;
+			std::vector<ChunkInfo> m_Chunks;
+			std::vector<Slot> m_Slots;
+			uint64_t m_FileSize;
+			uint64_t m_UncompressedSize;
+			size_t m_NextToSubmit;
+			size_t m_NextToRead;
+			bool m_HoldingChunk;
+
+			std::mutex m_Mutex;
+			std::condition_variable m_Ready;
+			size_t m_Pending;
+			bool m_Failed;
+		};
+
+	} // namespace ChunkedFile
+
+} // namespace Utility
@@ -108,12 +108,36 @@ ByteArray Inflate(ByteArray CompressedSource, int& err, uint32_t ChunkSize = 0x1
 	return byteArray;
 }
 
+ByteArray DecompressChunkedFile( ByteArray CompressedFile )
+{
+	ChunkedFile::ReadFn Read = ChunkedFile::MemoryReader(CompressedFile->data(), CompressedFile->size());
+
+	ChunkedFile::Header FileHeader;
+	vector<ChunkedFile::ChunkInfo> Chunks;
+	if (!ChunkedFile::ReadIndex(Read, CompressedFile->size(), FileHeader, Chunks) || FileHeader.UncompressedSize > SIZE_MAX)
+		return NullFile;
+
+	Utility::ByteArray byteArray = make_shared<vector<byte> >( (size_t)FileHeader.UncompressedSize );
+	if (!ChunkedFile::Decompress(Read, FileHeader, Chunks, byteArray->data()))
+		return NullFile;
+
+	return byteArray;
+}
+
 ByteArray DecompressZippedFile( wstring& fileName )
 {
 	ByteArray CompressedFile = ReadFileHelper(fileName);
 	if (CompressedFile == NullFile)
 		return NullFile;
 
+	if (ChunkedFile::IsChunkedFile(CompressedFile->data(), CompressedFile->size()))
+	{
+		ByteArray DecompressedFile = DecompressChunkedFile(CompressedFile);
+		if (DecompressedFile == NullFile)
+			Utility::Printf(L"Couldn't decompress chunked file %s\n", fileName.c_str());
+		return DecompressedFile;
+	}
+
 	int error;
 	ByteArray DecompressedFile = Inflate(CompressedFile, error);
 	if (DecompressedFile->size() == 0)
@@ -135,3 +159,52 @@ task<ByteArray> Utility::ReadFileAsync(const wstring& fileName)
 	shared_ptr<wstring> SharedPtr = make_shared<wstring>(fileName);
 	return create_task( [=] { return ReadFileHelperEx(SharedPtr); } );
 }
+
+// Reads from the file on whichever worker thread needs the next chunk
+ChunkedFile::ReadFn OpenFileReader( const wstring& fileName, uint64_t& fileSize )
+{
+	shared_ptr<ifstream> file = make_shared<ifstream>( fileName, ios::in | ios::binary );
+	if (!*file)
+		return nullptr;
+
+	fileSize = file->seekg(0, ios::end).tellg();
+
+	shared_ptr<mutex> fileMutex = make_shared<mutex>();
+	return [file, fileMutex]( uint64_t Offset, void* Dest, size_t Size ) -> bool
+	{
+		lock_guard<mutex> CS(*fileMutex);
+		file->clear();
+		return !file->seekg(Offset, ios::beg).read( (char*)Dest, Size ).fail();
+	};
+}
+
+FileStream Utility::OpenFileStream( const wstring& fileName )
+{
+	FileStream Stream = make_shared<ChunkedFile::Stream>();
+	uint64_t fileSize = 0;
+
+	wstring zippedName = fileName + L".gz";
+	ChunkedFile::ReadFn Read = OpenFileReader(zippedName, fileSize);
+	if (Read != nullptr)
+	{
+		if (Stream->OpenChunked(Read, fileSize))
+			return Stream;
+
+		// Older .gz files are a single deflate stream, so they have to be inflated up front.
+		ByteArray DecompressedFile = DecompressZippedFile(zippedName);
+		if (DecompressedFile == NullFile)
+			return nullptr;
+
+		ChunkedFile::ReadFn ReadMemory = ChunkedFile::MemoryReader(DecompressedFile->data(), DecompressedFile->size());
+		Stream->OpenStored( [DecompressedFile, ReadMemory]( uint64_t Offset, void* Dest, size_t Size )
+			{ return ReadMemory(Offset, Dest, Size); }, DecompressedFile->size() );
+		return Stream;
+	}
+
+	Read = OpenFileReader(fileName, fileSize);
+	if (Read == nullptr)
+		return nullptr;
+
+	Stream->OpenStored(Read, fileSize);
+	return Stream;
+}
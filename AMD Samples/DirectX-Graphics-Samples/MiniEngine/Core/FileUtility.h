@@ -14,6 +14,7 @@
 #pragma once
 
 #include "pch.h"
+#include "ChunkedFile.h"
 #include <vector>
 #include <string>
 #include <ppl.h>
@@ -26,12 +27,20 @@ namespace Utility
 	typedef shared_ptr<vector<byte> > ByteArray;
 	extern ByteArray NullFile;
 
+	typedef shared_ptr<ChunkedFile::Stream> FileStream;
+
 	// Reads the entire contents of a binary file.  If the file with the same name except with an additional
-	// ".gz" suffix exists, it will be loaded and decompressed instead.
+	// ".gz" suffix exists, it will be loaded and decompressed instead.  A ".gz" file may also be in the
+	// chunked format described in ChunkedFile.h, in which case its chunks are decompressed in parallel.
 	// This operation blocks until the entire file is read.
 	ByteArray ReadFileSync(const wstring& fileName);
 
 	// Same as previous except that it does not block but instead returns a task.
 	task<ByteArray> ReadFileAsync(const wstring& fileName);
 
+	// Opens a file to be read in order one chunk at a time, with the same ".gz" lookup as ReadFileSync.
+	// Chunked files are read and decompressed a few chunks ahead of the caller on worker threads, so
+	// large files never need to be held in memory all at once.  Returns nullptr if the file can't be read.
+	FileStream OpenFileStream(const wstring& fileName);
+
 } // namespace Utility
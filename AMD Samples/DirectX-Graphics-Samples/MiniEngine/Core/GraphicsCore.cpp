@@ -309,6 +309,7 @@ void Graphics::Initialize(void)
 		g_Device = pDevice.Detach();
 	}
 	
+	PSO::LoadCache(L"PipelineCache.bin", pAdapter.Get());
 
 #if _DEBUG
 	ID3D12InfoQueue* pInfoQueue = nullptr;
@@ -563,6 +564,7 @@ void Graphics::Shutdown(void)
 	g_CommandManager.Shutdown();
 	GpuTimeManager::Shutdown();
 	s_PrimarySwapChain->Release();
+	PSO::SaveCache();
 	PSO::DestroyAll();
 	RootSignature::DestroyAll();
 
@@ -14,23 +14,108 @@
 #include "GraphicsCore.h"
 #include "PipelineState.h"
 #include "RootSignature.h"
-#include "Hash.h"
-#include <map>
-#include <thread>
-#include <mutex>
+#include "PipelineStateCache.h"
+#include "FileUtility.h"
+#include <dxgi1_4.h>
+#include <fstream>
 
 using Math::IsAligned;
 using namespace Graphics;
 using Microsoft::WRL::ComPtr;
 using namespace std;
 
-static map< size_t, ComPtr<ID3D12PipelineState> > s_GraphicsPSOHashMap;
-static map< size_t, ComPtr<ID3D12PipelineState> > s_ComputePSOHashMap;
+static Utility::ShardedCache< ComPtr<ID3D12PipelineState> > s_GraphicsPSOCache;
+static Utility::ShardedCache< ComPtr<ID3D12PipelineState> > s_ComputePSOCache;
+static Utility::PipelineBlobCache s_PipelineBlobCache;
+static wstring s_PipelineCacheFile;
 
 void PSO::DestroyAll(void)
 {
-	s_GraphicsPSOHashMap.clear();
-	s_ComputePSOHashMap.clear();
+	s_GraphicsPSOCache.Clear();
+	s_ComputePSOCache.Clear();
+}
+
+void PSO::LoadCache( const wstring& FileName, IDXGIAdapter* Adapter )
+{
+	// Blobs only work with the adapter and driver that compiled them
+	struct
+	{
+		UINT VendorId;
+		UINT DeviceId;
+		UINT SubSysId;
+		UINT Revision;
+		LARGE_INTEGER DriverVersion;
+	} DeviceId = {};
+
+	DXGI_ADAPTER_DESC AdapterDesc;
+	if (SUCCEEDED(Adapter->GetDesc(&AdapterDesc)))
+	{
+		DeviceId.VendorId = AdapterDesc.VendorId;
+		DeviceId.DeviceId = AdapterDesc.DeviceId;
+		DeviceId.SubSysId = AdapterDesc.SubSysId;
+		DeviceId.Revision = AdapterDesc.Revision;
+	}
+	Adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &DeviceId.DriverVersion);
+
+	s_PipelineCacheFile = FileName;
+
+	const uint64_t DeviceKey = Utility::HashBytes64(&DeviceId, sizeof(DeviceId));
+	Utility::ByteArray CacheFile = Utility::ReadFileSync(FileName);
+
+	if (s_PipelineBlobCache.Load(CacheFile->data(), CacheFile->size(), DeviceKey))
+		Utility::Printf(L"Loaded %u cached pipelines from %s\n", (uint32_t)s_PipelineBlobCache.GetEntryCount(), FileName.c_str());
+}
+
+void PSO::SaveCache( void )
+{
+	if (s_PipelineCacheFile.empty() || !s_PipelineBlobCache.IsDirty())
+		return;
+
+	vector<uint8_t> CacheFile;
+	s_PipelineBlobCache.Save(CacheFile);
+
+	ofstream file( s_PipelineCacheFile, ios::out | ios::binary | ios::trunc );
+	if (file)
+		file.write( (const char*)CacheFile.data(), CacheFile.size() );
+}
+
+// Creates a pipeline from the saved blob with the same key if there is one, falling back to
+// compiling it if the blob is rejected, and saves the blob of pipelines that were compiled.
+// Returns null if the pipeline can't be created, which ASSERT_SUCCEEDED doesn't catch in release builds.
+template <typename DESC, typename CreateFn>
+static ComPtr<ID3D12PipelineState> CreatePipelineState( DESC Desc, uint64_t HashCode, CreateFn Create )
+{
+	ComPtr<ID3D12PipelineState> PipelineState;
+
+	const void* CachedBlob = nullptr;
+	size_t CachedBlobSize = 0;
+	if (s_PipelineBlobCache.Find(HashCode, CachedBlob, CachedBlobSize))
+	{
+		Desc.CachedPSO.pCachedBlob = CachedBlob;
+		Desc.CachedPSO.CachedBlobSizeInBytes = CachedBlobSize;
+		if (SUCCEEDED(Create(Desc, PipelineState.ReleaseAndGetAddressOf())))
+			return PipelineState;
+
+		Desc.CachedPSO.pCachedBlob = nullptr;
+		Desc.CachedPSO.CachedBlobSizeInBytes = 0;
+	}
+
+	HRESULT hr = Create(Desc, PipelineState.ReleaseAndGetAddressOf());
+	ASSERT_SUCCEEDED( hr, "Failed to create pipeline state" );
+	if (FAILED(hr))
+		return nullptr;
+
+	ComPtr<ID3DBlob> CompiledBlob;
+	if (SUCCEEDED(PipelineState->GetCachedBlob(CompiledBlob.GetAddressOf())))
+		s_PipelineBlobCache.Store(HashCode, CompiledBlob->GetBufferPointer(), CompiledBlob->GetBufferSize());
+
+	return PipelineState;
+}
+
+static uint64_t HashShader( const D3D12_SHADER_BYTECODE& Shader, uint64_t Hash )
+{
+	Hash = Utility::HashBytes64(&Shader.BytecodeLength, sizeof(Shader.BytecodeLength), Hash);
+	return Utility::HashBytes64(Shader.pShaderBytecode, Shader.BytecodeLength, Hash);
 }
 
 
@@ -112,39 +197,48 @@ void GraphicsPSO::Finalize()
 	m_PSODesc.pRootSignature = m_RootSignature->GetSignature();
 	ASSERT(m_PSODesc.pRootSignature != nullptr);
 
-	m_PSODesc.InputLayout.pInputElementDescs = nullptr;
-	size_t HashCode = Utility::HashState(&m_PSODesc);
-	HashCode = Utility::HashStateArray(m_InputLayouts.get(), m_PSODesc.InputLayout.NumElements, HashCode);
-	m_PSODesc.InputLayout.pInputElementDescs = m_InputLayouts.get();
+	// Hash the contents of everything the description points to rather than the pointers, so
+	// that the key of a pipeline stays the same from run to run.  Stream output is not used.
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC HashDesc;
+	memcpy(&HashDesc, &m_PSODesc, sizeof(HashDesc));
+	HashDesc.pRootSignature = nullptr;
+	HashDesc.VS.pShaderBytecode = nullptr;
+	HashDesc.PS.pShaderBytecode = nullptr;
+	HashDesc.DS.pShaderBytecode = nullptr;
+	HashDesc.HS.pShaderBytecode = nullptr;
+	HashDesc.GS.pShaderBytecode = nullptr;
+	HashDesc.StreamOutput.pSODeclaration = nullptr;
+	HashDesc.StreamOutput.pBufferStrides = nullptr;
+	HashDesc.InputLayout.pInputElementDescs = nullptr;
+	HashDesc.CachedPSO.pCachedBlob = nullptr;
+	HashDesc.CachedPSO.CachedBlobSizeInBytes = 0;
 
-	ID3D12PipelineState** PSORef = nullptr;
-	bool firstCompile = false;
-	{
-		static mutex s_HashMapMutex;
-		lock_guard<mutex> CS(s_HashMapMutex);
-		auto iter = s_GraphicsPSOHashMap.find(HashCode);
-
-		// Reserve space so the next inquiry will find that someone got here first.
-		if (iter == s_GraphicsPSOHashMap.end())
-		{
-			firstCompile = true;
-			PSORef = s_GraphicsPSOHashMap[HashCode].GetAddressOf();
-		}
-		else
-			PSORef = iter->second.GetAddressOf();
-	}
+	uint64_t HashCode = Utility::HashBytes64(&HashDesc, sizeof(HashDesc), m_RootSignature->GetContentHash());
+	HashCode = HashShader(m_PSODesc.VS, HashCode);
+	HashCode = HashShader(m_PSODesc.PS, HashCode);
+	HashCode = HashShader(m_PSODesc.DS, HashCode);
+	HashCode = HashShader(m_PSODesc.HS, HashCode);
+	HashCode = HashShader(m_PSODesc.GS, HashCode);
 
-	if (firstCompile)
+	for (UINT i = 0; i < m_PSODesc.InputLayout.NumElements; ++i)
 	{
-		ASSERT_SUCCEEDED( g_Device->CreateGraphicsPipelineState(&m_PSODesc, MY_IID_PPV_ARGS(&m_PSO)) );
-		s_GraphicsPSOHashMap[HashCode].Attach(m_PSO);
+		D3D12_INPUT_ELEMENT_DESC Element = m_InputLayouts.get()[i];
+		const char* SemanticName = Element.SemanticName;
+		Element.SemanticName = nullptr;
+		HashCode = Utility::HashBytes64(&Element, sizeof(Element), HashCode);
+		HashCode = Utility::HashBytes64(SemanticName, strlen(SemanticName), HashCode);
 	}
-	else
+
+	m_PSODesc.InputLayout.pInputElementDescs = m_InputLayouts.get();
+
+	m_PSO = s_GraphicsPSOCache.GetOrCreate(HashCode, [&]()
 	{
-		while (*PSORef == nullptr)
-			this_thread::yield();
-		m_PSO = *PSORef;
-	}
+		return CreatePipelineState(m_PSODesc, HashCode,
+			[]( const D3D12_GRAPHICS_PIPELINE_STATE_DESC& Desc, ID3D12PipelineState** PipelineState )
+			{
+				return g_Device->CreateGraphicsPipelineState(&Desc, MY_IID_PPV_ARGS(PipelineState));
+			});
+	}).Get();
 }
 
 void ComputePSO::Finalize()
@@ -153,36 +247,24 @@ void ComputePSO::Finalize()
 	m_PSODesc.pRootSignature = m_RootSignature->GetSignature();
 	ASSERT(m_PSODesc.pRootSignature != nullptr);
 
-	size_t HashCode = Utility::HashState(&m_PSODesc);
+	D3D12_COMPUTE_PIPELINE_STATE_DESC HashDesc;
+	memcpy(&HashDesc, &m_PSODesc, sizeof(HashDesc));
+	HashDesc.pRootSignature = nullptr;
+	HashDesc.CS.pShaderBytecode = nullptr;
+	HashDesc.CachedPSO.pCachedBlob = nullptr;
+	HashDesc.CachedPSO.CachedBlobSizeInBytes = 0;
 
-	ID3D12PipelineState** PSORef = nullptr;
-	bool firstCompile = false;
-	{
-		static mutex s_HashMapMutex;
-		lock_guard<mutex> CS(s_HashMapMutex);
-		auto iter = s_ComputePSOHashMap.find(HashCode);
-
-		// Reserve space so the next inquiry will find that someone got here first.
-		if (iter == s_ComputePSOHashMap.end())
-		{
-			firstCompile = true;
-			PSORef = s_ComputePSOHashMap[HashCode].GetAddressOf();
-		}
-		else
-			PSORef = iter->second.GetAddressOf();
-	}
+	uint64_t HashCode = Utility::HashBytes64(&HashDesc, sizeof(HashDesc), m_RootSignature->GetContentHash());
+	HashCode = HashShader(m_PSODesc.CS, HashCode);
 
-	if (firstCompile)
+	m_PSO = s_ComputePSOCache.GetOrCreate(HashCode, [&]()
 	{
-		ASSERT_SUCCEEDED( g_Device->CreateComputePipelineState(&m_PSODesc, MY_IID_PPV_ARGS(&m_PSO)) );
-		s_ComputePSOHashMap[HashCode].Attach(m_PSO);
-	}
-	else
-	{
-		while (*PSORef == nullptr)
-			this_thread::yield();
-		m_PSO = *PSORef;
-	}
+		return CreatePipelineState(m_PSODesc, HashCode,
+			[]( const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc, ID3D12PipelineState** PipelineState )
+			{
+				return g_Device->CreateComputePipelineState(&Desc, MY_IID_PPV_ARGS(PipelineState));
+			});
+	}).Get();
 }
 
 ComputePSO::ComputePSO()
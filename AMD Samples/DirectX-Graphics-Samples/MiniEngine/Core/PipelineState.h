@@ -15,6 +15,7 @@
 
 #include "pch.h"
 
+struct IDXGIAdapter;
 class CommandContext;
 class RootSignature;
 class VertexShader;
@@ -32,6 +33,13 @@ public:
 
 	static void DestroyAll( void );
 
+	// Loads compiled pipelines saved by a previous run on the same adapter and driver, so that
+	// Finalize() can skip shader compilation.  Call before any pipelines are finalized.
+	static void LoadCache( const std::wstring& FileName, IDXGIAdapter* Adapter );
+
+	// Writes the compiled pipelines back to the file they were loaded from if any were added.
+	static void SaveCache( void );
+
 	void SetRootSignature( const RootSignature& BindMappings )
 	{
 		m_RootSignature = &BindMappings;
@@ -0,0 +1,362 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// The parts of the pipeline state cache that do not depend on D3D12:  a 64-bit content hash,
+// a sharded map of objects that are created once per key, and the file format used to keep
+// compiled pipeline blobs between runs.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Utility
+{
+	namespace Hash64Detail
+	{
+		const uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+		const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+		const uint64_t kPrime3 = 0x165667B19E3779F9ull;
+		const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+		const uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+		inline uint64_t Rotate( uint64_t x, int r ) { return (x << r) | (x >> (64 - r)); }
+		inline uint64_t Read64( const uint8_t* p ) { uint64_t v; memcpy(&v, p, 8); return v; }
+		inline uint32_t Read32( const uint8_t* p ) { uint32_t v; memcpy(&v, p, 4); return v; }
+		inline uint64_t Round( uint64_t Acc, uint64_t Input ) { return Rotate(Acc + Input * kPrime2, 31) * kPrime1; }
+		inline uint64_t Merge( uint64_t Acc, uint64_t Lane ) { return (Acc ^ Round(0, Lane)) * kPrime1 + kPrime4; }
+	}
+
+	// Hashes a range of bytes eight at a time, in four independent lanes so that long ranges
+	// such as shader bytecode hash at close to memory speed.  The seed lets hashes be chained.
+	inline uint64_t HashBytes64( const void* Data, size_t Size, uint64_t Seed = 0 )
+	{
+		using namespace Hash64Detail;
+
+		const uint8_t* p = (const uint8_t*)Data;
+		const uint8_t* End = p + Size;
+		uint64_t Hash;
+
+		if (Size >= 32)
+		{
+			uint64_t v1 = Seed + kPrime1 + kPrime2;
+			uint64_t v2 = Seed + kPrime2;
+			uint64_t v3 = Seed;
+			uint64_t v4 = Seed - kPrime1;
+
+			do
+			{
+				v1 = Round(v1, Read64(p));
+				v2 = Round(v2, Read64(p + 8));
+				v3 = Round(v3, Read64(p + 16));
+				v4 = Round(v4, Read64(p + 24));
+				p += 32;
+			}
+			while (p + 32 <= End);
+
+			Hash = Rotate(v1, 1) + Rotate(v2, 7) + Rotate(v3, 12) + Rotate(v4, 18);
+			Hash = Merge(Hash, v1);
+			Hash = Merge(Hash, v2);
+			Hash = Merge(Hash, v3);
+			Hash = Merge(Hash, v4);
+		}
+		else
+			Hash = Seed + kPrime5;
+
+		Hash += (uint64_t)Size;
+
+		for (; p + 8 <= End; p += 8)
+			Hash = Rotate(Hash ^ Round(0, Read64(p)), 27) * kPrime1 + kPrime4;
+
+		if (p + 4 <= End)
+		{
+			Hash = Rotate(Hash ^ (Read32(p) * kPrime1), 23) * kPrime2 + kPrime3;
+			p += 4;
+		}
+
+		for (; p < End; ++p)
+			Hash = Rotate(Hash ^ (*p * kPrime5), 11) * kPrime1;
+
+		Hash ^= Hash >> 33;
+		Hash *= kPrime2;
+		Hash ^= Hash >> 29;
+		Hash *= kPrime3;
+		Hash ^= Hash >> 32;
+
+		return Hash;
+	}
+
+	// A map from 64-bit keys to objects that are created once.  Keys are spread over shards
+	// that each have their own lock, so threads finalizing different objects rarely wait on
+	// each other.  A thread asking for an object that another thread is still creating sleeps
+	// until it is ready.  If creation throws, the key is released so a later request retries.
+	template <typename T, size_t ShardCount = 16>
+	class ShardedCache
+	{
+	public:
+
+		template <typename CreateFn>
+		T GetOrCreate( uint64_t Key, CreateFn Create )
+		{
+			Shard& S = m_Shards[(Key ^ (Key >> 32)) % ShardCount];
+			std::shared_ptr<Entry> NewEntry;
+
+			{
+				std::unique_lock<std::mutex> Lock(S.Mutex);
+
+				for (;;)
+				{
+					auto iter = S.Entries.find(Key);
+					if (iter == S.Entries.end())
+						break;
+
+					// Someone got here first.  Wait for them to finish.
+					std::shared_ptr<Entry> Existing = iter->second;
+					S.Ready.wait(Lock, [&] { return Existing->State != kPending; });
+					if (Existing->State == kReady)
+						return Existing->Value;
+				}
+
+				NewEntry = std::make_shared<Entry>();
+				S.Entries.emplace(Key, NewEntry);
+			}
+
+			T Value;
+			try
+			{
+				Value = Create();
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> Lock(S.Mutex);
+				NewEntry->State = kFailed;
+				S.Entries.erase(Key);
+				S.Ready.notify_all();
+				throw;
+			}
+
+			std::lock_guard<std::mutex> Lock(S.Mutex);
+			NewEntry->Value = Value;
+			NewEntry->State = kReady;
+			S.Ready.notify_all();
+			return Value;
+		}
+
+		// Must not be called while objects are being created.
+		void Clear( void )
+		{
+			for (size_t i = 0; i < ShardCount; ++i)
+			{
+				std::lock_guard<std::mutex> Lock(m_Shards[i].Mutex);
+				m_Shards[i].Entries.clear();
+			}
+		}
+
+		size_t Size( void ) const
+		{
+			size_t Count = 0;
+			for (size_t i = 0; i < ShardCount; ++i)
+			{
+				std::lock_guard<std::mutex> Lock(m_Shards[i].Mutex);
+				Count += m_Shards[i].Entries.size();
+			}
+			return Count;
+		}
+
+	private:
+
+		enum EntryState { kPending, kReady, kFailed };
+
+		struct Entry
+		{
+			Entry() : Value(), State(kPending) {}
+			T Value;
+			EntryState State;
+		};
+
+		struct Shard
+		{
+			mutable std::mutex Mutex;
+			std::condition_variable Ready;
+			std::unordered_map< uint64_t, std::shared_ptr<Entry> > Entries;
+		};
+
+		Shard m_Shards[ShardCount];
+	};
+
+	// Compiled pipeline blobs keyed by the content hash of their pipeline description, and the
+	// file they are saved to.  A file written for another device or driver (as identified by the
+	// device key), by another version of this code, or that fails its checksums is ignored.
+	//
+	//     FileHeader, then for each entry an EntryHeader followed by the blob padded to 8 bytes
+	//
+	// Load the file before pipelines are created.  Find and Store may then be called from any
+	// thread, and the pointer Find returns stays valid until the blob with that key is stored
+	// again or the cache is reset.
+	class PipelineBlobCache
+	{
+	public:
+
+		static const uint32_t kMagic = 0x43505350;	// "PSPC"
+		static const uint32_t kVersion = 1;
+
+		struct FileHeader
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t EntryCount;
+			uint32_t PointerSize;
+			uint64_t DeviceKey;
+		};
+
+		struct EntryHeader
+		{
+			uint64_t Key;
+			uint64_t Checksum;
+			uint32_t Size;
+			uint32_t Reserved;
+		};
+
+		PipelineBlobCache() : m_DeviceKey(0), m_Dirty(false) {}
+
+		void Reset( uint64_t DeviceKey )
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_Entries.clear();
+			m_DeviceKey = DeviceKey;
+			m_Dirty = false;
+		}
+
+		// Returns false and leaves the cache empty if the file cannot be used.
+		bool Load( const void* Data, size_t Size, uint64_t DeviceKey )
+		{
+			Reset(DeviceKey);
+
+			FileHeader Header;
+			if (Data == nullptr || Size < sizeof(Header))
+				return false;
+
+			const uint8_t* p = (const uint8_t*)Data;
+			const uint8_t* End = p + Size;
+
+			memcpy(&Header, p, sizeof(Header));
+			p += sizeof(Header);
+
+			if (Header.Magic != kMagic || Header.Version != kVersion ||
+				Header.PointerSize != sizeof(void*) || Header.DeviceKey != DeviceKey)
+				return false;
+
+			std::unordered_map< uint64_t, std::vector<uint8_t> > Entries;
+
+			for (uint32_t i = 0; i < Header.EntryCount; ++i)
+			{
+				EntryHeader Entry;
+				if ((size_t)(End - p) < sizeof(Entry))
+					return false;
+				memcpy(&Entry, p, sizeof(Entry));
+				p += sizeof(Entry);
+
+				if ((size_t)(End - p) < Entry.Size || HashBytes64(p, Entry.Size) != Entry.Checksum)
+					return false;
+
+				Entries[Entry.Key].assign(p, p + Entry.Size);
+				p += Entry.Size;
+
+				if ((size_t)(End - p) < PaddingFor(Entry.Size))
+					return false;
+				p += PaddingFor(Entry.Size);
+			}
+
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			m_Entries.swap(Entries);
+			return true;
+		}
+
+		void Save( std::vector<uint8_t>& Out ) const
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+
+			FileHeader Header = { kMagic, kVersion, (uint32_t)m_Entries.size(), (uint32_t)sizeof(void*), m_DeviceKey };
+
+			size_t TotalSize = sizeof(Header);
+			for (auto& iter : m_Entries)
+				TotalSize += sizeof(EntryHeader) + iter.second.size() + PaddingFor(iter.second.size());
+
+			Out.clear();
+			Out.reserve(TotalSize);
+			Append(Out, &Header, sizeof(Header));
+
+			for (auto& iter : m_Entries)
+			{
+				const std::vector<uint8_t>& Blob = iter.second;
+				EntryHeader Entry = { iter.first, HashBytes64(Blob.data(), Blob.size()), (uint32_t)Blob.size(), 0 };
+				Append(Out, &Entry, sizeof(Entry));
+				Append(Out, Blob.data(), Blob.size());
+				Out.resize(Out.size() + PaddingFor(Blob.size()), 0);
+			}
+
+			m_Dirty = false;
+		}
+
+		bool Find( uint64_t Key, const void*& Data, size_t& Size ) const
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			auto iter = m_Entries.find(Key);
+			if (iter == m_Entries.end() || iter->second.empty())
+				return false;
+
+			Data = iter->second.data();
+			Size = iter->second.size();
+			return true;
+		}
+
+		void Store( uint64_t Key, const void* Data, size_t Size )
+		{
+			if (Size == 0 || Size > UINT32_MAX)
+				return;
+
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			std::vector<uint8_t>& Blob = m_Entries[Key];
+			Blob.assign((const uint8_t*)Data, (const uint8_t*)Data + Size);
+			m_Dirty = true;
+		}
+
+		bool IsDirty( void ) const
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			return m_Dirty;
+		}
+
+		size_t GetEntryCount( void ) const
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+			return m_Entries.size();
+		}
+
+	private:
+
+		static size_t PaddingFor( size_t Size ) { return (8 - (Size & 7)) & 7; }
+
+		static void Append( std::vector<uint8_t>& Out, const void* Data, size_t Size )
+		{
+			Out.insert(Out.end(), (const uint8_t*)Data, (const uint8_t*)Data + Size);
+		}
+
+		mutable std::mutex m_Mutex;
+		std::unordered_map< uint64_t, std::vector<uint8_t> > m_Entries;
+		uint64_t m_DeviceKey;
+		mutable bool m_Dirty;
+	};
+
+} // namespace Utility
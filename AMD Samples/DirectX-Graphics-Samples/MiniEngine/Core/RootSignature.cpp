@@ -15,6 +15,7 @@
 #include "RootSignature.h"
 #include "GraphicsCore.h"
 #include "Hash.h"
+#include "PipelineStateCache.h"
 #include <map>
 #include <thread>
 #include <mutex>
@@ -104,11 +105,19 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS Flags)
 	m_MaxDescriptorCacheHandleCount = 0;
 
 	size_t HashCode = Utility::HashStateArray( RootDesc.pStaticSamplers, m_NumSamplers );
+
+	// Pipeline state objects saved to disk are keyed by this, so it must not include any pointers
+	m_ContentHash = Utility::HashBytes64( &Flags, sizeof(Flags) );
+	m_ContentHash = Utility::HashBytes64( RootDesc.pStaticSamplers, m_NumSamplers * sizeof(D3D12_STATIC_SAMPLER_DESC), m_ContentHash );
+
 	for (UINT Param = 0; Param < m_NumParameters; ++Param)
 	{
 		const D3D12_ROOT_PARAMETER& RootParam = RootDesc.pParameters[Param];
 		m_DescriptorTableSize[Param] = 0;
 
+		m_ContentHash = Utility::HashBytes64( &RootParam.ParameterType, sizeof(RootParam.ParameterType), m_ContentHash );
+		m_ContentHash = Utility::HashBytes64( &RootParam.ShaderVisibility, sizeof(RootParam.ShaderVisibility), m_ContentHash );
+
 		if (RootParam.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
 		{
 			ASSERT(RootParam.DescriptorTable.pDescriptorRanges != nullptr);
@@ -116,6 +125,9 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS Flags)
 			HashCode = Utility::HashStateArray( RootParam.DescriptorTable.pDescriptorRanges,
 				RootParam.DescriptorTable.NumDescriptorRanges, HashCode );
 
+			m_ContentHash = Utility::HashBytes64( RootParam.DescriptorTable.pDescriptorRanges,
+				RootParam.DescriptorTable.NumDescriptorRanges * sizeof(D3D12_DESCRIPTOR_RANGE), m_ContentHash );
+
 			// We don't care about sampler descriptor tables.  We don't manage them in DescriptorCache
 			if (RootParam.DescriptorTable.pDescriptorRanges->RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER)
 				continue;
@@ -127,7 +139,14 @@ void RootSignature::Finalize(D3D12_ROOT_SIGNATURE_FLAGS Flags)
 			m_MaxDescriptorCacheHandleCount += m_DescriptorTableSize[Param];
 		}
 		else
+		{
 			HashCode = Utility::HashState( &RootParam, HashCode );
+
+			if (RootParam.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+				m_ContentHash = Utility::HashBytes64( &RootParam.Constants, sizeof(RootParam.Constants), m_ContentHash );
+			else
+				m_ContentHash = Utility::HashBytes64( &RootParam.Descriptor, sizeof(RootParam.Descriptor), m_ContentHash );
+		}
 	}
 
 	ID3D12RootSignature** RSRef = nullptr;
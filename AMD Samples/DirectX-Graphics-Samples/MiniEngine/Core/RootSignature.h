@@ -162,6 +162,9 @@ public:
 
 	ID3D12RootSignature* GetSignature() const { return m_Signature; }
 
+	// A hash of the root signature's contents, which unlike the signature pointer is the same from run to run
+	uint64_t GetContentHash() const { return m_ContentHash; }
+
 protected:
 
 	BOOL m_Finalized;
@@ -174,4 +177,5 @@ protected:
 	std::unique_ptr<RootParameter[]> m_ParamArray;
 	std::unique_ptr<D3D12_STATIC_SAMPLER_DESC[]> m_SamplerArray;
 	ID3D12RootSignature* m_Signature;
+	uint64_t m_ContentHash;
 };
@@ -0,0 +1,249 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Checks that chunked files round trip through Compress, Decompress and Stream with any number
+// of workers, and that truncated, corrupt and overflowing files are rejected.
+//
+
+#include "TestUtility.h"
+#include "ChunkedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace Utility;
+
+namespace
+{
+	// Mostly compressible bytes, with one region that deflate cannot shrink so that some chunks
+	// are stored as they are.
+	std::vector<uint8_t> MakeData( size_t Size )
+	{
+		std::vector<uint8_t> Data(Size);
+		uint32_t Random = 1;
+		for (size_t i = 0; i < Size; ++i)
+		{
+			Random = Random * 1103515245 + 12345;
+			Data[i] = (uint8_t)((Random >> 16) % 16 + (i / 4096) % 7);
+		}
+
+		const size_t NoiseStart = std::min<size_t>(Size, 1 << 20);
+		const size_t NoiseEnd = std::min<size_t>(Size, NoiseStart + 300000);
+		for (size_t i = NoiseStart; i < NoiseEnd; ++i)
+		{
+			Random = Random * 1103515245 + 12345;
+			Data[i] = (uint8_t)(Random >> 23);
+		}
+
+		return Data;
+	}
+
+	bool ReadsBack( ChunkedFile::Stream& Stream, const std::vector<uint8_t>& Expected )
+	{
+		size_t Position = 0;
+		const uint8_t* Data;
+		size_t Size;
+
+		while (Stream.Next(Data, Size))
+		{
+			if (Position + Size > Expected.size() || memcmp(Data, Expected.data() + Position, Size) != 0)
+				return false;
+			Position += Size;
+		}
+
+		return Position == Expected.size() && !Stream.HasFailed();
+	}
+
+	void TestRoundTrip( void )
+	{
+		const std::vector<uint8_t> Source = MakeData(8 * 1024 * 1024 + 12345);
+
+		TaskPool Pool(3);
+		std::vector<uint8_t> Packed;
+		if (!CHECK(ChunkedFile::Compress(Source.data(), Source.size(), Packed, ChunkedFile::kDefaultChunkSize, 6, Pool)))
+			return;
+		CHECK(Packed.size() < Source.size());
+
+		const ChunkedFile::ReadFn Read = ChunkedFile::MemoryReader(Packed.data(), Packed.size());
+		ChunkedFile::Header Header;
+		std::vector<ChunkedFile::ChunkInfo> Chunks;
+		if (!CHECK(ChunkedFile::ReadIndex(Read, Packed.size(), Header, Chunks)))
+			return;
+		CHECK(Header.UncompressedSize == Source.size());
+		CHECK(Chunks.size() == ChunkedFile::ChunksFor(Source.size(), ChunkedFile::kDefaultChunkSize));
+
+		bool HasStoredChunk = false;
+		for (auto& Chunk : Chunks)
+			HasStoredChunk |= Chunk.CompressedSize == Chunk.UncompressedSize;
+		CHECK(HasStoredChunk);
+
+		// A pool without workers decompresses everything on the calling thread.
+		for (size_t WorkerCount : { 0, 1, 7 })
+		{
+			TaskPool Workers(WorkerCount);
+			std::vector<uint8_t> Out(Source.size());
+			CHECK(ChunkedFile::Decompress(Read, Header, Chunks, Out.data(), Workers) && Out == Source);
+		}
+
+		// Decompressing from a task on the pool that runs it must not deadlock.
+		{
+			TaskPool Workers(1);
+			std::vector<uint8_t> Out(Source.size());
+			std::atomic<bool> Succeeded(false);
+			std::atomic<bool> Finished(false);
+			Workers.Submit([&]
+			{
+				Succeeded = ChunkedFile::Decompress(Read, Header, Chunks, Out.data(), Workers);
+				Finished = true;
+			});
+			while (!Finished)
+				std::this_thread::yield();
+			CHECK(Succeeded && Out == Source);
+		}
+
+		for (size_t WorkerCount : { 0, 3 })
+		{
+			TaskPool Workers(WorkerCount);
+			ChunkedFile::Stream Stream(Workers, 4);
+
+			CHECK(Stream.OpenChunked(Read, Packed.size()) && Stream.GetSize() == Source.size());
+			CHECK(ReadsBack(Stream, Source));
+
+			// Closing part way through waits for the chunks still being decompressed.
+			const uint8_t* Data;
+			size_t Size;
+			CHECK(Stream.OpenChunked(Read, Packed.size()) && Stream.Next(Data, Size));
+			Stream.Close();
+
+			// Plain files read the same way, in chunks of any size.
+			CHECK(Stream.OpenStored(ChunkedFile::MemoryReader(Source.data(), Source.size()), Source.size(), 100000));
+			CHECK(ReadsBack(Stream, Source));
+		}
+	}
+
+	void TestCorruptFiles( void )
+	{
+		const std::vector<uint8_t> Source = MakeData(2 * 1024 * 1024 + 777);
+
+		TaskPool Pool(3);
+		std::vector<uint8_t> Packed;
+		if (!CHECK(ChunkedFile::Compress(Source.data(), Source.size(), Packed, ChunkedFile::kDefaultChunkSize, 6, Pool)))
+			return;
+
+		ChunkedFile::Header Header;
+		std::vector<ChunkedFile::ChunkInfo> Chunks;
+		if (!CHECK(ChunkedFile::ReadIndex(ChunkedFile::MemoryReader(Packed.data(), Packed.size()), Packed.size(), Header, Chunks)))
+			return;
+
+		// The index is intact, but a deflated chunk no longer inflates to its size or checksum.
+		const ChunkedFile::ChunkInfo& Last = Chunks.back();
+		CHECK(Last.CompressedSize < Last.UncompressedSize);
+
+		std::vector<uint8_t> Corrupt(Packed);
+		Corrupt[(size_t)Last.Offset + Last.CompressedSize / 2] ^= 0x55;
+		const ChunkedFile::ReadFn ReadCorrupt = ChunkedFile::MemoryReader(Corrupt.data(), Corrupt.size());
+
+		std::vector<uint8_t> Out(Source.size());
+		CHECK(ChunkedFile::ReadIndex(ReadCorrupt, Corrupt.size(), Header, Chunks));
+		CHECK(!ChunkedFile::Decompress(ReadCorrupt, Header, Chunks, Out.data(), Pool));
+
+		ChunkedFile::Stream Stream(Pool);
+		CHECK(Stream.OpenChunked(ReadCorrupt, Corrupt.size()));
+		const uint8_t* Data;
+		size_t Size;
+		while (Stream.Next(Data, Size)) {}
+		CHECK(Stream.HasFailed());
+
+		// Any file cut short is rejected before anything is decompressed.
+		const size_t DataStart = sizeof(ChunkedFile::Header) + Chunks.size() * sizeof(ChunkedFile::ChunkInfo);
+		for (size_t Cut = 0; Cut <= DataStart; ++Cut)
+		{
+			if (!CHECK(!ChunkedFile::ReadIndex(ChunkedFile::MemoryReader(Packed.data(), Cut), Cut, Header, Chunks)))
+				break;
+		}
+		CHECK(!ChunkedFile::ReadIndex(ChunkedFile::MemoryReader(Packed.data(), Packed.size() - 1), Packed.size() - 1, Header, Chunks));
+		CHECK(Chunks.empty());
+
+		// Headers whose size does not match their chunk count, including one that would overflow
+		// ChunkCount * ChunkSize in 32 bits.
+		ChunkedFile::Header Overflow = { ChunkedFile::kMagic, ChunkedFile::kVersion, ChunkedFile::kDefaultChunkSize, 0, ~0ull };
+		CHECK(!ChunkedFile::ReadIndex(ChunkedFile::MemoryReader(&Overflow, sizeof(Overflow)), sizeof(Overflow), Header, Chunks));
+
+		Overflow.ChunkCount = 1;
+		Overflow.UncompressedSize = ChunkedFile::kDefaultChunkSize + 1;
+		CHECK(!ChunkedFile::ReadIndex(ChunkedFile::MemoryReader(&Overflow, sizeof(Overflow)), sizeof(Overflow), Header, Chunks));
+
+		std::vector<uint8_t> BadChunkSize(Packed);
+		const uint32_t TooSmall = ChunkedFile::kMinChunkSize - 1;
+		memcpy(BadChunkSize.data() + offsetof(ChunkedFile::Header, ChunkSize), &TooSmall, sizeof(TooSmall));
+		CHECK(!ChunkedFile::ReadIndex(ChunkedFile::MemoryReader(BadChunkSize.data(), BadChunkSize.size()), BadChunkSize.size(), Header, Chunks));
+	}
+
+	void TestEmptyFile( void )
+	{
+		std::vector<uint8_t> Packed;
+		if (!CHECK(ChunkedFile::Compress(nullptr, 0, Packed)))
+			return;
+		CHECK(ChunkedFile::IsChunkedFile(Packed.data(), Packed.size()));
+
+		ChunkedFile::Stream Stream;
+		const uint8_t* Data;
+		size_t Size;
+		CHECK(Stream.OpenChunked(ChunkedFile::MemoryReader(Packed.data(), Packed.size()), Packed.size()));
+		CHECK(Stream.GetSize() == 0 && !Stream.Next(Data, Size) && !Stream.HasFailed());
+	}
+
+	void BenchmarkDecompress( void )
+	{
+		const std::vector<uint8_t> Source = MakeData(64 * 1024 * 1024 + 12345);
+
+		std::vector<uint8_t> Packed;
+		TestUtility::Timer CompressTimer;
+		if (!CHECK(ChunkedFile::Compress(Source.data(), Source.size(), Packed, ChunkedFile::kDefaultChunkSize, 6)))
+			return;
+		printf("Compressed %zu bytes to %zu in %.1f ms with %zu workers\n", Source.size(), Packed.size(),
+			CompressTimer.ElapsedMilliseconds(), TaskPool::Default().GetWorkerCount());
+
+		const ChunkedFile::ReadFn Read = ChunkedFile::MemoryReader(Packed.data(), Packed.size());
+		ChunkedFile::Header Header;
+		std::vector<ChunkedFile::ChunkInfo> Chunks;
+		if (!CHECK(ChunkedFile::ReadIndex(Read, Packed.size(), Header, Chunks)))
+			return;
+
+		std::vector<uint8_t> Out(Source.size());
+		for (size_t WorkerCount : { 0, 1, 3, 7 })
+		{
+			TaskPool Workers(WorkerCount);
+			TestUtility::Timer Timer;
+			CHECK(ChunkedFile::Decompress(Read, Header, Chunks, Out.data(), Workers));
+			const double Elapsed = Timer.ElapsedMilliseconds();
+			CHECK(Out == Source);
+
+			printf("Decompressed with %zu worker(s) in %.1f ms\n", WorkerCount, Elapsed);
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	TestRoundTrip();
+	TestCorruptFiles();
+	TestEmptyFile();
+
+	if (TestUtility::IsBenchmark(argc, argv))
+	{
+		BenchmarkDecompress();
+	}
+
+	return TestUtility::Finish("ChunkedFileTest");
+}
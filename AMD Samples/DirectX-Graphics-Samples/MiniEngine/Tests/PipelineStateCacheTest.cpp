@@ -0,0 +1,327 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Checks the content hash, the sharded object cache (with threads racing to create the same
+// objects, some of which fail) and the pipeline blob file format of PipelineStateCache.h.
+//
+
+#include "TestUtility.h"
+#include "PipelineStateCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace Utility;
+
+namespace
+{
+	std::vector<uint8_t> MakeBytes( size_t Size )
+	{
+		std::vector<uint8_t> Bytes(Size);
+		for (size_t i = 0; i < Size; ++i)
+			Bytes[i] = (uint8_t)(i * 131 + 7);
+		return Bytes;
+	}
+
+	void TestHash( void )
+	{
+		const std::vector<uint8_t> Bytes = MakeBytes(1000);
+
+		// Every length hashes differently, covering the tail and four lane paths.
+		std::unordered_set<uint64_t> Seen;
+		for (size_t Size = 0; Size < 200; ++Size)
+			CHECK(Seen.insert(HashBytes64(Bytes.data(), Size)).second);
+
+		CHECK(HashBytes64(Bytes.data(), 50) == HashBytes64(Bytes.data(), 50));
+		CHECK(HashBytes64(Bytes.data() + 1, 50) != HashBytes64(Bytes.data(), 50));
+		CHECK(HashBytes64(Bytes.data(), 50, 1) != HashBytes64(Bytes.data(), 50, 2));
+
+		// The hash does not depend on the alignment of the data.
+		std::vector<uint8_t> Shifted(Bytes.size() + 3);
+		memcpy(Shifted.data() + 3, Bytes.data(), Bytes.size());
+		CHECK(HashBytes64(Shifted.data() + 3, Bytes.size()) == HashBytes64(Bytes.data(), Bytes.size()));
+
+		// Flipping any one bit changes the hash.
+		std::vector<uint8_t> Flipped(Bytes.begin(), Bytes.begin() + 64);
+		const uint64_t Original = HashBytes64(Flipped.data(), Flipped.size());
+		for (size_t Bit = 0; Bit < Flipped.size() * 8; ++Bit)
+		{
+			Flipped[Bit / 8] ^= (uint8_t)(1 << (Bit % 8));
+			CHECK(HashBytes64(Flipped.data(), Flipped.size()) != Original);
+			Flipped[Bit / 8] ^= (uint8_t)(1 << (Bit % 8));
+		}
+	}
+
+	void TestShardedCache( void )
+	{
+		const int kThreadCount = 8;
+		const int kLookups = 2000;
+		const uint64_t kKeyCount = 500;
+		const uint64_t kFailingKey = 7;
+
+		ShardedCache< std::shared_ptr<uint64_t> > Cache;
+		std::atomic<int> CreateCount[kKeyCount];
+		for (auto& Count : CreateCount)
+			Count = 0;
+		std::atomic<int> FailuresLeft(3);
+		std::atomic<int> Thrown(0);
+
+		std::vector<std::thread> Threads;
+		for (int t = 0; t < kThreadCount; ++t)
+		{
+			Threads.emplace_back([&]
+			{
+				for (int i = 0; i < kLookups; ++i)
+				{
+					const uint64_t Key = HashBytes64(&i, sizeof(i)) % kKeyCount;
+
+					try
+					{
+						std::shared_ptr<uint64_t> Value = Cache.GetOrCreate(Key, [&]
+						{
+							// The first few attempts to create one key fail, as a driver might.
+							if (Key == kFailingKey && FailuresLeft.fetch_sub(1) > 0)
+								throw std::runtime_error("Creation failed");
+
+							++CreateCount[Key];
+							std::this_thread::sleep_for(std::chrono::microseconds(50));
+							return std::make_shared<uint64_t>(Key);
+						});
+
+						CHECK(Value && *Value == Key);
+					}
+					catch (const std::runtime_error&)
+					{
+						++Thrown;
+					}
+				}
+			});
+		}
+
+		for (auto& Thread : Threads)
+			Thread.join();
+
+		// Each key was created exactly once, however many threads asked for it at once.
+		size_t Created = 0;
+		for (uint64_t Key = 0; Key < kKeyCount; ++Key)
+		{
+			CHECK(CreateCount[Key] <= 1);
+			Created += CreateCount[Key];
+		}
+
+		CHECK(Created == Cache.Size());
+		CHECK(CreateCount[kFailingKey] == 1);
+		CHECK(Thrown == 3);
+
+		Cache.Clear();
+		CHECK(Cache.Size() == 0);
+	}
+
+	void TestBlobCache( void )
+	{
+		const std::vector<uint8_t> Bytes = MakeBytes(1000);
+
+		PipelineBlobCache Cache;
+		Cache.Reset(42);
+		for (int i = 0; i < 50; ++i)
+			Cache.Store(i * 977, Bytes.data() + i, 13 + i * 7);
+
+		// Empty blobs are not stored.
+		Cache.Store(123456, Bytes.data(), 0);
+		CHECK(Cache.IsDirty());
+		CHECK(Cache.GetEntryCount() == 50);
+
+		std::vector<uint8_t> File;
+		Cache.Save(File);
+		CHECK(!Cache.IsDirty());
+
+		PipelineBlobCache Loaded;
+		CHECK(Loaded.Load(File.data(), File.size(), 42));
+		CHECK(Loaded.GetEntryCount() == 50);
+		CHECK(!Loaded.IsDirty());
+
+		for (int i = 0; i < 50; ++i)
+		{
+			const void* Data = nullptr;
+			size_t Size = 0;
+			if (!CHECK(Loaded.Find(i * 977, Data, Size)))
+				break;
+			CHECK(Size == size_t(13 + i * 7) && memcmp(Data, Bytes.data() + i, Size) == 0);
+		}
+
+		const void* Data;
+		size_t Size;
+		CHECK(!Loaded.Find(123456, Data, Size));
+
+		// Files for another device, truncated files and corrupt files are rejected and leave
+		// the cache empty.
+		CHECK(!Loaded.Load(File.data(), File.size(), 43));
+		CHECK(Loaded.GetEntryCount() == 0);
+
+		for (size_t Cut = 0; Cut < File.size(); ++Cut)
+		{
+			if (!CHECK(!Loaded.Load(File.data(), Cut, 42) && Loaded.GetEntryCount() == 0))
+				break;
+		}
+
+		// A flipped bit in the first entry's checksum, size or blob is caught; one in its key
+		// only files the blob under another key.
+		const size_t FirstEntry = sizeof(PipelineBlobCache::FileHeader);
+		const size_t Corruptions[] =
+		{
+			FirstEntry + offsetof(PipelineBlobCache::EntryHeader, Checksum),
+			FirstEntry + offsetof(PipelineBlobCache::EntryHeader, Size),
+			FirstEntry + sizeof(PipelineBlobCache::EntryHeader),
+			FirstEntry + sizeof(PipelineBlobCache::EntryHeader) + 12,
+		};
+
+		for (size_t Offset : Corruptions)
+		{
+			std::vector<uint8_t> Corrupt(File);
+			Corrupt[Offset] ^= 1;
+			CHECK(!Loaded.Load(Corrupt.data(), Corrupt.size(), 42) && Loaded.GetEntryCount() == 0);
+		}
+
+		std::vector<uint8_t> BadKey(File);
+		BadKey[FirstEntry + offsetof(PipelineBlobCache::EntryHeader, Key) + 7] ^= 0x80;
+		CHECK(Loaded.Load(BadKey.data(), BadKey.size(), 42) && Loaded.GetEntryCount() == 50);
+
+		std::vector<uint8_t> BadVersion(File);
+		BadVersion[4] ^= 1;
+		CHECK(!Loaded.Load(BadVersion.data(), BadVersion.size(), 42));
+
+		std::vector<uint8_t> BadPointerSize(File);
+		BadPointerSize[12] ^= 4;
+		CHECK(!Loaded.Load(BadPointerSize.data(), BadPointerSize.size(), 42));
+
+		CHECK(!Loaded.Load(nullptr, 0, 42));
+
+		// Storing over an existing key replaces the blob.
+		CHECK(Loaded.Load(File.data(), File.size(), 42));
+		Loaded.Store(0, Bytes.data() + 500, 40);
+		CHECK(Loaded.IsDirty());
+		CHECK(Loaded.Find(0, Data, Size) && Size == 40 && memcmp(Data, Bytes.data() + 500, 40) == 0);
+	}
+
+	// The word-at-a-time FNV loop that HashStateArray in Hash.h uses.
+	size_t HashWordsFNV( const uint32_t* Begin, const uint32_t* End, size_t Val )
+	{
+		while (Begin < End)
+			Val = 16777619U * Val ^ (size_t)*Begin++;
+		return Val;
+	}
+
+	void BenchmarkHash( void )
+	{
+		const std::vector<uint8_t> Bytes = MakeBytes(100000);
+		const std::vector<uint32_t> Words(Bytes.size() / 4, 0x12345678);
+		const int kIterations = 200;
+
+		uint64_t Sum = 0;
+
+		TestUtility::Timer HashTimer;
+		for (int i = 0; i < kIterations; ++i)
+			Sum += HashBytes64(Bytes.data(), Bytes.size(), i);
+		const double HashTime = HashTimer.ElapsedMilliseconds();
+
+		TestUtility::Timer FNVTimer;
+		for (int i = 0; i < kIterations; ++i)
+			Sum += HashWordsFNV(Words.data(), Words.data() + Words.size(), 2166136261U + i);
+		const double FNVTime = FNVTimer.ElapsedMilliseconds();
+
+		printf("Hashing %zu bytes: HashBytes64 %.3f ms, FNV words %.3f ms (%d)\n",
+			Bytes.size(), HashTime / kIterations, FNVTime / kIterations, (int)(Sum & 1));
+	}
+
+	// The cache look-up that GraphicsPSO::Finalize does for pipelines that already exist,
+	// against one map behind one lock.
+	void BenchmarkLookups( void )
+	{
+		const int kThreadCount = 8;
+		const int kLookups = 200000;
+		const uint64_t kKeyCount = 4096;
+
+		ShardedCache<uint64_t> Sharded;
+		std::mutex Mutex;
+		std::unordered_map<uint64_t, uint64_t> Locked;
+
+		for (uint64_t Key = 0; Key < kKeyCount; ++Key)
+		{
+			const uint64_t Hash = HashBytes64(&Key, sizeof(Key));
+			Sharded.GetOrCreate(Hash, [&] { return Key; });
+			Locked[Hash] = Key;
+		}
+
+		auto TimeThreads = [&]( const std::function<uint64_t (uint64_t)>& Lookup )
+		{
+			std::atomic<uint64_t> Sum(0);
+			TestUtility::Timer Timer;
+
+			std::vector<std::thread> Threads;
+			for (int t = 0; t < kThreadCount; ++t)
+			{
+				Threads.emplace_back([&, t]
+				{
+					uint64_t Local = 0;
+					for (int i = 0; i < kLookups; ++i)
+					{
+						const uint64_t Key = (uint64_t)(i * 7 + t) % kKeyCount;
+						Local += Lookup(HashBytes64(&Key, sizeof(Key)));
+					}
+					Sum += Local;
+				});
+			}
+
+			for (auto& Thread : Threads)
+				Thread.join();
+
+			const double Elapsed = Timer.ElapsedMilliseconds();
+			CHECK(Sum != 0);
+			return Elapsed;
+		};
+
+		const double ShardedTime = TimeThreads([&]( uint64_t Hash )
+		{
+			return Sharded.GetOrCreate(Hash, [] { return uint64_t(0); });
+		});
+
+		const double LockedTime = TimeThreads([&]( uint64_t Hash )
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return Locked[Hash];
+		});
+
+		printf("%d threads x %d cached look-ups: ShardedCache %.3f ms, one locked map %.3f ms\n",
+			kThreadCount, kLookups, ShardedTime, LockedTime);
+	}
+}
+
+int main( int argc, char** argv )
+{
+	TestHash();
+	TestShardedCache();
+	TestBlobCache();
+
+	if (TestUtility::IsBenchmark(argc, argv))
+	{
+		BenchmarkHash();
+		BenchmarkLookups();
+	}
+
+	return TestUtility::Finish("PipelineStateCacheTest");
+}
@@ -0,0 +1,72 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Checks and timing shared by the tests of the parts of Core that do not depend on D3D12.
+// A test run with --benchmark also times the code it checks.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace TestUtility
+{
+	// Checks may fail on any thread.
+	inline std::atomic<int>& FailureCount( void )
+	{
+		static std::atomic<int> s_Failures(0);
+		return s_Failures;
+	}
+
+	inline bool Check( bool Condition, const char* Text, const char* File, int Line )
+	{
+		if (!Condition)
+		{
+			fprintf(stderr, "%s(%d): check failed: %s\n", File, Line, Text);
+			++FailureCount();
+		}
+		return Condition;
+	}
+
+	inline bool IsBenchmark( int argc, char** argv )
+	{
+		return argc > 1 && strcmp(argv[1], "--benchmark") == 0;
+	}
+
+	// Prints a summary and returns the process exit code.
+	inline int Finish( const char* TestName )
+	{
+		if (FailureCount() != 0)
+		{
+			fprintf(stderr, "%s: %d check(s) failed\n", TestName, FailureCount().load());
+			return 1;
+		}
+
+		printf("%s: all checks passed\n", TestName);
+		return 0;
+	}
+
+	class Timer
+	{
+	public:
+		Timer() : m_Start(std::chrono::steady_clock::now()) {}
+
+		double ElapsedMilliseconds( void ) const
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point m_Start;
+	};
+}
+
+#define CHECK(Condition) TestUtility::Check(!!(Condition), #Condition, __FILE__, __LINE__)
@@ -41,10 +41,12 @@
 // This is the platform independent interface between an OGL driver
 // and the shading language compiler/linker.
 //
+#include <cstddef>
 #include <cstring>
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <vector>
 #include "SymbolTable.h"
 #include "ParseHelper.h"
 #include "Scan.h"
@@ -228,6 +230,29 @@ TSymbolTable* SharedSymbolTables[VersionCount][SpvVersionCount][ProfileCount][So
 
 TPoolAllocator* PerProcessGPA = nullptr;
 
+// A process-global cache of the context-specific built-ins (symbol table level 2),
+// keyed on everything that goes into generating them: version, profile, stage and
+// the full set of resource limits.  Applications tend to compile many shaders with
+// one set of resources, so the built-in text for these only needs to be generated
+// and parsed once, rather than once per compile.
+//
+// Each entry adopts the shared levels of the matching SharedSymbolTables entry and
+// owns a copy of level 2, allocated from the process-global pool.  Compiles never
+// use that copy directly; they clone it into their own pool.
+// Shared global; access should be protected by a global mutex/critical section.
+struct TContextSymbolTable {
+    int versionIndex;
+    int spvVersionIndex;
+    int profileIndex;
+    int sourceIndex;
+    EShLanguage stage;
+    unsigned int resourcesHash;
+    TBuiltInResource resources;
+    TSymbolTable* symbolTable;
+};
+
+std::vector<TContextSymbolTable>* ContextSymbolTables = nullptr;
+
 //
 // Parse and add to the given symbol table the content of the given shader string.
 //
@@ -395,6 +420,40 @@ bool AddContextSpecificSymbols(const TBuiltInResource* resources, TInfoSink& inf
     return true;
 }
 
+//
+// Compare two sets of resources.  The limits are compared member-wise, as the
+// padding at the end of TLimits is not guaranteed to be initialized.
+//
+bool EqualResources(const TBuiltInResource& a, const TBuiltInResource& b)
+{
+    return memcmp(&a, &b, offsetof(TBuiltInResource, limits)) == 0                                        &&
+           a.limits.nonInductiveForLoops                 == b.limits.nonInductiveForLoops                 &&
+           a.limits.whileLoops                           == b.limits.whileLoops                           &&
+           a.limits.doWhileLoops                         == b.limits.doWhileLoops                         &&
+           a.limits.generalUniformIndexing               == b.limits.generalUniformIndexing               &&
+           a.limits.generalAttributeMatrixVectorIndexing == b.limits.generalAttributeMatrixVectorIndexing &&
+           a.limits.generalVaryingIndexing               == b.limits.generalVaryingIndexing               &&
+           a.limits.generalSamplerIndexing               == b.limits.generalSamplerIndexing               &&
+           a.limits.generalVariableIndexing              == b.limits.generalVariableIndexing              &&
+           a.limits.generalConstantMatrixVectorIndexing  == b.limits.generalConstantMatrixVectorIndexing;
+}
+
+//
+// FNV-1a over the integer part of the resources, used to quickly reject cache entries.
+//
+unsigned int HashResources(const TBuiltInResource& resources)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&resources);
+    unsigned int hash = 2166136261u;
+
+    for (size_t i = 0; i < offsetof(TBuiltInResource, limits); ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
 //
 // To do this on the fly, we want to leave the current state of our thread's
 // pool allocator intact, so:
@@ -474,6 +533,94 @@ void SetupBuiltinSymbolTable(int version, EProfile profile, const SpvVersion& sp
     glslang::ReleaseGlobalLock();
 }
 
+//
+// Return a symbol table holding the shared built-ins for the given version/profile/stage,
+// topped with the built-ins that depend on 'resources'.
+// The table is generated the first time a compile asks for this combination,
+// the same way SetupBuiltinSymbolTable() does it for the shared levels, and is
+// reused by all later compiles.
+//
+// SetupBuiltinSymbolTable() must have been called for this version/profile combination.
+// Returns nullptr if the context-specific built-ins could not be generated.
+//
+TSymbolTable* GetContextSymbolTable(const TBuiltInResource& resources, TInfoSink& infoSink, int version, EProfile profile,
+                                    const SpvVersion& spvVersion, EShLanguage language, EShSource source)
+{
+    const int versionIndex = MapVersionToIndex(version);
+    const int spvVersionIndex = MapSpvVersionToIndex(spvVersion);
+    const int profileIndex = MapProfileToIndex(profile);
+    const int sourceIndex = MapSourceToIndex(source);
+    const unsigned int resourcesHash = HashResources(resources);
+
+    // Make sure only one thread tries to do this at a time
+    glslang::GetGlobalLock();
+
+    if (ContextSymbolTables == nullptr)
+        ContextSymbolTables = new std::vector<TContextSymbolTable>;
+
+    // See if it's already been done for this combination
+    for (auto it = ContextSymbolTables->begin(); it != ContextSymbolTables->end(); ++it) {
+        if (it->versionIndex    == versionIndex    &&
+            it->spvVersionIndex == spvVersionIndex &&
+            it->profileIndex    == profileIndex    &&
+            it->sourceIndex     == sourceIndex     &&
+            it->stage           == language        &&
+            it->resourcesHash   == resourcesHash   &&
+            EqualResources(it->resources, resources)) {
+            TSymbolTable* symbolTable = it->symbolTable;
+            glslang::ReleaseGlobalLock();
+
+            return symbolTable;
+        }
+    }
+
+    TSymbolTable* sharedTable = SharedSymbolTables[versionIndex][spvVersionIndex][profileIndex][sourceIndex][language];
+
+    // Switch to a new pool
+    TPoolAllocator& previousAllocator = GetThreadPoolAllocator();
+    TPoolAllocator* builtInPoolAllocator = new TPoolAllocator;
+    SetThreadPoolAllocator(builtInPoolAllocator);
+
+    // Generate the context-specific level on top of the shared levels, using the new pool
+    TSymbolTable* localTable = new TSymbolTable;
+    if (sharedTable)
+        localTable->adoptLevels(*sharedTable);
+    bool success = AddContextSpecificSymbols(&resources, infoSink, *localTable, version, profile, spvVersion,
+                                             language, source);
+
+    // Switch to the process-global pool, and copy the context-specific level into it
+    SetThreadPoolAllocator(PerProcessGPA);
+
+    TSymbolTable* contextTable = nullptr;
+    if (success) {
+        contextTable = new TSymbolTable;
+        if (sharedTable)
+            contextTable->adoptLevels(*sharedTable);
+        contextTable->copyTable(*localTable);
+
+        TContextSymbolTable entry;
+        entry.versionIndex = versionIndex;
+        entry.spvVersionIndex = spvVersionIndex;
+        entry.profileIndex = profileIndex;
+        entry.sourceIndex = sourceIndex;
+        entry.stage = language;
+        entry.resourcesHash = resourcesHash;
+        entry.resources = resources;
+        entry.symbolTable = contextTable;
+        ContextSymbolTables->push_back(entry);
+    }
+
+    // Clean up the local table before deleting the pool it used.
+    delete localTable;
+
+    delete builtInPoolAllocator;
+    SetThreadPoolAllocator(&previousAllocator);
+
+    glslang::ReleaseGlobalLock();
+
+    return contextTable;
+}
+
 // Return true if the shader was correctly specified for version/profile/stage.
 bool DeduceVersionProfile(TInfoSink& infoSink, EShLanguage stage, bool versionNotFirst, int defaultVersion,
                           EShSource source, int& version, EProfile& profile, const SpvVersion& spvVersion)
@@ -893,17 +1040,22 @@ bool ProcessDeferred(
                                                   [MapSourceToIndex(source)]
                                                   [stage];
 
+    // Built-in symbols that are potentially context dependent are generated once per set of
+    // resources and kept in a process-global cache.
+    TSymbolTable* contextTable = GetContextSymbolTable(*resources, compiler->infoSink, version, profile, spvVersion,
+                                                       stage, source);
+    if (contextTable == nullptr)
+        return false;
+
     // Dynamically allocate the symbol table so we can control when it is deallocated WRT the pool.
     std::unique_ptr<TSymbolTable> symbolTable(new TSymbolTable);
     if (cachedTable)
         symbolTable->adoptLevels(*cachedTable);
 
-    // Add built-in symbols that are potentially context dependent;
-    // they get popped again further down.
-    if (! AddContextSpecificSymbols(resources, compiler->infoSink, *symbolTable, version, profile, spvVersion,
-                                    stage, source)) {
-        return false;
-    }
+    // Give this compile its own, writable, copy of the context-specific built-ins, as the parser
+    // edits them in place (e.g., implicitly sized members of gl_in); cloning the cached level is
+    // much cheaper than generating and parsing the built-in text again.
+    symbolTable->copyTable(*contextTable);
 
     //
     // Now we can process the full shader under proper symbols and rules.
@@ -1345,6 +1497,13 @@ int ShFinalize()
     if (! finalize)
         return 1;
 
+    if (ContextSymbolTables != nullptr) {
+        for (auto it = ContextSymbolTables->begin(); it != ContextSymbolTables->end(); ++it)
+            delete it->symbolTable;
+        delete ContextSymbolTables;
+        ContextSymbolTables = nullptr;
+    }
+
     for (int version = 0; version < VersionCount; ++version) {
         for (int spvVersion = 0; spvVersion < SpvVersionCount; ++spvVersion) {
             for (int p = 0; p < ProfileCount; ++p) {
@@ -0,0 +1,357 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Implements a linear arena which command buffers use to stash descriptors of recorded commands.
+ *
+ * Command descriptors, as well as all variable-length data they refer to (regions, barriers, clear values, marker
+ * names, push constant data, ..), are placement-constructed into large memory blocks owned by the stash, one after
+ * another. Recording a command thus boils down to a pointer bump plus a copy of the arguments.
+ *
+ * reset() destroys all stashed objects but keeps the memory blocks around, so that a command buffer which is
+ * re-recorded every frame stops allocating heap memory after the first recording.
+ *
+ * CommandStash is NOT thread-safe. Command buffers are expected to be recorded from one thread at a time.
+ **/
+#ifndef MISC_COMMAND_STASH_H
+#define MISC_COMMAND_STASH_H
+
+#include "misc/debug.h"
+#include "misc/types.h"
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Anvil
+{
+    /* Forward declarations */
+    struct Command;
+
+    /** Read-only view of an array whose storage is owned by a CommandStash instance.
+     *
+     *  Exposes a subset of std::vector's interface, so that stashed command descriptors can be
+     *  inspected the same way as before they were moved to the arena.
+     **/
+    template<typename Type>
+    class CommandStashArray
+    {
+    public:
+        /* Public functions */
+
+        CommandStashArray()
+            :m_items_ptr(nullptr),
+             m_n_items  (0)
+        {
+            /* Stub */
+        }
+
+        CommandStashArray(const Type* in_items_ptr,
+                          uint32_t    in_n_items)
+            :m_items_ptr(in_items_ptr),
+             m_n_items  (in_n_items)
+        {
+            /* Stub */
+        }
+
+        const Type& at(size_t in_n_item) const
+        {
+            anvil_assert(in_n_item < m_n_items);
+
+            return m_items_ptr[in_n_item];
+        }
+
+        const Type* begin() const
+        {
+            return m_items_ptr;
+        }
+
+        const Type* data() const
+        {
+            return m_items_ptr;
+        }
+
+        bool empty() const
+        {
+            return (m_n_items == 0);
+        }
+
+        const Type* end() const
+        {
+            return m_items_ptr + m_n_items;
+        }
+
+        size_t size() const
+        {
+            return m_n_items;
+        }
+
+        const Type& operator[](size_t in_n_item) const
+        {
+            return m_items_ptr[in_n_item];
+        }
+
+    private:
+        /* Private variables */
+        const Type* m_items_ptr;
+        uint32_t    m_n_items;
+    };
+
+    class CommandStash
+    {
+    public:
+        /* Public functions */
+
+        /** Constructor. Does not allocate any memory.
+         *
+         *  @param in_block_size Size of a single memory block. Requests larger than this value are assigned
+         *                       dedicated blocks.
+         **/
+        explicit CommandStash(size_t in_block_size = 64 * 1024);
+
+        /** Destructor. Destroys all stashed objects and releases the memory blocks. */
+        ~CommandStash();
+
+        /** Copies @param in_n_items items under @param in_items_ptr to the stash.
+         *
+         *  Non-trivially destructible items are destroyed at reset() time.
+         *
+         *  @return View of the copied items. Stays valid until the next reset() call.
+         **/
+        template<typename Type>
+        CommandStashArray<Type> copy_array(const Type* in_items_ptr,
+                                           uint32_t    in_n_items)
+        {
+            Type* result_ptr = nullptr;
+
+            if (in_n_items == 0)
+            {
+                goto end;
+            }
+
+            anvil_assert(in_items_ptr != nullptr);
+
+            result_ptr = static_cast<Type*>(allocate(sizeof(Type) * in_n_items,
+                                                     alignof(Type) ));
+
+            for (uint32_t n_item = 0;
+                          n_item < in_n_items;
+                        ++n_item)
+            {
+                new (result_ptr + n_item) Type(in_items_ptr[n_item]);
+
+                register_destructor<Type>(result_ptr + n_item);
+            }
+
+        end:
+            return CommandStashArray<Type>(result_ptr,
+                                           in_n_items);
+        }
+
+        /** Same as above, but copies the contents of @param in_items. */
+        template<typename Type>
+        CommandStashArray<Type> copy_array(const std::vector<Type>& in_items)
+        {
+            return copy_array((in_items.size() > 0) ? &in_items.at(0) : nullptr,
+                              static_cast<uint32_t>(in_items.size() ));
+        }
+
+        /** Copies @param in_size bytes of raw data under @param in_data_ptr to the stash.
+         *
+         *  @return Pointer to the copy, or nullptr if @param in_size is 0. Stays valid until the next reset() call.
+         **/
+        const void* copy_data(const void* in_data_ptr,
+                              size_t      in_size);
+
+        /** Copies a null-terminated string to the stash.
+         *
+         *  @return Pointer to the copy. Stays valid until the next reset() call.
+         **/
+        const char* copy_string(const char* in_string_ptr);
+
+        /** Constructs @param in_n_items items in the stash. The n-th item is copy-constructed from the value
+         *  returned by @param in_generator_func for n.
+         *
+         *  Meant for arrays whose items are derived from, rather than equal to, the recorded arguments.
+         *  Non-trivially destructible items are destroyed at reset() time.
+         *
+         *  @return View of the constructed items. Stays valid until the next reset() call.
+         **/
+        template<typename Type, typename GeneratorFunc>
+        CommandStashArray<Type> generate_array(uint32_t      in_n_items,
+                                               GeneratorFunc in_generator_func)
+        {
+            Type* result_ptr = nullptr;
+
+            if (in_n_items == 0)
+            {
+                goto end;
+            }
+
+            result_ptr = static_cast<Type*>(allocate(sizeof(Type) * in_n_items,
+                                                     alignof(Type) ));
+
+            for (uint32_t n_item = 0;
+                          n_item < in_n_items;
+                        ++n_item)
+            {
+                new (result_ptr + n_item) Type(in_generator_func(n_item) );
+
+                register_destructor<Type>(result_ptr + n_item);
+            }
+
+        end:
+            return CommandStashArray<Type>(result_ptr,
+                                           in_n_items);
+        }
+
+        /** Constructs a new command descriptor in the stash and appends it to the list of stashed commands.
+         *
+         *  @param in_args Arguments to forward to the command descriptor's constructor.
+         *
+         *  @return Pointer to the new command descriptor. Stays valid until the next reset() call.
+         **/
+        template<typename CommandType, typename... Args>
+        CommandType* stash(Args&&... in_args)
+        {
+            CommandType* result_ptr = nullptr;
+
+            result_ptr = new (allocate(sizeof(CommandType),
+                                       alignof(CommandType) )) CommandType(std::forward<Args>(in_args)...);
+
+            register_destructor<CommandType>(result_ptr);
+
+            m_command_ptrs.push_back(result_ptr);
+
+            return result_ptr;
+        }
+
+        /** Destroys all stashed objects. Memory blocks are retained for reuse. */
+        void reset();
+
+        /** Returns a stashed command descriptor.
+         *
+         *  @param in_n_command Index of the command, in stashing order. Must be smaller than get_n_commands().
+         **/
+        const Anvil::Command* get_command(uint32_t in_n_command) const
+        {
+            anvil_assert(in_n_command < m_command_ptrs.size() );
+
+            return m_command_ptrs.at(in_n_command);
+        }
+
+        /** Returns the number of command descriptors stashed since the last reset() call. */
+        uint32_t get_n_commands() const
+        {
+            return static_cast<uint32_t>(m_command_ptrs.size() );
+        }
+
+        /** Returns the number of bytes in use by the stashed objects. */
+        size_t get_n_bytes_used() const;
+
+        /** Returns the number of bytes held by the stash, including unused memory. */
+        size_t get_n_bytes_reserved() const;
+
+        /** Returns pointers to all commands stashed since the last reset() call, in stashing order. */
+        const std::vector<Anvil::Command*>& get_commands() const
+        {
+            return m_command_ptrs;
+        }
+
+    private:
+        /* Private type definitions */
+        typedef struct Block
+        {
+            std::unique_ptr<uint8_t[]> data_ptr;
+            size_t                     size;
+
+            explicit Block(size_t in_size)
+                :data_ptr(new uint8_t[in_size]),
+                 size    (in_size)
+            {
+                /* Stub */
+            }
+
+            Block(Block&& in_block)
+                :data_ptr(std::move(in_block.data_ptr) ),
+                 size    (in_block.size)
+            {
+                /* Stub */
+            }
+
+            Block& operator=(Block&& in_block)
+            {
+                data_ptr = std::move(in_block.data_ptr);
+                size     = in_block.size;
+
+                return *this;
+            }
+        } Block;
+
+        typedef struct Destructor
+        {
+            void (*destroy_func_ptr)(void*);
+            void* object_ptr;
+
+            Destructor(void (*in_destroy_func_ptr)(void*),
+                       void*  in_object_ptr)
+                :destroy_func_ptr(in_destroy_func_ptr),
+                 object_ptr      (in_object_ptr)
+            {
+                /* Stub */
+            }
+        } Destructor;
+
+        /* Private functions */
+        void* allocate(size_t in_size,
+                       size_t in_alignment);
+
+        template<typename Type>
+        static void destroy(void* in_object_ptr)
+        {
+            static_cast<Type*>(in_object_ptr)->~Type();
+        }
+
+        template<typename Type>
+        void register_destructor(Type* in_object_ptr)
+        {
+            if (!std::is_trivially_destructible<Type>::value)
+            {
+                m_destructors.push_back(Destructor(&CommandStash::destroy<Type>,
+                                                   in_object_ptr) );
+            }
+        }
+
+        /* Private variables */
+        std::vector<Block>           m_blocks;
+        size_t                       m_block_size;
+        std::vector<Anvil::Command*> m_command_ptrs;
+        size_t                       m_current_block_offset;
+        uint32_t                     m_n_current_block;
+        std::vector<Destructor>      m_destructors;
+
+        ANVIL_DISABLE_ASSIGNMENT_OPERATOR(CommandStash);
+        ANVIL_DISABLE_COPY_CONSTRUCTOR   (CommandStash);
+    };
+}; /* namespace Anvil */
+
+#endif /* MISC_COMMAND_STASH_H */
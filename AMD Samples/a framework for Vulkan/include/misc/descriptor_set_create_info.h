@@ -164,6 +164,15 @@ namespace Anvil
                                                     bool*                          out_opt_immutable_samplers_enabled_ptr = nullptr,
                                                     Anvil::DescriptorBindingFlags* out_opt_flags_ptr                      = nullptr) const;
 
+        /** Returns a hash of the layout configuration. Two instances which compare equal always share the same hash.
+         *
+         *  The hash is updated whenever the configuration changes, so retrieving it is cheap.
+         **/
+        size_t get_hash() const
+        {
+            return m_hash;
+        }
+
         /** Returns the number of bindings defined for the layout. */
         uint32_t get_n_bindings() const
         {
@@ -242,8 +251,11 @@ namespace Anvil
         /* Please see create() documentation for more details */
         DescriptorSetCreateInfo();
 
+        void update_hash();
+
         /* Private variables */
         BindingIndexToBindingMap m_bindings;
+        size_t                   m_hash;
 
         uint32_t                 m_n_variable_descriptor_count_binding;
         uint32_t                 m_variable_descriptor_count_binding_size;
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Dirty-state transitions of descriptor set binding items.
+ *
+ * DescriptorSet marks a binding item dirty whenever it is assigned a different descriptor. Update paths skip bindings
+ * whose items are all clean, and mark all items clean once the Vulkan update has been issued. The functions below
+ * hold that bookkeeping. They are templates over the binding item type, which only needs to expose "dirty" and
+ * "type_vk" fields, so that the transitions can be exercised without a device.
+ **/
+#ifndef MISC_DESCRIPTOR_SET_DIRTY_STATE_H
+#define MISC_DESCRIPTOR_SET_DIRTY_STATE_H
+
+#include "misc/types.h"
+#include <vector>
+
+namespace Anvil
+{
+    namespace DescriptorSetDirtyState
+    {
+        /** Tells if all array items of a binding have been written and have not changed since.
+         *
+         *  @param in_binding_item_ptrs Binding items of a single binding. Null items have never been set.
+         *
+         *  @return true if the binding has at least one item and none of its items is null or dirty, false otherwise.
+         **/
+        template<typename BindingItemPtrs>
+        bool is_binding_clean(const BindingItemPtrs& in_binding_item_ptrs)
+        {
+            bool result = (in_binding_item_ptrs.size() > 0);
+
+            for (const auto& current_binding_item_ptr : in_binding_item_ptrs)
+            {
+                if (current_binding_item_ptr        == nullptr ||
+                    current_binding_item_ptr->dirty)
+                {
+                    result = false;
+
+                    break;
+                }
+            }
+
+            return result;
+        }
+
+        /** Marks all binding items clean, after a core update has written every dirty item.
+         *
+         *  Inline uniform block bindings hold pending updates rather than descriptors. These have now been performed,
+         *  so the items of the listed bindings are dropped.
+         *
+         *  @param inout_binding_ptrs     Binding index -> binding items map.
+         *  @param in_iub_binding_indices Indices of the inline uniform block bindings whose updates have been issued.
+         **/
+        template<typename BindingMap>
+        void on_core_update_issued(BindingMap&                  inout_binding_ptrs,
+                                   const std::vector<uint32_t>& in_iub_binding_indices)
+        {
+            for (auto& current_binding : inout_binding_ptrs)
+            {
+                for (auto& current_binding_item_ptr : current_binding.second)
+                {
+                    if (current_binding_item_ptr != nullptr)
+                    {
+                        current_binding_item_ptr->dirty = false;
+                    }
+                }
+            }
+
+            for (const auto& current_iub_binding_index : in_iub_binding_indices)
+            {
+                inout_binding_ptrs.at(current_iub_binding_index).clear();
+            }
+        }
+
+        /** Marks all binding items clean, after a template update has written every dirty item.
+         *
+         *  Items of inline uniform block bindings are dropped, as for on_core_update_issued().
+         *
+         *  @param inout_binding_ptrs Binding index -> binding items map.
+         **/
+        template<typename BindingMap>
+        void on_template_update_issued(BindingMap& inout_binding_ptrs)
+        {
+            for (auto& current_binding : inout_binding_ptrs)
+            {
+                bool is_iub_binding = false;
+
+                for (auto& current_binding_item_ptr : current_binding.second)
+                {
+                    if (current_binding_item_ptr == nullptr)
+                    {
+                        continue;
+                    }
+
+                    is_iub_binding                 |= (current_binding_item_ptr->type_vk == Anvil::DescriptorType::INLINE_UNIFORM_BLOCK);
+                    current_binding_item_ptr->dirty = false;
+                }
+
+                if (is_iub_binding)
+                {
+                    current_binding.second.clear();
+                }
+            }
+        }
+    }; /* namespace DescriptorSetDirtyState */
+}; /* namespace Anvil */
+
+#endif /* MISC_DESCRIPTOR_SET_DIRTY_STATE_H */
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/* Packs descriptors into a CPU-side payload, which can be passed to vkUpdateDescriptorSetWithTemplateKHR(), and builds
+ * the list of template entries describing the payload's layout.
+ *
+ * Descriptors appended for consecutive array elements of the same binding are folded into a single strided template
+ * entry. This keeps the number of entries (and, in consequence, the number of distinct template objects which need to
+ * be created for a given layout) low, when only a subset of a binding's array elements needs to be updated.
+ *
+ * The class does not use any Vulkan entry-points, so it can be used without a device.
+ **/
+#ifndef MISC_DESCRIPTOR_UPDATE_TEMPLATE_PAYLOAD_H
+#define MISC_DESCRIPTOR_UPDATE_TEMPLATE_PAYLOAD_H
+
+#include "misc/types.h"
+
+namespace Anvil
+{
+    class DescriptorUpdateTemplatePayload
+    {
+    public:
+        /* Public functions */
+
+        /** Constructor. */
+        DescriptorUpdateTemplatePayload();
+
+        /** Reserves space for a new descriptor at the end of the payload.
+         *
+         *  @param in_descriptor_type      Type of the descriptor.
+         *  @param in_n_binding            Index of the binding the descriptor is going to be written to.
+         *  @param in_n_array_element      Index of the binding's array element the descriptor is going to be written to.
+         *  @param in_descriptor_size      Size of the descriptor's payload, in bytes. Must not be 0.
+         *  @param in_can_be_merged        True if the descriptor may share a template entry with the previously appended
+         *                                 descriptor, false if it requires an entry of its own.
+         *
+         *  @return Pointer to the descriptor's storage, which should be filled by the caller. The pointer is only valid
+         *          until the next append() or clear() call.
+         **/
+        void* append(Anvil::DescriptorType in_descriptor_type,
+                     uint32_t              in_n_binding,
+                     uint32_t              in_n_array_element,
+                     size_t                in_descriptor_size,
+                     bool                  in_can_be_merged = true);
+
+        /** Drops all appended descriptors & entries. Does not release the underlying storage. */
+        void clear();
+
+        /** Returns a pointer to the packed payload, or nullptr if no descriptors have been appended. */
+        const void* get_data() const
+        {
+            return (m_data.size() > 0) ? &m_data.at(0)
+                                       : nullptr;
+        }
+
+        /** Returns the size of the packed payload, in bytes. */
+        size_t get_data_size() const
+        {
+            return m_data.size();
+        }
+
+        /** Returns template entries describing the packed payload. */
+        const std::vector<Anvil::DescriptorUpdateTemplateEntry>& get_entries() const
+        {
+            return m_entries;
+        }
+
+        /** Tells whether any descriptors have been appended since construction time or the last clear() call. */
+        bool is_empty() const
+        {
+            return m_entries.empty();
+        }
+
+    private:
+        /* Private variables */
+        std::vector<uint8_t>                              m_data;
+        std::vector<Anvil::DescriptorUpdateTemplateEntry> m_entries;
+        bool                                              m_last_entry_can_be_merged;
+
+        ANVIL_DISABLE_ASSIGNMENT_OPERATOR(DescriptorUpdateTemplatePayload);
+        ANVIL_DISABLE_COPY_CONSTRUCTOR   (DescriptorUpdateTemplatePayload);
+    };
+}; /* namespace Anvil */
+
+#endif /* MISC_DESCRIPTOR_UPDATE_TEMPLATE_PAYLOAD_H */
@@ -131,6 +131,40 @@ namespace Anvil
 
     namespace Utils
     {
+        /** Converts an array of FP16 values to FP32.
+         *
+         *  The conversion is exact. NaNs are quieted, but keep their sign and payload.
+         *
+         *  Uses F16C, SSE2 or NEON instructions, depending on what the build targets and the running CPU supports.
+         *  All code paths return the same bits, regardless of the FTZ/DAZ settings of the calling thread.
+         *
+         *  @param in_fp16_values_ptr  Values to convert. Must not be nullptr, unless @param in_n_values is 0.
+         *  @param in_n_values         Number of values to convert.
+         *  @param out_fp32_values_ptr Deref will be filled with @param in_n_values converted values. Must not overlap
+         *                             with @param in_fp16_values_ptr.
+         **/
+        void fp16_to_fp32_array(const float16_t* in_fp16_values_ptr,
+                                size_t           in_n_values,
+                                float32_t*       out_fp32_values_ptr);
+
+        /** Converts an array of FP32 values to FP16, rounding to nearest even.
+         *
+         *  Values which do not fit in FP16 become infinities. Values which are too small become FP16 denormals
+         *  or zeros. NaNs are quieted, but keep their sign and the most significant bits of their payload.
+         *  Apart from NaNs, results match fp32_to_fp16_full_rtne().
+         *
+         *  Uses F16C, SSE2 or NEON instructions, depending on what the build targets and the running CPU supports.
+         *  All code paths return the same bits, regardless of the FTZ/DAZ settings of the calling thread.
+         *
+         *  @param in_fp32_values_ptr  Values to convert. Must not be nullptr, unless @param in_n_values is 0.
+         *  @param in_n_values         Number of values to convert.
+         *  @param out_fp16_values_ptr Deref will be filled with @param in_n_values converted values. Must not overlap
+         *                             with @param in_fp32_values_ptr.
+         **/
+        void fp32_to_fp16_array_rtne(const float32_t* in_fp32_values_ptr,
+                                     size_t           in_n_values,
+                                     float16_t*       out_fp16_values_ptr);
+
         float32_t fp16_to_fp32_fast      (float16_t in_h);
         float32_t fp16_to_fp32_fast2     (float16_t in_h);
         float32_t fp16_to_fp32_fast3     (float16_t in_h);
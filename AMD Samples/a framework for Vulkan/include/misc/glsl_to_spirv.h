@@ -254,6 +254,29 @@ namespace Anvil
           **/
          bool bake_spirv_blob() const;
 
+         /** Bakes SPIR-V blobs for multiple generators at once, spreading the work across worker threads.
+          *
+          *  Each generator is processed exactly as if bake_spirv_blob() was called for it, which includes
+          *  looking up and updating the generator's SPIR-V disk cache, if one has been assigned. Generators
+          *  whose blobs have already been baked are skipped.
+          *
+          *  Call-backs of the generators are issued from the worker threads.
+          *
+          *  This function is NOT supported if ANVIL_LINK_WITH_GLSLANG macro is undefined, in which case the blobs
+          *  are baked one after another on the calling thread, since glslangvalidator processes share temporary
+          *  files.
+          *
+          *  @param in_generator_ptrs    Generators to bake SPIR-V blobs for. A generator must not be listed more
+          *                              than once, and none of the generators may be used by other threads until
+          *                              the function returns.
+          *  @param in_n_worker_threads  Maximum number of worker threads to use. 0 selects the number of hardware
+          *                              threads available.
+          *
+          *  @return true if all blobs have been baked successfully, false otherwise.
+          **/
+         static bool bake_spirv_blobs(const std::vector<const GLSLShaderToSPIRVGenerator*>& in_generator_ptrs,
+                                      uint32_t                                              in_n_worker_threads = 0);
+
          /* Converts a ExtensionBehavior enum value to a corresponding GLSL definition */
          std::string get_extension_behavior_glsl_code(const ExtensionBehavior& in_value) const;
 
@@ -311,6 +334,19 @@ namespace Anvil
              return m_glsl_source_code;
          }
 
+         /** Returns the SPIR-V disk cache assigned to the generator, or nullptr if none has been assigned. */
+         Anvil::SPIRVDiskCache* get_spirv_disk_cache() const
+         {
+             return m_spirv_disk_cache_ptr;
+         }
+
+         /** Returns the key under which the generator's SPIR-V blob is looked up in, and stored to, a SPIR-V disk
+          *  cache. See set_spirv_disk_cache() for the list of properties the key covers.
+          *
+          *  Can be used to populate a cache with blobs which have been baked elsewhere.
+          **/
+         std::string get_spirv_disk_cache_key() const;
+
          /** Tells what shader stage the encapsulated GLSL shader descirbes. */
          ShaderStage get_shader_stage() const
          {
@@ -346,6 +382,24 @@ namespace Anvil
              return static_cast<uint32_t>(m_spirv_blob.size() );
          }
 
+         /** Assigns a persistent SPIR-V cache to the generator.
+          *
+          *  When baking a SPIR-V blob, the generator first looks the blob up in the cache. Blobs which
+          *  had to be compiled are stored in the cache, so that subsequent application runs can skip
+          *  the compilation.
+          *
+          *  The cache key covers the final GLSL source code (with all definitions, extension behaviors,
+          *  pragmas and placeholder values already applied), the shader stage, the target SPIR-V version,
+          *  as well as the compiler version and limits.
+          *
+          *  @param in_opt_spirv_disk_cache_ptr Cache to use, or nullptr to disable disk caching. The cache must
+          *                                     outlive the generator. Multiple generators may share the same cache.
+          **/
+         void set_spirv_disk_cache(Anvil::SPIRVDiskCache* in_opt_spirv_disk_cache_ptr)
+         {
+             m_spirv_disk_cache_ptr = in_opt_spirv_disk_cache_ptr;
+         }
+
     private:
         /* Private type declarations */
         typedef std::map<std::string, ExtensionBehavior>         ExtensionNameToExtensionBehaviorMap;
@@ -363,7 +417,7 @@ namespace Anvil
                                             ShaderStage              in_shader_stage,
                                             SpvVersion               in_spirv_version);
 
-        bool bake_glsl_source_code() const;
+        bool        bake_glsl_source_code    () const;
 
         #ifdef ANVIL_LINK_WITH_GLSLANG
             bool        bake_spirv_blob_by_calling_glslang(const char* in_body) const;
@@ -391,6 +445,7 @@ namespace Anvil
         ShaderStage               m_shader_stage;
         SpvVersion                m_spirv_version;
         mutable std::vector<char> m_spirv_blob;
+        Anvil::SPIRVDiskCache*    m_spirv_disk_cache_ptr;
 
         DefinitionNameToValueMap            m_definition_values;
         ExtensionNameToExtensionBehaviorMap m_extension_behaviors;
@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Implements a memory allocator backend which sub-allocates memory regions from large memory blocks ("pages"),
+ * using a two-level segregated fit allocator (see TLSFHeap). Allocations and releases take constant time, and
+ * memory regions are returned to the backend as soon as the memory blocks they have been assigned to go out of scope.
+ *
+ * Each combination of memory type, device mask and memory priority uses a separate heap. If the device reports a
+ * buffer-image granularity larger than 1, linear and non-linear resources also use separate heaps, so that they
+ * never share a granularity-sized region of a page.
+ *
+ * Dedicated allocations and allocations with exportable external handles are assigned memory blocks of their own.
+ *
+ * This class should only be used internally by MemoryAllocator.
+ **/
+#ifndef MISC_MEMORY_ALLOCATOR_BACKEND_TLSF_H
+#define MISC_MEMORY_ALLOCATOR_BACKEND_TLSF_H
+
+#include "misc/types.h"
+#include "misc/memory_allocator.h"
+#include "misc/memalloc_backends/tlsf_heap.h"
+#include <mutex>
+
+namespace Anvil
+{
+    namespace MemoryAllocatorBackends
+    {
+        /* TLSF memory allocator backend implementation.
+         *
+         * Should only be used by Anvil::MemoryAllocator
+         */
+        class TLSF : public Anvil::MemoryAllocator::IMemoryAllocatorBackend,
+                     public std::enable_shared_from_this<TLSF>
+        {
+        public:
+            /* Public functions */
+
+            /** Creates a new TLSF memory allocator backend instance.
+             *
+             *  Should only be used internally by MemoryAllocator.
+             *
+             *  @param in_device_ptr Vulkan device the memory allocations are going to be made for.
+             *  @param in_page_size  Size of the memory blocks to sub-allocate from. Must not be 0.
+             **/
+            TLSF(const Anvil::BaseDevice* in_device_ptr,
+                 VkDeviceSize             in_page_size);
+
+            /** Destructor. */
+            virtual ~TLSF();
+
+        private:
+            /* Private type definitions */
+
+            typedef struct HeapKey
+            {
+                uint32_t device_mask;
+                bool     is_linear;
+                float    memory_priority;
+                uint32_t memory_type_index;
+
+                HeapKey(uint32_t in_memory_type_index,
+                        uint32_t in_device_mask,
+                        float    in_memory_priority,
+                        bool     in_is_linear)
+                    :device_mask      (in_device_mask),
+                     is_linear        (in_is_linear),
+                     memory_priority  (in_memory_priority),
+                     memory_type_index(in_memory_type_index)
+                {
+                    /* Stub */
+                }
+
+                bool operator<(const HeapKey& in_key) const;
+            } HeapKey;
+
+            /** Memory block backing a single TLSF page. */
+            typedef struct Page
+            {
+                Anvil::MemoryBlockUniquePtr memory_block_ptr;
+                void*                       mapped_data_ptr;
+                uint32_t                    n_map_requests;
+
+                explicit Page(Anvil::MemoryBlockUniquePtr in_memory_block_ptr)
+                    :memory_block_ptr(std::move(in_memory_block_ptr) ),
+                     mapped_data_ptr (nullptr),
+                     n_map_requests  (0)
+                {
+                    /* Stub */
+                }
+            } Page;
+
+            /** Allocates memory blocks for the pages of a single TLSF heap. */
+            class PageProvider : public ITLSFPageProvider
+            {
+            public:
+                PageProvider(const Anvil::BaseDevice* in_device_ptr,
+                             const HeapKey&           in_key);
+
+                void* allocate_page(VkDeviceSize in_size) final;
+                void  release_page (void*        in_page_handle) final;
+
+            private:
+                const Anvil::BaseDevice* m_device_ptr;
+                HeapKey                  m_key;
+            };
+
+            typedef struct Heap
+            {
+                std::unique_ptr<PageProvider> page_provider_ptr;
+                std::unique_ptr<TLSFHeap>     tlsf_heap_ptr;
+            } Heap;
+
+            /* IMemoryAllocatorBackend functions */
+
+            bool     bake                            (Anvil::MemoryAllocator::Items&              in_items) final;
+            bool     get_statistics                  (uint32_t                                    in_memory_type_index,
+                                                      Anvil::MemoryAllocatorStatistics*           out_result_ptr)                  const final;
+            VkResult map                             (void*                                       in_memory_object,
+                                                      VkDeviceSize                                in_start_offset,
+                                                      VkDeviceSize                                in_memory_block_start_offset,
+                                                      VkDeviceSize                                in_size,
+                                                      void**                                      out_result_ptr) final;
+            bool     supports_baking                 () const final;
+            bool     supports_device_masks           ()                                                                            const final;
+            bool     supports_external_memory_handles(const Anvil::ExternalMemoryHandleTypeFlags& in_external_memory_handle_types) const final;
+            bool     supports_protected_memory       ()                                                                            const final;
+            void     unmap                           (void*                                       in_memory_object) final;
+
+            /* Private functions */
+            bool bake_dedicated_item     (Anvil::MemoryAllocator::Item*       in_item_ptr,
+                                          uint32_t                            in_memory_type_index);
+            bool bake_sub_allocated_item (Anvil::MemoryAllocator::Item*       in_item_ptr,
+                                          uint32_t                            in_memory_type_index);
+            bool get_memory_type_index   (const Anvil::MemoryAllocator::Item* in_item_ptr,
+                                          uint32_t*                           out_memory_type_index_ptr) const;
+            void on_memory_block_released(Anvil::MemoryBlock*                 in_memory_block_ptr,
+                                          HeapKey                             in_key,
+                                          void*                               in_block_handle);
+
+            /* Private variables */
+            VkDeviceSize             m_buffer_image_granularity;
+            const Anvil::BaseDevice* m_device_ptr;
+            std::map<HeapKey, Heap>  m_heaps;
+            mutable std::mutex       m_mutex;
+            VkDeviceSize             m_page_size;
+
+            ANVIL_DISABLE_ASSIGNMENT_OPERATOR(TLSF);
+            ANVIL_DISABLE_COPY_CONSTRUCTOR   (TLSF);
+        };
+    };
+};
+
+#endif /* MISC_MEMORY_ALLOCATOR_BACKEND_TLSF_H */
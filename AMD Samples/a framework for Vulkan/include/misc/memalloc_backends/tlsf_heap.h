@@ -0,0 +1,211 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Implements a two-level segregated fit (TLSF) allocator which sub-allocates address ranges from large pages.
+ *
+ * Free ranges are kept in size-segregated lists. The first level splits sizes into power-of-two classes, the second
+ * level splits each class into 2^SECOND_LEVEL_INDEX_LOG2 linear sub-ranges. Two bitmaps tell which lists are non-empty,
+ * so that a suitable free range is located with a couple of bit scans, regardless of the number of live allocations.
+ * Physically adjacent free ranges are merged as soon as they are released.
+ *
+ * The heap does not touch the memory it manages. Pages are requested from, and returned to, an ITLSFPageProvider
+ * instance, which makes it possible to exercise the allocator without a Vulkan device.
+ *
+ * TLSFHeap is NOT thread-safe.
+ **/
+#ifndef MISC_MEMORY_ALLOCATOR_BACKEND_TLSF_HEAP_H
+#define MISC_MEMORY_ALLOCATOR_BACKEND_TLSF_HEAP_H
+
+#include "misc/types.h"
+
+namespace Anvil
+{
+    namespace MemoryAllocatorBackends
+    {
+        /** Interface of an entity which hands out pages to TLSFHeap instances. */
+        class ITLSFPageProvider
+        {
+        public:
+            virtual ~ITLSFPageProvider()
+            {
+                /* Stub */
+            }
+
+            /** Allocates a new page.
+             *
+             *  @param in_size Size of the page, in bytes.
+             *
+             *  @return Opaque handle of the new page, or nullptr if the page could not be allocated.
+             **/
+            virtual void* allocate_page(VkDeviceSize in_size) = 0;
+
+            /** Releases a page previously returned by allocate_page(). */
+            virtual void release_page(void* in_page_handle) = 0;
+        };
+
+        class TLSFHeap
+        {
+        public:
+            /* Public type definitions */
+
+            /** Describes a range handed out by TLSFHeap::allocate(). */
+            typedef struct Allocation
+            {
+                void*        block_handle; /* Pass to TLSFHeap::free() to release the range */
+                VkDeviceSize offset;       /* Start offset of the range, relative to the start of the page */
+                void*        page_handle;  /* As returned by ITLSFPageProvider::allocate_page() */
+                VkDeviceSize size;
+
+                Allocation()
+                    :block_handle(nullptr),
+                     offset      (0),
+                     page_handle (nullptr),
+                     size        (0)
+                {
+                    /* Stub */
+                }
+            } Allocation;
+
+            /* Public functions */
+
+            /** Constructor. Does not allocate any pages.
+             *
+             *  @param in_page_provider_ptr Provider to request pages from. Must not be nullptr. Must outlive the heap.
+             *  @param in_page_size         Size of the pages to request. Requests which do not fit in a page of this size
+             *                              are given dedicated pages.
+             **/
+            TLSFHeap(ITLSFPageProvider* in_page_provider_ptr,
+                     VkDeviceSize       in_page_size);
+
+            /** Destructor. Returns all pages to the page provider.
+             *
+             *  All allocations should have been released by the time the heap is destroyed.
+             **/
+            ~TLSFHeap();
+
+            /** Sub-allocates a range of @param in_size bytes, whose start offset is a multiple of @param in_alignment.
+             *
+             *  Requests a new page from the page provider if none of the existing pages can hold the range.
+             *
+             *  @param in_size        Number of bytes to allocate. Must not be 0.
+             *  @param in_alignment   Required alignment of the start offset. Must be a power of two.
+             *  @param out_result_ptr Deref will be set to the allocation details. Must not be nullptr.
+             *
+             *  @return true if successful, false if the page provider failed to allocate a new page.
+             **/
+            bool allocate(VkDeviceSize in_size,
+                          VkDeviceSize in_alignment,
+                          Allocation*  out_result_ptr);
+
+            /** Releases a range previously handed out by allocate().
+             *
+             *  Pages which become empty are returned to the page provider, except for one page which is kept around,
+             *  so that a heap whose usage oscillates around a page boundary does not keep reallocating it.
+             *
+             *  @param in_block_handle Allocation::block_handle of the range to release.
+             **/
+            void free(void* in_block_handle);
+
+            /** Fills @param out_result_ptr with current usage & fragmentation statistics of the heap.
+             *
+             *  Cost is linear in the number of free ranges.
+             **/
+            void get_statistics(Anvil::MemoryAllocatorStatistics* out_result_ptr) const;
+
+            /** Tells whether the heap currently holds any pages. */
+            bool has_pages() const
+            {
+                return !m_page_ptrs.empty();
+            }
+
+        private:
+            /* Private type definitions */
+            enum
+            {
+                SECOND_LEVEL_INDEX_LOG2 = 5,
+                SECOND_LEVEL_COUNT      = 1 << SECOND_LEVEL_INDEX_LOG2,
+                FIRST_LEVEL_COUNT       = 64 - SECOND_LEVEL_INDEX_LOG2 + 1
+            };
+
+            struct Page;
+
+            typedef struct Block
+            {
+                VkDeviceSize offset;
+                Page*        page_ptr;
+                VkDeviceSize size;
+
+                bool   is_free;
+                Block* next_free_block_ptr;
+                Block* next_physical_block_ptr;
+                Block* prev_free_block_ptr;
+                Block* prev_physical_block_ptr;
+            } Block;
+
+            typedef struct Page
+            {
+                Block*       first_block_ptr;
+                void*        handle;
+                bool         is_dedicated;
+                uint32_t     n_allocations;
+                VkDeviceSize size;
+            } Page;
+
+            /* Private functions */
+            Block* acquire_block_descriptor();
+            Page*  allocate_page           (VkDeviceSize in_size,
+                                            bool         in_is_dedicated);
+            bool   fits                    (const Block* in_block_ptr,
+                                            VkDeviceSize in_size,
+                                            VkDeviceSize in_alignment) const;
+            Block* find_free_block         (VkDeviceSize in_size);
+            void   insert_free_block       (Block*       in_block_ptr);
+            void   release_block_descriptor(Block*       in_block_ptr);
+            void   release_page            (Page*        in_page_ptr);
+            void   remove_free_block       (Block*       in_block_ptr);
+            Block* split_block             (Block*       in_block_ptr,
+                                            VkDeviceSize in_size);
+
+            static void get_list_indices(VkDeviceSize in_size,
+                                         uint32_t*    out_first_level_index_ptr,
+                                         uint32_t*    out_second_level_index_ptr);
+
+            /* Private variables */
+            Page*               m_empty_page_ptr;
+            uint64_t            m_first_level_bitmap;
+            Block*              m_free_lists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+            uint32_t            m_n_allocations;
+            VkDeviceSize        m_n_bytes_allocated;
+            VkDeviceSize        m_n_bytes_reserved;
+            ITLSFPageProvider*  m_page_provider_ptr;
+            std::vector<Page*>  m_page_ptrs;
+            VkDeviceSize        m_page_size;
+            uint32_t            m_second_level_bitmaps[FIRST_LEVEL_COUNT];
+            std::vector<Block*> m_spare_block_ptrs;
+
+            ANVIL_DISABLE_ASSIGNMENT_OPERATOR(TLSFHeap);
+            ANVIL_DISABLE_COPY_CONSTRUCTOR   (TLSFHeap);
+        };
+    };
+}; /* namespace Anvil */
+
+#endif /* MISC_MEMORY_ALLOCATOR_BACKEND_TLSF_HEAP_H */
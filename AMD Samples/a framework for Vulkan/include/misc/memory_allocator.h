@@ -225,6 +225,16 @@ namespace Anvil
             virtual bool supports_device_masks           ()                                                                            const = 0;
             virtual bool supports_external_memory_handles(const Anvil::ExternalMemoryHandleTypeFlags& in_external_memory_handle_types) const = 0;
             virtual bool supports_protected_memory       ()                                                                            const = 0;
+
+            /** Backends which do not sub-allocate memory have no statistics to report. */
+            virtual bool get_statistics(uint32_t                          in_memory_type_index,
+                                        Anvil::MemoryAllocatorStatistics* out_result_ptr) const
+            {
+                ANVIL_REDUNDANT_ARGUMENT_CONST(in_memory_type_index);
+                ANVIL_REDUNDANT_ARGUMENT_CONST(out_result_ptr);
+
+                return false;
+            }
         };
 
         /* Public functions */
@@ -521,11 +531,33 @@ namespace Anvil
         static Anvil::MemoryAllocatorUniquePtr create_vma(const Anvil::BaseDevice* in_device_ptr,
                                                           MTSafety                 in_mt_safety = Anvil::MTSafety::INHERIT_FROM_PARENT_DEVICE);
 
+        /** Creates a new TLSF memory allocator instance.
+         *
+         *  This type of allocator supports an arbitrary number of implicit or explicit bake invocations.
+         *  Memory regions are sub-allocated from memory blocks of @param in_page_size bytes, and are returned
+         *  to the allocator as soon as the memory blocks wrapping them go out of scope.
+         *
+         *  @param in_device_ptr Device to use.
+         *  @param in_mt_safety  MT safety of the allocator.
+         *  @param in_page_size  Size of the memory blocks to sub-allocate from. Objects which do not fit in
+         *                       a memory block of this size are assigned memory blocks of their own.
+         **/
+        static Anvil::MemoryAllocatorUniquePtr create_tlsf(const Anvil::BaseDevice* in_device_ptr,
+                                                           MTSafety                 in_mt_safety = Anvil::MTSafety::INHERIT_FROM_PARENT_DEVICE,
+                                                           VkDeviceSize             in_page_size = 64 * 1024 * 1024);
+
         static bool get_mem_types_supporting_mem_features(const Anvil::BaseDevice*         in_device_ptr,
                                                           uint32_t                         in_memory_types,
                                                           const Anvil::MemoryFeatureFlags& in_memory_features,
                                                           uint32_t*                        out_opt_filtered_memory_types_ptr);
 
+        /** Retrieves usage & fragmentation statistics of memory sub-allocated for memory type @param in_memory_type_index.
+         *
+         *  @return true if successful, false if the backend used by the allocator does not sub-allocate memory.
+         **/
+        bool get_statistics(uint32_t                          in_memory_type_index,
+                            Anvil::MemoryAllocatorStatistics* out_result_ptr) const;
+
         /** By default, once memory regions are baked, memory allocator will bind them to objects specified
          *  at add_*() call time. Use cases exist where apps may prefer to handle this action on their own.
          *
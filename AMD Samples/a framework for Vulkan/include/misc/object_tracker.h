@@ -32,14 +32,20 @@
  *  ObjectTracker::check_for_leaks() to determine, if there are any wrapper objects alive. If so,
  *  brief info on each such instance will be printed out to stdout.
  *
- *  Object Tracker is thread-safe.
+ *  Object Tracker is thread-safe. Objects are stored in separate shards for each object type, so that threads
+ *  creating or releasing objects of different types do not contend for the same lock. Per-type counters are atomic
+ *  and can be read without taking any lock.
  **/
 #ifndef MISC_OBJECT_TRACKER_H
 #define MISC_OBJECT_TRACKER_H
 
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include "misc/callbacks.h"
+#include "misc/time.h"
 #include "misc/types.h"
 
 namespace Anvil
@@ -108,6 +114,29 @@ namespace Anvil
     class ObjectTracker : public CallbacksSupportProvider
     {
     public:
+        /* Public type declarations */
+
+        /** Describes alive objects of a single type. Returned by get_snapshot(). */
+        typedef struct TypeSnapshot
+        {
+            std::vector<void*> alive_object_ptrs;  /* Only filled if requested at get_snapshot() call time */
+            double             creation_rate;      /* Objects created per second since the previous get_snapshot() call */
+            uint32_t           n_alive_objects;
+            uint64_t           n_created_objects;  /* Total number of objects created since the tracker was instantiated */
+            ObjectType         object_type;
+            const char*        object_type_name;
+
+            TypeSnapshot()
+                :creation_rate    (0.0),
+                 n_alive_objects  (0),
+                 n_created_objects(0),
+                 object_type      (ObjectType::UNKNOWN),
+                 object_type_name (nullptr)
+            {
+                /* Stub */
+            }
+        } TypeSnapshot;
+
         /* Public functions */
 
         /** Destroys the ObjectTracker singleton, no matter how many preceding get() calls have been made. */
@@ -126,10 +155,43 @@ namespace Anvil
          **/
         void check_for_leaks() const;
 
-        /** Retrieves an alive object of user-specified type at given index. */
+        /** Calls @param in_visitor_func for every alive object of the specified type, in the order they were
+         *  registered, until the visitor returns false.
+         *
+         *  Use this instead of get_object_at_index() to visit every object of a type. The visitor is called with
+         *  the type's lock held, so objects registered or unregistered meanwhile cannot make the iteration skip or
+         *  repeat other objects. Objects unregister themselves before they are released, so the visited objects
+         *  cannot be destroyed by other threads while the visitor accesses them either. The visitor must not
+         *  register or unregister objects of the same type.
+         *
+         *  @param in_object_type  Wrapper object type.
+         *  @param in_visitor_func Function to call for each object. Return false to stop the iteration.
+         **/
+        void visit_alive_objects(const ObjectType&                 in_object_type,
+                                 std::function<bool(const void*)>  in_visitor_func) const;
+
+        /** Returns the number of alive objects of the specified type. Does not take any lock. */
+        uint32_t get_n_alive_objects(const ObjectType& in_object_type) const;
+
+        /** Retrieves an alive object of user-specified type at given index.
+         *
+         *  NOTE: Indices of alive objects change as other objects of the same type are unregistered. Use
+         *        visit_alive_objects() to iterate over all objects of a type.
+         **/
         void* get_object_at_index(const ObjectType& in_object_type,
                                   uint32_t          in_alloc_index) const;
 
+        /** Reports the number of alive & created objects, as well as object creation rates, for all object types
+         *  for which at least one object has been registered.
+         *
+         *  Each call resets the reference point creation rates are calculated against.
+         *
+         *  @param in_include_object_ptrs true to also report pointers to all alive objects.
+         *  @param out_snapshot_ptr       Deref will be filled with one item per object type. Must not be nullptr.
+         **/
+        void get_snapshot(bool                       in_include_object_ptrs,
+                          std::vector<TypeSnapshot>* out_snapshot_ptr) const;
+
         /** Registers a new object of the specified type.
          *
          *  @param in_object_type Wrapper object type.
@@ -152,20 +214,17 @@ namespace Anvil
 
     private:
         /* Private type declarations */
-        typedef uint64_t ObjectVkHandle;
+        enum
+        {
+            /* One shard per Anvil::ObjectType value, including UNKNOWN */
+            N_SHARDS = 38
+        };
 
         typedef struct ObjectAllocation
         {
             uint32_t n_allocation;
             void*    object_ptr;
 
-            /** Dummy constructor. Should only be used by STL */
-            ObjectAllocation()
-            {
-                n_allocation = UINT32_MAX;
-                object_ptr   = nullptr;
-            }
-
             /** Constructor.
              *
              *  @param in_n_allocation Index of the memory allocation.
@@ -177,28 +236,42 @@ namespace Anvil
                 n_allocation = in_n_allocation;
                 object_ptr   = in_object_ptr;
             }
-
-            /** Comparator. Will return true if the wrapped pointer matches @param in_object_ptr. */
-            bool operator==(const void* in_object_ptr) const
-            {
-                return object_ptr == in_object_ptr;
-            }
         } ObjectAllocation;
 
         typedef std::vector<ObjectAllocation> ObjectAllocations;
 
+        /** Holds all objects of a single type.
+         *
+         *  Each object remembers the index of the slot it occupies, so that it can be unregistered by moving the last
+         *  object of the shard to its slot, instead of searching & erasing.
+         **/
+        typedef struct Shard
+        {
+            ObjectAllocations                   allocations;
+            mutable std::mutex                  cs;
+            std::atomic<uint32_t>               n_alive_objects;
+            std::atomic<uint32_t>               n_created_objects;
+            mutable uint64_t                    n_created_objects_at_last_snapshot; /* Guarded by m_snapshot_cs */
+            std::unordered_map<void*, uint32_t> object_ptr_to_slot_index_map;
+            ObjectType                          object_type;
+        } Shard;
+
         /* Private functions */
         ObjectTracker           ();
         ObjectTracker           (const ObjectTracker&);
         ObjectTracker& operator=(const ObjectTracker&);
 
-        const char* get_object_type_name(const ObjectType& in_object_type) const;
+        const char*  get_object_type_name(const ObjectType& in_object_type) const;
+        Shard&       get_shard           (const ObjectType& in_object_type);
+        const Shard& get_shard           (const ObjectType& in_object_type) const;
 
-        /* Private members */
-        mutable std::mutex m_cs;
+        static uint32_t get_shard_index(const ObjectType& in_object_type);
 
-        mutable std::map<Anvil::ObjectType, ObjectAllocations>  m_object_allocations;
-        std::map<Anvil::ObjectType, uint32_t>                   m_n_objects_allocated_array;
+        /* Private members */
+        mutable uint64_t    m_last_snapshot_time_msec; /* Guarded by m_snapshot_cs */
+        Shard               m_shards[N_SHARDS];
+        mutable std::mutex  m_snapshot_cs;
+        mutable Anvil::Time m_time;
     };
 }; /* namespace Anvil */
 
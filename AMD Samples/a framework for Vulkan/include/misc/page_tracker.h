@@ -24,14 +24,44 @@
 #define MISC_PAGE_TRACKER_H
 
 #include "misc/types.h"
+#include <memory>
 
 
 namespace Anvil
 {
-    /** Tracks memory page bindings for sparse images & sparse buffers */
+    /** Tracks memory page bindings for sparse images & sparse buffers.
+     *
+     *  Bindings are stored per page in a two-level radix table. The first level holds one pointer per
+     *  2^PAGES_PER_LEAF_LOG2 pages, the second level ("leaves") holds the actual per-page bindings. Leaves are
+     *  only allocated for page ranges with at least one memory-backed page, so sparsely-populated resources
+     *  with huge virtual address ranges stay cheap. Looking up or updating a single page takes constant time,
+     *  regardless of how many bindings have been made.
+     *
+     *  PageTracker is NOT thread-safe.
+     **/
     class PageTracker
     {
     public:
+        /* Public type definitions */
+
+        /** Describes a single page binding update. Used by set_page_bindings(). */
+        typedef struct PageBindingUpdate
+        {
+            MemoryBlock* memory_block_ptr;          /* May be null, in which case the page loses its memory backing */
+            VkDeviceSize memory_block_start_offset; /* Ignored if memory_block_ptr is null */
+            uint32_t     n_page;
+
+            PageBindingUpdate(uint32_t     in_n_page,
+                              MemoryBlock* in_memory_block_ptr,
+                              VkDeviceSize in_memory_block_start_offset)
+                :memory_block_ptr         (in_memory_block_ptr),
+                 memory_block_start_offset(in_memory_block_start_offset),
+                 n_page                   (in_n_page)
+            {
+                /* Stub */
+            }
+        } PageBindingUpdate;
+
         /* Public functions */
 
         /** Constructor.
@@ -42,6 +72,9 @@ namespace Anvil
         explicit PageTracker(VkDeviceSize in_region_size,
                              VkDeviceSize in_page_size);
 
+        /** Destructor. */
+        ~PageTracker();
+
         /** Retrieves a memory block assigned to the region <in_start_offset, in_start_offset + in_size>.
          *
          *  NOTE: in_size must not be larger than page size of the memory block.
@@ -49,8 +82,8 @@ namespace Anvil
          *        more than one memory block to a sparsely-bound buffer / image.
          *
          *  @param in_start_offset                    Start offset of the page..
-         *  @param out_memory_region_start_offset_ptr Deref will be set to the start offset, which corresponds to @param in_start_offset
-         *                                            from the returned memory object's PoV. Must not be NULL.
+         *  @param out_memory_region_start_offset_ptr Deref will be set to the offset, relative to the returned memory block's
+         *                                            start offset, which @param in_start_offset is backed by. Must not be NULL.
          *
          *  @return Memory block instance bound to the specified page OR null, if no memory block has been assigned to the memory region.
          */
@@ -64,6 +97,9 @@ namespace Anvil
          *  This function can be used to retrieve a memory block, bound to a descriptor
          *  at a given index (@param in_n_memory_block).
          *
+         *  NOTE: Descriptors are rebuilt on first access after bindings have changed, at a cost
+         *        linear in the number of allocated leaves.
+         *
          *  @param in_n_memory_block See above. Must not be equal or larger than value returned
          *                           by get_n_memory_blocks().
          *
@@ -71,6 +107,8 @@ namespace Anvil
          */
         Anvil::MemoryBlock* get_memory_block(uint32_t in_n_memory_block) const
         {
+            update_memory_blocks();
+
             anvil_assert(in_n_memory_block < m_memory_blocks.size() );
 
             return m_memory_blocks.at(in_n_memory_block).memory_block_ptr;
@@ -79,6 +117,8 @@ namespace Anvil
         /** Returns the number of disjoint memory blocks */
         uint32_t get_n_memory_blocks() const
         {
+            update_memory_blocks();
+
             return static_cast<uint32_t>(m_memory_blocks.size() );
         }
 
@@ -119,8 +159,34 @@ namespace Anvil
                          VkDeviceSize in_start_offset,
                          VkDeviceSize in_size);
 
+        /** Applies a batch of per-page binding updates and, optionally, converts the changes into the smallest
+         *  set of VkSparseMemoryBind ranges which need to be submitted to a sparse binding queue.
+         *
+         *  Updates may be specified in any order. If more than one update refers to the same page, the one which
+         *  comes last in @param in_updates wins. Updates which do not change the page's current binding are dropped.
+         *  Runs of adjacent pages bound to contiguous regions of the same device memory object (or all unbound)
+         *  are merged into a single range.
+         *
+         *  @param in_updates                      Updates to apply.
+         *  @param out_opt_sparse_memory_binds_ptr If not null, deref will be filled with ranges describing the changes,
+         *                                         sorted by resource offset. Resource offsets are relative to the start
+         *                                         of the tracked memory region. Memory offsets include the memory blocks'
+         *                                         start offsets.
+         *
+         *  @return true if successful, false if any of the updates referred to a page outside the tracked region.
+         *          In the latter case, no updates are applied.
+         **/
+        bool set_page_bindings(const std::vector<PageBindingUpdate>& in_updates,
+                               std::vector<VkSparseMemoryBind>*      out_opt_sparse_memory_binds_ptr);
+
     private:
         /* Private type definitions */
+        enum
+        {
+            PAGES_PER_LEAF_LOG2 = 10,
+            PAGES_PER_LEAF      = 1 << PAGES_PER_LEAF_LOG2
+        };
+
         typedef struct MemoryBlockBinding
         {
             MemoryBlock* memory_block_ptr;
@@ -140,16 +206,37 @@ namespace Anvil
             }
         } MemoryBlockBinding;
 
+        typedef struct PageBinding
+        {
+            MemoryBlock* memory_block_ptr;
+            VkDeviceSize memory_block_start_offset;
+        } PageBinding;
+
+        typedef struct Leaf
+        {
+            uint32_t    n_pages_with_memory_backing;
+            PageBinding pages[PAGES_PER_LEAF];
+        } Leaf;
+
         /* Private functions */
+        const PageBinding* get_page_binding    (uint32_t     in_n_page) const;
+        VkDeviceSize       get_page_size       (uint32_t     in_n_page) const;
+        bool               set_page_binding    (uint32_t     in_n_page,
+                                                MemoryBlock* in_memory_block_ptr,
+                                                VkDeviceSize in_memory_block_start_offset);
+        void               update_memory_blocks() const;
 
         /* Private variables */
-        std::vector<MemoryBlockBinding>  m_memory_blocks;
-        uint32_t                         m_n_memory_blocks_with_memory_backing;
-        uint32_t                         m_n_pages_with_memory_backing;
-        uint32_t                         m_n_total_pages;
-        VkDeviceSize                     m_page_size;
-        VkDeviceSize                     m_region_size;
-        std::vector<PageOccupancyStatus> m_sparse_page_occupancy;
+        std::vector<std::unique_ptr<Leaf> >     m_leaves;
+        mutable std::vector<MemoryBlockBinding> m_memory_blocks;
+        mutable bool                            m_memory_blocks_dirty;
+        uint32_t                                m_n_pages_with_memory_backing;
+        uint32_t                                m_n_total_pages;
+        VkDeviceSize                            m_page_size;
+        VkDeviceSize                            m_region_size;
+
+        ANVIL_DISABLE_ASSIGNMENT_OPERATOR(PageTracker);
+        ANVIL_DISABLE_COPY_CONSTRUCTOR   (PageTracker);
     };
 }; /* namespace Anvil */
 
@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Implements a persistent, content-addressed cache of SPIR-V blobs.
+ *
+ * Each blob is stored in a separate file, whose name is the SHA-256 digest of all the data that contributed to
+ * the blob's contents (see calculate_key() ). The digest is strong enough for the file name to be trusted as an
+ * identity of the blob, so no further verification of the input data is needed upon a hit.
+ *
+ * Blobs are first written to a uniquely named temporary file and then renamed to their final name. Since a rename
+ * is atomic on all supported platforms, concurrent readers and writers (be it threads or separate processes sharing
+ * the same directory) never see a partially written blob.
+ *
+ * The total size of cached blobs is kept below a user-specified budget. When a store operation takes the cache over
+ * the budget, least recently used blobs are deleted. Each hit bumps the modification time of the corresponding file,
+ * so that the usage order survives between application runs.
+ *
+ * SPIRVDiskCache is thread-safe.
+ **/
+#ifndef MISC_SPIRV_DISK_CACHE_H
+#define MISC_SPIRV_DISK_CACHE_H
+
+#include "misc/types.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Anvil
+{
+    class SPIRVDiskCache
+    {
+    public:
+        /* Public functions */
+
+        /** Creates a new SPIR-V disk cache instance.
+         *
+         *  @param in_directory          Directory to store the blobs in. If the directory does not exist, it is
+         *                               created relative to the working directory (see Anvil::IO::create_directory() ).
+         *                               Multiple cache instances (possibly living in different processes) can
+         *                               safely share the same directory.
+         *  @param in_max_size_in_bytes  Upper bound on the total size of the blobs held in @param in_directory.
+         *
+         *  @return New instance or nullptr, if the directory could not be created or accessed.
+         **/
+        static Anvil::SPIRVDiskCacheUniquePtr create(const std::string& in_directory,
+                                                     uint64_t           in_max_size_in_bytes = 256 * 1024 * 1024);
+
+        /** Destructor. Does not touch any of the cached blobs. */
+        ~SPIRVDiskCache();
+
+        /** Calculates a cache key for the specified data.
+         *
+         *  Callers are expected to serialize all the information which affects the contents of the SPIR-V blob
+         *  (source code, target stage, target SPIR-V version, compiler limits, ..) into a single buffer, and to
+         *  use the returned key for both load() and store() calls.
+         *
+         *  @param in_data       Data to hash. May be nullptr if @param in_data_size is 0.
+         *  @param in_data_size  Number of bytes available under @param in_data.
+         *
+         *  @return Lower-case hexadecimal representation of the SHA-256 digest of the data.
+         **/
+        static std::string calculate_key(const void* in_data,
+                                         size_t      in_data_size);
+
+        /** Removes all blobs from the cache directory. */
+        void clear();
+
+        /** Returns the number of load() calls which found a valid blob. */
+        uint64_t get_n_hits() const;
+
+        /** Returns the number of load() calls which did not find a valid blob. */
+        uint64_t get_n_misses() const;
+
+        /** Returns the total size of the blobs currently known to be held in the cache. */
+        uint64_t get_size_in_bytes() const;
+
+        /** Looks up a blob associated with the specified key.
+         *
+         *  @param in_key         Key returned by an earlier calculate_key() call.
+         *  @param out_blob_ptr   Deref will be set to the blob contents, if found. Must not be nullptr.
+         *
+         *  @return true if the blob was found, false otherwise.
+         **/
+        bool load(const std::string& in_key,
+                  std::vector<char>* out_blob_ptr);
+
+        /** Stores a blob under the specified key, replacing any existing blob with the same key.
+         *
+         *  May evict least recently used blobs, if the cache goes over budget.
+         *
+         *  @param in_key         Key returned by an earlier calculate_key() call.
+         *  @param in_blob        SPIR-V blob to store. Must hold a valid SPIR-V header.
+         *  @param in_blob_size   Number of bytes available under @param in_blob.
+         *
+         *  @return true if the blob was stored successfully, false otherwise.
+         **/
+        bool store(const std::string& in_key,
+                   const char*        in_blob,
+                   size_t             in_blob_size);
+
+    private:
+        /* Private type definitions */
+        typedef struct EntryInfo
+        {
+            /* File time stamps have a resolution of (at best) one second, so entries used within the same
+             * second are ordered by a per-instance counter. */
+            uint64_t last_used_time;
+            uint64_t last_used_counter;
+            uint64_t size;
+
+            EntryInfo()
+            {
+                last_used_counter = 0;
+                last_used_time    = 0;
+                size              = 0;
+            }
+
+            EntryInfo(uint64_t in_last_used_time,
+                      uint64_t in_last_used_counter,
+                      uint64_t in_size)
+            {
+                last_used_counter = in_last_used_counter;
+                last_used_time    = in_last_used_time;
+                size              = in_size;
+            }
+        } EntryInfo;
+
+        /* Private functions */
+        SPIRVDiskCache(const std::string& in_directory,
+                       uint64_t           in_max_size_in_bytes);
+
+        void        evict_entries_over_budget();
+        std::string get_entry_filename       (const std::string& in_key) const;
+        bool        init                     ();
+        bool        is_key_valid             (const std::string& in_key) const;
+
+        /* Private variables */
+        std::string                      m_directory;
+        std::map<std::string, EntryInfo> m_entries;
+        uint64_t                         m_max_size_in_bytes;
+        mutable std::mutex               m_mutex;
+        uint64_t                         m_n_hits;
+        uint64_t                         m_n_misses;
+        uint64_t                         m_size_in_bytes;
+        uint64_t                         m_use_counter;
+
+        ANVIL_DISABLE_ASSIGNMENT_OPERATOR(SPIRVDiskCache);
+        ANVIL_DISABLE_COPY_CONSTRUCTOR   (SPIRVDiskCache);
+    };
+}; /* namespace Anvil */
+
+#endif /* MISC_SPIRV_DISK_CACHE_H */
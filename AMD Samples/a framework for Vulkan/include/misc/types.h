@@ -171,6 +171,7 @@ namespace Anvil
     class  SGPUDevice;
     class  ShaderModule;
     class  ShaderModuleCache;
+    class  SPIRVDiskCache;
     class  Swapchain;
     class  SwapchainCreateInfo;
     class  Window;
@@ -234,6 +235,7 @@ namespace Anvil
     typedef std::unique_ptr<SGPUDevice,                            std::function<void(SGPUDevice*)> >                  SGPUDeviceUniquePtr;
     typedef std::unique_ptr<ShaderModuleCache,                     std::function<void(ShaderModuleCache*)> >           ShaderModuleCacheUniquePtr;
     typedef std::unique_ptr<ShaderModule,                          std::function<void(ShaderModule*)> >                ShaderModuleUniquePtr;
+    typedef std::unique_ptr<SPIRVDiskCache,                        std::function<void(SPIRVDiskCache*)> >              SPIRVDiskCacheUniquePtr;
     typedef std::unique_ptr<SwapchainCreateInfo>                                                                       SwapchainCreateInfoUniquePtr;
     typedef std::unique_ptr<Swapchain,                             std::function<void(Swapchain*)> >                   SwapchainUniquePtr;
     typedef std::unique_ptr<Window,                                std::function<void(Window*)> >                      WindowUniquePtr;
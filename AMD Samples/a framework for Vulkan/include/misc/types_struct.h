@@ -1874,6 +1874,25 @@ namespace Anvil
     extern bool operator==(const MemoryHeap& in1,
                            const MemoryHeap& in2);
 
+    /** Holds usage & fragmentation statistics of memory sub-allocated by a memory allocator backend. */
+    typedef struct MemoryAllocatorStatistics
+    {
+        VkDeviceSize largest_free_range_size;
+        uint32_t     n_allocations;
+        VkDeviceSize n_bytes_allocated;
+        VkDeviceSize n_bytes_reserved;
+        uint32_t     n_free_ranges;
+        uint32_t     n_pages;
+
+        /** Zeroes all fields */
+        MemoryAllocatorStatistics();
+
+        /** Returns a value between 0 and 1, telling how scattered free memory is. 0 means all free memory is held
+         *  by a single range, values close to 1 mean the largest free range is a tiny fraction of all free memory.
+         **/
+        float get_fragmentation() const;
+    } MemoryAllocatorStatistics;
+
     /** Holds properties of a single Vulkan Memory Type. */
     typedef struct MemoryType
     {
@@ -64,6 +64,13 @@ namespace Anvil
             return x;
         }
 
+        /** Mixes @param in_value into the hash value stored under @param inout_hash_ptr. **/
+        static inline void hash_combine(size_t* inout_hash_ptr,
+                                        size_t  in_value)
+        {
+            *inout_hash_ptr ^= in_value + 0x9E3779B9 + (*inout_hash_ptr << 6) + (*inout_hash_ptr >> 2);
+        }
+
         /** Returns an access mask which has all the access bits, relevant to the user-specified image layout,
          *  enabled.
          *
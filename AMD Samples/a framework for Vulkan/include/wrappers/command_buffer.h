@@ -36,6 +36,7 @@
 #define WRAPPERS_COMMAND_BUFFER_H
 
 #include "misc/callbacks.h"
+#include "misc/command_stash.h"
 #include "misc/debug_marker.h"
 #include "misc/io.h"
 #include "misc/mt_safety.h"
@@ -204,22 +205,23 @@ namespace Anvil
     /** Holds all arguments passed to a vkCmdBeginRenderPass() command. */
     typedef struct BeginRenderPassCommand : public Command
     {
-        std::vector<VkClearValue>                 clear_values;
-        Anvil::SubpassContents                    contents;
-        uint32_t                                  device_mask;
-        Anvil::Framebuffer*                       fbo_ptr;
-        std::vector<VkRect2D>                     render_areas;
-        Anvil::RenderPass*                        render_pass_ptr;
+        Anvil::CommandStashArray<VkClearValue> clear_values;
+        Anvil::SubpassContents                 contents;
+        uint32_t                               device_mask;
+        Anvil::Framebuffer*                    fbo_ptr;
+        Anvil::CommandStashArray<VkRect2D>     render_areas;
+        Anvil::RenderPass*                     render_pass_ptr;
 
         /* VK_EXT_sample_locations: */
-        std::vector<Anvil::AttachmentSampleLocations> attachment_initial_sample_locations;
-        std::vector<Anvil::SubpassSampleLocations>    post_subpass_sample_locations;
+        Anvil::CommandStashArray<Anvil::AttachmentSampleLocations> attachment_initial_sample_locations;
+        Anvil::CommandStashArray<Anvil::SubpassSampleLocations>    post_subpass_sample_locations;
 
         /** Constructor.
          *
          *  Arguments as per Vulkan API.
          **/
-        explicit BeginRenderPassCommand(uint32_t                                in_n_clear_values,
+        explicit BeginRenderPassCommand(Anvil::CommandStash*                    in_stash_ptr,
+                                        uint32_t                                in_n_clear_values,
                                         const VkClearValue*                     in_clear_value_ptrs,
                                         Anvil::Framebuffer*                     in_fbo_ptr,
                                         uint32_t                                in_device_mask,
@@ -249,7 +251,8 @@ namespace Anvil
 
     typedef struct BeginRenderPass2KHRCommand : BeginRenderPassCommand
     {
-        BeginRenderPass2KHRCommand(uint32_t                                in_n_clear_values,
+        BeginRenderPass2KHRCommand(Anvil::CommandStash*                    in_stash_ptr,
+                                   uint32_t                                in_n_clear_values,
                                    const VkClearValue*                     in_clear_value_ptrs,
                                    Anvil::Framebuffer*                     in_fbo_ptr,
                                    uint32_t                                in_device_mask,
@@ -261,7 +264,8 @@ namespace Anvil
                                    const Anvil::AttachmentSampleLocations* in_attachment_initial_sample_locations_ptr,
                                    const uint32_t&                         in_n_post_subpass_sample_locations,
                                    const Anvil::SubpassSampleLocations*    in_post_subpass_sample_locations_ptr)
-            :BeginRenderPassCommand(in_n_clear_values,
+            :BeginRenderPassCommand(in_stash_ptr,
+                                    in_n_clear_values,
                                     in_clear_value_ptrs,
                                     in_fbo_ptr,
                                     in_device_mask,
@@ -300,13 +304,15 @@ namespace Anvil
 
     typedef struct BeginTransformFeedbackEXTCommand : public Command
     {
-        std::vector<VkDeviceSize>         counter_buffer_offsets;
-        std::vector<const Anvil::Buffer*> counter_buffer_ptrs;
-        uint32_t                          first_counter_buffer;
+        Anvil::CommandStashArray<VkDeviceSize>         counter_buffer_offsets;
+        Anvil::CommandStashArray<const Anvil::Buffer*> counter_buffer_ptrs;
+        uint32_t                                       first_counter_buffer;
 
-        explicit BeginTransformFeedbackEXTCommand(const uint32_t&                          in_first_counter_buffer,
-                                                  const std::vector<const Anvil::Buffer*>& in_counter_buffer_ptrs,
-                                                  const std::vector<VkDeviceSize>&         in_counter_buffer_offsets);
+        explicit BeginTransformFeedbackEXTCommand(Anvil::CommandStash*        in_stash_ptr,
+                                                  const uint32_t&             in_first_counter_buffer,
+                                                  const uint32_t&             in_n_counter_buffers,
+                                                  const Anvil::Buffer* const* in_opt_counter_buffer_ptrs,
+                                                  const VkDeviceSize*         in_opt_counter_buffer_offsets);
 
     private:
         BeginTransformFeedbackEXTCommand           (const BeginTransformFeedbackEXTCommand&);
@@ -315,17 +321,18 @@ namespace Anvil
 
     typedef struct BindTransformFeedbackBuffersEXTCommand : public Command
     {
-        std::vector<Anvil::Buffer*> buffer_ptrs;
-        uint32_t                    first_binding;
-        uint32_t                    n_bindings;
-        std::vector<VkDeviceSize>   offsets;
-        std::vector<VkDeviceSize>   sizes;
-
-        explicit BindTransformFeedbackBuffersEXTCommand(const uint32_t&                    in_first_binding,
-                                                        const uint32_t&                    in_n_bindings,
-                                                        const std::vector<Anvil::Buffer*>& in_buffer_ptrs,
-                                                        const std::vector<VkDeviceSize>&   in_offsets,
-                                                        const std::vector<VkDeviceSize>&   in_sizes);
+        Anvil::CommandStashArray<Anvil::Buffer*> buffer_ptrs;
+        uint32_t                                 first_binding;
+        uint32_t                                 n_bindings;
+        Anvil::CommandStashArray<VkDeviceSize>   offsets;
+        Anvil::CommandStashArray<VkDeviceSize>   sizes;
+
+        explicit BindTransformFeedbackBuffersEXTCommand(Anvil::CommandStash*  in_stash_ptr,
+                                                        const uint32_t&       in_first_binding,
+                                                        const uint32_t&       in_n_bindings,
+                                                        Anvil::Buffer* const* in_buffer_ptrs,
+                                                        const VkDeviceSize*   in_offsets,
+                                                        const VkDeviceSize*   in_sizes);
 
     private:
         BindTransformFeedbackBuffersEXTCommand           (const BindTransformFeedbackBuffersEXTCommand&);
@@ -376,9 +383,9 @@ namespace Anvil
     /** Holds all arguments passed to a vkCmdPipelineBarrier() command. */
     typedef struct PipelineBarrierCommand : public Command
     {
-        std::vector<BufferBarrier> buffer_barriers;
-        std::vector<ImageBarrier>  image_barriers;
-        std::vector<MemoryBarrier> memory_barriers;
+        Anvil::CommandStashArray<BufferBarrier> buffer_barriers;
+        Anvil::CommandStashArray<ImageBarrier>  image_barriers;
+        Anvil::CommandStashArray<MemoryBarrier> memory_barriers;
 
         Anvil::DependencyFlags flags;
 
@@ -391,7 +398,8 @@ namespace Anvil
          *
          *  Arguments as per Vulkan API.
          **/
-        explicit PipelineBarrierCommand(Anvil::PipelineStageFlags  in_src_stage_mask,
+        explicit PipelineBarrierCommand(Anvil::CommandStash*       in_stash_ptr,
+                                        Anvil::PipelineStageFlags  in_src_stage_mask,
                                         Anvil::PipelineStageFlags  in_dst_stage_mask,
                                         Anvil::DependencyFlags     in_flags,
                                         uint32_t                   in_memory_barrier_count,
@@ -399,7 +407,7 @@ namespace Anvil
                                         uint32_t                   in_buffer_memory_barrier_count,
                                         const BufferBarrier* const in_buffer_memory_barrier_ptr_ptr,
                                         uint32_t                   in_image_memory_barrier_count,
-                                        const ImageBarrier*  const in_image_memory_barrier_ptr_ptr);
+                                        const ImageBarrier* const  in_image_memory_barrier_ptr_ptr);
 
         virtual ~PipelineBarrierCommand()
         {
@@ -472,12 +480,33 @@ namespace Anvil
             return m_type;
         }
 
+        /** Returns the number of commands stashed since the command buffer was last reset or started
+         *  recording.
+         *
+         *  Always returns 0 for builds without STORE_COMMAND_BUFFER_COMMANDS enabled, or if command stashing
+         *  has been disabled.
+         **/
+        uint32_t get_n_stashed_commands() const;
+
         /** Returns the parent command pool */
         Anvil::CommandPool* get_parent_command_pool() const
         {
             return m_parent_command_pool_ptr;
         }
 
+        /** Returns a descriptor of a stashed command. Commands are indexed in recording order, so iterating
+         *  from 0 to get_n_stashed_commands() - 1 visits the command buffer's contents in the order they were
+         *  recorded. The descriptors are for inspection only: nothing re-records them into another command buffer.
+         *
+         *  The descriptor, as well as all arrays it refers to, remain valid until the command buffer is reset
+         *  or starts recording again. Use Command::type to determine the descriptor's actual type.
+         *
+         *  @param in_n_command Index of the command. Must be smaller than get_n_stashed_commands().
+         *
+         *  @return Requested descriptor or nullptr if the index is invalid.
+         **/
+        const Anvil::Command* get_stashed_command(uint32_t in_n_command) const;
+
         /** Inserts a single queue debug label.
          *
          *  Requires VK_EXT_debug_utils support. Otherwise, the call is moot.
@@ -1517,9 +1546,11 @@ namespace Anvil
                                     Anvil::QueryPool*            in_query_pool_ptr,
                                     Anvil::QueryIndex            in_entry);
 
-        /** Resets the underlying Vulkan command buffer and clears the internally managed vector of
+        /** Resets the underlying Vulkan command buffer and clears the internally managed stash of
          *  recorded commands, if STORE_COMMAND_BUFFER_COMMANDS has been defined for the build.
          *
+         *  Memory used by the stash is retained and reused by subsequent recordings.
+         *
          *  @param in_should_release_resources true if the vkResetCommandBuffer() should be made with the
          *                                     VK_CMD_BUFFER_RESET_RELEASE_RESOURCES_BIT flag set.
          *
@@ -1609,14 +1640,15 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdBindDescriptorSets() command. */
         typedef struct BindDescriptorSetsCommand : public Command
         {
-            std::vector<const Anvil::DescriptorSet*> descriptor_sets;
-            std::vector<uint32_t>                    dynamic_offsets;
-            uint32_t                                 first_set;
-            Anvil::PipelineLayout*                   layout_ptr;
-            Anvil::PipelineBindPoint                 pipeline_bind_point;
+            Anvil::CommandStashArray<const Anvil::DescriptorSet*> descriptor_sets;
+            Anvil::CommandStashArray<uint32_t>                    dynamic_offsets;
+            uint32_t                                              first_set;
+            Anvil::PipelineLayout*                                layout_ptr;
+            Anvil::PipelineBindPoint                              pipeline_bind_point;
 
             /** Constructor. **/
-            explicit BindDescriptorSetsCommand(Anvil::PipelineBindPoint           in_pipeline_bind_point,
+            explicit BindDescriptorSetsCommand(Anvil::CommandStash*               in_stash_ptr,
+                                               Anvil::PipelineBindPoint           in_pipeline_bind_point,
                                                Anvil::PipelineLayout*             in_layout_ptr,
                                                uint32_t                           in_first_set,
                                                uint32_t                           in_set_count,
@@ -1710,14 +1742,15 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdBindVertexBuffers() command. */
         typedef struct BindVertexBuffersCommand : public Command
         {
-            std::vector<BindVertexBuffersCommandBinding> bindings;
-            uint32_t                                     start_binding;
+            Anvil::CommandStashArray<BindVertexBuffersCommandBinding> bindings;
+            uint32_t                                                  start_binding;
 
             /** Constructor. **/
-            explicit BindVertexBuffersCommand(uint32_t            in_start_binding,
-                                              uint32_t            in_binding_count,
-                                              Anvil::Buffer**     in_buffer_ptrs,
-                                              const VkDeviceSize* in_offset_ptrs);
+            explicit BindVertexBuffersCommand(Anvil::CommandStash* in_stash_ptr,
+                                              uint32_t             in_start_binding,
+                                              uint32_t             in_binding_count,
+                                              Anvil::Buffer**      in_buffer_ptrs,
+                                              const VkDeviceSize*  in_offset_ptrs);
 
             /** Destructor. */
             virtual ~BindVertexBuffersCommand()
@@ -1736,11 +1769,12 @@ namespace Anvil
             Anvil::ImageLayout src_image_layout;
             Anvil::Image*      src_image_ptr;
 
-            Anvil::Filter                 filter;
-            std::vector<Anvil::ImageBlit> regions;
+            Anvil::Filter                              filter;
+            Anvil::CommandStashArray<Anvil::ImageBlit> regions;
 
             /** Constructor. */
-            explicit BlitImageCommand(Anvil::Image*           in_src_image_ptr,
+            explicit BlitImageCommand(Anvil::CommandStash*    in_stash_ptr,
+                                      Anvil::Image*           in_src_image_ptr,
                                       Anvil::ImageLayout      in_src_image_layout,
                                       Anvil::Image*           in_dst_image_ptr,
                                       Anvil::ImageLayout      in_dst_image_layout,
@@ -1787,11 +1821,12 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdClearAttachments() command. */
         typedef struct ClearAttachmentsCommand : public Command
         {
-            std::vector<ClearAttachmentsCommandAttachment> attachments;
-            std::vector<VkClearRect>                       rects;
+            Anvil::CommandStashArray<ClearAttachmentsCommandAttachment> attachments;
+            Anvil::CommandStashArray<VkClearRect>                       rects;
 
             /* Constructor. **/
-            explicit ClearAttachmentsCommand(uint32_t                      in_n_attachments,
+            explicit ClearAttachmentsCommand(Anvil::CommandStash*          in_stash_ptr,
+                                             uint32_t                      in_n_attachments,
                                              const Anvil::ClearAttachment* in_attachments,
                                              uint32_t                      in_n_rects,
                                              const VkClearRect*            in_rect_ptrs);
@@ -1807,14 +1842,15 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdClearColorImage() command. */
         typedef struct ClearColorImageCommand : public Command
         {
-            VkClearColorValue                         color;
-            VkImage                                   image;
-            Anvil::ImageLayout                        image_layout;
-            Anvil::Image*                             image_ptr;
-            std::vector<Anvil::ImageSubresourceRange> ranges;
+            VkClearColorValue                                      color;
+            VkImage                                                image;
+            Anvil::ImageLayout                                     image_layout;
+            Anvil::Image*                                          image_ptr;
+            Anvil::CommandStashArray<Anvil::ImageSubresourceRange> ranges;
 
             /** Constructor. **/
-            explicit ClearColorImageCommand(Anvil::Image*                       in_image_ptr,
+            explicit ClearColorImageCommand(Anvil::CommandStash*                in_stash_ptr,
+                                            Anvil::Image*                       in_image_ptr,
                                             Anvil::ImageLayout                  in_image_layout,
                                             const VkClearColorValue*            in_color_ptr,
                                             uint32_t                            in_range_count,
@@ -1834,14 +1870,15 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdClearDepthStencilImage() command. */
         typedef struct ClearDepthStencilImageCommand : public Command
         {
-            VkClearDepthStencilValue                  depth_stencil;
-            VkImage                                   image;
-            Anvil::ImageLayout                        image_layout;
-            Anvil::Image*                             image_ptr;
-            std::vector<Anvil::ImageSubresourceRange> ranges;
+            VkClearDepthStencilValue                               depth_stencil;
+            VkImage                                                image;
+            Anvil::ImageLayout                                     image_layout;
+            Anvil::Image*                                          image_ptr;
+            Anvil::CommandStashArray<Anvil::ImageSubresourceRange> ranges;
 
             /** Constructor. **/
-            explicit ClearDepthStencilImageCommand(Anvil::Image*                       in_image_ptr,
+            explicit ClearDepthStencilImageCommand(Anvil::CommandStash*                in_stash_ptr,
+                                                   Anvil::Image*                       in_image_ptr,
                                                    Anvil::ImageLayout                  in_image_layout,
                                                    const VkClearDepthStencilValue*     in_depth_stencil_ptr,
                                                    uint32_t                            in_range_count,
@@ -1861,14 +1898,15 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdCopyBuffer() command. */
         typedef struct CopyBufferCommand : public Command
         {
-            VkBuffer                       dst_buffer;
-            Anvil::Buffer*                 dst_buffer_ptr;
-            std::vector<Anvil::BufferCopy> regions;
-            VkBuffer                       src_buffer;
-            Anvil::Buffer*                 src_buffer_ptr;
+            VkBuffer                                    dst_buffer;
+            Anvil::Buffer*                              dst_buffer_ptr;
+            Anvil::CommandStashArray<Anvil::BufferCopy> regions;
+            VkBuffer                                    src_buffer;
+            Anvil::Buffer*                              src_buffer_ptr;
 
             /** Constructor. **/
-            explicit CopyBufferCommand(Anvil::Buffer*           in_src_buffer_ptr,
+            explicit CopyBufferCommand(Anvil::CommandStash*     in_stash_ptr,
+                                       Anvil::Buffer*           in_src_buffer_ptr,
                                        Anvil::Buffer*           in_dst_buffer_ptr,
                                        uint32_t                 in_region_count,
                                        const Anvil::BufferCopy* in_region_ptrs);
@@ -1887,15 +1925,16 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdCopyBufferToImage() command. */
         typedef struct CopyBufferToImageCommand : public Command
         {
-            VkImage                             dst_image;
-            Anvil::ImageLayout                  dst_image_layout;
-            Anvil::Image*                       dst_image_ptr;
-            std::vector<Anvil::BufferImageCopy> regions;
-            VkBuffer                            src_buffer;
-            Anvil::Buffer*                      src_buffer_ptr;
+            VkImage                                          dst_image;
+            Anvil::ImageLayout                               dst_image_layout;
+            Anvil::Image*                                    dst_image_ptr;
+            Anvil::CommandStashArray<Anvil::BufferImageCopy> regions;
+            VkBuffer                                         src_buffer;
+            Anvil::Buffer*                                   src_buffer_ptr;
 
             /** Constructor. **/
-            explicit CopyBufferToImageCommand(Anvil::Buffer*                in_src_buffer_ptr,
+            explicit CopyBufferToImageCommand(Anvil::CommandStash*          in_stash_ptr,
+                                              Anvil::Buffer*                in_src_buffer_ptr,
                                               Anvil::Image*                 in_dst_image_ptr,
                                               Anvil::ImageLayout            in_dst_image_layout,
                                               uint32_t                      in_region_count,
@@ -1916,16 +1955,17 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdCopyImage() command. */
         typedef struct CopyImageCommand : public Command
         {
-            VkImage                       dst_image;
-            Anvil::Image*                 dst_image_ptr;
-            Anvil::ImageLayout            dst_image_layout;
-            std::vector<Anvil::ImageCopy> regions;
-            VkImage                       src_image;
-            Anvil::Image*                 src_image_ptr;
-            Anvil::ImageLayout            src_image_layout;
+            VkImage                                    dst_image;
+            Anvil::Image*                              dst_image_ptr;
+            Anvil::ImageLayout                         dst_image_layout;
+            Anvil::CommandStashArray<Anvil::ImageCopy> regions;
+            VkImage                                    src_image;
+            Anvil::Image*                              src_image_ptr;
+            Anvil::ImageLayout                         src_image_layout;
 
             /** Constructor. **/
-            explicit CopyImageCommand(Anvil::Image*           in_src_image_ptr,
+            explicit CopyImageCommand(Anvil::CommandStash*    in_stash_ptr,
+                                      Anvil::Image*           in_src_image_ptr,
                                       Anvil::ImageLayout      in_src_image_layout,
                                       Anvil::Image*           in_dst_image_ptr,
                                       Anvil::ImageLayout      in_dst_image_layout,
@@ -1946,15 +1986,16 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdCopyImageToBuffer() command. */
         typedef struct CopyImageToBufferCommand : public Command
         {
-            VkBuffer                            dst_buffer;
-            Anvil::Buffer*                      dst_buffer_ptr;
-            std::vector<Anvil::BufferImageCopy> regions;
-            VkImage                             src_image;
-            Anvil::ImageLayout                  src_image_layout;
-            Anvil::Image*                       src_image_ptr;
+            VkBuffer                                         dst_buffer;
+            Anvil::Buffer*                                   dst_buffer_ptr;
+            Anvil::CommandStashArray<Anvil::BufferImageCopy> regions;
+            VkImage                                          src_image;
+            Anvil::ImageLayout                               src_image_layout;
+            Anvil::Image*                                    src_image_ptr;
 
             /** Constructor. **/
-            explicit CopyImageToBufferCommand(Anvil::Image*                 in_src_image_ptr,
+            explicit CopyImageToBufferCommand(Anvil::CommandStash*          in_stash_ptr,
+                                              Anvil::Image*                 in_src_image_ptr,
                                               Anvil::ImageLayout            in_src_image_layout,
                                               Anvil::Buffer*                in_dst_buffer_ptr,
                                               uint32_t                      in_region_count,
@@ -2007,11 +2048,12 @@ namespace Anvil
         typedef struct DebugMarkerBeginEXTCommand : public Command
         {
             float       color[4];
-            std::string marker_name;
+            const char* marker_name;
 
             /** Constructor. */
-            explicit DebugMarkerBeginEXTCommand(const std::string& in_marker_name,
-                                                const float*       in_color);
+            explicit DebugMarkerBeginEXTCommand(Anvil::CommandStash* in_stash_ptr,
+                                                const char*          in_marker_name,
+                                                const float*         in_color);
 
             /* Destructor */
             virtual ~DebugMarkerBeginEXTCommand()
@@ -2037,11 +2079,12 @@ namespace Anvil
         typedef struct DebugMarkerInsertEXTCommand : public Command
         {
             float       color[4];
-            std::string marker_name;
+            const char* marker_name;
 
             /** Constructor. */
-            explicit DebugMarkerInsertEXTCommand(const std::string& in_marker_name,
-                                                 const float*       in_color);
+            explicit DebugMarkerInsertEXTCommand(Anvil::CommandStash* in_stash_ptr,
+                                                 const char*          in_marker_name,
+                                                 const float*         in_color);
 
             /* Destructor. */
             virtual ~DebugMarkerInsertEXTCommand()
@@ -2404,13 +2447,15 @@ namespace Anvil
 
         typedef struct EndTransformFeedbackEXTCommand : public Command
         {
-            std::vector<VkDeviceSize>         counter_buffer_offsets;
-            std::vector<const Anvil::Buffer*> counter_buffer_ptrs;
-            uint32_t                          first_counter_buffer;
+            Anvil::CommandStashArray<VkDeviceSize>         counter_buffer_offsets;
+            Anvil::CommandStashArray<const Anvil::Buffer*> counter_buffer_ptrs;
+            uint32_t                                       first_counter_buffer;
 
-            explicit EndTransformFeedbackEXTCommand(const uint32_t&                          in_first_counter_buffer,
-                                                    const std::vector<const Anvil::Buffer*>& in_counter_buffer_ptrs,
-                                                    const std::vector<VkDeviceSize>&         in_counter_buffer_offsets);
+            explicit EndTransformFeedbackEXTCommand(Anvil::CommandStash*        in_stash_ptr,
+                                                    const uint32_t&             in_first_counter_buffer,
+                                                    const uint32_t&             in_n_counter_buffers,
+                                                    const Anvil::Buffer* const* in_opt_counter_buffer_ptrs,
+                                                    const VkDeviceSize*         in_opt_counter_buffer_offsets);
 
         private:
             EndTransformFeedbackEXTCommand           (const EndTransformFeedbackEXTCommand&);
@@ -2420,11 +2465,12 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdExecuteCommands() command. */
         typedef struct ExecuteCommandsCommand : public Command
         {
-            std::vector<Anvil::SecondaryCommandBuffer*> command_buffer_ptrs;
-            std::vector<VkCommandBuffer>                command_buffers;
+            Anvil::CommandStashArray<Anvil::SecondaryCommandBuffer*> command_buffer_ptrs;
+            Anvil::CommandStashArray<VkCommandBuffer>                command_buffers;
 
             /** Constructor. **/
-            explicit ExecuteCommandsCommand(uint32_t                        in_cmd_buffers_count,
+            explicit ExecuteCommandsCommand(Anvil::CommandStash*            in_stash_ptr,
+                                            uint32_t                        in_cmd_buffers_count,
                                             Anvil::SecondaryCommandBuffer** in_cmd_buffer_ptrs);
 
             /** Destructor. */
@@ -2497,10 +2543,11 @@ namespace Anvil
             Anvil::PipelineLayout* layout_ptr;
             uint32_t               offset;
             uint32_t               size;
-            const void*            values;
+            const void*            values; /* Copy of the data, owned by the command stash */
 
             /** Constructor. **/
-            explicit PushConstantsCommand(Anvil::PipelineLayout*  in_layout_ptr,
+            explicit PushConstantsCommand(Anvil::CommandStash*    in_stash_ptr,
+                                          Anvil::PipelineLayout*  in_layout_ptr,
                                           Anvil::ShaderStageFlags in_stage_flags,
                                           uint32_t                in_offset,
                                           uint32_t                in_size,
@@ -2559,16 +2606,17 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdResolveImage() command. **/
         typedef struct ResolveImageCommand : public Command
         {
-            VkImage                          dst_image;
-            Anvil::Image*                    dst_image_ptr;
-            Anvil::ImageLayout               dst_image_layout;
-            std::vector<Anvil::ImageResolve> regions;
-            VkImage                          src_image;
-            Anvil::Image*                    src_image_ptr;
-            Anvil::ImageLayout               src_image_layout;
+            VkImage                                       dst_image;
+            Anvil::Image*                                 dst_image_ptr;
+            Anvil::ImageLayout                            dst_image_layout;
+            Anvil::CommandStashArray<Anvil::ImageResolve> regions;
+            VkImage                                       src_image;
+            Anvil::Image*                                 src_image_ptr;
+            Anvil::ImageLayout                            src_image_layout;
 
             /** Constructor. **/
-            explicit ResolveImageCommand(Anvil::Image*              in_src_image_ptr,
+            explicit ResolveImageCommand(Anvil::CommandStash*       in_stash_ptr,
+                                         Anvil::Image*              in_src_image_ptr,
                                          Anvil::ImageLayout         in_src_image_layout,
                                          Anvil::Image*              in_dst_image_ptr,
                                          Anvil::ImageLayout         in_dst_image_layout,
@@ -2711,13 +2759,14 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdSetScissor() command. **/
         typedef struct SetScissorCommand : public Command
         {
-            uint32_t              first_scissor;
-            std::vector<VkRect2D> scissors;
+            uint32_t                           first_scissor;
+            Anvil::CommandStashArray<VkRect2D> scissors;
 
             /** Constructor. **/
-            explicit SetScissorCommand(uint32_t        in_first_scissor,
-                                       uint32_t        in_scissor_count,
-                                       const VkRect2D* in_scissor_ptrs);
+            explicit SetScissorCommand(Anvil::CommandStash* in_stash_ptr,
+                                       uint32_t             in_first_scissor,
+                                       uint32_t             in_scissor_count,
+                                       const VkRect2D*      in_scissor_ptrs);
 
             /** Destructor. */
             virtual ~SetScissorCommand()
@@ -2786,13 +2835,14 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdSetViewport() command. **/
         typedef struct SetViewportCommand : public Command
         {
-            uint32_t                first_viewport;
-            std::vector<VkViewport> viewports;
+            uint32_t                             first_viewport;
+            Anvil::CommandStashArray<VkViewport> viewports;
 
             /** Constructor. **/
-            explicit SetViewportCommand(uint32_t          in_first_viewport,
-                                        uint32_t          in_viewport_count,
-                                        const VkViewport* in_viewport_ptrs);
+            explicit SetViewportCommand(Anvil::CommandStash* in_stash_ptr,
+                                        uint32_t             in_first_viewport,
+                                        uint32_t             in_viewport_count,
+                                        const VkViewport*    in_viewport_ptrs);
 
             /** Destructor. */
             virtual ~SetViewportCommand()
@@ -2805,17 +2855,18 @@ namespace Anvil
         /** Holds all arguments passed to a vkCmdUpdateBuffer() command. **/
         typedef struct UpdateBufferCommand : public Command
         {
-            const void*     data_ptr;
+            const void*     data_ptr; /* Copy of the data, owned by the command stash */
             VkDeviceSize    data_size;
             VkBuffer        dst_buffer;
             Anvil::Buffer*  dst_buffer_ptr;
             VkDeviceSize    dst_offset;
 
             /** Constructor **/
-            explicit UpdateBufferCommand(Anvil::Buffer* in_dst_buffer_ptr,
-                                         VkDeviceSize   in_dst_offset,
-                                         VkDeviceSize   in_data_size,
-                                         const void*    in_data_ptr);
+            explicit UpdateBufferCommand(Anvil::CommandStash* in_stash_ptr,
+                                         Anvil::Buffer*       in_dst_buffer_ptr,
+                                         VkDeviceSize         in_dst_offset,
+                                         VkDeviceSize         in_data_size,
+                                         const void*          in_data_ptr);
 
             /** Destructor. */
             virtual ~UpdateBufferCommand()
@@ -2833,15 +2884,16 @@ namespace Anvil
             Anvil::PipelineStageFlags dst_stage_mask;
             Anvil::PipelineStageFlags src_stage_mask;
 
-            std::vector<BufferBarrier>  buffer_barriers;
-            std::vector<ImageBarrier>   image_barriers;
-            std::vector<MemoryBarrier>  memory_barriers;
+            Anvil::CommandStashArray<BufferBarrier> buffer_barriers;
+            Anvil::CommandStashArray<ImageBarrier>  image_barriers;
+            Anvil::CommandStashArray<MemoryBarrier> memory_barriers;
 
-            std::vector<VkEvent>       events;
-            std::vector<Anvil::Event*> event_ptrs;
+            Anvil::CommandStashArray<VkEvent>       events;
+            Anvil::CommandStashArray<Anvil::Event*> event_ptrs;
 
             /** Constructor **/
-            explicit WaitEventsCommand(uint32_t                   in_event_count,
+            explicit WaitEventsCommand(Anvil::CommandStash*       in_stash_ptr,
+                                       uint32_t                   in_event_count,
                                        Anvil::Event* const*       in_event_ptrs,
                                        Anvil::PipelineStageFlags  in_src_stage_mask,
                                        Anvil::PipelineStageFlags  in_dst_stage_mask,
@@ -2910,8 +2962,6 @@ namespace Anvil
         } WriteTimestampCommand;
 
 
-        typedef std::vector<Command> Commands;
-
         /* Protected functions */
         explicit CommandBufferBase(const Anvil::BaseDevice* in_device_ptr,
                                    Anvil::CommandPool*      in_parent_command_pool_ptr,
@@ -2924,9 +2974,12 @@ namespace Anvil
 
         /* Protected variables */
         #ifdef STORE_COMMAND_BUFFER_COMMANDS
-            Commands m_commands;
+            Anvil::CommandStash m_command_stash;
         #endif
 
+        /* Holds descriptors of commands built solely for the purpose of a call-back. Reset after each call-back. */
+        Anvil::CommandStash m_callback_command_stash;
+
         VkCommandBuffer          m_command_buffer;
         uint32_t                 m_device_mask;
         const Anvil::BaseDevice* m_device_ptr;
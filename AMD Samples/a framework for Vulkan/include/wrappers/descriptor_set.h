@@ -32,6 +32,7 @@
 #define WRAPPERS_DESCRIPTOR_SET_H
 
 #include "misc/debug_marker.h"
+#include "misc/descriptor_update_template_payload.h"
 #include "misc/mt_safety.h"
 #include "misc/types.h"
 
@@ -725,13 +726,17 @@ namespace Anvil
                                      current_element_index < last_element_index;
                                    ++current_element_index)
             {
-                m_dirty |= !(*binding_item_ptrs[current_element_index] == *in_elements_ptr_ptr[current_element_index - in_element_range.first]);
+                if (!( binding_item_ptrs[current_element_index]  != nullptr                                                               &&
+                      *binding_item_ptrs[current_element_index] == *in_elements_ptr_ptr[current_element_index - in_element_range.first]) )
+                {
+                    m_dirty = true;
 
-                binding_item_ptrs[current_element_index].reset(
-                    new Anvil::DescriptorSet::BindingItem()
-                );
+                    binding_item_ptrs[current_element_index].reset(
+                        new Anvil::DescriptorSet::BindingItem()
+                    );
 
-                *binding_item_ptrs[current_element_index] = *in_elements_ptr_ptr[current_element_index - in_element_range.first];
+                    *binding_item_ptrs[current_element_index] = *in_elements_ptr_ptr[current_element_index - in_element_range.first];
+                }
             }
 
             return true;
@@ -776,6 +781,8 @@ namespace Anvil
                                                    const bool&         in_should_cache_raw_data);
 
         /** Updates internally-maintained Vulkan descriptor set instances.
+         *
+         *  Only binding array items which have been assigned new descriptors since the last update are written.
          *
          *  @param in_update_method Please see DescriptorSetUpdateMethod documentation for more details.
          *
@@ -783,6 +790,26 @@ namespace Anvil
          **/
         bool update(const DescriptorSetUpdateMethod& in_update_method = Anvil::DescriptorSetUpdateMethod::CORE) const;
 
+        /** Updates all dirty descriptor sets from the specified array in one go.
+         *
+         *  For CORE update method, writes for all sets created for the same device are gathered and issued with a single
+         *  vkUpdateDescriptorSets() call. Sets whose pending writes can be described by a descriptor update template that
+         *  their layout has already created (see DescriptorSetLayout::get_update_template()) are updated using that template instead.
+         *
+         *  For TEMPLATE update method, each dirty set is updated with a vkUpdateDescriptorSetWithTemplateKHR() call.
+         *
+         *  Sets which are not dirty are skipped. The same set may be specified more than once.
+         *
+         *  @param in_ds_ptrs           Descriptor sets to update. Must not be null if @param in_n_descriptor_sets is not 0.
+         *  @param in_n_descriptor_sets Number of descriptor sets under @param in_ds_ptrs.
+         *  @param in_update_method     Please see DescriptorSetUpdateMethod documentation for more details.
+         *
+         *  @return true if all sets have been updated successfully, false otherwise.
+         **/
+        static bool update_batch(const Anvil::DescriptorSet* const* in_ds_ptrs,
+                                 uint32_t                           in_n_descriptor_sets,
+                                 const DescriptorSetUpdateMethod&   in_update_method = Anvil::DescriptorSetUpdateMethod::CORE);
+
     private:
         /* Private type declarations */
 
@@ -907,7 +934,12 @@ namespace Anvil
                                             VkDescriptorImageInfo*                     out_descriptor_ptr) const;
         void fill_iub_vk_descriptor        (const Anvil::DescriptorSet::BindingItem&   in_binding_item,
                                             VkWriteDescriptorSetInlineUniformBlockEXT* out_descriptor_ptr) const;
+        void on_core_update_issued         (const std::vector<uint32_t>&               in_iub_binding_indices) const;
         void on_parent_pool_reset          ();
+        void on_template_update_issued     () const;
+        bool prepare_core_update           (std::vector<uint32_t>*                     out_iub_binding_indices_ptr) const;
+        bool prepare_template_update       (bool*                                      out_has_iub_updates_ptr) const;
+        bool update_using_cached_template  () const;
         bool update_using_core_method      () const;
         bool update_using_template_method  () const;
 
@@ -934,9 +966,7 @@ namespace Anvil
         mutable std::vector<VkWriteDescriptorSetInlineUniformBlockEXT> m_cached_ds_write_iub_items_vk;
         mutable std::vector<VkWriteDescriptorSet>                      m_cached_ds_write_items_vk;
 
-        mutable std::vector<DescriptorUpdateTemplateEntry>                                                     m_template_entries;
-        mutable std::map<std::vector<DescriptorUpdateTemplateEntry>, Anvil::DescriptorUpdateTemplateUniquePtr> m_template_object_map;
-        mutable std::vector<uint8_t>                                                                           m_template_raw_data;
+        mutable Anvil::DescriptorUpdateTemplatePayload                 m_template_payload;
 
         friend class Anvil::DescriptorPool;
     };
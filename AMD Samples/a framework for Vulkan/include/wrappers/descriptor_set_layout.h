@@ -35,7 +35,9 @@
 #include "misc/mt_safety.h"
 #include "misc/types.h"
 #include "wrappers/sampler.h"
+#include <map>
 #include <memory>
+#include <mutex>
 
 namespace Anvil
 {
@@ -84,6 +86,27 @@ namespace Anvil
             return m_layout;
         }
 
+        /** Returns a descriptor update template, which can be used to update descriptor sets using this layout
+         *  with a payload described by @param in_entries.
+         *
+         *  Templates are cached for the lifetime of the layout and shared by all descriptor sets using it.
+         *
+         *  This function is thread-safe.
+         *
+         *  Requires VK_KHR_descriptor_update_template.
+         *
+         *  @param in_entries           Template entries to use. Must not be empty.
+         *  @param in_create_if_missing True to create a new template if none has been created for @param in_entries
+         *                              before. If false, nullptr is returned in such case.
+         *
+         *  @return As per description, or nullptr if the template could not be created.
+         **/
+        const Anvil::DescriptorUpdateTemplate* get_update_template(const std::vector<Anvil::DescriptorUpdateTemplateEntry>& in_entries,
+                                                                   bool                                                     in_create_if_missing) const;
+
+        /** Tells whether any descriptor update templates have been created for the layout so far. Thread-safe. */
+        bool has_update_templates() const;
+
         /* Returns the maximum number of variable descriptor count binding size supported for the specified descriptor set layout.
          *
          * Requires VK_KHR_maintenance3 and VK_KHR_descriptor_indexing.
@@ -131,6 +154,9 @@ namespace Anvil
         DescriptorSetCreateInfoUniquePtr m_create_info_ptr;
         const Anvil::BaseDevice*         m_device_ptr;
         VkDescriptorSetLayout            m_layout;
+
+        mutable std::map<std::vector<Anvil::DescriptorUpdateTemplateEntry>, Anvil::DescriptorUpdateTemplateUniquePtr> m_update_templates;
+        mutable std::mutex                                                                                             m_update_templates_mutex;
     };
 }; /* namespace Anvil */
 
@@ -25,6 +25,7 @@
 
 #include "misc/mt_safety.h"
 #include "misc/types.h"
+#include <unordered_map>
 
 namespace Anvil
 {
@@ -36,6 +37,18 @@ namespace Anvil
         /** Destructor */
         ~DescriptorSetLayoutManager();
 
+        /** Returns a descriptor set layout wrapper matching the specified descriptor set configuration.
+         *  If such layout has never been defined before, it will be created at the call time.
+         *
+         *  Layouts are indexed by DescriptorSetCreateInfo::get_hash(), so the cost of the look-up does not
+         *  depend on the number of cached layouts. For MT-safe managers, the index is split into shards,
+         *  each protected by a separate lock, so that threads looking up different layouts do not contend.
+         *
+         *  @param in_ds_create_info_ptr Descriptor set configuration. Must not be nullptr.
+         *  @param out_ds_layout_ptr_ptr Deref will be set to a ptr to the layout wrapper. Must not be nullptr.
+         *
+         *  @return true if successful, false otherwise.
+         **/
         bool get_layout(const DescriptorSetCreateInfo*       in_ds_create_info_ptr,
                         Anvil::DescriptorSetLayoutUniquePtr* out_ds_layout_ptr_ptr);
 
@@ -56,7 +69,19 @@ namespace Anvil
             }
         } DescriptorSetLayoutContainer;
 
-        typedef std::vector<std::unique_ptr<DescriptorSetLayoutContainer> > DescriptorSetLayouts;
+        typedef std::vector<std::unique_ptr<DescriptorSetLayoutContainer> >    DescriptorSetLayouts;
+        typedef std::unordered_map<size_t, DescriptorSetLayouts>             HashToDescriptorSetLayoutsMap;
+
+        typedef struct Shard
+        {
+            HashToDescriptorSetLayoutsMap descriptor_set_layouts;
+            std::mutex                    mutex;
+        } Shard;
+
+        enum
+        {
+            N_SHARDS = 16
+        };
 
         /* Private functions */
         DescriptorSetLayoutManager(const Anvil::BaseDevice* in_device_ptr,
@@ -70,9 +95,14 @@ namespace Anvil
         static Anvil::DescriptorSetLayoutManagerUniquePtr create(const Anvil::BaseDevice* in_device_ptr,
                                                                  bool                     in_mt_safe);
 
+        Shard& get_shard(size_t in_hash)
+        {
+            return m_shards[in_hash % N_SHARDS];
+        }
+
         /* Private members */
         const Anvil::BaseDevice* m_device_ptr;
-        DescriptorSetLayouts     m_descriptor_set_layouts;
+        Shard                    m_shards[N_SHARDS];
 
         friend class BaseDevice;
     };
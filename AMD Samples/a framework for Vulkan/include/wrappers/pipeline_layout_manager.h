@@ -33,6 +33,7 @@
 #include "misc/mt_safety.h"
 #include "misc/types.h"
 #include <memory>
+#include <unordered_map>
 
 namespace Anvil
 {
@@ -47,6 +48,10 @@ namespace Anvil
         /** Returns a pipeline layout wrapper matching the specified DSG + push constant range configuration.
          *  If such pipeline layout has never been defined before, it will be created at the call time.
          *
+         *  Layouts are indexed by a hash of the configuration, so the cost of the look-up does not depend on
+         *  the number of cached layouts. For MT-safe managers, the index is split into shards, each protected
+         *  by a separate lock, so that threads looking up different layouts do not contend.
+         *
          *  @param in_ds_create_info_items_ptr TODO.
          *  @param in_push_constant_ranges     A vector of PushConstantRange descriptor, describing the push constant ranges
          *                                     the layout should define.
@@ -77,6 +82,18 @@ namespace Anvil
         } PipelineLayoutContainer;
 
         typedef std::vector<std::unique_ptr<PipelineLayoutContainer> > PipelineLayouts;
+        typedef std::unordered_map<size_t, PipelineLayouts>             HashToPipelineLayoutsMap;
+
+        typedef struct Shard
+        {
+            std::mutex               mutex;
+            HashToPipelineLayoutsMap pipeline_layouts;
+        } Shard;
+
+        enum
+        {
+            N_SHARDS = 16
+        };
 
         /* Private functions */
         PipelineLayoutManager(const Anvil::BaseDevice* in_device_ptr,
@@ -85,6 +102,14 @@ namespace Anvil
         PipelineLayoutManager           (const PipelineLayoutManager&);
         PipelineLayoutManager& operator=(const PipelineLayoutManager&);
 
+        static size_t get_hash(const std::vector<DescriptorSetCreateInfoUniquePtr>* in_ds_create_info_items_ptr,
+                               const PushConstantRanges&                            in_push_constant_ranges);
+
+        Shard& get_shard(size_t in_hash)
+        {
+            return m_shards[in_hash % N_SHARDS];
+        }
+
         void on_pipeline_layout_dereferenced(Anvil::PipelineLayout* in_layout_ptr);
 
         /** Instantiates a new PipelineLayoutManager instance.
@@ -101,7 +126,7 @@ namespace Anvil
 
         /* Private members */
         const Anvil::BaseDevice* m_device_ptr;
-        PipelineLayouts          m_pipeline_layouts;
+        Shard                    m_shards[N_SHARDS];
 
         friend class BaseDevice;
     };
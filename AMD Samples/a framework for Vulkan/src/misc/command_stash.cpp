@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "misc/command_stash.h"
+#include <algorithm>
+#include <string.h>
+
+
+/* Please see header for specification */
+Anvil::CommandStash::CommandStash(size_t in_block_size)
+    :m_block_size          (in_block_size),
+     m_current_block_offset(0),
+     m_n_current_block     (0)
+{
+    anvil_assert(in_block_size > 0);
+}
+
+/* Please see header for specification */
+Anvil::CommandStash::~CommandStash()
+{
+    reset();
+}
+
+/** Returns a pointer to @param in_size bytes of uninitialized storage, aligned to @param in_alignment.
+ *
+ *  Walks the list of retained blocks first. A new block is only allocated if none of the remaining
+ *  blocks can hold the request.
+ **/
+void* Anvil::CommandStash::allocate(size_t in_size,
+                                    size_t in_alignment)
+{
+    void* result_ptr = nullptr;
+
+    anvil_assert(in_alignment > 0 && (in_alignment & (in_alignment - 1)) == 0);
+
+    while (m_n_current_block < m_blocks.size() )
+    {
+        const Block&   current_block  = m_blocks.at(m_n_current_block);
+        const uint8_t* block_data_ptr = current_block.data_ptr.get();
+        const size_t   aligned_offset = ((reinterpret_cast<uintptr_t>(block_data_ptr) + m_current_block_offset + in_alignment - 1) & ~(in_alignment - 1)) -
+                                          reinterpret_cast<uintptr_t>(block_data_ptr);
+
+        if (aligned_offset + in_size <= current_block.size)
+        {
+            result_ptr             = current_block.data_ptr.get() + aligned_offset;
+            m_current_block_offset = aligned_offset + in_size;
+
+            goto end;
+        }
+
+        /* Oversized requests are given dedicated blocks. If the next retained block is too small to hold this one,
+         * it is replaced rather than skipped, so that the number of retained blocks does not grow with every frame. */
+        ++m_n_current_block;
+        m_current_block_offset = 0;
+
+        if (m_n_current_block < m_blocks.size()                               &&
+            m_blocks.at(m_n_current_block).size < in_size + in_alignment - 1)
+        {
+            m_blocks.at(m_n_current_block) = Block(std::max(m_block_size,
+                                                            in_size + in_alignment - 1) );
+        }
+    }
+
+    m_blocks.push_back(Block(std::max(m_block_size,
+                                      in_size + in_alignment - 1) ));
+
+    m_n_current_block      = static_cast<uint32_t>(m_blocks.size() - 1);
+    m_current_block_offset = 0;
+
+    result_ptr = allocate(in_size,
+                          in_alignment);
+
+end:
+    return result_ptr;
+}
+
+/* Please see header for specification */
+const void* Anvil::CommandStash::copy_data(const void* in_data_ptr,
+                                           size_t      in_size)
+{
+    void* result_ptr = nullptr;
+
+    if (in_size == 0)
+    {
+        goto end;
+    }
+
+    anvil_assert(in_data_ptr != nullptr);
+
+    result_ptr = allocate(in_size,
+                          sizeof(uint64_t) );
+
+    memcpy(result_ptr,
+           in_data_ptr,
+           in_size);
+
+end:
+    return result_ptr;
+}
+
+/* Please see header for specification */
+const char* Anvil::CommandStash::copy_string(const char* in_string_ptr)
+{
+    const size_t string_size = (in_string_ptr != nullptr) ? strlen(in_string_ptr) + 1 /* terminator */
+                                                          : 0;
+    char*        result_ptr  = nullptr;
+
+    if (string_size == 0)
+    {
+        return "";
+    }
+
+    result_ptr = static_cast<char*>(allocate(string_size,
+                                             1) );
+
+    memcpy(result_ptr,
+           in_string_ptr,
+           string_size);
+
+    return result_ptr;
+}
+
+/* Please see header for specification */
+size_t Anvil::CommandStash::get_n_bytes_reserved() const
+{
+    size_t result = 0;
+
+    for (auto block_iterator  = m_blocks.cbegin();
+              block_iterator != m_blocks.cend();
+            ++block_iterator)
+    {
+        result += block_iterator->size;
+    }
+
+    return result;
+}
+
+/* Please see header for specification */
+size_t Anvil::CommandStash::get_n_bytes_used() const
+{
+    size_t result = 0;
+
+    for (uint32_t n_block = 0;
+                  n_block < m_n_current_block && n_block < m_blocks.size();
+                ++n_block)
+    {
+        result += m_blocks.at(n_block).size;
+    }
+
+    if (m_n_current_block < m_blocks.size() )
+    {
+        result += m_current_block_offset;
+    }
+
+    return result;
+}
+
+/* Please see header for specification */
+void Anvil::CommandStash::reset()
+{
+    /* Objects are destroyed in reverse construction order, so that command descriptors go away before the
+     * payload they point to. */
+    for (auto destructor_iterator  = m_destructors.rbegin();
+              destructor_iterator != m_destructors.rend();
+            ++destructor_iterator)
+    {
+        destructor_iterator->destroy_func_ptr(destructor_iterator->object_ptr);
+    }
+
+    m_command_ptrs.clear();
+    m_destructors.clear();
+
+    m_current_block_offset = 0;
+    m_n_current_block      = 0;
+}
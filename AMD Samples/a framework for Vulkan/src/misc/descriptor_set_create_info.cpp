@@ -27,10 +27,11 @@
 
 /** Please see header for specification */
 Anvil::DescriptorSetCreateInfo::DescriptorSetCreateInfo()
-    :m_n_variable_descriptor_count_binding   (UINT32_MAX),
+    :m_hash                                  (0),
+     m_n_variable_descriptor_count_binding   (UINT32_MAX),
      m_variable_descriptor_count_binding_size(0)
 {
-    /* Stub */
+    update_hash();
 }
 
 /** Please see header for specification */
@@ -96,6 +97,8 @@ bool Anvil::DescriptorSetCreateInfo::add_binding(uint32_t
                                            in_immutable_sampler_ptrs,
                                            in_flags);
 
+    update_hash();
+
     result  = true;
 end:
     return result;
@@ -416,6 +419,8 @@ bool Anvil::DescriptorSetCreateInfo::set_binding_variable_descriptor_count(const
     m_variable_descriptor_count_binding_size = in_count;
     result                                   = true;
 
+    update_hash();
+
 end:
     return result;
 }
@@ -426,4 +431,46 @@ bool Anvil::DescriptorSetCreateInfo::operator==(const Anvil::DescriptorSetCreate
     return (m_bindings                               == in_ds.m_bindings                               &&
             m_n_variable_descriptor_count_binding    == in_ds.m_n_variable_descriptor_count_binding    &&
             m_variable_descriptor_count_binding_size == in_ds.m_variable_descriptor_count_binding_size);
-}
\ No newline at end of file
+}
+/** Re-calculates the hash of the layout configuration. Must be called whenever any of the properties compared by
+ *  operator==() change.
+ **/
+void Anvil::DescriptorSetCreateInfo::update_hash()
+{
+    std::hash<const void*> hash_ptr;
+    std::hash<uint32_t>    hash_uint32;
+    size_t                 result_hash = 0;
+
+    Anvil::Utils::hash_combine(&result_hash,
+                               hash_uint32(m_n_variable_descriptor_count_binding) );
+    Anvil::Utils::hash_combine(&result_hash,
+                               hash_uint32(m_variable_descriptor_count_binding_size) );
+
+    for (auto binding_iterator  = m_bindings.begin();
+              binding_iterator != m_bindings.end();
+            ++binding_iterator)
+    {
+        const auto& binding_data = binding_iterator->second;
+
+        Anvil::Utils::hash_combine(&result_hash,
+                                   hash_uint32(binding_iterator->first) );
+        Anvil::Utils::hash_combine(&result_hash,
+                                   hash_uint32(binding_data.descriptor_array_size) );
+        Anvil::Utils::hash_combine(&result_hash,
+                                   hash_uint32(static_cast<uint32_t>(binding_data.descriptor_type) ) );
+        Anvil::Utils::hash_combine(&result_hash,
+                                   hash_uint32(static_cast<uint32_t>(binding_data.flags.get_vk() ) ) );
+        Anvil::Utils::hash_combine(&result_hash,
+                                   hash_uint32(static_cast<uint32_t>(binding_data.stage_flags.get_vk() ) ) );
+
+        for (auto sampler_iterator  = binding_data.immutable_samplers.begin();
+                  sampler_iterator != binding_data.immutable_samplers.end();
+                ++sampler_iterator)
+        {
+            Anvil::Utils::hash_combine(&result_hash,
+                                       hash_ptr(*sampler_iterator) );
+        }
+    }
+
+    m_hash = result_hash;
+}
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "misc/debug.h"
+#include "misc/descriptor_update_template_payload.h"
+
+/* Please see header for specification */
+Anvil::DescriptorUpdateTemplatePayload::DescriptorUpdateTemplatePayload()
+    :m_last_entry_can_be_merged(false)
+{
+    /* Stub */
+}
+
+/* Please see header for specification */
+void* Anvil::DescriptorUpdateTemplatePayload::append(Anvil::DescriptorType in_descriptor_type,
+                                                     uint32_t              in_n_binding,
+                                                     uint32_t              in_n_array_element,
+                                                     size_t                in_descriptor_size,
+                                                     bool                  in_can_be_merged)
+{
+    /* Keep all descriptors aligned to 8 bytes. All descriptor info structures, as well as non-dispatchable handles,
+     * are 8-byte aligned. */
+    const size_t descriptor_offset = Anvil::Utils::round_up(m_data.size(),
+                                                            static_cast<size_t>(8) );
+
+    anvil_assert(in_descriptor_size != 0);
+
+    m_data.resize(descriptor_offset + in_descriptor_size);
+
+    /* Fold the descriptor into the last entry if it directly follows it, both in the binding's array and in the payload. */
+    if (in_can_be_merged          &&
+        m_last_entry_can_be_merged)
+    {
+        auto& last_entry = m_entries.back();
+
+        if (last_entry.descriptor_type                                        == in_descriptor_type &&
+            last_entry.n_destination_binding                                  == in_n_binding       &&
+            last_entry.n_destination_array_element + last_entry.n_descriptors == in_n_array_element &&
+            last_entry.stride                                                 == in_descriptor_size &&
+            last_entry.offset + last_entry.stride * last_entry.n_descriptors  == descriptor_offset)
+        {
+            ++last_entry.n_descriptors;
+
+            goto end;
+        }
+    }
+
+    m_entries.push_back(
+        Anvil::DescriptorUpdateTemplateEntry(in_descriptor_type,
+                                             in_n_array_element,
+                                             in_n_binding,
+                                             1, /* in_n_descriptors */
+                                             descriptor_offset,
+                                             in_descriptor_size)
+    );
+
+    m_last_entry_can_be_merged = in_can_be_merged;
+
+end:
+    return &m_data.at(descriptor_offset);
+}
+
+/* Please see header for specification */
+void Anvil::DescriptorUpdateTemplatePayload::clear()
+{
+    m_data.clear   ();
+    m_entries.clear();
+
+    m_last_entry_can_be_merged = false;
+}
@@ -22,6 +22,31 @@
 
 #include "misc/fp16.h"
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+    #define ANVIL_FP16_X86
+
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+
+        #define ANVIL_FP16_F16C_FUNC
+    #else
+        #include <cpuid.h>
+
+        /* Lets the F16C code path be built without raising the minimum ISA of the whole library */
+        #define ANVIL_FP16_F16C_FUNC __attribute__((target("avx,f16c") ))
+    #endif
+
+    #if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+        #define ANVIL_FP16_SSE2
+    #endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define ANVIL_FP16_NEON
+
+    #include <arm_neon.h>
+#endif
+
 // Conversion tables
 static const struct PrecalcedData
 {
@@ -654,3 +679,480 @@ Anvil::float16_t Anvil::Utils::fp32_to_fp16_approx(Anvil::float32_t in_f)
 
     return o;
 }
+
+
+namespace
+{
+    typedef void (*PFNCONVERTFP16TOFP32PROC)(const uint16_t* in_fp16_values_ptr,
+                                             size_t          in_n_values,
+                                             uint32_t*       out_fp32_values_ptr);
+    typedef void (*PFNCONVERTFP32TOFP16PROC)(const uint32_t* in_fp32_values_ptr,
+                                             size_t          in_n_values,
+                                             uint16_t*       out_fp16_values_ptr);
+
+    static_assert(sizeof(Anvil::float16_t) == sizeof(uint16_t), "Anvil::float16_t must not be padded");
+    static_assert(sizeof(Anvil::float32_t) == sizeof(uint32_t), "Anvil::float32_t must not be padded");
+
+    /* Scalar versions of the array conversions. These are also used to process the tails of arrays whose sizes
+     * are not a multiple of the SIMD width, so they must return exactly the same bits as the vectorized versions.
+     *
+     * Apart from NaNs, the results match fp16_to_fp32_full() and fp32_to_fp16_full_rtne(). NaNs are quieted and
+     * keep their sign and the most significant bits of their payload, which is what F16C and NEON hardware does.
+     */
+    uint32_t convert_fp16_to_fp32_scalar(uint16_t in_fp16_value)
+    {
+        Anvil::float16_t fp16_value;
+        uint32_t         result;
+
+        fp16_value.u = in_fp16_value;
+        result       = Anvil::Utils::fp16_to_fp32_full(fp16_value).u;
+
+        if ((in_fp16_value & 0x7fffu) > 0x7c00u) // NaN
+        {
+            result |= 0x00400000u;
+        }
+
+        return result;
+    }
+
+    uint16_t convert_fp32_to_fp16_scalar(uint32_t in_fp32_value)
+    {
+        Anvil::float32_t fp32_value;
+        uint16_t         result;
+
+        if ((in_fp32_value & 0x7fffffffu) > 0x7f800000u) // NaN
+        {
+            result = static_cast<uint16_t>( ((in_fp32_value >> 16) & 0x8000u) |
+                                            0x7e00u                           |
+                                            ((in_fp32_value >> 13) & 0x03ffu) );
+        }
+        else
+        {
+            fp32_value.u = in_fp32_value;
+            result       = Anvil::Utils::fp32_to_fp16_full_rtne(fp32_value).u;
+        }
+
+        return result;
+    }
+
+    void convert_fp16_to_fp32_portable(const uint16_t* in_fp16_values_ptr,
+                                       size_t          in_n_values,
+                                       uint32_t*       out_fp32_values_ptr)
+    {
+        for (size_t n_value = 0;
+                    n_value < in_n_values;
+                  ++n_value)
+        {
+            out_fp32_values_ptr[n_value] = convert_fp16_to_fp32_scalar(in_fp16_values_ptr[n_value]);
+        }
+    }
+
+    void convert_fp32_to_fp16_portable(const uint32_t* in_fp32_values_ptr,
+                                       size_t          in_n_values,
+                                       uint16_t*       out_fp16_values_ptr)
+    {
+        for (size_t n_value = 0;
+                    n_value < in_n_values;
+                  ++n_value)
+        {
+            out_fp16_values_ptr[n_value] = convert_fp32_to_fp16_scalar(in_fp32_values_ptr[n_value]);
+        }
+    }
+
+#if defined(ANVIL_FP16_SSE2)
+    /* Branchless FP16 to FP32 conversion. Takes four FP16 values stored in the low halves of 32-bit lanes.
+     *
+     * FP16 denormals are renormalized with a FP32 subtraction whose result is always a normal number, so the
+     * FTZ and DAZ bits of MXCSR do not affect the outcome.
+     */
+    __m128i convert_fp16x4_to_fp32x4_sse2(__m128i in_fp16_values)
+    {
+        const __m128i denorm_exp_adjust = _mm_set1_epi32(1 << 23);
+        const __m128  denorm_magic      = _mm_castsi128_ps(_mm_set1_epi32(113 << 23) );
+        const __m128i exp_adjust        = _mm_set1_epi32((127 - 15) << 23);
+        const __m128i fp16_infinity     = _mm_set1_epi32(0x7c00);
+        const __m128i infnan_exp_adjust = _mm_set1_epi32((128 - 16) << 23);
+        const __m128i mask_nosign       = _mm_set1_epi32(0x7fff);
+        const __m128i quiet_bit         = _mm_set1_epi32(0x00400000);
+        const __m128i shifted_exp       = _mm_set1_epi32(0x7c00 << 13);
+
+        const __m128i exp_mantissa = _mm_and_si128  (in_fp16_values,
+                                                     mask_nosign);
+        const __m128i sign         = _mm_slli_epi32 (_mm_xor_si128(in_fp16_values,
+                                                                   exp_mantissa),
+                                                     16);
+        const __m128i is_nan       = _mm_cmpgt_epi32(exp_mantissa,
+                                                     fp16_infinity);
+        __m128i       result       = _mm_slli_epi32 (exp_mantissa,
+                                                     13);
+        const __m128i exp          = _mm_and_si128  (result,
+                                                     shifted_exp);
+        const __m128i is_infnan    = _mm_cmpeq_epi32(exp,
+                                                     shifted_exp);
+        const __m128i is_denorm    = _mm_cmpeq_epi32(exp,
+                                                     _mm_setzero_si128() );
+        __m128i       denorm;
+
+        result = _mm_add_epi32(result,
+                               exp_adjust);
+        result = _mm_add_epi32(result,
+                               _mm_and_si128(is_infnan,
+                                             infnan_exp_adjust) );
+        denorm = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(result,
+                                                                            denorm_exp_adjust) ),
+                                             denorm_magic) );
+
+        result = _mm_or_si128(_mm_andnot_si128(is_denorm,
+                                               result),
+                              _mm_and_si128   (is_denorm,
+                                               denorm) );
+        result = _mm_or_si128(result,
+                              _mm_and_si128(is_nan,
+                                            quiet_bit) );
+
+        return _mm_or_si128(result,
+                            sign);
+    }
+
+    /* Branchless FP32 to FP16 conversion, rounding to nearest even. Returns FP16 values sign-extended to 32 bits,
+     * so that two results can be narrowed with a single saturating pack.
+     *
+     * The only FP32 operation is the addition used to round FP16 denormals, which always yields a normal number.
+     * FP32 denormals flushed by DAZ round to zero either way.
+     */
+    __m128i convert_fp32x4_to_fp16x4_sse2(__m128 in_fp32_values)
+    {
+        const __m128i fp16_infinity = _mm_set1_epi32(0x7c00);
+        const __m128i fp16_max      = _mm_set1_epi32((127 + 16) << 23);  /* All FP32 values >= this round to infinity */
+        const __m128i mantissa_mask = _mm_set1_epi32(0x03ff);
+        const __m128  mask_sign     = _mm_set1_ps   (-0.0f);
+        const __m128i min_normal    = _mm_set1_epi32((127 - 14) << 23);  /* Smallest FP32 value yielding a normal FP16 */
+        const __m128i nan_bit       = _mm_set1_epi32(0x0200);
+        const __m128i normal_bias   = _mm_set1_epi32(0xfff - ((127 - 15) << 23) );
+        const __m128i subnorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+
+        const __m128  abs_value     = _mm_andnot_ps   (mask_sign,
+                                                       in_fp32_values);
+        const __m128i abs_value_int = _mm_castps_si128(abs_value);
+        const __m128i is_nan        = _mm_castps_si128(_mm_cmpunord_ps(abs_value,
+                                                                       abs_value) );
+        const __m128i is_regular    = _mm_cmpgt_epi32 (fp16_max,
+                                                       abs_value_int);
+        const __m128i is_subnormal  = _mm_cmpgt_epi32 (min_normal,
+                                                       abs_value_int);
+        const __m128i sign          = _mm_srai_epi32  (_mm_castps_si128(_mm_and_ps(in_fp32_values,
+                                                                                   mask_sign) ),
+                                                       16);
+        __m128i       inf_or_nan;
+        __m128i       mantissa_odd;
+        __m128i       normal;
+        __m128i       result;
+        __m128i       subnormal;
+
+        /* Infinity, or a quiet NaN which keeps the top bits of the payload */
+        inf_or_nan = _mm_or_si128(fp16_infinity,
+                                  _mm_and_si128(is_nan,
+                                                _mm_or_si128(nan_bit,
+                                                             _mm_and_si128(_mm_srli_epi32(abs_value_int,
+                                                                                          13),
+                                                                           mantissa_mask) )));
+
+        /* Result is a FP16 denormal: let the FP32 adder round the mantissa */
+        subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(abs_value,
+                                                              _mm_castsi128_ps(subnorm_magic) )),
+                                  subnorm_magic);
+
+        /* Result is a normal FP16: rebias the exponent and round to nearest even */
+        mantissa_odd = _mm_srai_epi32(_mm_slli_epi32(abs_value_int,
+                                                     31 - 13),
+                                      31);
+        normal       = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(abs_value_int,
+                                                                  normal_bias),
+                                                    mantissa_odd),
+                                      13);
+
+        result = _mm_or_si128(_mm_and_si128   (is_subnormal,
+                                               subnormal),
+                              _mm_andnot_si128(is_subnormal,
+                                               normal) );
+        result = _mm_or_si128(_mm_and_si128   (is_regular,
+                                               result),
+                              _mm_andnot_si128(is_regular,
+                                               inf_or_nan) );
+
+        return _mm_or_si128(result,
+                            sign);
+    }
+
+    void convert_fp16_to_fp32_sse2(const uint16_t* in_fp16_values_ptr,
+                                   size_t          in_n_values,
+                                   uint32_t*       out_fp32_values_ptr)
+    {
+        size_t n_value = 0;
+
+        for (;
+             n_value + 8 <= in_n_values;
+             n_value += 8)
+        {
+            const __m128i fp16_values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_fp16_values_ptr + n_value) );
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_fp32_values_ptr + n_value),
+                             convert_fp16x4_to_fp32x4_sse2(_mm_unpacklo_epi16(fp16_values,
+                                                                              _mm_setzero_si128() )));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_fp32_values_ptr + n_value + 4),
+                             convert_fp16x4_to_fp32x4_sse2(_mm_unpackhi_epi16(fp16_values,
+                                                                              _mm_setzero_si128() )));
+        }
+
+        convert_fp16_to_fp32_portable(in_fp16_values_ptr  + n_value,
+                                      in_n_values         - n_value,
+                                      out_fp32_values_ptr + n_value);
+    }
+
+    void convert_fp32_to_fp16_sse2(const uint32_t* in_fp32_values_ptr,
+                                   size_t          in_n_values,
+                                   uint16_t*       out_fp16_values_ptr)
+    {
+        size_t n_value = 0;
+
+        for (;
+             n_value + 8 <= in_n_values;
+             n_value += 8)
+        {
+            const __m128i fp16_values_lo = convert_fp32x4_to_fp16x4_sse2(_mm_loadu_ps(reinterpret_cast<const float*>(in_fp32_values_ptr + n_value) ));
+            const __m128i fp16_values_hi = convert_fp32x4_to_fp16x4_sse2(_mm_loadu_ps(reinterpret_cast<const float*>(in_fp32_values_ptr + n_value + 4) ));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_fp16_values_ptr + n_value),
+                             _mm_packs_epi32(fp16_values_lo,
+                                             fp16_values_hi) );
+        }
+
+        convert_fp32_to_fp16_portable(in_fp32_values_ptr  + n_value,
+                                      in_n_values         - n_value,
+                                      out_fp16_values_ptr + n_value);
+    }
+#endif /* ANVIL_FP16_SSE2 */
+
+#if defined(ANVIL_FP16_X86)
+    ANVIL_FP16_F16C_FUNC void convert_fp16_to_fp32_f16c(const uint16_t* in_fp16_values_ptr,
+                                                        size_t          in_n_values,
+                                                        uint32_t*       out_fp32_values_ptr)
+    {
+        size_t n_value = 0;
+
+        for (;
+             n_value + 8 <= in_n_values;
+             n_value += 8)
+        {
+            _mm256_storeu_ps(reinterpret_cast<float*>(out_fp32_values_ptr + n_value),
+                             _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_fp16_values_ptr + n_value) )));
+        }
+
+        convert_fp16_to_fp32_portable(in_fp16_values_ptr  + n_value,
+                                      in_n_values         - n_value,
+                                      out_fp32_values_ptr + n_value);
+    }
+
+    ANVIL_FP16_F16C_FUNC void convert_fp32_to_fp16_f16c(const uint32_t* in_fp32_values_ptr,
+                                                        size_t          in_n_values,
+                                                        uint16_t*       out_fp16_values_ptr)
+    {
+        size_t n_value = 0;
+
+        for (;
+             n_value + 8 <= in_n_values;
+             n_value += 8)
+        {
+            /* Immediate rounding mode, so that the result does not depend on MXCSR.RC */
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out_fp16_values_ptr + n_value),
+                             _mm256_cvtps_ph(_mm256_loadu_ps(reinterpret_cast<const float*>(in_fp32_values_ptr + n_value) ),
+                                             _MM_FROUND_TO_NEAREST_INT) );
+        }
+
+        convert_fp32_to_fp16_portable(in_fp32_values_ptr  + n_value,
+                                      in_n_values         - n_value,
+                                      out_fp16_values_ptr + n_value);
+    }
+
+    /* Tells if both the CPU and the OS support F16C. The VEX-encoded conversions require the OS to preserve
+     * YMM state, hence the XCR0 check. */
+    bool is_f16c_supported()
+    {
+        const uint32_t avx_bit     = 1u << 28;
+        const uint32_t f16c_bit    = 1u << 29;
+        const uint32_t osxsave_bit = 1u << 27;
+        uint32_t       ecx         = 0;
+        uint64_t       xcr0        = 0;
+
+        #if defined(_MSC_VER)
+        {
+            int cpu_info[4];
+
+            __cpuid(cpu_info,
+                    1);
+
+            ecx = static_cast<uint32_t>(cpu_info[2]);
+        }
+        #else
+        {
+            unsigned int eax_reg = 0;
+            unsigned int ebx_reg = 0;
+            unsigned int ecx_reg = 0;
+            unsigned int edx_reg = 0;
+
+            if (__get_cpuid(1,
+                           &eax_reg,
+                           &ebx_reg,
+                           &ecx_reg,
+                           &edx_reg) == 0)
+            {
+                return false;
+            }
+
+            ecx = ecx_reg;
+        }
+        #endif
+
+        if ((ecx & (avx_bit | f16c_bit | osxsave_bit)) != (avx_bit | f16c_bit | osxsave_bit) )
+        {
+            return false;
+        }
+
+        #if defined(_MSC_VER)
+        {
+            xcr0 = _xgetbv(0);
+        }
+        #else
+        {
+            uint32_t xcr0_hi = 0;
+            uint32_t xcr0_lo = 0;
+
+            __asm__ __volatile__("xgetbv"
+                                 : "=a" (xcr0_lo), "=d" (xcr0_hi)
+                                 : "c"  (0) );
+
+            xcr0 = (static_cast<uint64_t>(xcr0_hi) << 32) | xcr0_lo;
+        }
+        #endif
+
+        return (xcr0 & 0x6) == 0x6; /* XMM and YMM state */
+    }
+#endif /* ANVIL_FP16_X86 */
+
+#if defined(ANVIL_FP16_NEON)
+    /* NOTE: NEON conversions honor FPCR. The results match the other code paths for the default FPCR state
+     *       (round to nearest even, no flush-to-zero, no default NaN mode). */
+    void convert_fp16_to_fp32_neon(const uint16_t* in_fp16_values_ptr,
+                                   size_t          in_n_values,
+                                   uint32_t*       out_fp32_values_ptr)
+    {
+        size_t n_value = 0;
+
+        for (;
+             n_value + 4 <= in_n_values;
+             n_value += 4)
+        {
+            vst1q_f32(reinterpret_cast<float*>(out_fp32_values_ptr + n_value),
+                      vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in_fp16_values_ptr + n_value) )));
+        }
+
+        convert_fp16_to_fp32_portable(in_fp16_values_ptr  + n_value,
+                                      in_n_values         - n_value,
+                                      out_fp32_values_ptr + n_value);
+    }
+
+    void convert_fp32_to_fp16_neon(const uint32_t* in_fp32_values_ptr,
+                                   size_t          in_n_values,
+                                   uint16_t*       out_fp16_values_ptr)
+    {
+        size_t n_value = 0;
+
+        for (;
+             n_value + 4 <= in_n_values;
+             n_value += 4)
+        {
+            vst1_u16(out_fp16_values_ptr + n_value,
+                     vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(reinterpret_cast<const float*>(in_fp32_values_ptr + n_value) ))));
+        }
+
+        convert_fp32_to_fp16_portable(in_fp32_values_ptr  + n_value,
+                                      in_n_values         - n_value,
+                                      out_fp16_values_ptr + n_value);
+    }
+#endif /* ANVIL_FP16_NEON */
+
+    /* Picks the fastest implementation supported by the running CPU. Done once, on first use. */
+    struct ConversionFuncs
+    {
+        PFNCONVERTFP16TOFP32PROC pfn_fp16_to_fp32;
+        PFNCONVERTFP32TOFP16PROC pfn_fp32_to_fp16;
+
+        ConversionFuncs()
+            :pfn_fp16_to_fp32(convert_fp16_to_fp32_portable),
+             pfn_fp32_to_fp16(convert_fp32_to_fp16_portable)
+        {
+            #if defined(ANVIL_FP16_X86)
+            {
+                #if defined(ANVIL_FP16_SSE2)
+                {
+                    pfn_fp16_to_fp32 = convert_fp16_to_fp32_sse2;
+                    pfn_fp32_to_fp16 = convert_fp32_to_fp16_sse2;
+                }
+                #endif
+
+                if (is_f16c_supported() )
+                {
+                    pfn_fp16_to_fp32 = convert_fp16_to_fp32_f16c;
+                    pfn_fp32_to_fp16 = convert_fp32_to_fp16_f16c;
+                }
+            }
+            #elif defined(ANVIL_FP16_NEON)
+            {
+                pfn_fp16_to_fp32 = convert_fp16_to_fp32_neon;
+                pfn_fp32_to_fp16 = convert_fp32_to_fp16_neon;
+            }
+            #endif
+        }
+    };
+
+    const ConversionFuncs& get_conversion_funcs()
+    {
+        static const ConversionFuncs conversion_funcs;
+
+        return conversion_funcs;
+    }
+}
+
+void Anvil::Utils::fp16_to_fp32_array(const Anvil::float16_t* in_fp16_values_ptr,
+                                      size_t                  in_n_values,
+                                      Anvil::float32_t*       out_fp32_values_ptr)
+{
+    if (in_n_values == 0)
+    {
+        return;
+    }
+
+    anvil_assert(in_fp16_values_ptr  != nullptr);
+    anvil_assert(out_fp32_values_ptr != nullptr);
+
+    get_conversion_funcs().pfn_fp16_to_fp32(reinterpret_cast<const uint16_t*>(in_fp16_values_ptr),
+                                            in_n_values,
+                                            reinterpret_cast<uint32_t*>      (out_fp32_values_ptr) );
+}
+
+void Anvil::Utils::fp32_to_fp16_array_rtne(const Anvil::float32_t* in_fp32_values_ptr,
+                                           size_t                  in_n_values,
+                                           Anvil::float16_t*       out_fp16_values_ptr)
+{
+    if (in_n_values == 0)
+    {
+        return;
+    }
+
+    anvil_assert(in_fp32_values_ptr  != nullptr);
+    anvil_assert(out_fp16_values_ptr != nullptr);
+
+    get_conversion_funcs().pfn_fp32_to_fp16(reinterpret_cast<const uint32_t*>(in_fp32_values_ptr),
+                                            in_n_values,
+                                            reinterpret_cast<uint16_t*>      (out_fp16_values_ptr) );
+}
@@ -23,10 +23,13 @@
 #include "misc/glsl_to_spirv.h"
 #include "misc/io.h"
 #include "misc/object_tracker.h"
+#include "misc/spirv_disk_cache.h"
 #include "wrappers/device.h"
 #include "wrappers/shader_module.h"
 #include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <thread>
 
 #ifndef _WIN32
     #include <limits.h>
@@ -258,6 +261,7 @@ Anvil::GLSLShaderToSPIRVGenerator::GLSLShaderToSPIRVGenerator(const Anvil::BaseD
      m_glsl_source_code_dirty(true),
      m_mode                  (in_mode),
      m_shader_stage          (in_shader_stage),
+     m_spirv_disk_cache_ptr  (nullptr),
      m_spirv_version         (in_spirv_version)
 {
     #ifdef ANVIL_LINK_WITH_GLSLANG
@@ -519,6 +523,7 @@ bool Anvil::GLSLShaderToSPIRVGenerator::bake_spirv_blob() const
     bool           glsl_filename_is_temporary = false;
     std::string    glsl_filename_with_path;
     bool           result                     = false;
+    std::string    spirv_disk_cache_key;
 
     ANVIL_REDUNDANT_VARIABLE(glsl_filename_is_temporary);
 
@@ -538,6 +543,19 @@ bool Anvil::GLSLShaderToSPIRVGenerator::bake_spirv_blob() const
     /* Form a temporary file name we will use to write the modified GLSL shader to. */
     #ifndef ANVIL_LINK_WITH_GLSLANG
     {
+        if (m_spirv_disk_cache_ptr != nullptr)
+        {
+            spirv_disk_cache_key = get_spirv_disk_cache_key();
+
+            if (m_spirv_disk_cache_ptr->load(spirv_disk_cache_key,
+                                            &m_spirv_blob) )
+            {
+                result = true;
+
+                goto end;
+            }
+        }
+
         switch (m_shader_stage)
         {
             case ShaderStage::COMPUTE:                 glsl_filename_with_path = "temp.comp"; break;
@@ -572,23 +590,18 @@ bool Anvil::GLSLShaderToSPIRVGenerator::bake_spirv_blob() const
          * Given that the conversion process can be time-consuming, let's try to see if any of the living
          * shader module instances already use exactly the same source code.
          */
-        uint32_t n_current_shader_module = 0;
-        auto     object_tracker_ptr      = Anvil::ObjectTracker::get();
-
-        do
-        {
-            auto                       shader_module_raw_ptr = object_tracker_ptr->get_object_at_index     (Anvil::ObjectType::SHADER_MODULE,
-                                                                                                            n_current_shader_module);
-            const Anvil::ShaderModule* shader_module_ptr     = reinterpret_cast<const Anvil::ShaderModule*>(shader_module_raw_ptr);
-
-            if (shader_module_raw_ptr == nullptr)
+        /* Compare under the tracker's lock: other threads may be releasing shader modules meanwhile */
+        Anvil::ObjectTracker::get()->visit_alive_objects(
+            Anvil::ObjectType::SHADER_MODULE,
+            [this, &result](const void* in_shader_module_raw_ptr) -> bool
             {
-                /* Out of shader module instances. */
-                break;
-            }
+                const Anvil::ShaderModule* shader_module_ptr = reinterpret_cast<const Anvil::ShaderModule*>(in_shader_module_raw_ptr);
+
+                if (shader_module_ptr->get_glsl_source_code() != m_glsl_source_code)
+                {
+                    return true;
+                }
 
-            if (shader_module_ptr->get_glsl_source_code() == m_glsl_source_code)
-            {
                 const auto reference_spirv_blob               = shader_module_ptr->get_spirv_blob();
                 const auto reference_spirv_blob_size_in_bytes = reference_spirv_blob.size() * sizeof(reference_spirv_blob.at(0) );
 
@@ -601,18 +614,31 @@ bool Anvil::GLSLShaderToSPIRVGenerator::bake_spirv_blob() const
                        reference_spirv_blob_size_in_bytes);
 
                 result = true;
-                break;
-            }
+                return false;
+            });
 
-            /* Move to the next shader module instance */
-            ++n_current_shader_module;
+        if (m_spirv_blob.size() == 0 &&
+            m_spirv_disk_cache_ptr != nullptr)
+        {
+            /* No luck. Maybe the blob has been baked during one of the previous application runs? */
+            spirv_disk_cache_key = get_spirv_disk_cache_key();
+
+            result = m_spirv_disk_cache_ptr->load(spirv_disk_cache_key,
+                                                 &m_spirv_blob);
         }
-        while (n_current_shader_module != 0); /* work around "conditional expression is constant" warnings issued by some compilers */
 
         if (m_spirv_blob.size() == 0)
         {
             /* Need to bake a brand new SPIR-V blob */
             result = bake_spirv_blob_by_calling_glslang(m_glsl_source_code.c_str() );
+
+            if (result                         &&
+                m_spirv_disk_cache_ptr != nullptr)
+            {
+                m_spirv_disk_cache_ptr->store(spirv_disk_cache_key,
+                                             &m_spirv_blob.at(0),
+                                              m_spirv_blob.size() );
+            }
         }
     }
 
@@ -621,6 +647,14 @@ bool Anvil::GLSLShaderToSPIRVGenerator::bake_spirv_blob() const
         /* We need to point glslangvalidator at a location where it can stash the SPIR-V blob. */
         result = bake_spirv_blob_by_spawning_glslang_process(glsl_filename_with_path,
                                                              "temp.spv");
+
+        if (result                         &&
+            m_spirv_disk_cache_ptr != nullptr)
+        {
+            m_spirv_disk_cache_ptr->store(spirv_disk_cache_key,
+                                         &m_spirv_blob.at(0),
+                                          m_spirv_blob.size() );
+        }
     }
 
 end:
@@ -631,6 +665,135 @@ end:
     return result;
 }
 
+/* Please see header for specification */
+bool Anvil::GLSLShaderToSPIRVGenerator::bake_spirv_blobs(const std::vector<const GLSLShaderToSPIRVGenerator*>& in_generator_ptrs,
+                                                         uint32_t                                              in_n_worker_threads)
+{
+    std::atomic<uint32_t>    n_failed_generators(0);
+    std::atomic<uint32_t>    n_next_generator   (0);
+    const uint32_t           n_generators       = static_cast<uint32_t>(in_generator_ptrs.size() );
+    uint32_t                 n_worker_threads   = in_n_worker_threads;
+    std::vector<std::thread> worker_threads;
+
+    auto worker_func = [&]()
+    {
+        uint32_t n_generator;
+
+        while ( (n_generator = n_next_generator.fetch_add(1) ) < n_generators)
+        {
+            const GLSLShaderToSPIRVGenerator* generator_ptr = in_generator_ptrs.at(n_generator);
+
+            if (generator_ptr->m_spirv_blob.size() != 0)
+            {
+                continue;
+            }
+
+            if (!generator_ptr->bake_spirv_blob() )
+            {
+                ++n_failed_generators;
+            }
+        }
+    };
+
+    #ifdef ANVIL_LINK_WITH_GLSLANG
+    {
+        if (n_worker_threads == 0)
+        {
+            n_worker_threads = std::max(std::thread::hardware_concurrency(),
+                                        1u);
+        }
+    }
+    #else
+    {
+        /* All glslangvalidator processes write to the same temporary files. */
+        n_worker_threads = 1;
+    }
+    #endif
+
+    n_worker_threads = std::min(n_worker_threads,
+                                n_generators);
+
+    if (n_worker_threads <= 1)
+    {
+        worker_func();
+    }
+    else
+    {
+        /* The calling thread takes part in the baking, too. */
+        worker_threads.reserve(n_worker_threads - 1);
+
+        for (uint32_t n_worker_thread = 0;
+                      n_worker_thread < n_worker_threads - 1;
+                    ++n_worker_thread)
+        {
+            worker_threads.push_back(
+                std::thread(worker_func)
+            );
+        }
+
+        worker_func();
+
+        for (auto worker_thread_iterator  = worker_threads.begin();
+                  worker_thread_iterator != worker_threads.end();
+                ++worker_thread_iterator)
+        {
+            worker_thread_iterator->join();
+        }
+    }
+
+    return (n_failed_generators == 0);
+}
+
+/* Please see header for specification */
+std::string Anvil::GLSLShaderToSPIRVGenerator::get_spirv_disk_cache_key() const
+{
+    std::string    key_data;
+    const uint32_t shader_stage  = static_cast<uint32_t>(m_shader_stage);
+    const uint32_t spirv_version = static_cast<uint32_t>(m_spirv_version);
+
+    /* Serialize all the information that affects the contents of the SPIR-V blob */
+    if (m_glsl_source_code_dirty)
+    {
+        bake_glsl_source_code();
+
+        anvil_assert(!m_glsl_source_code_dirty);
+    }
+
+    /* NOTE: Bump the version whenever the way blobs are produced changes. */
+    key_data  = "Anvil GLSL->SPIR-V v1";
+    key_data += '\0';
+
+    #ifdef ANVIL_LINK_WITH_GLSLANG
+    {
+        key_data += glslang::GetGlslVersionString();
+        key_data += '\0';
+
+        /* TBuiltInResource is value-initialized at creation time, so any padding bytes it holds are zeroed. */
+        if (m_limits_ptr != nullptr)
+        {
+            key_data.append(reinterpret_cast<const char*>(m_limits_ptr->get_resource_ptr() ),
+                            sizeof(TBuiltInResource) );
+        }
+    }
+    #else
+    {
+        key_data += "glslangValidator";
+        key_data += '\0';
+    }
+    #endif
+
+    key_data.append(reinterpret_cast<const char*>(&shader_stage),
+                    sizeof(shader_stage) );
+    key_data.append(reinterpret_cast<const char*>(&spirv_version),
+                    sizeof(spirv_version) );
+
+    /* Definitions, extension behaviors, pragmas and placeholder values have already been applied to the source code. */
+    key_data += m_glsl_source_code;
+
+    return Anvil::SPIRVDiskCache::calculate_key(key_data.c_str(),
+                                                key_data.size() );
+}
+
 #ifdef ANVIL_LINK_WITH_GLSLANG
     /** Takes the GLSL source code, specified under @param body, converts it to SPIR-V and stores
      *  the blob data under m_spirv_blob.
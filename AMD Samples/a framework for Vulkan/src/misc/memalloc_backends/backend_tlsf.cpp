@@ -0,0 +1,525 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "misc/memalloc_backends/backend_tlsf.h"
+#include "misc/debug.h"
+#include "misc/image_create_info.h"
+#include "misc/memory_allocator.h"
+#include "misc/memory_block_create_info.h"
+#include "wrappers/buffer.h"
+#include "wrappers/device.h"
+#include "wrappers/image.h"
+#include "wrappers/memory_block.h"
+#include <algorithm>
+
+
+/** Please see header for specification */
+Anvil::MemoryAllocatorBackends::TLSF::TLSF(const Anvil::BaseDevice* in_device_ptr,
+                                           VkDeviceSize             in_page_size)
+    :m_buffer_image_granularity(in_device_ptr->get_physical_device_properties().core_vk1_0_properties_ptr->limits.buffer_image_granularity),
+     m_device_ptr              (in_device_ptr),
+     m_page_size               (in_page_size)
+{
+    anvil_assert(in_page_size > 0);
+}
+
+/** Please see header for specification */
+Anvil::MemoryAllocatorBackends::TLSF::~TLSF()
+{
+    /* Stub */
+}
+
+/* Please see header for specification */
+Anvil::MemoryAllocatorBackends::TLSF::PageProvider::PageProvider(const Anvil::BaseDevice* in_device_ptr,
+                                                                 const HeapKey&           in_key)
+    :m_device_ptr(in_device_ptr),
+     m_key       (in_key)
+{
+    /* Stub */
+}
+
+/** Allocates a new memory block of @param in_size bytes, using the memory type, device mask and memory priority
+ *  the heap has been created for.
+ *
+ *  @return Page descriptor, or nullptr if the memory block could not be allocated.
+ **/
+void* Anvil::MemoryAllocatorBackends::TLSF::PageProvider::allocate_page(VkDeviceSize in_size)
+{
+    const auto&                 memory_props    (m_device_ptr->get_physical_device_memory_properties() );
+    Anvil::MemoryBlockUniquePtr memory_block_ptr(nullptr,
+                                                 std::default_delete<Anvil::MemoryBlock>() );
+
+    {
+        auto create_info_ptr = Anvil::MemoryBlockCreateInfo::create_regular(m_device_ptr,
+                                                                            1u << m_key.memory_type_index,
+                                                                            in_size,
+                                                                            memory_props.types.at(m_key.memory_type_index).features);
+
+        create_info_ptr->set_memory_priority(m_key.memory_priority);
+        create_info_ptr->set_device_mask    (m_key.device_mask);
+        create_info_ptr->set_mt_safety      (Anvil::Utils::convert_boolean_to_mt_safety_enum(m_device_ptr->is_mt_safe()) );
+
+        memory_block_ptr = Anvil::MemoryBlock::create(std::move(create_info_ptr) );
+    }
+
+    if (memory_block_ptr == nullptr)
+    {
+        return nullptr;
+    }
+
+    return new Page(std::move(memory_block_ptr) );
+}
+
+/** Releases a memory block allocated by allocate_page(). */
+void Anvil::MemoryAllocatorBackends::TLSF::PageProvider::release_page(void* in_page_handle)
+{
+    Page* page_ptr = static_cast<Page*>(in_page_handle);
+
+    anvil_assert(page_ptr->n_map_requests == 0);
+
+    delete page_ptr;
+}
+
+/* Please see header for specification */
+bool Anvil::MemoryAllocatorBackends::TLSF::HeapKey::operator<(const HeapKey& in_key) const
+{
+    if (memory_type_index != in_key.memory_type_index)
+    {
+        return memory_type_index < in_key.memory_type_index;
+    }
+
+    if (device_mask != in_key.device_mask)
+    {
+        return device_mask < in_key.device_mask;
+    }
+
+    if (memory_priority != in_key.memory_priority)
+    {
+        return memory_priority < in_key.memory_priority;
+    }
+
+    return (!is_linear && in_key.is_linear);
+}
+
+/** For each specified Memory Allocator's Item, sub-allocates a memory region from a page of a heap matching
+ *  the item's requirements, or allocates a memory block of its own if the item requires a dedicated allocation
+ *  or an exportable external handle.
+ *
+ *  This function can be called multiple times.
+ *
+ *  @return true if all allocations have been handled successfully, false if there was at least
+ *               one failure.
+ **/
+bool Anvil::MemoryAllocatorBackends::TLSF::bake(Anvil::MemoryAllocator::Items& in_items)
+{
+    bool result = true;
+
+    for (auto& current_item_ptr : in_items)
+    {
+        uint32_t memory_type_index = UINT32_MAX;
+
+        if (!get_memory_type_index(current_item_ptr.get(),
+                                  &memory_type_index) )
+        {
+            result = false;
+
+            continue;
+        }
+
+        if (current_item_ptr->alloc_is_dedicated_memory                   ||
+            current_item_ptr->alloc_exportable_external_handle_types != 0)
+        {
+            if (!bake_dedicated_item(current_item_ptr.get(),
+                                     memory_type_index) )
+            {
+                result = false;
+            }
+        }
+        else
+        {
+            if (!bake_sub_allocated_item(current_item_ptr.get(),
+                                         memory_type_index) )
+            {
+                result = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+/** Allocates a memory block of its own for @param in_item_ptr and assigns it to the item.
+ *
+ *  @return true if successful, false otherwise.
+ **/
+bool Anvil::MemoryAllocatorBackends::TLSF::bake_dedicated_item(Anvil::MemoryAllocator::Item* in_item_ptr,
+                                                               uint32_t                      in_memory_type_index)
+{
+    const auto&                 memory_props        (m_device_ptr->get_physical_device_memory_properties() );
+    Anvil::MemoryBlockUniquePtr new_memory_block_ptr(nullptr,
+                                                     std::default_delete<Anvil::MemoryBlock>() );
+
+    {
+        auto create_info_ptr = Anvil::MemoryBlockCreateInfo::create_regular(m_device_ptr,
+                                                                            1u << in_memory_type_index,
+                                                                            in_item_ptr->alloc_size,
+                                                                            memory_props.types.at(in_memory_type_index).features);
+
+        create_info_ptr->set_memory_priority(in_item_ptr->memory_priority);
+        create_info_ptr->set_device_mask    (in_item_ptr->alloc_device_mask);
+        create_info_ptr->set_mt_safety      (Anvil::Utils::convert_boolean_to_mt_safety_enum(m_device_ptr->is_mt_safe()) );
+
+        if (in_item_ptr->alloc_is_dedicated_memory)
+        {
+            create_info_ptr->use_dedicated_allocation(in_item_ptr->buffer_ptr,
+                                                      in_item_ptr->image_ptr);
+        }
+
+        if (in_item_ptr->alloc_exportable_external_handle_types != 0)
+        {
+            create_info_ptr->set_exportable_external_memory_handle_types(in_item_ptr->alloc_exportable_external_handle_types);
+        }
+
+        #if defined(_WIN32)
+        {
+            if (in_item_ptr->alloc_external_nt_handle_info_ptr != nullptr)
+            {
+                create_info_ptr->set_exportable_nt_handle_info(in_item_ptr->alloc_external_nt_handle_info_ptr->attributes_ptr,
+                                                               in_item_ptr->alloc_external_nt_handle_info_ptr->access,
+                                                               in_item_ptr->alloc_external_nt_handle_info_ptr->name);
+            }
+        }
+        #endif
+
+        new_memory_block_ptr = Anvil::MemoryBlock::create(std::move(create_info_ptr) );
+    }
+
+    if (new_memory_block_ptr == nullptr)
+    {
+        anvil_assert(new_memory_block_ptr != nullptr);
+
+        return false;
+    }
+
+    /* NOTE: The memory block owns its memory object, so it can map & release it without the backend's help. */
+    in_item_ptr->alloc_memory_block_ptr = std::move(new_memory_block_ptr);
+    in_item_ptr->is_baked               = true;
+
+    return true;
+}
+
+/** Sub-allocates a memory region for @param in_item_ptr from a page of a heap matching the item's requirements,
+ *  and assigns a memory block wrapping the region to the item. The region is returned to the heap when
+ *  the memory block goes out of scope.
+ *
+ *  @return true if successful, false otherwise.
+ **/
+bool Anvil::MemoryAllocatorBackends::TLSF::bake_sub_allocated_item(Anvil::MemoryAllocator::Item* in_item_ptr,
+                                                                   uint32_t                      in_memory_type_index)
+{
+    Anvil::MemoryAllocatorBackends::TLSFHeap::Allocation allocation;
+    const bool                                           is_buffer            = (in_item_ptr->type == Anvil::MemoryAllocator::ITEM_TYPE_BUFFER               ||
+                                                                                 in_item_ptr->type == Anvil::MemoryAllocator::ITEM_TYPE_SPARSE_BUFFER_REGION);
+    const bool                                           is_linear            = (is_buffer)                                                                                                       ||
+                                                                                (in_item_ptr->image_ptr->get_create_info_ptr()->get_tiling() == Anvil::ImageTiling::LINEAR);
+    const HeapKey                                        key                  (in_memory_type_index,
+                                                                               in_item_ptr->alloc_device_mask,
+                                                                               in_item_ptr->memory_priority,
+                                                                               (m_buffer_image_granularity > 1) ? is_linear : false);
+    const auto&                                          memory_props         (m_device_ptr->get_physical_device_memory_properties() );
+    Anvil::MemoryBlockUniquePtr                          new_memory_block_ptr (nullptr,
+                                                                               std::default_delete<Anvil::MemoryBlock>() );
+    Page*                                                page_ptr             (nullptr);
+    Anvil::OnMemoryBlockReleaseCallbackFunction          release_callback_function;
+
+    anvil_assert(in_item_ptr->alloc_size > 0);
+
+    {
+        std::unique_lock<std::mutex> lock          (m_mutex);
+        auto                         heap_iterator = m_heaps.find(key);
+
+        if (heap_iterator == m_heaps.end() )
+        {
+            Heap new_heap;
+
+            new_heap.page_provider_ptr.reset(
+                new PageProvider(m_device_ptr,
+                                 key)
+            );
+            new_heap.tlsf_heap_ptr.reset(
+                new TLSFHeap(new_heap.page_provider_ptr.get(),
+                             m_page_size)
+            );
+
+            heap_iterator = m_heaps.insert(
+                std::make_pair(key,
+                               std::move(new_heap) )
+            ).first;
+        }
+
+        if (!heap_iterator->second.tlsf_heap_ptr->allocate(in_item_ptr->alloc_size,
+                                                           std::max(in_item_ptr->alloc_memory_required_alignment,
+                                                                    static_cast<VkDeviceSize>(1) ),
+                                                          &allocation) )
+        {
+            return false;
+        }
+    }
+
+    page_ptr = static_cast<Page*>(allocation.page_handle);
+
+    /* Bake the block and stash it */
+    release_callback_function = std::bind(&TLSF::on_memory_block_released,
+                                          shared_from_this(),
+                                          std::placeholders::_1,
+                                          key,
+                                          allocation.block_handle);
+
+    {
+        auto create_info_ptr = Anvil::MemoryBlockCreateInfo::create_derived_with_custom_delete_proc(m_device_ptr,
+                                                                                                    page_ptr->memory_block_ptr->get_memory(),
+                                                                                                    1u << in_memory_type_index,
+                                                                                                    memory_props.types.at(in_memory_type_index).features,
+                                                                                                    in_memory_type_index,
+                                                                                                    in_item_ptr->alloc_size,
+                                                                                                    allocation.offset,
+                                                                                                    release_callback_function);
+
+        new_memory_block_ptr = Anvil::MemoryBlock::create(std::move(create_info_ptr) );
+    }
+
+    if (new_memory_block_ptr == nullptr)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        anvil_assert(new_memory_block_ptr != nullptr);
+
+        m_heaps.at(key).tlsf_heap_ptr->free(allocation.block_handle);
+
+        return false;
+    }
+
+    dynamic_cast<IMemoryBlockBackendSupport*>(new_memory_block_ptr.get() )->set_parent_memory_allocator_backend_ptr(shared_from_this(),
+                                                                                                                    page_ptr);
+
+    in_item_ptr->alloc_memory_block_ptr = std::move(new_memory_block_ptr);
+    in_item_ptr->is_baked               = true;
+
+    return true;
+}
+
+/** Picks the first memory type which is supported by @param in_item_ptr, exposes all memory features
+ *  required by the item, and meets the item's peer memory requirements (if any).
+ *
+ *  @return true if a matching memory type has been found, false otherwise.
+ **/
+bool Anvil::MemoryAllocatorBackends::TLSF::get_memory_type_index(const Anvil::MemoryAllocator::Item* in_item_ptr,
+                                                                 uint32_t*                           out_memory_type_index_ptr) const
+{
+    const auto& memory_props             (m_device_ptr->get_physical_device_memory_properties() );
+    const auto& required_memory_features (in_item_ptr->alloc_memory_required_features);
+    const auto& supported_memory_types   (in_item_ptr->alloc_memory_supported_memory_types);
+
+    for (uint32_t n_memory_type = 0;
+                  n_memory_type < static_cast<uint32_t>(memory_props.types.size() );
+                ++n_memory_type)
+    {
+        bool is_peer_memory_supported = true;
+
+        if (!(supported_memory_types & (1u << n_memory_type)) )
+        {
+            continue;
+        }
+
+        if ((memory_props.types.at(n_memory_type).features & static_cast<Anvil::MemoryFeatureFlagBits>(required_memory_features.get_vk() )) != required_memory_features)
+        {
+            continue;
+        }
+
+        if (in_item_ptr->alloc_mgpu_peer_memory_reqs.size() > 0)
+        {
+            auto mgpu_device_ptr = dynamic_cast<const Anvil::MGPUDevice*>(m_device_ptr);
+
+            anvil_assert(m_device_ptr->get_type() == Anvil::DeviceType::MULTI_GPU);
+            anvil_assert(mgpu_device_ptr          != nullptr);
+
+            for (const auto& current_req : in_item_ptr->alloc_mgpu_peer_memory_reqs)
+            {
+                Anvil::PeerMemoryFeatureFlags current_memory_type_peer_memory_features;
+                const auto                    local_device_ptr                         = mgpu_device_ptr->get_physical_device(current_req.first.first);
+                const auto                    remote_device_ptr                        = mgpu_device_ptr->get_physical_device(current_req.first.second);
+
+                if (!mgpu_device_ptr->get_peer_memory_features(local_device_ptr,
+                                                               remote_device_ptr,
+                                                               memory_props.types.at(n_memory_type).heap_ptr->index,
+                                                              &current_memory_type_peer_memory_features) ||
+                    (current_memory_type_peer_memory_features & current_req.second) != current_req.second)
+                {
+                    is_peer_memory_supported = false;
+
+                    break;
+                }
+            }
+        }
+
+        if (!is_peer_memory_supported)
+        {
+            continue;
+        }
+
+        *out_memory_type_index_ptr = n_memory_type;
+
+        return true;
+    }
+
+    return false;
+}
+
+/** Please see header for specification */
+bool Anvil::MemoryAllocatorBackends::TLSF::get_statistics(uint32_t                          in_memory_type_index,
+                                                          Anvil::MemoryAllocatorStatistics* out_result_ptr) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    anvil_assert(out_result_ptr != nullptr);
+
+    *out_result_ptr = Anvil::MemoryAllocatorStatistics();
+
+    for (const auto& current_heap : m_heaps)
+    {
+        Anvil::MemoryAllocatorStatistics heap_statistics;
+
+        if (current_heap.first.memory_type_index != in_memory_type_index)
+        {
+            continue;
+        }
+
+        current_heap.second.tlsf_heap_ptr->get_statistics(&heap_statistics);
+
+        out_result_ptr->largest_free_range_size  = std::max(out_result_ptr->largest_free_range_size,
+                                                            heap_statistics.largest_free_range_size);
+        out_result_ptr->n_allocations           += heap_statistics.n_allocations;
+        out_result_ptr->n_bytes_allocated       += heap_statistics.n_bytes_allocated;
+        out_result_ptr->n_bytes_reserved        += heap_statistics.n_bytes_reserved;
+        out_result_ptr->n_free_ranges           += heap_statistics.n_free_ranges;
+        out_result_ptr->n_pages                 += heap_statistics.n_pages;
+    }
+
+    return true;
+}
+
+/** Maps the whole page a memory region has been sub-allocated from into process space.
+ *
+ *  Vulkan does not allow a memory object to be mapped more than once at a time, so the mapping is shared by all
+ *  memory blocks using the page, and reference-counted.
+ **/
+VkResult Anvil::MemoryAllocatorBackends::TLSF::map(void*        in_memory_object,
+                                                   VkDeviceSize in_start_offset,
+                                                   VkDeviceSize in_memory_block_start_offset,
+                                                   VkDeviceSize in_size,
+                                                   void**       out_result_ptr)
+{
+    std::unique_lock<std::mutex> lock     (m_mutex);
+    Page*                        page_ptr (static_cast<Page*>(in_memory_object) );
+    VkResult                     result   (VK_SUCCESS);
+
+    ANVIL_REDUNDANT_ARGUMENT(in_memory_block_start_offset);
+    ANVIL_REDUNDANT_ARGUMENT(in_size);
+    ANVIL_REDUNDANT_ARGUMENT(in_start_offset);
+
+    anvil_assert(in_start_offset == 0);
+
+    if (page_ptr->n_map_requests == 0)
+    {
+        result = Anvil::Vulkan::vkMapMemory(m_device_ptr->get_device_vk(),
+                                            page_ptr->memory_block_ptr->get_memory(),
+                                            0, /* offset */
+                                            VK_WHOLE_SIZE,
+                                            0, /* flags */
+                                           &page_ptr->mapped_data_ptr);
+
+        if (!is_vk_call_successful(result) )
+        {
+            goto end;
+        }
+    }
+
+    ++page_ptr->n_map_requests;
+
+    /* MemoryBlock adds the region's start offset on its own */
+    *out_result_ptr = page_ptr->mapped_data_ptr;
+
+end:
+    return result;
+}
+
+/** Returns a sub-allocated memory region back to its heap, after the memory block wrapping it has gone out of scope. */
+void Anvil::MemoryAllocatorBackends::TLSF::on_memory_block_released(Anvil::MemoryBlock* in_memory_block_ptr,
+                                                                    HeapKey             in_key,
+                                                                    void*               in_block_handle)
+{
+    /* Only release the region when the block it has been assigned to goes away, not its derivatives */
+    if (in_memory_block_ptr->get_create_info_ptr()->get_parent_memory_block() == nullptr)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_heaps.at(in_key).tlsf_heap_ptr->free(in_block_handle);
+    }
+}
+
+/** Always returns true */
+bool Anvil::MemoryAllocatorBackends::TLSF::supports_baking() const
+{
+    return true;
+}
+
+bool Anvil::MemoryAllocatorBackends::TLSF::supports_device_masks() const
+{
+    return true;
+}
+
+bool Anvil::MemoryAllocatorBackends::TLSF::supports_external_memory_handles(const Anvil::ExternalMemoryHandleTypeFlags&) const
+{
+    /* Exportable allocations are assigned memory blocks of their own */
+    return true;
+}
+
+bool Anvil::MemoryAllocatorBackends::TLSF::supports_protected_memory() const
+{
+    return true;
+}
+
+void Anvil::MemoryAllocatorBackends::TLSF::unmap(void* in_memory_object)
+{
+    std::unique_lock<std::mutex> lock    (m_mutex);
+    Page*                        page_ptr(static_cast<Page*>(in_memory_object) );
+
+    anvil_assert(page_ptr->n_map_requests > 0);
+
+    if (--page_ptr->n_map_requests == 0)
+    {
+        Anvil::Vulkan::vkUnmapMemory(m_device_ptr->get_device_vk(),
+                                     page_ptr->memory_block_ptr->get_memory() );
+
+        page_ptr->mapped_data_ptr = nullptr;
+    }
+}
@@ -0,0 +1,632 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "misc/memalloc_backends/tlsf_heap.h"
+#include "misc/debug.h"
+#include <algorithm>
+#include <string.h>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+
+namespace
+{
+    /* Returns the index of the most significant set bit. @param in_value must not be 0. */
+    uint32_t find_msb(uint64_t in_value)
+    {
+        #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        {
+            unsigned long result;
+
+            _BitScanReverse64(&result,
+                              in_value);
+
+            return static_cast<uint32_t>(result);
+        }
+        #elif defined(_MSC_VER)
+        {
+            unsigned long result;
+
+            if (_BitScanReverse(&result,
+                                static_cast<unsigned long>(in_value >> 32) ))
+            {
+                return static_cast<uint32_t>(result) + 32;
+            }
+
+            _BitScanReverse(&result,
+                            static_cast<unsigned long>(in_value) );
+
+            return static_cast<uint32_t>(result);
+        }
+        #else
+        {
+            return 63 - static_cast<uint32_t>(__builtin_clzll(in_value) );
+        }
+        #endif
+    }
+
+    /* Returns the index of the least significant set bit. @param in_value must not be 0. */
+    uint32_t find_lsb(uint64_t in_value)
+    {
+        #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        {
+            unsigned long result;
+
+            _BitScanForward64(&result,
+                              in_value);
+
+            return static_cast<uint32_t>(result);
+        }
+        #elif defined(_MSC_VER)
+        {
+            unsigned long result;
+
+            if (_BitScanForward(&result,
+                                static_cast<unsigned long>(in_value) ))
+            {
+                return static_cast<uint32_t>(result);
+            }
+
+            _BitScanForward(&result,
+                            static_cast<unsigned long>(in_value >> 32) );
+
+            return static_cast<uint32_t>(result) + 32;
+        }
+        #else
+        {
+            return static_cast<uint32_t>(__builtin_ctzll(in_value) );
+        }
+        #endif
+    }
+}
+
+
+/* Please see header for specification */
+Anvil::MemoryAllocatorBackends::TLSFHeap::TLSFHeap(ITLSFPageProvider* in_page_provider_ptr,
+                                                   VkDeviceSize       in_page_size)
+    :m_empty_page_ptr    (nullptr),
+     m_first_level_bitmap(0),
+     m_n_allocations     (0),
+     m_n_bytes_allocated (0),
+     m_n_bytes_reserved  (0),
+     m_page_provider_ptr (in_page_provider_ptr),
+     m_page_size         (in_page_size)
+{
+    anvil_assert(in_page_provider_ptr != nullptr);
+    anvil_assert(in_page_size         >  0);
+
+    memset(m_free_lists,
+           0,
+           sizeof(m_free_lists) );
+    memset(m_second_level_bitmaps,
+           0,
+           sizeof(m_second_level_bitmaps) );
+}
+
+/* Please see header for specification */
+Anvil::MemoryAllocatorBackends::TLSFHeap::~TLSFHeap()
+{
+    anvil_assert(m_n_allocations == 0);
+
+    for (auto page_ptr : m_page_ptrs)
+    {
+        Block* block_ptr = page_ptr->first_block_ptr;
+
+        while (block_ptr != nullptr)
+        {
+            Block* next_block_ptr = block_ptr->next_physical_block_ptr;
+
+            delete block_ptr;
+            block_ptr = next_block_ptr;
+        }
+
+        m_page_provider_ptr->release_page(page_ptr->handle);
+
+        delete page_ptr;
+    }
+
+    for (auto block_ptr : m_spare_block_ptrs)
+    {
+        delete block_ptr;
+    }
+}
+
+/** Returns a block descriptor, reusing a previously released one if available. */
+Anvil::MemoryAllocatorBackends::TLSFHeap::Block* Anvil::MemoryAllocatorBackends::TLSFHeap::acquire_block_descriptor()
+{
+    Block* result_ptr = nullptr;
+
+    if (!m_spare_block_ptrs.empty() )
+    {
+        result_ptr = m_spare_block_ptrs.back();
+
+        m_spare_block_ptrs.pop_back();
+    }
+    else
+    {
+        result_ptr = new Block();
+    }
+
+    memset(result_ptr,
+           0,
+           sizeof(Block) );
+
+    return result_ptr;
+}
+
+/* Please see header for specification */
+bool Anvil::MemoryAllocatorBackends::TLSFHeap::allocate(VkDeviceSize in_size,
+                                                        VkDeviceSize in_alignment,
+                                                        Allocation*  out_result_ptr)
+{
+    Block*             block_ptr   = nullptr;
+    const VkDeviceSize padded_size = in_size + in_alignment - 1;
+    VkDeviceSize       padding     = 0;
+    bool               result      = false;
+
+    anvil_assert(in_size        >  0);
+    anvil_assert(in_alignment   >  0 && (in_alignment & (in_alignment - 1)) == 0);
+    anvil_assert(out_result_ptr != nullptr);
+
+    /* Most ranges are tightly packed, so a free range of the requested size usually starts at an offset which is
+     * already suitably aligned. Only if it is not, look for a range which can hold the range regardless of how
+     * misaligned it is. */
+    block_ptr = find_free_block(in_size);
+
+    if ( block_ptr != nullptr   &&
+        !fits(block_ptr,
+              in_size,
+              in_alignment) )
+    {
+        block_ptr = (in_alignment > 1) ? find_free_block(padded_size)
+                                       : nullptr;
+    }
+
+    if (block_ptr == nullptr)
+    {
+        /* Requests which would not fit in a regular page get a page of their own. Dedicated pages start at
+         * offset 0, so no padding is needed. */
+        const bool is_dedicated = (padded_size > m_page_size);
+        Page*      page_ptr     = allocate_page((is_dedicated) ? in_size
+                                                               : m_page_size,
+                                                is_dedicated);
+
+        if (page_ptr == nullptr)
+        {
+            goto end;
+        }
+
+        block_ptr = page_ptr->first_block_ptr;
+    }
+
+    anvil_assert(fits(block_ptr,
+                      in_size,
+                      in_alignment) );
+
+    remove_free_block(block_ptr);
+
+    /* Return the misaligned head of the range to the heap */
+    padding = Anvil::Utils::round_up(block_ptr->offset,
+                                     in_alignment) - block_ptr->offset;
+
+    if (padding > 0)
+    {
+        Block* head_block_ptr = block_ptr;
+
+        block_ptr = split_block(head_block_ptr,
+                                padding);
+
+        insert_free_block(head_block_ptr);
+    }
+
+    /* Return the unused tail of the range to the heap */
+    if (block_ptr->size > in_size)
+    {
+        insert_free_block(split_block(block_ptr,
+                                      in_size) );
+    }
+
+    block_ptr->is_free = false;
+
+    if (block_ptr->page_ptr->n_allocations++ == 0 &&
+        block_ptr->page_ptr                  == m_empty_page_ptr)
+    {
+        m_empty_page_ptr = nullptr;
+    }
+
+    m_n_allocations     += 1;
+    m_n_bytes_allocated += block_ptr->size;
+
+    out_result_ptr->block_handle = block_ptr;
+    out_result_ptr->offset       = block_ptr->offset;
+    out_result_ptr->page_handle  = block_ptr->page_ptr->handle;
+    out_result_ptr->size         = block_ptr->size;
+
+    result = true;
+end:
+    return result;
+}
+
+/** Requests a new page from the page provider and makes its storage available for sub-allocation.
+ *
+ *  @return Page descriptor, or nullptr if the page provider failed to allocate the page.
+ **/
+Anvil::MemoryAllocatorBackends::TLSFHeap::Page* Anvil::MemoryAllocatorBackends::TLSFHeap::allocate_page(VkDeviceSize in_size,
+                                                                                                         bool         in_is_dedicated)
+{
+    Block* block_ptr   = nullptr;
+    void*  page_handle = m_page_provider_ptr->allocate_page(in_size);
+    Page*  result_ptr  = nullptr;
+
+    if (page_handle == nullptr)
+    {
+        goto end;
+    }
+
+    block_ptr  = acquire_block_descriptor();
+    result_ptr = new Page();
+
+    block_ptr->is_free  = false;
+    block_ptr->offset   = 0;
+    block_ptr->page_ptr = result_ptr;
+    block_ptr->size     = in_size;
+
+    result_ptr->first_block_ptr = block_ptr;
+    result_ptr->handle          = page_handle;
+    result_ptr->is_dedicated    = in_is_dedicated;
+    result_ptr->n_allocations   = 0;
+    result_ptr->size            = in_size;
+
+    insert_free_block(block_ptr);
+
+    m_n_bytes_reserved += in_size;
+
+    m_page_ptrs.push_back(result_ptr);
+end:
+    return result_ptr;
+}
+
+/** Returns a free block at least @param in_size bytes large, or nullptr if none is available.
+ *
+ *  The size is rounded up to the next second-level boundary first, so that any block in the list
+ *  the search starts from is large enough. The block is NOT removed from its free list.
+ **/
+Anvil::MemoryAllocatorBackends::TLSFHeap::Block* Anvil::MemoryAllocatorBackends::TLSFHeap::find_free_block(VkDeviceSize in_size)
+{
+    uint32_t     first_level_index  = 0;
+    uint64_t     first_level_map    = 0;
+    VkDeviceSize rounded_size       = in_size;
+    uint32_t     second_level_index = 0;
+    uint32_t     second_level_map   = 0;
+
+    if (in_size >= SECOND_LEVEL_COUNT)
+    {
+        const VkDeviceSize round_mask = (static_cast<VkDeviceSize>(1) << (find_msb(in_size) - SECOND_LEVEL_INDEX_LOG2) ) - 1;
+
+        if (in_size > ~static_cast<VkDeviceSize>(0) - round_mask)
+        {
+            return nullptr;
+        }
+
+        rounded_size = in_size + round_mask;
+    }
+
+    get_list_indices(rounded_size,
+                    &first_level_index,
+                    &second_level_index);
+
+    second_level_map = m_second_level_bitmaps[first_level_index] & (~0u << second_level_index);
+
+    if (second_level_map == 0)
+    {
+        /* No block in this size class is large enough. Move on to the next non-empty size class. */
+        first_level_map = (first_level_index + 1 < FIRST_LEVEL_COUNT) ? (m_first_level_bitmap & (~static_cast<uint64_t>(0) << (first_level_index + 1) ))
+                                                                      : 0;
+
+        if (first_level_map == 0)
+        {
+            return nullptr;
+        }
+
+        first_level_index = find_lsb(first_level_map);
+        second_level_map  = m_second_level_bitmaps[first_level_index];
+    }
+
+    second_level_index = find_lsb(second_level_map);
+
+    return m_free_lists[first_level_index][second_level_index];
+}
+
+/** Tells whether @param in_block_ptr can hold a range of @param in_size bytes aligned to @param in_alignment. */
+bool Anvil::MemoryAllocatorBackends::TLSFHeap::fits(const Block* in_block_ptr,
+                                                    VkDeviceSize in_size,
+                                                    VkDeviceSize in_alignment) const
+{
+    const VkDeviceSize padding = Anvil::Utils::round_up(in_block_ptr->offset,
+                                                        in_alignment) - in_block_ptr->offset;
+
+    return (padding                      <= in_block_ptr->size &&
+            in_block_ptr->size - padding >= in_size);
+}
+
+/* Please see header for specification */
+void Anvil::MemoryAllocatorBackends::TLSFHeap::free(void* in_block_handle)
+{
+    Block* block_ptr = static_cast<Block*>(in_block_handle);
+    Page*  page_ptr  = nullptr;
+
+    anvil_assert(block_ptr          != nullptr);
+    anvil_assert(!block_ptr->is_free);
+
+    page_ptr = block_ptr->page_ptr;
+
+    anvil_assert(m_n_allocations         > 0);
+    anvil_assert(page_ptr->n_allocations > 0);
+
+    m_n_allocations     -= 1;
+    m_n_bytes_allocated -= block_ptr->size;
+    page_ptr->n_allocations--;
+
+    block_ptr->is_free = true;
+
+    /* Merge with physically adjacent free blocks */
+    if (block_ptr->prev_physical_block_ptr          != nullptr &&
+        block_ptr->prev_physical_block_ptr->is_free)
+    {
+        Block* prev_block_ptr = block_ptr->prev_physical_block_ptr;
+
+        remove_free_block(prev_block_ptr);
+
+        prev_block_ptr->size                    += block_ptr->size;
+        prev_block_ptr->next_physical_block_ptr  = block_ptr->next_physical_block_ptr;
+
+        if (block_ptr->next_physical_block_ptr != nullptr)
+        {
+            block_ptr->next_physical_block_ptr->prev_physical_block_ptr = prev_block_ptr;
+        }
+
+        release_block_descriptor(block_ptr);
+
+        block_ptr = prev_block_ptr;
+    }
+
+    if (block_ptr->next_physical_block_ptr          != nullptr &&
+        block_ptr->next_physical_block_ptr->is_free)
+    {
+        Block* next_block_ptr = block_ptr->next_physical_block_ptr;
+
+        remove_free_block(next_block_ptr);
+
+        block_ptr->size                    += next_block_ptr->size;
+        block_ptr->next_physical_block_ptr  = next_block_ptr->next_physical_block_ptr;
+
+        if (next_block_ptr->next_physical_block_ptr != nullptr)
+        {
+            next_block_ptr->next_physical_block_ptr->prev_physical_block_ptr = block_ptr;
+        }
+
+        release_block_descriptor(next_block_ptr);
+    }
+
+    if (page_ptr->n_allocations == 0)
+    {
+        anvil_assert(block_ptr       == page_ptr->first_block_ptr);
+        anvil_assert(block_ptr->size == page_ptr->size);
+
+        if (page_ptr->is_dedicated       ||
+            m_empty_page_ptr != nullptr)
+        {
+            release_page(page_ptr);
+
+            goto end;
+        }
+
+        m_empty_page_ptr = page_ptr;
+    }
+
+    insert_free_block(block_ptr);
+
+end:
+    ;
+}
+
+/** Maps a block size to indices of the free list the block belongs to. */
+void Anvil::MemoryAllocatorBackends::TLSFHeap::get_list_indices(VkDeviceSize in_size,
+                                                                uint32_t*    out_first_level_index_ptr,
+                                                                uint32_t*    out_second_level_index_ptr)
+{
+    if (in_size < SECOND_LEVEL_COUNT)
+    {
+        *out_first_level_index_ptr  = 0;
+        *out_second_level_index_ptr = static_cast<uint32_t>(in_size);
+    }
+    else
+    {
+        const uint32_t msb = find_msb(in_size);
+
+        *out_first_level_index_ptr  = msb - SECOND_LEVEL_INDEX_LOG2 + 1;
+        *out_second_level_index_ptr = static_cast<uint32_t>(in_size >> (msb - SECOND_LEVEL_INDEX_LOG2) ) - SECOND_LEVEL_COUNT;
+    }
+}
+
+/* Please see header for specification */
+void Anvil::MemoryAllocatorBackends::TLSFHeap::get_statistics(Anvil::MemoryAllocatorStatistics* out_result_ptr) const
+{
+    anvil_assert(out_result_ptr != nullptr);
+
+    *out_result_ptr = Anvil::MemoryAllocatorStatistics();
+
+    out_result_ptr->n_allocations     = m_n_allocations;
+    out_result_ptr->n_bytes_allocated = m_n_bytes_allocated;
+    out_result_ptr->n_bytes_reserved  = m_n_bytes_reserved;
+    out_result_ptr->n_pages           = static_cast<uint32_t>(m_page_ptrs.size() );
+
+    for (uint32_t first_level_index = 0;
+                  first_level_index < FIRST_LEVEL_COUNT;
+                ++first_level_index)
+    {
+        if ((m_first_level_bitmap & (static_cast<uint64_t>(1) << first_level_index)) == 0)
+        {
+            continue;
+        }
+
+        for (uint32_t second_level_index = 0;
+                      second_level_index < SECOND_LEVEL_COUNT;
+                    ++second_level_index)
+        {
+            for (const Block* block_ptr  = m_free_lists[first_level_index][second_level_index];
+                              block_ptr != nullptr;
+                              block_ptr  = block_ptr->next_free_block_ptr)
+            {
+                out_result_ptr->largest_free_range_size = std::max(out_result_ptr->largest_free_range_size,
+                                                                   block_ptr->size);
+                out_result_ptr->n_free_ranges++;
+            }
+        }
+    }
+}
+
+/** Pushes a free block to the front of the free list matching its size. */
+void Anvil::MemoryAllocatorBackends::TLSFHeap::insert_free_block(Block* in_block_ptr)
+{
+    uint32_t first_level_index  = 0;
+    uint32_t second_level_index = 0;
+
+    get_list_indices(in_block_ptr->size,
+                    &first_level_index,
+                    &second_level_index);
+
+    in_block_ptr->is_free             = true;
+    in_block_ptr->next_free_block_ptr = m_free_lists[first_level_index][second_level_index];
+    in_block_ptr->prev_free_block_ptr = nullptr;
+
+    if (in_block_ptr->next_free_block_ptr != nullptr)
+    {
+        in_block_ptr->next_free_block_ptr->prev_free_block_ptr = in_block_ptr;
+    }
+
+    m_free_lists[first_level_index][second_level_index] = in_block_ptr;
+
+    m_first_level_bitmap                      |= static_cast<uint64_t>(1) << first_level_index;
+    m_second_level_bitmaps[first_level_index] |= 1u                       << second_level_index;
+}
+
+/** Stashes a block descriptor for reuse. */
+void Anvil::MemoryAllocatorBackends::TLSFHeap::release_block_descriptor(Block* in_block_ptr)
+{
+    m_spare_block_ptrs.push_back(in_block_ptr);
+}
+
+/** Returns an empty page to the page provider. The page's only block must not be in a free list. */
+void Anvil::MemoryAllocatorBackends::TLSFHeap::release_page(Page* in_page_ptr)
+{
+    auto page_iterator = std::find(m_page_ptrs.begin(),
+                                   m_page_ptrs.end  (),
+                                   in_page_ptr);
+
+    anvil_assert(in_page_ptr->n_allocations == 0);
+    anvil_assert(page_iterator              != m_page_ptrs.end() );
+
+    m_page_ptrs.erase(page_iterator);
+
+    m_n_bytes_reserved -= in_page_ptr->size;
+
+    m_page_provider_ptr->release_page(in_page_ptr->handle);
+
+    release_block_descriptor(in_page_ptr->first_block_ptr);
+
+    delete in_page_ptr;
+}
+
+/** Unlinks a free block from its free list. */
+void Anvil::MemoryAllocatorBackends::TLSFHeap::remove_free_block(Block* in_block_ptr)
+{
+    uint32_t first_level_index  = 0;
+    uint32_t second_level_index = 0;
+
+    anvil_assert(in_block_ptr->is_free);
+
+    get_list_indices(in_block_ptr->size,
+                    &first_level_index,
+                    &second_level_index);
+
+    if (in_block_ptr->prev_free_block_ptr != nullptr)
+    {
+        in_block_ptr->prev_free_block_ptr->next_free_block_ptr = in_block_ptr->next_free_block_ptr;
+    }
+    else
+    {
+        anvil_assert(m_free_lists[first_level_index][second_level_index] == in_block_ptr);
+
+        m_free_lists[first_level_index][second_level_index] = in_block_ptr->next_free_block_ptr;
+
+        if (m_free_lists[first_level_index][second_level_index] == nullptr)
+        {
+            m_second_level_bitmaps[first_level_index] &= ~(1u << second_level_index);
+
+            if (m_second_level_bitmaps[first_level_index] == 0)
+            {
+                m_first_level_bitmap &= ~(static_cast<uint64_t>(1) << first_level_index);
+            }
+        }
+    }
+
+    if (in_block_ptr->next_free_block_ptr != nullptr)
+    {
+        in_block_ptr->next_free_block_ptr->prev_free_block_ptr = in_block_ptr->prev_free_block_ptr;
+    }
+
+    in_block_ptr->is_free             = false;
+    in_block_ptr->next_free_block_ptr = nullptr;
+    in_block_ptr->prev_free_block_ptr = nullptr;
+}
+
+/** Shrinks @param in_block_ptr to @param in_size bytes and returns a new block descriptor for the remainder.
+ *
+ *  Neither of the blocks is inserted into a free list.
+ **/
+Anvil::MemoryAllocatorBackends::TLSFHeap::Block* Anvil::MemoryAllocatorBackends::TLSFHeap::split_block(Block*       in_block_ptr,
+                                                                                                       VkDeviceSize in_size)
+{
+    Block* result_ptr = acquire_block_descriptor();
+
+    anvil_assert(!in_block_ptr->is_free);
+    anvil_assert(in_block_ptr->size > in_size);
+
+    result_ptr->offset                  = in_block_ptr->offset + in_size;
+    result_ptr->page_ptr                = in_block_ptr->page_ptr;
+    result_ptr->size                    = in_block_ptr->size   - in_size;
+    result_ptr->next_physical_block_ptr = in_block_ptr->next_physical_block_ptr;
+    result_ptr->prev_physical_block_ptr = in_block_ptr;
+
+    if (in_block_ptr->next_physical_block_ptr != nullptr)
+    {
+        in_block_ptr->next_physical_block_ptr->prev_physical_block_ptr = result_ptr;
+    }
+
+    in_block_ptr->next_physical_block_ptr = result_ptr;
+    in_block_ptr->size                    = in_size;
+
+    return result_ptr;
+}
@@ -27,6 +27,7 @@
 #include "misc/instance_create_info.h"
 #include "misc/memory_allocator.h"
 #include "misc/memalloc_backends/backend_oneshot.h"
+#include "misc/memalloc_backends/backend_tlsf.h"
 #include "misc/memalloc_backends/backend_vma.h"
 #include "wrappers/buffer.h"
 #include "wrappers/device.h"
@@ -2126,6 +2127,36 @@ Anvil::MemoryAllocatorUniquePtr Anvil::MemoryAllocator::create_vma(const Anvil::
     return std::move(result_ptr);
 }
 
+/* Please see header for specification */
+Anvil::MemoryAllocatorUniquePtr Anvil::MemoryAllocator::create_tlsf(const Anvil::BaseDevice* in_device_ptr,
+                                                                    MTSafety                 in_mt_safety,
+                                                                    VkDeviceSize             in_page_size)
+{
+    std::shared_ptr<IMemoryAllocatorBackend> backend_ptr;
+    const bool                               mt_safe    (Anvil::Utils::convert_mt_safety_enum_to_boolean(in_mt_safety,
+                                                                                                         in_device_ptr) );
+    std::unique_ptr<MemoryAllocator>         result_ptr (nullptr,
+                                                         std::default_delete<MemoryAllocator>() );
+
+    anvil_assert(in_page_size > 0);
+
+    backend_ptr.reset(
+        new Anvil::MemoryAllocatorBackends::TLSF(in_device_ptr,
+                                                 in_page_size)
+    );
+
+    if (backend_ptr != nullptr)
+    {
+        result_ptr.reset(
+            new Anvil::MemoryAllocator(in_device_ptr,
+                                       backend_ptr,
+                                       mt_safe)
+        );
+    }
+
+    return std::move(result_ptr);
+}
+
 bool Anvil::MemoryAllocator::do_external_memory_handle_type_sanity_checks(const Anvil::ExternalMemoryHandleTypeFlags& in_external_memory_handle_types) const
 {
     bool result = true;
@@ -2143,6 +2174,16 @@ bool Anvil::MemoryAllocator::do_external_memory_handle_type_sanity_checks(const
     return result;
 }
 
+/* Please see header for specification */
+bool Anvil::MemoryAllocator::get_statistics(uint32_t                          in_memory_type_index,
+                                            Anvil::MemoryAllocatorStatistics* out_result_ptr) const
+{
+    anvil_assert(out_result_ptr != nullptr);
+
+    return m_backend_ptr->get_statistics(in_memory_type_index,
+                                         out_result_ptr);
+}
+
 /** Tells whether or not a given set of memory types supports the requested memory features. */
 bool Anvil::MemoryAllocator::get_mem_types_supporting_mem_features(const Anvil::BaseDevice*         in_device_ptr,
                                                                    uint32_t                         in_memory_types,
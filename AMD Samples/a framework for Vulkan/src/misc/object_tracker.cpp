@@ -28,11 +28,75 @@
 static Anvil::ObjectTracker* object_tracker_ptr = nullptr;
 
 
+/* Object types, in shard order. Must be kept in sync with ObjectTracker::get_shard_index(). */
+static const Anvil::ObjectType g_shard_object_types[] =
+{
+    Anvil::ObjectType::BUFFER,
+    Anvil::ObjectType::BUFFER_VIEW,
+    Anvil::ObjectType::COMMAND_BUFFER,
+    Anvil::ObjectType::COMMAND_POOL,
+    Anvil::ObjectType::DEBUG_REPORT_CALLBACK,
+    Anvil::ObjectType::DEBUG_UTILS_MESSENGER,
+    Anvil::ObjectType::DESCRIPTOR_POOL,
+    Anvil::ObjectType::DESCRIPTOR_SET,
+    Anvil::ObjectType::DESCRIPTOR_SET_LAYOUT,
+    Anvil::ObjectType::DESCRIPTOR_UPDATE_TEMPLATE,
+    Anvil::ObjectType::DEVICE,
+    Anvil::ObjectType::EVENT,
+    Anvil::ObjectType::FENCE,
+    Anvil::ObjectType::FRAMEBUFFER,
+    Anvil::ObjectType::IMAGE,
+    Anvil::ObjectType::IMAGE_VIEW,
+    Anvil::ObjectType::INSTANCE,
+    Anvil::ObjectType::PHYSICAL_DEVICE,
+    Anvil::ObjectType::PIPELINE,
+    Anvil::ObjectType::PIPELINE_CACHE,
+    Anvil::ObjectType::PIPELINE_LAYOUT,
+    Anvil::ObjectType::QUERY_POOL,
+    Anvil::ObjectType::QUEUE,
+    Anvil::ObjectType::RENDER_PASS,
+    Anvil::ObjectType::RENDERING_SURFACE,
+    Anvil::ObjectType::SAMPLER,
+    Anvil::ObjectType::SAMPLER_YCBCR_CONVERSION,
+    Anvil::ObjectType::SEMAPHORE,
+    Anvil::ObjectType::SHADER_MODULE,
+    Anvil::ObjectType::SWAPCHAIN,
+
+    Anvil::ObjectType::ANVIL_COMPUTE_PIPELINE_MANAGER,
+    Anvil::ObjectType::ANVIL_DESCRIPTOR_SET_GROUP,
+    Anvil::ObjectType::ANVIL_DESCRIPTOR_SET_LAYOUT_MANAGER,
+    Anvil::ObjectType::ANVIL_GLSL_SHADER_TO_SPIRV_GENERATOR,
+    Anvil::ObjectType::ANVIL_GRAPHICS_PIPELINE_MANAGER,
+    Anvil::ObjectType::ANVIL_MEMORY_BLOCK,
+    Anvil::ObjectType::ANVIL_PIPELINE_LAYOUT_MANAGER,
+
+    Anvil::ObjectType::UNKNOWN
+};
+
+
 /** Constructor. */
 Anvil::ObjectTracker::ObjectTracker()
     :CallbacksSupportProvider(OBJECT_TRACKER_CALLBACK_ID_COUNT)
 {
-    /* Stub */
+    static_assert(sizeof(g_shard_object_types) / sizeof(g_shard_object_types[0]) == N_SHARDS,
+                  "Shard count does not match the number of object types");
+
+    for (uint32_t n_shard = 0;
+                  n_shard < N_SHARDS;
+                ++n_shard)
+    {
+        auto& current_shard = m_shards[n_shard];
+
+        anvil_assert(get_shard_index(g_shard_object_types[n_shard]) == n_shard);
+
+        current_shard.n_alive_objects.store  (0);
+        current_shard.n_created_objects.store(0);
+
+        current_shard.n_created_objects_at_last_snapshot = 0;
+        current_shard.object_type                        = g_shard_object_types[n_shard];
+    }
+
+    m_last_snapshot_time_msec = m_time.get_time_in_msec();
 }
 
 /* Please see header for specification */
@@ -57,29 +121,49 @@ Anvil::ObjectTracker* Anvil::ObjectTracker::get()
 /* Please see header for specification */
 void Anvil::ObjectTracker::check_for_leaks() const
 {
-    std::unique_lock<std::mutex> lock(m_cs);
-
-    for (const auto& current_object_type_alloc_data : m_object_allocations)
+    for (const auto& current_shard : m_shards)
     {
-        const uint32_t n_object_allocations = static_cast<uint32_t>(current_object_type_alloc_data.second.size() );
+        ObjectAllocations alive_allocations;
 
-        if (n_object_allocations > 0)
+        if (current_shard.n_alive_objects.load() == 0)
         {
-            fprintf(stdout,
-                    "The following %s instances have not been released:\n",
-                    get_object_type_name(current_object_type_alloc_data.first) );
+            continue;
+        }
 
-            for (const auto& current_alloc : current_object_type_alloc_data.second)
-            {
-                fprintf(stdout,
-                        "[%d]. %p\n",
-                        current_alloc.n_allocation,
-                        current_alloc.object_ptr);
-            }
+        {
+            std::unique_lock<std::mutex> lock(current_shard.cs);
+
+            alive_allocations = current_shard.allocations;
+        }
+
+        if (alive_allocations.size() == 0)
+        {
+            continue;
+        }
 
+        /* Slots are reused as objects are unregistered. Restore creation order for readability. */
+        std::sort(alive_allocations.begin(),
+                  alive_allocations.end(),
+                  [](const ObjectAllocation& in_allocation1,
+                     const ObjectAllocation& in_allocation2)
+                  {
+                      return in_allocation1.n_allocation < in_allocation2.n_allocation;
+                  });
+
+        fprintf(stdout,
+                "The following %s instances have not been released:\n",
+                get_object_type_name(current_shard.object_type) );
+
+        for (const auto& current_alloc : alive_allocations)
+        {
             fprintf(stdout,
-                    "\n");
+                    "[%d]. %p\n",
+                    current_alloc.n_allocation,
+                    current_alloc.object_ptr);
         }
+
+        fprintf(stdout,
+                "\n");
     }
 }
 
@@ -99,6 +183,8 @@ const char* Anvil::ObjectTracker::get_object_type_name(const Anvil::ObjectType&
         case Anvil::ObjectType::BUFFER_VIEW:                result_ptr = "Buffer View";                break;
         case Anvil::ObjectType::COMMAND_BUFFER:             result_ptr = "Command Buffer";             break;
         case Anvil::ObjectType::COMMAND_POOL:               result_ptr = "Command Pool";               break;
+        case Anvil::ObjectType::DEBUG_REPORT_CALLBACK:      result_ptr = "Debug Report Callback";      break;
+        case Anvil::ObjectType::DEBUG_UTILS_MESSENGER:      result_ptr = "Debug Utils Messenger";      break;
         case Anvil::ObjectType::DESCRIPTOR_POOL:            result_ptr = "Descriptor Pool";            break;
         case Anvil::ObjectType::DESCRIPTOR_SET:             result_ptr = "Descriptor Set";             break;
         case Anvil::ObjectType::DESCRIPTOR_SET_LAYOUT:      result_ptr = "Descriptor Set Layout";      break;
@@ -111,6 +197,7 @@ const char* Anvil::ObjectTracker::get_object_type_name(const Anvil::ObjectType&
         case Anvil::ObjectType::IMAGE_VIEW:                 result_ptr = "Image View";                 break;
         case Anvil::ObjectType::INSTANCE:                   result_ptr = "Instance";                   break;
         case Anvil::ObjectType::PHYSICAL_DEVICE:            result_ptr = "Physical Device";            break;
+        case Anvil::ObjectType::PIPELINE:                   result_ptr = "Pipeline";                   break;
         case Anvil::ObjectType::PIPELINE_CACHE:             result_ptr = "Pipeline Cache";             break;
         case Anvil::ObjectType::PIPELINE_LAYOUT:            result_ptr = "Pipeline Layout";            break;
         case Anvil::ObjectType::QUERY_POOL:                 result_ptr = "Query Pool";                 break;
@@ -118,6 +205,7 @@ const char* Anvil::ObjectTracker::get_object_type_name(const Anvil::ObjectType&
         case Anvil::ObjectType::RENDER_PASS:                result_ptr = "Render Pass";                break;
         case Anvil::ObjectType::RENDERING_SURFACE:          result_ptr = "Rendering Surface";          break;
         case Anvil::ObjectType::SAMPLER:                    result_ptr = "Sampler";                    break;
+        case Anvil::ObjectType::SAMPLER_YCBCR_CONVERSION:   result_ptr = "Sampler YCbCr Conversion";   break;
         case Anvil::ObjectType::SEMAPHORE:                  result_ptr = "Semaphore";                  break;
         case Anvil::ObjectType::SHADER_MODULE:              result_ptr = "Shader Module";              break;
         case Anvil::ObjectType::SWAPCHAIN:                  result_ptr = "Swapchain";                  break;
@@ -130,6 +218,8 @@ const char* Anvil::ObjectTracker::get_object_type_name(const Anvil::ObjectType&
         case Anvil::ObjectType::ANVIL_MEMORY_BLOCK:                   result_ptr = "Anvil Memory Block";                  break;
         case Anvil::ObjectType::ANVIL_PIPELINE_LAYOUT_MANAGER:        result_ptr = "Anvil Pipeline Layout Manager";       break;
 
+        case Anvil::ObjectType::UNKNOWN: result_ptr = "Unknown"; break;
+
         default:
         {
             anvil_assert_fail();
@@ -139,34 +229,213 @@ const char* Anvil::ObjectTracker::get_object_type_name(const Anvil::ObjectType&
     return result_ptr;
 }
 
+/* Please see header for specification */
+void Anvil::ObjectTracker::visit_alive_objects(const ObjectType&                in_object_type,
+                                               std::function<bool(const void*)> in_visitor_func) const
+{
+    const Shard&                 shard(get_shard(in_object_type) );
+    std::unique_lock<std::mutex> lock (shard.cs);
+    std::vector<uint32_t>        slot_indices;
+
+    /* Slots are reused as objects are unregistered. Restore registration order. */
+    slot_indices.reserve(shard.allocations.size() );
+
+    for (uint32_t n_slot = 0;
+                  n_slot < static_cast<uint32_t>(shard.allocations.size() );
+                ++n_slot)
+    {
+        slot_indices.push_back(n_slot);
+    }
+
+    std::sort(slot_indices.begin(),
+              slot_indices.end(),
+              [&shard](uint32_t in_slot_index1,
+                       uint32_t in_slot_index2)
+              {
+                  return shard.allocations.at(in_slot_index1).n_allocation < shard.allocations.at(in_slot_index2).n_allocation;
+              });
+
+    for (const auto& current_slot_index : slot_indices)
+    {
+        if (!in_visitor_func(shard.allocations.at(current_slot_index).object_ptr) )
+        {
+            break;
+        }
+    }
+}
+
+/* Please see header for specification */
+uint32_t Anvil::ObjectTracker::get_n_alive_objects(const ObjectType& in_object_type) const
+{
+    return get_shard(in_object_type).n_alive_objects.load();
+}
+
 /* Please see header for specification */
 void* Anvil::ObjectTracker::get_object_at_index(const ObjectType& in_object_type,
                                                 uint32_t          in_alloc_index) const
 {
-    std::unique_lock<std::mutex> lock (m_cs);
-    void*                        result(nullptr);
+    const Shard&                 shard  (get_shard(in_object_type) );
+    std::unique_lock<std::mutex> lock   (shard.cs);
+    void*                        result (nullptr);
 
-    if (m_object_allocations[in_object_type].size() > in_alloc_index)
+    if (shard.allocations.size() > in_alloc_index)
     {
-        result = m_object_allocations[in_object_type][in_alloc_index].object_ptr;
+        result = shard.allocations.at(in_alloc_index).object_ptr;
     }
 
     return result;
 }
 
+/** Returns the shard holding objects of type @param in_object_type. */
+Anvil::ObjectTracker::Shard& Anvil::ObjectTracker::get_shard(const ObjectType& in_object_type)
+{
+    return m_shards[get_shard_index(in_object_type)];
+}
+
+/** Returns the shard holding objects of type @param in_object_type. */
+const Anvil::ObjectTracker::Shard& Anvil::ObjectTracker::get_shard(const ObjectType& in_object_type) const
+{
+    return m_shards[get_shard_index(in_object_type)];
+}
+
+/** Maps an object type to the index of the shard holding objects of that type.
+ *
+ *  ObjectType values are sparse (extension object types start at 1000000000), hence the switch.
+ **/
+uint32_t Anvil::ObjectTracker::get_shard_index(const ObjectType& in_object_type)
+{
+    uint32_t result = N_SHARDS - 1;
+
+    switch (in_object_type)
+    {
+        case Anvil::ObjectType::BUFFER:                     result = 0;  break;
+        case Anvil::ObjectType::BUFFER_VIEW:                result = 1;  break;
+        case Anvil::ObjectType::COMMAND_BUFFER:             result = 2;  break;
+        case Anvil::ObjectType::COMMAND_POOL:               result = 3;  break;
+        case Anvil::ObjectType::DEBUG_REPORT_CALLBACK:      result = 4;  break;
+        case Anvil::ObjectType::DEBUG_UTILS_MESSENGER:      result = 5;  break;
+        case Anvil::ObjectType::DESCRIPTOR_POOL:            result = 6;  break;
+        case Anvil::ObjectType::DESCRIPTOR_SET:             result = 7;  break;
+        case Anvil::ObjectType::DESCRIPTOR_SET_LAYOUT:      result = 8;  break;
+        case Anvil::ObjectType::DESCRIPTOR_UPDATE_TEMPLATE: result = 9;  break;
+        case Anvil::ObjectType::DEVICE:                     result = 10; break;
+        case Anvil::ObjectType::EVENT:                      result = 11; break;
+        case Anvil::ObjectType::FENCE:                      result = 12; break;
+        case Anvil::ObjectType::FRAMEBUFFER:                result = 13; break;
+        case Anvil::ObjectType::IMAGE:                      result = 14; break;
+        case Anvil::ObjectType::IMAGE_VIEW:                 result = 15; break;
+        case Anvil::ObjectType::INSTANCE:                   result = 16; break;
+        case Anvil::ObjectType::PHYSICAL_DEVICE:            result = 17; break;
+        case Anvil::ObjectType::PIPELINE:                   result = 18; break;
+        case Anvil::ObjectType::PIPELINE_CACHE:             result = 19; break;
+        case Anvil::ObjectType::PIPELINE_LAYOUT:            result = 20; break;
+        case Anvil::ObjectType::QUERY_POOL:                 result = 21; break;
+        case Anvil::ObjectType::QUEUE:                      result = 22; break;
+        case Anvil::ObjectType::RENDER_PASS:                result = 23; break;
+        case Anvil::ObjectType::RENDERING_SURFACE:          result = 24; break;
+        case Anvil::ObjectType::SAMPLER:                    result = 25; break;
+        case Anvil::ObjectType::SAMPLER_YCBCR_CONVERSION:   result = 26; break;
+        case Anvil::ObjectType::SEMAPHORE:                  result = 27; break;
+        case Anvil::ObjectType::SHADER_MODULE:              result = 28; break;
+        case Anvil::ObjectType::SWAPCHAIN:                  result = 29; break;
+
+        case Anvil::ObjectType::ANVIL_COMPUTE_PIPELINE_MANAGER:       result = 30; break;
+        case Anvil::ObjectType::ANVIL_DESCRIPTOR_SET_GROUP:           result = 31; break;
+        case Anvil::ObjectType::ANVIL_DESCRIPTOR_SET_LAYOUT_MANAGER:  result = 32; break;
+        case Anvil::ObjectType::ANVIL_GLSL_SHADER_TO_SPIRV_GENERATOR: result = 33; break;
+        case Anvil::ObjectType::ANVIL_GRAPHICS_PIPELINE_MANAGER:      result = 34; break;
+        case Anvil::ObjectType::ANVIL_MEMORY_BLOCK:                   result = 35; break;
+        case Anvil::ObjectType::ANVIL_PIPELINE_LAYOUT_MANAGER:        result = 36; break;
+
+        default:
+        {
+            /* Falls back to the UNKNOWN shard */
+        }
+    }
+
+    return result;
+}
+
+/* Please see header for specification */
+void Anvil::ObjectTracker::get_snapshot(bool                       in_include_object_ptrs,
+                                        std::vector<TypeSnapshot>* out_snapshot_ptr) const
+{
+    std::unique_lock<std::mutex> snapshot_lock          (m_snapshot_cs);
+    const uint64_t               current_time_msec      (m_time.get_time_in_msec() );
+    const uint64_t               elapsed_time_msec      (current_time_msec - m_last_snapshot_time_msec);
+
+    anvil_assert(out_snapshot_ptr != nullptr);
+
+    out_snapshot_ptr->clear();
+
+    for (auto& current_shard : m_shards)
+    {
+        TypeSnapshot   type_snapshot;
+        const uint64_t n_created_objects = current_shard.n_created_objects.load();
+
+        if (n_created_objects == 0)
+        {
+            continue;
+        }
+
+        type_snapshot.n_created_objects = n_created_objects;
+        type_snapshot.object_type       = current_shard.object_type;
+        type_snapshot.object_type_name  = get_object_type_name(current_shard.object_type);
+
+        if (elapsed_time_msec > 0)
+        {
+            type_snapshot.creation_rate = static_cast<double>(n_created_objects - current_shard.n_created_objects_at_last_snapshot) * 1000.0 /* ms in s */ / static_cast<double>(elapsed_time_msec);
+        }
+
+        if (in_include_object_ptrs)
+        {
+            std::unique_lock<std::mutex> lock(current_shard.cs);
+
+            type_snapshot.alive_object_ptrs.reserve(current_shard.allocations.size() );
+
+            for (const auto& current_alloc : current_shard.allocations)
+            {
+                type_snapshot.alive_object_ptrs.push_back(current_alloc.object_ptr);
+            }
+
+            type_snapshot.n_alive_objects = static_cast<uint32_t>(current_shard.allocations.size() );
+        }
+        else
+        {
+            type_snapshot.n_alive_objects = current_shard.n_alive_objects.load();
+        }
+
+        /* The reference point for creation rates is only mutated with m_snapshot_cs held */
+        current_shard.n_created_objects_at_last_snapshot = n_created_objects;
+
+        out_snapshot_ptr->push_back(std::move(type_snapshot) );
+    }
+
+    m_last_snapshot_time_msec = current_time_msec;
+}
+
 /* Please see header for specification */
 void Anvil::ObjectTracker::register_object(const ObjectType& in_object_type,
                                            void*             in_object_ptr)
 {
+    Shard& shard = get_shard(in_object_type);
+
     anvil_assert(in_object_ptr != nullptr);
 
     {
-        std::unique_lock<std::mutex> lock(m_cs);
+        std::unique_lock<std::mutex> lock      (shard.cs);
+        const uint32_t               slot_index(static_cast<uint32_t>(shard.allocations.size() ));
+
+        anvil_assert(shard.object_ptr_to_slot_index_map.find(in_object_ptr) == shard.object_ptr_to_slot_index_map.end() );
 
-        m_object_allocations[in_object_type].push_back(ObjectAllocation(m_n_objects_allocated_array[in_object_type]++,
-                                                                        in_object_ptr) );
+        shard.allocations.push_back(ObjectAllocation(shard.n_created_objects.fetch_add(1),
+                                                     in_object_ptr) );
+
+        shard.object_ptr_to_slot_index_map[in_object_ptr] = slot_index;
     }
 
+    shard.n_alive_objects.fetch_add(1);
+
     /* Notify any observers about the new object */
     OnObjectRegisteredCallbackArgument callback_arg(in_object_type,
                                                     in_object_ptr);
@@ -190,23 +459,36 @@ void Anvil::ObjectTracker::unregister_object(const ObjectType& in_object_type,
 {
     OnObjectAboutToBeUnregisteredCallbackArgument callback_arg(in_object_type,
                                                                in_object_ptr);
+    Shard&                                        shard       (get_shard(in_object_type) );
 
     {
-        std::unique_lock<std::mutex> lock                      (m_cs);
-        auto                         object_allocation_iterator(std::find(m_object_allocations[in_object_type].begin(),
-                                                                          m_object_allocations[in_object_type].end(),
-                                                                          in_object_ptr) );
+        std::unique_lock<std::mutex> lock                 (shard.cs);
+        auto                         slot_index_iterator  (shard.object_ptr_to_slot_index_map.find(in_object_ptr) );
+        uint32_t                     slot_index;
 
-        if (object_allocation_iterator == m_object_allocations[in_object_type].end() )
+        if (slot_index_iterator == shard.object_ptr_to_slot_index_map.end() )
         {
             anvil_assert_fail();
 
             goto end;
         }
 
-        m_object_allocations[in_object_type].erase(object_allocation_iterator);
+        slot_index = slot_index_iterator->second;
+
+        /* Move the last object to the released slot */
+        if (slot_index != shard.allocations.size() - 1)
+        {
+            shard.allocations.at(slot_index) = shard.allocations.back();
+
+            shard.object_ptr_to_slot_index_map.at(shard.allocations.at(slot_index).object_ptr) = slot_index;
+        }
+
+        shard.allocations.pop_back                 ();
+        shard.object_ptr_to_slot_index_map.erase   (slot_index_iterator);
     }
 
+    shard.n_alive_objects.fetch_sub(1);
+
     /* Notify any observers about the event. */
     if (in_object_type == Anvil::ObjectType::DEVICE)
     {
@@ -234,4 +516,4 @@ void Anvil::ObjectTracker::unregister_object(const ObjectType& in_object_type,
 
 end:
     ;
-}
\ No newline at end of file
+}
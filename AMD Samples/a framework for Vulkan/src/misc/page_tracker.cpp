@@ -23,19 +23,27 @@
 #include "wrappers/memory_block.h"
 #include "misc/debug.h"
 #include "misc/page_tracker.h"
+#include <algorithm>
 
 /** Please see header for specification */
 Anvil::PageTracker::PageTracker(VkDeviceSize in_region_size,
                                 VkDeviceSize in_page_size)
-    :m_n_total_pages              (static_cast<uint32_t>(in_region_size / in_page_size) ),
-     m_page_size                  (in_page_size),
+    :m_memory_blocks_dirty        (false),
      m_n_pages_with_memory_backing(0),
+     m_n_total_pages              (static_cast<uint32_t>(Anvil::Utils::round_up(in_region_size, in_page_size) / in_page_size) ),
+     m_page_size                  (in_page_size),
      m_region_size                (in_region_size)
 {
-    m_sparse_page_occupancy.resize(
-        1 + m_n_total_pages / (sizeof(uint32_t) * 8 /* bits in byte */)
-    );
+    anvil_assert(in_page_size   != 0);
+    anvil_assert(in_region_size != 0);
+
+    m_leaves.resize( (m_n_total_pages + PAGES_PER_LEAF - 1) >> PAGES_PER_LEAF_LOG2);
+}
 
+/** Please see header for specification */
+Anvil::PageTracker::~PageTracker()
+{
+    /* Stub */
 }
 
 /** Please see header for specification */
@@ -43,7 +51,9 @@ Anvil::MemoryBlock* Anvil::PageTracker::get_memory_block(VkDeviceSize  in_start_
                                                          VkDeviceSize  in_size,
                                                          VkDeviceSize* out_memory_region_start_offset_ptr) const
 {
-    Anvil::MemoryBlock* result_ptr = nullptr;
+    const PageBinding*  page_binding_ptr = nullptr;
+    const uint32_t      n_page           = static_cast<uint32_t>(in_start_offset / m_page_size);
+    Anvil::MemoryBlock* result_ptr       = nullptr;
 
     if (in_size > m_page_size)
     {
@@ -52,35 +62,60 @@ Anvil::MemoryBlock* Anvil::PageTracker::get_memory_block(VkDeviceSize  in_start_
         goto end;
     }
 
-    /* Handle the request */
-    for (const auto& current_memory_block : m_memory_blocks)
+    if (n_page >= m_n_total_pages)
     {
-        if (current_memory_block.start_offset                             <= in_start_offset           &&
-            current_memory_block.start_offset + current_memory_block.size >= in_start_offset + in_size)
-        {
-            result_ptr                          = current_memory_block.memory_block_ptr;
-            *out_memory_region_start_offset_ptr = in_start_offset - current_memory_block.start_offset;
+        anvil_assert(!(n_page >= m_n_total_pages) );
 
-            break;
-        }
+        goto end;
+    }
+
+    /* Handle the request */
+    page_binding_ptr = get_page_binding(n_page);
+
+    if (page_binding_ptr                   != nullptr &&
+        page_binding_ptr->memory_block_ptr != nullptr)
+    {
+        result_ptr                          = page_binding_ptr->memory_block_ptr;
+        *out_memory_region_start_offset_ptr = page_binding_ptr->memory_block_start_offset + (in_start_offset - static_cast<VkDeviceSize>(n_page) * m_page_size);
     }
 
 end:
     return result_ptr;
 }
 
+/** Returns binding info for page @param in_n_page, or null if the page has no memory backing and
+ *  neither do any of the pages sharing its leaf.
+ */
+const Anvil::PageTracker::PageBinding* Anvil::PageTracker::get_page_binding(uint32_t in_n_page) const
+{
+    const Leaf* leaf_ptr = m_leaves.at(in_n_page >> PAGES_PER_LEAF_LOG2).get();
+
+    return (leaf_ptr != nullptr) ? &leaf_ptr->pages[in_n_page & (PAGES_PER_LEAF - 1)]
+                                 : nullptr;
+}
+
+/** Returns size of page @param in_n_page. Only the last page may be smaller than the page size,
+ *  if the tracked region's size is not a multiple of the page size.
+ */
+VkDeviceSize Anvil::PageTracker::get_page_size(uint32_t in_n_page) const
+{
+    const VkDeviceSize page_start_offset = static_cast<VkDeviceSize>(in_n_page) * m_page_size;
+
+    return std::min(m_page_size,
+                    m_region_size - page_start_offset);
+}
+
 /** Please see header for specification */
 bool Anvil::PageTracker::set_binding(MemoryBlock* in_memory_block_ptr,
                                      VkDeviceSize in_memory_block_start_offset,
                                      VkDeviceSize in_start_offset,
                                      VkDeviceSize in_size)
 {
-    const auto     end_offset_page_aligned    = Anvil::Utils::round_up(in_start_offset + in_size,
-                                                                       m_page_size);
-    uint32_t       n_pages;
-    uint32_t       occupancy_item_start_index;
-    const uint32_t pages_per_vec_item         = 32;
-    bool           result                     = false;
+    const auto end_offset_page_aligned = Anvil::Utils::round_up(in_start_offset + in_size,
+                                                                m_page_size);
+    uint32_t   n_pages;
+    uint32_t   n_start_page;
+    bool       result                  = false;
 
     /* Sanity checks */
     if (in_start_offset + in_size > m_region_size)
@@ -98,134 +133,192 @@ bool Anvil::PageTracker::set_binding(MemoryBlock* in_memory_block_ptr,
     }
 
     if (((in_start_offset + in_size) % m_page_size) != 0              &&
-        end_offset_page_aligned                     != m_region_size)
+        end_offset_page_aligned                     != Anvil::Utils::round_up(m_region_size, m_page_size) )
     {
         anvil_assert(!((in_start_offset + in_size) % m_page_size) != 0              &&
-                       end_offset_page_aligned                    != m_region_size);
+                       end_offset_page_aligned                    != Anvil::Utils::round_up(m_region_size, m_page_size) );
 
         goto end;
     }
 
-    /* Store the memory block binding */
-    for (auto mem_binding_iterator  = m_memory_blocks.begin();
-              mem_binding_iterator != m_memory_blocks.end();
-            ++mem_binding_iterator)
+    /* Update the bindings, one page at a time */
+    n_pages      = static_cast<uint32_t>((end_offset_page_aligned - in_start_offset) / m_page_size);
+    n_start_page = static_cast<uint32_t>(in_start_offset                            / m_page_size);
+
+    for (uint32_t n_page = 0;
+                  n_page < n_pages;
+                ++n_page)
     {
-        auto& mem_binding = *mem_binding_iterator;
+        set_page_binding(n_start_page + n_page,
+                         in_memory_block_ptr,
+                         in_memory_block_start_offset + static_cast<VkDeviceSize>(n_page) * m_page_size);
+    }
 
-        const bool does_not_overlap = (in_start_offset + in_size -1                    < mem_binding.start_offset || /* XXYY , X = new binding, Y = this binding */
-                                       mem_binding.start_offset + mem_binding.size - 1 < in_start_offset);           /* YYXX */
+    anvil_assert(m_n_pages_with_memory_backing <= m_n_total_pages);
+    result = true;
+end:
+    return result;
+}
 
-        if (does_not_overlap)
+/** Updates binding of a single page. Allocates the page's leaf if the page is assigned memory backing
+ *  for the first time, and releases it as soon as none of the leaf's pages has any memory backing.
+ *
+ *  @return true if the binding has changed, false otherwise.
+ */
+bool Anvil::PageTracker::set_page_binding(uint32_t     in_n_page,
+                                          MemoryBlock* in_memory_block_ptr,
+                                          VkDeviceSize in_memory_block_start_offset)
+{
+    auto&        leaf_ptr         = m_leaves.at(in_n_page >> PAGES_PER_LEAF_LOG2);
+    PageBinding* page_binding_ptr = nullptr;
+    bool         result           = false;
+
+    if (leaf_ptr == nullptr)
+    {
+        if (in_memory_block_ptr == nullptr)
         {
-            continue;
+            /* Page has no memory backing already */
+            goto end;
         }
 
-        /* There are four cases we need to handle separately :
-         *
-         * 1)  ###      - The new block _ interleaves with current memory block # from the left side.
-         *    __          Need to truncate # from the left side.
-         *
-         * 2)  ###      - The new block _ splits current memory block # in half.
-         *      _         Need to split # to two separate memory blocks.
-         *
-         * 3)  ###      - The new block _ interleaves with current memory block # from the right side.
-         *       __       Need to truncate # from the right side.
-         *
-         * 4)  ###      - The new block _ is going to be completely overwritten by _
-         *    _____       Need to remove it.
-         */
-        if ( in_start_offset            <=  mem_binding.start_offset                     &&
-             in_start_offset            <  (mem_binding.start_offset + mem_binding.size) &&
-            (in_start_offset + in_size) >=  mem_binding.start_offset                     &&
-            (in_start_offset + in_size) <  (mem_binding.start_offset + mem_binding.size) )
+        leaf_ptr.reset(new Leaf() );
+
+        leaf_ptr->n_pages_with_memory_backing = 0;
+    }
+
+    page_binding_ptr = &leaf_ptr->pages[in_n_page & (PAGES_PER_LEAF - 1)];
+
+    if (in_memory_block_ptr == nullptr)
+    {
+        if (page_binding_ptr->memory_block_ptr == nullptr)
         {
-            /* Case 1 */
-            mem_binding.size         -= in_start_offset + in_size - (mem_binding.start_offset);
-            mem_binding.start_offset  = in_start_offset + in_size;
+            goto end;
         }
-        else
-        if ( in_start_offset            >  mem_binding.start_offset                     &&
-             in_start_offset            < (mem_binding.start_offset + mem_binding.size) &&
-            (in_start_offset + in_size) >  mem_binding.start_offset                     &&
-            (in_start_offset + in_size) < (mem_binding.start_offset + mem_binding.size))
+
+        page_binding_ptr->memory_block_ptr          = nullptr;
+        page_binding_ptr->memory_block_start_offset = 0;
+
+        --m_n_pages_with_memory_backing;
+
+        if (--leaf_ptr->n_pages_with_memory_backing == 0)
         {
-            /* Case 2 */
-            MemoryBlockBinding left_half (mem_binding.memory_block_ptr,
-                                          mem_binding.memory_block_start_offset,
-                                          in_start_offset - mem_binding.start_offset, /* in_size         */
-                                          mem_binding.start_offset);                  /* in_start_offset */
-            MemoryBlockBinding right_half(mem_binding.memory_block_ptr,
-                                          mem_binding.memory_block_start_offset,
-                                          mem_binding.start_offset + mem_binding.size - (in_start_offset + in_size) + 1, /* in_size         */
-                                          in_start_offset + in_size);                                                    /* in_start_offset */
-
-            m_memory_blocks.push_back(left_half);
-            m_memory_blocks.push_back(right_half);
-
-            m_memory_blocks.erase(mem_binding_iterator);
+            leaf_ptr.reset();
         }
-        else
-        if ( in_start_offset            >  mem_binding.start_offset                     &&
-             in_start_offset            > (mem_binding.start_offset + mem_binding.size) &&
-            (in_start_offset + in_size) >  mem_binding.start_offset                     &&
-            (in_start_offset + in_size) > (mem_binding.start_offset + mem_binding.size) )
+    }
+    else
+    {
+        if (page_binding_ptr->memory_block_ptr          == in_memory_block_ptr &&
+            page_binding_ptr->memory_block_start_offset == in_memory_block_start_offset)
         {
-            /* Case 3 */
-            mem_binding.size = (mem_binding.start_offset + mem_binding.size) - in_start_offset + 1;
+            goto end;
         }
-        else
-        {
-            /* Must be case 4 */
-            anvil_assert( in_start_offset            <=  mem_binding.start_offset                     &&
-                         (in_start_offset + in_size) >= (mem_binding.start_offset + mem_binding.size) );
 
-            m_memory_blocks.erase(mem_binding_iterator);
+        if (page_binding_ptr->memory_block_ptr == nullptr)
+        {
+            ++leaf_ptr->n_pages_with_memory_backing;
+            ++m_n_pages_with_memory_backing;
         }
 
-        /* No more than one memory binding can be assigned to the same memory region */
-        break;
+        page_binding_ptr->memory_block_ptr          = in_memory_block_ptr;
+        page_binding_ptr->memory_block_start_offset = in_memory_block_start_offset;
     }
 
-    m_memory_blocks.push_back(
-        MemoryBlockBinding(
-            in_memory_block_ptr,
-            in_memory_block_start_offset,
-            in_size,
-            in_start_offset)
-        );
+    m_memory_blocks_dirty = true;
+    result                = true;
+end:
+    return result;
+}
 
-    /* Update page occupancy info */
-    n_pages                    = static_cast<uint32_t>(in_size         / m_page_size);
-    occupancy_item_start_index = static_cast<uint32_t>(in_start_offset / m_page_size);
+/** Please see header for specification */
+bool Anvil::PageTracker::set_page_bindings(const std::vector<PageBindingUpdate>& in_updates,
+                                           std::vector<VkSparseMemoryBind>*      out_opt_sparse_memory_binds_ptr)
+{
+    VkSparseMemoryBind*             current_bind_ptr = nullptr;
+    uint32_t                        n_last_page      = UINT32_MAX;
+    bool                            result           = false;
+    std::vector<PageBindingUpdate>  sorted_updates;
 
-    /* TODO: Perf of the code below could definitely be improved */
-    for (uint32_t n_page = 0;
-                  n_page < n_pages;
-                ++n_page)
+    if (out_opt_sparse_memory_binds_ptr != nullptr)
     {
-        const uint32_t occupancy_item_index = (occupancy_item_start_index + n_page) % pages_per_vec_item;
-        const uint32_t occupancy_vec_index  = (occupancy_item_start_index + n_page) / pages_per_vec_item;
-        const uint32_t n_page_mask          = m_sparse_page_occupancy[occupancy_vec_index].raw & (1 << occupancy_item_index);
+        out_opt_sparse_memory_binds_ptr->clear();
+    }
 
-        /* Change the number of memory-backed pages only if a bit would be flipped */
-        if (in_memory_block_ptr != nullptr)
+    /* Sanity checks */
+    for (const auto& current_update : in_updates)
+    {
+        if (current_update.n_page >= m_n_total_pages)
         {
-            if (n_page_mask == 0)
-            {
-                m_sparse_page_occupancy[occupancy_vec_index].raw |= (1 << occupancy_item_index);
+            anvil_assert(!(current_update.n_page >= m_n_total_pages) );
 
-                ++m_n_pages_with_memory_backing;
-            }
+            goto end;
         }
-        else
+    }
+
+    /* Sort the updates by page index. For duplicate page indices, only the last update matters.
+     *
+     * NOTE: Stable sort preserves the relative order of updates referring to the same page. */
+    sorted_updates = in_updates;
+
+    std::stable_sort(sorted_updates.begin(),
+                     sorted_updates.end(),
+                     [](const PageBindingUpdate& in_update1,
+                        const PageBindingUpdate& in_update2)
+                     {
+                         return in_update1.n_page < in_update2.n_page;
+                     });
+
+    for (auto update_iterator  = sorted_updates.cbegin();
+              update_iterator != sorted_updates.cend();
+            ++update_iterator)
+    {
+        const auto next_update_iterator = update_iterator + 1;
+
+        if (next_update_iterator         != sorted_updates.cend() &&
+            next_update_iterator->n_page == update_iterator->n_page)
+        {
+            continue;
+        }
+
+        if (!set_page_binding(update_iterator->n_page,
+                              update_iterator->memory_block_ptr,
+                              update_iterator->memory_block_start_offset) )
         {
-            if (n_page_mask != 0)
+            /* No-op update */
+            continue;
+        }
+
+        if (out_opt_sparse_memory_binds_ptr != nullptr)
+        {
+            const VkDeviceMemory memory        = (update_iterator->memory_block_ptr != nullptr) ? update_iterator->memory_block_ptr->get_memory()
+                                                                                                : VK_NULL_HANDLE;
+            const VkDeviceSize   memory_offset = (update_iterator->memory_block_ptr != nullptr) ? update_iterator->memory_block_ptr->get_start_offset() + update_iterator->memory_block_start_offset
+                                                                                                : 0;
+            const VkDeviceSize   page_size     = get_page_size(update_iterator->n_page);
+
+            /* Extend the last range, if the page directly follows it in both resource & memory address space */
+            if (current_bind_ptr                                                         != nullptr                   &&
+                n_last_page + 1                                                          == update_iterator->n_page   &&
+                current_bind_ptr->memory                                                 == memory                    &&
+                (memory == VK_NULL_HANDLE || current_bind_ptr->memoryOffset + current_bind_ptr->size == memory_offset) )
+            {
+                current_bind_ptr->size += page_size;
+            }
+            else
             {
-                m_sparse_page_occupancy[occupancy_vec_index].raw &= ~(1 << occupancy_item_index);
+                VkSparseMemoryBind new_bind;
 
-                --m_n_pages_with_memory_backing;
+                new_bind.flags          = 0;
+                new_bind.memory         = memory;
+                new_bind.memoryOffset   = memory_offset;
+                new_bind.resourceOffset = static_cast<VkDeviceSize>(update_iterator->n_page) * m_page_size;
+                new_bind.size           = page_size;
+
+                out_opt_sparse_memory_binds_ptr->push_back(new_bind);
+
+                current_bind_ptr = &out_opt_sparse_memory_binds_ptr->back();
             }
+
+            n_last_page = update_iterator->n_page;
         }
     }
 
@@ -233,4 +326,71 @@ bool Anvil::PageTracker::set_binding(MemoryBlock* in_memory_block_ptr,
     result = true;
 end:
     return result;
-}
\ No newline at end of file
+}
+
+/** Rebuilds the list of coalesced memory block descriptors, if any of the bindings has changed since the last call. */
+void Anvil::PageTracker::update_memory_blocks() const
+{
+    MemoryBlockBinding* current_binding_ptr = nullptr;
+    const uint32_t      n_leaves            = static_cast<uint32_t>(m_leaves.size() );
+
+    if (!m_memory_blocks_dirty)
+    {
+        goto end;
+    }
+
+    m_memory_blocks.clear();
+
+    for (uint32_t n_leaf = 0;
+                  n_leaf < n_leaves;
+                ++n_leaf)
+    {
+        const Leaf*    leaf_ptr = m_leaves.at(n_leaf).get();
+        const uint32_t n_pages  = std::min(static_cast<uint32_t>(PAGES_PER_LEAF),
+                                           m_n_total_pages - (n_leaf << PAGES_PER_LEAF_LOG2) );
+
+        if (leaf_ptr == nullptr)
+        {
+            current_binding_ptr = nullptr;
+
+            continue;
+        }
+
+        for (uint32_t n_leaf_page = 0;
+                      n_leaf_page < n_pages;
+                    ++n_leaf_page)
+        {
+            const uint32_t     n_page       = (n_leaf << PAGES_PER_LEAF_LOG2) + n_leaf_page;
+            const PageBinding& page_binding = leaf_ptr->pages[n_leaf_page];
+
+            if (page_binding.memory_block_ptr == nullptr)
+            {
+                current_binding_ptr = nullptr;
+
+                continue;
+            }
+
+            if (current_binding_ptr                                                            != nullptr                                &&
+                current_binding_ptr->memory_block_ptr                                          == page_binding.memory_block_ptr          &&
+                current_binding_ptr->memory_block_start_offset + current_binding_ptr->size     == page_binding.memory_block_start_offset)
+            {
+                current_binding_ptr->size += get_page_size(n_page);
+            }
+            else
+            {
+                m_memory_blocks.push_back(
+                    MemoryBlockBinding(page_binding.memory_block_ptr,
+                                       page_binding.memory_block_start_offset,
+                                       get_page_size(n_page),
+                                       static_cast<VkDeviceSize>(n_page) * m_page_size)
+                );
+
+                current_binding_ptr = &m_memory_blocks.back();
+            }
+        }
+    }
+
+    m_memory_blocks_dirty = false;
+end:
+    ;
+}
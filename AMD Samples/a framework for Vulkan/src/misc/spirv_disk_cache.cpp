@@ -0,0 +1,787 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "misc/debug.h"
+#include "misc/io.h"
+#include "misc/spirv_disk_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <thread>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <Windows.h>
+    #include <sys/utime.h>
+#else
+    #include <unistd.h>
+    #include <utime.h>
+#endif
+
+#define SPIRV_DISK_CACHE_ENTRY_EXTENSION     ".spv"
+#define SPIRV_DISK_CACHE_ENTRY_MAGIC         (0x56505341u) /* "ASPV" */
+#define SPIRV_DISK_CACHE_ENTRY_VERSION       (1u)
+#define SPIRV_DISK_CACHE_TEMP_FILE_EXTENSION ".tmp"
+#define SPIRV_DISK_CACHE_TEMP_FILE_MAX_AGE   (24 * 60 * 60) /* seconds */
+
+/* Eviction trims the cache down to this fraction of the budget, so that a cache which sits at its limit does not
+ * have to scan its entries on every single store operation. */
+#define SPIRV_DISK_CACHE_EVICTION_TARGET_NUMERATOR   (9)
+#define SPIRV_DISK_CACHE_EVICTION_TARGET_DENOMINATOR (10)
+
+#define SPIRV_MAGIC_NUMBER (0x07230203u)
+
+
+namespace
+{
+    /* Header preceding the SPIR-V blob in each cache file. */
+    typedef struct
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t blob_size;
+    } EntryHeader;
+
+    /** Minimal SHA-256 implementation (FIPS 180-4). **/
+    class SHA256
+    {
+    public:
+        SHA256()
+        {
+            static const uint32_t initial_state[8] =
+            {
+                0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+            };
+
+            memcpy(m_state,
+                   initial_state,
+                   sizeof(m_state) );
+
+            m_n_buffered_bytes = 0;
+            m_n_total_bytes    = 0;
+        }
+
+        void update(const void* in_data,
+                    size_t      in_data_size)
+        {
+            const uint8_t* data_u8_ptr = static_cast<const uint8_t*>(in_data);
+
+            m_n_total_bytes += in_data_size;
+
+            while (in_data_size > 0)
+            {
+                const size_t n_bytes_to_copy = std::min<size_t>(sizeof(m_buffer) - m_n_buffered_bytes,
+                                                                in_data_size);
+
+                memcpy(m_buffer + m_n_buffered_bytes,
+                       data_u8_ptr,
+                       n_bytes_to_copy);
+
+                m_n_buffered_bytes += n_bytes_to_copy;
+                data_u8_ptr        += n_bytes_to_copy;
+                in_data_size       -= n_bytes_to_copy;
+
+                if (m_n_buffered_bytes == sizeof(m_buffer) )
+                {
+                    process_block(m_buffer);
+
+                    m_n_buffered_bytes = 0;
+                }
+            }
+        }
+
+        std::string finalize()
+        {
+            static const char hex_digits[] = "0123456789abcdef";
+            const uint64_t    n_total_bits = m_n_total_bytes * 8;
+            std::string       result;
+            uint8_t           size_data[8];
+            const uint8_t     terminator   = 0x80;
+            const uint8_t     zero         = 0x00;
+
+            for (uint32_t n_byte = 0;
+                          n_byte < 8;
+                        ++n_byte)
+            {
+                size_data[n_byte] = static_cast<uint8_t>(n_total_bits >> (56 - n_byte * 8) );
+            }
+
+            update(&terminator,
+                   1);
+
+            while (m_n_buffered_bytes != sizeof(m_buffer) - sizeof(size_data) )
+            {
+                update(&zero,
+                       1);
+            }
+
+            update(size_data,
+                   sizeof(size_data) );
+
+            anvil_assert(m_n_buffered_bytes == 0);
+
+            result.reserve(64);
+
+            for (uint32_t n_word = 0;
+                          n_word < 8;
+                        ++n_word)
+            {
+                for (int32_t n_nibble = 7;
+                             n_nibble >= 0;
+                           --n_nibble)
+                {
+                    result += hex_digits[(m_state[n_word] >> (n_nibble * 4)) & 0xF];
+                }
+            }
+
+            return result;
+        }
+
+    private:
+        static uint32_t rotr(uint32_t in_value,
+                             uint32_t in_n_bits)
+        {
+            return (in_value >> in_n_bits) | (in_value << (32 - in_n_bits) );
+        }
+
+        void process_block(const uint8_t* in_block_ptr)
+        {
+            static const uint32_t k[64] =
+            {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+            };
+
+            uint32_t state[8];
+            uint32_t w    [64];
+
+            for (uint32_t n = 0;
+                          n < 16;
+                        ++n)
+            {
+                w[n] = (static_cast<uint32_t>(in_block_ptr[n * 4 + 0]) << 24) |
+                       (static_cast<uint32_t>(in_block_ptr[n * 4 + 1]) << 16) |
+                       (static_cast<uint32_t>(in_block_ptr[n * 4 + 2]) << 8)  |
+                       (static_cast<uint32_t>(in_block_ptr[n * 4 + 3]) );
+            }
+
+            for (uint32_t n = 16;
+                          n < 64;
+                        ++n)
+            {
+                const uint32_t s0 = rotr(w[n - 15], 7)  ^ rotr(w[n - 15], 18) ^ (w[n - 15] >> 3);
+                const uint32_t s1 = rotr(w[n - 2],  17) ^ rotr(w[n - 2],  19) ^ (w[n - 2]  >> 10);
+
+                w[n] = w[n - 16] + s0 + w[n - 7] + s1;
+            }
+
+            memcpy(state,
+                   m_state,
+                   sizeof(state) );
+
+            for (uint32_t n = 0;
+                          n < 64;
+                        ++n)
+            {
+                const uint32_t s1    = rotr(state[4], 6) ^ rotr(state[4], 11) ^ rotr(state[4], 25);
+                const uint32_t ch    = (state[4] & state[5]) ^ (~state[4] & state[6]);
+                const uint32_t temp1 = state[7] + s1 + ch + k[n] + w[n];
+                const uint32_t s0    = rotr(state[0], 2) ^ rotr(state[0], 13) ^ rotr(state[0], 22);
+                const uint32_t maj   = (state[0] & state[1]) ^ (state[0] & state[2]) ^ (state[1] & state[2]);
+                const uint32_t temp2 = s0 + maj;
+
+                state[7] = state[6];
+                state[6] = state[5];
+                state[5] = state[4];
+                state[4] = state[3] + temp1;
+                state[3] = state[2];
+                state[2] = state[1];
+                state[1] = state[0];
+                state[0] = temp1 + temp2;
+            }
+
+            for (uint32_t n = 0;
+                          n < 8;
+                        ++n)
+            {
+                m_state[n] += state[n];
+            }
+        }
+
+        uint8_t  m_buffer[64];
+        size_t   m_n_buffered_bytes;
+        uint64_t m_n_total_bytes;
+        uint32_t m_state [8];
+    };
+
+    /** Retrieves size and modification time of the specified file.
+     *
+     *  @return true if the file exists, false otherwise.
+     **/
+    bool get_file_properties(const std::string& in_filename,
+                             uint64_t*          out_size_ptr,
+                             uint64_t*          out_modification_time_ptr)
+    {
+        struct stat stat_data;
+
+        if (stat(in_filename.c_str(),
+                &stat_data) != 0)
+        {
+            return false;
+        }
+
+        *out_size_ptr              = static_cast<uint64_t>(stat_data.st_size);
+        *out_modification_time_ptr = static_cast<uint64_t>(stat_data.st_mtime);
+
+        return true;
+    }
+
+    /** Returns a file name suffix which is unique across all threads and processes using the same cache directory. */
+    std::string get_unique_temp_file_suffix()
+    {
+        static std::atomic<uint32_t> counter(0);
+        std::stringstream            result_sstream;
+
+        #ifdef _WIN32
+            const uint64_t process_id = static_cast<uint64_t>(::GetCurrentProcessId() );
+        #else
+            const uint64_t process_id = static_cast<uint64_t>(getpid() );
+        #endif
+
+        result_sstream << "."
+                       << process_id
+                       << "_"
+                       << std::hash<std::thread::id>()(std::this_thread::get_id() )
+                       << "_"
+                       << counter.fetch_add(1)
+                       << SPIRV_DISK_CACHE_TEMP_FILE_EXTENSION;
+
+        return result_sstream.str();
+    }
+
+    /** Atomically replaces @param in_dst_filename with @param in_src_filename. */
+    bool rename_file(const std::string& in_src_filename,
+                     const std::string& in_dst_filename)
+    {
+        #ifdef _WIN32
+        {
+            return (::MoveFileExA(in_src_filename.c_str(),
+                                  in_dst_filename.c_str(),
+                                  MOVEFILE_REPLACE_EXISTING) != 0);
+        }
+        #else
+        {
+            return (rename(in_src_filename.c_str(),
+                           in_dst_filename.c_str() ) == 0);
+        }
+        #endif
+    }
+
+    /** Sets the modification time of the specified file to current time. */
+    void touch_file(const std::string& in_filename)
+    {
+        #ifdef _WIN32
+        {
+            _utime(in_filename.c_str(),
+                   nullptr);
+        }
+        #else
+        {
+            utime(in_filename.c_str(),
+                  nullptr);
+        }
+        #endif
+    }
+
+    /** Tells whether @param in_string ends with @param in_suffix */
+    bool ends_with(const std::string& in_string,
+                   const std::string& in_suffix)
+    {
+        return (in_string.size() >= in_suffix.size()                                  &&
+                in_string.compare(in_string.size() - in_suffix.size(),
+                                  in_suffix.size(),
+                                  in_suffix) == 0);
+    }
+
+    /** Strips the path from @param in_filename_with_path. */
+    std::string get_filename_without_path(const std::string& in_filename_with_path)
+    {
+        const size_t last_separator_pos = in_filename_with_path.find_last_of("/\\");
+
+        return (last_separator_pos != std::string::npos) ? in_filename_with_path.substr(last_separator_pos + 1)
+                                                         : in_filename_with_path;
+    }
+}
+
+
+/* Please see header for specification */
+Anvil::SPIRVDiskCache::SPIRVDiskCache(const std::string& in_directory,
+                                      uint64_t           in_max_size_in_bytes)
+    :m_directory        (in_directory),
+     m_max_size_in_bytes(in_max_size_in_bytes),
+     m_n_hits           (0),
+     m_n_misses         (0),
+     m_size_in_bytes    (0),
+     m_use_counter      (0)
+{
+    /* Stub */
+}
+
+/* Please see header for specification */
+Anvil::SPIRVDiskCache::~SPIRVDiskCache()
+{
+    /* Stub */
+}
+
+/* Please see header for specification */
+std::string Anvil::SPIRVDiskCache::calculate_key(const void* in_data,
+                                                 size_t      in_data_size)
+{
+    SHA256 hasher;
+
+    hasher.update(in_data,
+                  in_data_size);
+
+    return hasher.finalize();
+}
+
+/* Please see header for specification */
+void Anvil::SPIRVDiskCache::clear()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (auto entry_iterator  = m_entries.begin();
+              entry_iterator != m_entries.end();
+            ++entry_iterator)
+    {
+        Anvil::IO::delete_file(get_entry_filename(entry_iterator->first) );
+    }
+
+    m_entries.clear();
+
+    m_size_in_bytes = 0;
+}
+
+/* Please see header for specification */
+Anvil::SPIRVDiskCacheUniquePtr Anvil::SPIRVDiskCache::create(const std::string& in_directory,
+                                                             uint64_t           in_max_size_in_bytes)
+{
+    Anvil::SPIRVDiskCacheUniquePtr result_ptr(nullptr,
+                                              std::default_delete<Anvil::SPIRVDiskCache>() );
+
+    result_ptr.reset(
+        new Anvil::SPIRVDiskCache(in_directory,
+                                  in_max_size_in_bytes)
+    );
+
+    if (result_ptr != nullptr)
+    {
+        if (!result_ptr->init() )
+        {
+            result_ptr.reset();
+        }
+    }
+
+    return result_ptr;
+}
+
+/** Deletes least recently used entries until the total size of the cache drops below the eviction target.
+ *
+ *  Must be called with m_mutex locked.
+ **/
+void Anvil::SPIRVDiskCache::evict_entries_over_budget()
+{
+    typedef std::pair<std::pair<uint64_t, uint64_t>, std::string> LastUsedTimeAndKeyPair;
+
+    std::vector<LastUsedTimeAndKeyPair> entries_by_age;
+    const uint64_t                      target_size_in_bytes = m_max_size_in_bytes / SPIRV_DISK_CACHE_EVICTION_TARGET_DENOMINATOR
+                                                                                   * SPIRV_DISK_CACHE_EVICTION_TARGET_NUMERATOR;
+
+    if (m_size_in_bytes <= m_max_size_in_bytes)
+    {
+        goto end;
+    }
+
+    entries_by_age.reserve(m_entries.size() );
+
+    for (auto entry_iterator  = m_entries.begin();
+              entry_iterator != m_entries.end();
+            ++entry_iterator)
+    {
+        entries_by_age.push_back(
+            LastUsedTimeAndKeyPair(std::make_pair(entry_iterator->second.last_used_time,
+                                                  entry_iterator->second.last_used_counter),
+                                   entry_iterator->first)
+        );
+    }
+
+    std::sort(entries_by_age.begin(),
+              entries_by_age.end() );
+
+    for (auto age_iterator  = entries_by_age.begin();
+              age_iterator != entries_by_age.end() && m_size_in_bytes > target_size_in_bytes;
+            ++age_iterator)
+    {
+        auto entry_iterator = m_entries.find(age_iterator->second);
+
+        anvil_assert(entry_iterator != m_entries.end() );
+
+        /* The file may have already been deleted by another process sharing the directory, in which case
+         * there is nothing left to do apart from forgetting about the entry. */
+        Anvil::IO::delete_file(get_entry_filename(age_iterator->second) );
+
+        m_size_in_bytes -= entry_iterator->second.size;
+        m_entries.erase  (entry_iterator);
+    }
+
+end:
+    ;
+}
+
+/* Please see header for specification */
+uint64_t Anvil::SPIRVDiskCache::get_n_hits() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    return m_n_hits;
+}
+
+/* Please see header for specification */
+uint64_t Anvil::SPIRVDiskCache::get_n_misses() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    return m_n_misses;
+}
+
+/* Please see header for specification */
+uint64_t Anvil::SPIRVDiskCache::get_size_in_bytes() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    return m_size_in_bytes;
+}
+
+/** Returns name (incl. path) of the file which holds the blob associated with @param in_key. */
+std::string Anvil::SPIRVDiskCache::get_entry_filename(const std::string& in_key) const
+{
+    return m_directory + "/" + in_key + SPIRV_DISK_CACHE_ENTRY_EXTENSION;
+}
+
+/** Creates the cache directory, if needed, and indexes the blobs which are already held in it.
+ *
+ *  @return true if successful, false otherwise.
+ **/
+bool Anvil::SPIRVDiskCache::init()
+{
+    std::vector<std::string> filenames;
+    const uint64_t           current_time = static_cast<uint64_t>(time(nullptr) );
+    bool                     result       = false;
+
+    if (!Anvil::IO::is_directory(m_directory) )
+    {
+        Anvil::IO::create_directory(m_directory);
+
+        if (!Anvil::IO::is_directory(m_directory) )
+        {
+            goto end;
+        }
+    }
+
+    if (!Anvil::IO::enumerate_files_in_directory(m_directory,
+                                                 false, /* in_recursive */
+                                                &filenames) )
+    {
+        goto end;
+    }
+
+    for (auto filename_iterator  = filenames.begin();
+              filename_iterator != filenames.end();
+            ++filename_iterator)
+    {
+        const std::string filename          = get_filename_without_path(*filename_iterator);
+        uint64_t          modification_time = 0;
+        uint64_t          size              = 0;
+
+        if (!get_file_properties(*filename_iterator,
+                                 &size,
+                                 &modification_time) )
+        {
+            continue;
+        }
+
+        if (ends_with(filename,
+                      SPIRV_DISK_CACHE_TEMP_FILE_EXTENSION) )
+        {
+            /* Leftover of a writer which has been terminated before it managed to rename the file. Temporary files
+             * which are not that old may still be in use by other processes, so leave them alone. */
+            if (modification_time + SPIRV_DISK_CACHE_TEMP_FILE_MAX_AGE < current_time)
+            {
+                Anvil::IO::delete_file(*filename_iterator);
+            }
+
+            continue;
+        }
+
+        if (ends_with(filename,
+                      SPIRV_DISK_CACHE_ENTRY_EXTENSION) )
+        {
+            const std::string key = filename.substr(0,
+                                                    filename.size() - strlen(SPIRV_DISK_CACHE_ENTRY_EXTENSION) );
+
+            if (!is_key_valid(key) )
+            {
+                continue;
+            }
+
+            m_entries[key]   = EntryInfo(modification_time,
+                                         0, /* in_last_used_counter */
+                                         size);
+            m_size_in_bytes += size;
+        }
+    }
+
+    evict_entries_over_budget();
+
+    result = true;
+end:
+    return result;
+}
+
+/** Tells whether @param in_key looks like a key returned by calculate_key(). **/
+bool Anvil::SPIRVDiskCache::is_key_valid(const std::string& in_key) const
+{
+    bool result = (in_key.size() == 64);
+
+    for (auto char_iterator  = in_key.begin();
+              char_iterator != in_key.end() && result;
+            ++char_iterator)
+    {
+        result = ((*char_iterator >= '0' && *char_iterator <= '9') ||
+                  (*char_iterator >= 'a' && *char_iterator <= 'f') );
+    }
+
+    return result;
+}
+
+/* Please see header for specification */
+bool Anvil::SPIRVDiskCache::load(const std::string& in_key,
+                                 std::vector<char>* out_blob_ptr)
+{
+    const std::string entry_filename = get_entry_filename(in_key);
+    FILE*             file_ptr       = nullptr;
+    EntryHeader       header;
+    bool              result         = false;
+    uint32_t          spirv_magic    = 0;
+
+    anvil_assert(is_key_valid(in_key) );
+    anvil_assert(out_blob_ptr != nullptr);
+
+    /* NOTE: The entry may have been stored by another process, so do not rely on m_entries to tell whether the blob
+     *       is available. */
+    file_ptr = fopen(entry_filename.c_str(),
+                     "rb");
+
+    if (file_ptr == nullptr)
+    {
+        goto end;
+    }
+
+    if (fread(&header,
+              sizeof(header),
+              1, /* count */
+              file_ptr) != 1)
+    {
+        goto end;
+    }
+
+    if (header.magic     != SPIRV_DISK_CACHE_ENTRY_MAGIC   ||
+        header.version   != SPIRV_DISK_CACHE_ENTRY_VERSION ||
+        header.blob_size <  sizeof(uint32_t)               ||
+        header.blob_size >  m_max_size_in_bytes            ||
+        header.blob_size %  sizeof(uint32_t) != 0)
+    {
+        goto end;
+    }
+
+    out_blob_ptr->resize(static_cast<size_t>(header.blob_size) );
+
+    if (fread(&out_blob_ptr->at(0),
+              out_blob_ptr->size(),
+              1, /* count */
+              file_ptr) != 1)
+    {
+        goto end;
+    }
+
+    memcpy(&spirv_magic,
+           &out_blob_ptr->at(0),
+           sizeof(spirv_magic) );
+
+    result = (spirv_magic == SPIRV_MAGIC_NUMBER);
+
+end:
+    if (file_ptr != nullptr)
+    {
+        fclose(file_ptr);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (result)
+        {
+            const uint64_t entry_size = sizeof(header) + header.blob_size;
+            auto           entry_iterator = m_entries.find(in_key);
+
+            if (entry_iterator == m_entries.end() )
+            {
+                m_entries[in_key] = EntryInfo(0, /* in_last_used_time    */
+                                              0, /* in_last_used_counter */
+                                              entry_size);
+                m_size_in_bytes  += entry_size;
+
+                entry_iterator = m_entries.find(in_key);
+            }
+
+            entry_iterator->second.last_used_counter = ++m_use_counter;
+            entry_iterator->second.last_used_time    = static_cast<uint64_t>(time(nullptr) );
+
+            ++m_n_hits;
+        }
+        else
+        {
+            ++m_n_misses;
+        }
+    }
+
+    if (result)
+    {
+        /* Bump the modification time, so that the LRU order is preserved for future application runs. */
+        touch_file(entry_filename);
+    }
+    else
+    {
+        out_blob_ptr->clear();
+    }
+
+    return result;
+}
+
+/* Please see header for specification */
+bool Anvil::SPIRVDiskCache::store(const std::string& in_key,
+                                  const char*        in_blob,
+                                  size_t             in_blob_size)
+{
+    const std::string entry_filename = get_entry_filename(in_key);
+    FILE*             file_ptr       = nullptr;
+    EntryHeader       header;
+    bool              result         = false;
+    const std::string temp_filename  = entry_filename + get_unique_temp_file_suffix();
+
+    anvil_assert(is_key_valid(in_key) );
+    anvil_assert(in_blob       != nullptr);
+    anvil_assert(in_blob_size  >= sizeof(uint32_t) &&
+                 (in_blob_size %  sizeof(uint32_t) ) == 0);
+
+    header.magic     = SPIRV_DISK_CACHE_ENTRY_MAGIC;
+    header.version   = SPIRV_DISK_CACHE_ENTRY_VERSION;
+    header.blob_size = in_blob_size;
+
+    if (in_blob_size > m_max_size_in_bytes)
+    {
+        /* Would be evicted right away. */
+        goto end;
+    }
+
+    /* Write the entry to a temporary file first. This way, nobody is ever going to see a partially written entry. */
+    file_ptr = fopen(temp_filename.c_str(),
+                     "wb");
+
+    if (file_ptr == nullptr)
+    {
+        goto end;
+    }
+
+    result = (fwrite(&header,
+                     sizeof(header),
+                     1, /* count */
+                     file_ptr) == 1);
+
+    if (result)
+    {
+        result = (fwrite(in_blob,
+                         in_blob_size,
+                         1, /* count */
+                         file_ptr) == 1);
+    }
+
+    if (fclose(file_ptr) != 0)
+    {
+        result = false;
+    }
+
+    if (result)
+    {
+        result = rename_file(temp_filename,
+                             entry_filename);
+    }
+
+    if (!result)
+    {
+        Anvil::IO::delete_file(temp_filename);
+
+        goto end;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock          (m_mutex);
+        const uint64_t               entry_size     = sizeof(header) + in_blob_size;
+        auto                         entry_iterator = m_entries.find(in_key);
+
+        if (entry_iterator != m_entries.end() )
+        {
+            m_size_in_bytes -= entry_iterator->second.size;
+        }
+
+        m_entries[in_key] = EntryInfo(static_cast<uint64_t>(time(nullptr) ),
+                                      ++m_use_counter,
+                                      entry_size);
+        m_size_in_bytes  += entry_size;
+
+        evict_entries_over_budget();
+    }
+
+end:
+    return result;
+}
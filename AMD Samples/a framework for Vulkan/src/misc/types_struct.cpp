@@ -1909,6 +1909,29 @@ bool Anvil::operator==(const MemoryProperties& in1,
     return result;
 }
 
+Anvil::MemoryAllocatorStatistics::MemoryAllocatorStatistics()
+    :largest_free_range_size(0),
+     n_allocations          (0),
+     n_bytes_allocated      (0),
+     n_bytes_reserved       (0),
+     n_free_ranges          (0),
+     n_pages                (0)
+{
+    /* Stub */
+}
+
+float Anvil::MemoryAllocatorStatistics::get_fragmentation() const
+{
+    const VkDeviceSize n_bytes_free = n_bytes_reserved - n_bytes_allocated;
+
+    if (n_bytes_free == 0)
+    {
+        return 0.0f;
+    }
+
+    return 1.0f - static_cast<float>(static_cast<double>(largest_free_range_size) / static_cast<double>(n_bytes_free) );
+}
+
 Anvil::MemoryProperties::MemoryProperties()
 {
     heaps   = nullptr;
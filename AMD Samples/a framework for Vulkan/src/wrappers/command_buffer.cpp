@@ -76,7 +76,8 @@ Anvil::BeginQueryIndexedEXTCommand::BeginQueryIndexedEXTCommand(Anvil::QueryPool
 }
 
 /** Please see header for specification */
-Anvil::BeginRenderPassCommand::BeginRenderPassCommand(uint32_t                                in_n_clear_values,
+Anvil::BeginRenderPassCommand::BeginRenderPassCommand(Anvil::CommandStash*                    in_stash_ptr,
+                                                      uint32_t                                in_n_clear_values,
                                                       const VkClearValue*                     in_clear_value_ptrs,
                                                       Anvil::Framebuffer*                     in_fbo_ptr,
                                                       uint32_t                                in_device_mask,
@@ -95,53 +96,42 @@ Anvil::BeginRenderPassCommand::BeginRenderPassCommand(uint32_t
     fbo_ptr         = in_fbo_ptr;
     render_pass_ptr = in_render_pass_ptr;
 
-    for (uint32_t n_clear_value = 0;
-                  n_clear_value < in_n_clear_values;
-                ++n_clear_value)
-    {
-        clear_values.push_back(in_clear_value_ptrs[n_clear_value]);
-    }
-
-    attachment_initial_sample_locations.resize(in_n_attachment_initial_sample_locations);
-    post_subpass_sample_locations.resize      (in_n_post_subpass_sample_locations);
-    render_areas.resize                       (in_n_render_areas);
-
-    for (uint32_t n_render_area = 0;
-                  n_render_area < in_n_render_areas;
-                ++n_render_area)
-    {
-        render_areas.at(n_render_area) = in_render_areas_ptr[n_render_area];
-    }
-
-    for (uint32_t n_attachment = 0;
-                  n_attachment < in_n_attachment_initial_sample_locations;
-                ++n_attachment)
-    {
-        attachment_initial_sample_locations.at(n_attachment) = in_attachment_initial_sample_locations_ptr[n_attachment];
-    }
-
-    for (uint32_t n_subpass = 0;
-                  n_subpass < in_n_post_subpass_sample_locations;
-                ++n_subpass)
-    {
-        post_subpass_sample_locations.at(n_subpass) = in_post_subpass_sample_locations_ptr[n_subpass];
-    }
+    attachment_initial_sample_locations = in_stash_ptr->copy_array(in_attachment_initial_sample_locations_ptr,
+                                                                   in_n_attachment_initial_sample_locations);
+    clear_values                        = in_stash_ptr->copy_array(in_clear_value_ptrs,
+                                                                   in_n_clear_values);
+    post_subpass_sample_locations       = in_stash_ptr->copy_array(in_post_subpass_sample_locations_ptr,
+                                                                   in_n_post_subpass_sample_locations);
+    render_areas                        = in_stash_ptr->copy_array(in_render_areas_ptr,
+                                                                   in_n_render_areas);
 }
 
 /** Please see header for specification */
-Anvil::BeginTransformFeedbackEXTCommand::BeginTransformFeedbackEXTCommand(const uint32_t&                          in_first_counter_buffer,
-                                                                          const std::vector<const Anvil::Buffer*>& in_counter_buffer_ptrs,
-                                                                          const std::vector<VkDeviceSize>&         in_counter_buffer_offsets)
-    :Command               (COMMAND_TYPE_BEGIN_TRANSFORM_FEEDBACK_EXT),
-     counter_buffer_ptrs   (in_counter_buffer_ptrs),
-     counter_buffer_offsets(in_counter_buffer_offsets),
-     first_counter_buffer  (in_first_counter_buffer)
-{
-    /* Stub */
+Anvil::BeginTransformFeedbackEXTCommand::BeginTransformFeedbackEXTCommand(Anvil::CommandStash*        in_stash_ptr,
+                                                                          const uint32_t&             in_first_counter_buffer,
+                                                                          const uint32_t&             in_n_counter_buffers,
+                                                                          const Anvil::Buffer* const* in_opt_counter_buffer_ptrs,
+                                                                          const VkDeviceSize*         in_opt_counter_buffer_offsets)
+    :Command             (COMMAND_TYPE_BEGIN_TRANSFORM_FEEDBACK_EXT),
+     first_counter_buffer(in_first_counter_buffer)
+{
+    counter_buffer_offsets = in_stash_ptr->generate_array<VkDeviceSize>(in_n_counter_buffers,
+                                                                        [=](uint32_t in_n_counter_buffer)
+                                                                        {
+                                                                            return (in_opt_counter_buffer_offsets != nullptr) ? in_opt_counter_buffer_offsets[in_n_counter_buffer]
+                                                                                                                              : 0;
+                                                                        });
+    counter_buffer_ptrs    = in_stash_ptr->generate_array<const Anvil::Buffer*>(in_n_counter_buffers,
+                                                                                [=](uint32_t in_n_counter_buffer)
+                                                                                {
+                                                                                    return (in_opt_counter_buffer_ptrs != nullptr) ? in_opt_counter_buffer_ptrs[in_n_counter_buffer]
+                                                                                                                                   : nullptr;
+                                                                                });
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::BindDescriptorSetsCommand::BindDescriptorSetsCommand(Anvil::PipelineBindPoint           in_pipeline_bind_point,
+Anvil::CommandBufferBase::BindDescriptorSetsCommand::BindDescriptorSetsCommand(Anvil::CommandStash*               in_stash_ptr,
+                                                                               Anvil::PipelineBindPoint           in_pipeline_bind_point,
                                                                                Anvil::PipelineLayout*             in_layout_ptr,
                                                                                uint32_t                           in_first_set,
                                                                                uint32_t                           in_set_count,
@@ -154,19 +144,11 @@ Anvil::CommandBufferBase::BindDescriptorSetsCommand::BindDescriptorSetsCommand(A
     layout_ptr          = in_layout_ptr;
     pipeline_bind_point = in_pipeline_bind_point;
 
-    for (uint32_t n_set = 0;
-                  n_set < in_set_count;
-                ++n_set)
-    {
-        descriptor_sets.push_back(in_descriptor_set_ptrs[n_set]);
-    }
+    descriptor_sets = in_stash_ptr->copy_array(in_descriptor_set_ptrs,
+                                               in_set_count);
 
-    for (uint32_t n_dynamic_offset = 0;
-                  n_dynamic_offset < in_dynamic_offset_count;
-                ++n_dynamic_offset)
-    {
-        dynamic_offsets.push_back(in_dynamic_offset_ptrs[n_dynamic_offset]);
-    }
+    dynamic_offsets = in_stash_ptr->copy_array(in_dynamic_offset_ptrs,
+                                               in_dynamic_offset_count);
 }
 
 /** Please see header for specification */
@@ -191,21 +173,21 @@ Anvil::CommandBufferBase::BindPipelineCommand::BindPipelineCommand(Anvil::Pipeli
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::BindVertexBuffersCommand::BindVertexBuffersCommand(uint32_t            in_start_binding,
-                                                                             uint32_t            in_binding_count,
-                                                                             Anvil::Buffer**     in_buffer_ptrs,
-                                                                             const VkDeviceSize* in_offset_ptrs)
+Anvil::CommandBufferBase::BindVertexBuffersCommand::BindVertexBuffersCommand(Anvil::CommandStash* in_stash_ptr,
+                                                                             uint32_t             in_start_binding,
+                                                                             uint32_t             in_binding_count,
+                                                                             Anvil::Buffer**      in_buffer_ptrs,
+                                                                             const VkDeviceSize*  in_offset_ptrs)
     :Command(COMMAND_TYPE_BIND_VERTEX_BUFFER)
 {
     start_binding = in_start_binding;
 
-    for (uint32_t n_binding = 0;
-                  n_binding < in_binding_count;
-                ++n_binding)
-    {
-        bindings.push_back(BindVertexBuffersCommandBinding(in_buffer_ptrs[n_binding],
-                                                           in_offset_ptrs[n_binding]) );
-    }
+    bindings = in_stash_ptr->generate_array<BindVertexBuffersCommandBinding>(in_binding_count,
+                                                                             [=](uint32_t in_n_binding)
+                                                                             {
+                                                                                 return BindVertexBuffersCommandBinding(in_buffer_ptrs[in_n_binding],
+                                                                                                                        in_offset_ptrs[in_n_binding]);
+                                                                             });
 }
 
 /** Please see header for specification */
@@ -226,7 +208,8 @@ Anvil::CommandBufferBase::BindVertexBuffersCommandBinding::BindVertexBuffersComm
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::BlitImageCommand::BlitImageCommand(Anvil::Image*           in_src_image_ptr,
+Anvil::CommandBufferBase::BlitImageCommand::BlitImageCommand(Anvil::CommandStash*    in_stash_ptr,
+                                                             Anvil::Image*           in_src_image_ptr,
                                                              Anvil::ImageLayout      in_src_image_layout,
                                                              Anvil::Image*           in_dst_image_ptr,
                                                              Anvil::ImageLayout      in_dst_image_layout,
@@ -243,56 +226,51 @@ Anvil::CommandBufferBase::BlitImageCommand::BlitImageCommand(Anvil::Image*
     src_image_layout = in_src_image_layout;
     src_image_ptr    = in_src_image_ptr;
 
-    for (uint32_t n_region = 0;
-                  n_region < in_region_count;
-                ++n_region)
-    {
-        regions.push_back(in_region_ptrs[n_region]);
-    }
+    regions = in_stash_ptr->copy_array(in_region_ptrs,
+                                       in_region_count);
 }
 
 /** Please see header for specification */
-Anvil::BindTransformFeedbackBuffersEXTCommand::BindTransformFeedbackBuffersEXTCommand(const uint32_t&                    in_first_binding,
-                                                                                      const uint32_t&                    in_n_bindings,
-                                                                                      const std::vector<Anvil::Buffer*>& in_buffer_ptrs,
-                                                                                      const std::vector<VkDeviceSize>&   in_offsets,
-                                                                                      const std::vector<VkDeviceSize>&   in_sizes)
+Anvil::BindTransformFeedbackBuffersEXTCommand::BindTransformFeedbackBuffersEXTCommand(Anvil::CommandStash*  in_stash_ptr,
+                                                                                      const uint32_t&       in_first_binding,
+                                                                                      const uint32_t&       in_n_bindings,
+                                                                                      Anvil::Buffer* const* in_buffer_ptrs,
+                                                                                      const VkDeviceSize*   in_offsets,
+                                                                                      const VkDeviceSize*   in_sizes)
     :Command      (COMMAND_TYPE_BIND_TRANSFORM_FEEDBACK_BUFFERS_EXT),
-     buffer_ptrs  (in_buffer_ptrs),
+     buffer_ptrs  (in_stash_ptr->copy_array(in_buffer_ptrs, in_n_bindings) ),
      first_binding(in_first_binding),
      n_bindings   (in_n_bindings),
-     offsets      (in_offsets),
-     sizes        (in_sizes)
+     offsets      (in_stash_ptr->copy_array(in_offsets,     in_n_bindings) ),
+     sizes        (in_stash_ptr->copy_array(in_sizes,       in_n_bindings) )
 {
     /* Stub */
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::ClearAttachmentsCommand::ClearAttachmentsCommand(uint32_t                      in_n_attachments,
+Anvil::CommandBufferBase::ClearAttachmentsCommand::ClearAttachmentsCommand(Anvil::CommandStash*          in_stash_ptr,
+                                                                           uint32_t                      in_n_attachments,
                                                                            const Anvil::ClearAttachment* in_attachments,
                                                                            uint32_t                      in_n_rects,
                                                                            const VkClearRect*            in_rect_ptrs)
     :Command(COMMAND_TYPE_CLEAR_ATTACHMENTS)
 {
-    for (uint32_t n_attachment = 0;
-                  n_attachment < in_n_attachments;
-                ++n_attachment)
-    {
-        attachments.push_back(ClearAttachmentsCommandAttachment(in_attachments[n_attachment].aspect_mask,
-                                                                in_attachments[n_attachment].clear_value,
-                                                                in_attachments[n_attachment].color_attachment) );
-    }
+    attachments = in_stash_ptr->generate_array<ClearAttachmentsCommandAttachment>(in_n_attachments,
+                                                                                  [=](uint32_t in_n_attachment)
+                                                                                  {
+                                                                                      return ClearAttachmentsCommandAttachment(in_attachments[in_n_attachment].aspect_mask,
+                                                                                                                               in_attachments[in_n_attachment].clear_value,
+                                                                                                                               in_attachments[in_n_attachment].color_attachment);
+                                                                                  });
 
-    for (uint32_t n_rect = 0;
-                  n_rect < in_n_rects;
-                ++n_rect)
-    {
-        rects.push_back(in_rect_ptrs[n_rect]);
-    }
+
+    rects = in_stash_ptr->copy_array(in_rect_ptrs,
+                                     in_n_rects);
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::ClearColorImageCommand::ClearColorImageCommand(Anvil::Image*                       in_image_ptr,
+Anvil::CommandBufferBase::ClearColorImageCommand::ClearColorImageCommand(Anvil::CommandStash*                in_stash_ptr,
+                                                                         Anvil::Image*                       in_image_ptr,
                                                                          Anvil::ImageLayout                  in_image_layout,
                                                                          const VkClearColorValue*            in_color_ptr,
                                                                          uint32_t                            in_range_count,
@@ -304,16 +282,13 @@ Anvil::CommandBufferBase::ClearColorImageCommand::ClearColorImageCommand(Anvil::
     image_layout = in_image_layout;
     image_ptr    = in_image_ptr;
 
-    for (uint32_t n_range = 0;
-                  n_range < in_range_count;
-                ++n_range)
-    {
-        ranges.push_back(in_range_ptrs[n_range]);
-    }
+    ranges = in_stash_ptr->copy_array(in_range_ptrs,
+                                      in_range_count);
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::ClearDepthStencilImageCommand::ClearDepthStencilImageCommand(Anvil::Image*                       in_image_ptr,
+Anvil::CommandBufferBase::ClearDepthStencilImageCommand::ClearDepthStencilImageCommand(Anvil::CommandStash*                in_stash_ptr,
+                                                                                       Anvil::Image*                       in_image_ptr,
                                                                                        Anvil::ImageLayout                  in_image_layout,
                                                                                        const VkClearDepthStencilValue*     in_depth_stencil_ptr,
                                                                                        uint32_t                            in_range_count,
@@ -325,16 +300,13 @@ Anvil::CommandBufferBase::ClearDepthStencilImageCommand::ClearDepthStencilImageC
     image_layout  =  in_image_layout;
     image_ptr     =  in_image_ptr;
 
-    for (uint32_t n_range = 0;
-                  n_range < in_range_count;
-                ++n_range)
-    {
-        ranges.push_back(in_range_ptrs[n_range]);
-    }
+    ranges = in_stash_ptr->copy_array(in_range_ptrs,
+                                      in_range_count);
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::CopyBufferCommand::CopyBufferCommand(Anvil::Buffer*           in_src_buffer_ptr,
+Anvil::CommandBufferBase::CopyBufferCommand::CopyBufferCommand(Anvil::CommandStash*     in_stash_ptr,
+                                                               Anvil::Buffer*           in_src_buffer_ptr,
                                                                Anvil::Buffer*           in_dst_buffer_ptr,
                                                                uint32_t                 in_region_count,
                                                                const Anvil::BufferCopy* in_region_ptrs)
@@ -345,16 +317,13 @@ Anvil::CommandBufferBase::CopyBufferCommand::CopyBufferCommand(Anvil::Buffer*
     src_buffer     = in_src_buffer_ptr->get_buffer();
     src_buffer_ptr = in_src_buffer_ptr;
 
-    for (uint32_t n_region = 0;
-                  n_region < in_region_count;
-                ++n_region)
-    {
-        regions.push_back(in_region_ptrs[n_region]);
-    }
+    regions = in_stash_ptr->copy_array(in_region_ptrs,
+                                       in_region_count);
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::CopyBufferToImageCommand::CopyBufferToImageCommand(Anvil::Buffer*                in_src_buffer_ptr,
+Anvil::CommandBufferBase::CopyBufferToImageCommand::CopyBufferToImageCommand(Anvil::CommandStash*          in_stash_ptr,
+                                                                             Anvil::Buffer*                in_src_buffer_ptr,
                                                                              Anvil::Image*                 in_dst_image_ptr,
                                                                              Anvil::ImageLayout            in_dst_image_layout,
                                                                              uint32_t                      in_region_count,
@@ -367,16 +336,13 @@ Anvil::CommandBufferBase::CopyBufferToImageCommand::CopyBufferToImageCommand(Anv
     src_buffer       = in_src_buffer_ptr->get_buffer();
     src_buffer_ptr   = in_src_buffer_ptr;
 
-    for (uint32_t n_region = 0;
-                  n_region < in_region_count;
-                ++n_region)
-    {
-        regions.push_back(in_region_ptrs[n_region]);
-    }
+    regions = in_stash_ptr->copy_array(in_region_ptrs,
+                                       in_region_count);
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::CopyImageCommand::CopyImageCommand(Anvil::Image*           in_src_image_ptr,
+Anvil::CommandBufferBase::CopyImageCommand::CopyImageCommand(Anvil::CommandStash*    in_stash_ptr,
+                                                             Anvil::Image*           in_src_image_ptr,
                                                              Anvil::ImageLayout      in_src_image_layout,
                                                              Anvil::Image*           in_dst_image_ptr,
                                                              Anvil::ImageLayout      in_dst_image_layout,
@@ -391,16 +357,13 @@ Anvil::CommandBufferBase::CopyImageCommand::CopyImageCommand(Anvil::Image*
     src_image_layout = in_src_image_layout;
     src_image_ptr    = in_src_image_ptr;
 
-    for (uint32_t n_region = 0;
-                  n_region < in_region_count;
-                ++n_region)
-    {
-        regions.push_back(in_region_ptrs[n_region]);
-    }
+    regions = in_stash_ptr->copy_array(in_region_ptrs,
+                                       in_region_count);
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::CopyImageToBufferCommand::CopyImageToBufferCommand(Anvil::Image*                 in_src_image_ptr,
+Anvil::CommandBufferBase::CopyImageToBufferCommand::CopyImageToBufferCommand(Anvil::CommandStash*          in_stash_ptr,
+                                                                             Anvil::Image*                 in_src_image_ptr,
                                                                              Anvil::ImageLayout            in_src_image_layout,
                                                                              Anvil::Buffer*                in_dst_buffer_ptr,
                                                                              uint32_t                      in_region_count,
@@ -413,12 +376,8 @@ Anvil::CommandBufferBase::CopyImageToBufferCommand::CopyImageToBufferCommand(Anv
     src_image_layout = in_src_image_layout;
     src_image_ptr    = in_src_image_ptr;
 
-    for (uint32_t n_region = 0;
-                  n_region < in_region_count;
-                ++n_region)
-    {
-        regions.push_back(in_region_ptrs[n_region]);
-    }
+    regions = in_stash_ptr->copy_array(in_region_ptrs,
+                                       in_region_count);
 }
 
 /** Please see header for specification */
@@ -442,8 +401,9 @@ Anvil::CommandBufferBase::CopyQueryPoolResultsCommand::CopyQueryPoolResultsComma
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::DebugMarkerBeginEXTCommand::DebugMarkerBeginEXTCommand(const std::string& in_marker_name,
-                                                                                 const float*       in_color)
+Anvil::CommandBufferBase::DebugMarkerBeginEXTCommand::DebugMarkerBeginEXTCommand(Anvil::CommandStash* in_stash_ptr,
+                                                                                 const char*          in_marker_name,
+                                                                                 const float*         in_color)
     :Command(Anvil::COMMAND_TYPE_DEBUG_MARKER_BEGIN_EXT)
 {
     if (in_color != nullptr)
@@ -459,7 +419,7 @@ Anvil::CommandBufferBase::DebugMarkerBeginEXTCommand::DebugMarkerBeginEXTCommand
                sizeof(color) );
     }
 
-    marker_name = in_marker_name;
+    marker_name = in_stash_ptr->copy_string(in_marker_name);
 }
 
 /** Please see header for specification */
@@ -470,8 +430,9 @@ Anvil::CommandBufferBase::DebugMarkerEndEXTCommand::DebugMarkerEndEXTCommand()
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::DebugMarkerInsertEXTCommand::DebugMarkerInsertEXTCommand(const std::string& in_marker_name,
-                                                                                   const float*       in_color)
+Anvil::CommandBufferBase::DebugMarkerInsertEXTCommand::DebugMarkerInsertEXTCommand(Anvil::CommandStash* in_stash_ptr,
+                                                                                   const char*          in_marker_name,
+                                                                                   const float*         in_color)
     :Command(Anvil::COMMAND_TYPE_DEBUG_MARKER_INSERT_EXT)
 {
     if (in_color != nullptr)
@@ -487,7 +448,7 @@ Anvil::CommandBufferBase::DebugMarkerInsertEXTCommand::DebugMarkerInsertEXTComma
                sizeof(color) );
     }
 
-    marker_name = in_marker_name;
+    marker_name = in_stash_ptr->copy_string(in_marker_name);
 }
 
 /** Please see header for specification */
@@ -705,29 +666,41 @@ Anvil::EndRenderPassCommand::EndRenderPassCommand()
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::EndTransformFeedbackEXTCommand::EndTransformFeedbackEXTCommand(const uint32_t&                          in_first_counter_buffer,
-                                                                                         const std::vector<const Anvil::Buffer*>& in_counter_buffer_ptrs,
-                                                                                         const std::vector<VkDeviceSize>&         in_counter_buffer_offsets)
-    :Command               (COMMAND_TYPE_END_TRANSFORM_FEEDBACK_EXT),
-     first_counter_buffer  (in_first_counter_buffer),
-     counter_buffer_ptrs   (in_counter_buffer_ptrs),
-     counter_buffer_offsets(in_counter_buffer_offsets)
-{
-    /* Stub */
+Anvil::CommandBufferBase::EndTransformFeedbackEXTCommand::EndTransformFeedbackEXTCommand(Anvil::CommandStash*        in_stash_ptr,
+                                                                                         const uint32_t&             in_first_counter_buffer,
+                                                                                         const uint32_t&             in_n_counter_buffers,
+                                                                                         const Anvil::Buffer* const* in_opt_counter_buffer_ptrs,
+                                                                                         const VkDeviceSize*         in_opt_counter_buffer_offsets)
+    :Command             (COMMAND_TYPE_END_TRANSFORM_FEEDBACK_EXT),
+     first_counter_buffer(in_first_counter_buffer)
+{
+    counter_buffer_offsets = in_stash_ptr->generate_array<VkDeviceSize>(in_n_counter_buffers,
+                                                                        [=](uint32_t in_n_counter_buffer)
+                                                                        {
+                                                                            return (in_opt_counter_buffer_offsets != nullptr) ? in_opt_counter_buffer_offsets[in_n_counter_buffer]
+                                                                                                                              : 0;
+                                                                        });
+    counter_buffer_ptrs    = in_stash_ptr->generate_array<const Anvil::Buffer*>(in_n_counter_buffers,
+                                                                                [=](uint32_t in_n_counter_buffer)
+                                                                                {
+                                                                                    return (in_opt_counter_buffer_ptrs != nullptr) ? in_opt_counter_buffer_ptrs[in_n_counter_buffer]
+                                                                                                                                   : nullptr;
+                                                                                });
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::ExecuteCommandsCommand::ExecuteCommandsCommand(uint32_t                        in_cmd_buffers_count,
+Anvil::CommandBufferBase::ExecuteCommandsCommand::ExecuteCommandsCommand(Anvil::CommandStash*            in_stash_ptr,
+                                                                         uint32_t                        in_cmd_buffers_count,
                                                                          Anvil::SecondaryCommandBuffer** in_cmd_buffer_ptrs)
     :Command(COMMAND_TYPE_EXECUTE_COMMANDS)
 {
-    for (uint32_t n_cmd_buffer = 0;
-                  n_cmd_buffer < in_cmd_buffers_count;
-                ++n_cmd_buffer)
-    {
-        command_buffers.push_back    (in_cmd_buffer_ptrs[n_cmd_buffer]->get_command_buffer() );
-        command_buffer_ptrs.push_back(in_cmd_buffer_ptrs[n_cmd_buffer]);
-    }
+    command_buffer_ptrs = in_stash_ptr->copy_array    (in_cmd_buffer_ptrs,
+                                                       in_cmd_buffers_count);
+    command_buffers     = in_stash_ptr->generate_array<VkCommandBuffer>(in_cmd_buffers_count,
+                                                                        [=](uint32_t in_n_cmd_buffer)
+                                                                        {
+                                                                            return in_cmd_buffer_ptrs[in_n_cmd_buffer]->get_command_buffer();
+                                                                        });
 }
 
 /** Please see header for specification */
@@ -752,7 +725,8 @@ Anvil::CommandBufferBase::NextSubpassCommand::NextSubpassCommand(Anvil::SubpassC
 }
 
 /** Please see header for specification */
-Anvil::PipelineBarrierCommand::PipelineBarrierCommand(Anvil::PipelineStageFlags  in_src_stage_mask,
+Anvil::PipelineBarrierCommand::PipelineBarrierCommand(Anvil::CommandStash*       in_stash_ptr,
+                                                      Anvil::PipelineStageFlags  in_src_stage_mask,
                                                       Anvil::PipelineStageFlags  in_dst_stage_mask,
                                                       Anvil::DependencyFlags     in_flags,
                                                       uint32_t                   in_memory_barrier_count,
@@ -760,37 +734,26 @@ Anvil::PipelineBarrierCommand::PipelineBarrierCommand(Anvil::PipelineStageFlags
                                                       uint32_t                   in_buffer_memory_barrier_count,
                                                       const BufferBarrier* const in_buffer_memory_barrier_ptr_ptr,
                                                       uint32_t                   in_image_memory_barrier_count,
-                                                      const ImageBarrier*  const in_image_memory_barrier_ptr_ptr)
+                                                      const ImageBarrier* const  in_image_memory_barrier_ptr_ptr)
     :Command(COMMAND_TYPE_PIPELINE_BARRIER)
 {
     dst_stage_mask = in_dst_stage_mask;
     flags          = in_flags;
     src_stage_mask = in_src_stage_mask;
 
-    for (uint32_t n_buffer_memory_barrier = 0;
-                  n_buffer_memory_barrier < in_buffer_memory_barrier_count;
-                ++n_buffer_memory_barrier)
-    {
-        buffer_barriers.push_back(in_buffer_memory_barrier_ptr_ptr[n_buffer_memory_barrier]);
-    }
+    buffer_barriers = in_stash_ptr->copy_array(in_buffer_memory_barrier_ptr_ptr,
+                                               in_buffer_memory_barrier_count);
 
-    for (uint32_t n_image_memory_barrier = 0;
-                  n_image_memory_barrier < in_image_memory_barrier_count;
-                ++n_image_memory_barrier)
-    {
-        image_barriers.push_back(in_image_memory_barrier_ptr_ptr[n_image_memory_barrier]);
-    }
+    image_barriers = in_stash_ptr->copy_array(in_image_memory_barrier_ptr_ptr,
+                                              in_image_memory_barrier_count);
 
-    for (uint32_t n_memory_barrier = 0;
-                  n_memory_barrier < in_memory_barrier_count;
-                ++n_memory_barrier)
-    {
-        memory_barriers.push_back(in_memory_barrier_ptr_ptr[n_memory_barrier]);
-    }
+    memory_barriers = in_stash_ptr->copy_array(in_memory_barrier_ptr_ptr,
+                                               in_memory_barrier_count);
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::PushConstantsCommand::PushConstantsCommand(Anvil::PipelineLayout*  in_layout_ptr,
+Anvil::CommandBufferBase::PushConstantsCommand::PushConstantsCommand(Anvil::CommandStash*    in_stash_ptr,
+                                                                     Anvil::PipelineLayout*  in_layout_ptr,
                                                                      Anvil::ShaderStageFlags in_stage_flags,
                                                                      uint32_t                in_offset,
                                                                      uint32_t                in_size,
@@ -801,7 +764,8 @@ Anvil::CommandBufferBase::PushConstantsCommand::PushConstantsCommand(Anvil::Pipe
     offset      = in_offset;
     size        = in_size;
     stage_flags = in_stage_flags;
-    values      = in_values;
+    values      = in_stash_ptr->copy_data(in_values,
+                                          in_size);
 }
 
 /** Please see header for specification */
@@ -826,11 +790,12 @@ Anvil::CommandBufferBase::ResetQueryPoolCommand::ResetQueryPoolCommand(Anvil::Qu
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::ResolveImageCommand::ResolveImageCommand(Anvil::Image*             in_src_image_ptr,
-                                                                   Anvil::ImageLayout        in_src_image_layout,
-                                                                   Anvil::Image*             in_dst_image_ptr,
-                                                                   Anvil::ImageLayout        in_dst_image_layout,
-                                                                   uint32_t                  in_region_count,
+Anvil::CommandBufferBase::ResolveImageCommand::ResolveImageCommand(Anvil::CommandStash*       in_stash_ptr,
+                                                                   Anvil::Image*              in_src_image_ptr,
+                                                                   Anvil::ImageLayout         in_src_image_layout,
+                                                                   Anvil::Image*              in_dst_image_ptr,
+                                                                   Anvil::ImageLayout         in_dst_image_layout,
+                                                                   uint32_t                   in_region_count,
                                                                    const Anvil::ImageResolve* in_region_ptrs)
     :Command(COMMAND_TYPE_RESOLVE_IMAGE)
 {
@@ -841,12 +806,8 @@ Anvil::CommandBufferBase::ResolveImageCommand::ResolveImageCommand(Anvil::Image*
     src_image_layout = in_src_image_layout;
     src_image_ptr    = in_src_image_ptr;
 
-    for (uint32_t n_region = 0;
-                  n_region < in_region_count;
-                ++n_region)
-    {
-        regions.push_back(in_region_ptrs[n_region]);
-    }
+    regions = in_stash_ptr->copy_array(in_region_ptrs,
+                                       in_region_count);
 }
 
 /** Please see header for specification */
@@ -910,19 +871,16 @@ Anvil::CommandBufferBase::SetSampleLocationsEXTCommand::SetSampleLocationsEXTCom
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::SetScissorCommand::SetScissorCommand(uint32_t        in_first_scissor,
-                                                               uint32_t        in_scissor_count,
-                                                               const VkRect2D* in_scissor_ptrs)
+Anvil::CommandBufferBase::SetScissorCommand::SetScissorCommand(Anvil::CommandStash* in_stash_ptr,
+                                                               uint32_t             in_first_scissor,
+                                                               uint32_t             in_scissor_count,
+                                                               const VkRect2D*      in_scissor_ptrs)
     :Command(COMMAND_TYPE_SET_SCISSOR)
 {
     first_scissor = in_first_scissor;
 
-    for (uint32_t n_scissor = 0;
-                  n_scissor < in_scissor_count;
-                ++n_scissor)
-    {
-        scissors.push_back(in_scissor_ptrs[n_scissor]);
-    }
+    scissors = in_stash_ptr->copy_array(in_scissor_ptrs,
+                                        in_scissor_count);
 }
 
 /** Please see header for specification */
@@ -953,29 +911,28 @@ Anvil::CommandBufferBase::SetStencilWriteMaskCommand::SetStencilWriteMaskCommand
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::SetViewportCommand::SetViewportCommand(uint32_t          in_first_viewport,
-                                                                 uint32_t          in_viewport_count,
-                                                                 const VkViewport* in_viewport_ptrs)
+Anvil::CommandBufferBase::SetViewportCommand::SetViewportCommand(Anvil::CommandStash* in_stash_ptr,
+                                                                 uint32_t             in_first_viewport,
+                                                                 uint32_t             in_viewport_count,
+                                                                 const VkViewport*    in_viewport_ptrs)
     :Command(COMMAND_TYPE_SET_VIEWPORT)
 {
     first_viewport = in_first_viewport;
 
-    for (uint32_t n_viewport = 0;
-                  n_viewport < in_viewport_count;
-                ++n_viewport)
-    {
-        viewports.push_back(in_viewport_ptrs[n_viewport]);
-    }
+    viewports = in_stash_ptr->copy_array(in_viewport_ptrs,
+                                         in_viewport_count);
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::UpdateBufferCommand::UpdateBufferCommand(Anvil::Buffer* in_dst_buffer_ptr,
-                                                                   VkDeviceSize   in_dst_offset,
-                                                                   VkDeviceSize   in_data_size,
-                                                                   const void*    in_data_ptr)
+Anvil::CommandBufferBase::UpdateBufferCommand::UpdateBufferCommand(Anvil::CommandStash* in_stash_ptr,
+                                                                   Anvil::Buffer*       in_dst_buffer_ptr,
+                                                                   VkDeviceSize         in_dst_offset,
+                                                                   VkDeviceSize         in_data_size,
+                                                                   const void*          in_data_ptr)
     :Command(COMMAND_TYPE_UPDATE_BUFFER)
 {
-    data_ptr       = in_data_ptr;
+    data_ptr       = in_stash_ptr->copy_data(in_data_ptr,
+                                             static_cast<size_t>(in_data_size) );
     data_size      = in_data_size;
     dst_buffer     = in_dst_buffer_ptr->get_buffer();
     dst_buffer_ptr = in_dst_buffer_ptr;
@@ -983,7 +940,8 @@ Anvil::CommandBufferBase::UpdateBufferCommand::UpdateBufferCommand(Anvil::Buffer
 }
 
 /** Please see header for specification */
-Anvil::CommandBufferBase::WaitEventsCommand::WaitEventsCommand(uint32_t                   in_event_count,
+Anvil::CommandBufferBase::WaitEventsCommand::WaitEventsCommand(Anvil::CommandStash*       in_stash_ptr,
+                                                               uint32_t                   in_event_count,
                                                                Anvil::Event* const*       in_event_ptrs,
                                                                Anvil::PipelineStageFlags  in_src_stage_mask,
                                                                Anvil::PipelineStageFlags  in_dst_stage_mask,
@@ -998,34 +956,22 @@ Anvil::CommandBufferBase::WaitEventsCommand::WaitEventsCommand(uint32_t
     dst_stage_mask = in_dst_stage_mask;
     src_stage_mask = in_src_stage_mask;
 
-    for (uint32_t n_event = 0;
-                  n_event < in_event_count;
-                ++n_event)
-    {
-        events.push_back    (in_event_ptrs[n_event]->get_event() );
-        event_ptrs.push_back(in_event_ptrs[n_event]);
-    }
+    event_ptrs = in_stash_ptr->copy_array    (in_event_ptrs,
+                                              in_event_count);
+    events     = in_stash_ptr->generate_array<VkEvent>(in_event_count,
+                                                       [=](uint32_t in_n_event)
+                                                       {
+                                                           return in_event_ptrs[in_n_event]->get_event();
+                                                       });
 
-    for (uint32_t n_buffer_memory_barrier = 0;
-                  n_buffer_memory_barrier < in_buffer_memory_barrier_count;
-                ++n_buffer_memory_barrier)
-    {
-        buffer_barriers.push_back(in_buffer_memory_barriers_ptr[n_buffer_memory_barrier]);
-    }
+    buffer_barriers = in_stash_ptr->copy_array(in_buffer_memory_barriers_ptr,
+                                               in_buffer_memory_barrier_count);
 
-    for (uint32_t n_image_memory_barrier = 0;
-                  n_image_memory_barrier < in_image_memory_barrier_count;
-                ++n_image_memory_barrier)
-    {
-        image_barriers.push_back(in_image_memory_barriers_ptr[n_image_memory_barrier]);
-    }
+    image_barriers = in_stash_ptr->copy_array(in_image_memory_barriers_ptr,
+                                              in_image_memory_barrier_count);
 
-    for (uint32_t n_memory_barrier = 0;
-                  n_memory_barrier < in_memory_barrier_count;
-                ++n_memory_barrier)
-    {
-        memory_barriers.push_back(in_memory_barriers_ptr[n_memory_barrier]);
-    }
+    memory_barriers = in_stash_ptr->copy_array(in_memory_barriers_ptr,
+                                               in_memory_barrier_count);
 }
 
 /** Please see header for specification */
@@ -1067,6 +1013,7 @@ Anvil::CommandBufferBase::CommandBufferBase(const Anvil::BaseDevice* in_device_p
      DebugMarkerSupportProvider     (in_device_ptr,
                                      Anvil::ObjectType::COMMAND_BUFFER),
      CallbacksSupportProvider       (COMMAND_BUFFER_CALLBACK_ID_COUNT),
+     m_callback_command_stash       (4 * 1024), /* in_block_size */
      m_command_buffer               (VK_NULL_HANDLE),
      m_device_mask                  (0),
      m_device_ptr                   (in_device_ptr),
@@ -1146,10 +1093,10 @@ end:
 }
 
 #ifdef STORE_COMMAND_BUFFER_COMMANDS
-    /** Clears the command vector by releasing all command descriptors back to the heap memory. */
+    /** Destroys all stashed command descriptors. The memory backing the stash is kept for subsequent recordings. */
     void Anvil::CommandBufferBase::clear_commands()
     {
-        m_commands.clear();
+        m_command_stash.reset();
     }
 #endif
 
@@ -1179,6 +1126,41 @@ end:
     ;
 }
 
+/** Please see header for specification */
+uint32_t Anvil::CommandBufferBase::get_n_stashed_commands() const
+{
+    #ifdef STORE_COMMAND_BUFFER_COMMANDS
+    {
+        return m_command_stash.get_n_commands();
+    }
+    #else
+    {
+        return 0;
+    }
+    #endif
+}
+
+/** Please see header for specification */
+const Anvil::Command* Anvil::CommandBufferBase::get_stashed_command(uint32_t in_n_command) const
+{
+    const Anvil::Command* result_ptr = nullptr;
+
+    #ifdef STORE_COMMAND_BUFFER_COMMANDS
+    {
+        if (in_n_command < m_command_stash.get_n_commands() )
+        {
+            result_ptr = m_command_stash.get_command(in_n_command);
+        }
+    }
+    #else
+    {
+        ANVIL_REDUNDANT_ARGUMENT(in_n_command);
+    }
+    #endif
+
+    return result_ptr;
+}
+
 /** Please see header for specification */
 void Anvil::CommandBufferBase::insert_debug_utils_label(const char*  in_label_name_ptr,
                                                         const float* in_color_vec4_ptr)
@@ -1227,9 +1209,9 @@ bool Anvil::CommandBufferBase::record_begin_query(Anvil::QueryPool*        in_qu
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(BeginQueryCommand(in_query_pool_ptr,
-                                                   in_entry,
-                                                   in_flags) );
+            m_command_stash.stash<BeginQueryCommand>(in_query_pool_ptr,
+                                                     in_entry,
+                                                     in_flags);
         }
     }
     #endif
@@ -1271,10 +1253,10 @@ bool Anvil::CommandBufferBase::record_begin_query_indexed(Anvil::QueryPool*
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(BeginQueryIndexedEXTCommand(in_query_pool_ptr,
-                                                             in_query,
-                                                             in_flags,
-                                                             in_index) );
+            m_command_stash.stash<BeginQueryIndexedEXTCommand>(in_query_pool_ptr,
+                                                               in_query,
+                                                               in_flags,
+                                                               in_index);
         }
     }
     #endif
@@ -1332,29 +1314,11 @@ bool Anvil::CommandBufferBase::record_begin_transform_feedback_EXT(const uint32_
     {
         if (!m_command_stashing_disabled)
         {
-            std::vector<const Anvil::Buffer*> buffer_ptr_vec(in_n_counter_buffers,
-                                                             nullptr);
-            std::vector<VkDeviceSize>         offset_vec    (in_n_counter_buffers);
-
-            for (uint32_t n_counter_buffer = 0;
-                          n_counter_buffer < in_n_counter_buffers;
-                        ++n_counter_buffer)
-            {
-                if (in_opt_counter_buffer_ptrs                   != nullptr &&
-                    in_opt_counter_buffer_ptrs[n_counter_buffer] != nullptr)
-                {
-                    buffer_ptr_vec.at(n_counter_buffer) = in_opt_counter_buffer_ptrs[n_counter_buffer];
-                }
-
-                if (in_opt_counter_buffer_offsets != nullptr)
-                {
-                    offset_vec.at(n_counter_buffer) = in_opt_counter_buffer_offsets[n_counter_buffer];
-                }
-            }
-
-            m_commands.push_back(BeginTransformFeedbackEXTCommand(in_first_counter_buffer,
-                                                                  buffer_ptr_vec,
-                                                                  offset_vec) );
+            m_command_stash.stash<BeginTransformFeedbackEXTCommand>(&m_command_stash,
+                                                                    in_first_counter_buffer,
+                                                                    in_n_counter_buffers,
+                                                                    in_opt_counter_buffer_ptrs,
+                                                                    in_opt_counter_buffer_offsets);
         }
     }
     #endif
@@ -1389,6 +1353,10 @@ bool Anvil::CommandBufferBase::record_bind_descriptor_sets(Anvil::PipelineBindPo
     auto dss_vk = std::vector<VkDescriptorSet>(in_set_count);
     bool result = false;
 
+    /* Flush pending updates of all sets in one go, rather than one set at a time from within get_descriptor_set_vk(). */
+    Anvil::DescriptorSet::update_batch(in_descriptor_set_ptrs,
+                                       in_set_count);
+
     for (uint32_t n_set = 0;
                   n_set < in_set_count;
                 ++n_set)
@@ -1407,13 +1375,14 @@ bool Anvil::CommandBufferBase::record_bind_descriptor_sets(Anvil::PipelineBindPo
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(BindDescriptorSetsCommand(in_pipeline_bind_point,
-                                                           in_layout_ptr,
-                                                           in_first_set,
-                                                           in_set_count,
-                                                           in_descriptor_set_ptrs,
-                                                           in_dynamic_offset_count,
-                                                           in_dynamic_offset_ptrs) );
+            m_command_stash.stash<BindDescriptorSetsCommand>(&m_command_stash,
+                                                             in_pipeline_bind_point,
+                                                             in_layout_ptr,
+                                                             in_first_set,
+                                                             in_set_count,
+                                                             in_descriptor_set_ptrs,
+                                                             in_dynamic_offset_count,
+                                                             in_dynamic_offset_ptrs);
         }
     }
     #endif
@@ -1457,9 +1426,9 @@ bool Anvil::CommandBufferBase::record_bind_index_buffer(Anvil::Buffer*   in_buff
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(BindIndexBufferCommand(in_buffer_ptr,
-                                                        in_offset,
-                                                        in_index_type) );
+            m_command_stash.stash<BindIndexBufferCommand>(in_buffer_ptr,
+                                                          in_offset,
+                                                          in_index_type);
         }
     }
     #endif
@@ -1505,8 +1474,8 @@ bool Anvil::CommandBufferBase::record_bind_pipeline(Anvil::PipelineBindPoint in_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(BindPipelineCommand(in_pipeline_bind_point,
-                                                     in_pipeline_id) );
+            m_command_stash.stash<BindPipelineCommand>(in_pipeline_bind_point,
+                                                       in_pipeline_id);
         }
     }
     #endif
@@ -1549,24 +1518,12 @@ bool Anvil::CommandBufferBase::record_bind_transform_feedback_buffers_EXT(const
     {
         if (!m_command_stashing_disabled)
         {
-            std::vector<Anvil::Buffer*> buffer_vec(in_n_bindings);
-            std::vector<VkDeviceSize>   offset_vec(in_n_bindings);
-            std::vector<VkDeviceSize>   size_vec  (in_n_bindings);
-
-            for (uint32_t n_binding = 0;
-                          n_binding < in_n_bindings;
-                        ++n_binding)
-            {
-                buffer_vec.at(n_binding) = in_buffer_ptrs[n_binding];
-                offset_vec.at(n_binding) = in_offsets_ptr[n_binding];
-                size_vec.at  (n_binding) = in_sizes_ptr  [n_binding];
-            }
-
-            m_commands.push_back(BindTransformFeedbackBuffersEXTCommand(in_first_binding,
-                                                                        in_n_bindings,
-                                                                        buffer_vec,
-                                                                        offset_vec,
-                                                                        size_vec) );
+            m_command_stash.stash<BindTransformFeedbackBuffersEXTCommand>(&m_command_stash,
+                                                                          in_first_binding,
+                                                                          in_n_bindings,
+                                                                          in_buffer_ptrs,
+                                                                          in_offsets_ptr,
+                                                                          in_sizes_ptr);
         }
     }
     #endif
@@ -1617,10 +1574,11 @@ bool Anvil::CommandBufferBase::record_bind_vertex_buffers(uint32_t            in
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(BindVertexBuffersCommand(in_start_binding,
-                                                          in_binding_count,
-                                                          in_buffer_ptrs,
-                                                          in_offset_ptrs) );
+            m_command_stash.stash<BindVertexBuffersCommand>(&m_command_stash,
+                                                            in_start_binding,
+                                                            in_binding_count,
+                                                            in_buffer_ptrs,
+                                                            in_offset_ptrs);
         }
     }
     #endif
@@ -1678,13 +1636,14 @@ bool Anvil::CommandBufferBase::record_blit_image(Anvil::Image*           in_src_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(BlitImageCommand(in_src_image_ptr,
-                                                  in_src_image_layout,
-                                                  in_dst_image_ptr,
-                                                  in_dst_image_layout,
-                                                  in_region_count,
-                                                  in_region_ptrs,
-                                                  in_filter) );
+            m_command_stash.stash<BlitImageCommand>(&m_command_stash,
+                                                    in_src_image_ptr,
+                                                    in_src_image_layout,
+                                                    in_dst_image_ptr,
+                                                    in_dst_image_layout,
+                                                    in_region_count,
+                                                    in_region_ptrs,
+                                                    in_filter);
         }
     }
     #endif
@@ -1735,10 +1694,11 @@ bool Anvil::CommandBufferBase::record_clear_attachments(uint32_t
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(ClearAttachmentsCommand(in_n_attachments,
-                                                         in_attachment_ptrs,
-                                                         in_n_rects,
-                                                         in_rect_ptrs) );
+            m_command_stash.stash<ClearAttachmentsCommand>(&m_command_stash,
+                                                           in_n_attachments,
+                                                           in_attachment_ptrs,
+                                                           in_n_rects,
+                                                           in_rect_ptrs);
         }
     }
     #endif
@@ -1787,11 +1747,12 @@ bool Anvil::CommandBufferBase::record_clear_color_image(Anvil::Image*
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(ClearColorImageCommand(in_image_ptr,
-                                                        in_image_layout,
-                                                        in_color_ptr,
-                                                        in_range_count,
-                                                        in_range_ptrs) );
+            m_command_stash.stash<ClearColorImageCommand>(&m_command_stash,
+                                                          in_image_ptr,
+                                                          in_image_layout,
+                                                          in_color_ptr,
+                                                          in_range_count,
+                                                          in_range_ptrs);
         }
     }
     #endif
@@ -1841,11 +1802,12 @@ bool Anvil::CommandBufferBase::record_clear_depth_stencil_image(Anvil::Image*
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(ClearDepthStencilImageCommand(in_image_ptr,
-                                                               in_image_layout,
-                                                               in_depth_stencil_ptr,
-                                                               in_range_count,
-                                                               in_range_ptrs) );
+            m_command_stash.stash<ClearDepthStencilImageCommand>(&m_command_stash,
+                                                                 in_image_ptr,
+                                                                 in_image_layout,
+                                                                 in_depth_stencil_ptr,
+                                                                 in_range_count,
+                                                                 in_range_ptrs);
         }
     }
     #endif
@@ -1894,10 +1856,11 @@ bool Anvil::CommandBufferBase::record_copy_buffer(Anvil::Buffer*           in_sr
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(CopyBufferCommand(in_src_buffer_ptr,
-                                                   in_dst_buffer_ptr,
-                                                   in_region_count,
-                                                   in_region_ptrs) );
+            m_command_stash.stash<CopyBufferCommand>(&m_command_stash,
+                                                     in_src_buffer_ptr,
+                                                     in_dst_buffer_ptr,
+                                                     in_region_count,
+                                                     in_region_ptrs);
         }
     }
     #endif
@@ -1946,11 +1909,12 @@ bool Anvil::CommandBufferBase::record_copy_buffer_to_image(Anvil::Buffer*
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(CopyBufferToImageCommand(in_src_buffer_ptr,
-                                                          in_dst_image_ptr,
-                                                          in_dst_image_layout,
-                                                          in_region_count,
-                                                          in_region_ptrs) );
+            m_command_stash.stash<CopyBufferToImageCommand>(&m_command_stash,
+                                                            in_src_buffer_ptr,
+                                                            in_dst_image_ptr,
+                                                            in_dst_image_layout,
+                                                            in_region_count,
+                                                            in_region_ptrs);
         }
     }
     #endif
@@ -2001,12 +1965,13 @@ bool Anvil::CommandBufferBase::record_copy_image(Anvil::Image*           in_src_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(CopyImageCommand(in_src_image_ptr,
-                                                  in_src_image_layout,
-                                                  in_dst_image_ptr,
-                                                  in_dst_image_layout,
-                                                  in_region_count,
-                                                  in_region_ptrs) );
+            m_command_stash.stash<CopyImageCommand>(&m_command_stash,
+                                                    in_src_image_ptr,
+                                                    in_src_image_layout,
+                                                    in_dst_image_ptr,
+                                                    in_dst_image_layout,
+                                                    in_region_count,
+                                                    in_region_ptrs);
         }
     }
     #endif
@@ -2057,11 +2022,12 @@ bool Anvil::CommandBufferBase::record_copy_image_to_buffer(Anvil::Image*
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(CopyImageToBufferCommand(in_src_image_ptr,
-                                                          in_src_image_layout,
-                                                          in_dst_buffer_ptr,
-                                                          in_region_count,
-                                                          in_region_ptrs) );
+            m_command_stash.stash<CopyImageToBufferCommand>(&m_command_stash,
+                                                            in_src_image_ptr,
+                                                            in_src_image_layout,
+                                                            in_dst_buffer_ptr,
+                                                            in_region_count,
+                                                            in_region_ptrs);
         }
     }
     #endif
@@ -2113,13 +2079,13 @@ bool Anvil::CommandBufferBase::record_copy_query_pool_results(Anvil::QueryPool*
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(CopyQueryPoolResultsCommand(in_query_pool_ptr,
-                                                             in_start_query,
-                                                             in_query_count,
-                                                             in_dst_buffer_ptr,
-                                                             in_dst_offset,
-                                                             in_dst_stride,
-                                                             in_flags) );
+            m_command_stash.stash<CopyQueryPoolResultsCommand>(in_query_pool_ptr,
+                                                               in_start_query,
+                                                               in_query_count,
+                                                               in_dst_buffer_ptr,
+                                                               in_dst_offset,
+                                                               in_dst_stride,
+                                                               in_flags);
         }
     }
     #endif
@@ -2169,9 +2135,9 @@ bool Anvil::CommandBufferBase::record_dispatch(uint32_t in_x,
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DispatchCommand(in_x,
-                                                 in_y,
-                                                 in_z) );
+            m_command_stash.stash<DispatchCommand>(in_x,
+                                                   in_y,
+                                                   in_z);
         }
     }
     #endif
@@ -2211,8 +2177,9 @@ bool Anvil::CommandBufferBase::record_debug_marker_begin_EXT(const std::string&
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DebugMarkerBeginEXTCommand(in_marker_name,
-                                                            in_opt_color) );
+            m_command_stash.stash<DebugMarkerBeginEXTCommand>(&m_command_stash,
+                                                              in_marker_name.c_str(),
+                                                              in_opt_color);
         }
     }
     #endif
@@ -2269,7 +2236,7 @@ bool Anvil::CommandBufferBase::record_debug_marker_end_EXT()
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DebugMarkerEndEXTCommand() );
+            m_command_stash.stash<DebugMarkerEndEXTCommand>();
         }
     }
     #endif
@@ -2307,8 +2274,9 @@ bool Anvil::CommandBufferBase::record_debug_marker_insert_EXT(const std::string&
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DebugMarkerInsertEXTCommand(in_marker_name,
-                                                             in_opt_color) );
+            m_command_stash.stash<DebugMarkerInsertEXTCommand>(&m_command_stash,
+                                                               in_marker_name.c_str(),
+                                                               in_opt_color);
         }
     }
     #endif
@@ -2375,12 +2343,12 @@ bool Anvil::CommandBufferBase::record_dispatch_base_KHR(uint32_t in_base_group_x
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DispatchBaseKHRCommand(in_base_group_x,
-                                                        in_base_group_y,
-                                                        in_base_group_z,
-                                                        in_group_count_x,
-                                                        in_group_count_y,
-                                                        in_group_count_z) );
+            m_command_stash.stash<DispatchBaseKHRCommand>(in_base_group_x,
+                                                          in_base_group_y,
+                                                          in_base_group_z,
+                                                          in_group_count_x,
+                                                          in_group_count_y,
+                                                          in_group_count_z);
         }
     }
     #endif
@@ -2428,8 +2396,8 @@ bool Anvil::CommandBufferBase::record_dispatch_indirect(Anvil::Buffer* in_buffer
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DispatchIndirectCommand(in_buffer_ptr,
-                                                         in_offset) );
+            m_command_stash.stash<DispatchIndirectCommand>(in_buffer_ptr,
+                                                           in_offset);
         }
     }
     #endif
@@ -2475,10 +2443,10 @@ bool Anvil::CommandBufferBase::record_draw(uint32_t in_vertex_count,
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawCommand(in_vertex_count,
-                                             in_instance_count,
-                                             in_first_vertex,
-                                             in_first_instance) );
+            m_command_stash.stash<DrawCommand>(in_vertex_count,
+                                               in_instance_count,
+                                               in_first_vertex,
+                                               in_first_instance);
         }
     }
     #endif
@@ -2527,11 +2495,11 @@ bool Anvil::CommandBufferBase::record_draw_indexed(uint32_t in_index_count,
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawIndexedCommand(in_index_count,
-                                                    in_instance_count,
-                                                    in_first_index,
-                                                    in_vertex_offset,
-                                                    in_first_instance) );
+            m_command_stash.stash<DrawIndexedCommand>(in_index_count,
+                                                      in_instance_count,
+                                                      in_first_index,
+                                                      in_vertex_offset,
+                                                      in_first_instance);
         }
     }
     #endif
@@ -2580,10 +2548,10 @@ bool Anvil::CommandBufferBase::record_draw_indexed_indirect(Anvil::Buffer* in_bu
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawIndexedIndirectCommand(in_buffer_ptr,
-                                                            in_offset,
-                                                            in_count,
-                                                            in_stride) );
+            m_command_stash.stash<DrawIndexedIndirectCommand>(in_buffer_ptr,
+                                                              in_offset,
+                                                              in_count,
+                                                              in_stride);
         }
     }
     #endif
@@ -2634,12 +2602,12 @@ bool Anvil::CommandBufferBase::record_draw_indirect_byte_count_EXT(const uint32_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawIndirectByteCountEXTCommand(in_instance_count,
-                                                                 in_first_instance,
-                                                                 in_counter_buffer_ptr,
-                                                                 in_counter_buffer_offset,
-                                                                 in_counter_offset,
-                                                                 in_vertex_stride) );
+            m_command_stash.stash<DrawIndirectByteCountEXTCommand>(in_instance_count,
+                                                                   in_first_instance,
+                                                                   in_counter_buffer_ptr,
+                                                                   in_counter_buffer_offset,
+                                                                   in_counter_offset,
+                                                                   in_vertex_stride);
         }
     }
     #endif
@@ -2695,12 +2663,12 @@ bool Anvil::CommandBufferBase::record_draw_indexed_indirect_count_AMD(Anvil::Buf
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawIndexedIndirectCountAMDCommand(in_buffer_ptr,
-                                                                    in_offset,
-                                                                    in_count_buffer_ptr,
-                                                                    in_count_offset,
-                                                                    in_max_draw_count,
-                                                                    in_stride) );
+            m_command_stash.stash<DrawIndexedIndirectCountAMDCommand>(in_buffer_ptr,
+                                                                      in_offset,
+                                                                      in_count_buffer_ptr,
+                                                                      in_count_offset,
+                                                                      in_max_draw_count,
+                                                                      in_stride);
         }
     }
     #endif
@@ -2758,12 +2726,12 @@ bool Anvil::CommandBufferBase::record_draw_indexed_indirect_count_KHR(Anvil::Buf
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawIndexedIndirectCountKHRCommand(in_buffer_ptr,
-                                                                    in_offset,
-                                                                    in_count_buffer_ptr,
-                                                                    in_count_offset,
-                                                                    in_max_draw_count,
-                                                                    in_stride) );
+            m_command_stash.stash<DrawIndexedIndirectCountKHRCommand>(in_buffer_ptr,
+                                                                      in_offset,
+                                                                      in_count_buffer_ptr,
+                                                                      in_count_offset,
+                                                                      in_max_draw_count,
+                                                                      in_stride);
         }
     }
     #endif
@@ -2815,10 +2783,10 @@ bool Anvil::CommandBufferBase::record_draw_indirect(Anvil::Buffer* in_buffer_ptr
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawIndirectCommand(in_buffer_ptr,
-                                                     in_offset,
-                                                     in_count,
-                                                     in_stride) );
+            m_command_stash.stash<DrawIndirectCommand>(in_buffer_ptr,
+                                                       in_offset,
+                                                       in_count,
+                                                       in_stride);
         }
     }
     #endif
@@ -2872,12 +2840,12 @@ bool Anvil::CommandBufferBase::record_draw_indirect_count_AMD(Anvil::Buffer* in_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawIndirectCountAMDCommand(in_buffer_ptr,
-                                                             in_offset,
-                                                             in_count_buffer_ptr,
-                                                             in_count_offset,
-                                                             in_max_draw_count,
-                                                             in_stride) );
+            m_command_stash.stash<DrawIndirectCountAMDCommand>(in_buffer_ptr,
+                                                               in_offset,
+                                                               in_count_buffer_ptr,
+                                                               in_count_offset,
+                                                               in_max_draw_count,
+                                                               in_stride);
         }
     }
     #endif
@@ -2935,12 +2903,12 @@ bool Anvil::CommandBufferBase::record_draw_indirect_count_KHR(Anvil::Buffer* in_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(DrawIndirectCountKHRCommand(in_buffer_ptr,
-                                                             in_offset,
-                                                             in_count_buffer_ptr,
-                                                             in_count_offset,
-                                                             in_max_draw_count,
-                                                             in_stride) );
+            m_command_stash.stash<DrawIndirectCountKHRCommand>(in_buffer_ptr,
+                                                               in_offset,
+                                                               in_count_buffer_ptr,
+                                                               in_count_offset,
+                                                               in_max_draw_count,
+                                                               in_stride);
         }
     }
     #endif
@@ -2984,8 +2952,8 @@ bool Anvil::CommandBufferBase::record_end_query(Anvil::QueryPool* in_query_pool_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(EndQueryCommand(in_query_pool_ptr,
-                                                 in_entry) );
+            m_command_stash.stash<EndQueryCommand>(in_query_pool_ptr,
+                                                   in_entry);
         }
     }
     #endif
@@ -3025,9 +2993,9 @@ bool Anvil::CommandBufferBase::record_end_query_indexed_EXT(Anvil::QueryPool*
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(EndQueryIndexedEXTCommand(in_query_pool_ptr,
-                                                           in_query,
-                                                           in_index) );
+            m_command_stash.stash<EndQueryIndexedEXTCommand>(in_query_pool_ptr,
+                                                             in_query,
+                                                             in_index);
         }
     }
     #endif
@@ -3084,28 +3052,11 @@ bool Anvil::CommandBufferBase::record_end_transform_feedback_EXT(const uint32_t&
     {
         if (!m_command_stashing_disabled)
         {
-            std::vector<const Anvil::Buffer*> buffer_ptr_vec(in_n_counter_buffers);
-            std::vector<VkDeviceSize>         offset_vec    (in_n_counter_buffers);
-
-            for (uint32_t n_counter_buffer = 0;
-                          n_counter_buffer < in_n_counter_buffers;
-                        ++n_counter_buffer)
-            {
-                if (in_opt_counter_buffer_ptrs                   != nullptr &&
-                    in_opt_counter_buffer_ptrs[n_counter_buffer] != nullptr)
-                {
-                    buffer_ptr_vec.at(n_counter_buffer) = in_opt_counter_buffer_ptrs[n_counter_buffer];
-                }
-
-                if (in_opt_counter_buffer_offsets != nullptr)
-                {
-                    offset_vec.at(n_counter_buffer) = in_opt_counter_buffer_offsets[n_counter_buffer];
-                }
-            }
-
-            m_commands.push_back(EndTransformFeedbackEXTCommand(in_first_counter_buffer,
-                                                                buffer_ptr_vec,
-                                                                offset_vec) );
+            m_command_stash.stash<EndTransformFeedbackEXTCommand>(&m_command_stash,
+                                                                  in_first_counter_buffer,
+                                                                  in_n_counter_buffers,
+                                                                  in_opt_counter_buffer_ptrs,
+                                                                  in_opt_counter_buffer_offsets);
         }
     }
     #endif
@@ -3153,10 +3104,10 @@ bool Anvil::CommandBufferBase::record_fill_buffer(Anvil::Buffer* in_dst_buffer_p
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(FillBufferCommand(in_dst_buffer_ptr,
-                                                   in_dst_offset,
-                                                   in_size,
-                                                   in_data) );
+            m_command_stash.stash<FillBufferCommand>(in_dst_buffer_ptr,
+                                                     in_dst_offset,
+                                                     in_size,
+                                                     in_data);
         }
     }
     #endif
@@ -3195,6 +3146,8 @@ bool Anvil::CommandBufferBase::record_pipeline_barrier(Anvil::PipelineStageFlags
     auto memory_barriers_vk = std::vector<VkMemoryBarrier>      (in_memory_barrier_count);
     bool result             = false;
 
+    const PipelineBarrierCommand* command_data_ptr = nullptr;
+
     if (!m_recording_in_progress)
     {
         anvil_assert(m_recording_in_progress);
@@ -3209,35 +3162,46 @@ bool Anvil::CommandBufferBase::record_pipeline_barrier(Anvil::PipelineStageFlags
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(PipelineBarrierCommand(in_src_stage_mask,
-                                                        in_dst_stage_mask,
-                                                        in_dependency_flags,
-                                                        in_memory_barrier_count,
-                                                        in_memory_barriers_ptr,
-                                                        in_buffer_memory_barrier_count,
-                                                        in_buffer_memory_barriers_ptr,
-                                                        in_image_memory_barrier_count,
-                                                        in_image_memory_barriers_ptr) );
+            command_data_ptr = m_command_stash.stash<PipelineBarrierCommand>(&m_command_stash,
+                                                                             in_src_stage_mask,
+                                                                             in_dst_stage_mask,
+                                                                             in_dependency_flags,
+                                                                             in_memory_barrier_count,
+                                                                             in_memory_barriers_ptr,
+                                                                             in_buffer_memory_barrier_count,
+                                                                             in_buffer_memory_barriers_ptr,
+                                                                             in_image_memory_barrier_count,
+                                                                             in_image_memory_barriers_ptr);
         }
     }
     #endif
 
     if (get_n_of_callback_subscribers(COMMAND_BUFFER_CALLBACK_ID_PIPELINE_BARRIER_COMMAND_RECORDED) > 0)
     {
-        PipelineBarrierCommand                       command_data(in_src_stage_mask,
-                                                                  in_dst_stage_mask,
-                                                                  in_dependency_flags,
-                                                                  in_memory_barrier_count,
-                                                                  in_memory_barriers_ptr,
-                                                                  in_buffer_memory_barrier_count,
-                                                                  in_buffer_memory_barriers_ptr,
-                                                                  in_image_memory_barrier_count,
-                                                                  in_image_memory_barriers_ptr);
-        OnPipelineBarrierCommandRecordedCallbackData callback_data(this,
-                                                                  &command_data);
+        /* Reuse the stashed descriptor, if there is one. */
+        if (command_data_ptr == nullptr)
+        {
+            command_data_ptr = m_callback_command_stash.stash<PipelineBarrierCommand>(&m_callback_command_stash,
+                                                                                      in_src_stage_mask,
+                                                                                      in_dst_stage_mask,
+                                                                                      in_dependency_flags,
+                                                                                      in_memory_barrier_count,
+                                                                                      in_memory_barriers_ptr,
+                                                                                      in_buffer_memory_barrier_count,
+                                                                                      in_buffer_memory_barriers_ptr,
+                                                                                      in_image_memory_barrier_count,
+                                                                                      in_image_memory_barriers_ptr);
+        }
+
+        {
+            OnPipelineBarrierCommandRecordedCallbackData callback_data(this,
+                                                                       command_data_ptr);
+
+            callback(COMMAND_BUFFER_CALLBACK_ID_PIPELINE_BARRIER_COMMAND_RECORDED,
+                    &callback_data);
+        }
 
-        callback(COMMAND_BUFFER_CALLBACK_ID_PIPELINE_BARRIER_COMMAND_RECORDED,
-                &callback_data);
+        m_callback_command_stash.reset();
     }
 
     for (uint32_t n_buffer_barrier = 0;
@@ -3304,11 +3268,12 @@ bool Anvil::CommandBufferBase::record_push_constants(Anvil::PipelineLayout*  in_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(PushConstantsCommand(in_layout_ptr,
-                                                      in_stage_flags,
-                                                      in_offset,
-                                                      in_size,
-                                                      in_values) );
+            m_command_stash.stash<PushConstantsCommand>(&m_command_stash,
+                                                        in_layout_ptr,
+                                                        in_stage_flags,
+                                                        in_offset,
+                                                        in_size,
+                                                        in_values);
         }
     }
     #endif
@@ -3355,8 +3320,8 @@ bool Anvil::CommandBufferBase::record_reset_event(Anvil::Event*             in_e
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(ResetEventCommand(in_event_ptr,
-                                                   in_stage_mask) );
+            m_command_stash.stash<ResetEventCommand>(in_event_ptr,
+                                                     in_stage_mask);
         }
     }
     #endif
@@ -3401,9 +3366,9 @@ bool Anvil::CommandBufferBase::record_reset_query_pool(Anvil::QueryPool* in_quer
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(ResetQueryPoolCommand(in_query_pool_ptr,
-                                                       in_start_query,
-                                                       in_query_count) );
+            m_command_stash.stash<ResetQueryPoolCommand>(in_query_pool_ptr,
+                                                         in_start_query,
+                                                         in_query_count);
         }
     }
     #endif
@@ -3452,12 +3417,13 @@ bool Anvil::CommandBufferBase::record_resolve_image(Anvil::Image*              i
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(ResolveImageCommand(in_src_image_ptr,
-                                                     in_src_image_layout,
-                                                     in_dst_image_ptr,
-                                                     in_dst_image_layout,
-                                                     in_region_count,
-                                                     in_region_ptrs) );
+            m_command_stash.stash<ResolveImageCommand>(&m_command_stash,
+                                                       in_src_image_ptr,
+                                                       in_src_image_layout,
+                                                       in_dst_image_ptr,
+                                                       in_dst_image_layout,
+                                                       in_region_count,
+                                                       in_region_ptrs);
         }
     }
     #endif
@@ -3498,7 +3464,7 @@ bool Anvil::CommandBufferBase::record_set_blend_constants(const float in_blend_c
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetBlendConstantsCommand(in_blend_constants));
+            m_command_stash.stash<SetBlendConstantsCommand>(in_blend_constants);
         }
     }
     #endif
@@ -3536,9 +3502,9 @@ bool Anvil::CommandBufferBase::record_set_depth_bias(float in_depth_bias_constan
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetDepthBiasCommand(in_depth_bias_constant_factor,
-                                                     in_depth_bias_clamp,
-                                                     in_slope_scaled_depth_bias) );
+            m_command_stash.stash<SetDepthBiasCommand>(in_depth_bias_constant_factor,
+                                                       in_depth_bias_clamp,
+                                                       in_slope_scaled_depth_bias);
         }
     }
     #endif
@@ -3577,8 +3543,8 @@ bool Anvil::CommandBufferBase::record_set_depth_bounds(float in_min_depth_bounds
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetDepthBoundsCommand(in_min_depth_bounds,
-                                                       in_max_depth_bounds) );
+            m_command_stash.stash<SetDepthBoundsCommand>(in_min_depth_bounds,
+                                                         in_max_depth_bounds);
         }
     }
     #endif
@@ -3619,7 +3585,7 @@ bool Anvil::CommandBufferBase::record_set_device_mask_KHR(uint32_t in_device_mas
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetDeviceMaskKHRCommand(in_device_mask) );
+            m_command_stash.stash<SetDeviceMaskKHRCommand>(in_device_mask);
         }
     }
     #endif
@@ -3686,8 +3652,8 @@ bool Anvil::CommandBufferBase::record_set_event(Anvil::Event*             in_eve
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetEventCommand(in_event_ptr,
-                                                 in_stage_mask) );
+            m_command_stash.stash<SetEventCommand>(in_event_ptr,
+                                                   in_stage_mask);
         }
     }
     #endif
@@ -3724,7 +3690,7 @@ bool Anvil::CommandBufferBase::record_set_line_width(float in_line_width)
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetLineWidthCommand(in_line_width) );
+            m_command_stash.stash<SetLineWidthCommand>(in_line_width);
         }
     }
     #endif
@@ -3762,7 +3728,7 @@ bool Anvil::CommandBufferBase::record_set_sample_locations_EXT(const Anvil::Samp
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetSampleLocationsEXTCommand(in_sample_locations_info) );
+            m_command_stash.stash<SetSampleLocationsEXTCommand>(in_sample_locations_info);
         }
     }
     #endif
@@ -3802,9 +3768,10 @@ bool Anvil::CommandBufferBase::record_set_scissor(uint32_t        in_first_sciss
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetScissorCommand(in_first_scissor,
-                                                   in_scissor_count,
-                                                   in_scissor_ptrs) );
+            m_command_stash.stash<SetScissorCommand>(&m_command_stash,
+                                                     in_first_scissor,
+                                                     in_scissor_count,
+                                                     in_scissor_ptrs);
         }
     }
     #endif
@@ -3843,8 +3810,8 @@ bool Anvil::CommandBufferBase::record_set_stencil_compare_mask(Anvil::StencilFac
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetStencilCompareMaskCommand(in_face_mask,
-                                                              in_stencil_compare_mask) );
+            m_command_stash.stash<SetStencilCompareMaskCommand>(in_face_mask,
+                                                                in_stencil_compare_mask);
         }
     }
     #endif
@@ -3882,8 +3849,8 @@ bool Anvil::CommandBufferBase::record_set_stencil_reference(Anvil::StencilFaceFl
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetStencilReferenceCommand(in_face_mask,
-                                                            in_stencil_reference) );
+            m_command_stash.stash<SetStencilReferenceCommand>(in_face_mask,
+                                                              in_stencil_reference);
         }
     }
     #endif
@@ -3921,8 +3888,8 @@ bool Anvil::CommandBufferBase::record_set_stencil_write_mask(Anvil::StencilFaceF
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetStencilWriteMaskCommand(in_face_mask,
-                                                            in_stencil_write_mask) );
+            m_command_stash.stash<SetStencilWriteMaskCommand>(in_face_mask,
+                                                              in_stencil_write_mask);
         }
     }
     #endif
@@ -3961,9 +3928,10 @@ bool Anvil::CommandBufferBase::record_set_viewport(uint32_t          in_first_vi
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(SetViewportCommand(in_first_viewport,
-                                                    in_viewport_count,
-                                                    in_viewport_ptrs) );
+            m_command_stash.stash<SetViewportCommand>(&m_command_stash,
+                                                      in_first_viewport,
+                                                      in_viewport_count,
+                                                      in_viewport_ptrs);
         }
     }
     #endif
@@ -4010,10 +3978,11 @@ bool Anvil::CommandBufferBase::record_update_buffer(Anvil::Buffer* in_dst_buffer
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(UpdateBufferCommand(in_dst_buffer_ptr,
-                                                     in_dst_offset,
-                                                     in_data_size,
-                                                     in_data_ptr) );
+            m_command_stash.stash<UpdateBufferCommand>(&m_command_stash,
+                                                       in_dst_buffer_ptr,
+                                                       in_dst_offset,
+                                                       in_data_size,
+                                                       in_data_ptr);
         }
     }
     #endif
@@ -4069,16 +4038,17 @@ bool Anvil::CommandBufferBase::record_wait_events(uint32_t                   in_
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(WaitEventsCommand(in_event_count,
-                                                   in_events,
-                                                   in_src_stage_mask,
-                                                   in_dst_stage_mask,
-                                                   in_memory_barrier_count,
-                                                   in_memory_barriers_ptr,
-                                                   in_buffer_memory_barrier_count,
-                                                   in_buffer_memory_barriers_ptr,
-                                                   in_image_memory_barrier_count,
-                                                   in_image_memory_barriers_ptr) );
+            m_command_stash.stash<WaitEventsCommand>(&m_command_stash,
+                                                     in_event_count,
+                                                     in_events,
+                                                     in_src_stage_mask,
+                                                     in_dst_stage_mask,
+                                                     in_memory_barrier_count,
+                                                     in_memory_barriers_ptr,
+                                                     in_buffer_memory_barrier_count,
+                                                     in_buffer_memory_barriers_ptr,
+                                                     in_image_memory_barrier_count,
+                                                     in_image_memory_barriers_ptr);
         }
     }
     #endif
@@ -4156,10 +4126,10 @@ bool Anvil::CommandBufferBase::record_write_buffer_marker_AMD(const Anvil::Pipel
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(WriteBufferMarkerAMDCommand(in_pipeline_stage,
-                                                             in_dst_buffer_ptr,
-                                                             in_dst_offset,
-                                                             in_marker) );
+            m_command_stash.stash<WriteBufferMarkerAMDCommand>(in_pipeline_stage,
+                                                               in_dst_buffer_ptr,
+                                                               in_dst_offset,
+                                                               in_marker);
         }
     }
     #endif
@@ -4200,9 +4170,9 @@ bool Anvil::CommandBufferBase::record_write_timestamp(Anvil::PipelineStageFlagBi
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(WriteTimestampCommand(in_pipeline_stage,
-                                                       in_query_pool_ptr,
-                                                       in_query_index) );
+            m_command_stash.stash<WriteTimestampCommand>(in_pipeline_stage,
+                                                         in_query_pool_ptr,
+                                                         in_query_index);
         }
     }
     #endif
@@ -4480,33 +4450,35 @@ bool Anvil::PrimaryCommandBuffer::record_begin_render_pass_internal(const bool&
         {
             if (in_use_khr_create_rp2_extension)
             {
-                m_commands.push_back(BeginRenderPass2KHRCommand(in_n_clear_values,
-                                                                in_clear_value_ptrs,
-                                                                in_fbo_ptr,
-                                                                in_device_mask,
-                                                                in_n_render_areas,
-                                                                in_render_areas_ptr,
-                                                                in_render_pass_ptr,
-                                                                in_contents,
-                                                                in_opt_n_attachment_initial_sample_locations,
-                                                                in_opt_attachment_initial_sample_locations_ptr,
-                                                                in_opt_n_post_subpass_sample_locations,
-                                                                in_opt_post_subpass_sample_locations_ptr) );
+                m_command_stash.stash<BeginRenderPass2KHRCommand>(&m_command_stash,
+                                                                  in_n_clear_values,
+                                                                  in_clear_value_ptrs,
+                                                                  in_fbo_ptr,
+                                                                  in_device_mask,
+                                                                  in_n_render_areas,
+                                                                  in_render_areas_ptr,
+                                                                  in_render_pass_ptr,
+                                                                  in_contents,
+                                                                  in_opt_n_attachment_initial_sample_locations,
+                                                                  in_opt_attachment_initial_sample_locations_ptr,
+                                                                  in_opt_n_post_subpass_sample_locations,
+                                                                  in_opt_post_subpass_sample_locations_ptr);
             }
             else
             {
-                m_commands.push_back(BeginRenderPassCommand(in_n_clear_values,
-                                                            in_clear_value_ptrs,
-                                                            in_fbo_ptr,
-                                                            in_device_mask,
-                                                            in_n_render_areas,
-                                                            in_render_areas_ptr,
-                                                            in_render_pass_ptr,
-                                                            in_contents,
-                                                            in_opt_n_attachment_initial_sample_locations,
-                                                            in_opt_attachment_initial_sample_locations_ptr,
-                                                            in_opt_n_post_subpass_sample_locations,
-                                                            in_opt_post_subpass_sample_locations_ptr) );
+                m_command_stash.stash<BeginRenderPassCommand>(&m_command_stash,
+                                                              in_n_clear_values,
+                                                              in_clear_value_ptrs,
+                                                              in_fbo_ptr,
+                                                              in_device_mask,
+                                                              in_n_render_areas,
+                                                              in_render_areas_ptr,
+                                                              in_render_pass_ptr,
+                                                              in_contents,
+                                                              in_opt_n_attachment_initial_sample_locations,
+                                                              in_opt_attachment_initial_sample_locations_ptr,
+                                                              in_opt_n_post_subpass_sample_locations,
+                                                              in_opt_post_subpass_sample_locations_ptr);
             }
         }
     }
@@ -4651,11 +4623,11 @@ bool Anvil::PrimaryCommandBuffer::record_end_render_pass_internal(const bool& in
         {
             if (in_use_khr_create_rp2_extension)
             {
-                m_commands.push_back(EndRenderPass2KHRCommand() );
+                m_command_stash.stash<EndRenderPass2KHRCommand>();
             }
             else
             {
-                m_commands.push_back(EndRenderPassCommand() );
+                m_command_stash.stash<EndRenderPassCommand>();
             }
         }
     }
@@ -4708,8 +4680,9 @@ bool Anvil::PrimaryCommandBuffer::record_execute_commands(uint32_t
     {
         if (!m_command_stashing_disabled)
         {
-            m_commands.push_back(ExecuteCommandsCommand(in_cmd_buffers_count,
-                                                        in_cmd_buffer_ptrs) );
+            m_command_stash.stash<ExecuteCommandsCommand>(&m_command_stash,
+                                                          in_cmd_buffers_count,
+                                                          in_cmd_buffer_ptrs);
         }
     }
     #endif
@@ -4778,11 +4751,11 @@ bool Anvil::PrimaryCommandBuffer::record_next_subpass_internal(const bool&
         {
             if (in_use_khr_create_rp2_extension)
             {
-                m_commands.push_back(NextSubpass2KHRCommand(in_contents) );
+                m_command_stash.stash<NextSubpass2KHRCommand>(in_contents);
             }
             else
             {
-                m_commands.push_back(NextSubpassCommand(in_contents) );
+                m_command_stash.stash<NextSubpassCommand>(in_contents);
             }
         }
     }
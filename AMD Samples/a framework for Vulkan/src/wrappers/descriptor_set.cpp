@@ -23,6 +23,7 @@
 #include "misc/buffer_create_info.h"
 #include "misc/debug.h"
 #include "misc/descriptor_set_create_info.h"
+#include "misc/descriptor_set_dirty_state.h"
 #include "misc/object_tracker.h"
 #include "wrappers/buffer.h"
 #include "wrappers/buffer_view.h"
@@ -33,6 +34,7 @@
 #include "wrappers/device.h"
 #include "wrappers/image_view.h"
 #include "wrappers/sampler.h"
+#include <algorithm>
 
 #ifdef max
     #undef max
@@ -723,424 +725,647 @@ bool Anvil::DescriptorSet::update(const DescriptorSetUpdateMethod& in_update_met
 }
 
 /* Please see header for specification */
-bool Anvil::DescriptorSet::update_using_core_method() const
+bool Anvil::DescriptorSet::update_batch(const Anvil::DescriptorSet* const* in_ds_ptrs,
+                                        uint32_t                           in_n_descriptor_sets,
+                                        const DescriptorSetUpdateMethod&   in_update_method)
 {
-    std::vector<uint32_t> iub_binding_indices;
-    const auto            layout_info_ptr     = m_layout_ptr->get_create_info();
-    bool                  result              = false;
+    std::vector<const Anvil::DescriptorSet*> ds_ptrs;
+    std::vector<std::vector<uint32_t> >      iub_binding_indices_per_ds;
+    std::vector<const Anvil::DescriptorSet*> prepared_ds_ptrs;
+    const Anvil::BaseDevice*                 device_ptr       = nullptr;
+    bool                                     result           = true;
+    std::vector<VkWriteDescriptorSet>        write_items_vk;
 
-    anvil_assert(!m_unusable);
+    for (uint32_t n_ds = 0;
+                  n_ds < in_n_descriptor_sets;
+                ++n_ds)
+    {
+        if (in_ds_ptrs[n_ds] != nullptr)
+        {
+            ds_ptrs.push_back(in_ds_ptrs[n_ds]);
+        }
+    }
 
-    if (m_dirty)
+    if (ds_ptrs.size() == 0)
     {
-        uint32_t       cached_ds_buffer_info_items_array_offset       = 0;
-        uint32_t       cached_ds_image_info_items_array_offset        = 0;
-        uint32_t       cached_ds_iub_array_offset                     = 0;
-        uint32_t       cached_ds_texel_buffer_info_items_array_offset = 0;
-        const uint32_t n_bindings                                     = static_cast<uint32_t>(m_binding_ptrs.size() );
+        goto end;
+    }
 
-        m_cached_ds_info_buffer_info_items_vk.clear      ();
-        m_cached_ds_info_image_info_items_vk.clear       ();
-        m_cached_ds_info_texel_buffer_info_items_vk.clear();
-        m_cached_ds_write_items_vk.clear                 ();
+    /* Lock the sets in a deterministic order, so that concurrent batches sharing some of the sets cannot deadlock. */
+    std::sort(ds_ptrs.begin(),
+              ds_ptrs.end() );
 
+    ds_ptrs.erase(std::unique(ds_ptrs.begin(),
+                              ds_ptrs.end() ),
+                  ds_ptrs.end() );
+
+    if (in_update_method != Anvil::DescriptorSetUpdateMethod::CORE ||
+        ds_ptrs.size() == 1)
+    {
+        for (const auto& current_ds_ptr : ds_ptrs)
         {
-            uint32_t n_max_ds_info_items_to_cache  = 0;
+            bool is_dirty;
 
-            for (auto& binding_map_item : m_binding_ptrs)
+            /* m_dirty may be modified by other threads updating the set, so it must only be read with the lock held */
+            current_ds_ptr->lock();
             {
-                const uint32_t n_current_binding_items = static_cast<uint32_t>(binding_map_item.second.size() );
+                is_dirty = current_ds_ptr->m_dirty;
+            }
+            current_ds_ptr->unlock();
 
-                n_max_ds_info_items_to_cache += n_current_binding_items;
+            if (is_dirty)
+            {
+                result &= current_ds_ptr->update(in_update_method);
             }
+        }
+
+        goto end;
+    }
+
+    for (const auto& current_ds_ptr : ds_ptrs)
+    {
+        current_ds_ptr->lock();
+    }
+
+    iub_binding_indices_per_ds.reserve(ds_ptrs.size() );
+    prepared_ds_ptrs.reserve          (ds_ptrs.size() );
+
+    for (const auto& current_ds_ptr : ds_ptrs)
+    {
+        if (!current_ds_ptr->m_dirty)
+        {
+            continue;
+        }
+
+        anvil_assert(!current_ds_ptr->m_unusable);
+
+        if (device_ptr == nullptr)
+        {
+            device_ptr = current_ds_ptr->m_device_ptr;
+        }
+
+        if (current_ds_ptr->m_device_ptr != device_ptr)
+        {
+            result &= current_ds_ptr->update_using_core_method();
+
+            continue;
+        }
 
-            m_cached_ds_info_buffer_info_items_vk.reserve      (n_max_ds_info_items_to_cache);
-            m_cached_ds_info_image_info_items_vk.reserve       (n_max_ds_info_items_to_cache);
-            m_cached_ds_info_texel_buffer_info_items_vk.reserve(n_max_ds_info_items_to_cache);
+        if (current_ds_ptr->update_using_cached_template() )
+        {
+            continue;
         }
 
-        for (uint32_t n_binding = 0;
-                      n_binding < n_bindings;
-                    ++n_binding)
+        iub_binding_indices_per_ds.push_back(std::vector<uint32_t>() );
+
+        if (!current_ds_ptr->prepare_core_update(&iub_binding_indices_per_ds.back() ))
         {
-            Anvil::DescriptorBindingFlags current_binding_flags;
-            uint32_t                      current_binding_index;
-            uint32_t                      descriptor_array_size                         = 0;
-            Anvil::DescriptorType         descriptor_type;
-            bool                          immutable_samplers_enabled                    = false;
-            uint32_t                      start_ds_buffer_info_items_array_offset       = cached_ds_buffer_info_items_array_offset;
-            uint32_t                      start_ds_image_info_items_array_offset        = cached_ds_image_info_items_array_offset;
-            uint32_t                      start_ds_iub_array_offset                     = cached_ds_iub_array_offset;
-            uint32_t                      start_ds_texel_buffer_info_items_array_offset = cached_ds_texel_buffer_info_items_array_offset;
-            VkWriteDescriptorSet          write_ds_vk;
-
-            if (!layout_info_ptr->get_binding_properties_by_index_number(n_binding,
-                                                                        &current_binding_index,
-                                                                        &descriptor_type,
-                                                                        &descriptor_array_size,
-                                                                         nullptr, /* out_opt_stage_flags_ptr */
-                                                                        &immutable_samplers_enabled,
-                                                                        &current_binding_flags) )
+            iub_binding_indices_per_ds.pop_back();
+
+            result = false;
+            continue;
+        }
+
+        write_items_vk.insert(write_items_vk.end(),
+                              current_ds_ptr->m_cached_ds_write_items_vk.begin(),
+                              current_ds_ptr->m_cached_ds_write_items_vk.end  () );
+
+        prepared_ds_ptrs.push_back(current_ds_ptr);
+    }
+
+    /* Issue the Vulkan call */
+    if (write_items_vk.size() > 0)
+    {
+        Anvil::Vulkan::vkUpdateDescriptorSets(device_ptr->get_device_vk(),
+                                              static_cast<uint32_t>(write_items_vk.size() ),
+                                             &write_items_vk.at(0),
+                                              0,        /* copyCount         */
+                                              nullptr); /* pDescriptorCopies */
+    }
+
+    for (uint32_t n_prepared_ds = 0;
+                  n_prepared_ds < static_cast<uint32_t>(prepared_ds_ptrs.size() );
+                ++n_prepared_ds)
+    {
+        prepared_ds_ptrs.at(n_prepared_ds)->on_core_update_issued(iub_binding_indices_per_ds.at(n_prepared_ds) );
+    }
+
+    for (auto ds_iterator  = ds_ptrs.rbegin();
+              ds_iterator != ds_ptrs.rend();
+            ++ds_iterator)
+    {
+        (*ds_iterator)->unlock();
+    }
+
+end:
+    return result;
+}
+
+/** Marks the set and all its binding items as clean, after writes prepared by prepare_core_update() have been issued.
+ *
+ *  @param in_iub_binding_indices Indices of IUB bindings, as reported by prepare_core_update().
+ **/
+void Anvil::DescriptorSet::on_core_update_issued(const std::vector<uint32_t>& in_iub_binding_indices) const
+{
+    /* prepare_core_update() writes every dirty item, so all of them are now in sync with the Vulkan set. */
+    Anvil::DescriptorSetDirtyState::on_core_update_issued(m_binding_ptrs,
+                                                          in_iub_binding_indices);
+
+    m_dirty = false;
+}
+
+/** Marks all binding items as clean, after a template update prepared by prepare_template_update() has been issued. */
+void Anvil::DescriptorSet::on_template_update_issued() const
+{
+    Anvil::DescriptorSetDirtyState::on_template_update_issued(m_binding_ptrs);
+
+    m_dirty = false;
+}
+
+/** Fills m_cached_ds_* vectors with write items for all binding array items which need to be written.
+ *
+ *  Does not modify the dirty state of the set, or of its binding items.
+ *
+ *  @param out_iub_binding_indices_ptr Deref will be filled with indices of IUB bindings which have been processed. These need
+ *                                     to be passed to on_core_update_issued(), after the write items are consumed.
+ *
+ *  @return true if successful, false otherwise.
+ **/
+bool Anvil::DescriptorSet::prepare_core_update(std::vector<uint32_t>* out_iub_binding_indices_ptr) const
+{
+    const auto layout_info_ptr = m_layout_ptr->get_create_info();
+    bool       result          = false;
+
+    uint32_t       cached_ds_buffer_info_items_array_offset       = 0;
+    uint32_t       cached_ds_image_info_items_array_offset        = 0;
+    uint32_t       cached_ds_iub_array_offset                     = 0;
+    uint32_t       cached_ds_texel_buffer_info_items_array_offset = 0;
+    const uint32_t n_bindings                                     = static_cast<uint32_t>(m_binding_ptrs.size() );
+
+    m_cached_ds_info_buffer_info_items_vk.clear      ();
+    m_cached_ds_info_image_info_items_vk.clear       ();
+    m_cached_ds_info_texel_buffer_info_items_vk.clear();
+    m_cached_ds_write_items_vk.clear                 ();
+
+    {
+        uint32_t n_max_ds_info_items_to_cache  = 0;
+
+        for (auto& binding_map_item : m_binding_ptrs)
+        {
+            const uint32_t n_current_binding_items = static_cast<uint32_t>(binding_map_item.second.size() );
+
+            n_max_ds_info_items_to_cache += n_current_binding_items;
+        }
+
+        m_cached_ds_info_buffer_info_items_vk.reserve      (n_max_ds_info_items_to_cache);
+        m_cached_ds_info_image_info_items_vk.reserve       (n_max_ds_info_items_to_cache);
+        m_cached_ds_info_texel_buffer_info_items_vk.reserve(n_max_ds_info_items_to_cache);
+    }
+
+    for (uint32_t n_binding = 0;
+                  n_binding < n_bindings;
+                ++n_binding)
+    {
+        Anvil::DescriptorBindingFlags current_binding_flags;
+        uint32_t                      current_binding_index;
+        uint32_t                      descriptor_array_size                         = 0;
+        Anvil::DescriptorType         descriptor_type;
+        bool                          immutable_samplers_enabled                    = false;
+        uint32_t                      start_ds_buffer_info_items_array_offset       = cached_ds_buffer_info_items_array_offset;
+        uint32_t                      start_ds_image_info_items_array_offset        = cached_ds_image_info_items_array_offset;
+        uint32_t                      start_ds_iub_array_offset                     = cached_ds_iub_array_offset;
+        uint32_t                      start_ds_texel_buffer_info_items_array_offset = cached_ds_texel_buffer_info_items_array_offset;
+        VkWriteDescriptorSet          write_ds_vk;
+
+        if (!layout_info_ptr->get_binding_properties_by_index_number(n_binding,
+                                                                    &current_binding_index,
+                                                                    &descriptor_type,
+                                                                    &descriptor_array_size,
+                                                                     nullptr, /* out_opt_stage_flags_ptr */
+                                                                    &immutable_samplers_enabled,
+                                                                    &current_binding_flags) )
+        {
+            anvil_assert_fail();
+        }
+
+        /* For each array item, initialize a descriptor info item.. */
+        BindingItemUniquePtrs& current_binding_item_ptrs = m_binding_ptrs.at(current_binding_index);
+        uint32_t               n_current_binding_items   = static_cast<uint32_t>(current_binding_item_ptrs.size() );
+        int32_t                n_last_binding_item       = -1;
+
+        /* Skip bindings whose array items have all been written already and have not changed since. */
+        if (descriptor_type != Anvil::DescriptorType::INLINE_UNIFORM_BLOCK &&
+            Anvil::DescriptorSetDirtyState::is_binding_clean(current_binding_item_ptrs) )
+        {
+            continue;
+        }
+
+        for (uint32_t n_current_binding_item = 0;
+                      n_current_binding_item < n_current_binding_items;
+                    ++n_current_binding_item)
+        {
+            auto& current_binding_item_ptr = current_binding_item_ptrs.at(n_current_binding_item);
+            bool  needs_write_item         = ((n_current_binding_item + 1) == n_current_binding_items);
+
+            if (descriptor_type == Anvil::DescriptorType::INLINE_UNIFORM_BLOCK)
             {
-                anvil_assert_fail();
+                /* Binding items for this descriptor type correspond internally to consecutive update requests which have been scheduled for
+                 * the same IUB binding. As per API restrictions, only one such update can be carried out using a single VkWriteDescriptorSet struct.
+                 */
+                n_last_binding_item = static_cast<uint32_t>(current_binding_item_ptr->start_offset) - 1; //< write_ds_vk.dstArrayElement corresponds to start offset for inline uniform blocks
+
+                if (n_current_binding_item == 0)
+                {
+                    out_iub_binding_indices_ptr->push_back(n_binding);
+                }
             }
 
-            /* For each array item, initialize a descriptor info item.. */
-            BindingItemUniquePtrs& current_binding_item_ptrs = m_binding_ptrs.at(current_binding_index);
-            uint32_t               n_current_binding_items   = static_cast<uint32_t>(current_binding_item_ptrs.size() );
-            int32_t                n_last_binding_item       = -1;
+            /* TODO: For arrayed binding items, avoid updating all binding items every time baking is triggered. */
+            if ( current_binding_item_ptr        != nullptr &&
+                !current_binding_item_ptr->dirty            &&
+                 n_current_binding_item          == 0       &&
+                 n_current_binding_items         == 1)
+            {
+                continue;
+            }
 
-            for (uint32_t n_current_binding_item = 0;
-                          n_current_binding_item < n_current_binding_items;
-                        ++n_current_binding_item)
+            if (current_binding_item_ptr             != nullptr &&
+                current_binding_item_ptr->buffer_ptr != nullptr)
             {
-                auto& current_binding_item_ptr = current_binding_item_ptrs.at(n_current_binding_item);
-                bool  needs_write_item         = ((n_current_binding_item + 1) == n_current_binding_items);
+                VkDescriptorBufferInfo buffer_info;
 
-                if (descriptor_type == Anvil::DescriptorType::INLINE_UNIFORM_BLOCK)
-                {
-                    /* Binding items for this descriptor type correspond internally to consecutive update requests which have been scheduled for
-                     * the same IUB binding. As per API restrictions, only one such update can be carried out using a single VkWriteDescriptorSet struct.
-                     */
-                    n_last_binding_item = static_cast<uint32_t>(current_binding_item_ptr->start_offset) - 1; //< write_ds_vk.dstArrayElement corresponds to start offset for inline uniform blocks
+                fill_buffer_info_vk_descriptor(*current_binding_item_ptr,
+                                              &buffer_info);
 
-                    if (n_current_binding_item == 0)
-                    {
-                        iub_binding_indices.push_back(n_binding);
-                    }
-                }
+                m_cached_ds_info_buffer_info_items_vk.push_back(buffer_info);
 
-                /* TODO: For arrayed binding items, avoid updating all binding items every time baking is triggered. */
-                if ( current_binding_item_ptr        != nullptr &&
-                    !current_binding_item_ptr->dirty            &&
-                     n_current_binding_item          == 0       &&
-                     n_current_binding_items         == 1)
-                {
-                    continue;
-                }
+                ++cached_ds_buffer_info_items_array_offset;
+            }
+            else
+            if (current_binding_item_ptr                  != nullptr &&
+                current_binding_item_ptr->buffer_view_ptr != nullptr)
+            {
+                m_cached_ds_info_texel_buffer_info_items_vk.push_back(current_binding_item_ptr->buffer_view_ptr->get_buffer_view() );
 
-                if (current_binding_item_ptr             != nullptr &&
-                    current_binding_item_ptr->buffer_ptr != nullptr)
-                {
-                    VkDescriptorBufferInfo buffer_info;
+                ++cached_ds_texel_buffer_info_items_array_offset;
+            }
+            else
+            if ( current_binding_item_ptr                 != nullptr  &&
+                (current_binding_item_ptr->image_view_ptr != nullptr  ||
+                 current_binding_item_ptr->sampler_ptr    != nullptr) )
+            {
+                VkDescriptorImageInfo image_info;
 
-                    fill_buffer_info_vk_descriptor(*current_binding_item_ptr,
-                                                  &buffer_info);
+                fill_image_info_vk_descriptor(*current_binding_item_ptr,
+                                              immutable_samplers_enabled,
+                                             &image_info);
 
-                    m_cached_ds_info_buffer_info_items_vk.push_back(buffer_info);
+                m_cached_ds_info_image_info_items_vk.push_back(image_info);
 
-                    ++cached_ds_buffer_info_items_array_offset;
-                }
-                else
-                if (current_binding_item_ptr                  != nullptr &&
-                    current_binding_item_ptr->buffer_view_ptr != nullptr)
+                ++cached_ds_image_info_items_array_offset;
+            }
+            else
+            if (descriptor_type == Anvil::DescriptorType::INLINE_UNIFORM_BLOCK)
+            {
+                VkWriteDescriptorSetInlineUniformBlockEXT iub_info;
+
+                fill_iub_vk_descriptor(*current_binding_item_ptr,
+                                      &iub_info);
+
+                m_cached_ds_write_iub_items_vk.at(start_ds_iub_array_offset) = iub_info;
+
+                needs_write_item           =  true;
+                cached_ds_iub_array_offset ++;
+            }
+            else
+            {
+                /* Arrayed bindings are only permitted if the binding has been created with the PARTIALLY_BOUND flag */
+                if ((current_binding_flags & Anvil::DescriptorBindingFlagBits::PARTIALLY_BOUND_BIT) == 0)
                 {
-                    m_cached_ds_info_texel_buffer_info_items_vk.push_back(current_binding_item_ptr->buffer_view_ptr->get_buffer_view() );
+                    anvil_assert_fail();
 
-                    ++cached_ds_texel_buffer_info_items_array_offset;
+                    goto end;
                 }
-                else
-                if ( current_binding_item_ptr                 != nullptr  &&
-                    (current_binding_item_ptr->image_view_ptr != nullptr  ||
-                     current_binding_item_ptr->sampler_ptr    != nullptr) )
-                {
-                    VkDescriptorImageInfo image_info;
 
-                    fill_image_info_vk_descriptor(*current_binding_item_ptr,
-                                                  immutable_samplers_enabled,
-                                                 &image_info);
+                /* Need to cache a write item at this point since current binding has not been assigned a descriptor */
+                needs_write_item = true;
+            }
 
-                    m_cached_ds_info_image_info_items_vk.push_back(image_info);
+            if (needs_write_item)
+            {
+                uint32_t n_descriptors = 0;
 
-                    ++cached_ds_image_info_items_array_offset;
-                }
-                else
                 if (descriptor_type == Anvil::DescriptorType::INLINE_UNIFORM_BLOCK)
                 {
-                    VkWriteDescriptorSetInlineUniformBlockEXT iub_info;
+                    anvil_assert((cached_ds_buffer_info_items_array_offset       - start_ds_buffer_info_items_array_offset)       +
+                                 (cached_ds_image_info_items_array_offset        - start_ds_image_info_items_array_offset)        +
+                                 (cached_ds_texel_buffer_info_items_array_offset - start_ds_texel_buffer_info_items_array_offset) == 0);
 
-                    fill_iub_vk_descriptor(*current_binding_item_ptr,
-                                          &iub_info);
+                    n_descriptors = m_cached_ds_write_iub_items_vk.at(start_ds_iub_array_offset).dataSize;
 
-                    m_cached_ds_write_iub_items_vk.at(start_ds_iub_array_offset) = iub_info;
-
-                    needs_write_item           =  true;
-                    cached_ds_iub_array_offset ++;
+                    anvil_assert(n_descriptors != 0);
                 }
                 else
                 {
-                    /* Arrayed bindings are only permitted if the binding has been created with the PARTIALLY_BOUND flag */
-                    if ((current_binding_flags & Anvil::DescriptorBindingFlagBits::PARTIALLY_BOUND_BIT) == 0)
-                    {
-                        anvil_assert_fail();
-
-                        goto end;
-                    }
+                    anvil_assert(cached_ds_iub_array_offset == start_ds_iub_array_offset);
 
-                    /* Need to cache a write item at this point since current binding has not been assigned a descriptor */
-                    needs_write_item = true;
+                    n_descriptors = (cached_ds_buffer_info_items_array_offset       - start_ds_buffer_info_items_array_offset)       +
+                                    (cached_ds_image_info_items_array_offset        - start_ds_image_info_items_array_offset)        +
+                                    (cached_ds_texel_buffer_info_items_array_offset - start_ds_texel_buffer_info_items_array_offset);
                 }
 
-                if (needs_write_item)
+                if (n_descriptors > 0)
                 {
-                    uint32_t n_descriptors = 0;
-
-                    if (descriptor_type == Anvil::DescriptorType::INLINE_UNIFORM_BLOCK)
-                    {
-                        anvil_assert((cached_ds_buffer_info_items_array_offset       - start_ds_buffer_info_items_array_offset)       +
-                                     (cached_ds_image_info_items_array_offset        - start_ds_image_info_items_array_offset)        +
-                                     (cached_ds_texel_buffer_info_items_array_offset - start_ds_texel_buffer_info_items_array_offset) == 0);
-
-                        n_descriptors = m_cached_ds_write_iub_items_vk.at(start_ds_iub_array_offset).dataSize;
-
-                        anvil_assert(n_descriptors != 0);
-                    }
-                    else
-                    {
-                        anvil_assert(cached_ds_iub_array_offset == start_ds_iub_array_offset);
-
-                        n_descriptors = (cached_ds_buffer_info_items_array_offset       - start_ds_buffer_info_items_array_offset)       +
-                                        (cached_ds_image_info_items_array_offset        - start_ds_image_info_items_array_offset)        +
-                                        (cached_ds_texel_buffer_info_items_array_offset - start_ds_texel_buffer_info_items_array_offset);
-                    }
-
-                    if (n_descriptors > 0)
-                    {
-                        write_ds_vk.descriptorCount  = n_descriptors;
-                        write_ds_vk.descriptorType   = static_cast<VkDescriptorType>(descriptor_type);
-                        write_ds_vk.dstArrayElement  = n_last_binding_item + 1;
-                        write_ds_vk.dstBinding       = current_binding_index;
-                        write_ds_vk.dstSet           = m_descriptor_set;
-                        write_ds_vk.pBufferInfo      = (start_ds_buffer_info_items_array_offset != cached_ds_buffer_info_items_array_offset)             ? &m_cached_ds_info_buffer_info_items_vk[start_ds_buffer_info_items_array_offset]
-                                                                                                                                                         : nullptr;
-                        write_ds_vk.pImageInfo       = (start_ds_image_info_items_array_offset  != cached_ds_image_info_items_array_offset)              ? &m_cached_ds_info_image_info_items_vk[start_ds_image_info_items_array_offset]
-                                                                                                                                                         : nullptr;
-                        write_ds_vk.pNext            = nullptr;
-                        write_ds_vk.pTexelBufferView = (start_ds_texel_buffer_info_items_array_offset != cached_ds_texel_buffer_info_items_array_offset) ? &m_cached_ds_info_texel_buffer_info_items_vk[start_ds_texel_buffer_info_items_array_offset]
-                                                                                                                                                         : nullptr;
-                        write_ds_vk.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-
-                        anvil_assert(write_ds_vk.descriptorCount != 0);
-
-                        m_cached_ds_write_items_vk.push_back(write_ds_vk);
-                    }
-
-                    if (start_ds_iub_array_offset - cached_ds_iub_array_offset)
-                    {
-                        /* TODO: This is ugly but will always work, as you can't use vkUpdateDescriptorSets() for any other updates if inline uniform block's contents is
-                         *       being refreshed. Still, we should be using struct chains instead here.
-                         */
-                        anvil_assert((cached_ds_iub_array_offset - start_ds_iub_array_offset) == 1);
-
-                        m_cached_ds_write_items_vk.back().pNext = &m_cached_ds_write_iub_items_vk.at(start_ds_iub_array_offset);
-                    }
-
-                    n_last_binding_item                           = n_current_binding_item;
-                    start_ds_buffer_info_items_array_offset       = cached_ds_buffer_info_items_array_offset;
-                    start_ds_image_info_items_array_offset        = cached_ds_image_info_items_array_offset;
-                    start_ds_iub_array_offset                     = cached_ds_iub_array_offset;
-                    start_ds_texel_buffer_info_items_array_offset = cached_ds_texel_buffer_info_items_array_offset;
+                    write_ds_vk.descriptorCount  = n_descriptors;
+                    write_ds_vk.descriptorType   = static_cast<VkDescriptorType>(descriptor_type);
+                    write_ds_vk.dstArrayElement  = n_last_binding_item + 1;
+                    write_ds_vk.dstBinding       = current_binding_index;
+                    write_ds_vk.dstSet           = m_descriptor_set;
+                    write_ds_vk.pBufferInfo      = (start_ds_buffer_info_items_array_offset != cached_ds_buffer_info_items_array_offset)             ? &m_cached_ds_info_buffer_info_items_vk[start_ds_buffer_info_items_array_offset]
+                                                                                                                                                     : nullptr;
+                    write_ds_vk.pImageInfo       = (start_ds_image_info_items_array_offset  != cached_ds_image_info_items_array_offset)              ? &m_cached_ds_info_image_info_items_vk[start_ds_image_info_items_array_offset]
+                                                                                                                                                     : nullptr;
+                    write_ds_vk.pNext            = nullptr;
+                    write_ds_vk.pTexelBufferView = (start_ds_texel_buffer_info_items_array_offset != cached_ds_texel_buffer_info_items_array_offset) ? &m_cached_ds_info_texel_buffer_info_items_vk[start_ds_texel_buffer_info_items_array_offset]
+                                                                                                                                                     : nullptr;
+                    write_ds_vk.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+
+                    anvil_assert(write_ds_vk.descriptorCount != 0);
+
+                    m_cached_ds_write_items_vk.push_back(write_ds_vk);
                 }
 
-                if (current_binding_item_ptr != nullptr)
+                if (start_ds_iub_array_offset - cached_ds_iub_array_offset)
                 {
-                    current_binding_item_ptr->dirty = false;
+                    /* TODO: This is ugly but will always work, as you can't use vkUpdateDescriptorSets() for any other updates if inline uniform block's contents is
+                     *       being refreshed. Still, we should be using struct chains instead here.
+                     */
+                    anvil_assert((cached_ds_iub_array_offset - start_ds_iub_array_offset) == 1);
+
+                    m_cached_ds_write_items_vk.back().pNext = &m_cached_ds_write_iub_items_vk.at(start_ds_iub_array_offset);
                 }
+
+                n_last_binding_item                           = n_current_binding_item;
+                start_ds_buffer_info_items_array_offset       = cached_ds_buffer_info_items_array_offset;
+                start_ds_image_info_items_array_offset        = cached_ds_image_info_items_array_offset;
+                start_ds_iub_array_offset                     = cached_ds_iub_array_offset;
+                start_ds_texel_buffer_info_items_array_offset = cached_ds_texel_buffer_info_items_array_offset;
             }
         }
+    }
 
-        /* Issue the Vulkan call */
-        if (m_cached_ds_write_items_vk.size() > 0)
+    result = true;
+
+end:
+    return result;
+}
+
+/** Packs descriptors for all dirty binding array items into m_template_payload.
+ *
+ *  Does not modify the set's dirty state.
+ *
+ *  @param out_has_iub_updates_ptr Deref will be set to true if the payload includes inline uniform block updates,
+ *                                 false otherwise. Must not be null.
+ *
+ *  @return true if successful, false otherwise.
+ **/
+bool Anvil::DescriptorSet::prepare_template_update(bool* out_has_iub_updates_ptr) const
+{
+    const auto     layout_info_ptr = m_layout_ptr->get_create_info();
+    const uint32_t n_bindings      = static_cast<uint32_t>(m_binding_ptrs.size() );
+    bool           result          = false;
+
+    *out_has_iub_updates_ptr = false;
+
+    m_template_payload.clear();
+
+    for (uint32_t n_binding = 0;
+                  n_binding < n_bindings;
+                ++n_binding)
+    {
+        const std::vector<BindingItemUniquePtr>* binding_element_ptr_vec_ptr = nullptr;
+        uint32_t                                 current_binding_index       = UINT32_MAX;
+        Anvil::DescriptorType                    descriptor_type             = Anvil::DescriptorType::UNKNOWN;
+        bool                                     immutable_samplers_enabled  = false;
+        uint32_t                                 n_binding_elements          = 0;
+
+        if (!layout_info_ptr->get_binding_properties_by_index_number(n_binding,
+                                                                    &current_binding_index,
+                                                                    &descriptor_type,
+                                                                     nullptr,                     /* out_opt_descriptor_array_size_ptr */
+                                                                     nullptr,                     /* out_opt_stage_flags_ptr           */
+                                                                    &immutable_samplers_enabled,
+                                                                     nullptr) )                   /* out_opt_flags_ptr                 */
         {
-            Anvil::Vulkan::vkUpdateDescriptorSets(m_device_ptr->get_device_vk(),
-                                                  static_cast<uint32_t>(m_cached_ds_write_items_vk.size() ),
-                                                 &m_cached_ds_write_items_vk[0],
-                                                  0,        /* copyCount         */
-                                                  nullptr); /* pDescriptorCopies */
+            anvil_assert_fail();
 
-            /* If any IUB bindings have been processed, wipe out binding items associated with these, as the corresponding updates have already
-             * been performed.
-             */
-            for (const auto& current_iub_binding_index : iub_binding_indices)
+            goto end;
+        }
+
+        binding_element_ptr_vec_ptr = &m_binding_ptrs.at(current_binding_index);
+        n_binding_elements          = static_cast<uint32_t>(binding_element_ptr_vec_ptr->size() );
+
+        for (uint32_t n_binding_element = 0;
+                      n_binding_element < n_binding_elements;
+                    ++n_binding_element)
+        {
+            const auto& current_binding_element_ptr = binding_element_ptr_vec_ptr->at(n_binding_element);
+
+            if (current_binding_element_ptr        == nullptr ||
+               !current_binding_element_ptr->dirty)
             {
-                auto& current_iub_binding = m_binding_ptrs.at(current_iub_binding_index);
+                continue;
+            }
 
-                current_iub_binding.clear();
+            /* Append the new descriptor to the payload. Descriptors for consecutive array items are folded into a single
+             * template entry by the payload. */
+            if (current_binding_element_ptr->buffer_ptr != nullptr)
+            {
+                fill_buffer_info_vk_descriptor(*current_binding_element_ptr,
+                                               static_cast<VkDescriptorBufferInfo*>(m_template_payload.append(descriptor_type,
+                                                                                                              current_binding_index,
+                                                                                                              n_binding_element,
+                                                                                                              sizeof(VkDescriptorBufferInfo) )));
             }
-        }
+            else
+            if (current_binding_element_ptr->buffer_view_ptr != nullptr)
+            {
+                *static_cast<VkBufferView*>(m_template_payload.append(descriptor_type,
+                                                                      current_binding_index,
+                                                                      n_binding_element,
+                                                                      sizeof(VkBufferView) )) = current_binding_element_ptr->buffer_view_ptr->get_buffer_view();
+            }
+            else
+            if (current_binding_element_ptr->image_view_ptr != nullptr ||
+                current_binding_element_ptr->sampler_ptr    != nullptr)
+            {
+                fill_image_info_vk_descriptor(*current_binding_element_ptr,
+                                              immutable_samplers_enabled,
+                                              static_cast<VkDescriptorImageInfo*>(m_template_payload.append(descriptor_type,
+                                                                                                            current_binding_index,
+                                                                                                            n_binding_element,
+                                                                                                            sizeof(VkDescriptorImageInfo) )));
+            }
+            else
+            if (current_binding_element_ptr->type_vk == Anvil::DescriptorType::INLINE_UNIFORM_BLOCK)
+            {
+                fill_iub_vk_descriptor(*current_binding_element_ptr,
+                                       static_cast<VkWriteDescriptorSetInlineUniformBlockEXT*>(m_template_payload.append(descriptor_type,
+                                                                                                                         current_binding_index,
+                                                                                                                         n_binding_element,
+                                                                                                                         sizeof(VkWriteDescriptorSetInlineUniformBlockEXT),
+                                                                                                                         false) )); /* in_can_be_merged */
+
+                *out_has_iub_updates_ptr = true;
+            }
+            else
+            {
+                anvil_assert_fail();
 
-        m_dirty = false;
+                goto end;
+            }
+        }
     }
 
     result = true;
-
 end:
-
     return result;
 }
 
-bool Anvil::DescriptorSet::update_using_template_method() const
+/** Updates the set with a descriptor update template, if the set's layout has already created a template matching
+ *  the pending updates. IUB updates are never handled by this function.
+ *
+ *  @return true if the set has been updated, false if the caller should fall back to vkUpdateDescriptorSets().
+ **/
+bool Anvil::DescriptorSet::update_using_cached_template() const
 {
-    std::vector<uint8_t> data_vector;
-    const auto           layout_info_ptr = m_layout_ptr->get_create_info();
-    bool                 result          = false;
+    bool                                   has_iub_updates = false;
+    bool                                   result          = false;
+    const Anvil::DescriptorUpdateTemplate* template_ptr    = nullptr;
 
-    if (!m_device_ptr->get_extension_info()->khr_descriptor_update_template() )
+    if (!m_device_ptr->get_extension_info()->khr_descriptor_update_template() ||
+        !m_layout_ptr->has_update_templates() )
     {
-        anvil_assert(m_device_ptr->get_extension_info()->khr_descriptor_update_template() );
+        goto end;
+    }
 
+    if (!prepare_template_update(&has_iub_updates) ||
+         has_iub_updates                           ||
+         m_template_payload.is_empty() )
+    {
         goto end;
     }
 
+    template_ptr = m_layout_ptr->get_update_template(m_template_payload.get_entries(),
+                                                     false); /* in_create_if_missing */
+
+    if (template_ptr == nullptr)
+    {
+        goto end;
+    }
+
+    /* NOTE: The order MUST be reversed, since update_descriptor_set() calls DescriptorSet::get_descriptor_set_vk() which would invoke update()
+     *       had m_dirty been set to true.
+     */
+    m_dirty = false;
+
+    template_ptr->update_descriptor_set(this,
+                                        m_template_payload.get_data() );
+
+    on_template_update_issued();
+
+    result = true;
+end:
+    return result;
+}
+
+/* Please see header for specification */
+bool Anvil::DescriptorSet::update_using_core_method() const
+{
+    std::vector<uint32_t> iub_binding_indices;
+    bool                  result              = false;
+
     anvil_assert(!m_unusable);
 
     if (m_dirty)
     {
-        /* First build up a vector of template entries we need the template to encapsulate. While on it,
-         * also construct an array of descriptors we're going to pass along the template.
-         */
-        const uint32_t                                  n_bindings               = static_cast<uint32_t>(m_binding_ptrs.size() );
-        decltype(m_template_object_map)::const_iterator template_object_iterator;
-
-        m_template_entries.clear ();
-        m_template_raw_data.clear();
-
-        for (uint32_t n_binding = 0;
-                      n_binding < n_bindings;
-                    ++n_binding)
+        if (!prepare_core_update(&iub_binding_indices) )
         {
-            const std::vector<BindingItemUniquePtr>* binding_element_ptr_vec_ptr = nullptr;
-            uint32_t                                 current_binding_index       = UINT32_MAX;
-            Anvil::DescriptorType                    descriptor_type             = Anvil::DescriptorType::UNKNOWN;
-            bool                                     immutable_samplers_enabled  = false;
-            uint32_t                                 n_binding_elements          = 0;
-
-            if (!layout_info_ptr->get_binding_properties_by_index_number(n_binding,
-                                                                        &current_binding_index,
-                                                                        &descriptor_type,
-                                                                         nullptr,                     /* out_opt_descriptor_array_size_ptr */
-                                                                         nullptr,                     /* out_opt_stage_flags_ptr           */
-                                                                        &immutable_samplers_enabled,
-                                                                         nullptr) )                   /* out_opt_flags_ptr                 */
-            {
-                anvil_assert_fail();
-
-                result = false;
-                goto end;
-            }
+            goto end;
+        }
 
-            binding_element_ptr_vec_ptr = &m_binding_ptrs.at(current_binding_index);
-            n_binding_elements          = static_cast<uint32_t>(binding_element_ptr_vec_ptr->size() );
+        /* Issue the Vulkan call */
+        if (m_cached_ds_write_items_vk.size() > 0)
+        {
+            Anvil::Vulkan::vkUpdateDescriptorSets(m_device_ptr->get_device_vk(),
+                                                  static_cast<uint32_t>(m_cached_ds_write_items_vk.size() ),
+                                                 &m_cached_ds_write_items_vk[0],
+                                                  0,        /* copyCount         */
+                                                  nullptr); /* pDescriptorCopies */
+        }
 
-            for (uint32_t n_binding_element = 0;
-                          n_binding_element < n_binding_elements;
-                        ++n_binding_element)
-            {
-                const auto&    current_binding_element        = *binding_element_ptr_vec_ptr->at(n_binding_element);
-                const uint32_t current_template_raw_data_size = static_cast<uint32_t>(m_template_raw_data.size() );
+        on_core_update_issued(iub_binding_indices);
+    }
 
-                if (!current_binding_element.dirty)
-                {
-                    continue;
-                }
+    result = true;
 
-                /* Append the new descriptor to the raw data vector.
-                 *
-                 * TODO: Consecutive dirty binding elements could be merged into a single item here.
-                 */
-                if (current_binding_element.buffer_ptr != nullptr)
-                {
-                    m_template_raw_data.resize(current_template_raw_data_size + sizeof(VkDescriptorBufferInfo) );
+end:
 
-                    fill_buffer_info_vk_descriptor(current_binding_element,
-                                                   reinterpret_cast<VkDescriptorBufferInfo*>(&m_template_raw_data.at(current_template_raw_data_size) ));
-                }
-                else
-                if (current_binding_element.buffer_view_ptr != nullptr)
-                {
-                    m_template_raw_data.resize(current_template_raw_data_size + sizeof(VkBufferView) );
+    return result;
+}
 
-                    *reinterpret_cast<VkBufferView*>(&m_template_raw_data.at(current_template_raw_data_size) ) = current_binding_element.buffer_view_ptr->get_buffer_view();
-                }
-                else
-                if (current_binding_element.image_view_ptr != nullptr)
-                {
-                    m_template_raw_data.resize(current_template_raw_data_size + sizeof(VkDescriptorImageInfo) );
+bool Anvil::DescriptorSet::update_using_template_method() const
+{
+    bool                                   has_iub_updates = false;
+    bool                                   result          = false;
+    const Anvil::DescriptorUpdateTemplate* template_ptr    = nullptr;
 
-                    fill_image_info_vk_descriptor(current_binding_element,
-                                                  immutable_samplers_enabled,
-                                                  reinterpret_cast<VkDescriptorImageInfo*>(&m_template_raw_data.at(current_template_raw_data_size) ));
-                }
-                else
-                if (current_binding_element.type_vk == Anvil::DescriptorType::INLINE_UNIFORM_BLOCK)
-                {
-                    m_template_raw_data.resize(current_template_raw_data_size + sizeof(VkWriteDescriptorSetInlineUniformBlockEXT) );
+    if (!m_device_ptr->get_extension_info()->khr_descriptor_update_template() )
+    {
+        anvil_assert(m_device_ptr->get_extension_info()->khr_descriptor_update_template() );
 
-                    fill_iub_vk_descriptor(current_binding_element,
-                                           reinterpret_cast<VkWriteDescriptorSetInlineUniformBlockEXT*>(&m_template_raw_data.at(current_template_raw_data_size) ));
-                }
-                else
-                {
-                    anvil_assert_fail();
+        goto end;
+    }
 
-                    result = false;
-                    goto end;
-                }
+    anvil_assert(!m_unusable);
 
-                m_template_entries.push_back(
-                    DescriptorUpdateTemplateEntry(descriptor_type,
-                                                  n_binding_element,
-                                                  current_binding_index,
-                                                  1,                              /* in_n_descriptors */
-                                                  current_template_raw_data_size,
-                                                  0)                              /* in_stride */
-                );
-            }
+    if (m_dirty)
+    {
+        if (!prepare_template_update(&has_iub_updates) )
+        {
+            goto end;
         }
 
-        if (m_template_entries.size() == 0)
+        if (m_template_payload.is_empty() )
         {
-            goto end;
+            /* All binding items have already been written */
+            m_dirty = false;
         }
         else
         {
-            anvil_assert(m_template_raw_data.size() > 0);
-        }
+            /* Templates are cached by the layout, so that all sets using the same layout can share them */
+            template_ptr = m_layout_ptr->get_update_template(m_template_payload.get_entries(),
+                                                             true); /* in_create_if_missing */
 
-        /* Has a template object matching our needs already been created in the past? */
-        template_object_iterator = m_template_object_map.find(m_template_entries);
-
-        if (template_object_iterator == m_template_object_map.end() )
-        {
-            /* Need to create a new template object.. */
-            m_template_object_map[m_template_entries] = std::move(
-                Anvil::DescriptorUpdateTemplate::create_for_descriptor_set_updates(m_device_ptr,
-                                                                                   m_layout_ptr,
-                                                                                   m_template_entries,
-                                                                                   Anvil::MTSafety::DISABLED) );
-
-            /* Update the iterator */
-            template_object_iterator = m_template_object_map.find(m_template_entries);
-            anvil_assert(template_object_iterator != m_template_object_map.end() );
-
-            if (template_object_iterator->second == nullptr)
+            if (template_ptr == nullptr)
             {
-                anvil_assert(template_object_iterator->second != nullptr);
+                anvil_assert(template_ptr != nullptr);
 
-                result = false;
                 goto end;
             }
-        }
 
-        /* Issue the Vulkan call.
-         *
-         * NOTE: The order MUST be reversed, since update_descriptor_set() calls DescriptorSet::get_descriptor_set_vk() which would invoke update()
-         *       had m_dirty been set to true.
-         */
-        m_dirty = false;
+            /* Issue the Vulkan call.
+             *
+             * NOTE: The order MUST be reversed, since update_descriptor_set() calls DescriptorSet::get_descriptor_set_vk() which would invoke update()
+             *       had m_dirty been set to true.
+             */
+            m_dirty = false;
+
+            template_ptr->update_descriptor_set(this,
+                                                m_template_payload.get_data() );
 
-        template_object_iterator->second->update_descriptor_set(this,
-                                                               &m_template_raw_data.at(0) );
+            on_template_update_issued();
+        }
     }
 
     result = true;
@@ -1148,4 +1373,4 @@ bool Anvil::DescriptorSet::update_using_template_method() const
 end:
 
     return result;
-}
\ No newline at end of file
+}
@@ -25,6 +25,7 @@
 #include "misc/object_tracker.h"
 #include "misc/struct_chainer.h"
 #include "wrappers/descriptor_set_layout.h"
+#include "wrappers/descriptor_update_template.h"
 #include "wrappers/device.h"
 #include "wrappers/sampler.h"
 
@@ -49,6 +50,8 @@ Anvil::DescriptorSetLayout::~DescriptorSetLayout()
     Anvil::ObjectTracker::get()->unregister_object(Anvil::ObjectType::DESCRIPTOR_SET_LAYOUT,
                                                     this);
 
+    m_update_templates.clear();
+
     if (m_layout != VK_NULL_HANDLE)
     {
         lock();
@@ -90,6 +93,55 @@ Anvil::DescriptorSetLayoutUniquePtr Anvil::DescriptorSetLayout::create(Anvil::De
     return result_ptr;
 }
 
+/** Please see header for specification */
+const Anvil::DescriptorUpdateTemplate* Anvil::DescriptorSetLayout::get_update_template(const std::vector<Anvil::DescriptorUpdateTemplateEntry>& in_entries,
+                                                                                        bool                                                     in_create_if_missing) const
+{
+    std::unique_lock<std::mutex>     lock      (m_update_templates_mutex);
+    Anvil::DescriptorUpdateTemplate* result_ptr(nullptr);
+    auto                             iterator  (m_update_templates.find(in_entries) );
+
+    if (iterator != m_update_templates.end() )
+    {
+        result_ptr = iterator->second.get();
+
+        goto end;
+    }
+
+    if (!in_create_if_missing)
+    {
+        goto end;
+    }
+
+    {
+        auto new_template_ptr = Anvil::DescriptorUpdateTemplate::create_for_descriptor_set_updates(m_device_ptr,
+                                                                                                   this,
+                                                                                                   in_entries,
+                                                                                                   Anvil::MTSafety::DISABLED);
+
+        if (new_template_ptr == nullptr)
+        {
+            anvil_assert(new_template_ptr != nullptr);
+
+            goto end;
+        }
+
+        result_ptr                     = new_template_ptr.get();
+        m_update_templates[in_entries] = std::move(new_template_ptr);
+    }
+
+end:
+    return result_ptr;
+}
+
+/** Please see header for specification */
+bool Anvil::DescriptorSetLayout::has_update_templates() const
+{
+    std::unique_lock<std::mutex> lock(m_update_templates_mutex);
+
+    return !m_update_templates.empty();
+}
+
 uint32_t Anvil::DescriptorSetLayout::get_maximum_variable_descriptor_count(const DescriptorSetLayoutCreateInfoContainer* in_ds_create_info_ptr,
                                                                            const Anvil::BaseDevice*                      in_device_ptr)
 {
@@ -42,7 +42,12 @@ Anvil::DescriptorSetLayoutManager::DescriptorSetLayoutManager(const Anvil::BaseD
 /** Destructor */
 Anvil::DescriptorSetLayoutManager::~DescriptorSetLayoutManager()
 {
-    anvil_assert(m_descriptor_set_layouts.size() == 0);
+    for (uint32_t n_shard = 0;
+                  n_shard < N_SHARDS;
+                ++n_shard)
+    {
+        anvil_assert(m_shards[n_shard].descriptor_set_layouts.size() == 0);
+    }
 
     /* Unregister the object */
     Anvil::ObjectTracker::get()->unregister_object(Anvil::ObjectType::ANVIL_DESCRIPTOR_SET_LAYOUT_MANAGER,
@@ -69,36 +74,44 @@ Anvil::DescriptorSetLayoutManagerUniquePtr Anvil::DescriptorSetLayoutManager::cr
 bool Anvil::DescriptorSetLayoutManager::get_layout(const DescriptorSetCreateInfo*       in_ds_create_info_ptr,
                                                    Anvil::DescriptorSetLayoutUniquePtr* out_ds_layout_ptr_ptr)
 {
-    std::unique_lock<std::recursive_mutex> mutex_lock;
-    auto                                   mutex_ptr            = get_mutex();
-    bool                                   result               = false;
-    Anvil::DescriptorSetLayout*            result_ds_layout_ptr = nullptr;
-
     anvil_assert(in_ds_create_info_ptr != nullptr);
 
-    if (mutex_ptr != nullptr)
+    const size_t                 hash                 = in_ds_create_info_ptr->get_hash();
+    bool                         result               = false;
+    Anvil::DescriptorSetLayout*  result_ds_layout_ptr = nullptr;
+    auto&                        shard                = get_shard(hash);
+    std::unique_lock<std::mutex> shard_lock            (shard.mutex,
+                                                        std::defer_lock);
+
+    if (is_mt_safe() )
     {
-        mutex_lock = std::move(
-            std::unique_lock<std::recursive_mutex>(*mutex_ptr)
-        );
+        shard_lock.lock();
     }
 
-    for (auto layout_iterator  = m_descriptor_set_layouts.begin();
-              layout_iterator != m_descriptor_set_layouts.end();
-            ++layout_iterator)
+    /* Only look the bucket up here, so that misses do not leave empty buckets behind */
+    auto ds_layouts_iterator = shard.descriptor_set_layouts.find(hash);
+
+    if (ds_layouts_iterator != shard.descriptor_set_layouts.end() )
     {
-        auto&  current_ds_layout_container_ptr  = *layout_iterator;
-        auto&  current_ds_layout_ptr            = current_ds_layout_container_ptr->ds_layout_ptr;
-        auto   current_ds_create_info_ptr       = current_ds_layout_ptr->get_create_info();
+        auto& ds_layouts = ds_layouts_iterator->second;
 
-        if (*in_ds_create_info_ptr == *current_ds_create_info_ptr)
+        for (auto layout_iterator  = ds_layouts.begin();
+                  layout_iterator != ds_layouts.end();
+                ++layout_iterator)
         {
-            result               = true;
-            result_ds_layout_ptr = current_ds_layout_ptr.get();
+            auto&  current_ds_layout_container_ptr  = *layout_iterator;
+            auto&  current_ds_layout_ptr            = current_ds_layout_container_ptr->ds_layout_ptr;
+            auto   current_ds_create_info_ptr       = current_ds_layout_ptr->get_create_info();
 
-            current_ds_layout_container_ptr->n_references.fetch_add(1);
+            if (*in_ds_create_info_ptr == *current_ds_create_info_ptr)
+            {
+                result               = true;
+                result_ds_layout_ptr = current_ds_layout_ptr.get();
+
+                current_ds_layout_container_ptr->n_references.fetch_add(1);
 
-            break;
+                break;
+            }
         }
     }
 
@@ -115,7 +128,7 @@ bool Anvil::DescriptorSetLayoutManager::get_layout(const DescriptorSetCreateInfo
         result_ds_layout_ptr                       = new_ds_layout_ptr.get();
         new_ds_layout_container_ptr->ds_layout_ptr = std::move(new_ds_layout_ptr);
 
-        m_descriptor_set_layouts.push_back(
+        shard.descriptor_set_layouts[hash].push_back(
             std::move(new_ds_layout_container_ptr)
         );
     }
@@ -136,36 +149,57 @@ bool Anvil::DescriptorSetLayoutManager::get_layout(const DescriptorSetCreateInfo
 
 void Anvil::DescriptorSetLayoutManager::on_descriptor_set_layout_dereferenced(Anvil::DescriptorSetLayout* in_layout_ptr)
 {
-    bool                                   has_found  = false;
-    std::unique_lock<std::recursive_mutex> mutex_lock;
-    auto                                   mutex_ptr  = get_mutex();
+    bool                                          has_found = false;
+    const size_t                                  hash      = in_layout_ptr->get_create_info()->get_hash();
+    std::unique_ptr<DescriptorSetLayoutContainer> released_container_ptr;
+    auto&                                         shard     = get_shard(hash);
 
-    if (mutex_ptr != nullptr)
-    {
-        mutex_lock = std::move(
-            std::unique_lock<std::recursive_mutex>(*mutex_ptr)
-        );
-    }
+    ANVIL_REDUNDANT_VARIABLE(has_found);
 
-    for (auto layout_iterator  = m_descriptor_set_layouts.begin();
-              layout_iterator != m_descriptor_set_layouts.end()    && !has_found;
-            ++layout_iterator)
     {
-        auto& current_ds_layout_container_ptr = *layout_iterator;
-        auto& current_ds_layout_ptr           = current_ds_layout_container_ptr->ds_layout_ptr;
+        std::unique_lock<std::mutex> shard_lock(shard.mutex,
+                                                std::defer_lock);
 
-        if (current_ds_layout_ptr.get() == in_layout_ptr)
+        if (is_mt_safe() )
         {
-            has_found = true;
+            shard_lock.lock();
+        }
+
+        auto ds_layouts_iterator = shard.descriptor_set_layouts.find(hash);
+
+        if (ds_layouts_iterator != shard.descriptor_set_layouts.end() )
+        {
+            auto& ds_layouts = ds_layouts_iterator->second;
 
-            if (current_ds_layout_container_ptr->n_references.fetch_sub(1) == 1)
+            for (auto layout_iterator  = ds_layouts.begin();
+                      layout_iterator != ds_layouts.end();
+                    ++layout_iterator)
             {
-                m_descriptor_set_layouts.erase(layout_iterator);
-            }
+                auto& current_ds_layout_container_ptr = *layout_iterator;
+                auto& current_ds_layout_ptr           = current_ds_layout_container_ptr->ds_layout_ptr;
+
+                if (current_ds_layout_ptr.get() == in_layout_ptr)
+                {
+                    has_found = true;
 
-            break;
+                    if (current_ds_layout_container_ptr->n_references.fetch_sub(1) == 1)
+                    {
+                        /* Release the layout after the shard is unlocked. */
+                        released_container_ptr = std::move(current_ds_layout_container_ptr);
+
+                        ds_layouts.erase(layout_iterator);
+
+                        if (ds_layouts.size() == 0)
+                        {
+                            shard.descriptor_set_layouts.erase(ds_layouts_iterator);
+                        }
+                    }
+
+                    break;
+                }
+            }
         }
     }
 
     anvil_assert(has_found);
-}
\ No newline at end of file
+}
@@ -43,7 +43,12 @@ Anvil::PipelineLayoutManager::PipelineLayoutManager(const Anvil::BaseDevice* in_
 Anvil::PipelineLayoutManager::~PipelineLayoutManager()
 {
     /* If this assertion check explodes, your app has not released all pipelines it has created. */
-    anvil_assert(m_pipeline_layouts.size() == 0);
+    for (uint32_t n_shard = 0;
+                  n_shard < N_SHARDS;
+                ++n_shard)
+    {
+        anvil_assert(m_shards[n_shard].pipeline_layouts.size() == 0);
+    }
 
     /* Unregister the object */
     Anvil::ObjectTracker::get()->unregister_object(Anvil::ObjectType::ANVIL_PIPELINE_LAYOUT_MANAGER,
@@ -66,82 +71,128 @@ Anvil::PipelineLayoutManagerUniquePtr Anvil::PipelineLayoutManager::create(const
     return result_ptr;
 }
 
+/** Calculates a hash of the specified DSG + push constant range configuration. Configurations which are considered
+ *  equal by get_layout() always share the same hash.
+ **/
+size_t Anvil::PipelineLayoutManager::get_hash(const std::vector<DescriptorSetCreateInfoUniquePtr>* in_ds_create_info_items_ptr,
+                                              const PushConstantRanges&                            in_push_constant_ranges)
+{
+    std::hash<uint32_t> hash_uint32;
+    size_t              result_hash = 0;
+
+    Anvil::Utils::hash_combine(&result_hash,
+                               hash_uint32(static_cast<uint32_t>(in_ds_create_info_items_ptr->size() )) );
+
+    for (auto ds_create_info_iterator  = in_ds_create_info_items_ptr->begin();
+              ds_create_info_iterator != in_ds_create_info_items_ptr->end();
+            ++ds_create_info_iterator)
+    {
+        /* Null descriptor sets only match other null descriptor sets. */
+        Anvil::Utils::hash_combine(&result_hash,
+                                   (*ds_create_info_iterator != nullptr) ? (*ds_create_info_iterator)->get_hash()
+                                                                         : 0);
+    }
+
+    for (auto push_constant_range_iterator  = in_push_constant_ranges.begin();
+              push_constant_range_iterator != in_push_constant_ranges.end();
+            ++push_constant_range_iterator)
+    {
+        Anvil::Utils::hash_combine(&result_hash,
+                                   hash_uint32(push_constant_range_iterator->offset) );
+        Anvil::Utils::hash_combine(&result_hash,
+                                   hash_uint32(push_constant_range_iterator->size) );
+        Anvil::Utils::hash_combine(&result_hash,
+                                   hash_uint32(static_cast<uint32_t>(push_constant_range_iterator->stages.get_vk() )) );
+    }
+
+    return result_hash;
+}
+
 /* Please see header for specification */
 bool Anvil::PipelineLayoutManager::get_layout(const std::vector<DescriptorSetCreateInfoUniquePtr>* in_ds_create_info_items_ptr,
                                               const PushConstantRanges&                            in_push_constant_ranges,
                                               Anvil::PipelineLayoutUniquePtr*                      out_pipeline_layout_ptr_ptr)
 {
-    std::unique_lock<std::recursive_mutex> mutex_lock;
-    auto                                   mutex_ptr                   = get_mutex();
-    const uint32_t                         n_descriptor_sets_in_in_dsg = static_cast<uint32_t>(in_ds_create_info_items_ptr->size() );
-    bool                                   result                      = false;
-    Anvil::PipelineLayout*                 result_pipeline_layout_ptr  = nullptr;
-
-    if (mutex_ptr != nullptr)
+    const size_t                 hash                        = get_hash(in_ds_create_info_items_ptr,
+                                                                        in_push_constant_ranges);
+    const uint32_t               n_descriptor_sets_in_in_dsg = static_cast<uint32_t>(in_ds_create_info_items_ptr->size() );
+    bool                         result                      = false;
+    Anvil::PipelineLayout*       result_pipeline_layout_ptr  = nullptr;
+    auto&                        shard                       = get_shard(hash);
+    std::unique_lock<std::mutex> shard_lock                   (shard.mutex,
+                                                               std::defer_lock);
+
+    if (is_mt_safe() )
     {
-        mutex_lock = std::move(
-            std::unique_lock<std::recursive_mutex>(*mutex_ptr)
-        );
+        shard_lock.lock();
     }
 
-    for (auto layout_iterator  = m_pipeline_layouts.begin();
-              layout_iterator != m_pipeline_layouts.end();
-            ++layout_iterator)
-    {
-        auto&      current_pipeline_layout_container_ptr     = *layout_iterator;
-        auto&      current_pipeline_layout_ptr               = current_pipeline_layout_container_ptr->pipeline_layout_ptr;
-        auto       current_pipeline_ds_create_info_ptrs      = current_pipeline_layout_ptr->get_ds_create_info_ptrs();
-        bool       dss_match                                 = true;
-        const auto n_descriptor_sets_in_current_pipeline_dsg = static_cast<uint32_t>(current_pipeline_ds_create_info_ptrs->size() );
+    /* Only look the bucket up here, so that misses do not leave empty buckets behind */
+    auto pipeline_layouts_iterator = shard.pipeline_layouts.find(hash);
 
-        if (n_descriptor_sets_in_current_pipeline_dsg != n_descriptor_sets_in_in_dsg)
-        {
-            continue;
-        }
-
-        if (current_pipeline_layout_ptr->get_attached_push_constant_ranges() != in_push_constant_ranges)
-        {
-            continue;
-        }
+    if (pipeline_layouts_iterator != shard.pipeline_layouts.end() )
+    {
+        auto& pipeline_layouts = pipeline_layouts_iterator->second;
 
-        for (uint32_t n_ds = 0;
-                      n_ds < n_descriptor_sets_in_in_dsg && dss_match;
-                    ++n_ds)
+        for (auto layout_iterator  = pipeline_layouts.begin();
+                  layout_iterator != pipeline_layouts.end();
+                ++layout_iterator)
         {
-            auto&       in_dsg_ds_create_info_ptr               = in_ds_create_info_items_ptr->at         (n_ds);
-            const auto& current_pipeline_dsg_ds_create_info_ptr = current_pipeline_ds_create_info_ptrs->at(n_ds);
+            auto&      current_pipeline_layout_container_ptr     = *layout_iterator;
+            auto&      current_pipeline_layout_ptr               = current_pipeline_layout_container_ptr->pipeline_layout_ptr;
+            auto       current_pipeline_ds_create_info_ptrs      = current_pipeline_layout_ptr->get_ds_create_info_ptrs();
+            bool       dss_match                                 = true;
+            const auto n_descriptor_sets_in_current_pipeline_dsg = static_cast<uint32_t>(current_pipeline_ds_create_info_ptrs->size() );
 
-            if ((in_dsg_ds_create_info_ptr != nullptr && current_pipeline_dsg_ds_create_info_ptr == nullptr) ||
-                (in_dsg_ds_create_info_ptr == nullptr && current_pipeline_dsg_ds_create_info_ptr != nullptr) )
+            if (n_descriptor_sets_in_current_pipeline_dsg != n_descriptor_sets_in_in_dsg)
             {
-                dss_match = false;
+                continue;
+            }
 
-                break;
+            if (current_pipeline_layout_ptr->get_attached_push_constant_ranges() != in_push_constant_ranges)
+            {
+                continue;
             }
 
-            if (in_dsg_ds_create_info_ptr               != nullptr &&
-                current_pipeline_dsg_ds_create_info_ptr != nullptr)
+            for (uint32_t n_ds = 0;
+                          n_ds < n_descriptor_sets_in_in_dsg && dss_match;
+                        ++n_ds)
             {
-                if (!(*in_dsg_ds_create_info_ptr == *current_pipeline_dsg_ds_create_info_ptr) )
+                auto&       in_dsg_ds_create_info_ptr               = in_ds_create_info_items_ptr->at         (n_ds);
+                const auto& current_pipeline_dsg_ds_create_info_ptr = current_pipeline_ds_create_info_ptrs->at(n_ds);
+
+                if ((in_dsg_ds_create_info_ptr != nullptr && current_pipeline_dsg_ds_create_info_ptr == nullptr) ||
+                    (in_dsg_ds_create_info_ptr == nullptr && current_pipeline_dsg_ds_create_info_ptr != nullptr) )
                 {
                     dss_match = false;
 
                     break;
                 }
+
+                if (in_dsg_ds_create_info_ptr               != nullptr &&
+                    current_pipeline_dsg_ds_create_info_ptr != nullptr)
+                {
+                    if (!(*in_dsg_ds_create_info_ptr == *current_pipeline_dsg_ds_create_info_ptr) )
+                    {
+                        dss_match = false;
+
+                        break;
+                    }
+                }
             }
-        }
 
-        if (!dss_match)
-        {
-            continue;
-        }
+            if (!dss_match)
+            {
+                continue;
+            }
 
-        result                       = true;
-        result_pipeline_layout_ptr   = current_pipeline_layout_container_ptr->pipeline_layout_ptr.get();
+            result                       = true;
+            result_pipeline_layout_ptr   = current_pipeline_layout_container_ptr->pipeline_layout_ptr.get();
 
-        current_pipeline_layout_container_ptr->n_references.fetch_add(1);
+            current_pipeline_layout_container_ptr->n_references.fetch_add(1);
 
-        break;
+            break;
+        }
     }
 
     if (!result)
@@ -158,7 +209,7 @@ bool Anvil::PipelineLayoutManager::get_layout(const std::vector<DescriptorSetCre
         result_pipeline_layout_ptr                    = new_layout_ptr.get();
         new_layout_container_ptr->pipeline_layout_ptr = std::move(new_layout_ptr);
 
-        m_pipeline_layouts.push_back(
+        shard.pipeline_layouts[hash].push_back(
             std::move(new_layout_container_ptr)
         );
     }
@@ -179,36 +230,59 @@ bool Anvil::PipelineLayoutManager::get_layout(const std::vector<DescriptorSetCre
 
 void Anvil::PipelineLayoutManager::on_pipeline_layout_dereferenced(Anvil::PipelineLayout* in_layout_ptr)
 {
-    bool                                   has_found  = false;
-    std::unique_lock<std::recursive_mutex> mutex_lock;
-    auto                                   mutex_ptr  = get_mutex();
+    bool                                     has_found = false;
+    const size_t                             hash      = get_hash(in_layout_ptr->get_ds_create_info_ptrs(),
+                                                                  in_layout_ptr->get_attached_push_constant_ranges() );
+    std::unique_ptr<PipelineLayoutContainer> released_container_ptr;
+    auto&                                    shard     = get_shard(hash);
 
-    if (mutex_ptr != nullptr)
-    {
-        mutex_lock = std::move(
-            std::unique_lock<std::recursive_mutex>(*mutex_ptr)
-        );
-    }
+    ANVIL_REDUNDANT_VARIABLE(has_found);
 
-    for (auto layout_iterator  = m_pipeline_layouts.begin();
-              layout_iterator != m_pipeline_layouts.end()    && !has_found;
-            ++layout_iterator)
     {
-        auto& current_pipeline_layout_container_ptr = *layout_iterator;
-        auto& current_pipeline_layout_ptr           = current_pipeline_layout_container_ptr->pipeline_layout_ptr;
+        std::unique_lock<std::mutex> shard_lock(shard.mutex,
+                                                std::defer_lock);
 
-        if (current_pipeline_layout_ptr.get() == in_layout_ptr)
+        if (is_mt_safe() )
         {
-            has_found = true;
+            shard_lock.lock();
+        }
+
+        auto pipeline_layouts_iterator = shard.pipeline_layouts.find(hash);
 
-            if (current_pipeline_layout_container_ptr->n_references.fetch_sub(1) == 1)
+        if (pipeline_layouts_iterator != shard.pipeline_layouts.end() )
+        {
+            auto& pipeline_layouts = pipeline_layouts_iterator->second;
+
+            for (auto layout_iterator  = pipeline_layouts.begin();
+                      layout_iterator != pipeline_layouts.end();
+                    ++layout_iterator)
             {
-                m_pipeline_layouts.erase(layout_iterator);
-            }
+                auto& current_pipeline_layout_container_ptr = *layout_iterator;
+                auto& current_pipeline_layout_ptr           = current_pipeline_layout_container_ptr->pipeline_layout_ptr;
 
-            break;
+                if (current_pipeline_layout_ptr.get() == in_layout_ptr)
+                {
+                    has_found = true;
+
+                    if (current_pipeline_layout_container_ptr->n_references.fetch_sub(1) == 1)
+                    {
+                        /* Release the layout after the shard is unlocked. Destroying a pipeline layout releases
+                         * the descriptor set layouts it references, which takes other locks. */
+                        released_container_ptr = std::move(current_pipeline_layout_container_ptr);
+
+                        pipeline_layouts.erase(layout_iterator);
+
+                        if (pipeline_layouts.size() == 0)
+                        {
+                            shard.pipeline_layouts.erase(pipeline_layouts_iterator);
+                        }
+                    }
+
+                    break;
+                }
+            }
         }
     }
 
     anvil_assert(has_found);
-}
\ No newline at end of file
+}
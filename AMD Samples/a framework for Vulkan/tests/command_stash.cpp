@@ -0,0 +1,386 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Checks how CommandStash places stashed objects in its memory blocks, that it runs destructors of non-trivially
+ * destructible objects exactly once, that it stops allocating memory once a command buffer is re-recorded with the same
+ * commands, and that stashed commands are reported in stashing order.
+ **/
+#include "misc/command_stash.h"
+#include "wrappers/command_buffer.h"
+#include "test_utils.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string.h>
+#include <vector>
+
+/* Heap allocations made by the test process. Lets the block reuse test check that nothing is allocated. */
+static std::atomic<uint64_t> g_n_heap_allocations(0);
+
+void* operator new(size_t in_size)
+{
+    void* result_ptr = malloc((in_size > 0) ? in_size : 1);
+
+    if (result_ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    g_n_heap_allocations.fetch_add(1);
+
+    return result_ptr;
+}
+
+void operator delete(void* in_ptr) noexcept
+{
+    free(in_ptr);
+}
+
+void operator delete(void* in_ptr, size_t) noexcept
+{
+    free(in_ptr);
+}
+
+void* operator new[](size_t in_size)
+{
+    return operator new(in_size);
+}
+
+void operator delete[](void* in_ptr) noexcept
+{
+    free(in_ptr);
+}
+
+void operator delete[](void* in_ptr, size_t) noexcept
+{
+    free(in_ptr);
+}
+
+/* Destruction log of TrackedItem instances, in destruction order. */
+static std::vector<uint32_t> g_destroyed_item_ids;
+
+typedef struct TrackedItem
+{
+    uint32_t id;
+
+    explicit TrackedItem(uint32_t in_id)
+        :id(in_id)
+    {
+        /* Stub */
+    }
+
+    TrackedItem(const TrackedItem& in_item)
+        :id(in_item.id)
+    {
+        /* Stub */
+    }
+
+    ~TrackedItem()
+    {
+        g_destroyed_item_ids.push_back(id);
+    }
+} TrackedItem;
+
+typedef struct alignas(32) WideItem
+{
+    uint8_t data[48];
+} WideItem;
+
+/** Stands in for a command descriptor, which refers to arrays stashed before it. */
+typedef struct TestCommand : public Anvil::Command
+{
+    uint32_t                              id;
+    Anvil::CommandStashArray<TrackedItem> items;
+    TrackedItem                           own_item;
+
+    TestCommand(Anvil::CommandType                    in_type,
+                uint32_t                              in_id,
+                Anvil::CommandStashArray<TrackedItem> in_items)
+        :Command (in_type),
+         id      (in_id),
+         items   (in_items),
+         own_item(in_id)
+    {
+        /* Stub */
+    }
+} TestCommand;
+
+static bool is_aligned(const void* in_ptr,
+                       size_t      in_alignment)
+{
+    return (reinterpret_cast<uintptr_t>(in_ptr) % in_alignment) == 0;
+}
+
+/** Interleaves payloads of different sizes & alignments, and checks each is aligned and holds what has been copied. */
+static void test_mixed_alignment()
+{
+    Anvil::CommandStash stash(1024);
+
+    for (uint32_t n_iteration = 0;
+                  n_iteration < 64;
+                ++n_iteration)
+    {
+        const char*    string_ptr = stash.copy_string("abc");
+        const uint8_t  bytes[]    = {1, 2, 3};
+        const double   doubles[]  = {1.5, 2.5};
+        const uint64_t raw_data   = 0x0123456789ABCDEFull + n_iteration;
+        WideItem       wide_item;
+
+        memset(wide_item.data,
+               static_cast<int>(n_iteration),
+               sizeof(wide_item.data) );
+
+        const auto  bytes_array     = stash.copy_array(bytes,   3);
+        const auto  doubles_array   = stash.copy_array(doubles, 2);
+        const void* raw_data_ptr    = stash.copy_data (&raw_data, sizeof(raw_data) );
+        const auto  wide_item_array = stash.copy_array(&wide_item, 1);
+
+        ANVIL_TEST_CHECK(strcmp(string_ptr, "abc") == 0);
+        ANVIL_TEST_CHECK(bytes_array.size() == 3 && bytes_array[2] == 3);
+
+        ANVIL_TEST_CHECK(is_aligned(doubles_array.data(), alignof(double) ));
+        ANVIL_TEST_CHECK(doubles_array.at(0) == 1.5 && doubles_array.at(1) == 2.5);
+
+        ANVIL_TEST_CHECK(is_aligned(raw_data_ptr, sizeof(uint64_t) ));
+        ANVIL_TEST_CHECK(memcmp(raw_data_ptr, &raw_data, sizeof(raw_data) ) == 0);
+
+        ANVIL_TEST_CHECK(is_aligned(wide_item_array.data(), 32) );
+        ANVIL_TEST_CHECK(wide_item_array.at(0).data[47] == static_cast<uint8_t>(n_iteration) );
+    }
+
+    /* Empty payloads do not consume any space */
+    const size_t n_bytes_used = stash.get_n_bytes_used();
+
+    ANVIL_TEST_CHECK(stash.copy_data (nullptr, 0) == nullptr);
+    ANVIL_TEST_CHECK(stash.copy_array(std::vector<uint32_t>() ).empty() );
+    ANVIL_TEST_CHECK(strcmp(stash.copy_string(nullptr), "") == 0);
+    ANVIL_TEST_CHECK(stash.get_n_bytes_used() == n_bytes_used);
+}
+
+/** Payloads which do not fit in a block get a dedicated one, and earlier payloads are left intact. */
+static void test_oversized_payloads()
+{
+    const size_t          block_size = 256;
+    Anvil::CommandStash   stash     (block_size);
+    std::vector<uint32_t> large_data(1000);
+
+    for (uint32_t n_item = 0;
+                  n_item < static_cast<uint32_t>(large_data.size() );
+                ++n_item)
+    {
+        large_data[n_item] = n_item * 3;
+    }
+
+    const char* string_before_ptr = stash.copy_string("before");
+    const auto  large_array       = stash.copy_array (large_data);
+    const char* string_after_ptr  = stash.copy_string("after");
+
+    ANVIL_TEST_CHECK(stash.get_n_bytes_reserved() >= block_size + large_data.size() * sizeof(uint32_t) );
+    ANVIL_TEST_CHECK(strcmp(string_before_ptr, "before") == 0);
+    ANVIL_TEST_CHECK(strcmp(string_after_ptr,  "after")  == 0);
+
+    if (ANVIL_TEST_CHECK(large_array.size() == large_data.size() ))
+    {
+        ANVIL_TEST_CHECK(memcmp(large_array.data(),
+                                large_data.data(),
+                                large_data.size() * sizeof(uint32_t) ) == 0);
+    }
+
+    /* After a reset, the oversized block is reused for the same request */
+    const size_t n_bytes_reserved = stash.get_n_bytes_reserved();
+
+    stash.reset();
+
+    stash.copy_string("before");
+    stash.copy_array (large_data);
+    stash.copy_string("after");
+
+    ANVIL_TEST_CHECK(stash.get_n_bytes_reserved() == n_bytes_reserved);
+}
+
+/** Stashed objects are destroyed exactly once, in reverse construction order, both by reset() and by the destructor. */
+static void test_destruction_order()
+{
+    const TrackedItem items[] = {TrackedItem(1), TrackedItem(2)};
+
+    {
+        Anvil::CommandStash stash(128);
+
+        g_destroyed_item_ids.clear();
+
+        auto items_array = stash.copy_array(items, 2);
+
+        stash.stash<TestCommand>(Anvil::COMMAND_TYPE_DRAW,
+                                 3,
+                                 items_array);
+        stash.generate_array<TrackedItem>(2,
+                                          [](uint32_t in_n_item)
+                                          {
+                                              return TrackedItem(10 + in_n_item);
+                                          });
+
+        /* Drop destructions of the generator's temporaries */
+        g_destroyed_item_ids.clear();
+
+        stash.reset();
+
+        if (ANVIL_TEST_CHECK(g_destroyed_item_ids.size() == 5) )
+        {
+            /* The command's own member goes away with the command, after the items generated later on */
+            ANVIL_TEST_CHECK(g_destroyed_item_ids[0] == 11);
+            ANVIL_TEST_CHECK(g_destroyed_item_ids[1] == 10);
+            ANVIL_TEST_CHECK(g_destroyed_item_ids[2] == 3);
+            ANVIL_TEST_CHECK(g_destroyed_item_ids[3] == 2);
+            ANVIL_TEST_CHECK(g_destroyed_item_ids[4] == 1);
+        }
+
+        ANVIL_TEST_CHECK(stash.get_n_commands() == 0);
+
+        /* A second reset must not destroy anything again */
+        stash.reset();
+
+        ANVIL_TEST_CHECK(g_destroyed_item_ids.size() == 5);
+
+        /* Objects left in the stash are destroyed with it */
+        g_destroyed_item_ids.clear();
+
+        stash.copy_array(items, 2);
+    }
+
+    if (ANVIL_TEST_CHECK(g_destroyed_item_ids.size() == 2) )
+    {
+        ANVIL_TEST_CHECK(g_destroyed_item_ids[0] == 2);
+        ANVIL_TEST_CHECK(g_destroyed_item_ids[1] == 1);
+    }
+
+    g_destroyed_item_ids.clear();
+}
+
+/** Records the same "frame" of commands over and over. After the first one, no heap memory may be allocated. */
+static void test_block_reuse()
+{
+    const uint32_t        n_commands_per_frame = 200;
+    const uint32_t        n_frames             = 8;
+    Anvil::CommandStash   stash                (512);
+    const TrackedItem     items[]              = {TrackedItem(1), TrackedItem(2), TrackedItem(3)};
+    std::vector<uint32_t> large_data           (300, 7);
+    size_t                n_bytes_reserved     = 0;
+
+    g_destroyed_item_ids.reserve(n_commands_per_frame * 8);
+
+    for (uint32_t n_frame = 0;
+                  n_frame < n_frames;
+                ++n_frame)
+    {
+        const uint64_t n_allocations_before = g_n_heap_allocations.load();
+
+        stash.reset();
+
+        g_destroyed_item_ids.clear();
+
+        for (uint32_t n_command = 0;
+                      n_command < n_commands_per_frame;
+                    ++n_command)
+        {
+            auto items_array = stash.copy_array(items, 1 + n_command % 3);
+
+            stash.copy_string("marker");
+
+            if ((n_command % 50) == 0)
+            {
+                stash.copy_array(large_data);
+            }
+
+            stash.stash<TestCommand>(Anvil::COMMAND_TYPE_DRAW,
+                                     n_command,
+                                     items_array);
+        }
+
+        if (n_frame == 0)
+        {
+            n_bytes_reserved = stash.get_n_bytes_reserved();
+        }
+        else
+        {
+            ANVIL_TEST_CHECK(g_n_heap_allocations.load()  == n_allocations_before);
+            ANVIL_TEST_CHECK(stash.get_n_bytes_reserved() == n_bytes_reserved);
+        }
+    }
+
+    stash.reset();
+
+    g_destroyed_item_ids.clear();
+}
+
+/** Commands are reported in stashing order, and the arrays they refer to stay intact. */
+static void test_command_order()
+{
+    const uint32_t      n_commands = 100;
+    Anvil::CommandStash stash      (256);
+
+    for (uint32_t n_command = 0;
+                  n_command < n_commands;
+                ++n_command)
+    {
+        const TrackedItem item(n_command * 2);
+
+        stash.stash<TestCommand>((n_command % 2 == 0) ? Anvil::COMMAND_TYPE_DRAW
+                                                      : Anvil::COMMAND_TYPE_DISPATCH,
+                                 n_command,
+                                 stash.copy_array(&item, 1) );
+    }
+
+    if (ANVIL_TEST_CHECK(stash.get_n_commands() == n_commands) )
+    {
+        for (uint32_t n_command = 0;
+                      n_command < n_commands;
+                    ++n_command)
+        {
+            const TestCommand* command_ptr = static_cast<const TestCommand*>(stash.get_command(n_command) );
+
+            ANVIL_TEST_CHECK(command_ptr                 == stash.get_commands().at(n_command) );
+            ANVIL_TEST_CHECK(command_ptr->id             == n_command);
+            ANVIL_TEST_CHECK(command_ptr->type           == ((n_command % 2 == 0) ? Anvil::COMMAND_TYPE_DRAW
+                                                                                  : Anvil::COMMAND_TYPE_DISPATCH) );
+            ANVIL_TEST_CHECK(command_ptr->items.size()   == 1);
+            ANVIL_TEST_CHECK(command_ptr->items.at(0).id == n_command * 2);
+        }
+    }
+
+    stash.reset();
+
+    ANVIL_TEST_CHECK(stash.get_n_commands() == 0);
+    ANVIL_TEST_CHECK(stash.get_commands().empty() );
+
+    g_destroyed_item_ids.clear();
+}
+
+int main()
+{
+    test_mixed_alignment   ();
+    test_oversized_payloads();
+    test_destruction_order ();
+    test_block_reuse       ();
+    test_command_order     ();
+
+    return AnvilTests::finish("command_stash");
+}
@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Checks the structural hash kept by DescriptorSetCreateInfo, which DescriptorSetLayoutManager uses to find
+ * matching layouts, and compares a hash-bucketed look-up with a linear scan over 10k create infos. The managers
+ * themselves need a device, so the test reproduces their look-up scheme: operator== only runs within the bucket
+ * the hash selects.
+ **/
+#include "misc/descriptor_set_create_info.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+typedef std::unordered_map<size_t, std::vector<const Anvil::DescriptorSetCreateInfo*> > HashToCreateInfosMap;
+
+/** Returns the @param in_n_create_info-th create info of a set of distinct create infos. Bindings are added in
+ *  descending or ascending binding index order, depending on @param in_reverse_order.
+ **/
+static Anvil::DescriptorSetCreateInfoUniquePtr create_ds_create_info(uint32_t in_n_create_info,
+                                                                     bool     in_reverse_order)
+{
+    const Anvil::DescriptorType descriptor_types[] =
+    {
+        Anvil::DescriptorType::COMBINED_IMAGE_SAMPLER,
+        Anvil::DescriptorType::STORAGE_BUFFER,
+        Anvil::DescriptorType::UNIFORM_BUFFER,
+        Anvil::DescriptorType::STORAGE_IMAGE,
+    };
+    const uint32_t                          n_bindings = 1 + in_n_create_info % 4;
+    Anvil::DescriptorSetCreateInfoUniquePtr result_ptr = Anvil::DescriptorSetCreateInfo::create();
+
+    for (uint32_t n_binding = 0;
+                  n_binding < n_bindings;
+                ++n_binding)
+    {
+        const uint32_t binding_index = (in_reverse_order) ? n_bindings - n_binding - 1
+                                                          : n_binding;
+
+        result_ptr->add_binding(binding_index,
+                                descriptor_types[(in_n_create_info / 4 + binding_index) % 4],
+                                (binding_index == 0) ? 1 + in_n_create_info / 4
+                                                     : 1,
+                                Anvil::ShaderStageFlagBits::FRAGMENT_BIT);
+    }
+
+    return result_ptr;
+}
+
+/** Finds a create info equal to @param in_create_info_ptr the way the layout managers do. */
+static const Anvil::DescriptorSetCreateInfo* find_in_map(const HashToCreateInfosMap&           in_map,
+                                                         const Anvil::DescriptorSetCreateInfo* in_create_info_ptr)
+{
+    const Anvil::DescriptorSetCreateInfo* result_ptr = nullptr;
+    auto                                  iterator   = in_map.find(in_create_info_ptr->get_hash() );
+
+    if (iterator != in_map.end() )
+    {
+        for (const auto current_create_info_ptr : iterator->second)
+        {
+            if (*current_create_info_ptr == *in_create_info_ptr)
+            {
+                result_ptr = current_create_info_ptr;
+
+                break;
+            }
+        }
+    }
+
+    return result_ptr;
+}
+
+/** Finds a create info equal to @param in_create_info_ptr by comparing it with every create info. */
+static const Anvil::DescriptorSetCreateInfo* find_linear(const std::vector<Anvil::DescriptorSetCreateInfoUniquePtr>& in_create_infos,
+                                                         const Anvil::DescriptorSetCreateInfo*                       in_create_info_ptr)
+{
+    for (const auto& current_create_info_ptr : in_create_infos)
+    {
+        if (*current_create_info_ptr == *in_create_info_ptr)
+        {
+            return current_create_info_ptr.get();
+        }
+    }
+
+    return nullptr;
+}
+
+static void create_ds_create_infos(uint32_t                                              in_n_create_infos,
+                                   std::vector<Anvil::DescriptorSetCreateInfoUniquePtr>* out_create_infos_ptr,
+                                   std::vector<Anvil::DescriptorSetCreateInfoUniquePtr>* out_queries_ptr,
+                                   HashToCreateInfosMap*                                 out_map_ptr)
+{
+    for (uint32_t n_create_info = 0;
+                  n_create_info < in_n_create_infos;
+                ++n_create_info)
+    {
+        out_create_infos_ptr->push_back(create_ds_create_info(n_create_info,
+                                                              false) ); /* in_reverse_order */
+        out_queries_ptr->push_back     (create_ds_create_info(n_create_info,
+                                                              true) ); /* in_reverse_order */
+
+        (*out_map_ptr)[out_create_infos_ptr->back()->get_hash()].push_back(out_create_infos_ptr->back().get() );
+    }
+}
+
+static void test_hash()
+{
+    const uint32_t                                       n_create_infos = 10000;
+    std::vector<Anvil::DescriptorSetCreateInfoUniquePtr> create_infos;
+    HashToCreateInfosMap                                 map;
+    uint32_t                                             n_mismatches   = 0;
+    std::vector<Anvil::DescriptorSetCreateInfoUniquePtr> queries;
+
+    create_ds_create_infos(n_create_infos,
+                          &create_infos,
+                          &queries,
+                          &map);
+
+    /* Equal create infos must hash the same, whatever order their bindings were added in */
+    for (uint32_t n_create_info = 0;
+                  n_create_info < n_create_infos;
+                ++n_create_info)
+    {
+        const Anvil::DescriptorSetCreateInfo* create_info_ptr = create_infos[n_create_info].get();
+        const Anvil::DescriptorSetCreateInfo* query_ptr       = queries     [n_create_info].get();
+
+        if (!(*query_ptr == *create_info_ptr)                          ||
+            query_ptr->get_hash()          != create_info_ptr->get_hash() ||
+            find_in_map(map, query_ptr)    != create_info_ptr)
+        {
+            ++n_mismatches;
+        }
+    }
+
+    ANVIL_TEST_CHECK(n_mismatches == 0);
+
+    /* Distinct create infos should practically never share a bucket */
+    ANVIL_TEST_CHECK(map.size() >= n_create_infos - 10);
+
+    /* The hash follows binding changes */
+    {
+        auto   create_info_ptr = create_ds_create_info(5,
+                                                       false); /* in_reverse_order */
+        size_t original_hash   = create_info_ptr->get_hash();
+
+        create_info_ptr->add_binding(7,
+                                     Anvil::DescriptorType::SAMPLER,
+                                     1, /* in_descriptor_array_size */
+                                     Anvil::ShaderStageFlagBits::VERTEX_BIT);
+
+        ANVIL_TEST_CHECK(create_info_ptr->get_hash()              != original_hash);
+        ANVIL_TEST_CHECK(find_in_map(map, create_info_ptr.get() ) == nullptr);
+    }
+}
+
+/** Looks up each of 10k create infos among 10k others. */
+static void run_benchmark()
+{
+    const uint32_t                                       n_create_infos = 10000;
+    std::vector<Anvil::DescriptorSetCreateInfoUniquePtr> create_infos;
+    HashToCreateInfosMap                                 map;
+    uint32_t                                             n_found        = 0;
+    std::vector<Anvil::DescriptorSetCreateInfoUniquePtr> queries;
+
+    create_ds_create_infos(n_create_infos,
+                          &create_infos,
+                          &queries,
+                          &map);
+
+    {
+        AnvilTests::Timer timer;
+
+        for (const auto& current_query_ptr : queries)
+        {
+            n_found += (find_in_map(map, current_query_ptr.get() ) != nullptr) ? 1 : 0;
+        }
+
+        fprintf(stdout,
+                "Hash bucket look-up: %8.2f ms for %u look-ups among %u create infos\n",
+                timer.get_elapsed_msec(),
+                n_create_infos,
+                n_create_infos);
+    }
+
+    {
+        AnvilTests::Timer timer;
+
+        for (const auto& current_query_ptr : queries)
+        {
+            n_found += (find_linear(create_infos, current_query_ptr.get() ) != nullptr) ? 1 : 0;
+        }
+
+        fprintf(stdout,
+                "Linear scan:         %8.2f ms for %u look-ups among %u create infos\n",
+                timer.get_elapsed_msec(),
+                n_create_infos,
+                n_create_infos);
+    }
+
+    ANVIL_TEST_CHECK(n_found == 2 * n_create_infos);
+}
+
+int main(int    argc,
+         char** argv)
+{
+    test_hash();
+
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+    {
+        run_benchmark();
+    }
+
+    return AnvilTests::finish("descriptor_set_create_info_hash");
+}
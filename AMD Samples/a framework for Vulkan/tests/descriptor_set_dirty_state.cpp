@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Walks binding items through the dirty & clean transitions DescriptorSet goes through as descriptors are assigned and
+ * core or template updates are issued.
+ **/
+#include "misc/descriptor_set_dirty_state.h"
+#include "test_utils.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+/** Stands in for DescriptorSet::BindingItem, which exposes the same two fields to the dirty-state functions. */
+typedef struct FakeBindingItem
+{
+    bool                  dirty;
+    Anvil::DescriptorType type_vk;
+
+    FakeBindingItem(Anvil::DescriptorType in_type_vk)
+        :dirty  (true),
+         type_vk(in_type_vk)
+    {
+        /* Stub */
+    }
+} FakeBindingItem;
+
+typedef std::vector<std::unique_ptr<FakeBindingItem> > FakeBindingItemPtrs;
+typedef std::map<uint32_t, FakeBindingItemPtrs>        FakeBindingMap;
+
+/** Mimics DescriptorSet::set_binding_array_items(): assigning a different descriptor replaces the item with a dirty one. */
+static void set_binding_item(FakeBindingMap*       inout_binding_map_ptr,
+                             uint32_t              in_n_binding,
+                             uint32_t              in_n_array_item,
+                             Anvil::DescriptorType in_type_vk)
+{
+    auto& binding_item_ptrs = (*inout_binding_map_ptr)[in_n_binding];
+
+    if (binding_item_ptrs.size() <= in_n_array_item)
+    {
+        binding_item_ptrs.resize(in_n_array_item + 1);
+    }
+
+    binding_item_ptrs.at(in_n_array_item).reset(new FakeBindingItem(in_type_vk) );
+}
+
+static bool are_all_items_clean(const FakeBindingMap& in_binding_map)
+{
+    for (const auto& current_binding : in_binding_map)
+    {
+        for (const auto& current_binding_item_ptr : current_binding.second)
+        {
+            if (current_binding_item_ptr        != nullptr &&
+                current_binding_item_ptr->dirty)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/** Bindings with no items, with items which have never been set, or with dirty items must be written. */
+static void test_is_binding_clean()
+{
+    FakeBindingItemPtrs binding_item_ptrs;
+
+    ANVIL_TEST_CHECK(!Anvil::DescriptorSetDirtyState::is_binding_clean(binding_item_ptrs) );
+
+    binding_item_ptrs.resize(2);
+    binding_item_ptrs.at(0).reset(new FakeBindingItem(Anvil::DescriptorType::SAMPLED_IMAGE) );
+
+    binding_item_ptrs.at(0)->dirty = false;
+
+    ANVIL_TEST_CHECK(!Anvil::DescriptorSetDirtyState::is_binding_clean(binding_item_ptrs) );
+
+    binding_item_ptrs.at(1).reset(new FakeBindingItem(Anvil::DescriptorType::SAMPLED_IMAGE) );
+
+    ANVIL_TEST_CHECK(!Anvil::DescriptorSetDirtyState::is_binding_clean(binding_item_ptrs) );
+
+    binding_item_ptrs.at(1)->dirty = false;
+
+    ANVIL_TEST_CHECK(Anvil::DescriptorSetDirtyState::is_binding_clean(binding_item_ptrs) );
+}
+
+/** A core update cleans every item and drops the pending IUB updates. Items assigned afterwards are dirty again, while
+ *  the other bindings stay clean, so the next update only needs to write the changed binding.
+ **/
+static void test_core_update_transitions()
+{
+    FakeBindingMap        binding_map;
+    std::vector<uint32_t> iub_binding_indices;
+
+    set_binding_item(&binding_map, 0, 0, Anvil::DescriptorType::UNIFORM_BUFFER);
+    set_binding_item(&binding_map, 1, 0, Anvil::DescriptorType::COMBINED_IMAGE_SAMPLER);
+    set_binding_item(&binding_map, 1, 1, Anvil::DescriptorType::COMBINED_IMAGE_SAMPLER);
+    set_binding_item(&binding_map, 2, 0, Anvil::DescriptorType::INLINE_UNIFORM_BLOCK);
+    set_binding_item(&binding_map, 2, 1, Anvil::DescriptorType::INLINE_UNIFORM_BLOCK);
+
+    ANVIL_TEST_CHECK(!Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(0) ));
+    ANVIL_TEST_CHECK(!Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(1) ));
+
+    iub_binding_indices.push_back(2);
+
+    Anvil::DescriptorSetDirtyState::on_core_update_issued(binding_map,
+                                                          iub_binding_indices);
+
+    ANVIL_TEST_CHECK(are_all_items_clean(binding_map) );
+    ANVIL_TEST_CHECK(Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(0) ));
+    ANVIL_TEST_CHECK(Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(1) ));
+    ANVIL_TEST_CHECK(binding_map.at(2).empty() );
+
+    /* Reassign one array item of binding 1 */
+    set_binding_item(&binding_map, 1, 1, Anvil::DescriptorType::COMBINED_IMAGE_SAMPLER);
+
+    ANVIL_TEST_CHECK( Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(0) ));
+    ANVIL_TEST_CHECK(!Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(1) ));
+    ANVIL_TEST_CHECK(!binding_map.at(1).at(0)->dirty);
+    ANVIL_TEST_CHECK( binding_map.at(1).at(1)->dirty);
+
+    /* A second update with no IUB updates pending leaves the (now empty) IUB binding alone */
+    iub_binding_indices.clear();
+
+    Anvil::DescriptorSetDirtyState::on_core_update_issued(binding_map,
+                                                          iub_binding_indices);
+
+    ANVIL_TEST_CHECK(are_all_items_clean(binding_map) );
+    ANVIL_TEST_CHECK(Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(1) ));
+    ANVIL_TEST_CHECK(binding_map.size() == 3);
+}
+
+/** Only the IUB bindings reported by the core update are dropped. Null items, which have never been set, are kept. */
+static void test_core_update_keeps_unreported_bindings()
+{
+    FakeBindingMap        binding_map;
+    std::vector<uint32_t> iub_binding_indices;
+
+    set_binding_item(&binding_map, 0, 0, Anvil::DescriptorType::INLINE_UNIFORM_BLOCK);
+    set_binding_item(&binding_map, 1, 0, Anvil::DescriptorType::INLINE_UNIFORM_BLOCK);
+    set_binding_item(&binding_map, 2, 2, Anvil::DescriptorType::STORAGE_IMAGE);
+
+    iub_binding_indices.push_back(1);
+
+    Anvil::DescriptorSetDirtyState::on_core_update_issued(binding_map,
+                                                          iub_binding_indices);
+
+    ANVIL_TEST_CHECK(binding_map.at(0).size() == 1);
+    ANVIL_TEST_CHECK(binding_map.at(1).empty() );
+    ANVIL_TEST_CHECK(binding_map.at(2).size() == 3);
+    ANVIL_TEST_CHECK(binding_map.at(2).at(0) == nullptr);
+    ANVIL_TEST_CHECK(!binding_map.at(2).at(2)->dirty);
+
+    /* The binding still has items which have never been set, so it is not clean */
+    ANVIL_TEST_CHECK(!Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(2) ));
+}
+
+/** A template update cleans every item, and drops items of any binding which holds IUB updates. */
+static void test_template_update_transitions()
+{
+    FakeBindingMap binding_map;
+
+    set_binding_item(&binding_map, 0, 0, Anvil::DescriptorType::STORAGE_BUFFER);
+    set_binding_item(&binding_map, 0, 1, Anvil::DescriptorType::STORAGE_BUFFER);
+    set_binding_item(&binding_map, 3, 0, Anvil::DescriptorType::INLINE_UNIFORM_BLOCK);
+
+    Anvil::DescriptorSetDirtyState::on_template_update_issued(binding_map);
+
+    ANVIL_TEST_CHECK(are_all_items_clean(binding_map) );
+    ANVIL_TEST_CHECK(Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(0) ));
+    ANVIL_TEST_CHECK(binding_map.at(3).empty() );
+
+    set_binding_item(&binding_map, 0, 0, Anvil::DescriptorType::STORAGE_BUFFER);
+
+    ANVIL_TEST_CHECK(!Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(0) ));
+
+    Anvil::DescriptorSetDirtyState::on_template_update_issued(binding_map);
+
+    ANVIL_TEST_CHECK(Anvil::DescriptorSetDirtyState::is_binding_clean(binding_map.at(0) ));
+}
+
+int main()
+{
+    test_is_binding_clean                     ();
+    test_core_update_transitions              ();
+    test_core_update_keeps_unreported_bindings();
+    test_template_update_transitions          ();
+
+    return AnvilTests::finish("descriptor_set_dirty_state");
+}
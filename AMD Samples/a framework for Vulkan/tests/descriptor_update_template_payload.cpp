@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Checks how DescriptorUpdateTemplatePayload lays out descriptors, and how it folds runs of updated array elements
+ * into template entries.
+ **/
+#include "misc/descriptor_update_template_payload.h"
+#include "test_utils.h"
+#include <string.h>
+
+static bool check_entry(const Anvil::DescriptorUpdateTemplateEntry& in_entry,
+                        Anvil::DescriptorType                       in_descriptor_type,
+                        uint32_t                                    in_n_binding,
+                        uint32_t                                    in_n_array_element,
+                        uint32_t                                    in_n_descriptors,
+                        size_t                                      in_offset,
+                        size_t                                      in_stride)
+{
+    return in_entry.descriptor_type             == in_descriptor_type &&
+           in_entry.n_destination_binding       == in_n_binding       &&
+           in_entry.n_destination_array_element == in_n_array_element &&
+           in_entry.n_descriptors               == in_n_descriptors   &&
+           in_entry.offset                      == in_offset          &&
+           in_entry.stride                      == in_stride;
+}
+
+static void test_empty_payload()
+{
+    Anvil::DescriptorUpdateTemplatePayload payload;
+
+    ANVIL_TEST_CHECK(payload.is_empty      () );
+    ANVIL_TEST_CHECK(payload.get_data      () == nullptr);
+    ANVIL_TEST_CHECK(payload.get_data_size () == 0);
+    ANVIL_TEST_CHECK(payload.get_entries   ().empty() );
+}
+
+/** Descriptors are stored in the order they are appended, each at an 8-byte aligned offset. */
+static void test_payload_layout()
+{
+    Anvil::DescriptorUpdateTemplatePayload payload;
+    const uint32_t                         values[] = {0x11111111, 0x22222222, 0x33333333};
+
+    memcpy(payload.append(Anvil::DescriptorType::UNIFORM_BUFFER, 0, 0, sizeof(VkDescriptorBufferInfo) ),
+          &values[0],
+           sizeof(values[0]) );
+    memcpy(payload.append(Anvil::DescriptorType::UNIFORM_TEXEL_BUFFER, 1, 0, 4),
+          &values[1],
+           sizeof(values[1]) );
+    memcpy(payload.append(Anvil::DescriptorType::SAMPLED_IMAGE, 2, 0, sizeof(VkDescriptorImageInfo) ),
+          &values[2],
+           sizeof(values[2]) );
+
+    const auto& entries = payload.get_entries();
+
+    ANVIL_TEST_CHECK(!payload.is_empty() );
+
+    if (ANVIL_TEST_CHECK(entries.size() == 3) )
+    {
+        const size_t image_info_offset = Anvil::Utils::round_up(sizeof(VkDescriptorBufferInfo) + 4,
+                                                                static_cast<size_t>(8) );
+
+        ANVIL_TEST_CHECK(check_entry(entries[0], Anvil::DescriptorType::UNIFORM_BUFFER,       0, 0, 1, 0,                              sizeof(VkDescriptorBufferInfo) ));
+        ANVIL_TEST_CHECK(check_entry(entries[1], Anvil::DescriptorType::UNIFORM_TEXEL_BUFFER, 1, 0, 1, sizeof(VkDescriptorBufferInfo), 4) );
+        ANVIL_TEST_CHECK(check_entry(entries[2], Anvil::DescriptorType::SAMPLED_IMAGE,        2, 0, 1, image_info_offset,              sizeof(VkDescriptorImageInfo) ));
+
+        ANVIL_TEST_CHECK(payload.get_data_size() == image_info_offset + sizeof(VkDescriptorImageInfo) );
+
+        for (uint32_t n_entry = 0;
+                      n_entry < 3;
+                    ++n_entry)
+        {
+            uint32_t stored_value = 0;
+
+            memcpy(&stored_value,
+                    static_cast<const uint8_t*>(payload.get_data() ) + entries[n_entry].offset,
+                    sizeof(stored_value) );
+
+            ANVIL_TEST_CHECK(entries[n_entry].offset % 8 == 0);
+            ANVIL_TEST_CHECK(stored_value                == values[n_entry]);
+        }
+    }
+
+    /* clear() drops everything */
+    payload.clear();
+
+    ANVIL_TEST_CHECK(payload.is_empty     () );
+    ANVIL_TEST_CHECK(payload.get_data_size() == 0);
+}
+
+/** Appends one descriptor for each dirty element of a binding array, the way DescriptorSet does when it packs a
+ *  template update, and checks that each run of consecutive dirty elements ends up in a single entry.
+ **/
+static void test_dirty_range_coalescing()
+{
+    Anvil::DescriptorUpdateTemplatePayload payload;
+    const bool                             is_element_dirty[] = {true, true, true, false, true, true, false, false, true};
+    const uint32_t                         n_elements         = sizeof(is_element_dirty) / sizeof(is_element_dirty[0]);
+    const size_t                           stride             = sizeof(VkDescriptorImageInfo);
+
+    for (uint32_t n_element = 0;
+                  n_element < n_elements;
+                ++n_element)
+    {
+        if (is_element_dirty[n_element])
+        {
+            payload.append(Anvil::DescriptorType::COMBINED_IMAGE_SAMPLER,
+                           3, /* in_n_binding */
+                           n_element,
+                           stride);
+        }
+    }
+
+    const auto& entries = payload.get_entries();
+
+    if (ANVIL_TEST_CHECK(entries.size() == 3) )
+    {
+        ANVIL_TEST_CHECK(check_entry(entries[0], Anvil::DescriptorType::COMBINED_IMAGE_SAMPLER, 3, 0, 3, 0,          stride) );
+        ANVIL_TEST_CHECK(check_entry(entries[1], Anvil::DescriptorType::COMBINED_IMAGE_SAMPLER, 3, 4, 2, 3 * stride, stride) );
+        ANVIL_TEST_CHECK(check_entry(entries[2], Anvil::DescriptorType::COMBINED_IMAGE_SAMPLER, 3, 8, 1, 5 * stride, stride) );
+    }
+
+    ANVIL_TEST_CHECK(payload.get_data_size() == 6 * stride);
+}
+
+/** Descriptors which directly follow each other are only folded if they also share the binding, the descriptor type
+ *  and the size, if their size keeps them tightly packed, and if the caller allows it.
+ **/
+static void test_merge_conditions()
+{
+    Anvil::DescriptorUpdateTemplatePayload payload;
+
+    /* Different binding */
+    payload.append(Anvil::DescriptorType::STORAGE_BUFFER, 0, 0, sizeof(VkDescriptorBufferInfo) );
+    payload.append(Anvil::DescriptorType::STORAGE_BUFFER, 1, 1, sizeof(VkDescriptorBufferInfo) );
+
+    /* Different descriptor type */
+    payload.append(Anvil::DescriptorType::UNIFORM_BUFFER, 1, 2, sizeof(VkDescriptorBufferInfo) );
+
+    ANVIL_TEST_CHECK(payload.get_entries().size() == 3);
+
+    /* Sizes which are not a multiple of 8 leave gaps between the descriptors, so they cannot share a stride */
+    payload.clear();
+
+    payload.append(Anvil::DescriptorType::UNIFORM_BUFFER, 0, 0, 12);
+    payload.append(Anvil::DescriptorType::UNIFORM_BUFFER, 0, 1, 12);
+
+    ANVIL_TEST_CHECK(payload.get_entries().size() == 2);
+
+    /* Descriptors which must not be merged get entries of their own, and nothing is merged into them */
+    payload.clear();
+
+    payload.append(Anvil::DescriptorType::INLINE_UNIFORM_BLOCK, 0, 0,  16, false);
+    payload.append(Anvil::DescriptorType::INLINE_UNIFORM_BLOCK, 0, 16, 16, false);
+    payload.append(Anvil::DescriptorType::INLINE_UNIFORM_BLOCK, 0, 32, 16);
+
+    ANVIL_TEST_CHECK(payload.get_entries().size() == 3);
+}
+
+int main()
+{
+    test_empty_payload         ();
+    test_payload_layout        ();
+    test_dirty_range_coalescing();
+    test_merge_conditions      ();
+
+    return AnvilTests::finish("descriptor_update_template_payload");
+}
@@ -0,0 +1,310 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Checks the bulk FP16 <-> FP32 conversion functions against the scalar reference implementations for all 65,536
+ * half-precision values, and measures their throughput.
+ **/
+#include "misc/fp16.h"
+#include "test_utils.h"
+#include <string.h>
+#include <vector>
+
+static bool is_fp16_nan(uint16_t in_value)
+{
+    return (in_value & 0x7C00) == 0x7C00 &&
+           (in_value & 0x03FF) != 0;
+}
+
+static bool is_fp32_nan(uint32_t in_value)
+{
+    return (in_value & 0x7F800000) == 0x7F800000 &&
+           (in_value & 0x007FFFFF) != 0;
+}
+
+/** Converts every half-precision value to FP32 and back. */
+static void test_all_fp16_values()
+{
+    std::vector<Anvil::float16_t> fp16_values     (65536);
+    std::vector<Anvil::float16_t> fp16_values_back(65536);
+    std::vector<Anvil::float32_t> fp32_values     (65536);
+
+    for (uint32_t n_value = 0;
+                  n_value < 65536;
+                ++n_value)
+    {
+        fp16_values[n_value].u = static_cast<uint16_t>(n_value);
+    }
+
+    Anvil::Utils::fp16_to_fp32_array(&fp16_values.at(0),
+                                     fp16_values.size(),
+                                    &fp32_values.at(0) );
+
+    for (uint32_t n_value = 0;
+                  n_value < 65536;
+                ++n_value)
+    {
+        const uint32_t reference = Anvil::Utils::fp16_to_fp32_full(fp16_values[n_value]).u;
+        const uint32_t result    = fp32_values[n_value].u;
+
+        if (is_fp16_nan(static_cast<uint16_t>(n_value) ))
+        {
+            /* NaNs are quieted, the sign and the payload are kept */
+            ANVIL_TEST_CHECK(is_fp32_nan(result) );
+            ANVIL_TEST_CHECK(result == (reference | 0x00400000) );
+        }
+        else
+        {
+            ANVIL_TEST_CHECK(result == reference);
+        }
+    }
+
+    Anvil::Utils::fp32_to_fp16_array_rtne(&fp32_values.at(0),
+                                          fp32_values.size(),
+                                         &fp16_values_back.at(0) );
+
+    for (uint32_t n_value = 0;
+                  n_value < 65536;
+                ++n_value)
+    {
+        const uint16_t result = fp16_values_back[n_value].u;
+
+        if (is_fp16_nan(static_cast<uint16_t>(n_value) ))
+        {
+            ANVIL_TEST_CHECK(result == (n_value | 0x0200) );
+        }
+        else
+        {
+            ANVIL_TEST_CHECK(result == n_value);
+            ANVIL_TEST_CHECK(result == Anvil::Utils::fp32_to_fp16_full_rtne(fp32_values[n_value]).u);
+        }
+    }
+}
+
+/** Checks FP32 values which lie between two consecutive half-precision values: the midpoint, which must round to
+ *  the even neighbour, and the FP32 values directly above and below it.
+ **/
+static void test_rounding()
+{
+    std::vector<Anvil::float32_t> fp32_values;
+    std::vector<Anvil::float16_t> fp16_values;
+
+    for (uint32_t n_value = 0;
+                  n_value < 0x7C00;
+                ++n_value)
+    {
+        Anvil::float16_t lower;
+        Anvil::float16_t upper;
+
+        lower.u = static_cast<uint16_t>(n_value);
+        upper.u = static_cast<uint16_t>(n_value + 1);
+
+        for (uint32_t n_sign = 0;
+                      n_sign < 2;
+                    ++n_sign)
+        {
+            Anvil::float32_t midpoint;
+
+            midpoint.f = (Anvil::Utils::fp16_to_fp32_full(lower).f + Anvil::Utils::fp16_to_fp32_full(upper).f) * 0.5f;
+
+            if (n_sign == 1)
+            {
+                midpoint.f = -midpoint.f;
+            }
+
+            fp32_values.push_back(midpoint);
+
+            midpoint.u -= 1;
+            fp32_values.push_back(midpoint);
+
+            midpoint.u += 2;
+            fp32_values.push_back(midpoint);
+        }
+    }
+
+    /* FP32 denormals, which flush to signed zero, and values too large for FP16 */
+    const uint32_t special_values[] =
+    {
+        0x00000001, 0x807FFFFF, 0x477FF000, 0x477FEFFF, 0xC77FF000, 0x7F7FFFFF, 0x7F800000, 0xFF800000
+    };
+
+    for (const auto& current_value : special_values)
+    {
+        Anvil::float32_t value;
+
+        value.u = current_value;
+
+        fp32_values.push_back(value);
+    }
+
+    fp16_values.resize(fp32_values.size() );
+
+    Anvil::Utils::fp32_to_fp16_array_rtne(&fp32_values.at(0),
+                                          fp32_values.size(),
+                                         &fp16_values.at(0) );
+
+    for (size_t n_value = 0;
+                n_value < fp32_values.size();
+              ++n_value)
+    {
+        ANVIL_TEST_CHECK(fp16_values[n_value].u == Anvil::Utils::fp32_to_fp16_full_rtne(fp32_values[n_value]).u);
+    }
+}
+
+/** Checks that array lengths which do not fill a whole SIMD register, and unaligned arrays, are converted in full. */
+static void test_array_tails()
+{
+    std::vector<Anvil::float16_t> fp16_values(40);
+    std::vector<Anvil::float32_t> fp32_values(41);
+
+    for (uint32_t n_values = 0;
+                  n_values < 33;
+                ++n_values)
+    {
+        for (auto& current_value : fp32_values)
+        {
+            current_value.u = 0xDEADBEEF;
+        }
+
+        for (uint32_t n_value = 0;
+                      n_value < n_values;
+                    ++n_value)
+        {
+            fp16_values[n_value + 1].u = static_cast<uint16_t>(0x3C00 + n_value);
+        }
+
+        Anvil::Utils::fp16_to_fp32_array(&fp16_values.at(1),
+                                         n_values,
+                                        &fp32_values.at(1) );
+
+        for (uint32_t n_value = 0;
+                      n_value < n_values;
+                    ++n_value)
+        {
+            ANVIL_TEST_CHECK(fp32_values[n_value + 1].u == Anvil::Utils::fp16_to_fp32_full(fp16_values[n_value + 1]).u);
+        }
+
+        ANVIL_TEST_CHECK(fp32_values[0].u            == 0xDEADBEEF);
+        ANVIL_TEST_CHECK(fp32_values[n_values + 1].u == 0xDEADBEEF);
+    }
+}
+
+/** Compares the throughput of the bulk functions against per-value calls to the scalar functions. */
+static void run_benchmark()
+{
+    const uint32_t                n_values      = 16 * 1024 * 1024;
+    std::vector<Anvil::float16_t> fp16_values   (n_values);
+    std::vector<Anvil::float32_t> fp32_values   (n_values);
+    uint32_t                      checksum      = 0;
+
+    for (uint32_t n_value = 0;
+                  n_value < n_values;
+                ++n_value)
+    {
+        /* Skip Inf & NaNs, to keep the scalar paths on their common code path */
+        fp16_values[n_value].u = static_cast<uint16_t>((n_value * 2654435761u) >> 16) & 0xBBFF;
+    }
+
+    {
+        AnvilTests::Timer timer;
+
+        for (uint32_t n_value = 0;
+                      n_value < n_values;
+                    ++n_value)
+        {
+            fp32_values[n_value] = Anvil::Utils::fp16_to_fp32_full(fp16_values[n_value]);
+        }
+
+        fprintf(stdout,
+                "fp16_to_fp32_full():       %8.2f ms for %u values\n",
+                timer.get_elapsed_msec(),
+                n_values);
+    }
+
+    {
+        AnvilTests::Timer timer;
+
+        Anvil::Utils::fp16_to_fp32_array(&fp16_values.at(0),
+                                         n_values,
+                                        &fp32_values.at(0) );
+
+        fprintf(stdout,
+                "fp16_to_fp32_array():      %8.2f ms for %u values\n",
+                timer.get_elapsed_msec(),
+                n_values);
+    }
+
+    {
+        AnvilTests::Timer timer;
+
+        for (uint32_t n_value = 0;
+                      n_value < n_values;
+                    ++n_value)
+        {
+            fp16_values[n_value] = Anvil::Utils::fp32_to_fp16_full_rtne(fp32_values[n_value]);
+        }
+
+        fprintf(stdout,
+                "fp32_to_fp16_full_rtne():  %8.2f ms for %u values\n",
+                timer.get_elapsed_msec(),
+                n_values);
+    }
+
+    {
+        AnvilTests::Timer timer;
+
+        Anvil::Utils::fp32_to_fp16_array_rtne(&fp32_values.at(0),
+                                              n_values,
+                                             &fp16_values.at(0) );
+
+        fprintf(stdout,
+                "fp32_to_fp16_array_rtne(): %8.2f ms for %u values\n",
+                timer.get_elapsed_msec(),
+                n_values);
+    }
+
+    /* Keep the compiler from dropping the conversions */
+    for (uint32_t n_value = 0;
+                  n_value < n_values;
+                n_value += 4096)
+    {
+        checksum += fp16_values[n_value].u;
+    }
+
+    fprintf(stdout,
+            "Checksum: %u\n",
+            checksum);
+}
+
+int main(int    argc,
+         char** argv)
+{
+    test_all_fp16_values();
+    test_rounding       ();
+    test_array_tails    ();
+
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+    {
+        run_benchmark();
+    }
+
+    return AnvilTests::finish("fp16");
+}
@@ -0,0 +1,198 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Checks that the per-resource-set cache of glslang's context-specific built-ins hands each compile the built-ins
+ * for its own resources, and keeps the parser's edits of those private to each compile. The benchmark compares
+ * the first compile with a new set of resources (cold) against later compiles with the same resources (warm).
+ **/
+#include "glslang/glslang/Public/ShaderLang.h"
+#include "StandAlone/ResourceLimits.h"
+#include "test_utils.h"
+#include <string.h>
+
+/** Shader which only compiles if gl_MaxDrawBuffers equals 8. Negative array sizes are compile-time errors. */
+static const char* g_fs_expecting_8_draw_buffers =
+    "#version 450\n"
+    "\n"
+    "layout(location = 0) out vec4 result;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    float check[(gl_MaxDrawBuffers == 8) ? 1 : -1];\n"
+    "\n"
+    "    check[0] = 1.0;\n"
+    "    result   = vec4(check[0]);\n"
+    "}\n";
+
+/** As above, for gl_MaxDrawBuffers equal to 4. */
+static const char* g_fs_expecting_4_draw_buffers =
+    "#version 450\n"
+    "\n"
+    "layout(location = 0) out vec4 result;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    float check[(gl_MaxDrawBuffers == 4) ? 1 : -1];\n"
+    "\n"
+    "    check[0] = 1.0;\n"
+    "    result   = vec4(check[0]);\n"
+    "}\n";
+
+/* Geometry shaders which only compile if gl_in has been sized by the input primitive type. The parser sizes gl_in,
+ * which is one of the context-specific built-ins, in place. */
+static const char* g_gs_triangles =
+    "#version 450\n"
+    "\n"
+    "layout(triangles)                     in;\n"
+    "layout(points, max_vertices = 1)      out;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    float check[(gl_in.length() == 3) ? 1 : -1];\n"
+    "\n"
+    "    check[0]    = 1.0;\n"
+    "    gl_Position = gl_in[0].gl_Position * check[0];\n"
+    "\n"
+    "    EmitVertex();\n"
+    "}\n";
+
+static const char* g_gs_lines =
+    "#version 450\n"
+    "\n"
+    "layout(lines)                         in;\n"
+    "layout(points, max_vertices = 1)      out;\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    float check[(gl_in.length() == 2) ? 1 : -1];\n"
+    "\n"
+    "    check[0]    = 1.0;\n"
+    "    gl_Position = gl_in[0].gl_Position * check[0];\n"
+    "\n"
+    "    EmitVertex();\n"
+    "}\n";
+
+static bool compile(EShLanguage             in_stage,
+                    const char*             in_source_ptr,
+                    const TBuiltInResource& in_resources)
+{
+    glslang::TShader shader(in_stage);
+
+    shader.setStrings(&in_source_ptr,
+                      1);
+
+    return shader.parse(&in_resources,
+                        450,   /* defaultVersion    */
+                        false, /* forwardCompatible */
+                        EShMsgDefault);
+}
+
+/** Compiles shaders with two sets of resources, switching back & forth, so that both cold and cached built-ins
+ *  are used.
+ **/
+static void test_resource_sets()
+{
+    TBuiltInResource resources_8_draw_buffers = glslang::DefaultTBuiltInResource;
+    TBuiltInResource resources_4_draw_buffers = glslang::DefaultTBuiltInResource;
+
+    resources_8_draw_buffers.maxDrawBuffers = 8;
+    resources_4_draw_buffers.maxDrawBuffers = 4;
+
+    for (uint32_t n_iteration = 0;
+                  n_iteration < 2;
+                ++n_iteration)
+    {
+        ANVIL_TEST_CHECK( compile(EShLangFragment, g_fs_expecting_8_draw_buffers, resources_8_draw_buffers) );
+        ANVIL_TEST_CHECK(!compile(EShLangFragment, g_fs_expecting_4_draw_buffers, resources_8_draw_buffers) );
+        ANVIL_TEST_CHECK( compile(EShLangFragment, g_fs_expecting_4_draw_buffers, resources_4_draw_buffers) );
+        ANVIL_TEST_CHECK(!compile(EShLangFragment, g_fs_expecting_8_draw_buffers, resources_4_draw_buffers) );
+    }
+}
+
+/** Sizing gl_in in one compile must not leak into later compiles which use the same cached built-ins. */
+static void test_private_built_in_edits()
+{
+    for (uint32_t n_iteration = 0;
+                  n_iteration < 2;
+                ++n_iteration)
+    {
+        ANVIL_TEST_CHECK(compile(EShLangGeometry, g_gs_triangles, glslang::DefaultTBuiltInResource) );
+        ANVIL_TEST_CHECK(compile(EShLangGeometry, g_gs_lines,     glslang::DefaultTBuiltInResource) );
+    }
+}
+
+static void run_benchmark()
+{
+    const uint32_t   n_warm_compiles = 100;
+    TBuiltInResource resources       = glslang::DefaultTBuiltInResource;
+
+    /* Use resources no earlier compile has used, so that the first compile has to generate the built-ins */
+    resources.maxDrawBuffers = 6;
+
+    {
+        AnvilTests::Timer timer;
+
+        compile(EShLangFragment,
+                g_fs_expecting_8_draw_buffers,
+                resources);
+
+        fprintf(stdout,
+                "Cold compile: %8.3f ms\n",
+                timer.get_elapsed_msec() );
+    }
+
+    {
+        AnvilTests::Timer timer;
+
+        for (uint32_t n_compile = 0;
+                      n_compile < n_warm_compiles;
+                    ++n_compile)
+        {
+            compile(EShLangFragment,
+                    g_fs_expecting_8_draw_buffers,
+                    resources);
+        }
+
+        fprintf(stdout,
+                "Warm compile: %8.3f ms on average over %u compiles\n",
+                timer.get_elapsed_msec() / n_warm_compiles,
+                n_warm_compiles);
+    }
+}
+
+int main(int    argc,
+         char** argv)
+{
+    glslang::InitializeProcess();
+    {
+        test_resource_sets         ();
+        test_private_built_in_edits();
+
+        if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+        {
+            run_benchmark();
+        }
+    }
+    glslang::FinalizeProcess();
+
+    return AnvilTests::finish("glslang_context_symbol_tables");
+}
@@ -0,0 +1,418 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Checks that ObjectTracker keeps its per-type object lists & counters consistent when objects are unregistered out
+ * of order, and when many threads register and unregister objects at the same time. Also checks that objects visited
+ * under the tracker's lock cannot be released meanwhile. The benchmark measures how long it takes to register and
+ * unregister objects from several threads.
+ **/
+#include "misc/object_tracker.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+/** Returns a unique fake object pointer. The tracker never dereferences the pointers it is given. */
+static void* get_fake_object_ptr(uint32_t in_n_thread,
+                                 uint32_t in_n_object)
+{
+    return reinterpret_cast<void*>( (static_cast<uintptr_t>(in_n_thread + 1) << 24) + (static_cast<uintptr_t>(in_n_object + 1) << 4) );
+}
+
+/** Collects all alive objects of the specified type, in the order visit_alive_objects() visits them. */
+static std::vector<void*> get_alive_objects(const Anvil::ObjectType& in_object_type)
+{
+    std::vector<void*> result;
+
+    Anvil::ObjectTracker::get()->visit_alive_objects(in_object_type,
+        [&result](const void* in_object_ptr)
+        {
+            result.push_back(const_cast<void*>(in_object_ptr) );
+
+            return true;
+        });
+
+    return result;
+}
+
+/** Registers objects, releases them in random order and checks that visit_alive_objects() always visits the
+ *  remaining objects in registration order.
+ **/
+static void test_out_of_order_unregistration()
+{
+    const uint32_t        n_objects          = 1000;
+    Anvil::ObjectTracker* object_tracker_ptr = Anvil::ObjectTracker::get();
+    std::vector<void*>    alive_object_ptrs;
+    std::vector<void*>    expected_object_ptrs;
+    std::mt19937          random_generator   (1234);
+    std::vector<void*>    release_order;
+
+    for (uint32_t n_object = 0;
+                  n_object < n_objects;
+                ++n_object)
+    {
+        void* object_ptr = get_fake_object_ptr(0, n_object);
+
+        object_tracker_ptr->register_object(Anvil::ObjectType::BUFFER,
+                                            object_ptr);
+
+        expected_object_ptrs.push_back(object_ptr);
+    }
+
+    release_order = expected_object_ptrs;
+
+    std::shuffle(release_order.begin(),
+                 release_order.end  (),
+                 random_generator);
+
+    for (uint32_t n_object = 0;
+                  n_object < n_objects;
+                ++n_object)
+    {
+        object_tracker_ptr->unregister_object(Anvil::ObjectType::BUFFER,
+                                              release_order[n_object]);
+
+        expected_object_ptrs.erase(std::find(expected_object_ptrs.begin(),
+                                             expected_object_ptrs.end  (),
+                                             release_order[n_object]) );
+
+        /* Comparing the whole list after each release is quadratic, so only do it every now and then */
+        if ((n_object % 97) == 0)
+        {
+            alive_object_ptrs = get_alive_objects(Anvil::ObjectType::BUFFER);
+
+            ANVIL_TEST_CHECK(alive_object_ptrs == expected_object_ptrs);
+        }
+
+        ANVIL_TEST_CHECK(object_tracker_ptr->get_n_alive_objects(Anvil::ObjectType::BUFFER) == n_objects - n_object - 1);
+    }
+
+    ANVIL_TEST_CHECK(object_tracker_ptr->get_object_at_index(Anvil::ObjectType::BUFFER, 0) == nullptr);
+}
+
+/** Every thread registers & unregisters objects of its own type, plus objects of a type shared by all threads.
+ *  Meanwhile, the main thread keeps taking snapshots of the shared type, which must never contain duplicates.
+ **/
+static void test_concurrent_registration()
+{
+    const Anvil::ObjectType thread_object_types[] =
+    {
+        Anvil::ObjectType::IMAGE,
+        Anvil::ObjectType::IMAGE_VIEW,
+        Anvil::ObjectType::SAMPLER,
+        Anvil::ObjectType::FENCE,
+    };
+    const uint32_t                                  n_iterations       = 20000;
+    const uint32_t                                  n_threads          = sizeof(thread_object_types) / sizeof(thread_object_types[0]);
+    Anvil::ObjectTracker*                           object_tracker_ptr = Anvil::ObjectTracker::get();
+    std::atomic<uint32_t>                           n_threads_done     (0);
+    std::vector<Anvil::ObjectTracker::TypeSnapshot> snapshot;
+    std::vector<std::thread>                        threads;
+
+    for (uint32_t n_thread = 0;
+                  n_thread < n_threads;
+                ++n_thread)
+    {
+        threads.push_back(std::thread(
+            [&, n_thread]()
+            {
+                const uint32_t n_objects_held = 16;
+
+                for (uint32_t n_iteration = 0;
+                              n_iteration < n_iterations;
+                            ++n_iteration)
+                {
+                    void* object_ptr = get_fake_object_ptr(n_thread, n_iteration);
+
+                    object_tracker_ptr->register_object(thread_object_types[n_thread],
+                                                        object_ptr);
+                    object_tracker_ptr->register_object(Anvil::ObjectType::SEMAPHORE,
+                                                        object_ptr);
+
+                    /* Keep a few objects alive, so that releases happen out of registration order */
+                    if (n_iteration >= n_objects_held)
+                    {
+                        void* released_object_ptr = get_fake_object_ptr(n_thread, n_iteration - n_objects_held);
+
+                        object_tracker_ptr->unregister_object(thread_object_types[n_thread],
+                                                              released_object_ptr);
+                        object_tracker_ptr->unregister_object(Anvil::ObjectType::SEMAPHORE,
+                                                              released_object_ptr);
+                    }
+                }
+
+                for (uint32_t n_iteration = n_iterations - n_objects_held;
+                              n_iteration < n_iterations;
+                            ++n_iteration)
+                {
+                    object_tracker_ptr->unregister_object(thread_object_types[n_thread],
+                                                          get_fake_object_ptr(n_thread, n_iteration) );
+                    object_tracker_ptr->unregister_object(Anvil::ObjectType::SEMAPHORE,
+                                                          get_fake_object_ptr(n_thread, n_iteration) );
+                }
+
+                n_threads_done.fetch_add(1);
+            }) );
+    }
+
+    while (n_threads_done.load() < n_threads)
+    {
+        std::vector<void*> alive_object_ptrs = get_alive_objects(Anvil::ObjectType::SEMAPHORE);
+
+        std::sort(alive_object_ptrs.begin(),
+                  alive_object_ptrs.end  () );
+
+        ANVIL_TEST_CHECK(std::adjacent_find(alive_object_ptrs.begin(),
+                                            alive_object_ptrs.end  () ) == alive_object_ptrs.end() );
+        ANVIL_TEST_CHECK(alive_object_ptrs.size() <= (16 + 1) * n_threads);
+    }
+
+    for (auto& current_thread : threads)
+    {
+        current_thread.join();
+    }
+
+    object_tracker_ptr->get_snapshot(true, /* in_include_object_ptrs */
+                                    &snapshot);
+
+    for (const auto& current_type_snapshot : snapshot)
+    {
+        if (current_type_snapshot.object_type != Anvil::ObjectType::SEMAPHORE &&
+            std::find(thread_object_types,
+                      thread_object_types + n_threads,
+                      current_type_snapshot.object_type) == thread_object_types + n_threads)
+        {
+            continue;
+        }
+
+        ANVIL_TEST_CHECK(current_type_snapshot.n_alive_objects == 0);
+        ANVIL_TEST_CHECK(current_type_snapshot.alive_object_ptrs.empty() );
+        ANVIL_TEST_CHECK(current_type_snapshot.n_created_objects == ((current_type_snapshot.object_type == Anvil::ObjectType::SEMAPHORE) ? n_threads * n_iterations
+                                                                                                                                           : n_iterations) );
+    }
+}
+
+/** Mimics a wrapper object: it registers itself on construction and unregisters itself before its contents are
+ *  released.
+ **/
+class TrackedObject
+{
+public:
+    explicit TrackedObject(uint32_t in_value)
+        :m_value(new uint32_t(in_value) )
+    {
+        Anvil::ObjectTracker::get()->register_object(Anvil::ObjectType::SHADER_MODULE,
+                                                     this);
+    }
+
+    ~TrackedObject()
+    {
+        Anvil::ObjectTracker::get()->unregister_object(Anvil::ObjectType::SHADER_MODULE,
+                                                       this);
+
+        *m_value = 0xDEADBEEF;
+        delete m_value;
+    }
+
+    uint32_t get_value() const
+    {
+        return *m_value;
+    }
+
+private:
+    uint32_t* m_value;
+};
+
+/** Checks that visit_alive_objects() visits objects in registration order, stops when asked to, and that objects
+ *  released by another thread are never accessed by the visitor after their release has started.
+ **/
+static void test_visit_alive_objects()
+{
+    const uint32_t              n_objects          = 64;
+    const uint32_t              n_releases         = 20000;
+    Anvil::ObjectTracker*       object_tracker_ptr = Anvil::ObjectTracker::get();
+    std::atomic<bool>           releaser_done      (false);
+    std::vector<TrackedObject*> objects;
+    uint32_t                    n_visited_objects  = 0;
+    std::vector<uint32_t>       visited_values;
+
+    for (uint32_t n_object = 0;
+                  n_object < n_objects;
+                ++n_object)
+    {
+        objects.push_back(new TrackedObject(n_object + 1) );
+    }
+
+    object_tracker_ptr->visit_alive_objects(Anvil::ObjectType::SHADER_MODULE,
+                                            [&](const void* in_object_ptr) -> bool
+                                            {
+                                                visited_values.push_back(reinterpret_cast<const TrackedObject*>(in_object_ptr)->get_value() );
+
+                                                return true;
+                                            });
+
+    ANVIL_TEST_CHECK(visited_values.size() == n_objects);
+
+    for (uint32_t n_object = 0;
+                  n_object < static_cast<uint32_t>(visited_values.size() );
+                ++n_object)
+    {
+        ANVIL_TEST_CHECK(visited_values[n_object] == n_object + 1);
+    }
+
+    object_tracker_ptr->visit_alive_objects(Anvil::ObjectType::SHADER_MODULE,
+                                            [&](const void*) -> bool
+                                            {
+                                                return (++n_visited_objects < 3);
+                                            });
+
+    ANVIL_TEST_CHECK(n_visited_objects == 3);
+
+    /* Keep replacing objects on another thread, while this thread reads from every object it visits */
+    std::thread releaser_thread(
+        [&]()
+        {
+            for (uint32_t n_release = 0;
+                          n_release < n_releases;
+                        ++n_release)
+            {
+                const uint32_t n_object = n_release % n_objects;
+
+                delete objects[n_object];
+
+                objects[n_object] = new TrackedObject(n_object + 1);
+            }
+
+            releaser_done.store(true);
+        });
+
+    while (!releaser_done.load() )
+    {
+        object_tracker_ptr->visit_alive_objects(Anvil::ObjectType::SHADER_MODULE,
+                                                [&](const void* in_object_ptr) -> bool
+                                                {
+                                                    const uint32_t value = reinterpret_cast<const TrackedObject*>(in_object_ptr)->get_value();
+
+                                                    ANVIL_TEST_CHECK(value >= 1 && value <= n_objects);
+
+                                                    return true;
+                                                });
+    }
+
+    releaser_thread.join();
+
+    for (auto current_object_ptr : objects)
+    {
+        delete current_object_ptr;
+    }
+
+    ANVIL_TEST_CHECK(object_tracker_ptr->get_n_alive_objects(Anvil::ObjectType::SHADER_MODULE) == 0);
+}
+
+/** Registers & unregisters objects from several threads, first with each thread using a separate object type, then
+ *  with all threads using the same one.
+ **/
+static void run_benchmark()
+{
+    const Anvil::ObjectType separate_object_types[] =
+    {
+        Anvil::ObjectType::BUFFER,
+        Anvil::ObjectType::BUFFER_VIEW,
+        Anvil::ObjectType::IMAGE,
+        Anvil::ObjectType::IMAGE_VIEW,
+        Anvil::ObjectType::SAMPLER,
+        Anvil::ObjectType::FENCE,
+        Anvil::ObjectType::SEMAPHORE,
+        Anvil::ObjectType::QUERY_POOL,
+    };
+    const uint32_t          n_iterations          = 1000000;
+    const uint32_t          n_separate_types      = sizeof(separate_object_types) / sizeof(separate_object_types[0]);
+    const uint32_t          n_threads             = std::min(n_separate_types,
+                                                             std::max(2u, std::thread::hardware_concurrency() ));
+    Anvil::ObjectTracker*   object_tracker_ptr    = Anvil::ObjectTracker::get();
+
+    for (uint32_t n_run = 0;
+                  n_run < 2;
+                ++n_run)
+    {
+        const bool               use_shared_type = (n_run == 1);
+        std::vector<std::thread> threads;
+        AnvilTests::Timer        timer;
+
+        for (uint32_t n_thread = 0;
+                      n_thread < n_threads;
+                    ++n_thread)
+        {
+            threads.push_back(std::thread(
+                [&, use_shared_type, n_thread]()
+                {
+                    const Anvil::ObjectType object_type = (use_shared_type) ? Anvil::ObjectType::EVENT
+                                                                            : separate_object_types[n_thread];
+
+                    for (uint32_t n_iteration = 0;
+                                  n_iteration < n_iterations;
+                                ++n_iteration)
+                    {
+                        void* object_ptr = get_fake_object_ptr(n_thread, n_iteration % 1024);
+
+                        object_tracker_ptr->register_object  (object_type,
+                                                              object_ptr);
+                        object_tracker_ptr->unregister_object(object_type,
+                                                              object_ptr);
+                    }
+                }) );
+        }
+
+        for (auto& current_thread : threads)
+        {
+            current_thread.join();
+        }
+
+        fprintf(stdout,
+                "%u threads, %s object type: %8.2f ms for %u registrations per thread\n",
+                n_threads,
+                (use_shared_type) ? "shared"
+                                  : "separate",
+                timer.get_elapsed_msec(),
+                n_iterations);
+    }
+}
+
+int main(int    argc,
+         char** argv)
+{
+    test_out_of_order_unregistration();
+    test_concurrent_registration    ();
+    test_visit_alive_objects        ();
+
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+    {
+        run_benchmark();
+    }
+
+    Anvil::ObjectTracker::destroy();
+
+    return AnvilTests::finish("object_tracker");
+}
@@ -0,0 +1,318 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Checks PageTracker's per-page bindings against a plain per-page model, under random binding updates, and measures
+ * how long the updates take. The tracker never dereferences memory blocks unless asked to return sparse memory bind
+ * ranges for them, so fake memory block pointers are used.
+ **/
+#include "misc/page_tracker.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <random>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    const VkDeviceSize PAGE_SIZE = 65536;
+
+    /** Expected binding of a single page. */
+    typedef struct PageModel
+    {
+        Anvil::MemoryBlock* memory_block_ptr;
+        VkDeviceSize        memory_block_start_offset;
+
+        PageModel()
+            :memory_block_ptr         (nullptr),
+             memory_block_start_offset(0)
+        {
+            /* Stub */
+        }
+    } PageModel;
+}
+
+static Anvil::MemoryBlock* get_fake_memory_block_ptr(uint32_t in_n_memory_block)
+{
+    return reinterpret_cast<Anvil::MemoryBlock*>(static_cast<uintptr_t>(in_n_memory_block + 1) << 4);
+}
+
+/** Compares every page of @param in_page_tracker against @param in_model. */
+static void check_against_model(const Anvil::PageTracker&     in_page_tracker,
+                                const std::vector<PageModel>& in_model)
+{
+    uint32_t n_backed_pages = 0;
+    uint32_t n_mismatches   = 0;
+
+    for (uint32_t n_page = 0;
+                  n_page < static_cast<uint32_t>(in_model.size() );
+                ++n_page)
+    {
+        VkDeviceSize        memory_region_start_offset = 0;
+        Anvil::MemoryBlock* memory_block_ptr           = in_page_tracker.get_memory_block(n_page * PAGE_SIZE,
+                                                                                          1, /* in_size */
+                                                                                         &memory_region_start_offset);
+
+        if (memory_block_ptr != in_model[n_page].memory_block_ptr)
+        {
+            ++n_mismatches;
+        }
+        else
+        if (memory_block_ptr           != nullptr &&
+            memory_region_start_offset != in_model[n_page].memory_block_start_offset)
+        {
+            ++n_mismatches;
+        }
+
+        if (in_model[n_page].memory_block_ptr != nullptr)
+        {
+            ++n_backed_pages;
+        }
+    }
+
+    ANVIL_TEST_CHECK(n_mismatches                                      == 0);
+    ANVIL_TEST_CHECK(in_page_tracker.get_n_pages_with_memory_backing() == n_backed_pages);
+
+    /* Every coalesced descriptor must describe a bound region */
+    for (uint32_t n_memory_block = 0;
+                  n_memory_block < in_page_tracker.get_n_memory_blocks();
+                ++n_memory_block)
+    {
+        ANVIL_TEST_CHECK(in_page_tracker.get_memory_block(n_memory_block) != nullptr);
+    }
+}
+
+/** Binds & unbinds random page ranges with set_binding(). The region size is not a multiple of the page size, so
+ *  the last page is smaller than the others.
+ **/
+static void test_random_set_binding()
+{
+    const uint32_t         n_pages          = 5000;
+    const VkDeviceSize     region_size      = n_pages * PAGE_SIZE - 1000;
+    std::vector<PageModel> model            (n_pages);
+    Anvil::PageTracker     page_tracker     (region_size,
+                                             PAGE_SIZE);
+    std::mt19937           random_generator (1);
+
+    ANVIL_TEST_CHECK(page_tracker.get_n_pages() == n_pages);
+
+    for (uint32_t n_iteration = 0;
+                  n_iteration < 20000;
+                ++n_iteration)
+    {
+        const uint32_t            n_start_page              = random_generator() % n_pages;
+        const uint32_t            n_range_pages             = std::min(static_cast<uint32_t>(1 + random_generator() % 8),
+                                                                       n_pages - n_start_page);
+        Anvil::MemoryBlock* const memory_block_ptr          = (random_generator() % 3 == 0) ? nullptr
+                                                                                            : get_fake_memory_block_ptr(random_generator() % 4);
+        const VkDeviceSize        memory_block_start_offset = (random_generator() % 100) * PAGE_SIZE;
+        const VkDeviceSize        size                      = (n_start_page + n_range_pages == n_pages) ? region_size - n_start_page * PAGE_SIZE
+                                                                                                        : n_range_pages * PAGE_SIZE;
+
+        if (!ANVIL_TEST_CHECK(page_tracker.set_binding(memory_block_ptr,
+                                                       memory_block_start_offset,
+                                                       n_start_page * PAGE_SIZE,
+                                                       size) ))
+        {
+            continue;
+        }
+
+        for (uint32_t n_page = 0;
+                      n_page < n_range_pages;
+                    ++n_page)
+        {
+            model[n_start_page + n_page].memory_block_ptr          = memory_block_ptr;
+            model[n_start_page + n_page].memory_block_start_offset = (memory_block_ptr != nullptr) ? memory_block_start_offset + n_page * PAGE_SIZE
+                                                                                                   : 0;
+        }
+
+        if ((n_iteration % 1000) == 0)
+        {
+            check_against_model(page_tracker,
+                                model);
+        }
+    }
+
+    check_against_model(page_tracker,
+                        model);
+}
+
+/** Checks that the last update for a page wins, and that sparse memory bind ranges returned for unbinds only cover
+ *  pages which actually had memory backing, with adjacent pages merged.
+ **/
+static void test_set_page_bindings()
+{
+    const uint32_t                                     n_pages      = 3000;
+    std::vector<PageModel>                             model        (n_pages);
+    Anvil::PageTracker                                 page_tracker (n_pages * PAGE_SIZE,
+                                                                     PAGE_SIZE);
+    std::vector<VkSparseMemoryBind>                    sparse_memory_binds;
+    std::vector<Anvil::PageTracker::PageBindingUpdate> updates;
+
+    /* Bind pages [0, 10) and [2040, 2060). The second range spans two leaves of the radix table. Page 5 is updated
+     * twice, and only the second update should stick. */
+    for (uint32_t n_page = 0;
+                  n_page < n_pages;
+                ++n_page)
+    {
+        if (n_page < 10 || (n_page >= 2040 && n_page < 2060) )
+        {
+            updates.push_back(Anvil::PageTracker::PageBindingUpdate(n_page,
+                                                                    get_fake_memory_block_ptr(0),
+                                                                    n_page * PAGE_SIZE) );
+
+            model[n_page].memory_block_ptr          = get_fake_memory_block_ptr(0);
+            model[n_page].memory_block_start_offset = n_page * PAGE_SIZE;
+        }
+    }
+
+    updates.push_back(Anvil::PageTracker::PageBindingUpdate(5,
+                                                            get_fake_memory_block_ptr(1),
+                                                            0) );
+
+    model[5].memory_block_ptr          = get_fake_memory_block_ptr(1);
+    model[5].memory_block_start_offset = 0;
+
+    ANVIL_TEST_CHECK(page_tracker.set_page_bindings(updates,
+                                                    nullptr) ); /* out_opt_sparse_memory_binds_ptr */
+
+    check_against_model(page_tracker,
+                        model);
+
+    /* Unbind all pages, in reverse order */
+    updates.clear();
+
+    for (uint32_t n_page = 0;
+                  n_page < n_pages;
+                ++n_page)
+    {
+        updates.push_back(Anvil::PageTracker::PageBindingUpdate(n_pages - n_page - 1,
+                                                                nullptr,
+                                                                0) );
+
+        model[n_page] = PageModel();
+    }
+
+    ANVIL_TEST_CHECK(page_tracker.set_page_bindings(updates,
+                                                   &sparse_memory_binds) );
+
+    check_against_model(page_tracker,
+                        model);
+
+    if (ANVIL_TEST_CHECK(sparse_memory_binds.size() == 2) )
+    {
+        ANVIL_TEST_CHECK(sparse_memory_binds[0].memory         == VK_NULL_HANDLE);
+        ANVIL_TEST_CHECK(sparse_memory_binds[0].resourceOffset == 0);
+        ANVIL_TEST_CHECK(sparse_memory_binds[0].size           == 10 * PAGE_SIZE);
+        ANVIL_TEST_CHECK(sparse_memory_binds[1].memory         == VK_NULL_HANDLE);
+        ANVIL_TEST_CHECK(sparse_memory_binds[1].resourceOffset == 2040 * PAGE_SIZE);
+        ANVIL_TEST_CHECK(sparse_memory_binds[1].size           == 20 * PAGE_SIZE);
+    }
+
+    /* Unbinding pages which are not backed is a no-op */
+    ANVIL_TEST_CHECK(page_tracker.set_page_bindings(updates,
+                                                   &sparse_memory_binds) );
+    ANVIL_TEST_CHECK(sparse_memory_binds.empty() );
+}
+
+/** Measures random single-page binding updates on a large resource, followed by coalesced descriptor look-ups. */
+static void run_benchmark()
+{
+    const uint32_t     n_pages          = 262144;
+    const uint32_t     n_updates        = 1000000;
+    Anvil::PageTracker page_tracker     (n_pages * PAGE_SIZE,
+                                         PAGE_SIZE);
+    std::mt19937       random_generator (1);
+
+    {
+        AnvilTests::Timer timer;
+
+        for (uint32_t n_update = 0;
+                      n_update < n_updates;
+                    ++n_update)
+        {
+            const uint32_t n_page = random_generator() % n_pages;
+
+            page_tracker.set_binding((random_generator() % 4 == 0) ? nullptr
+                                                                   : get_fake_memory_block_ptr(0),
+                                     n_page * PAGE_SIZE,
+                                     n_page * PAGE_SIZE,
+                                     PAGE_SIZE);
+        }
+
+        fprintf(stdout,
+                "set_binding():          %8.2f ms for %u single-page updates\n",
+                timer.get_elapsed_msec(),
+                n_updates);
+    }
+
+    {
+        std::vector<Anvil::PageTracker::PageBindingUpdate> updates;
+
+        updates.reserve(n_updates);
+
+        for (uint32_t n_update = 0;
+                      n_update < n_updates;
+                    ++n_update)
+        {
+            const uint32_t n_page = random_generator() % n_pages;
+
+            updates.push_back(Anvil::PageTracker::PageBindingUpdate(n_page,
+                                                                    (random_generator() % 4 == 0) ? nullptr
+                                                                                                  : get_fake_memory_block_ptr(0),
+                                                                    n_page * PAGE_SIZE) );
+        }
+
+        AnvilTests::Timer timer;
+
+        page_tracker.set_page_bindings(updates,
+                                       nullptr); /* out_opt_sparse_memory_binds_ptr */
+
+        fprintf(stdout,
+                "set_page_bindings():    %8.2f ms for %u single-page updates\n",
+                timer.get_elapsed_msec(),
+                n_updates);
+    }
+
+    {
+        AnvilTests::Timer timer;
+        const uint32_t    n_memory_blocks = page_tracker.get_n_memory_blocks();
+
+        fprintf(stdout,
+                "get_n_memory_blocks():  %8.2f ms to coalesce %u descriptors\n",
+                timer.get_elapsed_msec(),
+                n_memory_blocks);
+    }
+}
+
+int main(int    argc,
+         char** argv)
+{
+    test_random_set_binding();
+    test_set_page_bindings ();
+
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+    {
+        run_benchmark();
+    }
+
+    return AnvilTests::finish("page_tracker");
+}
@@ -0,0 +1,477 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Checks SPIRVDiskCache's key derivation against SHA-256 test vectors, that blobs survive a store/load round trip
+ * (also across cache instances), that corrupt or truncated entries are rejected, and that least recently used
+ * entries are evicted first once the cache goes over its budget. Finally, bakes SPIR-V blobs for a number of
+ * generators from several threads at once, with all blobs served by a shared cache, so no device is needed.
+ **/
+#include "misc/glsl_to_spirv.h"
+#include "misc/spirv_disk_cache.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define SPIRV_MAGIC_NUMBER (0x07230203u)
+
+static const char* g_cache_directory = "spirv_disk_cache_test";
+
+/* Entries start with a 16-byte header. */
+static const uint32_t g_entry_header_size = 16;
+
+/** Returns a blob which starts with the SPIR-V magic number and is followed by @param in_n_words words derived from
+ *  @param in_seed.
+ **/
+static std::vector<char> create_blob(uint32_t in_seed,
+                                     uint32_t in_n_words)
+{
+    std::vector<uint32_t> words(1 + in_n_words);
+    std::vector<char>     result(words.size() * sizeof(uint32_t) );
+
+    words[0] = SPIRV_MAGIC_NUMBER;
+
+    for (uint32_t n_word = 0;
+                  n_word < in_n_words;
+                ++n_word)
+    {
+        words[1 + n_word] = in_seed * 2654435761u + n_word;
+    }
+
+    memcpy(&result.at(0),
+           &words.at(0),
+           result.size() );
+
+    return result;
+}
+
+static std::string get_key(const std::string& in_data)
+{
+    return Anvil::SPIRVDiskCache::calculate_key(in_data.c_str(),
+                                                in_data.size() );
+}
+
+static std::string get_entry_filename(const std::string& in_key)
+{
+    return std::string(g_cache_directory) + "/" + in_key + ".spv";
+}
+
+static bool store_blob(Anvil::SPIRVDiskCache*   in_cache_ptr,
+                       const std::string&       in_key,
+                       const std::vector<char>& in_blob)
+{
+    return in_cache_ptr->store(in_key,
+                              &in_blob.at(0),
+                               in_blob.size() );
+}
+
+static bool does_file_exist(const std::string& in_filename)
+{
+    FILE* file_ptr = fopen(in_filename.c_str(),
+                           "rb");
+
+    if (file_ptr != nullptr)
+    {
+        fclose(file_ptr);
+    }
+
+    return (file_ptr != nullptr);
+}
+
+/** Overwrites the file at @param in_filename with @param in_data. */
+static void write_file(const std::string&       in_filename,
+                       const std::vector<char>& in_data)
+{
+    FILE* file_ptr = fopen(in_filename.c_str(),
+                           "wb");
+
+    if (ANVIL_TEST_CHECK(file_ptr != nullptr) )
+    {
+        if (in_data.size() > 0)
+        {
+            fwrite(&in_data.at(0),
+                   in_data.size(),
+                   1, /* count */
+                   file_ptr);
+        }
+
+        fclose(file_ptr);
+    }
+}
+
+static std::vector<char> read_file(const std::string& in_filename)
+{
+    FILE*             file_ptr = fopen(in_filename.c_str(),
+                                       "rb");
+    std::vector<char> result;
+
+    if (ANVIL_TEST_CHECK(file_ptr != nullptr) )
+    {
+        char   buffer[4096];
+        size_t n_bytes_read;
+
+        while ( (n_bytes_read = fread(buffer, 1, sizeof(buffer), file_ptr) ) > 0)
+        {
+            result.insert(result.end(),
+                          buffer,
+                          buffer + n_bytes_read);
+        }
+
+        fclose(file_ptr);
+    }
+
+    return result;
+}
+
+/** Creates a cache instance which does not hold any entries. */
+static Anvil::SPIRVDiskCacheUniquePtr create_empty_cache(uint64_t in_max_size_in_bytes)
+{
+    auto cache_ptr = Anvil::SPIRVDiskCache::create(g_cache_directory,
+                                                   in_max_size_in_bytes);
+
+    if (ANVIL_TEST_CHECK(cache_ptr != nullptr) )
+    {
+        cache_ptr->clear();
+    }
+
+    return cache_ptr;
+}
+
+/** Keys are SHA-256 digests. Compares them against the FIPS 180-4 examples, including multi-block messages. */
+static void test_key_known_answers()
+{
+    const std::string million_as(1000000, 'a');
+
+    ANVIL_TEST_CHECK(get_key("")                                                         == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    ANVIL_TEST_CHECK(get_key("abc")                                                      == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    ANVIL_TEST_CHECK(get_key("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    ANVIL_TEST_CHECK(get_key(million_as)                                                 == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+    /* Keys depend on every byte, including embedded zeros */
+    ANVIL_TEST_CHECK(get_key(std::string("a\0b", 3) ) != get_key(std::string("a\0c", 3) ));
+}
+
+/** Blobs read back equal what has been stored, also from a new instance which indexes the directory at creation time. */
+static void test_round_trip()
+{
+    auto                    cache_ptr = create_empty_cache(1024 * 1024);
+    const std::string       key_1     = get_key("blob 1");
+    const std::string       key_2     = get_key("blob 2");
+    const std::vector<char> blob_1    = create_blob(1, 100);
+    const std::vector<char> blob_2    = create_blob(2, 3);
+    std::vector<char>       loaded_blob;
+
+    if (cache_ptr == nullptr)
+    {
+        return;
+    }
+
+    ANVIL_TEST_CHECK(!cache_ptr->load(key_1, &loaded_blob) );
+    ANVIL_TEST_CHECK(loaded_blob.empty() );
+    ANVIL_TEST_CHECK(cache_ptr->get_n_misses() == 1);
+
+    ANVIL_TEST_CHECK(store_blob(cache_ptr.get(), key_1, blob_1) );
+    ANVIL_TEST_CHECK(store_blob(cache_ptr.get(), key_2, blob_2) );
+
+    ANVIL_TEST_CHECK(cache_ptr->get_size_in_bytes() == 2 * g_entry_header_size + blob_1.size() + blob_2.size() );
+
+    ANVIL_TEST_CHECK(cache_ptr->load(key_1, &loaded_blob) && loaded_blob == blob_1);
+    ANVIL_TEST_CHECK(cache_ptr->load(key_2, &loaded_blob) && loaded_blob == blob_2);
+    ANVIL_TEST_CHECK(cache_ptr->get_n_hits() == 2);
+
+    /* Storing under an existing key replaces the blob */
+    ANVIL_TEST_CHECK(store_blob(cache_ptr.get(), key_2, blob_1) );
+    ANVIL_TEST_CHECK(cache_ptr->load(key_2, &loaded_blob) && loaded_blob == blob_1);
+    ANVIL_TEST_CHECK(cache_ptr->get_size_in_bytes() == 2 * (g_entry_header_size + blob_1.size() ));
+
+    /* A new instance sees the blobs stored by the previous one */
+    cache_ptr.reset();
+    cache_ptr = Anvil::SPIRVDiskCache::create(g_cache_directory,
+                                              1024 * 1024);
+
+    if (ANVIL_TEST_CHECK(cache_ptr != nullptr) )
+    {
+        ANVIL_TEST_CHECK(cache_ptr->get_size_in_bytes() == 2 * (g_entry_header_size + blob_1.size() ));
+        ANVIL_TEST_CHECK(cache_ptr->load(key_1, &loaded_blob) && loaded_blob == blob_1);
+
+        cache_ptr->clear();
+
+        ANVIL_TEST_CHECK(cache_ptr->get_size_in_bytes() == 0);
+        ANVIL_TEST_CHECK(!cache_ptr->load(key_1, &loaded_blob) );
+    }
+}
+
+/** Entries which are truncated, or whose header or SPIR-V magic number is damaged, are reported as misses. */
+static void test_corrupt_entries()
+{
+    auto                    cache_ptr = create_empty_cache(1024 * 1024);
+    const std::string       key       = get_key("corrupt");
+    const std::vector<char> blob      = create_blob(3, 64);
+    std::vector<char>       entry_data;
+    std::vector<char>       loaded_blob;
+
+    if (cache_ptr == nullptr)
+    {
+        return;
+    }
+
+    ANVIL_TEST_CHECK(store_blob(cache_ptr.get(), key, blob) );
+
+    entry_data = read_file(get_entry_filename(key) );
+
+    if (!ANVIL_TEST_CHECK(entry_data.size() == g_entry_header_size + blob.size() ))
+    {
+        return;
+    }
+
+    const std::vector<char> damaged_entries[] =
+    {
+        /* Empty file */
+        std::vector<char>(),
+
+        /* Truncated header */
+        std::vector<char>(entry_data.begin(), entry_data.begin() + g_entry_header_size / 2),
+
+        /* Truncated blob */
+        std::vector<char>(entry_data.begin(), entry_data.end() - 4),
+    };
+
+    for (const auto& current_damaged_entry : damaged_entries)
+    {
+        write_file(get_entry_filename(key),
+                   current_damaged_entry);
+
+        ANVIL_TEST_CHECK(!cache_ptr->load(key, &loaded_blob) );
+        ANVIL_TEST_CHECK(loaded_blob.empty() );
+    }
+
+    /* Damaged entry magic, version, blob size, and SPIR-V magic */
+    const uint32_t damaged_byte_offsets[] = {0, 4, 8, g_entry_header_size};
+
+    for (const auto& current_offset : damaged_byte_offsets)
+    {
+        std::vector<char> damaged_entry = entry_data;
+
+        damaged_entry.at(current_offset) ^= 0x5A;
+
+        write_file(get_entry_filename(key),
+                   damaged_entry);
+
+        ANVIL_TEST_CHECK(!cache_ptr->load(key, &loaded_blob) );
+    }
+
+    /* A blob size which is not a multiple of 4 */
+    {
+        std::vector<char> damaged_entry = entry_data;
+        uint64_t          blob_size     = blob.size() - 2;
+
+        memcpy(&damaged_entry.at(8),
+               &blob_size,
+               sizeof(blob_size) );
+
+        write_file(get_entry_filename(key),
+                   damaged_entry);
+
+        ANVIL_TEST_CHECK(!cache_ptr->load(key, &loaded_blob) );
+    }
+
+    /* The intact entry still loads */
+    write_file(get_entry_filename(key),
+               entry_data);
+
+    ANVIL_TEST_CHECK(cache_ptr->load(key, &loaded_blob) && loaded_blob == blob);
+
+    cache_ptr->clear();
+}
+
+/** Fills the cache up to its budget, uses one of the oldest entries, and checks that going over the budget evicts the
+ *  least recently used entries, and that blobs larger than the whole budget are never stored.
+ **/
+static void test_eviction_order()
+{
+    const uint32_t           n_blob_words   = 63;
+    const uint64_t           entry_size     = g_entry_header_size + (1 + n_blob_words) * sizeof(uint32_t);
+    const uint32_t           n_keys         = 4;
+    auto                     cache_ptr      = create_empty_cache(n_keys * entry_size - 1);
+    std::vector<std::string> keys;
+    std::vector<char>        loaded_blob;
+
+    if (cache_ptr == nullptr)
+    {
+        return;
+    }
+
+    for (uint32_t n_key = 0;
+                  n_key < n_keys;
+                ++n_key)
+    {
+        keys.push_back(get_key("entry " + std::to_string(n_key) ));
+    }
+
+    /* Three entries fit */
+    for (uint32_t n_key = 0;
+                  n_key < 3;
+                ++n_key)
+    {
+        ANVIL_TEST_CHECK(store_blob(cache_ptr.get(), keys[n_key], create_blob(n_key, n_blob_words) ));
+    }
+
+    ANVIL_TEST_CHECK(cache_ptr->get_size_in_bytes() == 3 * entry_size);
+
+    /* Entry 0 becomes the most recently used one, which leaves entry 1 as the least recently used one */
+    ANVIL_TEST_CHECK(cache_ptr->load(keys[0], &loaded_blob) );
+
+    /* The fourth entry takes the cache over budget. Eviction goes down to 90% of the budget, so one entry goes away */
+    ANVIL_TEST_CHECK(store_blob(cache_ptr.get(), keys[3], create_blob(3, n_blob_words) ));
+
+    ANVIL_TEST_CHECK(cache_ptr->get_size_in_bytes() == 3 * entry_size);
+    ANVIL_TEST_CHECK(!does_file_exist(get_entry_filename(keys[1]) ));
+
+    ANVIL_TEST_CHECK(!cache_ptr->load(keys[1], &loaded_blob) );
+    ANVIL_TEST_CHECK( cache_ptr->load(keys[0], &loaded_blob) && loaded_blob == create_blob(0, n_blob_words) );
+    ANVIL_TEST_CHECK( cache_ptr->load(keys[2], &loaded_blob) && loaded_blob == create_blob(2, n_blob_words) );
+    ANVIL_TEST_CHECK( cache_ptr->load(keys[3], &loaded_blob) && loaded_blob == create_blob(3, n_blob_words) );
+
+    /* Entry 0 is now the least recently used one */
+    ANVIL_TEST_CHECK(store_blob(cache_ptr.get(), keys[1], create_blob(1, n_blob_words) ));
+
+    ANVIL_TEST_CHECK(!cache_ptr->load(keys[0], &loaded_blob) );
+    ANVIL_TEST_CHECK( cache_ptr->load(keys[1], &loaded_blob) );
+
+    /* Blobs which exceed the budget on their own are rejected, and do not evict anything */
+    ANVIL_TEST_CHECK(!store_blob(cache_ptr.get(), get_key("too large"), create_blob(4, static_cast<uint32_t>(n_keys * entry_size / sizeof(uint32_t) ))));
+    ANVIL_TEST_CHECK(cache_ptr->get_size_in_bytes() == 3 * entry_size);
+
+    cache_ptr->clear();
+}
+
+/** Creates generators for distinct shaders, and populates the cache with a blob for each of them. Then bakes the
+ *  blobs with several bake_spirv_blobs() calls running at the same time, each of which uses several worker threads.
+ **/
+static void test_concurrent_batch_bakes()
+{
+    typedef std::vector<const Anvil::GLSLShaderToSPIRVGenerator*> GeneratorPtrs;
+
+    const uint32_t                                          n_batches              = 4;
+    const uint32_t                                          n_generators_per_batch = 32;
+    auto                                                    cache_ptr              = create_empty_cache(16 * 1024 * 1024);
+    std::vector<GeneratorPtrs>                              generator_ptrs_per_batch(n_batches);
+    std::vector<Anvil::GLSLShaderToSPIRVGeneratorUniquePtr> generator_ptrs;
+    std::vector<uint32_t>                                   results                (n_batches, 0);
+    std::vector<std::thread>                                threads;
+
+    if (cache_ptr == nullptr)
+    {
+        return;
+    }
+
+    for (uint32_t n_generator = 0;
+                  n_generator < n_batches * n_generators_per_batch;
+                ++n_generator)
+    {
+        const std::string source_code = "#version 450\n"
+                                        "\n"
+                                        "layout(location = 0) out vec4 result;\n"
+                                        "\n"
+                                        "void main()\n"
+                                        "{\n"
+                                        "    result = vec4(" + std::to_string(n_generator) + ".0);\n"
+                                        "}\n";
+
+        generator_ptrs.push_back(
+            Anvil::GLSLShaderToSPIRVGenerator::create(nullptr, /* in_opt_device_ptr */
+                                                      Anvil::GLSLShaderToSPIRVGenerator::MODE_USE_SPECIFIED_SOURCE,
+                                                      source_code,
+                                                      Anvil::ShaderStage::FRAGMENT)
+        );
+
+        generator_ptrs.back()->set_spirv_disk_cache(cache_ptr.get() );
+
+        ANVIL_TEST_CHECK(store_blob(cache_ptr.get(),
+                                    generator_ptrs.back()->get_spirv_disk_cache_key(),
+                                    create_blob(n_generator, 16) ));
+
+        generator_ptrs_per_batch.at(n_generator % n_batches).push_back(generator_ptrs.back().get() );
+    }
+
+    for (uint32_t n_batch = 0;
+                  n_batch < n_batches;
+                ++n_batch)
+    {
+        threads.push_back(std::thread(
+            [&, n_batch]()
+            {
+                results[n_batch] = Anvil::GLSLShaderToSPIRVGenerator::bake_spirv_blobs(generator_ptrs_per_batch.at(n_batch),
+                                                                                       4); /* in_n_worker_threads */
+            }) );
+    }
+
+    for (auto& current_thread : threads)
+    {
+        current_thread.join();
+    }
+
+    for (uint32_t n_batch = 0;
+                  n_batch < n_batches;
+                ++n_batch)
+    {
+        ANVIL_TEST_CHECK(results[n_batch] != 0);
+    }
+
+    for (uint32_t n_generator = 0;
+                  n_generator < static_cast<uint32_t>(generator_ptrs.size() );
+                ++n_generator)
+    {
+        const std::vector<char> expected_blob = create_blob(n_generator, 16);
+
+        if (ANVIL_TEST_CHECK(generator_ptrs[n_generator]->get_spirv_blob_size() == expected_blob.size() ))
+        {
+            ANVIL_TEST_CHECK(memcmp(generator_ptrs[n_generator]->get_spirv_blob(),
+                                   &expected_blob.at(0),
+                                    expected_blob.size() ) == 0);
+        }
+    }
+
+    ANVIL_TEST_CHECK(cache_ptr->get_n_hits  () == generator_ptrs.size() );
+    ANVIL_TEST_CHECK(cache_ptr->get_n_misses() == 0);
+
+    /* Generators whose blobs have already been baked are skipped */
+    ANVIL_TEST_CHECK(Anvil::GLSLShaderToSPIRVGenerator::bake_spirv_blobs(generator_ptrs_per_batch.at(0),
+                                                                         0) ); /* in_n_worker_threads */
+    ANVIL_TEST_CHECK(cache_ptr->get_n_hits() == generator_ptrs.size() );
+
+    generator_ptrs.clear();
+    cache_ptr->clear    ();
+}
+
+int main()
+{
+    test_key_known_answers     ();
+    test_round_trip            ();
+    test_corrupt_entries       ();
+    test_eviction_order        ();
+    test_concurrent_batch_bakes();
+
+    return AnvilTests::finish("spirv_disk_cache");
+}
@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Helpers shared by the device-free tests & benchmarks.
+ *
+ * Each test is a standalone executable, which returns a non-zero exit code if any of its checks failed.
+ **/
+#ifndef TESTS_TEST_UTILS_H
+#define TESTS_TEST_UTILS_H
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace AnvilTests
+{
+    static uint32_t n_failed_checks = 0;
+
+    /** Prints out a message and records a failure if @param in_condition is false.
+     *
+     *  @return @param in_condition.
+     **/
+    inline bool check(bool        in_condition,
+                      const char* in_condition_text_ptr,
+                      const char* in_file_ptr,
+                      int         in_line)
+    {
+        if (!in_condition)
+        {
+            fprintf(stderr,
+                    "%s:%d: check failed: %s\n",
+                    in_file_ptr,
+                    in_line,
+                    in_condition_text_ptr);
+
+            ++n_failed_checks;
+        }
+
+        return in_condition;
+    }
+
+    /** Returns the exit code of the test, and prints out a summary. */
+    inline int finish(const char* in_test_name_ptr)
+    {
+        if (n_failed_checks > 0)
+        {
+            fprintf(stderr,
+                    "%s: %u check(s) failed\n",
+                    in_test_name_ptr,
+                    n_failed_checks);
+
+            return 1;
+        }
+
+        fprintf(stdout,
+                "%s: all checks passed\n",
+                in_test_name_ptr);
+
+        return 0;
+    }
+
+    /** Measures wall-clock time in milliseconds, starting at construction time. */
+    class Timer
+    {
+    public:
+        Timer()
+            :m_start_time(std::chrono::steady_clock::now() )
+        {
+            /* Stub */
+        }
+
+        double get_elapsed_msec() const
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start_time).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start_time;
+    };
+}; /* namespace AnvilTests */
+
+#define ANVIL_TEST_CHECK(condition) \
+    AnvilTests::check(!!(condition), #condition, __FILE__, __LINE__)
+
+#endif /* TESTS_TEST_UTILS_H */
@@ -0,0 +1,414 @@
+//
+// Copyright (c) 2017-2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/* Exercises TLSFHeap against a fake page provider, which hands out address ranges instead of device memory. */
+#include "misc/memalloc_backends/tlsf_heap.h"
+#include "test_utils.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace
+{
+    /** Hands out pages with fake handles, and keeps track of the pages which have not been released yet. */
+    class FakePageProvider : public Anvil::MemoryAllocatorBackends::ITLSFPageProvider
+    {
+    public:
+        FakePageProvider()
+            :m_fail_allocations (false),
+             m_n_next_page      (1)
+        {
+            /* Stub */
+        }
+
+        void* allocate_page(VkDeviceSize in_size) override
+        {
+            void* result_ptr = nullptr;
+
+            if (!m_fail_allocations)
+            {
+                result_ptr = reinterpret_cast<void*>(static_cast<uintptr_t>(m_n_next_page++) );
+
+                m_live_pages[result_ptr] = in_size;
+            }
+
+            return result_ptr;
+        }
+
+        void release_page(void* in_page_handle) override
+        {
+            ANVIL_TEST_CHECK(m_live_pages.erase(in_page_handle) == 1);
+        }
+
+        VkDeviceSize get_page_size(void* in_page_handle) const
+        {
+            auto page_iterator = m_live_pages.find(in_page_handle);
+
+            return (page_iterator != m_live_pages.end() ) ? page_iterator->second
+                                                          : 0;
+        }
+
+        uint32_t get_n_live_pages() const
+        {
+            return static_cast<uint32_t>(m_live_pages.size() );
+        }
+
+        void set_fail_allocations(bool in_fail_allocations)
+        {
+            m_fail_allocations = in_fail_allocations;
+        }
+
+    private:
+        bool                          m_fail_allocations;
+        std::map<void*, VkDeviceSize> m_live_pages;
+        uintptr_t                     m_n_next_page;
+    };
+
+    typedef Anvil::MemoryAllocatorBackends::TLSFHeap TLSFHeap;
+
+    const VkDeviceSize PAGE_SIZE = 1024 * 1024;
+}
+
+/** Checks that none of the live allocations overlap, and that all of them lie within their pages. */
+static void check_allocations(const FakePageProvider&                  in_provider,
+                              const std::vector<TLSFHeap::Allocation>& in_allocations)
+{
+    std::vector<TLSFHeap::Allocation> sorted_allocations(in_allocations);
+
+    std::sort(sorted_allocations.begin(),
+              sorted_allocations.end(),
+              [](const TLSFHeap::Allocation& in_allocation1,
+                 const TLSFHeap::Allocation& in_allocation2)
+              {
+                  if (in_allocation1.page_handle != in_allocation2.page_handle)
+                  {
+                      return in_allocation1.page_handle < in_allocation2.page_handle;
+                  }
+
+                  return in_allocation1.offset < in_allocation2.offset;
+              });
+
+    for (size_t n_allocation = 0;
+                n_allocation < sorted_allocations.size();
+              ++n_allocation)
+    {
+        const auto& current_allocation = sorted_allocations[n_allocation];
+
+        ANVIL_TEST_CHECK(current_allocation.offset + current_allocation.size <= in_provider.get_page_size(current_allocation.page_handle) );
+
+        if (n_allocation > 0)
+        {
+            const auto& prev_allocation = sorted_allocations[n_allocation - 1];
+
+            if (prev_allocation.page_handle == current_allocation.page_handle)
+            {
+                ANVIL_TEST_CHECK(prev_allocation.offset + prev_allocation.size <= current_allocation.offset);
+            }
+        }
+    }
+}
+
+static void test_alloc_and_free()
+{
+    FakePageProvider provider;
+
+    {
+        TLSFHeap                          heap       (&provider,
+                                                      PAGE_SIZE);
+        Anvil::MemoryAllocatorStatistics  statistics;
+        std::vector<TLSFHeap::Allocation> allocations(3);
+
+        ANVIL_TEST_CHECK(!heap.has_pages() );
+
+        ANVIL_TEST_CHECK(heap.allocate(1000, 1,    &allocations[0]) );
+        ANVIL_TEST_CHECK(heap.allocate(512,  256,  &allocations[1]) );
+        ANVIL_TEST_CHECK(heap.allocate(4096, 4096, &allocations[2]) );
+
+        ANVIL_TEST_CHECK(provider.get_n_live_pages() == 1);
+
+        for (const auto& current_allocation : allocations)
+        {
+            ANVIL_TEST_CHECK(current_allocation.block_handle != nullptr);
+            ANVIL_TEST_CHECK(current_allocation.page_handle  == allocations[0].page_handle);
+        }
+
+        ANVIL_TEST_CHECK(allocations[0].size          == 1000);
+        ANVIL_TEST_CHECK(allocations[1].offset % 256  == 0);
+        ANVIL_TEST_CHECK(allocations[2].offset % 4096 == 0);
+
+        check_allocations(provider,
+                          allocations);
+
+        heap.get_statistics(&statistics);
+
+        ANVIL_TEST_CHECK(statistics.n_allocations     == 3);
+        ANVIL_TEST_CHECK(statistics.n_bytes_allocated == 1000 + 512 + 4096);
+        ANVIL_TEST_CHECK(statistics.n_bytes_reserved  == PAGE_SIZE);
+        ANVIL_TEST_CHECK(statistics.n_pages           == 1);
+
+        for (const auto& current_allocation : allocations)
+        {
+            heap.free(current_allocation.block_handle);
+        }
+
+        /* The last empty page is kept around */
+        heap.get_statistics(&statistics);
+
+        ANVIL_TEST_CHECK(statistics.n_allocations           == 0);
+        ANVIL_TEST_CHECK(statistics.n_free_ranges           == 1);
+        ANVIL_TEST_CHECK(statistics.largest_free_range_size == PAGE_SIZE);
+        ANVIL_TEST_CHECK(provider.get_n_live_pages()        == 1);
+    }
+
+    /* The destructor returns all pages */
+    ANVIL_TEST_CHECK(provider.get_n_live_pages() == 0);
+}
+
+static void test_coalescing()
+{
+    FakePageProvider                  provider;
+    TLSFHeap                          heap       (&provider,
+                                                  PAGE_SIZE);
+    Anvil::MemoryAllocatorStatistics  statistics;
+    std::vector<TLSFHeap::Allocation> allocations(4);
+
+    /* The whole page is handed out in four consecutive ranges */
+    for (auto& current_allocation : allocations)
+    {
+        ANVIL_TEST_CHECK(heap.allocate(PAGE_SIZE / 4,
+                                       1,
+                                      &current_allocation) );
+    }
+
+    ANVIL_TEST_CHECK(provider.get_n_live_pages() == 1);
+
+    heap.get_statistics(&statistics);
+    ANVIL_TEST_CHECK(statistics.n_free_ranges == 0);
+
+    /* Non-adjacent ranges stay separate.. */
+    heap.free(allocations[0].block_handle);
+    heap.free(allocations[2].block_handle);
+
+    heap.get_statistics(&statistics);
+    ANVIL_TEST_CHECK(statistics.n_free_ranges           == 2);
+    ANVIL_TEST_CHECK(statistics.largest_free_range_size == PAGE_SIZE / 4);
+
+    /* ..but are merged with a range released in between them.. */
+    heap.free(allocations[1].block_handle);
+
+    heap.get_statistics(&statistics);
+    ANVIL_TEST_CHECK(statistics.n_free_ranges           == 1);
+    ANVIL_TEST_CHECK(statistics.largest_free_range_size == PAGE_SIZE / 4 * 3);
+
+    /* ..so that a range spanning all three fits again, without requesting another page. */
+    TLSFHeap::Allocation large_allocation;
+
+    ANVIL_TEST_CHECK(heap.allocate(PAGE_SIZE / 4 * 3,
+                                   1,
+                                  &large_allocation) );
+    ANVIL_TEST_CHECK(large_allocation.page_handle == allocations[3].page_handle);
+    ANVIL_TEST_CHECK(provider.get_n_live_pages()  == 1);
+
+    heap.free(large_allocation.block_handle);
+    heap.free(allocations[3].block_handle);
+
+    heap.get_statistics(&statistics);
+    ANVIL_TEST_CHECK(statistics.n_free_ranges           == 1);
+    ANVIL_TEST_CHECK(statistics.largest_free_range_size == PAGE_SIZE);
+}
+
+static void test_fragmentation()
+{
+    const VkDeviceSize                allocation_size = 4096;
+    const uint32_t                    n_allocations   = static_cast<uint32_t>(PAGE_SIZE / allocation_size);
+    FakePageProvider                  provider;
+    TLSFHeap                          heap            (&provider,
+                                                       PAGE_SIZE);
+    Anvil::MemoryAllocatorStatistics  statistics;
+    std::vector<TLSFHeap::Allocation> allocations     (n_allocations);
+
+    for (auto& current_allocation : allocations)
+    {
+        ANVIL_TEST_CHECK(heap.allocate(allocation_size,
+                                       allocation_size,
+                                      &current_allocation) );
+    }
+
+    ANVIL_TEST_CHECK(provider.get_n_live_pages() == 1);
+
+    heap.get_statistics(&statistics);
+    ANVIL_TEST_CHECK(statistics.get_fragmentation() == 0.0f);
+
+    /* Release every other range. Half of the page is free, but no free range is larger than a single allocation. */
+    for (uint32_t n_allocation = 0;
+                  n_allocation < n_allocations;
+                  n_allocation += 2)
+    {
+        heap.free(allocations[n_allocation].block_handle);
+    }
+
+    heap.get_statistics(&statistics);
+    ANVIL_TEST_CHECK(statistics.n_free_ranges           == n_allocations / 2);
+    ANVIL_TEST_CHECK(statistics.largest_free_range_size == allocation_size);
+    ANVIL_TEST_CHECK(statistics.get_fragmentation()     >  0.99f);
+
+    /* A request larger than any of the holes needs a new page */
+    TLSFHeap::Allocation large_allocation;
+
+    ANVIL_TEST_CHECK(heap.allocate(allocation_size * 2,
+                                   1,
+                                  &large_allocation) );
+    ANVIL_TEST_CHECK(provider.get_n_live_pages() == 2);
+
+    heap.free(large_allocation.block_handle);
+
+    for (uint32_t n_allocation = 1;
+                  n_allocation < n_allocations;
+                  n_allocation += 2)
+    {
+        heap.free(allocations[n_allocation].block_handle);
+    }
+
+    heap.get_statistics(&statistics);
+    ANVIL_TEST_CHECK(statistics.n_pages             == 1);
+    ANVIL_TEST_CHECK(statistics.get_fragmentation() == 0.0f);
+    ANVIL_TEST_CHECK(provider.get_n_live_pages()    == 1);
+}
+
+static void test_dedicated_pages_and_provider_failures()
+{
+    FakePageProvider     provider;
+    TLSFHeap             heap      (&provider,
+                                    PAGE_SIZE);
+    TLSFHeap::Allocation allocation;
+
+    /* Requests larger than a page get a page of their own, which is released together with the allocation */
+    ANVIL_TEST_CHECK(heap.allocate(PAGE_SIZE * 3,
+                                   65536,
+                                  &allocation) );
+    ANVIL_TEST_CHECK(allocation.offset                               == 0);
+    ANVIL_TEST_CHECK(provider.get_page_size(allocation.page_handle) == PAGE_SIZE * 3);
+
+    heap.free(allocation.block_handle);
+
+    ANVIL_TEST_CHECK(provider.get_n_live_pages() == 0);
+
+    /* Running out of memory is reported, and leaves the heap usable */
+    provider.set_fail_allocations(true);
+
+    ANVIL_TEST_CHECK(!heap.allocate(256,
+                                    1,
+                                   &allocation) );
+
+    provider.set_fail_allocations(false);
+
+    ANVIL_TEST_CHECK(heap.allocate(256,
+                                   1,
+                                  &allocation) );
+
+    heap.free(allocation.block_handle);
+}
+
+/** Runs random allocations and releases, checking the heap's bookkeeping against the live allocations. */
+static void test_random_workload()
+{
+    FakePageProvider                  provider;
+    std::vector<TLSFHeap::Allocation> allocations;
+    std::mt19937                      random_generator(1234);
+
+    {
+        TLSFHeap heap(&provider,
+                      PAGE_SIZE);
+
+        for (uint32_t n_iteration = 0;
+                      n_iteration < 20000;
+                    ++n_iteration)
+        {
+            if (allocations.empty() || random_generator() % 3 != 0)
+            {
+                const VkDeviceSize   alignment = static_cast<VkDeviceSize>(1) << (random_generator() % 13);
+                const VkDeviceSize   size      = 1 + random_generator() % ((random_generator() % 8 == 0) ? (PAGE_SIZE * 2) : 65536);
+                TLSFHeap::Allocation allocation;
+
+                if (ANVIL_TEST_CHECK(heap.allocate(size,
+                                                   alignment,
+                                                  &allocation) ))
+                {
+                    ANVIL_TEST_CHECK(allocation.size               == size);
+                    ANVIL_TEST_CHECK(allocation.offset % alignment == 0);
+
+                    allocations.push_back(allocation);
+                }
+            }
+            else
+            {
+                const size_t n_allocation = random_generator() % allocations.size();
+
+                heap.free(allocations[n_allocation].block_handle);
+
+                allocations[n_allocation] = allocations.back();
+                allocations.pop_back();
+            }
+
+            if (n_iteration % 1000 == 0)
+            {
+                Anvil::MemoryAllocatorStatistics statistics;
+                VkDeviceSize                     n_bytes_allocated = 0;
+
+                check_allocations(provider,
+                                  allocations);
+
+                for (const auto& current_allocation : allocations)
+                {
+                    n_bytes_allocated += current_allocation.size;
+                }
+
+                heap.get_statistics(&statistics);
+
+                ANVIL_TEST_CHECK(statistics.n_allocations     == allocations.size() );
+                ANVIL_TEST_CHECK(statistics.n_bytes_allocated == n_bytes_allocated);
+                ANVIL_TEST_CHECK(statistics.n_pages           == provider.get_n_live_pages() );
+            }
+        }
+
+        for (const auto& current_allocation : allocations)
+        {
+            heap.free(current_allocation.block_handle);
+        }
+
+        ANVIL_TEST_CHECK(provider.get_n_live_pages() <= 1);
+    }
+
+    ANVIL_TEST_CHECK(provider.get_n_live_pages() == 0);
+}
+
+int main()
+{
+    test_alloc_and_free                       ();
+    test_coalescing                           ();
+    test_fragmentation                        ();
+    test_dedicated_pages_and_provider_failures();
+    test_random_workload                      ();
+
+    return AnvilTests::finish("tlsf_heap");
+}
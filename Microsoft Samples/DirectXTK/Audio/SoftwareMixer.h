@@ -0,0 +1,666 @@
+//--------------------------------------------------------------------------------------
+// File: SoftwareMixer.h
+//
+// Platform-neutral voice mixing, sample rate conversion and matrix panning for PCM and
+// ADPCM wave data, for offline rendering and for profiling voice management off Windows
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <DirectXMath.h>
+
+
+namespace DirectX
+{
+    //----------------------------------------------------------------------------------
+    // Mixes any number of voices into an interleaved float buffer.
+    //
+    // Each voice plays a block of PCM (8, 16, 24 or 32-bit integer, or 32-bit float) or
+    // Microsoft ADPCM wave data, such as returned by LoadWAVAudioInMemoryEx or
+    // WaveBankReader::GetWaveData, with optional looping. Voices are resampled to the
+    // output rate with linear interpolation, scaled by a volume and a source-to-output
+    // channel matrix laid out as for IXAudio2Voice::SetOutputMatrix, and summed.
+    //
+    // Output is produced in passes of PassFrames frames. Volume and matrix changes are
+    // ramped over the first pass after they are made to avoid clicks, and the inner
+    // mixing loop processes four frames at a time with DirectXMath.
+    //
+    // This is a standalone mixer, not a backend for AudioEngine: AudioEngine and the
+    // SoundEffectInstance classes always mix through XAudio2.
+    //----------------------------------------------------------------------------------
+    class SoftwareMixer
+    {
+    public:
+        static constexpr uint32_t MaxChannels = 8;
+        static constexpr uint32_t LoopInfinite = 255;
+        static constexpr uint32_t InvalidVoice = UINT32_MAX;
+        static constexpr float MaxFrequencyRatio = 8.f;
+        static constexpr size_t PassFrames = 256;
+
+        enum FormatTag : uint32_t
+        {
+            Format_PCM = 1,
+            Format_ADPCM = 2,
+            Format_IEEEFloat = 3,
+        };
+
+        struct SourceFormat
+        {
+            uint32_t tag;
+            uint32_t channels;
+            uint32_t sampleRate;
+            uint32_t bitsPerSample;
+            uint32_t blockAlign;
+            uint32_t samplesPerBlock;       // ADPCM only
+            int16_t coefficients[7][2];     // ADPCM only
+
+            // Fills in the format from a WAVEFORMATEX, ADPCMWAVEFORMAT or WAVEFORMATEXTENSIBLE.
+            template<typename TWaveFormat>
+            static bool FromWaveFormat(_In_ const TWaveFormat* wfx, SourceFormat& result) noexcept
+            {
+                result = {};
+                result.tag = wfx->wFormatTag;
+                result.channels = wfx->nChannels;
+                result.sampleRate = wfx->nSamplesPerSec;
+                result.bitsPerSample = wfx->wBitsPerSample;
+                result.blockAlign = wfx->nBlockAlign;
+
+                auto extra = reinterpret_cast<const uint8_t*>(wfx) + sizeof(TWaveFormat);
+
+                if (result.tag == 0xFFFE /*WAVE_FORMAT_EXTENSIBLE*/)
+                {
+                    // The first field of the SubFormat GUID is the format tag.
+                    if (wfx->cbSize < 22)
+                        return false;
+
+                    uint32_t subFormat;
+                    memcpy(&subFormat, extra + 6, sizeof(subFormat));
+                    result.tag = subFormat;
+                }
+                else if (result.tag == Format_ADPCM)
+                {
+                    // wSamplesPerBlock, wNumCoef and the coefficient pairs follow the header.
+                    if (wfx->cbSize < 4 + sizeof(result.coefficients))
+                        return false;
+
+                    uint16_t samplesPerBlock, numCoef;
+                    memcpy(&samplesPerBlock, extra, sizeof(samplesPerBlock));
+                    memcpy(&numCoef, extra + 2, sizeof(numCoef));
+
+                    if (numCoef != 7)
+                        return false;
+
+                    result.samplesPerBlock = samplesPerBlock;
+                    memcpy(result.coefficients, extra + 4, sizeof(result.coefficients));
+                }
+
+                return IsSupported(result);
+            }
+        };
+
+        struct Buffer
+        {
+            const uint8_t* data;
+            size_t bytes;
+            uint32_t loopBegin;     // First frame of the loop region
+            uint32_t loopLength;    // Frames in the loop region, or 0 to the end of the data
+            uint32_t loopCount;     // 0 to play once, or LoopInfinite
+        };
+
+        SoftwareMixer(uint32_t outputChannels, uint32_t outputSampleRate) :
+            mOutputChannels(outputChannels),
+            mOutputSampleRate(outputSampleRate),
+            mActiveVoices(0)
+        {
+            if (!outputChannels || outputChannels > MaxChannels)
+                throw std::invalid_argument("Unsupported output channel count");
+
+            if (!outputSampleRate)
+                throw std::invalid_argument("Output sample rate cannot be zero");
+
+            mMix.resize(size_t(outputChannels) * PassFrames);
+            mResampled.resize(size_t(MaxChannels) * PassFrames);
+        }
+
+        uint32_t GetOutputChannels() const noexcept { return mOutputChannels; }
+        uint32_t GetOutputSampleRate() const noexcept { return mOutputSampleRate; }
+        size_t GetActiveVoiceCount() const noexcept { return mActiveVoices; }
+
+        static bool IsSupported(const SourceFormat& format) noexcept
+        {
+            if (!format.channels || format.channels > MaxChannels || !format.sampleRate)
+                return false;
+
+            switch (format.tag)
+            {
+                case Format_PCM:
+                    return (format.bitsPerSample == 8 || format.bitsPerSample == 16
+                        || format.bitsPerSample == 24 || format.bitsPerSample == 32)
+                        && format.blockAlign == format.channels * format.bitsPerSample / 8;
+
+                case Format_IEEEFloat:
+                    return format.bitsPerSample == 32
+                        && format.blockAlign == format.channels * 4;
+
+                case Format_ADPCM:
+                    return format.channels <= 2
+                        && format.samplesPerBlock >= 2
+                        && format.blockAlign == 7 * format.channels + (format.samplesPerBlock - 2) * 4 * format.channels / 8;
+
+                default:
+                    return false;
+            }
+        }
+
+        // Creates a stopped voice playing the given buffer, which must remain valid until the voice is destroyed.
+        uint32_t CreateVoice(const SourceFormat& format, const Buffer& buffer)
+        {
+            if (!IsSupported(format))
+                throw std::invalid_argument("Unsupported source format");
+
+            if (!buffer.data || !buffer.bytes)
+                throw std::invalid_argument("Voice buffer cannot be empty");
+
+            uint32_t index;
+            if (!mFreeVoices.empty())
+            {
+                index = mFreeVoices.back();
+                mFreeVoices.pop_back();
+            }
+            else
+            {
+                index = static_cast<uint32_t>(mVoices.size());
+                mVoices.emplace_back();
+            }
+
+            auto& voice = mVoices[index];
+            voice = {};
+            voice.format = format;
+            voice.buffer = buffer;
+            voice.allocated = true;
+            voice.frequencyRatio = 1.f;
+            voice.volume = voice.targetVolume = 1.f;
+            voice.cachedBlock = SIZE_MAX;
+
+            if (format.tag == Format_ADPCM)
+            {
+                const size_t blocks = buffer.bytes / format.blockAlign;
+                const size_t remainder = buffer.bytes % format.blockAlign;
+
+                voice.frameCount = blocks * format.samplesPerBlock;
+                if (remainder >= 7u * format.channels)
+                {
+                    voice.frameCount += 2 + (remainder - 7u * format.channels) * 2 / format.channels;
+                }
+
+                voice.decoded.resize(size_t(format.samplesPerBlock) * format.channels);
+            }
+            else
+            {
+                voice.frameCount = buffer.bytes / format.blockAlign;
+            }
+
+            if (!voice.frameCount)
+            {
+                DestroyVoice(index);
+                throw std::invalid_argument("Voice buffer holds no complete frames");
+            }
+
+            voice.loopBegin = std::min<size_t>(buffer.loopBegin, voice.frameCount - 1);
+            voice.loopEnd = buffer.loopLength
+                ? std::min<size_t>(voice.loopBegin + buffer.loopLength, voice.frameCount)
+                : voice.frameCount;
+
+            // Default routing sends matching channels straight through, and mono to the front pair.
+            for (uint32_t d = 0; d < mOutputChannels; ++d)
+            {
+                for (uint32_t s = 0; s < format.channels; ++s)
+                {
+                    const bool route = (format.channels == 1) ? (d < 2) : (s == d);
+                    voice.targetMatrix[d * format.channels + s] = route ? 1.f : 0.f;
+                }
+            }
+            memcpy(voice.matrix, voice.targetMatrix, sizeof(voice.matrix));
+
+            // Make room for the source frames one pass can consume at the highest frequency ratio.
+            const double maxStep = double(MaxFrequencyRatio) * format.sampleRate / mOutputSampleRate;
+            const size_t maxSourceFrames = static_cast<size_t>(maxStep * PassFrames) + 3;
+            if (mSource.size() < maxSourceFrames * MaxChannels)
+            {
+                mSource.resize(maxSourceFrames * MaxChannels);
+            }
+
+            return index;
+        }
+
+        void DestroyVoice(uint32_t index) noexcept
+        {
+            if (!IsValidVoice(index))
+                return;
+
+            Stop(index);
+
+            mVoices[index].allocated = false;
+            mVoices[index].decoded.clear();
+            mFreeVoices.push_back(index);
+        }
+
+        void Play(uint32_t index) noexcept
+        {
+            if (IsValidVoice(index) && !mVoices[index].playing)
+            {
+                mVoices[index].playing = true;
+                ++mActiveVoices;
+            }
+        }
+
+        // Stops the voice and rewinds it to the start of the buffer.
+        void Stop(uint32_t index) noexcept
+        {
+            if (!IsValidVoice(index))
+                return;
+
+            auto& voice = mVoices[index];
+            if (voice.playing)
+            {
+                voice.playing = false;
+                --mActiveVoices;
+            }
+
+            voice.frame = 0;
+            voice.fraction = 0;
+            voice.loopsPlayed = 0;
+        }
+
+        bool IsPlaying(uint32_t index) const noexcept
+        {
+            return IsValidVoice(index) && mVoices[index].playing;
+        }
+
+        void SetVolume(uint32_t index, float volume) noexcept
+        {
+            if (IsValidVoice(index))
+            {
+                mVoices[index].targetVolume = volume;
+            }
+        }
+
+        void SetFrequencyRatio(uint32_t index, float ratio) noexcept
+        {
+            if (IsValidVoice(index))
+            {
+                mVoices[index].frequencyRatio = std::min(std::max(ratio, 1.f / 1024.f), MaxFrequencyRatio);
+            }
+        }
+
+        // Sets the level of each source channel s in each output channel d, as matrix[d * sourceChannels + s].
+        void SetOutputMatrix(uint32_t index, _In_ const float* matrix) noexcept
+        {
+            if (IsValidVoice(index) && matrix)
+            {
+                auto& voice = mVoices[index];
+                memcpy(voice.targetMatrix, matrix, sizeof(float) * voice.format.channels * mOutputChannels);
+            }
+        }
+
+        // Renders frames of interleaved output, replacing the contents of the buffer.
+        void Render(_Out_writes_(frames * outputChannels) float* output, size_t frames) noexcept
+        {
+            while (frames > 0)
+            {
+                const size_t count = std::min(frames, PassFrames);
+
+                std::fill(mMix.begin(), mMix.end(), 0.f);
+
+                for (auto& voice : mVoices)
+                {
+                    if (voice.playing)
+                    {
+                        RenderVoice(voice, count);
+                    }
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    for (size_t d = 0; d < mOutputChannels; ++d)
+                    {
+                        *output++ = mMix[d * PassFrames + i];
+                    }
+                }
+
+                frames -= count;
+            }
+        }
+
+    private:
+        struct Voice
+        {
+            SourceFormat format;
+            Buffer buffer;
+            size_t frameCount;
+            size_t loopBegin;
+            size_t loopEnd;
+            size_t frame;
+            uint32_t fraction;          // Position between frame and frame + 1, in 1/2^32 units
+            uint32_t loopsPlayed;
+            float frequencyRatio;
+            float volume;
+            float targetVolume;
+            float matrix[MaxChannels * MaxChannels];
+            float targetMatrix[MaxChannels * MaxChannels];
+            bool allocated;
+            bool playing;
+            size_t cachedBlock;
+            std::vector<float> decoded; // Planar samples of the cached ADPCM block
+        };
+
+        bool IsValidVoice(uint32_t index) const noexcept
+        {
+            return index < mVoices.size() && mVoices[index].allocated;
+        }
+
+        static bool HasLoopsRemaining(const Voice& voice, uint32_t loopsPlayed) noexcept
+        {
+            return voice.buffer.loopCount == LoopInfinite || loopsPlayed < voice.buffer.loopCount;
+        }
+
+        // Decodes one Microsoft ADPCM block into planar floats.
+        static void DecodeADPCMBlock(Voice& voice, size_t block) noexcept
+        {
+            static const int s_adaptation[16] = { 230, 230, 230, 230, 307, 409, 512, 614, 768, 614, 512, 409, 307, 230, 230, 230 };
+
+            const auto& format = voice.format;
+            const uint32_t channels = format.channels;
+            const size_t samplesPerBlock = format.samplesPerBlock;
+
+            const size_t offset = block * format.blockAlign;
+            const size_t bytes = std::min<size_t>(format.blockAlign, voice.buffer.bytes - offset);
+            const uint8_t* data = voice.buffer.data + offset;
+
+            std::fill(voice.decoded.begin(), voice.decoded.end(), 0.f);
+            voice.cachedBlock = block;
+
+            if (bytes < 7u * channels)
+                return;
+
+            int coef1[2], coef2[2], delta[2], sample1[2], sample2[2];
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                const uint32_t predictor = std::min<uint32_t>(data[c], 6);
+                coef1[c] = format.coefficients[predictor][0];
+                coef2[c] = format.coefficients[predictor][1];
+
+                int16_t value;
+                memcpy(&value, data + channels + c * 2, sizeof(value));
+                delta[c] = value;
+                memcpy(&value, data + channels * 3 + c * 2, sizeof(value));
+                sample1[c] = value;
+                memcpy(&value, data + channels * 5 + c * 2, sizeof(value));
+                sample2[c] = value;
+
+                voice.decoded[c * samplesPerBlock] = float(sample2[c]) * (1.f / 32768.f);
+                voice.decoded[c * samplesPerBlock + 1] = float(sample1[c]) * (1.f / 32768.f);
+            }
+
+            // Nibbles follow the header high nibble first, alternating channels for stereo.
+            const size_t nibbleCount = std::min((bytes - 7u * channels) * 2, (samplesPerBlock - 2) * channels);
+            const uint8_t* nibbles = data + 7u * channels;
+
+            for (size_t n = 0; n < nibbleCount; ++n)
+            {
+                const uint32_t c = static_cast<uint32_t>(n % channels);
+                const int code = (n & 1) ? (nibbles[n >> 1] & 0xF) : (nibbles[n >> 1] >> 4);
+                const int signedCode = (code & 0x8) ? (code - 16) : code;
+
+                int predicted = (sample1[c] * coef1[c] + sample2[c] * coef2[c]) / 256 + signedCode * delta[c];
+                predicted = std::min(std::max(predicted, -32768), 32767);
+
+                sample2[c] = sample1[c];
+                sample1[c] = predicted;
+                delta[c] = std::max((s_adaptation[code] * delta[c]) / 256, 16);
+
+                voice.decoded[c * samplesPerBlock + 2 + n / channels] = float(predicted) * (1.f / 32768.f);
+            }
+        }
+
+        // Converts count consecutive source frames into planar staging, starting at the given index.
+        void ReadFrames(Voice& voice, size_t frame, size_t index, size_t count, size_t stride) noexcept
+        {
+            const auto& format = voice.format;
+            const uint32_t channels = format.channels;
+
+            if (format.tag == Format_ADPCM)
+            {
+                for (size_t i = 0; i < count; ++i, ++frame)
+                {
+                    const size_t block = frame / format.samplesPerBlock;
+                    if (block != voice.cachedBlock)
+                    {
+                        DecodeADPCMBlock(voice, block);
+                    }
+
+                    const size_t sample = frame % format.samplesPerBlock;
+                    for (uint32_t c = 0; c < channels; ++c)
+                    {
+                        mSource[c * stride + index + i] = voice.decoded[c * format.samplesPerBlock + sample];
+                    }
+                }
+                return;
+            }
+
+            const uint8_t* src = voice.buffer.data + frame * format.blockAlign;
+
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                float* dest = mSource.data() + c * stride + index;
+                const uint8_t* p = src + c * (format.bitsPerSample / 8);
+
+                switch (format.bitsPerSample)
+                {
+                    case 8:
+                        for (size_t i = 0; i < count; ++i, p += format.blockAlign)
+                        {
+                            dest[i] = float(int(*p) - 128) * (1.f / 128.f);
+                        }
+                        break;
+
+                    case 16:
+                        for (size_t i = 0; i < count; ++i, p += format.blockAlign)
+                        {
+                            int16_t v;
+                            memcpy(&v, p, sizeof(v));
+                            dest[i] = float(v) * (1.f / 32768.f);
+                        }
+                        break;
+
+                    case 24:
+                        for (size_t i = 0; i < count; ++i, p += format.blockAlign)
+                        {
+                            const int32_t v = int32_t(uint32_t(p[0]) << 8 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 24) >> 8;
+                            dest[i] = float(v) * (1.f / 8388608.f);
+                        }
+                        break;
+
+                    default:
+                        if (format.tag == Format_IEEEFloat)
+                        {
+                            for (size_t i = 0; i < count; ++i, p += format.blockAlign)
+                            {
+                                memcpy(dest + i, p, sizeof(float));
+                            }
+                        }
+                        else
+                        {
+                            for (size_t i = 0; i < count; ++i, p += format.blockAlign)
+                            {
+                                int32_t v;
+                                memcpy(&v, p, sizeof(v));
+                                dest[i] = float(v) * (1.f / 2147483648.f);
+                            }
+                        }
+                        break;
+                }
+            }
+        }
+
+        void RenderVoice(Voice& voice, size_t count) noexcept
+        {
+            const uint32_t channels = voice.format.channels;
+
+            // Source position advances by step / 2^32 frames per output frame.
+            const double ratio = double(voice.frequencyRatio) * voice.format.sampleRate / mOutputSampleRate;
+            const uint64_t step = static_cast<uint64_t>(ratio * 4294967296.0);
+
+            const uint64_t end = uint64_t(voice.fraction) + step * (count - 1);
+            const size_t advance = static_cast<size_t>((uint64_t(voice.fraction) + step * count) >> 32);
+            const size_t needed = static_cast<size_t>(end >> 32) + 2;
+            const size_t stride = needed;
+
+            // Read the source frames this pass touches, remembering where the next pass starts.
+            size_t frame = voice.frame;
+            uint32_t loopsPlayed = voice.loopsPlayed;
+            size_t nextFrame = frame;
+            uint32_t nextLoopsPlayed = loopsPlayed;
+
+            const size_t total = std::max(needed, advance + 1);
+
+            for (size_t i = 0; i < total;)
+            {
+                if (frame >= voice.frameCount)
+                {
+                    // Past the end of the data, so the voice is silent and will stop.
+                    for (uint32_t c = 0; c < channels; ++c)
+                    {
+                        std::fill(mSource.begin() + c * stride + std::min(i, needed), mSource.begin() + c * stride + needed, 0.f);
+                    }
+
+                    if (advance >= i)
+                    {
+                        nextFrame = frame;
+                        nextLoopsPlayed = loopsPlayed;
+                    }
+                    break;
+                }
+
+                // Frames up to the loop end (or the end of the data) are contiguous in the buffer.
+                const bool looping = frame < voice.loopEnd && HasLoopsRemaining(voice, loopsPlayed);
+                const size_t boundary = looping ? voice.loopEnd : voice.frameCount;
+                const size_t run = std::min(total - i, boundary - frame);
+
+                if (i < needed)
+                {
+                    ReadFrames(voice, frame, i, std::min(run, needed - i), stride);
+                }
+
+                if (advance >= i && advance < i + run)
+                {
+                    nextFrame = frame + (advance - i);
+                    nextLoopsPlayed = loopsPlayed;
+                }
+
+                i += run;
+                frame += run;
+
+                if (looping && frame == voice.loopEnd)
+                {
+                    frame = voice.loopBegin;
+                    if (voice.buffer.loopCount != LoopInfinite)
+                    {
+                        ++loopsPlayed;
+                    }
+                }
+            }
+
+            // Linear interpolation into planar resampled buffers.
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                const float* src = mSource.data() + c * stride;
+                float* dst = mResampled.data() + c * PassFrames;
+
+                uint64_t position = voice.fraction;
+                for (size_t i = 0; i < count; ++i, position += step)
+                {
+                    const size_t k = static_cast<size_t>(position >> 32);
+                    const float t = float(uint32_t(position)) * (1.f / 4294967296.f);
+                    dst[i] = src[k] + (src[k + 1] - src[k]) * t;
+                }
+            }
+
+            // Accumulate into the mix with the gains ramping from their current to their target values.
+            const XMVECTOR frameOffsets = XMVectorSet(0.f, 1.f, 2.f, 3.f);
+            const float rampScale = 1.f / float(count);
+
+            for (uint32_t d = 0; d < mOutputChannels; ++d)
+            {
+                float* mix = mMix.data() + d * PassFrames;
+
+                for (uint32_t s = 0; s < channels; ++s)
+                {
+                    const float gain0 = voice.matrix[d * channels + s] * voice.volume;
+                    const float gain1 = voice.targetMatrix[d * channels + s] * voice.targetVolume;
+
+                    if (gain0 == 0.f && gain1 == 0.f)
+                        continue;
+
+                    const float* src = mResampled.data() + s * PassFrames;
+                    const float gainStep = (gain1 - gain0) * rampScale;
+
+                    XMVECTOR gain = XMVectorMultiplyAdd(frameOffsets, XMVectorReplicate(gainStep), XMVectorReplicate(gain0));
+                    const XMVECTOR gainStep4 = XMVectorReplicate(gainStep * 4.f);
+
+                    size_t i = 0;
+                    for (; i + 4 <= count; i += 4)
+                    {
+                        const XMVECTOR samples = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(src + i));
+                        const XMVECTOR sum = XMVectorMultiplyAdd(samples, gain, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(mix + i)));
+                        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(mix + i), sum);
+                        gain = XMVectorAdd(gain, gainStep4);
+                    }
+
+                    for (; i < count; ++i)
+                    {
+                        mix[i] += src[i] * (gain0 + gainStep * float(i));
+                    }
+                }
+            }
+
+            voice.volume = voice.targetVolume;
+            memcpy(voice.matrix, voice.targetMatrix, sizeof(voice.matrix));
+
+            voice.frame = nextFrame;
+            voice.fraction = static_cast<uint32_t>(uint64_t(voice.fraction) + step * count);
+            voice.loopsPlayed = nextLoopsPlayed;
+
+            if (voice.frame >= voice.frameCount)
+            {
+                voice.playing = false;
+                voice.frame = 0;
+                voice.fraction = 0;
+                voice.loopsPlayed = 0;
+                --mActiveVoices;
+            }
+        }
+
+        uint32_t                mOutputChannels;
+        uint32_t                mOutputSampleRate;
+        size_t                  mActiveVoices;
+        std::vector<Voice>      mVoices;
+        std::vector<uint32_t>   mFreeVoices;
+        std::vector<float>      mMix;           // Planar, PassFrames per output channel
+        std::vector<float>      mResampled;     // Planar, PassFrames per source channel
+        std::vector<float>      mSource;        // Planar source frames for the voice being mixed
+    };
+}
@@ -41,7 +41,6 @@ namespace
 {
     constexpr size_t DVD_SECTOR_SIZE = 2048;
     constexpr size_t ADVANCED_FORMAT_SECTOR_SIZE = 4096;
-    constexpr size_t MAX_BUFFER_COUNT = 3;
 
     #ifdef DIRECTX_ENABLE_SEEK_TABLES
     constexpr size_t MAX_STREAMING_SEEK_PACKETS = 2048;
@@ -98,7 +97,8 @@ public:
         mEndStream(false),
         mPrefetch(false),
         mSitching(false),
-        mPackets{},
+        mBufferCount(waveBank->GetStreamingReadAhead()),
+        mPackets(std::make_unique<Packets[]>(mBufferCount)),
         mCurrentDiskReadBuffer(0),
         mCurrentPlayBuffer(0),
         mBlockAlign(0),
@@ -160,9 +160,9 @@ public:
     {
         mBase.DestroyVoice();
 
-        if (mWaveBank && mWaveBank->GetAsyncHandle())
+        if (mPackets && mWaveBank && mWaveBank->GetAsyncHandle())
         {
-            for (size_t j = 0; j < MAX_BUFFER_COUNT; ++j)
+            for (size_t j = 0; j < mBufferCount; ++j)
             {
                 std::ignore = CancelIoEx(mWaveBank->GetAsyncHandle(), &mPackets[j].request);
             }
@@ -174,10 +174,7 @@ public:
             mBase.engine = nullptr;
         }
 
-        for (size_t j = 0; j < MAX_BUFFER_COUNT; ++j)
-        {
-            mPackets[j] = {};
-        }
+        mPackets.reset();
         mPacketSize = 0;
     }
 
@@ -243,7 +240,7 @@ public:
         case WAIT_OBJECT_0: // Read completed
 #ifdef VERBOSE_TRACE
             DebugTrace("INFO (Streaming): Playing... (readpos %zu) [", mCurrentPosition);
-            for (uint32_t k = 0; k < MAX_BUFFER_COUNT; ++k)
+            for (uint32_t k = 0; k < mBufferCount; ++k)
             {
                 DebugTrace("%ls ", s_debugState[static_cast<int>(mPackets[k].state)]);
             }
@@ -256,7 +253,7 @@ public:
         case (WAIT_OBJECT_0 + 1): // Play completed
 #ifdef VERBOSE_TRACE
             DebugTrace("INFO (Streaming): Reading... (readpos %zu) [", mCurrentPosition);
-            for (uint32_t k = 0; k < MAX_BUFFER_COUNT; ++k)
+            for (uint32_t k = 0; k < mBufferCount; ++k)
             {
                 DebugTrace("%ls ", s_debugState[static_cast<int>(mPackets[k].state)]);
             }
@@ -284,7 +281,7 @@ public:
     {
         mBase.GatherStatistics(stats);
 
-        stats.streamingBytes += mPacketSize * MAX_BUFFER_COUNT;
+        stats.streamingBytes += mPacketSize * mBufferCount;
     }
 
     virtual void __cdecl OnDestroyParent() noexcept override
@@ -365,7 +362,8 @@ public:
             notify{} {}
     };
 
-    Packets                         mPackets[MAX_BUFFER_COUNT];
+    uint32_t                        mBufferCount;
+    std::unique_ptr<Packets[]>      mPackets;
 
 private:
     uint32_t                        mCurrentDiskReadBuffer;
@@ -407,7 +405,7 @@ HRESULT SoundStreamInstance::Impl::AllocateStreamingBuffers(const WAVEFORMATEX*
     if (!packetSize)
         return E_UNEXPECTED;
 
-    uint64_t totalSize = uint64_t(packetSize) * uint64_t(MAX_BUFFER_COUNT);
+    uint64_t totalSize = uint64_t(packetSize) * uint64_t(mBufferCount);
     if (totalSize > UINT32_MAX)
         return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
 
@@ -421,7 +419,7 @@ HRESULT SoundStreamInstance::Impl::AllocateStreamingBuffers(const WAVEFORMATEX*
         mSitching = true;
 
         stitchSize = AlignUp<size_t>(wfx->nBlockAlign, mAsyncAlign);
-        totalSize += uint64_t(stitchSize) * uint64_t(MAX_BUFFER_COUNT);
+        totalSize += uint64_t(stitchSize) * uint64_t(mBufferCount);
         if (totalSize > UINT32_MAX)
             return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
     }
@@ -469,7 +467,7 @@ HRESULT SoundStreamInstance::Impl::AllocateStreamingBuffers(const WAVEFORMATEX*
     #else
         uint8_t* ptr = mStreamBuffer.get();
     #endif
-        for (size_t j = 0; j < MAX_BUFFER_COUNT; ++j)
+        for (size_t j = 0; j < mBufferCount; ++j)
         {
             mPackets[j].buffer = ptr;
             mPackets[j].stitchBuffer = nullptr;
@@ -480,7 +478,7 @@ HRESULT SoundStreamInstance::Impl::AllocateStreamingBuffers(const WAVEFORMATEX*
 
         if (stitchSize > 0)
         {
-            for (size_t j = 0; j < MAX_BUFFER_COUNT; ++j)
+            for (size_t j = 0; j < mBufferCount; ++j)
             {
                 mPackets[j].stitchBuffer = ptr;
                 ptr += stitchSize;
@@ -512,9 +510,9 @@ HRESULT SoundStreamInstance::Impl::ReadBuffers() noexcept
     HANDLE async = mWaveBank->GetAsyncHandle();
 
     const uint32_t readBuffer = mCurrentDiskReadBuffer;
-    for (uint32_t j = 0; j < MAX_BUFFER_COUNT; ++j)
+    for (uint32_t j = 0; j < mBufferCount; ++j)
     {
-        uint32_t entry = (j + readBuffer) % uint32_t(MAX_BUFFER_COUNT);
+        uint32_t entry = (j + readBuffer) % mBufferCount;
         if (mPackets[entry].state == State::FREE)
         {
             if (mCurrentPosition < mLengthInBytes)
@@ -544,7 +542,7 @@ HRESULT SoundStreamInstance::Impl::ReadBuffers() noexcept
 
                 mCurrentPosition += cbValid;
 
-                mCurrentDiskReadBuffer = (entry + 1) % uint32_t(MAX_BUFFER_COUNT);
+                mCurrentDiskReadBuffer = (entry + 1) % mBufferCount;
 
                 mPackets[entry].state = State::PENDING;
 
@@ -567,7 +565,7 @@ HRESULT SoundStreamInstance::Impl::PlayBuffers() noexcept
 {
     HANDLE async = mWaveBank->GetAsyncHandle();
 
-    for (uint32_t j = 0; j < MAX_BUFFER_COUNT; ++j)
+    for (uint32_t j = 0; j < mBufferCount; ++j)
     {
         if (mPackets[j].state == State::PENDING)
         {
@@ -595,7 +593,7 @@ HRESULT SoundStreamInstance::Impl::PlayBuffers() noexcept
     if (!mBase.voice || !mPlaying)
         return S_FALSE;
 
-    for (uint32_t j = 0; j < MAX_BUFFER_COUNT; ++j)
+    for (uint32_t j = 0; j < mBufferCount; ++j)
     {
         if (mPackets[mCurrentPlayBuffer].state != State::READY)
             break;
@@ -625,7 +623,7 @@ HRESULT SoundStreamInstance::Impl::PlayBuffers() noexcept
                 // Compute how many bytes at the start of our current packet are the tail of the partial block.
                 thisFrameStitch = mBlockAlign - prevFrameStitch;
 
-                const uint32_t k = (mCurrentPlayBuffer + MAX_BUFFER_COUNT - 1) % MAX_BUFFER_COUNT;
+                const uint32_t k = (mCurrentPlayBuffer + mBufferCount - 1) % mBufferCount;
                 if (mPackets[k].state == State::READY || mPackets[k].state == State::PLAYING)
                 {
                     // Compute how many bytes at the start of the previous packet were the tail of the previous stitch block.
@@ -727,7 +725,7 @@ HRESULT SoundStreamInstance::Impl::PlayBuffers() noexcept
         }
 
         mPackets[mCurrentPlayBuffer].state = State::PLAYING;
-        mCurrentPlayBuffer = (mCurrentPlayBuffer + 1) % uint32_t(MAX_BUFFER_COUNT);
+        mCurrentPlayBuffer = (mCurrentPlayBuffer + 1) % mBufferCount;
     }
 
     return S_OK;
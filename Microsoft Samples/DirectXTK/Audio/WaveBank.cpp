@@ -18,6 +18,13 @@
 
 using namespace DirectX;
 
+namespace
+{
+    constexpr unsigned int DEFAULT_STREAMING_READ_AHEAD = 3;
+    constexpr unsigned int MIN_STREAMING_READ_AHEAD = 2;
+    constexpr unsigned int MAX_STREAMING_READ_AHEAD = 16;
+}
+
 
 //======================================================================================
 // WaveBank
@@ -31,7 +38,8 @@ public:
         mEngine(engine),
         mOneShots(0),
         mPrepared(false),
-        mStreaming(false)
+        mStreaming(false),
+        mReadAhead(DEFAULT_STREAMING_READ_AHEAD)
     {
         assert(mEngine != nullptr);
         mEngine->RegisterNotify(this, false);
@@ -134,6 +142,7 @@ public:
     uint32_t                            mOneShots;
     bool                                mPrepared;
     bool                                mStreaming;
+    unsigned int                        mReadAhead;
 };
 
 
@@ -450,6 +459,18 @@ bool WaveBank::IsAdvancedFormat() const noexcept
 }
 
 
+void WaveBank::SetStreamingReadAhead(unsigned int packetCount) noexcept
+{
+    pImpl->mReadAhead = std::min(std::max(packetCount, MIN_STREAMING_READ_AHEAD), MAX_STREAMING_READ_AHEAD);
+}
+
+
+unsigned int WaveBank::GetStreamingReadAhead() const noexcept
+{
+    return pImpl->mReadAhead;
+}
+
+
 size_t WaveBank::GetSampleSizeInBytes(unsigned int index) const noexcept
 {
     if (index >= pImpl->mReader.Count())
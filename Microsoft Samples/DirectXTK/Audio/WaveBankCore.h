@@ -0,0 +1,616 @@
+//--------------------------------------------------------------------------------------
+// File: WaveBankCore.h
+//
+// Platform-neutral wave bank (XWB) file structures, validation, metadata and seek table
+// parsing used by WaveBankReader
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4201 4203)
+#endif
+
+
+namespace DirectX
+{
+    namespace WaveBankCore
+    {
+        inline uint32_t ByteSwap(uint32_t value) noexcept
+        {
+        #ifdef _MSC_VER
+            return _byteswap_ulong(value);
+        #else
+            return __builtin_bswap32(value);
+        #endif
+        }
+
+        constexpr uint32_t MakeFourCC(char ch0, char ch1, char ch2, char ch3) noexcept
+        {
+            return uint32_t(uint8_t(ch0)) | (uint32_t(uint8_t(ch1)) << 8) | (uint32_t(uint8_t(ch2)) << 16) | (uint32_t(uint8_t(ch3)) << 24);
+        }
+
+#pragma pack(push, 1)
+
+        constexpr size_t DVD_SECTOR_SIZE = 2048;
+        constexpr size_t DVD_BLOCK_SIZE = DVD_SECTOR_SIZE * 16;
+
+        constexpr size_t ALIGNMENT_MIN = 4;
+        constexpr size_t ALIGNMENT_DVD = DVD_SECTOR_SIZE;
+
+        constexpr size_t MAX_DATA_SEGMENT_SIZE = 0xFFFFFFFF;
+        constexpr size_t MAX_COMPACT_DATA_SEGMENT_SIZE = 0x001FFFFF;
+
+        struct REGION
+        {
+            uint32_t    dwOffset;   // Region offset, in bytes.
+            uint32_t    dwLength;   // Region length, in bytes.
+
+            void BigEndian() noexcept
+            {
+                dwOffset = ByteSwap(dwOffset);
+                dwLength = ByteSwap(dwLength);
+            }
+        };
+
+        struct SAMPLEREGION
+        {
+            uint32_t    dwStartSample;  // Start sample for the region.
+            uint32_t    dwTotalSamples; // Region length in samples.
+
+            void BigEndian() noexcept
+            {
+                dwStartSample = ByteSwap(dwStartSample);
+                dwTotalSamples = ByteSwap(dwTotalSamples);
+            }
+        };
+
+        struct HEADER
+        {
+            static constexpr uint32_t SIGNATURE = MakeFourCC('W', 'B', 'N', 'D');
+            static constexpr uint32_t BE_SIGNATURE = MakeFourCC('D', 'N', 'B', 'W');
+            static constexpr uint32_t VERSION = 44;
+
+            enum SEGIDX
+            {
+                SEGIDX_BANKDATA = 0,       // Bank data
+                SEGIDX_ENTRYMETADATA,      // Entry meta-data
+                SEGIDX_SEEKTABLES,         // Storage for seek tables for the encoded waves.
+                SEGIDX_ENTRYNAMES,         // Entry friendly names
+                SEGIDX_ENTRYWAVEDATA,      // Entry wave data
+                SEGIDX_COUNT
+            };
+
+            uint32_t    dwSignature;            // File signature
+            uint32_t    dwVersion;              // Version of the tool that created the file
+            uint32_t    dwHeaderVersion;        // Version of the file format
+            REGION      Segments[SEGIDX_COUNT]; // Segment lookup table
+
+            void BigEndian() noexcept
+            {
+                // Leave dwSignature alone as indicator of BE vs. LE
+
+                dwVersion = ByteSwap(dwVersion);
+                dwHeaderVersion = ByteSwap(dwHeaderVersion);
+                for (size_t j = 0; j < SEGIDX_COUNT; ++j)
+                {
+                    Segments[j].BigEndian();
+                }
+            }
+        };
+
+        union MINIWAVEFORMAT
+        {
+            static constexpr uint32_t TAG_PCM = 0x0;
+            static constexpr uint32_t TAG_XMA = 0x1;
+            static constexpr uint32_t TAG_ADPCM = 0x2;
+            static constexpr uint32_t TAG_WMA = 0x3;
+
+            static constexpr uint32_t BITDEPTH_8 = 0x0; // PCM only
+            static constexpr uint32_t BITDEPTH_16 = 0x1; // PCM only
+
+            static constexpr size_t ADPCM_BLOCKALIGN_CONVERSION_OFFSET = 22;
+
+            struct
+            {
+                uint32_t       wFormatTag : 2;        // Format tag
+                uint32_t       nChannels : 3;        // Channel count (1 - 6)
+                uint32_t       nSamplesPerSec : 18;       // Sampling rate
+                uint32_t       wBlockAlign : 8;        // Block alignment.  For WMA, lower 6 bits block alignment index, upper 2 bits bytes-per-second index.
+                uint32_t       wBitsPerSample : 1;        // Bits per sample (8 vs. 16, PCM only); WMAudio2/WMAudio3 (for WMA)
+            };
+
+            uint32_t           dwValue;
+
+            void BigEndian() noexcept
+            {
+                dwValue = ByteSwap(dwValue);
+            }
+
+            uint16_t BitsPerSample() const noexcept
+            {
+                if (wFormatTag == TAG_XMA)
+                    return 16; // XMA_OUTPUT_SAMPLE_BITS == 16
+                if (wFormatTag == TAG_WMA)
+                    return 16;
+                if (wFormatTag == TAG_ADPCM)
+                    return 4; // MSADPCM_BITS_PER_SAMPLE == 4
+
+                // wFormatTag must be TAG_PCM (2 bits can only represent 4 different values)
+                return (wBitsPerSample == BITDEPTH_16) ? 16u : 8u;
+            }
+
+            uint32_t BlockAlign() const noexcept
+            {
+                switch (wFormatTag)
+                {
+                    case TAG_PCM:
+                        return wBlockAlign;
+
+                    case TAG_XMA:
+                        return (nChannels * 16 / 8); // XMA_OUTPUT_SAMPLE_BITS = 16
+
+                    case TAG_ADPCM:
+                        return (wBlockAlign + ADPCM_BLOCKALIGN_CONVERSION_OFFSET) * nChannels;
+
+                    case TAG_WMA:
+                    {
+                        static const uint32_t aWMABlockAlign[17] =
+                        {
+                            929,
+                            1487,
+                            1280,
+                            2230,
+                            8917,
+                            8192,
+                            4459,
+                            5945,
+                            2304,
+                            1536,
+                            1485,
+                            1008,
+                            2731,
+                            4096,
+                            6827,
+                            5462,
+                            1280
+                        };
+
+                        const uint32_t dwBlockAlignIndex = wBlockAlign & 0x1F;
+                        if (dwBlockAlignIndex < 17)
+                            return aWMABlockAlign[dwBlockAlignIndex];
+                    }
+                    break;
+                }
+
+                return 0;
+            }
+
+            uint32_t AvgBytesPerSec() const noexcept
+            {
+                switch (wFormatTag)
+                {
+                    case TAG_PCM:
+                        return nSamplesPerSec * wBlockAlign;
+
+                    case TAG_XMA:
+                        return nSamplesPerSec * BlockAlign();
+
+                    case TAG_ADPCM:
+                    {
+                        const uint32_t blockAlign = BlockAlign();
+                        const uint32_t samplesPerAdpcmBlock = AdpcmSamplesPerBlock();
+                        return blockAlign * nSamplesPerSec / samplesPerAdpcmBlock;
+                    }
+
+                    case TAG_WMA:
+                    {
+                        static const uint32_t aWMAAvgBytesPerSec[7] =
+                        {
+                            12000,
+                            24000,
+                            4000,
+                            6000,
+                            8000,
+                            20000,
+                            2500
+                        };
+                        // bitrate = entry * 8
+
+                        const uint32_t dwBytesPerSecIndex = wBlockAlign >> 5;
+                        if (dwBytesPerSecIndex < 7)
+                            return aWMAAvgBytesPerSec[dwBytesPerSecIndex];
+                    }
+                    break;
+                }
+
+                return 0;
+            }
+
+            uint32_t AdpcmSamplesPerBlock() const noexcept
+            {
+                const uint32_t nBlockAlign = (wBlockAlign + ADPCM_BLOCKALIGN_CONVERSION_OFFSET) * nChannels;
+                return nBlockAlign * 2 / uint32_t(nChannels) - 12;
+            }
+
+            template<typename TADPCMFormat>
+            void AdpcmFillCoefficientTable(TADPCMFormat *fmt) const noexcept
+            {
+                // These are fixed since we are always using MS ADPCM
+                fmt->wNumCoef = 7 /* MSADPCM_NUM_COEFFICIENTS */;
+
+                static const int16_t aCoef[7][2] = { { 256, 0}, {512, -256}, {0,0}, {192,64}, {240,0}, {460, -208}, {392,-232} };
+                memcpy(&fmt->aCoef, aCoef, sizeof(aCoef));
+            }
+        };
+
+        struct BUILDTIME
+        {
+            uint32_t    dwLowDateTime;
+            uint32_t    dwHighDateTime;
+        };
+
+        struct BANKDATA
+        {
+            static constexpr size_t BANKNAME_LENGTH = 64;
+
+            static constexpr uint32_t TYPE_BUFFER = 0x00000000;
+            static constexpr uint32_t TYPE_STREAMING = 0x00000001;
+            static constexpr uint32_t TYPE_MASK = 0x00000001;
+
+            static constexpr uint32_t FLAGS_ENTRYNAMES = 0x00010000;
+            static constexpr uint32_t FLAGS_COMPACT = 0x00020000;
+            static constexpr uint32_t FLAGS_SYNC_DISABLED = 0x00040000;
+            static constexpr uint32_t FLAGS_SEEKTABLES = 0x00080000;
+            static constexpr uint32_t FLAGS_MASK = 0x000F0000;
+
+            uint32_t        dwFlags;                        // Bank flags
+            uint32_t        dwEntryCount;                   // Number of entries in the bank
+            char            szBankName[BANKNAME_LENGTH];    // Bank friendly name
+            uint32_t        dwEntryMetaDataElementSize;     // Size of each entry meta-data element, in bytes
+            uint32_t        dwEntryNameElementSize;         // Size of each entry name element, in bytes
+            uint32_t        dwAlignment;                    // Entry alignment, in bytes
+            MINIWAVEFORMAT  CompactFormat;                  // Format data for compact bank
+            BUILDTIME       BuildTime;                      // Build timestamp (FILETIME)
+
+            void BigEndian() noexcept
+            {
+                dwFlags = ByteSwap(dwFlags);
+                dwEntryCount = ByteSwap(dwEntryCount);
+                dwEntryMetaDataElementSize = ByteSwap(dwEntryMetaDataElementSize);
+                dwEntryNameElementSize = ByteSwap(dwEntryNameElementSize);
+                dwAlignment = ByteSwap(dwAlignment);
+                CompactFormat.BigEndian();
+                BuildTime.dwLowDateTime = ByteSwap(BuildTime.dwLowDateTime);
+                BuildTime.dwHighDateTime = ByteSwap(BuildTime.dwHighDateTime);
+            }
+        };
+
+        struct ENTRY
+        {
+            static constexpr uint32_t FLAGS_READAHEAD = 0x00000001;     // Enable stream read-ahead
+            static constexpr uint32_t FLAGS_LOOPCACHE = 0x00000002;     // One or more looping sounds use this wave
+            static constexpr uint32_t FLAGS_REMOVELOOPTAIL = 0x00000004;// Remove data after the end of the loop region
+            static constexpr uint32_t FLAGS_IGNORELOOP = 0x00000008;    // Used internally when the loop region can't be used
+            static constexpr uint32_t FLAGS_MASK = 0x00000008;
+
+            union
+            {
+                struct
+                {
+                    // Entry flags
+                    uint32_t                   dwFlags : 4;
+
+                    // Duration of the wave, in units of one sample.
+                    // For instance, a ten second long wave sampled
+                    // at 48KHz would have a duration of 480,000.
+                    // This value is not affected by the number of
+                    // channels, the number of bits per sample, or the
+                    // compression format of the wave.
+                    uint32_t                   Duration : 28;
+                };
+                uint32_t dwFlagsAndDuration;
+            };
+
+            MINIWAVEFORMAT  Format;         // Entry format.
+            REGION          PlayRegion;     // Region within the wave data segment that contains this entry.
+            SAMPLEREGION    LoopRegion;     // Region within the wave data (in samples) that should loop.
+
+            void BigEndian() noexcept
+            {
+                dwFlagsAndDuration = ByteSwap(dwFlagsAndDuration);
+                Format.BigEndian();
+                PlayRegion.BigEndian();
+                LoopRegion.BigEndian();
+            }
+        };
+
+        struct ENTRYCOMPACT
+        {
+            uint32_t       dwOffset : 21;       // Data offset, in multiplies of the bank alignment
+            uint32_t       dwLengthDeviation : 11;       // Data length deviation, in bytes
+
+            void BigEndian() noexcept
+            {
+                *reinterpret_cast<uint32_t*>(this) = ByteSwap(*reinterpret_cast<const uint32_t*>(this));
+            }
+
+            void ComputeLocations(uint32_t& offset, uint32_t& length, uint32_t index, const HEADER& header, const BANKDATA& data, const ENTRYCOMPACT* entries) const noexcept
+            {
+                offset = dwOffset * data.dwAlignment;
+
+                if (index < (data.dwEntryCount - 1))
+                {
+                    length = (entries[index + 1].dwOffset * data.dwAlignment) - offset - dwLengthDeviation;
+                }
+                else
+                {
+                    length = header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength - offset - dwLengthDeviation;
+                }
+            }
+
+            static uint32_t GetDuration(uint32_t length, const BANKDATA& data, const uint32_t* seekTable) noexcept
+            {
+                switch (data.CompactFormat.wFormatTag)
+                {
+                    case MINIWAVEFORMAT::TAG_ADPCM:
+                    {
+                        uint32_t duration = (length / data.CompactFormat.BlockAlign()) * data.CompactFormat.AdpcmSamplesPerBlock();
+                        const uint32_t partial = length % data.CompactFormat.BlockAlign();
+                        if (partial)
+                        {
+                            if (partial >= (7u * data.CompactFormat.nChannels))
+                                duration += (partial * 2 / data.CompactFormat.nChannels - 12);
+                        }
+                        return duration;
+                    }
+
+                    case MINIWAVEFORMAT::TAG_WMA:
+                        if (seekTable)
+                        {
+                            const uint32_t seekCount = *seekTable;
+                            if (seekCount > 0)
+                            {
+                                return seekTable[seekCount] / uint32_t(2 * data.CompactFormat.nChannels);
+                            }
+                        }
+                        return 0;
+
+                    case MINIWAVEFORMAT::TAG_XMA:
+                        if (seekTable)
+                        {
+                            const uint32_t seekCount = *seekTable;
+                            if (seekCount > 0)
+                            {
+                                return seekTable[seekCount];
+                            }
+                        }
+                        return 0;
+
+                    default:
+                        return uint32_t((uint64_t(length) * 8)
+                            / (uint64_t(data.CompactFormat.BitsPerSample()) * uint64_t(data.CompactFormat.nChannels)));
+                }
+            }
+        };
+
+#pragma pack(pop)
+
+        static_assert(sizeof(REGION) == 8, "Mismatch with xact3wb.h");
+        static_assert(sizeof(SAMPLEREGION) == 8, "Mismatch with xact3wb.h");
+        static_assert(sizeof(HEADER) == 52, "Mismatch with xact3wb.h");
+        static_assert(sizeof(ENTRY) == 24, "Mismatch with xact3wb.h");
+        static_assert(sizeof(MINIWAVEFORMAT) == 4, "Mismatch with xact3wb.h");
+        static_assert(sizeof(ENTRYCOMPACT) == 4, "Mismatch with xact3wb.h");
+        static_assert(sizeof(BANKDATA) == 96, "Mismatch with xact3wb.h");
+
+        // Returns the seek table of an entry (a count followed by that many values), or nullptr
+        // if the entry has none or the table does not lie within the seek table segment.
+        inline const uint32_t* FindSeekTable(uint32_t index, const uint8_t* seekTable, const HEADER& header, const BANKDATA& data) noexcept
+        {
+            if (!seekTable || index >= data.dwEntryCount)
+                return nullptr;
+
+            const uint64_t seekSize = header.Segments[HEADER::SEGIDX_SEEKTABLES].dwLength;
+
+            if ((uint64_t(index) + 1) * sizeof(uint32_t) > seekSize)
+                return nullptr;
+
+            uint32_t offset;
+            memcpy(&offset, seekTable + size_t(index) * sizeof(uint32_t), sizeof(offset));
+            if (offset == uint32_t(-1))
+                return nullptr;
+
+            const uint64_t tableOffset = uint64_t(offset) + sizeof(uint32_t) * uint64_t(data.dwEntryCount);
+
+            if (tableOffset + sizeof(uint32_t) > seekSize)
+                return nullptr;
+
+            auto table = reinterpret_cast<const uint32_t*>(seekTable + tableOffset);
+
+            if (tableOffset + (uint64_t(*table) + 1) * sizeof(uint32_t) > seekSize)
+                return nullptr;
+
+            return table;
+        }
+
+
+        //----------------------------------------------------------------------------------
+        // Checks the file header, converting it to little-endian if needed.
+        inline bool ValidateHeader(HEADER& header, bool& bigEndian) noexcept
+        {
+            if (header.dwSignature != HEADER::SIGNATURE && header.dwSignature != HEADER::BE_SIGNATURE)
+                return false;
+
+            bigEndian = (header.dwSignature == HEADER::BE_SIGNATURE);
+            if (bigEndian)
+            {
+                header.BigEndian();
+            }
+
+            return header.dwHeaderVersion == HEADER::VERSION;
+        }
+
+
+        // Checks the (already little-endian) bank data against the header.
+        inline bool ValidateBankData(const HEADER& header, const BANKDATA& data) noexcept
+        {
+            if (data.dwFlags & BANKDATA::TYPE_STREAMING)
+            {
+                if (data.dwAlignment < ALIGNMENT_DVD)
+                    return false;
+                if (data.dwAlignment % DVD_SECTOR_SIZE)
+                    return false;
+            }
+            else if (data.dwAlignment < ALIGNMENT_MIN)
+            {
+                return false;
+            }
+
+            if (data.dwFlags & BANKDATA::FLAGS_COMPACT)
+            {
+                if (data.dwEntryMetaDataElementSize != sizeof(ENTRYCOMPACT))
+                    return false;
+
+                // Data segment is too large to be valid compact wavebank
+                if (header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength > (MAX_COMPACT_DATA_SEGMENT_SIZE * data.dwAlignment))
+                    return false;
+            }
+            else if (data.dwEntryMetaDataElementSize != sizeof(ENTRY))
+            {
+                return false;
+            }
+
+            return uint64_t(header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength)
+                == uint64_t(data.dwEntryCount) * uint64_t(data.dwEntryMetaDataElementSize);
+        }
+
+
+        // Converts the entry metadata and seek tables of a big-endian (Xbox 360) bank.
+        inline void SwapEntries(_Inout_ void* entries, const BANKDATA& data) noexcept
+        {
+            if (data.dwFlags & BANKDATA::FLAGS_COMPACT)
+            {
+                auto ptr = static_cast<ENTRYCOMPACT*>(entries);
+                for (size_t j = 0; j < data.dwEntryCount; ++j, ++ptr)
+                    ptr->BigEndian();
+            }
+            else
+            {
+                auto ptr = static_cast<ENTRY*>(entries);
+                for (size_t j = 0; j < data.dwEntryCount; ++j, ++ptr)
+                    ptr->BigEndian();
+            }
+        }
+
+        inline void SwapSeekTables(_Inout_updates_bytes_(seekLen) uint8_t* seekData, size_t seekLen) noexcept
+        {
+            for (size_t j = 0; j + sizeof(uint32_t) <= seekLen; j += sizeof(uint32_t))
+            {
+                uint32_t value;
+                memcpy(&value, seekData + j, sizeof(value));
+                value = ByteSwap(value);
+                memcpy(seekData + j, &value, sizeof(value));
+            }
+        }
+
+
+        // Builds the name to index table from the entry names segment.
+        inline void ParseNames(
+            _In_reads_bytes_(namesBytes) const char* names,
+            size_t namesBytes,
+            const BANKDATA& data,
+            std::map<std::string, uint32_t>& result)
+        {
+            if (namesBytes < uint64_t(data.dwEntryNameElementSize) * uint64_t(data.dwEntryCount))
+                return;
+
+            constexpr size_t MaxNameLength = 63;
+            const size_t length = (data.dwEntryNameElementSize < MaxNameLength) ? data.dwEntryNameElementSize : MaxNameLength;
+
+            for (uint32_t j = 0; j < data.dwEntryCount; ++j)
+            {
+                const char* name = names + size_t(data.dwEntryNameElementSize) * j;
+
+                auto end = static_cast<const char*>(memchr(name, 0, length));
+                result[std::string(name, end ? end : name + length)] = j;
+            }
+        }
+
+
+        // Location and loop region of an entry.
+        struct EntryMetadata
+        {
+            uint32_t    duration;
+            uint32_t    loopStart;
+            uint32_t    loopLength;
+            uint32_t    offsetBytes;    // Relative to the start of the wave data segment
+            uint32_t    lengthBytes;
+        };
+
+        // Reads the metadata of an entry, returning false if the index is out of range.
+        inline bool GetEntryMetadata(
+            uint32_t index,
+            const HEADER& header,
+            const BANKDATA& data,
+            _In_ const void* entries,
+            _In_opt_ const uint8_t* seekData,
+            EntryMetadata& metadata) noexcept
+        {
+            if (index >= data.dwEntryCount || !entries)
+                return false;
+
+            if (data.dwFlags & BANKDATA::FLAGS_COMPACT)
+            {
+                auto compact = static_cast<const ENTRYCOMPACT*>(entries);
+                auto& entry = compact[index];
+
+                uint32_t dwOffset, dwLength;
+                entry.ComputeLocations(dwOffset, dwLength, index, header, data, compact);
+
+                auto seekTable = FindSeekTable(index, seekData, header, data);
+                metadata.duration = entry.GetDuration(dwLength, data, seekTable);
+                metadata.loopStart = metadata.loopLength = 0;
+                metadata.offsetBytes = dwOffset;
+                metadata.lengthBytes = dwLength;
+            }
+            else
+            {
+                auto& entry = static_cast<const ENTRY*>(entries)[index];
+
+                metadata.duration = entry.Duration;
+                metadata.loopStart = entry.LoopRegion.dwStartSample;
+                metadata.loopLength = entry.LoopRegion.dwTotalSamples;
+                metadata.offsetBytes = entry.PlayRegion.dwOffset;
+                metadata.lengthBytes = entry.PlayRegion.dwLength;
+            }
+
+            return true;
+        }
+
+        // Returns true if the entry lies within the wave data segment.
+        inline bool IsInWaveData(const HEADER& header, const EntryMetadata& metadata) noexcept
+        {
+            return (uint64_t(metadata.offsetBytes) + uint64_t(metadata.lengthBytes))
+                <= uint64_t(header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength);
+        }
+    }
+}
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
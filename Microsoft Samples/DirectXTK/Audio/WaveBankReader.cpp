@@ -15,6 +15,9 @@
 #include "Audio.h"
 #include "PlatformHelpers.h"
 #include "SoundCommon.h"
+#include "WaveBankCore.h"
+
+#include <thread>
 
 #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
 #ifdef __clang__
@@ -28,401 +31,27 @@
 
 namespace
 {
-#pragma pack(push, 1)
-
-    constexpr size_t DVD_SECTOR_SIZE = 2048;
-    constexpr size_t DVD_BLOCK_SIZE = DVD_SECTOR_SIZE * 16;
-
-    constexpr size_t ALIGNMENT_MIN = 4;
-    constexpr size_t ALIGNMENT_DVD = DVD_SECTOR_SIZE;
-
-    constexpr size_t MAX_DATA_SEGMENT_SIZE = 0xFFFFFFFF;
-    constexpr size_t MAX_COMPACT_DATA_SEGMENT_SIZE = 0x001FFFFF;
-
-    struct REGION
-    {
-        uint32_t    dwOffset;   // Region offset, in bytes.
-        uint32_t    dwLength;   // Region length, in bytes.
-
-        void BigEndian() noexcept
-        {
-            dwOffset = _byteswap_ulong(dwOffset);
-            dwLength = _byteswap_ulong(dwLength);
-        }
-    };
-
-    struct SAMPLEREGION
-    {
-        uint32_t    dwStartSample;  // Start sample for the region.
-        uint32_t    dwTotalSamples; // Region length in samples.
-
-        void BigEndian() noexcept
-        {
-            dwStartSample = _byteswap_ulong(dwStartSample);
-            dwTotalSamples = _byteswap_ulong(dwTotalSamples);
-        }
-    };
-
-    struct HEADER
-    {
-        static constexpr uint32_t SIGNATURE = MAKEFOURCC('W', 'B', 'N', 'D');
-        static constexpr uint32_t BE_SIGNATURE = MAKEFOURCC('D', 'N', 'B', 'W');
-        static constexpr uint32_t VERSION = 44;
-
-        enum SEGIDX
-        {
-            SEGIDX_BANKDATA = 0,       // Bank data
-            SEGIDX_ENTRYMETADATA,      // Entry meta-data
-            SEGIDX_SEEKTABLES,         // Storage for seek tables for the encoded waves.
-            SEGIDX_ENTRYNAMES,         // Entry friendly names
-            SEGIDX_ENTRYWAVEDATA,      // Entry wave data
-            SEGIDX_COUNT
-        };
-
-        uint32_t    dwSignature;            // File signature
-        uint32_t    dwVersion;              // Version of the tool that created the file
-        uint32_t    dwHeaderVersion;        // Version of the file format
-        REGION      Segments[SEGIDX_COUNT]; // Segment lookup table
-
-        void BigEndian() noexcept
-        {
-            // Leave dwSignature alone as indicator of BE vs. LE
-
-            dwVersion = _byteswap_ulong(dwVersion);
-            dwHeaderVersion = _byteswap_ulong(dwHeaderVersion);
-            for (size_t j = 0; j < SEGIDX_COUNT; ++j)
-            {
-                Segments[j].BigEndian();
-            }
-        }
-    };
-
-#pragma warning( disable : 4201 4203 )
-
-    union MINIWAVEFORMAT
-    {
-        static constexpr uint32_t TAG_PCM = 0x0;
-        static constexpr uint32_t TAG_XMA = 0x1;
-        static constexpr uint32_t TAG_ADPCM = 0x2;
-        static constexpr uint32_t TAG_WMA = 0x3;
-
-        static constexpr uint32_t BITDEPTH_8 = 0x0; // PCM only
-        static constexpr uint32_t BITDEPTH_16 = 0x1; // PCM only
-
-        static constexpr size_t ADPCM_BLOCKALIGN_CONVERSION_OFFSET = 22;
-
-        struct
-        {
-            uint32_t       wFormatTag : 2;        // Format tag
-            uint32_t       nChannels : 3;        // Channel count (1 - 6)
-            uint32_t       nSamplesPerSec : 18;       // Sampling rate
-            uint32_t       wBlockAlign : 8;        // Block alignment.  For WMA, lower 6 bits block alignment index, upper 2 bits bytes-per-second index.
-            uint32_t       wBitsPerSample : 1;        // Bits per sample (8 vs. 16, PCM only); WMAudio2/WMAudio3 (for WMA)
-        };
-
-        uint32_t           dwValue;
-
-        void BigEndian() noexcept
-        {
-            dwValue = _byteswap_ulong(dwValue);
-        }
-
-        WORD BitsPerSample() const noexcept
-        {
-            if (wFormatTag == TAG_XMA)
-                return 16; // XMA_OUTPUT_SAMPLE_BITS == 16
-            if (wFormatTag == TAG_WMA)
-                return 16;
-            if (wFormatTag == TAG_ADPCM)
-                return 4; // MSADPCM_BITS_PER_SAMPLE == 4
-
-            // wFormatTag must be TAG_PCM (2 bits can only represent 4 different values)
-            return (wBitsPerSample == BITDEPTH_16) ? 16u : 8u;
-        }
-
-        DWORD BlockAlign() const noexcept
-        {
-            switch (wFormatTag)
-            {
-                case TAG_PCM:
-                    return wBlockAlign;
-
-                case TAG_XMA:
-                    return (nChannels * 16 / 8); // XMA_OUTPUT_SAMPLE_BITS = 16
-
-                case TAG_ADPCM:
-                    return (wBlockAlign + ADPCM_BLOCKALIGN_CONVERSION_OFFSET) * nChannels;
-
-                case TAG_WMA:
-                {
-                    static const uint32_t aWMABlockAlign[17] =
-                    {
-                        929,
-                        1487,
-                        1280,
-                        2230,
-                        8917,
-                        8192,
-                        4459,
-                        5945,
-                        2304,
-                        1536,
-                        1485,
-                        1008,
-                        2731,
-                        4096,
-                        6827,
-                        5462,
-                        1280
-                    };
-
-                    const uint32_t dwBlockAlignIndex = wBlockAlign & 0x1F;
-                    if (dwBlockAlignIndex < 17)
-                        return aWMABlockAlign[dwBlockAlignIndex];
-                }
-                break;
-            }
-
-            return 0;
-        }
-
-        DWORD AvgBytesPerSec() const noexcept
-        {
-            switch (wFormatTag)
-            {
-                case TAG_PCM:
-                    return nSamplesPerSec * wBlockAlign;
-
-                case TAG_XMA:
-                    return nSamplesPerSec * BlockAlign();
-
-                case TAG_ADPCM:
-                {
-                    const uint32_t blockAlign = BlockAlign();
-                    const uint32_t samplesPerAdpcmBlock = AdpcmSamplesPerBlock();
-                    return blockAlign * nSamplesPerSec / samplesPerAdpcmBlock;
-                }
-
-                case TAG_WMA:
-                {
-                    static const uint32_t aWMAAvgBytesPerSec[7] =
-                    {
-                        12000,
-                        24000,
-                        4000,
-                        6000,
-                        8000,
-                        20000,
-                        2500
-                    };
-                    // bitrate = entry * 8
-
-                    const uint32_t dwBytesPerSecIndex = wBlockAlign >> 5;
-                    if (dwBytesPerSecIndex < 7)
-                        return aWMAAvgBytesPerSec[dwBytesPerSecIndex];
-                }
-                break;
-            }
-
-            return 0;
-        }
-
-        DWORD AdpcmSamplesPerBlock() const noexcept
-        {
-            const uint32_t nBlockAlign = (wBlockAlign + ADPCM_BLOCKALIGN_CONVERSION_OFFSET) * nChannels;
-            return nBlockAlign * 2 / uint32_t(nChannels) - 12;
-        }
-
-        void AdpcmFillCoefficientTable(ADPCMWAVEFORMAT *fmt) const noexcept
-        {
-            // These are fixed since we are always using MS ADPCM
-            fmt->wNumCoef = 7 /* MSADPCM_NUM_COEFFICIENTS */;
+#ifndef DIRECTX_NO_FILE_MAPPING
+    struct mapped_view_deleter { void operator()(const uint8_t* p) noexcept { if (p) UnmapViewOfFile(p); } };
 
-            static ADPCMCOEFSET aCoef[7] = { { 256, 0}, {512, -256}, {0,0}, {192,64}, {240,0}, {460, -208}, {392,-232} };
-            memcpy(&fmt->aCoef, aCoef, sizeof(aCoef));
-        }
-    };
-
-    struct BANKDATA
+    // Reads a byte from every page of the range, so it is all resident before XAudio2's
+    // real-time thread reads it.
+    void TouchPages(_In_reads_bytes_(length) const uint8_t* data, size_t length) noexcept
     {
-        static constexpr size_t BANKNAME_LENGTH = 64;
-
-        static constexpr uint32_t TYPE_BUFFER = 0x00000000;
-        static constexpr uint32_t TYPE_STREAMING = 0x00000001;
-        static constexpr uint32_t TYPE_MASK = 0x00000001;
-
-        static constexpr uint32_t FLAGS_ENTRYNAMES = 0x00010000;
-        static constexpr uint32_t FLAGS_COMPACT = 0x00020000;
-        static constexpr uint32_t FLAGS_SYNC_DISABLED = 0x00040000;
-        static constexpr uint32_t FLAGS_SEEKTABLES = 0x00080000;
-        static constexpr uint32_t FLAGS_MASK = 0x000F0000;
-
-        uint32_t        dwFlags;                        // Bank flags
-        uint32_t        dwEntryCount;                   // Number of entries in the bank
-        char            szBankName[BANKNAME_LENGTH];    // Bank friendly name
-        uint32_t        dwEntryMetaDataElementSize;     // Size of each entry meta-data element, in bytes
-        uint32_t        dwEntryNameElementSize;         // Size of each entry name element, in bytes
-        uint32_t        dwAlignment;                    // Entry alignment, in bytes
-        MINIWAVEFORMAT  CompactFormat;                  // Format data for compact bank
-        FILETIME        BuildTime;                      // Build timestamp
-
-        void BigEndian() noexcept
-        {
-            dwFlags = _byteswap_ulong(dwFlags);
-            dwEntryCount = _byteswap_ulong(dwEntryCount);
-            dwEntryMetaDataElementSize = _byteswap_ulong(dwEntryMetaDataElementSize);
-            dwEntryNameElementSize = _byteswap_ulong(dwEntryNameElementSize);
-            dwAlignment = _byteswap_ulong(dwAlignment);
-            CompactFormat.BigEndian();
-            BuildTime.dwLowDateTime = _byteswap_ulong(BuildTime.dwLowDateTime);
-            BuildTime.dwHighDateTime = _byteswap_ulong(BuildTime.dwHighDateTime);
-        }
-    };
-
-    struct ENTRY
-    {
-        static constexpr uint32_t FLAGS_READAHEAD = 0x00000001;     // Enable stream read-ahead
-        static constexpr uint32_t FLAGS_LOOPCACHE = 0x00000002;     // One or more looping sounds use this wave
-        static constexpr uint32_t FLAGS_REMOVELOOPTAIL = 0x00000004;// Remove data after the end of the loop region
-        static constexpr uint32_t FLAGS_IGNORELOOP = 0x00000008;    // Used internally when the loop region can't be used
-        static constexpr uint32_t FLAGS_MASK = 0x00000008;
-
-        union
-        {
-            struct
-            {
-                // Entry flags
-                uint32_t                   dwFlags : 4;
-
-                // Duration of the wave, in units of one sample.
-                // For instance, a ten second long wave sampled
-                // at 48KHz would have a duration of 480,000.
-                // This value is not affected by the number of
-                // channels, the number of bits per sample, or the
-                // compression format of the wave.
-                uint32_t                   Duration : 28;
-            };
-            uint32_t dwFlagsAndDuration;
-        };
-
-        MINIWAVEFORMAT  Format;         // Entry format.
-        REGION          PlayRegion;     // Region within the wave data segment that contains this entry.
-        SAMPLEREGION    LoopRegion;     // Region within the wave data (in samples) that should loop.
-
-        void BigEndian() noexcept
-        {
-            dwFlagsAndDuration = _byteswap_ulong(dwFlagsAndDuration);
-            Format.BigEndian();
-            PlayRegion.BigEndian();
-            LoopRegion.BigEndian();
-        }
-    };
-
-    struct ENTRYCOMPACT
-    {
-        uint32_t       dwOffset : 21;       // Data offset, in multiplies of the bank alignment
-        uint32_t       dwLengthDeviation : 11;       // Data length deviation, in bytes
-
-        void BigEndian() noexcept
-        {
-            *reinterpret_cast<uint32_t*>(this) = _byteswap_ulong(*reinterpret_cast<const uint32_t*>(this));
-        }
-
-        void ComputeLocations(DWORD& offset, DWORD& length, uint32_t index, const HEADER& header, const BANKDATA& data, const ENTRYCOMPACT* entries) const noexcept
-        {
-            offset = dwOffset * data.dwAlignment;
+        constexpr size_t PAGE_STRIDE = 4096;
 
-            if (index < (data.dwEntryCount - 1))
-            {
-                length = (entries[index + 1].dwOffset * data.dwAlignment) - offset - dwLengthDeviation;
-            }
-            else
-            {
-                length = header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength - offset - dwLengthDeviation;
-            }
-        }
-
-        static uint32_t GetDuration(DWORD length, const BANKDATA& data, const uint32_t* seekTable) noexcept
+        uint8_t sum = 0;
+        for (size_t offset = 0; offset < length; offset += PAGE_STRIDE)
         {
-            switch (data.CompactFormat.wFormatTag)
-            {
-                case MINIWAVEFORMAT::TAG_ADPCM:
-                {
-                    uint32_t duration = (length / data.CompactFormat.BlockAlign()) * data.CompactFormat.AdpcmSamplesPerBlock();
-                    const uint32_t partial = length % data.CompactFormat.BlockAlign();
-                    if (partial)
-                    {
-                        if (partial >= (7u * data.CompactFormat.nChannels))
-                            duration += (partial * 2 / data.CompactFormat.nChannels - 12);
-                    }
-                    return duration;
-                }
-
-                case MINIWAVEFORMAT::TAG_WMA:
-                    if (seekTable)
-                    {
-                        const uint32_t seekCount = *seekTable;
-                        if (seekCount > 0)
-                        {
-                            return seekTable[seekCount] / uint32_t(2 * data.CompactFormat.nChannels);
-                        }
-                    }
-                    return 0;
-
-                case MINIWAVEFORMAT::TAG_XMA:
-                    if (seekTable)
-                    {
-                        const uint32_t seekCount = *seekTable;
-                        if (seekCount > 0)
-                        {
-                            return seekTable[seekCount];
-                        }
-                    }
-                    return 0;
-
-                default:
-                    return uint32_t((uint64_t(length) * 8)
-                        / (uint64_t(data.CompactFormat.BitsPerSample()) * uint64_t(data.CompactFormat.nChannels)));
-            }
+            sum = static_cast<uint8_t>(sum + *static_cast<const volatile uint8_t*>(data + offset));
         }
-    };
-
-#pragma pack(pop)
-
-    inline const uint32_t* FindSeekTable(uint32_t index, const uint8_t* seekTable, const HEADER& header, const BANKDATA& data) noexcept
-    {
-        if (!seekTable || index >= data.dwEntryCount)
-            return nullptr;
-
-        const uint32_t seekSize = header.Segments[HEADER::SEGIDX_SEEKTABLES].dwLength;
-
-        if ((index * sizeof(uint32_t)) > seekSize)
-            return nullptr;
-
-        auto table = reinterpret_cast<const uint32_t*>(seekTable);
-        uint32_t offset = table[index];
-        if (offset == uint32_t(-1))
-            return nullptr;
-
-        offset += sizeof(uint32_t) * data.dwEntryCount;
-
-        if (offset > seekSize)
-            return nullptr;
-
-        return reinterpret_cast<const uint32_t*>(seekTable + offset);
+        std::ignore = sum;
     }
+#endif
 }
 
-static_assert(sizeof(REGION) == 8, "Mismatch with xact3wb.h");
-static_assert(sizeof(SAMPLEREGION) == 8, "Mismatch with xact3wb.h");
-static_assert(sizeof(HEADER) == 52, "Mismatch with xact3wb.h");
-static_assert(sizeof(ENTRY) == 24, "Mismatch with xact3wb.h");
-static_assert(sizeof(MINIWAVEFORMAT) == 4, "Mismatch with xact3wb.h");
-static_assert(sizeof(ENTRY) == 24, "Mismatch with xact3wb.h");
-static_assert(sizeof(ENTRYCOMPACT) == 4, "Mismatch with xact3wb.h");
-static_assert(sizeof(BANKDATA) == 96, "Mismatch with xact3wb.h");
-
 using namespace DirectX;
+using namespace DirectX::WaveBankCore;
 
 //--------------------------------------------------------------------------------------
 class WaveBankReader::Impl
@@ -460,6 +89,7 @@ public:
     HRESULT GetMetadata(_In_ uint32_t index, _Out_ Metadata& metadata) const noexcept;
 
     bool UpdatePrepared() noexcept;
+    void WaitOnPrepare() noexcept;
 
     void Clear() noexcept
     {
@@ -471,6 +101,10 @@ public:
         m_seekData.reset();
         m_waveData.reset();
 
+    #ifndef DIRECTX_NO_FILE_MAPPING
+        m_mappedFile.reset();
+    #endif
+
     #ifdef DIRECTX_ENABLE_XMA2
         if (m_xmaMemory)
         {
@@ -494,6 +128,16 @@ private:
     std::unique_ptr<uint8_t[]>          m_seekData;
     std::unique_ptr<uint8_t[]>          m_waveData;
 
+#ifndef DIRECTX_NO_FILE_MAPPING
+    std::unique_ptr<const uint8_t, mapped_view_deleter> m_mappedFile;
+    std::thread                         m_pageInThread; // Signals m_event once the mapped wave data is resident
+
+    HRESULT MapWaveData(_In_ HANDLE hFile) noexcept;
+    void WaitForPageIn() noexcept;
+#endif
+
+    const uint8_t* GetWaveDataPointer() const noexcept;
+
 #ifdef DIRECTX_ENABLE_XMA2
 public:
     void*                               m_xmaMemory;
@@ -569,21 +213,15 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName) noexcept(false)
         return HRESULT_FROM_WIN32(GetLastError());
     }
 
-    if (m_header.dwSignature != HEADER::SIGNATURE && m_header.dwSignature != HEADER::BE_SIGNATURE)
+    bool be = false;
+    if (!ValidateHeader(m_header, be))
     {
         return E_FAIL;
     }
 
-    const bool be = (m_header.dwSignature == HEADER::BE_SIGNATURE);
     if (be)
     {
         DebugTrace("INFO: \"%ls\" is a big-endian (Xbox 360) wave bank\n", szFileName);
-        m_header.BigEndian();
-    }
-
-    if (m_header.dwHeaderVersion != HEADER::VERSION)
-    {
-        return E_FAIL;
     }
 
     // Load bank data
@@ -624,44 +262,12 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName) noexcept(false)
         return HRESULT_FROM_WIN32(ERROR_NO_DATA);
     }
 
-    if (m_data.dwFlags & BANKDATA::TYPE_STREAMING)
-    {
-        if (m_data.dwAlignment < ALIGNMENT_DVD)
-            return E_FAIL;
-        if (m_data.dwAlignment % DVD_SECTOR_SIZE)
-            return E_FAIL;
-    }
-    else if (m_data.dwAlignment < ALIGNMENT_MIN)
+    if (!ValidateBankData(m_header, m_data))
     {
         return E_FAIL;
     }
 
-    if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
-    {
-        if (m_data.dwEntryMetaDataElementSize != sizeof(ENTRYCOMPACT))
-        {
-            return E_FAIL;
-        }
-
-        if (m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength > (MAX_COMPACT_DATA_SEGMENT_SIZE * m_data.dwAlignment))
-        {
-            // Data segment is too large to be valid compact wavebank
-            return E_FAIL;
-        }
-    }
-    else
-    {
-        if (m_data.dwEntryMetaDataElementSize != sizeof(ENTRY))
-        {
-            return E_FAIL;
-        }
-    }
-
     const DWORD metadataBytes = m_header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength;
-    if (metadataBytes != (m_data.dwEntryCount * m_data.dwEntryMetaDataElementSize))
-    {
-        return E_FAIL;
-    }
 
     // Load names
     const DWORD namesBytes = m_header.Segments[HEADER::SEGIDX_ENTRYNAMES].dwLength;
@@ -702,15 +308,7 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName) noexcept(false)
                 return HRESULT_FROM_WIN32(GetLastError());
             }
 
-            for (uint32_t j = 0; j < m_data.dwEntryCount; ++j)
-            {
-                const DWORD n = m_data.dwEntryNameElementSize * j;
-
-                char name[64] = {};
-                strncpy_s(name, &temp[n], sizeof(name));
-
-                m_names[name] = j;
-            }
+            ParseNames(temp.get(), namesBytes, m_data, m_names);
         }
     }
 
@@ -757,18 +355,7 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName) noexcept(false)
 
     if (be)
     {
-        if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
-        {
-            auto ptr = reinterpret_cast<ENTRYCOMPACT*>(m_entries.get());
-            for (size_t j = 0; j < m_data.dwEntryCount; ++j, ++ptr)
-                ptr->BigEndian();
-        }
-        else
-        {
-            auto ptr = reinterpret_cast<ENTRY*>(m_entries.get());
-            for (size_t j = 0; j < m_data.dwEntryCount; ++j, ++ptr)
-                ptr->BigEndian();
-        }
+        SwapEntries(m_entries.get(), m_data);
     }
 
     // Load seek tables (XMA2 / xWMA)
@@ -810,11 +397,7 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName) noexcept(false)
 
         if (be)
         {
-            auto ptr = reinterpret_cast<uint32_t*>(m_seekData.get());
-            for (size_t j = 0; j < seekLen; j += 4, ++ptr)
-            {
-                *ptr = _byteswap_ulong(*ptr);
-            }
+            SwapSeekTables(m_seekData.get(), seekLen);
         }
     }
 
@@ -894,6 +477,15 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName) noexcept(false)
         else
         #endif // XMA2
         {
+        #ifndef DIRECTX_NO_FILE_MAPPING
+            // Map the wave data rather than reading it into a copy. The bank is prepared once a
+            // helper thread has paged it all in.
+            if (SUCCEEDED(MapWaveData(hFile.get())))
+            {
+                return S_OK;
+            }
+        #endif
+
             m_waveData.reset(new (std::nothrow) uint8_t[waveLen]);
             if (!m_waveData)
                 return E_OUTOFMEMORY;
@@ -926,6 +518,10 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName) noexcept(false)
 
 void WaveBankReader::Impl::Close() noexcept
 {
+#ifndef DIRECTX_NO_FILE_MAPPING
+    WaitForPageIn();
+#endif
+
     if (m_async != INVALID_HANDLE_VALUE)
     {
         if (m_request.hEvent)
@@ -945,6 +541,10 @@ void WaveBankReader::Impl::Close() noexcept
     }
     m_event.reset();
 
+#ifndef DIRECTX_NO_FILE_MAPPING
+    m_mappedFile.reset();
+#endif
+
 #ifdef DIRECTX_ENABLE_XMA2
     if (m_xmaMemory)
     {
@@ -955,6 +555,108 @@ void WaveBankReader::Impl::Close() noexcept
 }
 
 
+#ifndef DIRECTX_NO_FILE_MAPPING
+_Use_decl_annotations_
+HRESULT WaveBankReader::Impl::MapWaveData(HANDLE hFile) noexcept
+{
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(hFile, FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    auto const& segment = m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA];
+    if ((uint64_t(segment.dwOffset) + uint64_t(segment.dwLength)) > uint64_t(fileInfo.EndOfFile.QuadPart))
+    {
+        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+    }
+
+    // The view stays valid after the mapping and file handles are closed.
+#if !defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP)
+    ScopedHandle hMapping(CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr));
+    if (!hMapping)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    const void* view = MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0);
+#else
+    ScopedHandle hMapping(CreateFileMappingFromApp(hFile, nullptr, PAGE_READONLY, 0, nullptr));
+    if (!hMapping)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    const void* view = MapViewOfFileFromApp(hMapping.get(), FILE_MAP_READ, 0, 0);
+#endif
+
+    if (!view)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    m_mappedFile.reset(static_cast<const uint8_t*>(view));
+
+    const uint8_t* waveData = m_mappedFile.get() + segment.dwOffset;
+    const size_t waveLength = segment.dwLength;
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) && (!defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP))
+    // Start reading the wave data in with large I/Os in the background.
+    WIN32_MEMORY_RANGE_ENTRY range = { const_cast<uint8_t*>(waveData), waveLength };
+    std::ignore = PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+
+    // Prefetching is only a hint, and XAudio2 must not take page faults on its real-time
+    // thread. So the pages are touched on a helper thread, like the overlapped read of the
+    // unmapped path, and the bank is prepared when it signals m_event.
+    HANDLE hEvent = m_event.get();
+    std::ignore = ResetEvent(hEvent);
+
+    try
+    {
+        m_pageInThread = std::thread([waveData, waveLength, hEvent]() noexcept
+            {
+                TouchPages(waveData, waveLength);
+                std::ignore = SetEvent(hEvent);
+            });
+    }
+    catch (...)
+    {
+        TouchPages(waveData, waveLength);
+        m_prepared = true;
+    }
+
+    return S_OK;
+}
+
+
+void WaveBankReader::Impl::WaitForPageIn() noexcept
+{
+    if (m_pageInThread.joinable())
+    {
+        m_pageInThread.join();
+        m_prepared = true;
+    }
+}
+#endif
+
+
+const uint8_t* WaveBankReader::Impl::GetWaveDataPointer() const noexcept
+{
+#ifndef DIRECTX_NO_FILE_MAPPING
+    if (m_mappedFile)
+        return m_mappedFile.get() + m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
+#endif
+
+#ifdef DIRECTX_ENABLE_XMA2
+    if (m_xmaMemory)
+        return reinterpret_cast<const uint8_t*>(m_xmaMemory);
+#endif
+
+    return m_waveData.get();
+}
+
+
 _Use_decl_annotations_
 HRESULT WaveBankReader::Impl::GetFormat(uint32_t index, WAVEFORMATEX* pFormat, size_t maxsize) const noexcept
 {
@@ -1044,7 +746,7 @@ HRESULT WaveBankReader::Impl::GetFormat(uint32_t index, WAVEFORMATEX* pFormat, s
                 {
                     auto& entry = reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get())[index];
 
-                    DWORD dwOffset, dwLength;
+                    uint32_t dwOffset, dwLength;
                     entry.ComputeLocations(dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get()));
 
                     xmaFmt->SamplesEncoded = entry.GetDuration(dwLength, m_data, seekTable);
@@ -1102,12 +804,7 @@ HRESULT WaveBankReader::Impl::GetWaveData(uint32_t index, const uint8_t** pData,
         return E_FAIL;
     }
 
-#ifdef DIRECTX_ENABLE_XMA2
-    const uint8_t* waveData = (m_xmaMemory) ? reinterpret_cast<uint8_t*>(m_xmaMemory) : m_waveData.get();
-#else
-    const uint8_t* waveData = m_waveData.get();
-#endif
-
+    const uint8_t* waveData = GetWaveDataPointer();
     if (!waveData)
         return E_FAIL;
 
@@ -1121,33 +818,15 @@ HRESULT WaveBankReader::Impl::GetWaveData(uint32_t index, const uint8_t** pData,
         return HRESULT_FROM_WIN32(ERROR_IO_INCOMPLETE);
     }
 
-    if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
+    EntryMetadata metadata;
+    if (!GetEntryMetadata(index, m_header, m_data, m_entries.get(), m_seekData.get(), metadata)
+        || !IsInWaveData(m_header, metadata))
     {
-        auto& entry = reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get())[index];
-
-        DWORD dwOffset, dwLength;
-        entry.ComputeLocations(dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get()));
-
-        if ((uint64_t(dwOffset) + uint64_t(dwLength)) > uint64_t(m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength))
-        {
-            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
-        }
-
-        *pData = &waveData[dwOffset];
-        dataSize = dwLength;
+        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
     }
-    else
-    {
-        auto& entry = reinterpret_cast<const ENTRY*>(m_entries.get())[index];
 
-        if ((uint64_t(entry.PlayRegion.dwOffset) + uint64_t(entry.PlayRegion.dwLength)) > uint64_t(m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength))
-        {
-            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
-        }
-
-        *pData = &waveData[entry.PlayRegion.dwOffset];
-        dataSize = entry.PlayRegion.dwLength;
-    }
+    *pData = &waveData[metadata.offsetBytes];
+    dataSize = metadata.lengthBytes;
 
     return S_OK;
 }
@@ -1206,29 +885,17 @@ HRESULT WaveBankReader::Impl::GetMetadata(uint32_t index, Metadata& metadata) co
         return E_FAIL;
     }
 
-    if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
+    EntryMetadata entryMetadata;
+    if (!GetEntryMetadata(index, m_header, m_data, m_entries.get(), m_seekData.get(), entryMetadata))
     {
-        auto& entry = reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get())[index];
-
-        DWORD dwOffset, dwLength;
-        entry.ComputeLocations(dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get()));
-
-        auto seekTable = FindSeekTable(index, m_seekData.get(), m_header, m_data);
-        metadata.duration = entry.GetDuration(dwLength, m_data, seekTable);
-        metadata.loopStart = metadata.loopLength = 0;
-        metadata.offsetBytes = dwOffset;
-        metadata.lengthBytes = dwLength;
+        return E_FAIL;
     }
-    else
-    {
-        auto& entry = reinterpret_cast<const ENTRY*>(m_entries.get())[index];
 
-        metadata.duration = entry.Duration;
-        metadata.loopStart = entry.LoopRegion.dwStartSample;
-        metadata.loopLength = entry.LoopRegion.dwTotalSamples;
-        metadata.offsetBytes = entry.PlayRegion.dwOffset;
-        metadata.lengthBytes = entry.PlayRegion.dwLength;
-    }
+    metadata.duration = entryMetadata.duration;
+    metadata.loopStart = entryMetadata.loopStart;
+    metadata.loopLength = entryMetadata.loopLength;
+    metadata.offsetBytes = entryMetadata.offsetBytes;
+    metadata.lengthBytes = entryMetadata.lengthBytes;
 
     if (m_data.dwFlags & BANKDATA::TYPE_STREAMING)
     {
@@ -1248,6 +915,17 @@ bool WaveBankReader::Impl::UpdatePrepared() noexcept
     if (m_prepared)
         return true;
 
+#ifndef DIRECTX_NO_FILE_MAPPING
+    if (m_pageInThread.joinable())
+    {
+        if (WaitForSingleObjectEx(m_event.get(), 0, FALSE) == WAIT_OBJECT_0)
+        {
+            WaitForPageIn();
+        }
+        return m_prepared;
+    }
+#endif
+
     if (m_async == INVALID_HANDLE_VALUE)
         return false;
 
@@ -1314,20 +992,32 @@ bool WaveBankReader::IsPrepared() noexcept
 }
 
 
-void WaveBankReader::WaitOnPrepare() noexcept
+void WaveBankReader::Impl::WaitOnPrepare() noexcept
 {
-    if (pImpl->m_prepared)
+    if (m_prepared)
         return;
 
-    if (pImpl->m_request.hEvent)
+#ifndef DIRECTX_NO_FILE_MAPPING
+    WaitForPageIn();
+    if (m_prepared)
+        return;
+#endif
+
+    if (m_request.hEvent)
     {
-        std::ignore = WaitForSingleObjectEx(pImpl->m_request.hEvent, INFINITE, FALSE);
+        std::ignore = WaitForSingleObjectEx(m_request.hEvent, INFINITE, FALSE);
 
-        pImpl->UpdatePrepared();
+        UpdatePrepared();
     }
 }
 
 
+void WaveBankReader::WaitOnPrepare() noexcept
+{
+    pImpl->WaitOnPrepare();
+}
+
+
 bool WaveBankReader::HasNames() const noexcept
 {
     return !pImpl->m_names.empty();
@@ -0,0 +1,444 @@
+//--------------------------------------------------------------------------------------
+// File: AsyncTextureQueueTest.cpp
+//
+// Checks the background texture loads used by EffectFactory with a fake loader: combined
+// requests, placeholders swapped out by Update, failed loads and the statistics
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "AsyncTextureQueue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    using Texture = std::shared_ptr<int>;
+    using Context = std::shared_ptr<std::string>;
+    using Queue = AsyncTextureQueue<Texture, Context>;
+
+    constexpr int c_Placeholder = -1;
+    const std::wstring c_Directory = L"textures\\";
+
+    // Loads "textures" whose value is the length of their name. Names starting with "missing"
+    // fail and names starting with "throw" throw. Loads block until the gate is opened.
+    class FakeLoader
+    {
+    public:
+        FakeLoader() noexcept : mOpen(true) {}
+
+        Texture Load(const std::wstring& directory, const std::wstring& name, bool)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mSignal.wait(lock, [this] { return mOpen; });
+
+            ++mLoads[name];
+            mDirectories[name] = directory;
+
+            if (name.compare(0, 7, L"missing") == 0)
+                return {};
+
+            if (name.compare(0, 5, L"throw") == 0)
+                throw std::runtime_error("FakeLoader");
+
+            return std::make_shared<int>(static_cast<int>(name.size()));
+        }
+
+        void Close()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mOpen = false;
+        }
+
+        void Open()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mOpen = true;
+            }
+            mSignal.notify_all();
+        }
+
+        int Loads(const std::wstring& name)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mLoads.find(name);
+            return (it != mLoads.end()) ? it->second : 0;
+        }
+
+        std::wstring Directory(const std::wstring& name)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mDirectories.find(name);
+            return (it != mDirectories.end()) ? it->second : std::wstring();
+        }
+
+    private:
+        bool                        mOpen;
+        std::map<std::wstring, int> mLoads;
+        std::map<std::wstring, std::wstring> mDirectories;
+        std::mutex                  mMutex;
+        std::condition_variable     mSignal;
+    };
+
+    // The cache EffectFactory keeps, filled in by the finalize function.
+    struct FakeCache
+    {
+        std::map<std::wstring, Texture> textures;
+        std::map<std::wstring, Context> contexts;
+        int finalized = 0;
+
+        void Finalize(const std::wstring& name, Texture& texture, const Context& context)
+        {
+            ++finalized;
+            contexts[name] = context;
+
+            auto it = textures.find(name);
+            if (it != textures.end())
+            {
+                texture = it->second;
+                return;
+            }
+
+            textures[name] = texture;
+        }
+    };
+
+    Queue::Loader MakeLoader(FakeLoader& loader)
+    {
+        return [&loader](const std::wstring& directory, const std::wstring& name, bool forceSRGB)
+            {
+                return loader.Load(directory, name, forceSRGB);
+            };
+    }
+
+    auto NotFound()
+    {
+        return [] { return false; };
+    }
+
+    // Stands in for an effect: holds the placeholder until a callback swaps the texture in.
+    Queue::Callback SetTexture(int& target)
+    {
+        target = c_Placeholder;
+        return [&target](const Texture& texture) { target = *texture; };
+    }
+
+    template<typename TPredicate>
+    bool WaitFor(TPredicate&& predicate)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!predicate())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return true;
+    }
+
+    bool WaitForReady(const Queue& queue, size_t count)
+    {
+        return WaitFor([&] { return queue.GetStatistics().ready == count; });
+    }
+
+    void TestCoalescing()
+    {
+        FakeLoader loader;
+        Queue queue(MakeLoader(loader));
+        queue.SetThreadCount(2);
+
+        loader.Close();
+
+        int first, second, third;
+        CHECK(queue.Request(L"abc", c_Directory, false, nullptr, NotFound(), SetTexture(first)) == Queue::RequestResult::Queued);
+        CHECK(queue.Request(L"abc", L"other\\", false, nullptr, NotFound(), SetTexture(second)) == Queue::RequestResult::Coalesced);
+
+        loader.Open();
+        CHECK(WaitForReady(queue, 1));
+
+        // Still pending until Update, so this one is combined too.
+        CHECK(queue.Request(L"abc", c_Directory, false, nullptr, NotFound(), SetTexture(third)) == Queue::RequestResult::Coalesced);
+
+        FakeCache cache;
+        CHECK(queue.Update([&](auto& name, auto& texture, auto& context) { cache.Finalize(name, texture, context); }) == 1);
+
+        CHECK(loader.Loads(L"abc") == 1);
+        CHECK(loader.Directory(L"abc") == c_Directory);
+        CHECK(cache.finalized == 1);
+        CHECK(first == 3 && second == 3 && third == 3);
+
+        const auto stats = queue.GetStatistics();
+        CHECK(stats.coalesced == 2);
+        CHECK(stats.completed == 1);
+        CHECK(stats.failed == 0);
+    }
+
+    void TestPlaceholderSwap()
+    {
+        FakeLoader loader;
+        Queue queue(MakeLoader(loader));
+
+        FakeCache cache;
+        auto find = [&cache] { return cache.textures.count(L"abcd") != 0; };
+
+        int effect;
+        CHECK(queue.Request(L"abcd", c_Directory, false, nullptr, find, SetTexture(effect)) == Queue::RequestResult::Queued);
+        CHECK(WaitForReady(queue, 1));
+
+        // The load is done, but the texture only changes on Update.
+        CHECK(effect == c_Placeholder);
+
+        queue.Update([&](auto& name, auto& texture, auto& context) { cache.Finalize(name, texture, context); });
+        CHECK(effect == 4);
+
+        // Once cached, requests are served by the find function.
+        int later;
+        CHECK(queue.Request(L"abcd", c_Directory, false, nullptr, find, SetTexture(later)) == Queue::RequestResult::Found);
+        CHECK(later == c_Placeholder);
+        CHECK(loader.Loads(L"abcd") == 1);
+
+        CHECK(queue.Update([&](auto& name, auto& texture, auto& context) { cache.Finalize(name, texture, context); }) == 0);
+    }
+
+    void TestFailedLoads()
+    {
+        FakeLoader loader;
+        Queue queue(MakeLoader(loader));
+        queue.SetThreadCount(1);
+
+        int missing, thrown;
+        queue.Request(L"missing.png", c_Directory, false, nullptr, NotFound(), SetTexture(missing));
+        queue.Request(L"throw.png", c_Directory, false, nullptr, NotFound(), SetTexture(thrown));
+        CHECK(WaitForReady(queue, 2));
+
+        FakeCache cache;
+        CHECK(queue.Update([&](auto& name, auto& texture, auto& context) { cache.Finalize(name, texture, context); }) == 2);
+
+        // The placeholders are kept, and nothing is cached.
+        CHECK(missing == c_Placeholder);
+        CHECK(thrown == c_Placeholder);
+        CHECK(cache.finalized == 0);
+
+        const auto stats = queue.GetStatistics();
+        CHECK(stats.completed == 2);
+        CHECK(stats.failed == 2);
+
+        // A failed file is loaded again when requested after Update.
+        queue.Request(L"missing.png", c_Directory, false, nullptr, NotFound(), SetTexture(missing));
+        CHECK(WaitForReady(queue, 1));
+        CHECK(loader.Loads(L"missing.png") == 2);
+        queue.Update([&](auto& name, auto& texture, auto& context) { cache.Finalize(name, texture, context); });
+    }
+
+    void TestContext()
+    {
+        FakeLoader loader;
+        Queue queue(MakeLoader(loader));
+
+        loader.Close();
+
+        // The first non-empty context is the one given to the finalize function.
+        const auto context = std::make_shared<std::string>("render");
+        int first, second, third;
+        queue.Request(L"ab", c_Directory, false, nullptr, NotFound(), SetTexture(first));
+        queue.Request(L"ab", c_Directory, false, context, NotFound(), SetTexture(second));
+        queue.Request(L"ab", c_Directory, false, std::make_shared<std::string>("other"), NotFound(), SetTexture(third));
+
+        loader.Open();
+        CHECK(WaitForReady(queue, 1));
+
+        // The finalize function can replace the texture the callbacks get.
+        FakeCache cache;
+        cache.textures[L"ab"] = std::make_shared<int>(42);
+        queue.Update([&](auto& name, auto& texture, auto& ctx) { cache.Finalize(name, texture, ctx); });
+
+        CHECK(cache.contexts[L"ab"] == context);
+        CHECK(first == 42 && second == 42 && third == 42);
+    }
+
+    void TestWait()
+    {
+        FakeLoader loader;
+        Queue queue(MakeLoader(loader));
+
+        Texture texture;
+        CHECK(!queue.Wait(L"abc", texture));
+
+        loader.Close();
+
+        int effect;
+        queue.Request(L"abcde", c_Directory, false, nullptr, NotFound(), SetTexture(effect));
+
+        std::thread opener([&loader]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                loader.Open();
+            });
+
+        CHECK(queue.Wait(L"abcde", texture));
+        CHECK(texture && *texture == 5);
+        opener.join();
+
+        // Waiting doesn't take the load away from Update.
+        CHECK(effect == c_Placeholder);
+        FakeCache cache;
+        CHECK(queue.Update([&](auto& name, auto& tex, auto& context) { cache.Finalize(name, tex, context); }) == 1);
+        CHECK(effect == 5);
+    }
+
+    void TestStatistics()
+    {
+        FakeLoader loader;
+        Queue queue(MakeLoader(loader));
+        queue.SetThreadCount(1);
+
+        loader.Close();
+
+        int a, b, c;
+        queue.Request(L"a", c_Directory, false, nullptr, NotFound(), SetTexture(a));
+        queue.Request(L"bb", c_Directory, false, nullptr, NotFound(), SetTexture(b));
+        queue.Request(L"ccc", c_Directory, false, nullptr, NotFound(), SetTexture(c));
+
+        CHECK(WaitFor([&] { return queue.GetStatistics().loading == 1; }));
+
+        auto stats = queue.GetStatistics();
+        CHECK(stats.queued == 2);
+        CHECK(stats.ready == 0);
+        CHECK(stats.completed == 0);
+
+        loader.Open();
+        CHECK(WaitForReady(queue, 3));
+
+        stats = queue.GetStatistics();
+        CHECK(stats.queued == 0);
+        CHECK(stats.loading == 0);
+        CHECK(stats.completed == 3);
+        CHECK(stats.maxLatencyUs <= stats.totalLatencyUs);
+
+        FakeCache cache;
+        CHECK(queue.Update([&](auto& name, auto& texture, auto& context) { cache.Finalize(name, texture, context); }) == 3);
+        CHECK(a == 1 && b == 2 && c == 3);
+        CHECK(queue.GetStatistics().ready == 0);
+    }
+
+    void TestShutdown()
+    {
+        FakeLoader loader;
+        Queue queue(MakeLoader(loader));
+        queue.SetThreadCount(1);
+
+        loader.Close();
+
+        int a, b;
+        queue.Request(L"a", c_Directory, false, nullptr, NotFound(), SetTexture(a));
+        queue.Request(L"bb", c_Directory, false, nullptr, NotFound(), SetTexture(b));
+        CHECK(WaitFor([&] { return queue.GetStatistics().loading == 1; }));
+
+        // The queued load is dropped, so waiting for it doesn't block.
+        std::thread shutdown([&queue] { queue.Shutdown(); });
+
+        Texture texture;
+        CHECK(queue.Wait(L"bb", texture));
+        CHECK(!texture);
+
+        // The load in progress is finished.
+        loader.Open();
+        shutdown.join();
+
+        CHECK(queue.Wait(L"a", texture));
+        CHECK(texture && *texture == 1);
+
+        FakeCache cache;
+        CHECK(queue.Update([&](auto& name, auto& tex, auto& context) { cache.Finalize(name, tex, context); }) == 1);
+        CHECK(a == 1);
+        CHECK(b == c_Placeholder);
+        CHECK(loader.Loads(L"bb") == 0);
+
+        // Nothing is queued once shut down, so there is nothing to wait for forever.
+        int c;
+        CHECK(queue.Request(L"ccc", c_Directory, false, nullptr, NotFound(), SetTexture(c)) == Queue::RequestResult::Stopped);
+        CHECK(!queue.Wait(L"ccc", texture));
+        CHECK(loader.Loads(L"ccc") == 0);
+    }
+
+    // Many requests for fewer files, as when loading a scene whose materials share textures.
+    void BenchmarkRequests()
+    {
+        constexpr size_t c_Files = 1000;
+        constexpr size_t c_Requests = 20000;
+
+        FakeLoader loader;
+        Queue queue(MakeLoader(loader));
+
+        std::vector<std::wstring> names;
+        names.reserve(c_Files);
+        for (size_t j = 0; j < c_Files; ++j)
+        {
+            names.emplace_back(std::to_wstring(j));
+        }
+
+        std::vector<int> effects(c_Requests);
+
+        TestHelpers::Timer timer;
+
+        for (size_t j = 0; j < c_Requests; ++j)
+        {
+            queue.Request(names[(j * 7919) % c_Files], c_Directory, false, nullptr, NotFound(), SetTexture(effects[j]));
+        }
+
+        const double requestTime = timer.ElapsedMilliseconds();
+
+        size_t finished = 0;
+        FakeCache cache;
+        while (finished < c_Files)
+        {
+            finished += queue.Update([&](auto& name, auto& texture, auto& context) { cache.Finalize(name, texture, context); });
+        }
+
+        const double totalTime = timer.ElapsedMilliseconds();
+
+        const auto stats = queue.GetStatistics();
+        CHECK(stats.completed == c_Files);
+
+        printf("%zu requests for %zu files: requests %.3f ms, all loaded %.3f ms, %zu coalesced, average latency %.1f us\n",
+            c_Requests, c_Files, requestTime, totalTime, stats.coalesced,
+            double(stats.totalLatencyUs) / double(stats.completed));
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestCoalescing();
+    TestPlaceholderSwap();
+    TestFailedLoads();
+    TestContext();
+    TestWait();
+    TestStatistics();
+    TestShutdown();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        BenchmarkRequests();
+    }
+
+    return TestHelpers::Finish("AsyncTextureQueueTest");
+}
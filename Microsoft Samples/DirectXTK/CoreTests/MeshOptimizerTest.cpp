@@ -0,0 +1,273 @@
+//--------------------------------------------------------------------------------------
+// File: MeshOptimizerTest.cpp
+//
+// Checks that the triangle and vertex reordering used by GeometricPrimitive and the Model
+// loaders keeps every triangle and improves vertex cache efficiency, and times each pass
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    struct TestVertex
+    {
+        float position[3];
+        float normal[3];
+        float textureCoordinate[2];
+    };
+
+    // The triangles of an index buffer, each rotated to start at its smallest index (which
+    // keeps the winding) and then sorted, so buffers can be compared regardless of order.
+    template<typename TIndex>
+    std::vector<std::array<TIndex, 3>> SortedTriangles(const std::vector<TIndex>& indices)
+    {
+        std::vector<std::array<TIndex, 3>> triangles;
+        triangles.reserve(indices.size() / 3);
+
+        for (size_t j = 0; j + 2 < indices.size(); j += 3)
+        {
+            size_t first = 0;
+            for (size_t k = 1; k < 3; ++k)
+            {
+                if (indices[j + k] < indices[j + first])
+                    first = k;
+            }
+
+            triangles.push_back({ indices[j + first], indices[j + (first + 1) % 3], indices[j + (first + 2) % 3] });
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    // A UV sphere, with triangles in row order as GeometricPrimitive generates them.
+    template<typename TIndex>
+    void MakeSphere(size_t rings, size_t segments, std::vector<TestVertex>& vertices, std::vector<TIndex>& indices)
+    {
+        vertices.clear();
+        indices.clear();
+
+        for (size_t i = 0; i <= rings; ++i)
+        {
+            const float theta = 3.14159265f * float(i) / float(rings);
+
+            for (size_t j = 0; j <= segments; ++j)
+            {
+                const float phi = 6.28318531f * float(j) / float(segments);
+
+                TestVertex v = {};
+                v.position[0] = sinf(theta) * cosf(phi);
+                v.position[1] = cosf(theta);
+                v.position[2] = sinf(theta) * sinf(phi);
+                v.textureCoordinate[0] = float(j) / float(segments);
+                v.textureCoordinate[1] = float(i) / float(rings);
+                vertices.push_back(v);
+            }
+        }
+
+        const size_t stride = segments + 1;
+        for (size_t i = 0; i < rings; ++i)
+        {
+            for (size_t j = 0; j < segments; ++j)
+            {
+                const auto a = static_cast<TIndex>(i * stride + j);
+                const auto b = static_cast<TIndex>((i + 1) * stride + j);
+                const auto c = static_cast<TIndex>(i * stride + j + 1);
+                const auto d = static_cast<TIndex>((i + 1) * stride + j + 1);
+
+                indices.insert(indices.end(), { a, b, c, c, b, d });
+            }
+        }
+    }
+
+    void TestCacheStatistics()
+    {
+        const uint16_t triangle[] = { 0, 1, 2 };
+        auto stats = MeshOptimizer::ComputeCacheStatistics(triangle, 3, 3);
+        CHECK(stats.acmr == 3.f);
+        CHECK(stats.atvr == 1.f);
+
+        // Two triangles sharing an edge only load four vertices.
+        const uint16_t quad[] = { 0, 1, 2, 2, 1, 3 };
+        stats = MeshOptimizer::ComputeCacheStatistics(quad, 6, 4);
+        CHECK(stats.acmr == 2.f);
+        CHECK(stats.atvr == 1.f);
+
+        stats = MeshOptimizer::ComputeCacheStatistics(triangle, 0, 3);
+        CHECK(stats.acmr == 0.f);
+    }
+
+    void TestSphere()
+    {
+        std::vector<TestVertex> vertices;
+        std::vector<uint16_t> indices;
+        MakeSphere(64, 128, vertices, indices);
+
+        const auto original = SortedTriangles(indices);
+        const auto before = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+
+        std::vector<size_t> clusters;
+        MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertices.size(),
+            MeshOptimizer::DefaultCacheSize, &clusters);
+        const auto afterCache = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+
+        CHECK(SortedTriangles(indices) == original);
+        CHECK(afterCache.acmr < before.acmr);
+        CHECK(afterCache.atvr < before.atvr);
+        CHECK(!clusters.empty() && clusters[0] == 0);
+        CHECK(std::is_sorted(clusters.begin(), clusters.end()));
+
+        MeshOptimizer::OptimizeOverdraw(indices.data(), indices.size(), vertices.data()->position,
+            sizeof(TestVertex), vertices.size(), clusters);
+        const auto afterOverdraw = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+
+        CHECK(SortedTriangles(indices) == original);
+        CHECK(afterOverdraw.acmr < before.acmr);
+
+        // Vertex fetch order: the index buffer now uses vertices in increasing order of first use.
+        const auto reordered = indices;
+        const auto oldVertices = vertices;
+
+        std::vector<uint32_t> remap;
+        MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertices.size(), remap);
+        MeshOptimizer::RemapVertices(vertices, remap);
+
+        uint32_t next = 0;
+        bool sequential = true;
+        for (const auto index : indices)
+        {
+            if (index > next)
+                sequential = false;
+            else if (index == next)
+                ++next;
+        }
+        CHECK(sequential);
+
+        std::vector<uint32_t> sortedRemap(remap);
+        std::sort(sortedRemap.begin(), sortedRemap.end());
+        bool permutation = true;
+        for (size_t v = 0; v < sortedRemap.size(); ++v)
+        {
+            if (sortedRemap[v] != v)
+                permutation = false;
+        }
+        CHECK(permutation);
+
+        bool samePositions = true;
+        for (size_t j = 0; j < indices.size(); ++j)
+        {
+            if (memcmp(&vertices[indices[j]], &oldVertices[reordered[j]], sizeof(TestVertex)) != 0)
+                samePositions = false;
+        }
+        CHECK(samePositions);
+
+        const auto afterFetch = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+        CHECK(afterFetch.acmr == afterOverdraw.acmr);
+    }
+
+    // Random triangle soups, including degenerate and repeated triangles.
+    void TestRandomMeshes()
+    {
+        std::mt19937 rng(3);
+
+        for (int trial = 0; trial < 50; ++trial)
+        {
+            const size_t vertexCount = 1 + rng() % 500;
+            const size_t triangleCount = rng() % 1000;
+
+            std::vector<uint32_t> indices(triangleCount * 3);
+            for (auto& index : indices)
+                index = rng() % uint32_t(vertexCount);
+
+            std::vector<float> positions(vertexCount * 3);
+            for (auto& p : positions)
+                p = float(rng() % 1000) / 100.f;
+
+            const auto original = SortedTriangles(indices);
+
+            std::vector<size_t> clusters;
+            MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertexCount,
+                MeshOptimizer::DefaultCacheSize, &clusters);
+            if (!CHECK(SortedTriangles(indices) == original))
+                break;
+
+            MeshOptimizer::OptimizeOverdraw(indices.data(), indices.size(), positions.data(),
+                3 * sizeof(float), vertexCount, clusters);
+            if (!CHECK(SortedTriangles(indices) == original))
+                break;
+        }
+
+        // Out-of-range indices leave the buffer as it was.
+        std::vector<uint16_t> invalid = { 0, 1, 2, 2, 1, 9 };
+        const auto unchanged = invalid;
+        std::vector<size_t> clusters;
+        MeshOptimizer::OptimizeVertexCache(invalid.data(), invalid.size(), 4, MeshOptimizer::DefaultCacheSize, &clusters);
+        CHECK(invalid == unchanged);
+        CHECK(clusters.empty());
+    }
+
+    void BenchmarkSphere()
+    {
+        std::vector<TestVertex> vertices;
+        std::vector<uint32_t> indices;
+        MakeSphere(512, 1024, vertices, indices);
+
+        const auto before = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+
+        std::vector<size_t> clusters;
+        TestHelpers::Timer cacheTimer;
+        MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertices.size(),
+            MeshOptimizer::DefaultCacheSize, &clusters);
+        const double cacheTime = cacheTimer.ElapsedMilliseconds();
+
+        const auto afterCache = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+
+        TestHelpers::Timer overdrawTimer;
+        MeshOptimizer::OptimizeOverdraw(indices.data(), indices.size(), vertices.data()->position,
+            sizeof(TestVertex), vertices.size(), clusters);
+        const double overdrawTime = overdrawTimer.ElapsedMilliseconds();
+
+        const auto afterOverdraw = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+
+        std::vector<uint32_t> remap;
+        TestHelpers::Timer fetchTimer;
+        MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertices.size(), remap);
+        MeshOptimizer::RemapVertices(vertices, remap);
+        const double fetchTime = fetchTimer.ElapsedMilliseconds();
+
+        printf("Sphere with %zu triangles: ACMR %.3f, after OptimizeVertexCache %.3f (%.3f ms), "
+            "after OptimizeOverdraw %.3f (%.3f ms), OptimizeVertexFetch %.3f ms\n",
+            indices.size() / 3, before.acmr, afterCache.acmr, cacheTime, afterOverdraw.acmr, overdrawTime, fetchTime);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestCacheStatistics();
+    TestSphere();
+    TestRandomMeshes();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        BenchmarkSphere();
+    }
+
+    return TestHelpers::Finish("MeshOptimizerTest");
+}
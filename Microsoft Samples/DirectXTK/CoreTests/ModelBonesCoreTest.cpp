@@ -0,0 +1,282 @@
+//--------------------------------------------------------------------------------------
+// File: ModelBonesCoreTest.cpp
+//
+// Checks the flattened bone traversal used by Model against the recursive traversal it
+// replaced, and compares their speed over many instances
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "ModelBonesCore.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr uint32_t c_Invalid = ModelBonesCore::InvalidIndex;
+
+    struct TestBone
+    {
+        uint32_t childIndex = c_Invalid;
+        uint32_t siblingIndex = c_Invalid;
+    };
+
+    // The recursive traversal Model used before the hierarchy was flattened.
+    void ReferenceTransforms(
+        const std::vector<TestBone>& bones,
+        uint32_t index,
+        const XMMATRIX& parent,
+        const XMMATRIX* inBoneTransforms,
+        XMMATRIX* outBoneTransforms)
+    {
+        if (index == c_Invalid || index >= bones.size())
+            return;
+
+        const XMMATRIX local = XMMatrixMultiply(inBoneTransforms[index], parent);
+        outBoneTransforms[index] = local;
+
+        if (bones[index].siblingIndex != c_Invalid)
+            ReferenceTransforms(bones, bones[index].siblingIndex, parent, inBoneTransforms, outBoneTransforms);
+
+        if (bones[index].childIndex != c_Invalid)
+            ReferenceTransforms(bones, bones[index].childIndex, local, inBoneTransforms, outBoneTransforms);
+    }
+
+    // A random tree rooted at bone 0. About one bone in ten is left unattached, so it is not
+    // reachable from the root.
+    std::vector<TestBone> MakeHierarchy(size_t count, std::mt19937& rng)
+    {
+        std::vector<TestBone> bones(count);
+
+        std::vector<uint32_t> ids(count);
+        for (size_t i = 0; i < count; ++i)
+            ids[i] = static_cast<uint32_t>(i);
+        std::shuffle(ids.begin() + 1, ids.end(), rng);
+
+        for (size_t i = 1; i < count; ++i)
+        {
+            if (rng() % 10 == 0)
+                continue;
+
+            const uint32_t child = ids[i];
+            const uint32_t parent = ids[rng() % i];
+
+            if (bones[parent].childIndex == c_Invalid)
+            {
+                bones[parent].childIndex = child;
+            }
+            else
+            {
+                uint32_t last = bones[parent].childIndex;
+                while (bones[last].siblingIndex != c_Invalid)
+                    last = bones[last].siblingIndex;
+                bones[last].siblingIndex = child;
+            }
+        }
+
+        return bones;
+    }
+
+    std::vector<XMMATRIX> MakeTransforms(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> value(-1.f, 1.f);
+        std::vector<XMMATRIX> transforms(count);
+
+        for (auto& transform : transforms)
+        {
+            XMFLOAT4X4 m;
+            for (auto& row : m.m)
+                for (auto& v : row)
+                    v = value(rng);
+            transform = XMLoadFloat4x4(&m);
+        }
+
+        return transforms;
+    }
+
+    bool SameMatrices(const std::vector<XMMATRIX>& a, const std::vector<XMMATRIX>& b)
+    {
+        if (a.size() != b.size())
+            return false;
+
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            XMFLOAT4X4 ma, mb;
+            XMStoreFloat4x4(&ma, a[i]);
+            XMStoreFloat4x4(&mb, b[i]);
+
+            if (memcmp(&ma, &mb, sizeof(XMFLOAT4X4)) != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    std::vector<XMMATRIX> ZeroMatrices(size_t count)
+    {
+        std::vector<XMMATRIX> matrices(count);
+        memset(matrices.data(), 0, sizeof(XMMATRIX) * count);
+        return matrices;
+    }
+
+    void TestRandomHierarchies()
+    {
+        std::mt19937 rng(1);
+
+        for (int trial = 0; trial < 200; ++trial)
+        {
+            const size_t nbones = 1 + rng() % 60;
+            const auto bones = MakeHierarchy(nbones, rng);
+            const auto inTransforms = MakeTransforms(nbones, rng);
+            const auto invBindPose = MakeTransforms(nbones, rng);
+
+            auto expected = ZeroMatrices(nbones);
+            ReferenceTransforms(bones, 0, XMMatrixIdentity(), inTransforms.data(), expected.data());
+
+            auto expectedSkin = ZeroMatrices(nbones);
+            std::vector<uint32_t> order;
+            std::vector<uint32_t> parents;
+            if (!CHECK(ModelBonesCore::FlattenHierarchy(bones, order, parents)))
+                continue;
+
+            CHECK(order.size() == parents.size());
+            for (const uint32_t index : order)
+                expectedSkin[index] = XMMatrixMultiply(invBindPose[index], expected[index]);
+
+            // Every parent comes before its children.
+            std::vector<bool> seen(nbones, false);
+            for (size_t j = 0; j < order.size(); ++j)
+            {
+                CHECK(parents[j] == c_Invalid || seen[parents[j]]);
+                seen[order[j]] = true;
+            }
+
+            // Start from garbage so unreachable bones must be cleared.
+            std::vector<XMMATRIX> actual(nbones, XMMatrixIdentity());
+            std::vector<XMMATRIX> actualSkin(nbones, XMMatrixIdentity());
+            ModelBonesCore::ComputeAbsoluteTransforms(
+                order.data(), parents.data(), order.size(), nbones,
+                inTransforms.data(), actual.data(), invBindPose.data(), actualSkin.data());
+
+            CHECK(SameMatrices(expected, actual));
+            CHECK(SameMatrices(expectedSkin, actualSkin));
+
+            // Without skinning output
+            std::vector<XMMATRIX> absoluteOnly(nbones, XMMatrixIdentity());
+            ModelBonesCore::ComputeAbsoluteTransforms(
+                order.data(), parents.data(), order.size(), nbones,
+                inTransforms.data(), absoluteOnly.data(), nullptr, nullptr);
+
+            CHECK(SameMatrices(expected, absoluteOnly));
+        }
+    }
+
+    void TestEdgeCases()
+    {
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> parents;
+
+        CHECK(ModelBonesCore::FlattenHierarchy(std::vector<TestBone>(), order, parents));
+        CHECK(order.empty() && parents.empty());
+
+        // Links past the end of the collection end the traversal, as they did before.
+        std::vector<TestBone> bones(3);
+        bones[0].childIndex = 1;
+        bones[1].siblingIndex = 7;
+        bones[1].childIndex = 2;
+        bones[2].childIndex = 100;
+        CHECK(ModelBonesCore::FlattenHierarchy(bones, order, parents));
+        CHECK((order == std::vector<uint32_t>{ 0, 1, 2 }));
+        CHECK((parents == std::vector<uint32_t>{ c_Invalid, 0, 1 }));
+
+        // Sibling cycle
+        std::vector<TestBone> siblingCycle(3);
+        siblingCycle[0].childIndex = 1;
+        siblingCycle[1].siblingIndex = 2;
+        siblingCycle[2].siblingIndex = 1;
+        CHECK(!ModelBonesCore::FlattenHierarchy(siblingCycle, order, parents));
+        CHECK(order.empty() && parents.empty());
+
+        // Child cycle back to the root
+        std::vector<TestBone> childCycle(2);
+        childCycle[0].childIndex = 1;
+        childCycle[1].childIndex = 0;
+        CHECK(!ModelBonesCore::FlattenHierarchy(childCycle, order, parents));
+
+        // A bone that is its own sibling
+        std::vector<TestBone> selfCycle(1);
+        selfCycle[0].siblingIndex = 0;
+        CHECK(!ModelBonesCore::FlattenHierarchy(selfCycle, order, parents));
+    }
+
+    void BenchmarkTraversal()
+    {
+        const size_t nbones = 64;
+        const size_t ninstances = 5000;
+
+        std::mt19937 rng(2);
+        const auto bones = MakeHierarchy(nbones, rng);
+        const auto inTransforms = MakeTransforms(nbones * ninstances, rng);
+        std::vector<XMMATRIX> outTransforms(nbones * ninstances);
+
+        double recursiveTime;
+        {
+            TestHelpers::Timer timer;
+            for (size_t instance = 0; instance < ninstances; ++instance)
+            {
+                const size_t offset = instance * nbones;
+                memset(outTransforms.data() + offset, 0, sizeof(XMMATRIX) * nbones);
+                ReferenceTransforms(bones, 0, XMMatrixIdentity(), inTransforms.data() + offset, outTransforms.data() + offset);
+            }
+            recursiveTime = timer.ElapsedMilliseconds();
+        }
+
+        const auto expected = outTransforms;
+
+        double flattenedTime;
+        {
+            TestHelpers::Timer timer;
+            std::vector<uint32_t> order;
+            std::vector<uint32_t> parents;
+            ModelBonesCore::FlattenHierarchy(bones, order, parents);
+
+            for (size_t instance = 0; instance < ninstances; ++instance)
+            {
+                const size_t offset = instance * nbones;
+                ModelBonesCore::ComputeAbsoluteTransforms(
+                    order.data(), parents.data(), order.size(), nbones,
+                    inTransforms.data() + offset, outTransforms.data() + offset, nullptr, nullptr);
+            }
+            flattenedTime = timer.ElapsedMilliseconds();
+        }
+
+        CHECK(SameMatrices(expected, outTransforms));
+
+        printf("%zu instances of %zu bones: recursive %.3f ms, flattened %.3f ms\n",
+            ninstances, nbones, recursiveTime, flattenedTime);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestRandomHierarchies();
+    TestEdgeCases();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        BenchmarkTraversal();
+    }
+
+    return TestHelpers::Finish("ModelBonesCoreTest");
+}
@@ -0,0 +1,349 @@
+//--------------------------------------------------------------------------------------
+// File: SDKMeshCoreTest.cpp
+//
+// Checks SDKMESH validation used by Model against well-formed, corrupted and truncated
+// files, and times parsing of a file with many meshes
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+
+// SDKMesh.h relies on the Windows headers for INT, MAX_PATH and DXGI_FORMAT.
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#include <dxgiformat.h>
+
+#include "SDKMeshCore.h"
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    struct FileOffsets
+    {
+        size_t vertexBuffer;
+        size_t indexBuffer;
+        size_t meshes;
+        size_t subsets;
+        size_t materials;
+        size_t subsetTable;
+        size_t bufferData;
+    };
+
+    template<typename T>
+    T* At(std::vector<uint8_t>& file, size_t offset) noexcept
+    {
+        return reinterpret_cast<T*>(file.data() + offset);
+    }
+
+    // Builds a well-formed file with one vertex buffer, one index buffer, and the given number
+    // of meshes, each with its own subset and material.
+    std::vector<uint8_t> MakeMeshFile(uint32_t version, uint32_t meshCount, FileOffsets* offsets = nullptr)
+    {
+        const size_t materialSize = (version == DXUT::SDKMESH_FILE_VERSION_V2)
+            ? sizeof(DXUT::SDKMESH_MATERIAL_V2) : sizeof(DXUT::SDKMESH_MATERIAL);
+
+        FileOffsets o = {};
+        o.vertexBuffer = sizeof(DXUT::SDKMESH_HEADER);
+        o.indexBuffer = o.vertexBuffer + sizeof(DXUT::SDKMESH_VERTEX_BUFFER_HEADER);
+        o.meshes = o.indexBuffer + sizeof(DXUT::SDKMESH_INDEX_BUFFER_HEADER);
+        o.subsets = o.meshes + meshCount * sizeof(DXUT::SDKMESH_MESH);
+        o.materials = o.subsets + meshCount * sizeof(DXUT::SDKMESH_SUBSET);
+        o.subsetTable = o.materials + meshCount * materialSize;
+        o.bufferData = (o.subsetTable + meshCount * sizeof(uint32_t) + 7) & ~size_t(7);
+
+        const uint64_t vertexBytes = 32;
+        const uint64_t indexBytes = 32;
+
+        std::vector<uint8_t> file(o.bufferData + vertexBytes + indexBytes, 0);
+
+        auto header = At<DXUT::SDKMESH_HEADER>(file, 0);
+        header->Version = version;
+        header->HeaderSize = o.meshes;
+        header->NonBufferDataSize = o.bufferData - o.meshes;
+        header->BufferDataSize = vertexBytes + indexBytes;
+        header->NumVertexBuffers = 1;
+        header->NumIndexBuffers = 1;
+        header->NumMeshes = meshCount;
+        header->NumTotalSubsets = meshCount;
+        header->NumMaterials = meshCount;
+        header->VertexStreamHeadersOffset = o.vertexBuffer;
+        header->IndexStreamHeadersOffset = o.indexBuffer;
+        header->MeshDataOffset = o.meshes;
+        header->SubsetDataOffset = o.subsets;
+        header->MaterialDataOffset = o.materials;
+
+        auto vb = At<DXUT::SDKMESH_VERTEX_BUFFER_HEADER>(file, o.vertexBuffer);
+        vb->NumVertices = 2;
+        vb->SizeBytes = vertexBytes;
+        vb->StrideBytes = 16;
+        vb->DataOffset = o.bufferData;
+
+        auto ib = At<DXUT::SDKMESH_INDEX_BUFFER_HEADER>(file, o.indexBuffer);
+        ib->NumIndices = indexBytes / sizeof(uint16_t);
+        ib->SizeBytes = indexBytes;
+        ib->IndexType = DXUT::IT_16BIT;
+        ib->DataOffset = o.bufferData + vertexBytes;
+
+        for (uint32_t j = 0; j < meshCount; ++j)
+        {
+            auto mesh = At<DXUT::SDKMESH_MESH>(file, o.meshes + j * sizeof(DXUT::SDKMESH_MESH));
+            mesh->NumVertexBuffers = 1;
+            mesh->NumSubsets = 1;
+            mesh->SubsetOffset = o.subsetTable + j * sizeof(uint32_t);
+
+            At<DXUT::SDKMESH_SUBSET>(file, o.subsets + j * sizeof(DXUT::SDKMESH_SUBSET))->MaterialID = j;
+            *At<uint32_t>(file, o.subsetTable + j * sizeof(uint32_t)) = j;
+        }
+
+        if (offsets)
+            *offsets = o;
+
+        return file;
+    }
+
+    bool Parses(const std::vector<uint8_t>& file, SDKMeshCore::FileLayout& layout)
+    {
+        try
+        {
+            SDKMeshCore::Parse(file.data(), file.size(), layout);
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    bool Parses(const std::vector<uint8_t>& file)
+    {
+        SDKMeshCore::FileLayout layout;
+        return Parses(file, layout);
+    }
+
+    // Everything the loaders read through the layout lies within the file.
+    bool LayoutIsInFile(const std::vector<uint8_t>& file, const SDKMeshCore::FileLayout& layout)
+    {
+        const uint64_t size = file.size();
+        auto header = layout.header;
+
+        for (size_t j = 0; j < header->NumVertexBuffers; ++j)
+        {
+            auto& vb = layout.vertexBuffers[j];
+            if (vb.DataOffset > size || vb.SizeBytes > size - vb.DataOffset)
+                return false;
+        }
+
+        for (size_t j = 0; j < header->NumIndexBuffers; ++j)
+        {
+            auto& ib = layout.indexBuffers[j];
+            if (ib.DataOffset > size || ib.SizeBytes > size - ib.DataOffset)
+                return false;
+        }
+
+        for (size_t j = 0; j < header->NumMeshes; ++j)
+        {
+            auto& mesh = layout.meshes[j];
+            if (mesh.IndexBuffer >= header->NumIndexBuffers
+                || mesh.VertexBuffers[0] >= header->NumVertexBuffers
+                || mesh.SubsetOffset > size
+                || mesh.NumSubsets > (size - mesh.SubsetOffset) / sizeof(uint32_t))
+                return false;
+
+            for (size_t k = 0; k < mesh.NumSubsets; ++k)
+            {
+                uint32_t subset;
+                memcpy(&subset, file.data() + mesh.SubsetOffset + k * sizeof(uint32_t), sizeof(subset));
+                if (subset >= header->NumTotalSubsets
+                    || layout.subsets[subset].MaterialID >= header->NumMaterials)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void TestValidFiles()
+    {
+        FileOffsets o;
+        SDKMeshCore::FileLayout layout;
+
+        auto file = MakeMeshFile(DXUT::SDKMESH_FILE_VERSION, 3, &o);
+        if (CHECK(Parses(file, layout)))
+        {
+            CHECK(layout.header == At<DXUT::SDKMESH_HEADER>(file, 0));
+            CHECK(layout.vertexBuffers == At<DXUT::SDKMESH_VERTEX_BUFFER_HEADER>(file, o.vertexBuffer));
+            CHECK(layout.indexBuffers == At<DXUT::SDKMESH_INDEX_BUFFER_HEADER>(file, o.indexBuffer));
+            CHECK(layout.meshes == At<DXUT::SDKMESH_MESH>(file, o.meshes));
+            CHECK(layout.subsets == At<DXUT::SDKMESH_SUBSET>(file, o.subsets));
+            CHECK(layout.materials == At<DXUT::SDKMESH_MATERIAL>(file, o.materials));
+            CHECK(layout.materialsV2 == nullptr);
+            CHECK(layout.frames == nullptr);
+        }
+
+        file = MakeMeshFile(DXUT::SDKMESH_FILE_VERSION_V2, 3, &o);
+        if (CHECK(Parses(file, layout)))
+        {
+            CHECK(layout.materials == nullptr);
+            CHECK(layout.materialsV2 == At<DXUT::SDKMESH_MATERIAL_V2>(file, o.materials));
+        }
+    }
+
+    void TestCorruptFiles()
+    {
+        FileOffsets o;
+        const auto valid = MakeMeshFile(DXUT::SDKMESH_FILE_VERSION, 2, &o);
+
+        // Every truncation cuts into the buffer data at the end of the file, if not sooner.
+        for (size_t size = 0; size < valid.size(); ++size)
+        {
+            if (!CHECK(!Parses(std::vector<uint8_t>(valid.begin(), valid.begin() + ptrdiff_t(size)))))
+                break;
+        }
+
+        auto file = valid;
+        At<DXUT::SDKMESH_HEADER>(file, 0)->HeaderSize += 8;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_HEADER>(file, 0)->Version = 99;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_HEADER>(file, 0)->IsBigEndian = 1;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_HEADER>(file, 0)->NumMaterials = 0;
+        CHECK(!Parses(file));
+
+        // A material table that runs past the end of the file
+        file = valid;
+        At<DXUT::SDKMESH_HEADER>(file, 0)->MaterialDataOffset = file.size() - sizeof(DXUT::SDKMESH_MATERIAL) / 2;
+        CHECK(!Parses(file));
+
+        // Offsets and sizes chosen so that offset + size wraps around
+        file = valid;
+        At<DXUT::SDKMESH_VERTEX_BUFFER_HEADER>(file, o.vertexBuffer)->DataOffset = UINT64_MAX - 15;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_INDEX_BUFFER_HEADER>(file, o.indexBuffer)->SizeBytes = UINT64_MAX;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_HEADER>(file, 0)->NonBufferDataSize = UINT64_MAX - 8;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_HEADER>(file, 0)->NumMeshes = UINT32_MAX;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_INDEX_BUFFER_HEADER>(file, o.indexBuffer)->IndexType = 2;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_MESH>(file, o.meshes)->IndexBuffer = 1;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_MESH>(file, o.meshes)->SubsetOffset = file.size() - 2;
+        CHECK(!Parses(file));
+
+        file = valid;
+        *At<uint32_t>(file, o.subsetTable) = 2;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_SUBSET>(file, o.subsets)->MaterialID = 2;
+        CHECK(!Parses(file));
+
+        file = valid;
+        At<DXUT::SDKMESH_MESH>(file, o.meshes)->NumFrameInfluences = 1;
+        At<DXUT::SDKMESH_MESH>(file, o.meshes)->FrameInfluenceOffset = file.size();
+        CHECK(!Parses(file));
+    }
+
+    // Random byte changes and truncations must either be rejected with an exception or leave
+    // a layout whose every range lies within the file.
+    void TestMutatedFiles()
+    {
+        const auto valid = MakeMeshFile(DXUT::SDKMESH_FILE_VERSION, 2);
+        std::mt19937 rng(7);
+
+        int accepted = 0;
+        for (int iteration = 0; iteration < 50000; ++iteration)
+        {
+            auto file = valid;
+
+            const uint32_t changes = 1 + rng() % 4;
+            for (uint32_t k = 0; k < changes; ++k)
+            {
+                file[rng() % file.size()] = (rng() % 3 == 0) ? 0xFF : static_cast<uint8_t>(rng());
+            }
+
+            if (rng() % 8 == 0)
+                file.resize(rng() % file.size());
+
+            SDKMeshCore::FileLayout layout;
+            if (Parses(file, layout))
+            {
+                ++accepted;
+                if (!CHECK(LayoutIsInFile(file, layout)))
+                    break;
+            }
+        }
+
+        // Most changes land in names and padding, so plenty of files should still load.
+        CHECK(accepted > 0);
+    }
+
+    void BenchmarkParse()
+    {
+        const auto file = MakeMeshFile(DXUT::SDKMESH_FILE_VERSION, 2000);
+        const int iterations = 1000;
+
+        SDKMeshCore::FileLayout layout;
+        TestHelpers::Timer timer;
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            SDKMeshCore::Parse(file.data(), file.size(), layout);
+        }
+        const double elapsed = timer.ElapsedMilliseconds();
+
+        CHECK(layout.header != nullptr);
+
+        printf("Parse of a %zu byte file with 2000 meshes: %.3f ms\n", file.size(), elapsed / iterations);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestValidFiles();
+    TestCorruptFiles();
+    TestMutatedFiles();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        BenchmarkParse();
+    }
+
+    return TestHelpers::Finish("SDKMeshCoreTest");
+}
@@ -0,0 +1,378 @@
+//--------------------------------------------------------------------------------------
+// File: SoftwareMixerTest.cpp
+//
+// Checks the software mixer against known PCM and ADPCM inputs, including loop regions,
+// resampling and volume ramps, and times mixing a thousand voices
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "SoftwareMixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr uint32_t c_OutputRate = 48000;
+    constexpr double c_Pi = 3.14159265358979323846;
+
+    // Same layout as WAVEFORMATEX and ADPCMWAVEFORMAT, so the tests need no Windows headers.
+#pragma pack(push, 1)
+    struct TestWaveFormat
+    {
+        uint16_t wFormatTag;
+        uint16_t nChannels;
+        uint32_t nSamplesPerSec;
+        uint32_t nAvgBytesPerSec;
+        uint16_t nBlockAlign;
+        uint16_t wBitsPerSample;
+        uint16_t cbSize;
+    };
+
+    struct TestADPCMWaveFormat
+    {
+        TestWaveFormat wfx;
+        uint16_t wSamplesPerBlock;
+        uint16_t wNumCoef;
+        int16_t aCoef[7][2];
+    };
+#pragma pack(pop)
+
+    TestWaveFormat MakePCMFormat(uint32_t channels, uint32_t sampleRate, uint32_t bitsPerSample)
+    {
+        const auto blockAlign = static_cast<uint16_t>(channels * bitsPerSample / 8);
+        return { 1, static_cast<uint16_t>(channels), sampleRate, sampleRate * blockAlign, blockAlign,
+            static_cast<uint16_t>(bitsPerSample), 0 };
+    }
+
+    SoftwareMixer::Buffer MakeBuffer(const void* data, size_t bytes, uint32_t loopBegin = 0, uint32_t loopLength = 0, uint32_t loopCount = 0)
+    {
+        return { static_cast<const uint8_t*>(data), bytes, loopBegin, loopLength, loopCount };
+    }
+
+    std::vector<int16_t> MakeSine(size_t frames, double frequency, double sampleRate, double amplitude)
+    {
+        std::vector<int16_t> samples(frames);
+        for (size_t i = 0; i < frames; ++i)
+            samples[i] = static_cast<int16_t>(amplitude * sin(2. * c_Pi * frequency * double(i) / sampleRate));
+        return samples;
+    }
+
+    // A minimal mono Microsoft ADPCM encoder that always uses the second predictor.
+    std::vector<uint8_t> EncodeADPCM(const std::vector<int16_t>& pcm, uint32_t samplesPerBlock)
+    {
+        static const int s_adaptation[16] = { 230, 230, 230, 230, 307, 409, 512, 614, 768, 614, 512, 409, 307, 230, 230, 230 };
+
+        const size_t blockAlign = 7 + (samplesPerBlock - 2) / 2;
+        std::vector<uint8_t> output;
+
+        for (size_t base = 0; base < pcm.size(); base += samplesPerBlock)
+        {
+            auto sample = [&](size_t i) { return (base + i < pcm.size()) ? int(pcm[base + i]) : 0; };
+
+            std::vector<uint8_t> block(blockAlign, 0);
+            int sample2 = sample(0);
+            int sample1 = sample(1);
+            int delta = 16;
+
+            block[0] = 1;
+            const int16_t header[3] = { int16_t(delta), int16_t(sample1), int16_t(sample2) };
+            memcpy(&block[1], header, sizeof(header));
+
+            for (size_t n = 0; n < samplesPerBlock - 2; ++n)
+            {
+                const int predicted = (sample1 * 512 - sample2 * 256) / 256;
+                int code = static_cast<int>(lround(double(sample(n + 2) - predicted) / delta));
+                code = std::max(-8, std::min(7, code));
+
+                const int value = std::max(-32768, std::min(32767, predicted + code * delta));
+                sample2 = sample1;
+                sample1 = value;
+
+                const int nibble = code & 0xF;
+                delta = std::max(s_adaptation[nibble] * delta / 256, 16);
+                block[7 + n / 2] |= static_cast<uint8_t>((n & 1) ? nibble : (nibble << 4));
+            }
+
+            output.insert(output.end(), block.begin(), block.end());
+        }
+
+        return output;
+    }
+
+    double MaxError(const std::vector<float>& output, size_t channels, size_t channel, const std::vector<float>& expected)
+    {
+        double error = 0;
+        for (size_t i = 0; i < expected.size(); ++i)
+            error = std::max(error, fabs(double(output[i * channels + channel]) - expected[i]));
+        return error;
+    }
+
+    std::vector<float> ToFloat(const std::vector<int16_t>& samples)
+    {
+        std::vector<float> result(samples.size());
+        for (size_t i = 0; i < samples.size(); ++i)
+            result[i] = float(samples[i]) / 32768.f;
+        return result;
+    }
+
+    void TestFormats()
+    {
+        SoftwareMixer::SourceFormat format;
+
+        auto pcm = MakePCMFormat(2, 44100, 16);
+        CHECK(SoftwareMixer::SourceFormat::FromWaveFormat(&pcm, format));
+        CHECK(format.tag == SoftwareMixer::Format_PCM && format.channels == 2 && format.blockAlign == 4);
+
+        pcm.nBlockAlign = 3;
+        CHECK(!SoftwareMixer::SourceFormat::FromWaveFormat(&pcm, format));
+
+        auto pcm12 = MakePCMFormat(1, 44100, 12);
+        CHECK(!SoftwareMixer::SourceFormat::FromWaveFormat(&pcm12, format));
+
+        TestADPCMWaveFormat adpcm = {};
+        adpcm.wfx = { SoftwareMixer::Format_ADPCM, 1, c_OutputRate, 0, 7 + 510 / 2, 4, 32 };
+        adpcm.wSamplesPerBlock = 512;
+        adpcm.wNumCoef = 7;
+        CHECK(SoftwareMixer::SourceFormat::FromWaveFormat(&adpcm.wfx, format));
+        CHECK(format.samplesPerBlock == 512);
+
+        adpcm.wNumCoef = 6;
+        CHECK(!SoftwareMixer::SourceFormat::FromWaveFormat(&adpcm.wfx, format));
+
+        adpcm.wNumCoef = 7;
+        adpcm.wfx.cbSize = 4;
+        CHECK(!SoftwareMixer::SourceFormat::FromWaveFormat(&adpcm.wfx, format));
+    }
+
+    void TestPassThrough()
+    {
+        const auto pcm = MakeSine(4800, 440., c_OutputRate, 16000.);
+
+        SoftwareMixer mixer(2, c_OutputRate);
+
+        SoftwareMixer::SourceFormat format;
+        const auto wfx = MakePCMFormat(1, c_OutputRate, 16);
+        CHECK(SoftwareMixer::SourceFormat::FromWaveFormat(&wfx, format));
+
+        const uint32_t voice = mixer.CreateVoice(format, MakeBuffer(pcm.data(), pcm.size() * sizeof(int16_t)));
+        CHECK(!mixer.IsPlaying(voice));
+        mixer.Play(voice);
+        CHECK(mixer.GetActiveVoiceCount() == 1);
+
+        std::vector<float> output(5000 * 2);
+        mixer.Render(output.data(), 5000);
+
+        // Mono goes to both front channels unchanged.
+        const auto expected = ToFloat(pcm);
+        CHECK(MaxError(output, 2, 0, expected) < 1e-5);
+        CHECK(MaxError(output, 2, 1, expected) < 1e-5);
+
+        // The voice stops at the end of the buffer and the rest is silent.
+        CHECK(!mixer.IsPlaying(voice));
+        CHECK(mixer.GetActiveVoiceCount() == 0);
+        CHECK(std::all_of(output.begin() + 4800 * 2, output.end(), [](float v) { return v == 0.f; }));
+
+        // Looping forever repeats the buffer.
+        mixer.DestroyVoice(voice);
+        const uint32_t looping = mixer.CreateVoice(format,
+            MakeBuffer(pcm.data(), pcm.size() * sizeof(int16_t), 0, 0, SoftwareMixer::LoopInfinite));
+        mixer.Play(looping);
+
+        output.assign(14400 * 2, 0.f);
+        mixer.Render(output.data(), 14400);
+
+        std::vector<float> repeated(14400);
+        for (size_t i = 0; i < repeated.size(); ++i)
+            repeated[i] = expected[i % expected.size()];
+        CHECK(MaxError(output, 2, 0, repeated) < 1e-5);
+        CHECK(mixer.IsPlaying(looping));
+    }
+
+    // A loop region played twice, rendered both in short calls and whole passes.
+    void TestLoopRegion()
+    {
+        std::vector<float> ramp(100);
+        for (size_t i = 0; i < ramp.size(); ++i)
+            ramp[i] = float(i);
+
+        SoftwareMixer::SourceFormat format = {};
+        format.tag = SoftwareMixer::Format_IEEEFloat;
+        format.channels = 1;
+        format.sampleRate = 1000;
+        format.bitsPerSample = 32;
+        format.blockAlign = 4;
+
+        std::vector<float> expected;
+        for (int i = 0; i < 50; ++i)
+            expected.push_back(float(i));
+        for (int k = 0; k < 2; ++k)
+            for (int i = 20; i < 50; ++i)
+                expected.push_back(float(i));
+        for (int i = 50; i < 100; ++i)
+            expected.push_back(float(i));
+        expected.resize(300, 0.f);
+
+        for (const size_t callFrames : { size_t(7), SoftwareMixer::PassFrames })
+        {
+            SoftwareMixer mixer(1, 1000);
+            const uint32_t voice = mixer.CreateVoice(format, MakeBuffer(ramp.data(), ramp.size() * sizeof(float), 20, 30, 2));
+            mixer.Play(voice);
+
+            std::vector<float> output(expected.size());
+            for (size_t offset = 0; offset < output.size(); offset += callFrames)
+                mixer.Render(output.data() + offset, std::min(callFrames, output.size() - offset));
+
+            CHECK(output == expected);
+            CHECK(!mixer.IsPlaying(voice));
+        }
+    }
+
+    void TestResample()
+    {
+        const auto pcm = MakeSine(24000, 440., 24000., 16000.);
+
+        SoftwareMixer mixer(2, c_OutputRate);
+
+        SoftwareMixer::SourceFormat format;
+        const auto wfx = MakePCMFormat(1, 24000, 16);
+        CHECK(SoftwareMixer::SourceFormat::FromWaveFormat(&wfx, format));
+
+        const uint32_t voice = mixer.CreateVoice(format, MakeBuffer(pcm.data(), pcm.size() * sizeof(int16_t)));
+        mixer.Play(voice);
+
+        std::vector<float> output(c_OutputRate * 2);
+        mixer.Render(output.data(), c_OutputRate);
+
+        // One second of a 440 Hz tone, now at the output rate.
+        const auto expected = ToFloat(MakeSine(c_OutputRate - 2, 440., c_OutputRate, 16000.));
+        CHECK(MaxError(output, 2, 0, expected) < 0.01);
+
+        int crossings = 0;
+        for (size_t i = 1; i < c_OutputRate; ++i)
+        {
+            if ((output[(i - 1) * 2] < 0.f) != (output[i * 2] < 0.f))
+                ++crossings;
+        }
+        CHECK(crossings >= 878 && crossings <= 882);
+    }
+
+    void TestVolumeRamp()
+    {
+        const std::vector<int16_t> dc(2000, 16384);
+
+        SoftwareMixer mixer(2, c_OutputRate);
+
+        SoftwareMixer::SourceFormat format;
+        const auto wfx = MakePCMFormat(1, c_OutputRate, 16);
+        CHECK(SoftwareMixer::SourceFormat::FromWaveFormat(&wfx, format));
+
+        const uint32_t voice = mixer.CreateVoice(format, MakeBuffer(dc.data(), dc.size() * sizeof(int16_t)));
+        const float leftOnly[2] = { 1.f, 0.f };
+        mixer.SetOutputMatrix(voice, leftOnly);
+        mixer.SetVolume(voice, 0.5f);
+        mixer.Play(voice);
+
+        std::vector<float> output(600 * 2);
+        mixer.Render(output.data(), 600);
+
+        // Both changes ramp over the first pass without overshooting, then hold.
+        bool smooth = true;
+        for (size_t i = 1; i < SoftwareMixer::PassFrames; ++i)
+        {
+            if (output[i * 2] > output[(i - 1) * 2] || output[i * 2 + 1] > output[(i - 1) * 2 + 1])
+                smooth = false;
+        }
+        CHECK(smooth);
+        CHECK(output[0] > 0.45f && output[0] <= 0.5f);
+        CHECK(output[1] > 0.45f && output[1] <= 0.5f);
+
+        for (size_t i = SoftwareMixer::PassFrames; i < 600; ++i)
+        {
+            if (!CHECK(output[i * 2] == 0.25f && output[i * 2 + 1] == 0.f))
+                break;
+        }
+    }
+
+    void TestADPCM()
+    {
+        const auto pcm = MakeSine(8000, 300., c_OutputRate, 12000.);
+        const auto encoded = EncodeADPCM(pcm, 512);
+
+        TestADPCMWaveFormat adpcm = {};
+        adpcm.wfx = { SoftwareMixer::Format_ADPCM, 1, c_OutputRate, 0, 7 + 510 / 2, 4, 32 };
+        adpcm.wSamplesPerBlock = 512;
+        adpcm.wNumCoef = 7;
+        const int16_t coefficients[7][2] = { { 256, 0 }, { 512, -256 }, { 0, 0 }, { 192, 64 }, { 240, 0 }, { 460, -208 }, { 392, -232 } };
+        memcpy(adpcm.aCoef, coefficients, sizeof(coefficients));
+
+        SoftwareMixer::SourceFormat format;
+        CHECK(SoftwareMixer::SourceFormat::FromWaveFormat(&adpcm.wfx, format));
+
+        SoftwareMixer mixer(2, c_OutputRate);
+        const uint32_t voice = mixer.CreateVoice(format, MakeBuffer(encoded.data(), encoded.size()));
+        mixer.Play(voice);
+
+        std::vector<float> output(8000 * 2);
+        mixer.Render(output.data(), 8000);
+
+        CHECK(MaxError(output, 2, 0, ToFloat(pcm)) < 0.01);
+    }
+
+    void BenchmarkVoices()
+    {
+        const auto pcm = MakeSine(4800, 440., c_OutputRate, 16000.);
+        const size_t voiceCount = 1000;
+
+        SoftwareMixer mixer(2, c_OutputRate);
+        for (size_t i = 0; i < voiceCount; ++i)
+        {
+            SoftwareMixer::SourceFormat format;
+            const auto wfx = MakePCMFormat(1, uint32_t(22050 + i * 20), 16);
+            SoftwareMixer::SourceFormat::FromWaveFormat(&wfx, format);
+
+            const uint32_t voice = mixer.CreateVoice(format,
+                MakeBuffer(pcm.data(), pcm.size() * sizeof(int16_t), 0, 0, SoftwareMixer::LoopInfinite));
+            mixer.SetVolume(voice, 0.001f);
+            mixer.Play(voice);
+        }
+
+        std::vector<float> output(c_OutputRate * 2);
+        TestHelpers::Timer timer;
+        mixer.Render(output.data(), c_OutputRate);
+        const double elapsed = timer.ElapsedMilliseconds();
+
+        CHECK(mixer.GetActiveVoiceCount() == voiceCount);
+
+        printf("%zu resampled voices, one second at %u Hz: %.3f ms\n", voiceCount, c_OutputRate, elapsed);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestFormats();
+    TestPassThrough();
+    TestLoopRegion();
+    TestResample();
+    TestVolumeRamp();
+    TestADPCM();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        BenchmarkVoices();
+    }
+
+    return TestHelpers::Finish("SoftwareMixerTest");
+}
@@ -0,0 +1,192 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteBatchCoreTest.cpp
+//
+// Checks the sprite sort keys and radix sort used by SpriteBatch against std::stable_sort,
+// and compares their speed with std::sort
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "SpriteBatchCore.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    struct SortedItem
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // Keys like SpriteBatch builds them for SpriteSortMode_Texture: a few distinct texture pointers.
+    std::vector<uint64_t> MakeTextureKeys(size_t count, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<uint64_t> keys(count);
+
+        for (auto& key : keys)
+            key = 0x00007FF612340000ull + (rng() % 16) * 0x1C0ull;
+
+        return keys;
+    }
+
+    // Keys like SpriteBatch builds them for SpriteSortMode_BackToFront.
+    std::vector<uint64_t> MakeDepthKeys(size_t count, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> depth(-1.f, 1.f);
+        std::vector<uint64_t> keys(count);
+
+        for (auto& key : keys)
+            key = ~uint64_t(SpriteBatchCore::DepthSortKey(depth(rng)));
+
+        return keys;
+    }
+
+    // Sorts keys with RadixSort, using the original index as the value, and checks the result
+    // against std::stable_sort.
+    bool MatchesStableSort(const std::vector<uint64_t>& input)
+    {
+        const size_t count = input.size();
+
+        std::vector<uint64_t> keys(input);
+        std::vector<uint32_t> values(count);
+        std::vector<uint64_t> scratchKeys(count);
+        std::vector<uint32_t> scratchValues(count);
+
+        for (size_t i = 0; i < count; ++i)
+            values[i] = static_cast<uint32_t>(i);
+
+        SpriteBatchCore::RadixSort(keys.data(), values.data(), scratchKeys.data(), scratchValues.data(), count);
+
+        std::vector<SortedItem> expected(count);
+        for (size_t i = 0; i < count; ++i)
+            expected[i] = { input[i], static_cast<uint32_t>(i) };
+
+        std::stable_sort(expected.begin(), expected.end(), [](const SortedItem& a, const SortedItem& b) noexcept
+            {
+                return a.key < b.key;
+            });
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (keys[i] != expected[i].key || values[i] != expected[i].index)
+                return false;
+        }
+
+        return true;
+    }
+
+    void TestDepthSortKey()
+    {
+        const float depths[] =
+        {
+            -std::numeric_limits<float>::infinity(),
+            -1e30f,
+            -1.f,
+            -std::numeric_limits<float>::denorm_min(),
+            0.f,
+            std::numeric_limits<float>::denorm_min(),
+            0.5f,
+            1.f,
+            std::numeric_limits<float>::infinity(),
+        };
+
+        for (size_t i = 1; i < std::size(depths); ++i)
+        {
+            CHECK(SpriteBatchCore::DepthSortKey(depths[i - 1]) < SpriteBatchCore::DepthSortKey(depths[i]));
+        }
+
+        CHECK(SpriteBatchCore::DepthSortKey(-0.f) == SpriteBatchCore::DepthSortKey(0.f));
+    }
+
+    void TestRadixSort()
+    {
+        // Empty and single-element inputs, and inputs where every pass is skipped
+        CHECK(MatchesStableSort({}));
+        CHECK(MatchesStableSort({ 42 }));
+        CHECK(MatchesStableSort(std::vector<uint64_t>(1000, 0x1234567890ABCDEFull)));
+
+        CHECK(MatchesStableSort(MakeTextureKeys(3, 1)));
+        CHECK(MatchesStableSort(MakeTextureKeys(10000, 2)));
+        CHECK(MatchesStableSort(MakeDepthKeys(10000, 3)));
+
+        // Keys that differ in every byte
+        std::mt19937_64 rng(4);
+        std::vector<uint64_t> keys(10000);
+        for (auto& key : keys)
+            key = rng();
+
+        CHECK(MatchesStableSort(keys));
+    }
+
+    void BenchmarkSort(const char* name, const std::vector<uint64_t>& input)
+    {
+        const size_t count = input.size();
+        const int iterations = 20;
+
+        std::vector<uint64_t> keys(count);
+        std::vector<uint32_t> values(count);
+        std::vector<uint64_t> scratchKeys(count);
+        std::vector<uint32_t> scratchValues(count);
+        std::vector<SortedItem> items(count);
+
+        double radixTime = 0;
+        double stdSortTime = 0;
+
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            keys = input;
+            for (size_t i = 0; i < count; ++i)
+                values[i] = static_cast<uint32_t>(i);
+
+            {
+                TestHelpers::Timer timer;
+                SpriteBatchCore::RadixSort(keys.data(), values.data(), scratchKeys.data(), scratchValues.data(), count);
+                radixTime += timer.ElapsedMilliseconds();
+            }
+
+            for (size_t i = 0; i < count; ++i)
+                items[i] = { input[i], static_cast<uint32_t>(i) };
+
+            {
+                TestHelpers::Timer timer;
+                std::sort(items.begin(), items.end(), [](const SortedItem& a, const SortedItem& b) noexcept
+                    {
+                        return a.key < b.key;
+                    });
+                stdSortTime += timer.ElapsedMilliseconds();
+            }
+        }
+
+        printf("%-8s %zu sprites: RadixSort %.3f ms, std::sort %.3f ms\n",
+            name, count, radixTime / iterations, stdSortTime / iterations);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestDepthSortKey();
+    TestRadixSort();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        BenchmarkSort("Texture", MakeTextureKeys(100000, 5));
+        BenchmarkSort("Depth", MakeDepthKeys(100000, 6));
+    }
+
+    return TestHelpers::Finish("SpriteBatchCoreTest");
+}
@@ -0,0 +1,194 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontCoreTest.cpp
+//
+// Checks the SpriteFont glyph table against an ordered map, checks the layout cache, and
+// compares glyph lookups with the binary search SpriteFont used before
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "SpriteFontCore.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    struct Glyph
+    {
+        uint32_t Character;
+    };
+
+    using GlyphTable = SpriteFontCore::GlyphTable;
+    using LayoutCache = SpriteFontCore::LayoutCache<Glyph>;
+
+    // ASCII, a full CJK page, a few scattered BMP characters and a few astral ones, sorted by
+    // character code like the glyphs of a .spritefont file.
+    std::vector<Glyph> MakeGlyphs()
+    {
+        std::vector<Glyph> glyphs;
+
+        for (uint32_t c = 32; c < 127; ++c)
+            glyphs.push_back({ c });
+
+        for (uint32_t c = 0x4E00; c < 0x4F00; ++c)
+            glyphs.push_back({ c });
+
+        for (const uint32_t c : { 0x20ACu, 0x2122u, 0xFFFDu, 0x1F600u, 0x1F601u, 0x2A6D6u })
+            glyphs.push_back({ c });
+
+        std::sort(glyphs.begin(), glyphs.end(), [](const Glyph& a, const Glyph& b) noexcept
+            {
+                return a.Character < b.Character;
+            });
+
+        return glyphs;
+    }
+
+    void TestGlyphTable()
+    {
+        const std::vector<Glyph> glyphs = MakeGlyphs();
+
+        GlyphTable table;
+        CHECK(table.Find(L'A') == GlyphTable::InvalidIndex);
+
+        table.Build(glyphs.data(), glyphs.size());
+
+        std::map<uint32_t, uint32_t> reference;
+        for (size_t i = 0; i < glyphs.size(); ++i)
+            reference[glyphs[i].Character] = static_cast<uint32_t>(i);
+
+        size_t mismatches = 0;
+        for (uint32_t c = 0; c < 0x31000; ++c)
+        {
+            auto it = reference.find(c);
+            const uint32_t expected = (it != reference.end()) ? it->second : GlyphTable::InvalidIndex;
+
+            if (table.Find(c) != expected)
+                ++mismatches;
+        }
+
+        CHECK(mismatches == 0);
+        CHECK(table.Find(UINT32_MAX) == GlyphTable::InvalidIndex);
+
+        // Rebuilding drops the glyphs of the previous font
+        const Glyph fewGlyphs[] = { { 'x' }, { 0x1F600 } };
+        table.Build(fewGlyphs, std::size(fewGlyphs));
+
+        CHECK(table.Find('x') == 0);
+        CHECK(table.Find(0x1F600) == 1);
+        CHECK(table.Find('A') == GlyphTable::InvalidIndex);
+        CHECK(table.Find(0x4E00) == GlyphTable::InvalidIndex);
+        CHECK(table.Find(0x1F601) == GlyphTable::InvalidIndex);
+    }
+
+    void TestLayoutCache()
+    {
+        const Glyph glyph = { 'a' };
+        const wchar_t* text = L"Score";
+        const wchar_t* otherText = L"Lives";
+
+        LayoutCache cache;
+
+        size_t length = 0;
+        const uint64_t hash = LayoutCache::Hash(text, false, &length);
+        CHECK(length == 5);
+        CHECK(LayoutCache::Hash(text, true, &length) != hash);
+
+        // Caching is off until a size is set
+        CHECK(cache.Insert(hash, text, length, false, LayoutCache::Items{ { &glyph, 0.f, 0.f, 8.f } }) == nullptr);
+        CHECK(cache.Find(hash, text, length, false) == nullptr);
+
+        cache.SetMaxEntries(2);
+
+        const LayoutCache::Items* items = cache.Insert(hash, text, length, false, LayoutCache::Items{ { &glyph, 1.f, 2.f, 8.f } });
+        if (CHECK(items != nullptr && items->size() == 1))
+        {
+            CHECK(cache.Find(hash, text, length, false) == items);
+            CHECK((*items)[0].glyph == &glyph && (*items)[0].x == 1.f && (*items)[0].y == 2.f);
+        }
+
+        // A different whitespace mode, or a different string with the same hash, is a miss
+        CHECK(cache.Find(hash, text, length, true) == nullptr);
+        CHECK(cache.Find(hash, otherText, 5, false) == nullptr);
+
+        // The cache is emptied once it is full
+        cache.Insert(1, otherText, 5, false, LayoutCache::Items{});
+        CHECK(cache.Find(hash, text, length, false) != nullptr);
+
+        cache.Insert(2, otherText, 5, true, LayoutCache::Items{});
+        CHECK(cache.Find(hash, text, length, false) == nullptr);
+        CHECK(cache.Find(2, otherText, 5, true) != nullptr);
+
+        cache.Clear();
+        CHECK(cache.Find(2, otherText, 5, true) == nullptr);
+    }
+
+    void RunBenchmark()
+    {
+        const std::vector<Glyph> glyphs = MakeGlyphs();
+        const size_t lookupCount = 10000000;
+
+        GlyphTable table;
+        table.Build(glyphs.data(), glyphs.size());
+
+        // Mostly ASCII text, with some CJK
+        std::mt19937 rng(1);
+        std::vector<uint32_t> characters(4096);
+        for (auto& c : characters)
+            c = (rng() % 4 != 0) ? 32 + rng() % 95 : 0x4E00 + rng() % 256;
+
+        uint64_t checksum = 0;
+
+        {
+            TestHelpers::Timer timer;
+            for (size_t i = 0; i < lookupCount; ++i)
+                checksum += table.Find(characters[i & 4095]);
+
+            printf("GlyphTable::Find: %.2f ms for %zu lookups\n", timer.ElapsedMilliseconds(), lookupCount);
+        }
+
+        {
+            TestHelpers::Timer timer;
+            for (size_t i = 0; i < lookupCount; ++i)
+            {
+                const uint32_t c = characters[i & 4095];
+                auto it = std::lower_bound(glyphs.begin(), glyphs.end(), c, [](const Glyph& glyph, uint32_t character) noexcept
+                    {
+                        return glyph.Character < character;
+                    });
+
+                checksum -= static_cast<uint64_t>(it - glyphs.begin());
+            }
+
+            printf("Binary search:    %.2f ms for %zu lookups\n", timer.ElapsedMilliseconds(), lookupCount);
+        }
+
+        // Both loops found the same glyphs
+        CHECK(checksum == 0);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestGlyphTable();
+    TestLayoutCache();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        RunBenchmark();
+    }
+
+    return TestHelpers::Finish("SpriteFontCoreTest");
+}
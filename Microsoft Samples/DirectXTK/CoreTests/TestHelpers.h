@@ -0,0 +1,74 @@
+//--------------------------------------------------------------------------------------
+// File: TestHelpers.h
+//
+// Checks and timing shared by the tests of the platform-neutral headers
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Also brings in the SAL annotations used by the headers under test.
+#include <DirectXMath.h>
+
+
+namespace TestHelpers
+{
+    inline int& FailureCount() noexcept
+    {
+        static int s_failures = 0;
+        return s_failures;
+    }
+
+    inline bool Check(bool condition, const char* text, const char* file, int line) noexcept
+    {
+        if (!condition)
+        {
+            fprintf(stderr, "%s(%d): check failed: %s\n", file, line, text);
+            ++FailureCount();
+        }
+
+        return condition;
+    }
+
+    inline bool IsBenchmark(int argc, char** argv) noexcept
+    {
+        return argc > 1 && strcmp(argv[1], "--benchmark") == 0;
+    }
+
+    // Prints a summary and returns the process exit code.
+    inline int Finish(const char* testName) noexcept
+    {
+        if (FailureCount() != 0)
+        {
+            fprintf(stderr, "%s: %d check(s) failed\n", testName, FailureCount());
+            return 1;
+        }
+
+        printf("%s: all checks passed\n", testName);
+        return 0;
+    }
+
+    class Timer
+    {
+    public:
+        Timer() noexcept : mStart(std::chrono::steady_clock::now()) {}
+
+        double ElapsedMilliseconds() const noexcept
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point mStart;
+    };
+}
+
+#define CHECK(condition) TestHelpers::Check(!!(condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,684 @@
+//--------------------------------------------------------------------------------------
+// File: WaveBankCoreTest.cpp
+//
+// Checks wave bank header validation, entry metadata, seek tables and names on synthetic
+// banks, including big-endian and truncated ones, and times reading a large bank's tables
+// and its wave data, both mapped and in streaming packets
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "WaveBankCore.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace DirectX::WaveBankCore;
+
+namespace
+{
+    // Same layout as ADPCMWAVEFORMAT after the WAVEFORMATEX header.
+    struct TestADPCMCoefficients
+    {
+        uint16_t wSamplesPerBlock;
+        uint16_t wNumCoef;
+        struct { int16_t iCoef1; int16_t iCoef2; } aCoef[7];
+    };
+
+    HEADER MakeHeader() noexcept
+    {
+        HEADER header = {};
+        header.dwSignature = HEADER::SIGNATURE;
+        header.dwHeaderVersion = HEADER::VERSION;
+        return header;
+    }
+
+    // A regular (non-compact) in-memory bank with the given number of entries.
+    void MakeBank(uint32_t count, HEADER& header, BANKDATA& data, std::vector<ENTRY>& entries)
+    {
+        header = MakeHeader();
+
+        data = {};
+        data.dwEntryCount = count;
+        data.dwEntryMetaDataElementSize = sizeof(ENTRY);
+        data.dwEntryNameElementSize = 64;
+        data.dwAlignment = static_cast<uint32_t>(ALIGNMENT_MIN);
+
+        entries.assign(count, ENTRY{});
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            entries[j].Duration = 50 * (j + 1);
+            entries[j].PlayRegion.dwOffset = 100 * j;
+            entries[j].PlayRegion.dwLength = 100;
+            entries[j].LoopRegion.dwStartSample = j;
+            entries[j].LoopRegion.dwTotalSamples = 7;
+        }
+
+        header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength = count * uint32_t(sizeof(ENTRY));
+        header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength = 100 * count;
+    }
+
+    void TestHeader()
+    {
+        HEADER header = MakeHeader();
+        bool bigEndian = true;
+        CHECK(ValidateHeader(header, bigEndian));
+        CHECK(!bigEndian);
+
+        // A big-endian header is converted in place.
+        HEADER swapped = MakeHeader();
+        swapped.dwSignature = HEADER::BE_SIGNATURE;
+        swapped.dwHeaderVersion = ByteSwap(HEADER::VERSION);
+        swapped.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset = ByteSwap(0x1000u);
+        swapped.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength = ByteSwap(1000u);
+        CHECK(ValidateHeader(swapped, bigEndian));
+        CHECK(bigEndian);
+        CHECK(swapped.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset == 0x1000);
+        CHECK(swapped.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength == 1000);
+
+        header = MakeHeader();
+        header.dwHeaderVersion = HEADER::VERSION - 1;
+        CHECK(!ValidateHeader(header, bigEndian));
+
+        header = MakeHeader();
+        header.dwSignature = 0x12345678;
+        CHECK(!ValidateHeader(header, bigEndian));
+    }
+
+    void TestBankData()
+    {
+        HEADER header;
+        BANKDATA data;
+        std::vector<ENTRY> entries;
+        MakeBank(3, header, data, entries);
+
+        CHECK(ValidateBankData(header, data));
+
+        // Streaming banks need DVD sector alignment.
+        data.dwFlags = BANKDATA::TYPE_STREAMING;
+        CHECK(!ValidateBankData(header, data));
+        data.dwAlignment = static_cast<uint32_t>(ALIGNMENT_DVD);
+        CHECK(ValidateBankData(header, data));
+        data.dwAlignment = static_cast<uint32_t>(ALIGNMENT_DVD + 4);
+        CHECK(!ValidateBankData(header, data));
+
+        MakeBank(3, header, data, entries);
+        header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength += 1;
+        CHECK(!ValidateBankData(header, data));
+
+        // An entry count whose metadata size overflows 32 bits
+        MakeBank(3, header, data, entries);
+        data.dwEntryCount = 0x80000001u;
+        header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength = data.dwEntryCount * uint32_t(sizeof(ENTRY));
+        CHECK(!ValidateBankData(header, data));
+
+        MakeBank(3, header, data, entries);
+        data.dwEntryMetaDataElementSize = sizeof(ENTRYCOMPACT);
+        CHECK(!ValidateBankData(header, data));
+    }
+
+    void TestEntries()
+    {
+        HEADER header;
+        BANKDATA data;
+        std::vector<ENTRY> entries;
+        MakeBank(3, header, data, entries);
+        entries[2].PlayRegion.dwLength = 101;
+
+        EntryMetadata metadata = {};
+        CHECK(GetEntryMetadata(1, header, data, entries.data(), nullptr, metadata));
+        CHECK(metadata.duration == 100 && metadata.offsetBytes == 100 && metadata.lengthBytes == 100);
+        CHECK(metadata.loopStart == 1 && metadata.loopLength == 7);
+        CHECK(IsInWaveData(header, metadata));
+
+        // The last entry runs one byte past the wave data.
+        CHECK(GetEntryMetadata(2, header, data, entries.data(), nullptr, metadata));
+        CHECK(!IsInWaveData(header, metadata));
+
+        CHECK(!GetEntryMetadata(3, header, data, entries.data(), nullptr, metadata));
+        CHECK(!GetEntryMetadata(0, header, data, nullptr, nullptr, metadata));
+
+        // Offsets near 4 GB must not wrap around.
+        entries[0].PlayRegion.dwOffset = UINT32_MAX - 10;
+        CHECK(GetEntryMetadata(0, header, data, entries.data(), nullptr, metadata));
+        CHECK(!IsInWaveData(header, metadata));
+
+        // Swapping twice gives back the original entries.
+        MakeBank(3, header, data, entries);
+        std::vector<ENTRY> swapped(entries);
+        SwapEntries(swapped.data(), data);
+        CHECK(memcmp(swapped.data(), entries.data(), sizeof(ENTRY) * entries.size()) != 0);
+        CHECK(swapped[1].PlayRegion.dwOffset == ByteSwap(100u));
+        SwapEntries(swapped.data(), data);
+        CHECK(memcmp(swapped.data(), entries.data(), sizeof(ENTRY) * entries.size()) == 0);
+    }
+
+    void TestNames()
+    {
+        BANKDATA data = {};
+        data.dwEntryCount = 3;
+        data.dwEntryNameElementSize = 64;
+
+        // The third name fills its whole element with no terminator.
+        std::vector<char> names(64 * 3, 0);
+        memcpy(&names[0], "alpha", 6);
+        memcpy(&names[64], "beta", 5);
+        memset(&names[128], 'x', 64);
+
+        std::map<std::string, uint32_t> result;
+        ParseNames(names.data(), names.size(), data, result);
+        CHECK(result.size() == 3);
+        CHECK(result["alpha"] == 0);
+        CHECK(result["beta"] == 1);
+        CHECK(result.count(std::string(63, 'x')) == 1 && result[std::string(63, 'x')] == 2);
+
+        // A names segment that is too short is ignored rather than read past.
+        result.clear();
+        ParseNames(names.data(), names.size() - 1, data, result);
+        CHECK(result.empty());
+
+        // Elements longer than the name limit are cut to 63 characters.
+        data.dwEntryCount = 1;
+        data.dwEntryNameElementSize = 100;
+        std::vector<char> longName(100, 'y');
+        result.clear();
+        ParseNames(longName.data(), longName.size(), data, result);
+        CHECK(result.size() == 1 && result.count(std::string(63, 'y')) == 1);
+    }
+
+    void TestCompactBank()
+    {
+        HEADER header = MakeHeader();
+
+        BANKDATA data = {};
+        data.dwFlags = BANKDATA::FLAGS_COMPACT;
+        data.dwEntryCount = 2;
+        data.dwEntryMetaDataElementSize = sizeof(ENTRYCOMPACT);
+        data.dwAlignment = static_cast<uint32_t>(ALIGNMENT_MIN);
+        data.CompactFormat.wFormatTag = MINIWAVEFORMAT::TAG_WMA;
+        data.CompactFormat.nChannels = 2;
+
+        header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength = 2 * sizeof(ENTRYCOMPACT);
+        header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength = 64;
+        CHECK(ValidateBankData(header, data));
+
+        ENTRYCOMPACT entries[2] = {};
+        entries[0].dwOffset = 0;
+        entries[1].dwOffset = 8;
+        entries[1].dwLengthDeviation = 2;
+
+        // An offset per entry, then entry 0's table of two packet positions. Entry 1 has none.
+        uint32_t seek[] = { 0, uint32_t(-1), 2, 100, 400 };
+        auto seekData = reinterpret_cast<const uint8_t*>(seek);
+        header.Segments[HEADER::SEGIDX_SEEKTABLES].dwLength = sizeof(seek);
+
+        EntryMetadata metadata = {};
+        CHECK(GetEntryMetadata(0, header, data, entries, seekData, metadata));
+        CHECK(metadata.offsetBytes == 0 && metadata.lengthBytes == 32 && metadata.duration == 100);
+
+        CHECK(GetEntryMetadata(1, header, data, entries, seekData, metadata));
+        CHECK(metadata.offsetBytes == 32 && metadata.lengthBytes == 30 && metadata.duration == 0);
+
+        const uint32_t* table = FindSeekTable(0, seekData, header, data);
+        CHECK(table == &seek[2]);
+        CHECK(FindSeekTable(1, seekData, header, data) == nullptr);
+        CHECK(FindSeekTable(2, seekData, header, data) == nullptr);
+
+        // Truncated seek table segments reject the table instead of reading past them.
+        for (uint32_t length = 0; length < sizeof(seek); length += sizeof(uint32_t))
+        {
+            header.Segments[HEADER::SEGIDX_SEEKTABLES].dwLength = length;
+            CHECK(FindSeekTable(0, seekData, header, data) == nullptr);
+        }
+
+        // A table count that runs past the segment
+        header.Segments[HEADER::SEGIDX_SEEKTABLES].dwLength = sizeof(seek);
+        seek[2] = 0x40000000u;
+        CHECK(FindSeekTable(0, seekData, header, data) == nullptr);
+        seek[2] = 2;
+
+        uint32_t swapped[5];
+        memcpy(swapped, seek, sizeof(seek));
+        SwapSeekTables(reinterpret_cast<uint8_t*>(swapped), sizeof(swapped));
+        CHECK(swapped[4] == ByteSwap(400u));
+
+        // A compact bank whose wave data is too large for its offsets
+        header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength = static_cast<uint32_t>((MAX_COMPACT_DATA_SEGMENT_SIZE + 1) * data.dwAlignment);
+        CHECK(!ValidateBankData(header, data));
+
+        TestADPCMCoefficients adpcm = {};
+        data.CompactFormat.AdpcmFillCoefficientTable(&adpcm);
+        CHECK(adpcm.wNumCoef == 7);
+        CHECK(adpcm.aCoef[5].iCoef1 == 460 && adpcm.aCoef[5].iCoef2 == -208);
+    }
+
+    void BenchmarkTables()
+    {
+        const uint32_t count = 20000;
+        const int iterations = 20;
+
+        HEADER header;
+        BANKDATA data;
+        std::vector<ENTRY> entries;
+        MakeBank(count, header, data, entries);
+
+        std::vector<char> names(size_t(count) * data.dwEntryNameElementSize, 0);
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            const std::string name = "wave_" + std::to_string(j);
+            memcpy(&names[size_t(j) * data.dwEntryNameElementSize], name.c_str(), name.size());
+        }
+
+        double metadataTime = 0;
+        double namesTime = 0;
+        uint64_t totalDuration = 0;
+
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            {
+                TestHelpers::Timer timer;
+                EntryMetadata metadata;
+                for (uint32_t j = 0; j < count; ++j)
+                {
+                    if (GetEntryMetadata(j, header, data, entries.data(), nullptr, metadata) && IsInWaveData(header, metadata))
+                        totalDuration += metadata.duration;
+                }
+                metadataTime += timer.ElapsedMilliseconds();
+            }
+
+            {
+                TestHelpers::Timer timer;
+                std::map<std::string, uint32_t> result;
+                ParseNames(names.data(), names.size(), data, result);
+                namesTime += timer.ElapsedMilliseconds();
+                CHECK(result.size() == count);
+            }
+        }
+
+        CHECK(totalDuration != 0);
+
+        printf("%u entries: metadata %.3f ms, names %.3f ms\n", count, metadataTime / iterations, namesTime / iterations);
+    }
+
+    //----------------------------------------------------------------------------------
+    // Bank file benchmark. WaveBankReader itself needs Win32 file I/O and XAudio2, so this
+    // reproduces its two ways of reading wave data with the same parsing code: in-memory
+    // banks map the whole file, while streaming banks read packets of the size
+    // SoundStreamInstance uses, a read-ahead count of them at a time.
+
+    constexpr uint32_t c_BankAlignment = 4096;
+    constexpr uint32_t c_SamplesPerSec = 48000;
+    constexpr uint32_t c_BlockAlign = 4; // 16-bit stereo
+
+    // Same as ComputeAsyncPacketSize in SoundStreamInstance.cpp for PCM.
+    constexpr size_t c_PacketSize = std::max<size_t>(65536u,
+        ((size_t(c_SamplesPerSec) * c_BlockAlign * 2u + c_BankAlignment * 2u - 1) / (c_BankAlignment * 2u)) * (c_BankAlignment * 2u));
+
+    // Same range as WaveBank::SetStreamingReadAhead.
+    const unsigned int c_ReadAheads[] = { 2, 3, 16 };
+
+    uint32_t AlignToBank(uint32_t value) noexcept
+    {
+        return (value + c_BankAlignment - 1) & ~(c_BankAlignment - 1);
+    }
+
+    // Writes a PCM bank with the given number of entries of entryBytes each.
+    bool WriteBankFile(const std::filesystem::path& path, uint32_t count, uint32_t entryBytes)
+    {
+        HEADER header = MakeHeader();
+
+        BANKDATA data = {};
+        data.dwFlags = BANKDATA::FLAGS_ENTRYNAMES;
+        data.dwEntryCount = count;
+        data.dwEntryMetaDataElementSize = sizeof(ENTRY);
+        data.dwEntryNameElementSize = 64;
+        data.dwAlignment = c_BankAlignment;
+
+        std::vector<ENTRY> entries(count, ENTRY{});
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            entries[j].Format.wFormatTag = MINIWAVEFORMAT::TAG_PCM;
+            entries[j].Format.nChannels = 2;
+            entries[j].Format.nSamplesPerSec = c_SamplesPerSec;
+            entries[j].Format.wBlockAlign = c_BlockAlign;
+            entries[j].Format.wBitsPerSample = MINIWAVEFORMAT::BITDEPTH_16;
+            entries[j].Duration = entryBytes / c_BlockAlign;
+            entries[j].PlayRegion.dwOffset = j * AlignToBank(entryBytes);
+            entries[j].PlayRegion.dwLength = entryBytes;
+        }
+
+        std::vector<char> names(size_t(count) * data.dwEntryNameElementSize, 0);
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            const std::string name = "wave_" + std::to_string(j);
+            memcpy(&names[size_t(j) * data.dwEntryNameElementSize], name.c_str(), name.size());
+        }
+
+        auto& segments = header.Segments;
+        segments[HEADER::SEGIDX_BANKDATA].dwOffset = sizeof(HEADER);
+        segments[HEADER::SEGIDX_BANKDATA].dwLength = sizeof(BANKDATA);
+        segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset = segments[HEADER::SEGIDX_BANKDATA].dwOffset + sizeof(BANKDATA);
+        segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength = count * uint32_t(sizeof(ENTRY));
+        segments[HEADER::SEGIDX_SEEKTABLES].dwOffset = segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset + segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength;
+        segments[HEADER::SEGIDX_ENTRYNAMES].dwOffset = segments[HEADER::SEGIDX_SEEKTABLES].dwOffset;
+        segments[HEADER::SEGIDX_ENTRYNAMES].dwLength = uint32_t(names.size());
+        segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset = AlignToBank(segments[HEADER::SEGIDX_ENTRYNAMES].dwOffset + segments[HEADER::SEGIDX_ENTRYNAMES].dwLength);
+        segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength = count * AlignToBank(entryBytes);
+
+        std::vector<uint8_t> file(size_t(segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset) + segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength, 0);
+        memcpy(file.data(), &header, sizeof(header));
+        memcpy(file.data() + segments[HEADER::SEGIDX_BANKDATA].dwOffset, &data, sizeof(data));
+        memcpy(file.data() + segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset, entries.data(), segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength);
+        memcpy(file.data() + segments[HEADER::SEGIDX_ENTRYNAMES].dwOffset, names.data(), names.size());
+
+        uint8_t* wave = file.data() + segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
+        for (size_t j = 0; j < segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength; ++j)
+        {
+            wave[j] = static_cast<uint8_t>(j * 31 + (j >> 12));
+        }
+
+        FILE* fp = fopen(path.string().c_str(), "wb");
+        if (!fp)
+            return false;
+
+        const bool written = fwrite(file.data(), 1, file.size(), fp) == file.size();
+        return (fclose(fp) == 0) && written;
+    }
+
+    // The tables WaveBankReader reads when opening a bank.
+    struct OpenedBank
+    {
+        HEADER                          header;
+        BANKDATA                        data;
+        std::vector<ENTRY>              entries;
+        std::map<std::string, uint32_t> names;
+    };
+
+    // Reads and validates the tables through read(offset, bytes, dest).
+    template<typename TRead>
+    bool OpenBank(TRead&& read, OpenedBank& bank)
+    {
+        bool bigEndian = false;
+        if (!read(0, sizeof(HEADER), &bank.header) || !ValidateHeader(bank.header, bigEndian))
+            return false;
+
+        const auto& segments = bank.header.Segments;
+        if (!read(segments[HEADER::SEGIDX_BANKDATA].dwOffset, sizeof(BANKDATA), &bank.data)
+            || !ValidateBankData(bank.header, bank.data))
+            return false;
+
+        bank.entries.resize(bank.data.dwEntryCount);
+        if (!read(segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset, segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength, bank.entries.data()))
+            return false;
+
+        std::vector<char> names(segments[HEADER::SEGIDX_ENTRYNAMES].dwLength);
+        if (!read(segments[HEADER::SEGIDX_ENTRYNAMES].dwOffset, names.size(), names.data()))
+            return false;
+
+        bank.names.clear();
+        ParseNames(names.data(), names.size(), bank.data, bank.names);
+        return bank.names.size() == bank.data.dwEntryCount;
+    }
+
+    uint64_t Checksum(const uint8_t* data, size_t bytes) noexcept
+    {
+        uint64_t sum = 0;
+        for (size_t j = 0; j < bytes; ++j)
+        {
+            sum += data[j];
+        }
+        return sum;
+    }
+
+    // Read-only view of a whole file, as WaveBankReader uses for in-memory banks.
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::filesystem::path& path) noexcept :
+            mData(nullptr),
+            mSize(0)
+        {
+        #ifdef _WIN32
+            HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (hFile == INVALID_HANDLE_VALUE)
+                return;
+
+            LARGE_INTEGER size = {};
+            HANDLE hMapping = GetFileSizeEx(hFile, &size) ? CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+            if (hMapping)
+            {
+                mData = static_cast<const uint8_t*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+                mSize = mData ? static_cast<size_t>(size.QuadPart) : 0;
+                CloseHandle(hMapping);
+            }
+            CloseHandle(hFile);
+        #else
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+
+            struct stat st = {};
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void* view = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (view != MAP_FAILED)
+                {
+                    mData = static_cast<const uint8_t*>(view);
+                    mSize = size_t(st.st_size);
+                }
+            }
+            close(fd);
+        #endif
+        }
+
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator= (MappedFile const&) = delete;
+
+        ~MappedFile()
+        {
+            if (!mData)
+                return;
+
+        #ifdef _WIN32
+            UnmapViewOfFile(mData);
+        #else
+            munmap(const_cast<uint8_t*>(mData), mSize);
+        #endif
+        }
+
+        const uint8_t* Data() const noexcept { return mData; }
+        size_t Size() const noexcept { return mSize; }
+
+    private:
+        const uint8_t*  mData;
+        size_t          mSize;
+    };
+
+    // Opens the bank through a mapping, then reads every entry from it in order.
+    bool ReadMapped(const std::filesystem::path& path, uint64_t& checksum, double& openTime)
+    {
+        TestHelpers::Timer timer;
+
+        MappedFile file(path);
+        if (!file.Data())
+            return false;
+
+        OpenedBank bank;
+        auto read = [&file](uint64_t offset, size_t bytes, void* dest)
+            {
+                if (offset + bytes > file.Size())
+                    return false;
+                memcpy(dest, file.Data() + offset, bytes);
+                return true;
+            };
+        if (!OpenBank(read, bank))
+            return false;
+
+        openTime = timer.ElapsedMilliseconds();
+
+        const uint8_t* wave = file.Data() + bank.header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
+
+        checksum = 0;
+        for (uint32_t j = 0; j < bank.data.dwEntryCount; ++j)
+        {
+            EntryMetadata metadata;
+            if (!GetEntryMetadata(j, bank.header, bank.data, bank.entries.data(), nullptr, metadata) || !IsInWaveData(bank.header, metadata))
+                return false;
+
+            checksum += Checksum(wave + metadata.offsetBytes, metadata.lengthBytes);
+        }
+
+        return true;
+    }
+
+    // Opens the bank with unbuffered reads, then streams every entry in order, readAhead
+    // packets per read.
+    bool ReadStreaming(const std::filesystem::path& path, unsigned int readAhead, uint64_t& checksum, double& openTime)
+    {
+        TestHelpers::Timer timer;
+
+        FILE* fp = fopen(path.string().c_str(), "rb");
+        if (!fp)
+            return false;
+
+        setvbuf(fp, nullptr, _IONBF, 0);
+
+        auto read = [fp](uint64_t offset, size_t bytes, void* dest)
+            {
+                return fseek(fp, long(offset), SEEK_SET) == 0 && fread(dest, 1, bytes, fp) == bytes;
+            };
+
+        OpenedBank bank;
+        bool result = OpenBank(read, bank);
+
+        openTime = timer.ElapsedMilliseconds();
+
+        std::vector<uint8_t> buffer(c_PacketSize * readAhead);
+
+        checksum = 0;
+        for (uint32_t j = 0; result && j < bank.data.dwEntryCount; ++j)
+        {
+            EntryMetadata metadata;
+            if (!GetEntryMetadata(j, bank.header, bank.data, bank.entries.data(), nullptr, metadata) || !IsInWaveData(bank.header, metadata))
+            {
+                result = false;
+                break;
+            }
+
+            uint64_t position = uint64_t(bank.header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset) + metadata.offsetBytes;
+            size_t remaining = metadata.lengthBytes;
+            while (remaining > 0)
+            {
+                const size_t bytes = std::min(remaining, buffer.size());
+                if (!read(position, bytes, buffer.data()))
+                {
+                    result = false;
+                    break;
+                }
+
+                checksum += Checksum(buffer.data(), bytes);
+                position += bytes;
+                remaining -= bytes;
+            }
+        }
+
+        fclose(fp);
+        return result;
+    }
+
+    void BenchmarkBankFile()
+    {
+        const uint32_t count = 64;
+        const uint32_t entryBytes = 1000000; // About 5 seconds each
+        const int iterations = 5;
+
+        std::error_code ec;
+        const auto path = std::filesystem::temp_directory_path(ec) / "WaveBankCoreTest.xwb";
+        if (!CHECK(!ec && WriteBankFile(path, count, entryBytes)))
+            return;
+
+        uint64_t expected = 0;
+        double openTime = 0;
+        double readTime = 0;
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            TestHelpers::Timer timer;
+            double open = 0;
+            uint64_t checksum = 0;
+            CHECK(ReadMapped(path, checksum, open));
+            readTime += timer.ElapsedMilliseconds();
+            openTime += open;
+
+            CHECK(iteration == 0 || checksum == expected);
+            expected = checksum;
+        }
+
+        const double megabytes = double(count) * entryBytes / (1024.0 * 1024.0);
+        printf("%u entries, %.1f MB: mapped open %.3f ms, open and read %.3f ms\n",
+            count, megabytes, openTime / iterations, readTime / iterations);
+
+        for (const unsigned int readAhead : c_ReadAheads)
+        {
+            openTime = readTime = 0;
+            for (int iteration = 0; iteration < iterations; ++iteration)
+            {
+                TestHelpers::Timer timer;
+                double open = 0;
+                uint64_t checksum = 0;
+                CHECK(ReadStreaming(path, readAhead, checksum, open));
+                readTime += timer.ElapsedMilliseconds();
+                openTime += open;
+
+                CHECK(checksum == expected);
+            }
+
+            printf("%u entries, %.1f MB: streaming %u x %zu byte packets open %.3f ms, open and read %.3f ms\n",
+                count, megabytes, readAhead, c_PacketSize, openTime / iterations, readTime / iterations);
+        }
+
+        std::filesystem::remove(path, ec);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestHeader();
+    TestBankData();
+    TestEntries();
+    TestNames();
+    TestCompactBank();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        BenchmarkTables();
+        BenchmarkBankFile();
+    }
+
+    return TestHelpers::Finish("WaveBankCoreTest");
+}
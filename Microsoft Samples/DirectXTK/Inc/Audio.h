@@ -335,6 +335,11 @@ namespace DirectX
         bool __cdecl IsStreamingBank() const noexcept;
         bool __cdecl IsAdvancedFormat() const noexcept;
 
+        void __cdecl SetStreamingReadAhead(unsigned int packetCount) noexcept;
+        unsigned int __cdecl GetStreamingReadAhead() const noexcept;
+        // Number of packets each SoundStreamInstance keeps in flight (2 - 16, default 3),
+        // applied to stream instances created afterwards
+
         size_t __cdecl GetSampleSizeInBytes(unsigned int index) const noexcept;
         // Returns size of wave audio data
 
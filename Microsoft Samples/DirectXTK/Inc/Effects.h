@@ -16,6 +16,7 @@
 #endif
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 
 #include <DirectXMath.h>
@@ -905,6 +906,33 @@ namespace DirectX
 
         void __cdecl SetDirectory(_In_opt_z_ const wchar_t* path) noexcept;
 
+        // Asynchronous texture loading. When enabled (and sharing is enabled), CreateEffect returns
+        // at once with placeholder textures, while the files are loaded on up to threadCount
+        // background threads (0 for a default). Requests for a file that is already loading are
+        // combined. Call UpdatePendingTextures from the thread that owns the device context passed
+        // to CreateEffect, typically once per frame, to swap the loaded textures into the effects;
+        // mipmaps for WIC textures are generated there. Like the caches, this setting is shared by
+        // all the EffectFactory instances for the same device. Classes derived from EffectFactory
+        // always load textures through their CreateTexture, and devices created with
+        // D3D11_CREATE_DEVICE_SINGLETHREADED always load synchronously.
+        struct AsyncTextureStatistics
+        {
+            size_t queued;              // Loads waiting for a thread
+            size_t loading;             // Loads in progress
+            size_t ready;               // Loads waiting for UpdatePendingTextures
+            size_t completed;           // Loads finished since async loading was first used
+            size_t failed;              // Loads that failed (the placeholder is kept)
+            size_t coalesced;           // Requests combined with a load already in flight
+            uint64_t totalLatencyUs;    // Sum of time from request to load completion
+            uint64_t maxLatencyUs;
+        };
+
+        void __cdecl EnableAsyncTextureLoading(bool enabled, unsigned int threadCount = 0) noexcept;
+
+        void __cdecl UpdatePendingTextures();
+
+        AsyncTextureStatistics __cdecl GetAsyncTextureStatistics() const;
+
         // Properties.
         ID3D11Device* GetDevice() const noexcept;
 
@@ -51,6 +51,7 @@ namespace DirectX
         ModelLoader_AllowLargeModels    = 0x8,
         ModelLoader_IncludeBones        = 0x10,
         ModelLoader_DisableSkinning     = 0x20,
+        ModelLoader_OptimizeMeshes      = 0x40,
     };
 
     //----------------------------------------------------------------------------------
@@ -269,6 +270,26 @@ namespace DirectX
             _In_reads_(nbones) const XMMATRIX* inBoneTransforms,
             _Out_writes_(nbones) XMMATRIX* outBoneTransforms) const;
 
+        // Compute absolute bone transforms and/or skinning matrices (invBindPoseMatrices * absolute)
+        // for many instances of the model. Each array holds nbones matrices per instance.
+        void __cdecl CopyAbsoluteBoneTransformsBatch(
+            size_t ninstances,
+            size_t nbones,
+            _In_reads_(ninstances * nbones) const XMMATRIX* inBoneTransforms,
+            _Out_writes_opt_(ninstances * nbones) XMMATRIX* outBoneTransforms,
+            _Out_writes_opt_(ninstances * nbones) XMMATRIX* outSkinTransforms) const;
+
+        // Same as CopyAbsoluteBoneTransformsBatch for the instances [firstInstance, firstInstance + ninstances)
+        // of the arrays, so a batch can be split across an application's own worker threads. Disjoint ranges
+        // can be computed concurrently.
+        void __cdecl CopyAbsoluteBoneTransformsRange(
+            size_t firstInstance,
+            size_t ninstances,
+            size_t nbones,
+            _In_reads_((firstInstance + ninstances) * nbones) const XMMATRIX* inBoneTransforms,
+            _Out_writes_opt_((firstInstance + ninstances) * nbones) XMMATRIX* outBoneTransforms,
+            _Out_writes_opt_((firstInstance + ninstances) * nbones) XMMATRIX* outSkinTransforms) const;
+
         // Set bone matrices to a set of relative tansforms
         void __cdecl CopyBoneTransformsFrom(
             size_t nbones,
@@ -279,8 +300,8 @@ namespace DirectX
             size_t nbones,
             _Out_writes_(nbones) XMMATRIX* boneTransforms) const;
 
-        // Notify model that effects, parts list, or mesh list has changed
-        void __cdecl Modified() noexcept { mEffectCache.clear(); }
+        // Notify model that effects, parts list, mesh list, or bone hierarchy has changed
+        void __cdecl Modified() noexcept { mEffectCache.clear(); mBoneHierarchy.reset(); }
 
         // Update all effects used by the model
         void __cdecl UpdateEffects(_In_ std::function<void __cdecl(IEffect*)> setEffect);
@@ -326,11 +347,14 @@ namespace DirectX
     private:
         std::set<IEffect*>  mEffectCache;
 
-        void __cdecl ComputeAbsolute(uint32_t index,
-            CXMMATRIX local, size_t nbones,
-            _In_reads_(nbones) const XMMATRIX* inBoneTransforms,
-            _Inout_updates_(nbones) XMMATRIX* outBoneTransforms,
-            size_t& visited) const;
+        // Bone indices in parent-before-child order, and the parent of each (c_Invalid for roots).
+        // Built at load time or by the first bone transform query after Modified, and never changed
+        // once built, so copies of the model share it. Accessed with std::atomic_load/atomic_store.
+        struct BoneHierarchy;
+        mutable std::shared_ptr<const BoneHierarchy> mBoneHierarchy;
+
+        void __cdecl FlattenBones();
+        std::shared_ptr<const BoneHierarchy> __cdecl GetBoneHierarchy() const;
     };
 
 #ifdef __clang__
@@ -59,6 +59,8 @@ namespace DirectX
         virtual ~SpriteBatch();
 
         // Begin/End a batch of sprite drawing operations.
+        // Unless using SpriteSortMode_Immediate, Draw may be called from multiple threads at once between
+        // Begin and End; End must not be called until all of those Draw calls have returned.
         void XM_CALLCONV Begin(SpriteSortMode sortMode = SpriteSortMode_Deferred,
             _In_opt_ ID3D11BlendState* blendState = nullptr,
             _In_opt_ ID3D11SamplerState* samplerState = nullptr,
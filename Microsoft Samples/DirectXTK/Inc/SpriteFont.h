@@ -67,6 +67,10 @@ namespace DirectX
 
         bool __cdecl ContainsCharacter(wchar_t character) const;
 
+        // Layout caching: keeps the glyph layout of up to maxStrings distinct strings, so text that is
+        // drawn or measured every frame is only laid out once. Disabled (0) by default.
+        void __cdecl SetLayoutCacheSize(size_t maxStrings);
+
         // Custom layout/rendering
         Glyph const* __cdecl FindGlyph(wchar_t character) const;
         void __cdecl GetSpriteSheet(ID3D11ShaderResourceView** texture) const;
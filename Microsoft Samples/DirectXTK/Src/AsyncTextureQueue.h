@@ -0,0 +1,349 @@
+//--------------------------------------------------------------------------------------
+// File: AsyncTextureQueue.h
+//
+// Platform-neutral queue of background texture loads used by EffectFactory
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace DirectX
+{
+    struct AsyncTextureQueueStatistics
+    {
+        size_t queued;              // Loads waiting for a thread
+        size_t loading;             // Loads in progress
+        size_t ready;               // Loads waiting for Update
+        size_t completed;           // Loads finished, including the failed ones
+        size_t failed;
+        size_t coalesced;           // Requests combined with a load already in flight
+        uint64_t totalLatencyUs;    // Sum of time from request to load completion
+        uint64_t maxLatencyUs;
+    };
+
+    //----------------------------------------------------------------------------------
+    // Loads texture files on a small pool of threads, started by the first request.
+    // Requests for a file that is already queued, loading or waiting for Update are
+    // combined into one load. Update hands the finished loads back on the calling thread:
+    // each texture goes through a finalize function, and then to the callbacks of all
+    // the requests for it. The callbacks of a failed load are never called, so the
+    // requesters keep whatever they used in the meantime.
+    //
+    // TTexture is a copyable handle that tests false when empty. TContext is passed from
+    // the requests to the finalize function; the first non-empty one for a file is kept.
+    // The loading itself is a callback, which keeps this class free of Direct3D. It gets
+    // the directory given with the request, so it doesn't read state another thread can
+    // change while the load is in progress.
+    //----------------------------------------------------------------------------------
+    template<typename TTexture, typename TContext>
+    class AsyncTextureQueue
+    {
+    public:
+        using Callback = std::function<void(const TTexture&)>;
+
+        // Runs on a loader thread, and returns an empty texture if the file can't be loaded.
+        using Loader = std::function<TTexture(const std::wstring& directory, const std::wstring& name, bool forceSRGB)>;
+
+        enum class RequestResult
+        {
+            Found,      // The find function returned the texture, nothing was queued
+            Queued,
+            Coalesced,
+            Stopped,    // Shutdown was called, nothing was queued
+        };
+
+        explicit AsyncTextureQueue(Loader loader) :
+            mLoader(std::move(loader)),
+            mThreadCount(0),
+            mShutdown(false),
+            mLoading(0),
+            mStats{}
+        {
+        }
+
+        AsyncTextureQueue(AsyncTextureQueue&&) = delete;
+        AsyncTextureQueue& operator= (AsyncTextureQueue&&) = delete;
+
+        AsyncTextureQueue(AsyncTextureQueue const&) = delete;
+        AsyncTextureQueue& operator= (AsyncTextureQueue const&) = delete;
+
+        ~AsyncTextureQueue()
+        {
+            Shutdown();
+        }
+
+        // Number of loader threads, 0 for a default. Only used when the threads are started.
+        void SetThreadCount(unsigned int threadCount)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mThreadCount = threadCount;
+        }
+
+        // Requests a texture file. find(), which returns true if the texture is already
+        // available, is called under the queue lock: a load finishing at the same time is
+        // then either found by it or still pending, so a file is never loaded twice.
+        template<typename TFind>
+        RequestResult Request(
+            const std::wstring& name,
+            const std::wstring& directory,
+            bool forceSRGB,
+            const TContext& context,
+            TFind&& find,
+            Callback callback)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (find())
+                return RequestResult::Found;
+
+            if (mShutdown)
+                return RequestResult::Stopped;
+
+            auto pending = mPending.find(name);
+            if (pending != mPending.end())
+            {
+                ++mStats.coalesced;
+
+                auto& request = *pending->second;
+                request.callbacks.emplace_back(std::move(callback));
+                if (!request.context)
+                {
+                    request.context = context;
+                }
+
+                return RequestResult::Coalesced;
+            }
+
+            auto request = std::make_shared<Request_>();
+            request->name = name;
+            request->directory = directory;
+            request->context = context;
+            request->callbacks.emplace_back(std::move(callback));
+            request->requestTime = Clock::now();
+            request->forceSRGB = forceSRGB;
+
+            mPending.emplace(name, request);
+            mQueue.emplace_back(std::move(request));
+
+            if (mWorkers.empty())
+            {
+                const unsigned int threadCount = mThreadCount
+                    ? mThreadCount
+                    : std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+
+                mWorkers.reserve(threadCount);
+                for (unsigned int j = 0; j < threadCount; ++j)
+                {
+                    mWorkers.emplace_back(&AsyncTextureQueue::LoaderThread, this);
+                }
+            }
+
+            mQueueSignal.notify_one();
+            return RequestResult::Queued;
+        }
+
+        // Waits for a pending file to finish loading. Returns false if the file is not
+        // pending, otherwise true with the loaded texture, which is empty if the load failed.
+        bool Wait(const std::wstring& name, TTexture& texture)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+
+            auto pending = mPending.find(name);
+            if (pending == mPending.end())
+                return false;
+
+            auto request = pending->second;
+            mDoneSignal.wait(lock, [&request] { return request->done; });
+
+            texture = request->texture;
+            return true;
+        }
+
+        // Calls finalize(name, texture, context) for each successful load that has finished,
+        // then the callbacks of all the requests for it. finalize may replace the texture and
+        // must not throw. Returns the number of finished loads, including the failed ones.
+        template<typename TFinalize>
+        size_t Update(TFinalize&& finalize)
+        {
+            std::vector<std::shared_ptr<Request_>> ready;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::swap(ready, mReady);
+            }
+
+            for (const auto& request : ready)
+            {
+                TTexture texture = request->texture;
+
+                if (texture)
+                {
+                    TContext context;
+                    {
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        context = request->context;
+                    }
+
+                    finalize(request->name, texture, context);
+                }
+
+                // Requests combined with this one until now are served below, later ones
+                // are up to find().
+                std::vector<Callback> callbacks;
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mPending.erase(request->name);
+                    std::swap(callbacks, request->callbacks);
+                }
+
+                if (texture)
+                {
+                    for (const auto& callback : callbacks)
+                    {
+                        callback(texture);
+                    }
+                }
+            }
+
+            return ready.size();
+        }
+
+        AsyncTextureQueueStatistics GetStatistics() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            auto stats = mStats;
+            stats.queued = mQueue.size();
+            stats.loading = mLoading;
+            stats.ready = mReady.size();
+            return stats;
+        }
+
+        // Stops the loader threads once their current loads are done. Queued loads are
+        // dropped, as failed ones.
+        void Shutdown()
+        {
+            std::vector<std::thread> workers;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mShutdown = true;
+                std::swap(workers, mWorkers);
+
+                for (auto& request : mQueue)
+                {
+                    request->done = true;
+                }
+                mQueue.clear();
+            }
+
+            mQueueSignal.notify_all();
+            mDoneSignal.notify_all();
+
+            for (auto& it : workers)
+            {
+                it.join();
+            }
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        // A file being loaded, along with the callbacks waiting for it.
+        struct Request_
+        {
+            std::wstring            name;
+            std::wstring            directory;
+            TTexture                texture;
+            TContext                context;
+            std::vector<Callback>   callbacks;
+            Clock::time_point       requestTime;
+            bool                    done;
+            bool                    forceSRGB;
+
+            Request_() noexcept : done(false), forceSRGB(false) {}
+        };
+
+        Loader                                  mLoader;
+        unsigned int                            mThreadCount;
+        bool                                    mShutdown;
+        size_t                                  mLoading;
+        std::map<std::wstring, std::shared_ptr<Request_>> mPending;
+        std::deque<std::shared_ptr<Request_>>   mQueue;
+        std::vector<std::shared_ptr<Request_>>  mReady;
+        std::vector<std::thread>                mWorkers;
+        AsyncTextureQueueStatistics             mStats;
+        mutable std::mutex                      mMutex;
+        std::condition_variable                 mQueueSignal;
+        std::condition_variable                 mDoneSignal;
+
+        void LoaderThread()
+        {
+            for (;;)
+            {
+                std::shared_ptr<Request_> request;
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mQueueSignal.wait(lock, [this] { return mShutdown || !mQueue.empty(); });
+
+                    if (mShutdown)
+                        break;
+
+                    request = std::move(mQueue.front());
+                    mQueue.pop_front();
+                    ++mLoading;
+                }
+
+                TTexture texture;
+                try
+                {
+                    texture = mLoader(request->directory, request->name, request->forceSRGB);
+                }
+                catch (...)
+                {
+                    texture = TTexture();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+
+                    const auto latency = static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - request->requestTime).count());
+
+                    --mLoading;
+                    ++mStats.completed;
+                    if (!texture)
+                    {
+                        ++mStats.failed;
+                    }
+                    mStats.totalLatencyUs += latency;
+                    mStats.maxLatencyUs = std::max(mStats.maxLatencyUs, latency);
+
+                    request->texture = std::move(texture);
+                    request->done = true;
+                    mReady.emplace_back(std::move(request));
+                }
+
+                mDoneSignal.notify_all();
+            }
+        }
+    };
+}
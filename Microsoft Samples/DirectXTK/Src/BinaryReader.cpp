@@ -104,3 +104,123 @@ HRESULT BinaryReader::ReadEntireFile(
 
     return S_OK;
 }
+
+
+//--------------------------------------------------------------------------------------
+// MappedFile
+//--------------------------------------------------------------------------------------
+
+#if (defined(_XBOX_ONE) && defined(_TITLE)) || (defined(WINAPI_FAMILY) && (WINAPI_FAMILY != WINAPI_FAMILY_DESKTOP_APP) && (_WIN32_WINNT < _WIN32_WINNT_WIN10))
+#define DIRECTX_NO_FILE_MAPPING
+#endif
+
+MappedFile::MappedFile() noexcept :
+    mData(nullptr),
+    mSize(0)
+{
+}
+
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+
+void MappedFile::Close() noexcept
+{
+#ifndef DIRECTX_NO_FILE_MAPPING
+    if (mData && !mOwnedData)
+    {
+        UnmapViewOfFile(mData);
+    }
+#endif
+
+    mOwnedData.reset();
+    mData = nullptr;
+    mSize = 0;
+}
+
+
+// Maps the whole file into memory for reading.
+HRESULT MappedFile::Open(_In_z_ wchar_t const* fileName)
+{
+    Close();
+
+    if (!fileName)
+        return E_INVALIDARG;
+
+#ifdef DIRECTX_NO_FILE_MAPPING
+    size_t dataSize = 0;
+    HRESULT hr = BinaryReader::ReadEntireFile(fileName, mOwnedData, &dataSize);
+    if (FAILED(hr))
+        return hr;
+
+    mData = mOwnedData.get();
+    mSize = dataSize;
+
+    return S_OK;
+#else
+    // Open the file.
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile(safe_handle(CreateFile2(
+        fileName,
+        GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING,
+        nullptr)));
+#else
+    ScopedHandle hFile(safe_handle(CreateFileW(
+        fileName,
+        GENERIC_READ, FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+        nullptr)));
+#endif
+
+    if (!hFile)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    // Get the file size.
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // File is too big for 32-bit allocation, so reject read.
+    if (fileInfo.EndOfFile.HighPart > 0)
+        return E_FAIL;
+
+    // Empty files cannot be mapped.
+    if (!fileInfo.EndOfFile.LowPart)
+        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+    // Map a read-only view of the whole file. The view stays valid after the handles are closed.
+#if !defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP)
+    ScopedHandle hMapping(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    if (!hMapping)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    const void* view = MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0);
+#else
+    ScopedHandle hMapping(CreateFileMappingFromApp(hFile.get(), nullptr, PAGE_READONLY, 0, nullptr));
+    if (!hMapping)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    const void* view = MapViewOfFileFromApp(hMapping.get(), FILE_MAP_READ, 0, 0);
+#endif
+
+    if (!view)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    mData = static_cast<uint8_t const*>(view);
+    mSize = fileInfo.EndOfFile.LowPart;
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) && (!defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP))
+    // Ask the memory manager to read the file in with large I/Os rather than one page fault at a time.
+    WIN32_MEMORY_RANGE_ENTRY range = { const_cast<void*>(view), mSize };
+    std::ignore = PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+
+    return S_OK;
+#endif
+}
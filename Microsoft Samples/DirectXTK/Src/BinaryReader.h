@@ -69,4 +69,31 @@ namespace DirectX
 
         std::unique_ptr<uint8_t[]> mOwnedData;
     };
+
+
+    // Helper for read-only access to a whole file through a memory mapped view, which avoids
+    // copying the file into a heap buffer. Falls back to reading the file into memory on
+    // platforms without file mapping.
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept;
+        ~MappedFile();
+
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator= (MappedFile const&) = delete;
+
+        HRESULT Open(_In_z_ wchar_t const* fileName);
+
+        uint8_t const* GetData() const noexcept { return mData; }
+        size_t GetSize() const noexcept { return mSize; }
+
+    private:
+        uint8_t const* mData;
+        size_t mSize;
+
+        std::unique_ptr<uint8_t[]> mOwnedData;
+
+        void Close() noexcept;
+    };
 }
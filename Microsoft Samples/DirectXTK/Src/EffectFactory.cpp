@@ -9,12 +9,17 @@
 
 #include "pch.h"
 #include "Effects.h"
+#include "DirectXHelpers.h"
 #include "DemandCreate.h"
 #include "SharedResourcePool.h"
+#include "AsyncTextureQueue.h"
 
 #include "DDSTextureLoader.h"
 #include "WICTextureLoader.h"
 
+#include <atomic>
+#include <typeinfo>
+
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
 
@@ -54,19 +59,50 @@ namespace
             effect->SetBiasedVertexNormals(true);
         }
     }
+
+    // Keeps COM initialized for the lifetime of a texture loader thread, as WIC needs it.
+    class ComInitializer
+    {
+    public:
+        ComInitializer() noexcept : hr(CoInitializeEx(nullptr, COINIT_MULTITHREADED)) {}
+
+        ComInitializer(ComInitializer&&) = delete;
+        ComInitializer& operator= (ComInitializer&&) = delete;
+
+        ComInitializer(ComInitializer const&) = delete;
+        ComInitializer& operator= (ComInitializer const&) = delete;
+
+        ~ComInitializer()
+        {
+            if (SUCCEEDED(hr))
+            {
+                CoUninitialize();
+            }
+        }
+
+    private:
+        HRESULT hr;
+    };
 }
 
 // Internal EffectFactory implementation class. Only one of these helpers is allocated
-// per D3D device, even if there are multiple public facing EffectFactory instances.
+// per D3D device, even if there are multiple public facing EffectFactory instances: they
+// all share its caches and settings, including asynchronous texture loading.
 class EffectFactory::Impl
 {
 public:
     explicit Impl(_In_ ID3D11Device* device)
-        : mPath{},
-        mDevice(device),
+        : mDevice(device),
+        mPath{},
         mSharing(true),
         mUseNormalMapEffect(true),
-        mForceSRGB(false)
+        mForceSRGB(false),
+        mFreeThreaded((device->GetCreationFlags() & D3D11_CREATE_DEVICE_SINGLETHREADED) == 0),
+        mAsync(false),
+        mAsyncQueue([this](const std::wstring& directory, const std::wstring& name, bool forceSRGB)
+            {
+                return LoadTextureAsync(directory, name, forceSRGB);
+            })
     {
         if (device->GetFeatureLevel() < D3D_FEATURE_LEVEL_10_0)
         {
@@ -74,6 +110,14 @@ public:
         }
     }
 
+    Impl(Impl&&) = delete;
+    Impl& operator= (Impl&&) = delete;
+
+    Impl(Impl const&) = delete;
+    Impl& operator= (Impl const&) = delete;
+
+    ~Impl();
+
     std::shared_ptr<IEffect> CreateEffect(_In_ IEffectFactory* factory, _In_ const IEffectFactory::EffectInfo& info, _In_opt_ ID3D11DeviceContext* deviceContext);
     void CreateTexture(_In_z_ const wchar_t* texture, _In_opt_ ID3D11DeviceContext* deviceContext, _Outptr_ ID3D11ShaderResourceView** textureView);
 
@@ -82,15 +126,32 @@ public:
     void EnableNormalMapEffect(bool enabled) noexcept { mUseNormalMapEffect = enabled; }
     void EnableForceSRGB(bool forceSRGB) noexcept { mForceSRGB = forceSRGB; }
 
-    static SharedResourcePool<ID3D11Device*, Impl> instancePool;
+    void SetDirectory(_In_opt_z_ const wchar_t* path) noexcept;
+    std::wstring GetDirectory();
 
-    wchar_t mPath[MAX_PATH];
+    void EnableAsyncTextureLoading(bool enabled, unsigned int threadCount) noexcept
+    {
+        if (threadCount)
+        {
+            mAsyncQueue.SetThreadCount(threadCount);
+        }
+        mAsync = enabled;
+    }
+
+    void UpdatePendingTextures();
+    EffectFactory::AsyncTextureStatistics GetAsyncTextureStatistics();
+
+    static SharedResourcePool<ID3D11Device*, Impl> instancePool;
 
     ComPtr<ID3D11Device> mDevice;
 
 private:
     using EffectCache = std::map< std::wstring, std::shared_ptr<IEffect> >;
     using TextureCache = std::map< std::wstring, ComPtr<ID3D11ShaderResourceView> >;
+    using TextureQueue = AsyncTextureQueue< ComPtr<ID3D11ShaderResourceView>, ComPtr<ID3D11DeviceContext> >;
+
+    // Guarded by mutex, as the directory is read for every texture load.
+    wchar_t mPath[MAX_PATH];
 
     EffectCache  mEffectCache;
     EffectCache  mEffectCacheSkinning;
@@ -104,6 +165,61 @@ private:
     bool mForceSRGB;
 
     std::mutex mutex;
+
+    // Placeholders are guarded by mutex.
+    ComPtr<ID3D11ShaderResourceView> mPlaceholder;
+    ComPtr<ID3D11ShaderResourceView> mPlaceholderNormalMap;
+
+    // Devices created with D3D11_CREATE_DEVICE_SINGLETHREADED always load synchronously.
+    const bool mFreeThreaded;
+
+    // Written by any of the EffectFactory instances sharing this Impl.
+    std::atomic<bool> mAsync;
+
+    // Declared last, so the loader threads stop before anything they use is destroyed.
+    TextureQueue mAsyncQueue;
+
+    void LoadTexture(_In_z_ const wchar_t* directory, _In_z_ const wchar_t* name, _In_opt_ ID3D11DeviceContext* deviceContext, bool forceSRGB, _Outptr_ ID3D11ShaderResourceView** textureView);
+    ComPtr<ID3D11ShaderResourceView> LoadTextureAsync(const std::wstring& directory, const std::wstring& name, bool forceSRGB);
+    void FinalizeTexture(const std::wstring& name, ComPtr<ID3D11ShaderResourceView>& texture, _In_opt_ ID3D11DeviceContext* deviceContext);
+
+    void RequestTexture(_In_z_ const wchar_t* name, _In_opt_ ID3D11DeviceContext* deviceContext, bool normalMap, TextureQueue::Callback callback, _Outptr_ ID3D11ShaderResourceView** textureView);
+    ID3D11ShaderResourceView* GetPlaceholder(bool normalMap);
+
+    // Sets a texture on an effect, asynchronously if enabled and the device is free-threaded.
+    // Factories derived from EffectFactory may override CreateTexture, so they always go through it.
+    template<typename TEffect, typename TSetter>
+    void SetEffectTexture(
+        _In_ IEffectFactory* factory,
+        _In_z_ const wchar_t* name,
+        _In_opt_ ID3D11DeviceContext* deviceContext,
+        const std::shared_ptr<TEffect>& effect,
+        TSetter setter,
+        bool normalMap = false)
+    {
+        ComPtr<ID3D11ShaderResourceView> srv;
+
+        if (mAsync && mSharing && mFreeThreaded && typeid(*factory) == typeid(EffectFactory))
+        {
+            std::weak_ptr<TEffect> weakEffect(effect);
+
+            RequestTexture(name, deviceContext, normalMap,
+                [weakEffect, setter](const ComPtr<ID3D11ShaderResourceView>& texture)
+                {
+                    if (auto target = weakEffect.lock())
+                    {
+                        setter(target.get(), texture.Get());
+                    }
+                },
+                srv.GetAddressOf());
+        }
+        else
+        {
+            factory->CreateTexture(name, deviceContext, srv.GetAddressOf());
+        }
+
+        setter(effect.get(), srv.Get());
+    }
 };
 
 
@@ -134,29 +250,20 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
             if (info.diffuseTexture && *info.diffuseTexture)
             {
-                ComPtr<ID3D11ShaderResourceView> srv;
-
-                factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
-
-                effect->SetTexture(srv.Get());
+                SetEffectTexture(factory, info.diffuseTexture, deviceContext, effect,
+                    [](auto* target, ID3D11ShaderResourceView* srv) { target->SetTexture(srv); });
             }
 
             if (info.specularTexture && *info.specularTexture)
             {
-                ComPtr<ID3D11ShaderResourceView> srv;
-
-                factory->CreateTexture(info.specularTexture, deviceContext, srv.GetAddressOf());
-
-                effect->SetSpecularTexture(srv.Get());
+                SetEffectTexture(factory, info.specularTexture, deviceContext, effect,
+                    [](auto* target, ID3D11ShaderResourceView* srv) { target->SetSpecularTexture(srv); });
             }
 
             if (info.normalTexture && *info.normalTexture)
             {
-                ComPtr<ID3D11ShaderResourceView> srv;
-
-                factory->CreateTexture(info.normalTexture, deviceContext, srv.GetAddressOf());
-
-                effect->SetNormalTexture(srv.Get());
+                SetEffectTexture(factory, info.normalTexture, deviceContext, effect,
+                    [](auto* target, ID3D11ShaderResourceView* srv) { target->SetNormalTexture(srv); }, true);
             }
 
             if (mSharing && info.name && *info.name)
@@ -186,11 +293,8 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
             if (info.diffuseTexture && *info.diffuseTexture)
             {
-                ComPtr<ID3D11ShaderResourceView> srv;
-
-                factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
-
-                effect->SetTexture(srv.Get());
+                SetEffectTexture(factory, info.diffuseTexture, deviceContext, effect,
+                    [](auto* target, ID3D11ShaderResourceView* srv) { target->SetTexture(srv); });
             }
 
             if (mSharing && info.name && *info.name)
@@ -231,29 +335,20 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (info.diffuseTexture && *info.diffuseTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture(srv.Get());
+            SetEffectTexture(factory, info.diffuseTexture, deviceContext, effect,
+                [](auto* target, ID3D11ShaderResourceView* srv) { target->SetTexture(srv); });
         }
 
         if (info.emissiveTexture && *info.emissiveTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.emissiveTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture2(srv.Get());
+            SetEffectTexture(factory, info.emissiveTexture, deviceContext, effect,
+                [](auto* target, ID3D11ShaderResourceView* srv) { target->SetTexture2(srv); });
         }
         else if (info.specularTexture && *info.specularTexture)
         {
             // If there's no emissive texture specified, use the specular texture as the second texture
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.specularTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture2(srv.Get());
+            SetEffectTexture(factory, info.specularTexture, deviceContext, effect,
+                [](auto* target, ID3D11ShaderResourceView* srv) { target->SetTexture2(srv); });
         }
 
         if (mSharing && info.name && *info.name)
@@ -288,29 +383,20 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (info.diffuseTexture && *info.diffuseTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture(srv.Get());
+            SetEffectTexture(factory, info.diffuseTexture, deviceContext, effect,
+                [](auto* target, ID3D11ShaderResourceView* srv) { target->SetTexture(srv); });
         }
 
         if (info.specularTexture && *info.specularTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.specularTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetSpecularTexture(srv.Get());
+            SetEffectTexture(factory, info.specularTexture, deviceContext, effect,
+                [](auto* target, ID3D11ShaderResourceView* srv) { target->SetSpecularTexture(srv); });
         }
 
         if (info.normalTexture && *info.normalTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.normalTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetNormalTexture(srv.Get());
+            SetEffectTexture(factory, info.normalTexture, deviceContext, effect,
+                [](auto* target, ID3D11ShaderResourceView* srv) { target->SetNormalTexture(srv); }, true);
         }
 
         if (mSharing && info.name && *info.name)
@@ -347,11 +433,8 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (info.diffuseTexture && *info.diffuseTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture(srv.Get());
+            SetEffectTexture(factory, info.diffuseTexture, deviceContext, effect,
+                [](auto* target, ID3D11ShaderResourceView* srv) { target->SetTexture(srv); });
             effect->SetTextureEnabled(true);
         }
 
@@ -372,90 +455,335 @@ void EffectFactory::Impl::CreateTexture(const wchar_t* name, ID3D11DeviceContext
     if (!name || !textureView)
         throw std::invalid_argument("name and textureView parameters can't be null");
 
+    // If the same file is being loaded in the background, wait for it rather than loading it twice.
+    if (mSharing)
+    {
+        ComPtr<ID3D11ShaderResourceView> loaded;
+        if (mAsyncQueue.Wait(name, loaded) && loaded)
+        {
+            FinalizeTexture(name, loaded, deviceContext);
+            *textureView = loaded.Detach();
+            return;
+        }
+    }
+
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = mTextureCache.find(name);
+        if (it != mTextureCache.end())
+        {
+            cached = true;
+
+            if (mSharing)
+            {
+                ID3D11ShaderResourceView* srv = it->second.Get();
+                srv->AddRef();
+                *textureView = srv;
+                return;
+            }
+        }
+    }
+
+    const std::wstring directory = GetDirectory();
+    LoadTexture(directory.c_str(), name, deviceContext, mForceSRGB, textureView);
+
+    if (mSharing && *name && !cached)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        TextureCache::value_type v(name, *textureView);
+        mTextureCache.insert(v);
+    }
+}
+
+// Loads a texture file, searching the given directory and then the current directory.
+_Use_decl_annotations_
+void EffectFactory::Impl::LoadTexture(const wchar_t* directory, const wchar_t* name, ID3D11DeviceContext* deviceContext, bool forceSRGB, ID3D11ShaderResourceView** textureView)
+{
 #if defined(_XBOX_ONE) && defined(_TITLE)
     UNREFERENCED_PARAMETER(deviceContext);
 #endif
 
-    auto it = mTextureCache.find(name);
+    wchar_t fullName[MAX_PATH] = {};
+    wcscpy_s(fullName, directory);
+    wcscat_s(fullName, name);
 
-    if (mSharing && it != mTextureCache.end())
-    {
-        ID3D11ShaderResourceView* srv = it->second.Get();
-        srv->AddRef();
-        *textureView = srv;
-    }
-    else
+    WIN32_FILE_ATTRIBUTE_DATA fileAttr = {};
+    if (!GetFileAttributesExW(fullName, GetFileExInfoStandard, &fileAttr))
     {
-        wchar_t fullName[MAX_PATH] = {};
-        wcscpy_s(fullName, mPath);
-        wcscat_s(fullName, name);
-
-        WIN32_FILE_ATTRIBUTE_DATA fileAttr = {};
+        // Try Current Working Directory (CWD)
+        wcscpy_s(fullName, name);
         if (!GetFileAttributesExW(fullName, GetFileExInfoStandard, &fileAttr))
         {
-            // Try Current Working Directory (CWD)
-            wcscpy_s(fullName, name);
-            if (!GetFileAttributesExW(fullName, GetFileExInfoStandard, &fileAttr))
-            {
-                DebugTrace("ERROR: EffectFactory could not find texture file '%ls'\n", name);
-                throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "EffectFactory::CreateTexture");
-            }
+            DebugTrace("ERROR: EffectFactory could not find texture file '%ls'\n", name);
+            throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "EffectFactory::CreateTexture");
         }
+    }
 
-        wchar_t ext[_MAX_EXT] = {};
-        _wsplitpath_s(name, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
-        const bool isdds = _wcsicmp(ext, L".dds") == 0;
+    wchar_t ext[_MAX_EXT] = {};
+    _wsplitpath_s(name, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+    const bool isdds = _wcsicmp(ext, L".dds") == 0;
 
-        if (isdds)
+    if (isdds)
+    {
+        HRESULT hr = CreateDDSTextureFromFileEx(
+            mDevice.Get(), fullName, 0,
+            D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+            forceSRGB, nullptr, textureView);
+        if (FAILED(hr))
         {
-            HRESULT hr = CreateDDSTextureFromFileEx(
-                mDevice.Get(), fullName, 0,
-                D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
-                mForceSRGB, nullptr, textureView);
-            if (FAILED(hr))
-            {
-                DebugTrace("ERROR: CreateDDSTextureFromFile failed (%08X) for '%ls'\n",
-                    static_cast<unsigned int>(hr), fullName);
-                throw std::runtime_error("EffectFactory::CreateDDSTextureFromFile");
-            }
+            DebugTrace("ERROR: CreateDDSTextureFromFile failed (%08X) for '%ls'\n",
+                static_cast<unsigned int>(hr), fullName);
+            throw std::runtime_error("EffectFactory::CreateDDSTextureFromFile");
         }
-    #if !defined(_XBOX_ONE) || !defined(_TITLE)
-        else if (deviceContext)
+    }
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    else if (deviceContext)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        HRESULT hr = CreateWICTextureFromFileEx(
+            mDevice.Get(), deviceContext, fullName, 0,
+            D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+            forceSRGB ? WIC_LOADER_FORCE_SRGB : WIC_LOADER_DEFAULT, nullptr, textureView);
+        if (FAILED(hr))
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            HRESULT hr = CreateWICTextureFromFileEx(
-                mDevice.Get(), deviceContext, fullName, 0,
-                D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
-                mForceSRGB ? WIC_LOADER_FORCE_SRGB : WIC_LOADER_DEFAULT, nullptr, textureView);
-            if (FAILED(hr))
-            {
-                DebugTrace("ERROR: CreateWICTextureFromFile failed (%08X) for '%ls'\n",
-                    static_cast<unsigned int>(hr), fullName);
-                throw std::runtime_error("EffectFactory::CreateWICTextureFromFile");
-            }
+            DebugTrace("ERROR: CreateWICTextureFromFile failed (%08X) for '%ls'\n",
+                static_cast<unsigned int>(hr), fullName);
+            throw std::runtime_error("EffectFactory::CreateWICTextureFromFile");
         }
-    #endif
-        else
+    }
+#endif
+    else
+    {
+        HRESULT hr = CreateWICTextureFromFileEx(
+            mDevice.Get(), fullName, 0,
+            D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+            forceSRGB ? WIC_LOADER_FORCE_SRGB : WIC_LOADER_DEFAULT, nullptr, textureView);
+        if (FAILED(hr))
         {
-            HRESULT hr = CreateWICTextureFromFileEx(
-                mDevice.Get(), fullName, 0,
-                D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
-                mForceSRGB ? WIC_LOADER_FORCE_SRGB : WIC_LOADER_DEFAULT, nullptr, textureView);
-            if (FAILED(hr))
+            DebugTrace("ERROR: CreateWICTextureFromFile failed (%08X) for '%ls'\n",
+                static_cast<unsigned int>(hr), fullName);
+            throw std::runtime_error("EffectFactory::CreateWICTextureFromFile");
+        }
+    }
+}
+
+EffectFactory::Impl::~Impl()
+{
+    mAsyncQueue.Shutdown();
+}
+
+// Loads a texture file on one of the loader threads. Texture creation on a Direct3D 11 device is
+// free-threaded, so the file read, header parsing and decode all happen there. Mipmaps need the
+// device context, so they are left to FinalizeTexture.
+ComPtr<ID3D11ShaderResourceView> EffectFactory::Impl::LoadTextureAsync(const std::wstring& directory, const std::wstring& name, bool forceSRGB)
+{
+    thread_local ComInitializer com;
+
+    ComPtr<ID3D11ShaderResourceView> texture;
+    try
+    {
+        LoadTexture(directory.c_str(), name.c_str(), nullptr, forceSRGB, texture.GetAddressOf());
+    }
+    catch (const std::exception& e)
+    {
+        DebugTrace("ERROR: EffectFactory failed to load texture '%ls' in the background (%s)\n", name.c_str(), e.what());
+        texture.Reset();
+    }
+
+    return texture;
+}
+
+// Adds a texture loaded in the background to the cache, on the thread that owns deviceContext.
+// If the file was cached in the meantime, texture is replaced with the cached one. Otherwise WIC
+// textures get the mipmaps a synchronous load would have generated.
+_Use_decl_annotations_
+void EffectFactory::Impl::FinalizeTexture(const std::wstring& name, ComPtr<ID3D11ShaderResourceView>& texture, ID3D11DeviceContext* deviceContext)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = mTextureCache.find(name);
+    if (it != mTextureCache.end())
+    {
+        texture = it->second;
+        return;
+    }
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    UNREFERENCED_PARAMETER(deviceContext);
+#else
+    wchar_t ext[_MAX_EXT] = {};
+    _wsplitpath_s(name.c_str(), nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+
+    if (deviceContext && _wcsicmp(ext, L".dds") != 0)
+    {
+        ComPtr<ID3D11Resource> res;
+        texture->GetResource(res.GetAddressOf());
+
+        ComPtr<ID3D11Texture2D> tex;
+        D3D11_TEXTURE2D_DESC desc = {};
+        if (SUCCEEDED(res.As(&tex)))
+        {
+            tex->GetDesc(&desc);
+        }
+
+        UINT fmtSupport = 0;
+        if (desc.MipLevels == 1
+            && SUCCEEDED(mDevice->CheckFormatSupport(desc.Format, &fmtSupport))
+            && (fmtSupport & D3D11_FORMAT_SUPPORT_MIP_AUTOGEN))
+        {
+            desc.MipLevels = 0;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+            desc.CPUAccessFlags = 0;
+            desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+            ComPtr<ID3D11Texture2D> mipTex;
+            ComPtr<ID3D11ShaderResourceView> mipView;
+            if (SUCCEEDED(mDevice->CreateTexture2D(&desc, nullptr, mipTex.GetAddressOf()))
+                && SUCCEEDED(mDevice->CreateShaderResourceView(mipTex.Get(), nullptr, mipView.GetAddressOf())))
             {
-                DebugTrace("ERROR: CreateWICTextureFromFile failed (%08X) for '%ls'\n",
-                    static_cast<unsigned int>(hr), fullName);
-                throw std::runtime_error("EffectFactory::CreateWICTextureFromFile");
+                deviceContext->CopySubresourceRegion(mipTex.Get(), 0, 0, 0, 0, tex.Get(), 0, nullptr);
+                deviceContext->GenerateMips(mipView.Get());
+
+                SetDebugObjectName(mipTex.Get(), "EffectFactory");
+                texture = mipView;
             }
         }
+    }
+#endif
+
+    TextureCache::value_type v(name, texture);
+    mTextureCache.insert(v);
+}
 
-        if (mSharing && *name && it == mTextureCache.end())
+// Returns a texture for an effect right away, loading it in the background if it is not already cached.
+_Use_decl_annotations_
+void EffectFactory::Impl::RequestTexture(const wchar_t* name, ID3D11DeviceContext* deviceContext, bool normalMap, TextureQueue::Callback callback, ID3D11ShaderResourceView** textureView)
+{
+    if (!name || !textureView)
+        throw std::invalid_argument("name and textureView parameters can't be null");
+
+    // The directory is copied now, so SetDirectory can't change it under a loader thread.
+    const std::wstring directory = GetDirectory();
+
+    auto result = mAsyncQueue.Request(name, directory, mForceSRGB, deviceContext,
+        [&]()
         {
             std::lock_guard<std::mutex> lock(mutex);
-            TextureCache::value_type v(name, *textureView);
-            mTextureCache.insert(v);
+
+            auto it = mTextureCache.find(name);
+            if (it == mTextureCache.end())
+                return false;
+
+            ID3D11ShaderResourceView* srv = it->second.Get();
+            srv->AddRef();
+            *textureView = srv;
+            return true;
+        },
+        std::move(callback));
+
+    if (result == TextureQueue::RequestResult::Found)
+        return;
+
+    if (result == TextureQueue::RequestResult::Stopped)
+    {
+        // The loader threads are shutting down, so there is nothing to swap the placeholder out.
+        CreateTexture(name, deviceContext, textureView);
+        return;
+    }
+
+    ID3D11ShaderResourceView* srv = GetPlaceholder(normalMap);
+    srv->AddRef();
+    *textureView = srv;
+}
+
+// Returns a 1x1 texture to use until a texture has loaded: white, or a flat normal for normal maps.
+ID3D11ShaderResourceView* EffectFactory::Impl::GetPlaceholder(bool normalMap)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& placeholder = normalMap ? mPlaceholderNormalMap : mPlaceholder;
+
+    if (!placeholder)
+    {
+        const uint32_t pixel = normalMap ? 0xFFFF8080 : 0xFFFFFFFF;
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = desc.Height = desc.MipLevels = desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        const D3D11_SUBRESOURCE_DATA initData = { &pixel, sizeof(uint32_t), 0 };
+
+        ComPtr<ID3D11Texture2D> tex;
+        ThrowIfFailed(mDevice->CreateTexture2D(&desc, &initData, tex.GetAddressOf()));
+
+        ThrowIfFailed(mDevice->CreateShaderResourceView(tex.Get(), nullptr, placeholder.ReleaseAndGetAddressOf()));
+
+        SetDebugObjectName(placeholder.Get(), "EffectFactory placeholder");
+    }
+
+    return placeholder.Get();
+}
+
+// Swaps loaded textures into the effects that were given placeholders. Mipmaps are generated
+// here, with the device context passed when the texture was requested.
+void EffectFactory::Impl::UpdatePendingTextures()
+{
+    mAsyncQueue.Update(
+        [this](const std::wstring& name, ComPtr<ID3D11ShaderResourceView>& texture, const ComPtr<ID3D11DeviceContext>& deviceContext)
+        {
+            FinalizeTexture(name, texture, deviceContext.Get());
+        });
+}
+
+EffectFactory::AsyncTextureStatistics EffectFactory::Impl::GetAsyncTextureStatistics()
+{
+    const auto queueStats = mAsyncQueue.GetStatistics();
+
+    EffectFactory::AsyncTextureStatistics stats = {};
+    stats.queued = queueStats.queued;
+    stats.loading = queueStats.loading;
+    stats.ready = queueStats.ready;
+    stats.completed = queueStats.completed;
+    stats.failed = queueStats.failed;
+    stats.coalesced = queueStats.coalesced;
+    stats.totalLatencyUs = queueStats.totalLatencyUs;
+    stats.maxLatencyUs = queueStats.maxLatencyUs;
+    return stats;
+}
+
+_Use_decl_annotations_
+void EffectFactory::Impl::SetDirectory(const wchar_t* path) noexcept
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (path && *path != 0)
+    {
+        wcscpy_s(mPath, path);
+        size_t len = wcsnlen(mPath, MAX_PATH);
+        if (len > 0 && len < (MAX_PATH - 1))
+        {
+            // Ensure it has a trailing slash
+            if (mPath[len - 1] != L'\\')
+            {
+                mPath[len] = L'\\';
+                mPath[len + 1] = 0;
+            }
         }
     }
+    else
+        *mPath = 0;
+}
+
+std::wstring EffectFactory::Impl::GetDirectory()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::wstring(mPath);
 }
 
 void EffectFactory::Impl::ReleaseCache()
@@ -518,24 +846,24 @@ void EffectFactory::EnableForceSRGB(bool forceSRGB) noexcept
     pImpl->EnableForceSRGB(forceSRGB);
 }
 
+void EffectFactory::EnableAsyncTextureLoading(bool enabled, unsigned int threadCount) noexcept
+{
+    pImpl->EnableAsyncTextureLoading(enabled, threadCount);
+}
+
+void EffectFactory::UpdatePendingTextures()
+{
+    pImpl->UpdatePendingTextures();
+}
+
+EffectFactory::AsyncTextureStatistics EffectFactory::GetAsyncTextureStatistics() const
+{
+    return pImpl->GetAsyncTextureStatistics();
+}
+
 void EffectFactory::SetDirectory(_In_opt_z_ const wchar_t* path) noexcept
 {
-    if (path && *path != 0)
-    {
-        wcscpy_s(pImpl->mPath, path);
-        size_t len = wcsnlen(pImpl->mPath, MAX_PATH);
-        if (len > 0 && len < (MAX_PATH - 1))
-        {
-            // Ensure it has a trailing slash
-            if (pImpl->mPath[len - 1] != L'\\')
-            {
-                pImpl->mPath[len] = L'\\';
-                pImpl->mPath[len + 1] = 0;
-            }
-        }
-    }
-    else
-        *pImpl->mPath = 0;
+    pImpl->SetDirectory(path);
 }
 
 ID3D11Device* EffectFactory::GetDevice() const noexcept
@@ -14,11 +14,41 @@
 #include "DirectXHelpers.h"
 #include "Effects.h"
 #include "Geometry.h"
+#include "MeshOptimizer.h"
 #include "SharedResourcePool.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
 
+namespace
+{
+    // Reorders generated shapes for the post-transform vertex cache, overdraw and vertex fetch.
+    void OptimizeMesh(VertexCollection& vertices, IndexCollection& indices)
+    {
+    #ifdef _DEBUG
+        const auto before = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+    #endif
+
+        std::vector<size_t> clusters;
+        MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertices.size(),
+            MeshOptimizer::DefaultCacheSize, &clusters);
+
+        MeshOptimizer::OptimizeOverdraw(indices.data(), indices.size(),
+            &vertices.data()->position, sizeof(VertexPositionNormalTexture), vertices.size(), clusters);
+
+        std::vector<uint32_t> remap;
+        MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertices.size(), remap);
+        MeshOptimizer::RemapVertices(vertices, remap);
+
+    #ifdef _DEBUG
+        const auto after = MeshOptimizer::ComputeCacheStatistics(indices.data(), indices.size(), vertices.size());
+
+        DebugTrace("INFO: GeometricPrimitive optimized %zu triangles (ACMR %.3f -> %.3f, ATVR %.3f -> %.3f)\n",
+            indices.size() / 3, before.acmr, after.acmr, before.atvr, after.atvr);
+    #endif
+    }
+}
+
 
 // Internal GeometricPrimitive implementation class.
 class GeometricPrimitive::Impl
@@ -26,7 +56,7 @@ class GeometricPrimitive::Impl
 public:
     Impl() noexcept : mIndexCount(0) {}
 
-    void Initialize(_In_ ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices);
+    void Initialize(_In_ ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices, bool optimize = true);
 
     void XM_CALLCONV Draw(FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
         FXMVECTOR color,
@@ -152,7 +182,7 @@ void GeometricPrimitive::Impl::SharedResources::PrepareForRendering(bool alpha,
 
 // Initializes a geometric primitive instance that will draw the specified vertex and index data.
 _Use_decl_annotations_
-void GeometricPrimitive::Impl::Initialize(ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices)
+void GeometricPrimitive::Impl::Initialize(ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices, bool optimize)
 {
     if (vertices.size() >= USHRT_MAX)
         throw std::out_of_range("Too many vertices for 16-bit index buffer");
@@ -165,12 +195,21 @@ void GeometricPrimitive::Impl::Initialize(ID3D11DeviceContext* deviceContext, co
     ComPtr<ID3D11Device> device;
     deviceContext->GetDevice(&device);
 
+    VertexCollection optimizedVertices;
+    IndexCollection optimizedIndices;
+    if (optimize)
+    {
+        optimizedVertices = vertices;
+        optimizedIndices = indices;
+        OptimizeMesh(optimizedVertices, optimizedIndices);
+    }
+
     ThrowIfFailed(
-        CreateStaticBuffer(device.Get(), vertices, D3D11_BIND_VERTEX_BUFFER, mVertexBuffer.ReleaseAndGetAddressOf())
+        CreateStaticBuffer(device.Get(), optimize ? optimizedVertices : vertices, D3D11_BIND_VERTEX_BUFFER, mVertexBuffer.ReleaseAndGetAddressOf())
     );
 
     ThrowIfFailed(
-        CreateStaticBuffer(device.Get(), indices, D3D11_BIND_INDEX_BUFFER, mIndexBuffer.ReleaseAndGetAddressOf())
+        CreateStaticBuffer(device.Get(), optimize ? optimizedIndices : indices, D3D11_BIND_INDEX_BUFFER, mIndexBuffer.ReleaseAndGetAddressOf())
     );
 
     SetDebugObjectName(mVertexBuffer.Get(), "DirectXTK:GeometricPrimitive");
@@ -836,7 +875,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateCustom(
     // Create the primitive object.
     std::unique_ptr<GeometricPrimitive> primitive(new GeometricPrimitive());
 
-    primitive->pImpl->Initialize(deviceContext, vertices, indices);
+    primitive->pImpl->Initialize(deviceContext, vertices, indices, false);
 
     return primitive;
 }
@@ -12,6 +12,8 @@
 #include "Geometry.h"
 #include "Bezier.h"
 
+#include <unordered_map>
+
 using namespace DirectX;
 
 namespace
@@ -235,10 +237,19 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
         return std::make_pair(std::max(a, b), std::min(a, b));
     };
 
+    // Both 16-bit indices of an edge fit in one hash value, so there are no collisions.
+    struct UndirectedEdgeHash
+    {
+        size_t operator()(const UndirectedEdge& edge) const noexcept
+        {
+            return std::hash<uint32_t>()((uint32_t(edge.first) << 16) | edge.second);
+        }
+    };
+
     // Key: an edge
     // Value: the index of the vertex which lies midway between the two vertices pointed to by the key value
     // This map is used to avoid duplicating vertices when subdividing triangles along edges.
-    using EdgeSubdivisionMap = std::map<UndirectedEdge, uint16_t>;
+    using EdgeSubdivisionMap = std::unordered_map<UndirectedEdge, uint16_t, UndirectedEdgeHash>;
 
 
     static const XMFLOAT3 OctahedronVertices[] =
@@ -282,7 +293,9 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
         assert(indices.size() % 3 == 0); // sanity
 
         // We use this to keep track of which edges have already been subdivided.
+        // Each triangle adds three edges, of which about half are shared.
         EdgeSubdivisionMap subdividedEdges;
+        subdividedEdges.reserve(indices.size() / 2 + 1);
 
         // The new index collection after subdivision.
         IndexCollection newIndices;
@@ -0,0 +1,499 @@
+//--------------------------------------------------------------------------------------
+// File: MeshOptimizer.h
+//
+// Platform-neutral triangle and vertex reordering used by GeometricPrimitive and the
+// Model loaders
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace MeshOptimizer
+    {
+        // Post-transform vertex cache size assumed when reordering and measuring.
+        constexpr size_t DefaultCacheSize = 16;
+
+        // Triangles may be split into smaller clusters for overdraw sorting as long as the cache
+        // miss ratio of a cluster stays within this factor of the miss ratio of the whole mesh.
+        constexpr float DefaultOverdrawThreshold = 1.05f;
+
+
+        //--------------------------------------------------------------------------------------
+        // Vertex cache efficiency of an indexed triangle list, simulating a FIFO cache.
+        //
+        // ACMR (average cache miss ratio) is the number of vertices transformed per triangle,
+        // between 0.5 and 3. ATVR (average transform to vertex ratio) is the number of vertices
+        // transformed per vertex referenced, where 1 is ideal.
+        //--------------------------------------------------------------------------------------
+        struct CacheStatistics
+        {
+            float acmr;
+            float atvr;
+        };
+
+        template<typename TIndex>
+        CacheStatistics ComputeCacheStatistics(
+            _In_reads_(indexCount) const TIndex* indices,
+            size_t indexCount,
+            size_t vertexCount,
+            size_t cacheSize = DefaultCacheSize)
+        {
+            CacheStatistics result = {};
+
+            if (indexCount < 3 || !vertexCount)
+                return result;
+
+            // A vertex is in the FIFO if it was loaded within the last cacheSize misses.
+            std::vector<size_t> loadTime(vertexCount, 0);
+            std::vector<bool> referenced(vertexCount, false);
+            size_t misses = 0;
+            size_t unique = 0;
+
+            for (size_t j = 0; j < indexCount; ++j)
+            {
+                const size_t v = indices[j];
+                if (v >= vertexCount)
+                    continue;
+
+                if (!referenced[v])
+                {
+                    referenced[v] = true;
+                    ++unique;
+                }
+
+                if (!loadTime[v] || misses + 1 - loadTime[v] > cacheSize)
+                {
+                    ++misses;
+                    loadTime[v] = misses;
+                }
+            }
+
+            result.acmr = float(misses) / float(indexCount / 3);
+            result.atvr = unique ? float(misses) / float(unique) : 0.f;
+
+            return result;
+        }
+
+
+        //--------------------------------------------------------------------------------------
+        // Reorders triangles for the post-transform vertex cache ("Tipsify", from Sander, Nehab
+        // and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+        //
+        // Runs in linear time. If clusters is given, it receives the first triangle of each run
+        // of triangles that starts after the algorithm jumped to an unconnected part of the mesh,
+        // which are the natural boundaries for OptimizeOverdraw.
+        //--------------------------------------------------------------------------------------
+        template<typename TIndex>
+        void OptimizeVertexCache(
+            _Inout_updates_(indexCount) TIndex* indices,
+            size_t indexCount,
+            size_t vertexCount,
+            size_t cacheSize = DefaultCacheSize,
+            _Out_opt_ std::vector<size_t>* clusters = nullptr)
+        {
+            if (clusters)
+            {
+                clusters->clear();
+            }
+
+            const size_t triangleCount = indexCount / 3;
+            if (!triangleCount || !vertexCount)
+                return;
+
+            for (size_t j = 0; j < triangleCount * 3; ++j)
+            {
+                if (indices[j] >= vertexCount)
+                    return;
+            }
+
+            // Vertex to triangle adjacency, in compressed rows.
+            std::vector<uint32_t> live(vertexCount, 0);
+            for (size_t j = 0; j < triangleCount * 3; ++j)
+            {
+                ++live[indices[j]];
+            }
+
+            std::vector<uint32_t> offsets(vertexCount + 1, 0);
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                offsets[v + 1] = offsets[v] + live[v];
+            }
+
+            std::vector<uint32_t> adjacency(triangleCount * 3);
+            {
+                std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+                for (size_t t = 0; t < triangleCount; ++t)
+                {
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+                    }
+                }
+            }
+
+            std::vector<size_t> cacheTime(vertexCount, 0);
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> deadEnd;
+            std::vector<uint32_t> candidates;
+            std::vector<TIndex> output;
+            output.reserve(triangleCount * 3);
+
+            deadEnd.reserve(triangleCount * 3);
+            candidates.reserve(64);
+
+            size_t timestamp = cacheSize + 1;
+            size_t cursor = 0;
+
+            // Finds a vertex with triangles left after a dead end: most recently used first,
+            // then in input order.
+            auto skipDeadEnd = [&]() -> size_t
+            {
+                while (!deadEnd.empty())
+                {
+                    const uint32_t d = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (live[d] > 0)
+                        return d;
+                }
+
+                for (; cursor < vertexCount; ++cursor)
+                {
+                    if (live[cursor] > 0)
+                        return cursor;
+                }
+
+                return SIZE_MAX;
+            };
+
+            size_t fan = skipDeadEnd();
+
+            while (fan != SIZE_MAX)
+            {
+                candidates.clear();
+
+                // Emit every remaining triangle around the fanning vertex.
+                for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; ++a)
+                {
+                    const uint32_t t = adjacency[a];
+                    if (emitted[t])
+                        continue;
+
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        const TIndex v = indices[t * 3 + k];
+
+                        output.push_back(v);
+                        deadEnd.push_back(v);
+                        candidates.push_back(v);
+                        --live[v];
+
+                        if (timestamp - cacheTime[v] > cacheSize)
+                        {
+                            cacheTime[v] = timestamp++;
+                        }
+                    }
+
+                    emitted[t] = true;
+                }
+
+                // Pick the next fanning vertex among those just used, preferring the one that
+                // will still be in the cache after its remaining triangles are emitted.
+                size_t next = SIZE_MAX;
+                size_t bestPriority = 0;
+
+                for (const uint32_t v : candidates)
+                {
+                    if (!live[v])
+                        continue;
+
+                    size_t priority = 1;
+                    const size_t age = timestamp - cacheTime[v];
+                    if (age + 2 * live[v] <= cacheSize)
+                    {
+                        priority += age;
+                    }
+
+                    if (priority > bestPriority)
+                    {
+                        bestPriority = priority;
+                        next = v;
+                    }
+                }
+
+                if (next == SIZE_MAX)
+                {
+                    next = skipDeadEnd();
+
+                    if (clusters && next != SIZE_MAX)
+                    {
+                        clusters->push_back(output.size() / 3);
+                    }
+                }
+
+                fan = next;
+            }
+
+            if (clusters && (clusters->empty() || clusters->front() != 0))
+            {
+                clusters->insert(clusters->begin(), 0);
+            }
+
+            std::copy(output.begin(), output.end(), indices);
+        }
+
+
+        //--------------------------------------------------------------------------------------
+        // Reorders clusters of triangles (as produced by OptimizeVertexCache) so that those
+        // facing away from the center of the mesh, which are the most likely to occlude the
+        // others, are drawn first. Clusters are first split further where this costs little
+        // in vertex cache efficiency, controlled by threshold.
+        //
+        // positions points to the first vertex position (three floats), positionStride is the
+        // distance in bytes between vertices.
+        //--------------------------------------------------------------------------------------
+        template<typename TIndex>
+        void OptimizeOverdraw(
+            _Inout_updates_(indexCount) TIndex* indices,
+            size_t indexCount,
+            _In_ const void* positions,
+            size_t positionStride,
+            size_t vertexCount,
+            const std::vector<size_t>& clusters,
+            float threshold = DefaultOverdrawThreshold,
+            size_t cacheSize = DefaultCacheSize)
+        {
+            const size_t triangleCount = indexCount / 3;
+            if (triangleCount < 2 || clusters.empty() || !positions || !vertexCount)
+                return;
+
+            for (size_t j = 0; j < triangleCount * 3; ++j)
+            {
+                if (indices[j] >= vertexCount)
+                    return;
+            }
+
+            auto position = [&](size_t v, float out[3]) noexcept
+            {
+                memcpy(out, static_cast<const uint8_t*>(positions) + v * positionStride, sizeof(float) * 3);
+            };
+
+            // Split clusters where the cache miss ratio of the part so far is good enough.
+            const float limit = ComputeCacheStatistics(indices, triangleCount * 3, vertexCount, cacheSize).acmr * threshold;
+
+            std::vector<size_t> starts;
+            {
+                std::vector<size_t> loadTime(vertexCount, 0);
+                size_t misses = 0;
+                size_t clusterMisses = 0;
+                size_t clusterStart = 0;
+                size_t nextHard = 0;
+
+                for (size_t t = 0; t < triangleCount; ++t)
+                {
+                    const bool hard = (nextHard < clusters.size() && clusters[nextHard] == t);
+                    if (hard)
+                    {
+                        ++nextHard;
+                    }
+
+                    const size_t clusterTriangles = t - clusterStart;
+                    if (hard || (clusterTriangles > 0 && float(clusterMisses) <= limit * float(clusterTriangles)))
+                    {
+                        starts.push_back(t);
+                        clusterStart = t;
+                        clusterMisses = 0;
+
+                        // The new cluster may be drawn after any other, so start it with a cold cache.
+                        misses += cacheSize;
+                    }
+
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        const size_t v = indices[t * 3 + k];
+                        if (!loadTime[v] || misses + 1 - loadTime[v] > cacheSize)
+                        {
+                            ++misses;
+                            ++clusterMisses;
+                            loadTime[v] = misses;
+                        }
+                    }
+                }
+            }
+
+            if (starts.size() < 2)
+                return;
+
+            struct Cluster
+            {
+                size_t start;
+                size_t end;
+                float centroid[3];
+                float normal[3];
+                float sortKey;
+            };
+
+            // Area-weighted centroid and summed normal of each cluster, and the mesh centroid.
+            std::vector<Cluster> sorted(starts.size());
+            float meshCentroid[3] = {};
+            float meshArea = 0.f;
+
+            for (size_t c = 0; c < starts.size(); ++c)
+            {
+                auto& cluster = sorted[c];
+                cluster.start = starts[c];
+                cluster.end = (c + 1 < starts.size()) ? starts[c + 1] : triangleCount;
+                cluster.sortKey = 0.f;
+
+                float area = 0.f;
+                memset(cluster.centroid, 0, sizeof(cluster.centroid));
+                memset(cluster.normal, 0, sizeof(cluster.normal));
+
+                for (size_t t = cluster.start; t < cluster.end; ++t)
+                {
+                    float p0[3], p1[3], p2[3];
+                    position(indices[t * 3], p0);
+                    position(indices[t * 3 + 1], p1);
+                    position(indices[t * 3 + 2], p2);
+
+                    const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                    const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                    const float n[3] =
+                    {
+                        e1[1] * e2[2] - e1[2] * e2[1],
+                        e1[2] * e2[0] - e1[0] * e2[2],
+                        e1[0] * e2[1] - e1[1] * e2[0],
+                    };
+                    const float twiceArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        cluster.centroid[k] += (p0[k] + p1[k] + p2[k]) * twiceArea;
+                        cluster.normal[k] += n[k];
+                    }
+
+                    area += twiceArea;
+                }
+
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    meshCentroid[k] += cluster.centroid[k];
+                }
+                meshArea += area;
+
+                if (area > 0.f)
+                {
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        cluster.centroid[k] /= area * 3.f;
+                    }
+                }
+            }
+
+            if (meshArea <= 0.f)
+                return;
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                meshCentroid[k] /= meshArea * 3.f;
+            }
+
+            for (auto& cluster : sorted)
+            {
+                const float length = std::sqrt(cluster.normal[0] * cluster.normal[0]
+                    + cluster.normal[1] * cluster.normal[1]
+                    + cluster.normal[2] * cluster.normal[2]);
+
+                if (length > 0.f)
+                {
+                    cluster.sortKey = ((cluster.centroid[0] - meshCentroid[0]) * cluster.normal[0]
+                        + (cluster.centroid[1] - meshCentroid[1]) * cluster.normal[1]
+                        + (cluster.centroid[2] - meshCentroid[2]) * cluster.normal[2]) / length;
+                }
+            }
+
+            std::stable_sort(sorted.begin(), sorted.end(),
+                [](const Cluster& a, const Cluster& b) noexcept { return a.sortKey > b.sortKey; });
+
+            std::vector<TIndex> output;
+            output.reserve(triangleCount * 3);
+
+            for (const auto& cluster : sorted)
+            {
+                output.insert(output.end(), indices + cluster.start * 3, indices + cluster.end * 3);
+            }
+
+            std::copy(output.begin(), output.end(), indices);
+        }
+
+
+        //--------------------------------------------------------------------------------------
+        // Renumbers vertices in the order the index buffer first uses them, so vertex fetch
+        // reads memory sequentially. Fills remap with the new index of each old vertex (unused
+        // vertices are moved to the end) and rewrites the indices.
+        //--------------------------------------------------------------------------------------
+        template<typename TIndex>
+        void OptimizeVertexFetch(
+            _Inout_updates_(indexCount) TIndex* indices,
+            size_t indexCount,
+            size_t vertexCount,
+            std::vector<uint32_t>& remap)
+        {
+            constexpr uint32_t Unused = UINT32_MAX;
+
+            remap.assign(vertexCount, Unused);
+
+            uint32_t next = 0;
+            for (size_t j = 0; j < indexCount; ++j)
+            {
+                const size_t v = indices[j];
+                if (v >= vertexCount)
+                    continue;
+
+                if (remap[v] == Unused)
+                {
+                    remap[v] = next++;
+                }
+
+                indices[j] = static_cast<TIndex>(remap[v]);
+            }
+
+            for (auto& it : remap)
+            {
+                if (it == Unused)
+                {
+                    it = next++;
+                }
+            }
+        }
+
+        // Moves vertices to the positions given by OptimizeVertexFetch.
+        template<typename TVertex>
+        void RemapVertices(std::vector<TVertex>& vertices, const std::vector<uint32_t>& remap)
+        {
+            if (remap.size() != vertices.size())
+                return;
+
+            std::vector<TVertex> output(vertices.size());
+            for (size_t v = 0; v < vertices.size(); ++v)
+            {
+                output[remap[v]] = vertices[v];
+            }
+
+            vertices.swap(output);
+        }
+    }
+}
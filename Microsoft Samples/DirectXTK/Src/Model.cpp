@@ -12,8 +12,11 @@
 #include "CommonStates.h"
 #include "DirectXHelpers.h"
 #include "Effects.h"
+#include "ModelBonesCore.h"
 #include "PlatformHelpers.h"
 
+#include <atomic>
+
 using namespace DirectX;
 
 #if !defined(_CPPRTTI) && !defined(__GXX_RTTI)
@@ -408,6 +411,33 @@ void XM_CALLCONV ModelMesh::DrawSkinned(
 // Model
 //--------------------------------------------------------------------------------------
 
+struct Model::BoneHierarchy
+{
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> parents;
+};
+
+namespace
+{
+    static_assert(ModelBone::c_Invalid == ModelBonesCore::InvalidIndex, "ModelBonesCore must use the same invalid index as ModelBone");
+
+    // Absolute transforms of one instance for skinning-only requests, kept per thread so repeated
+    // calls don't allocate.
+    XMMATRIX* GetScratchTransforms(size_t nbones)
+    {
+        thread_local ModelBone::TransformArray s_scratch;
+        thread_local size_t s_scratchCount = 0;
+
+        if (s_scratchCount < nbones)
+        {
+            s_scratch = ModelBone::MakeArray(nbones);
+            s_scratchCount = nbones;
+        }
+
+        return s_scratch.get();
+    }
+}
+
 Model::~Model()
 {
 }
@@ -416,7 +446,8 @@ Model::Model(Model const& other) :
     meshes(other.meshes),
     bones(other.bones),
     name(other.name),
-    mEffectCache(other.mEffectCache)
+    mEffectCache(other.mEffectCache),
+    mBoneHierarchy(std::atomic_load(&other.mBoneHierarchy))
 {
     const size_t nbones = other.bones.size();
     if (nbones > 0)
@@ -445,6 +476,7 @@ Model& Model::operator= (Model const& rhs)
         std::swap(invBindPoseMatrices, tmp.invBindPoseMatrices);
         std::swap(name, tmp.name);
         std::swap(mEffectCache, tmp.mEffectCache);
+        std::swap(mBoneHierarchy, tmp.mBoneHierarchy);
     }
     return *this;
 }
@@ -586,11 +618,7 @@ void Model::CopyAbsoluteBoneTransformsTo(
         throw std::runtime_error("Model is missing bones");
     }
 
-    memset(boneTransforms, 0, sizeof(XMMATRIX) * nbones);
-
-    const XMMATRIX id = XMMatrixIdentity();
-    size_t visited = 0;
-    ComputeAbsolute(0, id, bones.size(), boneMatrices.get(), boneTransforms, visited);
+    CopyAbsoluteBoneTransformsRange(0, 1, nbones, boneMatrices.get(), boneTransforms, nullptr);
 }
 
 
@@ -616,51 +644,105 @@ void Model::CopyAbsoluteBoneTransforms(
         throw std::runtime_error("Model is missing bones");
     }
 
-    memset(outBoneTransforms, 0, sizeof(XMMATRIX) * nbones);
+    CopyAbsoluteBoneTransformsRange(0, 1, nbones, inBoneTransforms, outBoneTransforms, nullptr);
+}
+
 
-    const XMMATRIX id = XMMatrixIdentity();
-    size_t visited = 0;
-    ComputeAbsolute(0, id, bones.size(), inBoneTransforms, outBoneTransforms, visited);
+// Compute using bone hierarchy for many instances, optionally producing skinning matrices.
+_Use_decl_annotations_
+void Model::CopyAbsoluteBoneTransformsBatch(
+    size_t ninstances,
+    size_t nbones,
+    const XMMATRIX* inBoneTransforms,
+    XMMATRIX* outBoneTransforms,
+    XMMATRIX* outSkinTransforms) const
+{
+    CopyAbsoluteBoneTransformsRange(0, ninstances, nbones, inBoneTransforms, outBoneTransforms, outSkinTransforms);
 }
 
 
-// Private helper for computing hierarchical transforms using bones via recursion.
+// Compute using bone hierarchy for a range of the instances of a batch.
 _Use_decl_annotations_
-void Model::ComputeAbsolute(
-    uint32_t index,
-    CXMMATRIX parent,
+void Model::CopyAbsoluteBoneTransformsRange(
+    size_t firstInstance,
+    size_t ninstances,
     size_t nbones,
     const XMMATRIX* inBoneTransforms,
     XMMATRIX* outBoneTransforms,
-    size_t& visited) const
+    XMMATRIX* outSkinTransforms) const
 {
-    if (index == ModelBone::c_Invalid || index >= nbones)
+    if (!ninstances)
         return;
 
-    assert(inBoneTransforms != nullptr && outBoneTransforms != nullptr);
+    if (!nbones || !inBoneTransforms || (!outBoneTransforms && !outSkinTransforms))
+    {
+        throw std::invalid_argument("Bone transforms arrays required");
+    }
+
+    if (nbones < bones.size())
+    {
+        throw std::invalid_argument("Bone transforms arrays are too small");
+    }
+
+    if (bones.empty())
+    {
+        throw std::runtime_error("Model is missing bones");
+    }
 
-    ++visited; // Cycle detection safety!
-    if (visited > bones.size())
+    if (outSkinTransforms && !invBindPoseMatrices)
     {
-        DebugTrace("ERROR: Model::CopyAbsoluteBoneTransformsTo encountered a cycle in the bones!\n");
-        throw std::runtime_error("Model bones form an invalid graph");
+        throw std::runtime_error("Model is missing inverse bind pose matrices");
     }
 
-    XMMATRIX local = inBoneTransforms[index];
-    local = XMMatrixMultiply(local, parent);
-    outBoneTransforms[index] = local;
+    const auto hierarchy = GetBoneHierarchy();
+    assert(hierarchy->order.size() == hierarchy->parents.size() && hierarchy->order.size() <= bones.size());
+
+    // Skinning-only requests need somewhere to hold the absolute transforms of each instance.
+    XMMATRIX* scratch = outBoneTransforms ? nullptr : GetScratchTransforms(nbones);
 
-    if (bones[index].siblingIndex != ModelBone::c_Invalid)
+    const XMMATRIX* invBindPose = invBindPoseMatrices.get();
+
+    for (size_t instance = firstInstance; instance < firstInstance + ninstances; ++instance)
     {
-        ComputeAbsolute(bones[index].siblingIndex, parent, nbones,
-            inBoneTransforms, outBoneTransforms, visited);
+        const size_t offset = instance * nbones;
+
+        ModelBonesCore::ComputeAbsoluteTransforms(
+            hierarchy->order.data(), hierarchy->parents.data(), hierarchy->order.size(), nbones,
+            inBoneTransforms + offset,
+            outBoneTransforms ? (outBoneTransforms + offset) : scratch,
+            invBindPose,
+            outSkinTransforms ? (outSkinTransforms + offset) : nullptr);
     }
+}
+
+
+// Private helper for flattening the bone hierarchy into parent-before-child order.
+void Model::FlattenBones()
+{
+    mBoneHierarchy.reset();
+    (void)GetBoneHierarchy();
+}
+
+
+// Private helper returning the flattened bone hierarchy, which is built on first use if the model
+// was not loaded from a file or was modified since. Threads racing on first use each build an
+// identical copy, and one of them is kept.
+std::shared_ptr<const Model::BoneHierarchy> Model::GetBoneHierarchy() const
+{
+    auto hierarchy = std::atomic_load(&mBoneHierarchy);
+    if (hierarchy)
+        return hierarchy;
 
-    if (bones[index].childIndex != ModelBone::c_Invalid)
+    auto flattened = std::make_shared<BoneHierarchy>();
+    if (!ModelBonesCore::FlattenHierarchy(bones, flattened->order, flattened->parents))
     {
-        ComputeAbsolute(bones[index].childIndex, local, nbones,
-            inBoneTransforms, outBoneTransforms, visited);
+        DebugTrace("ERROR: Model encountered a cycle in the bones!\n");
+        throw std::runtime_error("Model bones form an invalid graph");
     }
+
+    hierarchy = std::move(flattened);
+    std::atomic_store(&mBoneHierarchy, hierarchy);
+    return hierarchy;
 }
 
 
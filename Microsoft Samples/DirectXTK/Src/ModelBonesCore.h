@@ -0,0 +1,127 @@
+//--------------------------------------------------------------------------------------
+// File: ModelBonesCore.h
+//
+// Platform-neutral bone hierarchy flattening and transform evaluation used by Model
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <DirectXMath.h>
+
+
+namespace DirectX
+{
+    namespace ModelBonesCore
+    {
+        constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+        //--------------------------------------------------------------------------------------
+        // Orders the bones reachable from the root so every parent comes before its children.
+        // TBone needs childIndex and siblingIndex members. Returns false if the links form a cycle.
+        //--------------------------------------------------------------------------------------
+        template<typename TBone>
+        bool FlattenHierarchy(
+            const std::vector<TBone>& bones,
+            std::vector<uint32_t>& order,
+            std::vector<uint32_t>& parents)
+        {
+            const size_t nbones = bones.size();
+
+            order.clear();
+            parents.clear();
+            order.reserve(nbones);
+            parents.reserve(nbones);
+
+            if (!nbones)
+                return true;
+
+            // Pending runs of siblings, along with their shared parent.
+            std::vector<std::pair<uint32_t, uint32_t>> pending;
+            pending.emplace_back(0u, InvalidIndex);
+
+            while (!pending.empty())
+            {
+                const auto run = pending.back();
+                pending.pop_back();
+
+                for (uint32_t index = run.first;
+                    index != InvalidIndex && index < nbones;
+                    index = bones[index].siblingIndex)
+                {
+                    // Cycle detection safety!
+                    if (order.size() >= nbones)
+                    {
+                        order.clear();
+                        parents.clear();
+                        return false;
+                    }
+
+                    order.push_back(index);
+                    parents.push_back(run.second);
+
+                    if (bones[index].childIndex != InvalidIndex)
+                    {
+                        pending.emplace_back(bones[index].childIndex, index);
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        //--------------------------------------------------------------------------------------
+        // Computes absolute transforms (and optionally skinning matrices) for one instance,
+        // walking the order produced by FlattenHierarchy
+        //--------------------------------------------------------------------------------------
+        inline void ComputeAbsoluteTransforms(
+            _In_reads_(count) const uint32_t* order,
+            _In_reads_(count) const uint32_t* parents,
+            size_t count,
+            size_t nbones,
+            _In_reads_(nbones) const XMMATRIX* inBoneTransforms,
+            _Out_writes_(nbones) XMMATRIX* outBoneTransforms,
+            _In_reads_opt_(nbones) const XMMATRIX* invBindPoseTransforms,
+            _Out_writes_opt_(nbones) XMMATRIX* outSkinTransforms) noexcept
+        {
+            // Bones not reachable from the root are left as zero.
+            if (count < nbones)
+            {
+                memset(outBoneTransforms, 0, sizeof(XMMATRIX) * nbones);
+
+                if (outSkinTransforms)
+                {
+                    memset(outSkinTransforms, 0, sizeof(XMMATRIX) * nbones);
+                }
+            }
+
+            for (size_t j = 0; j < count; ++j)
+            {
+                const uint32_t index = order[j];
+                const uint32_t parent = parents[j];
+
+                XMMATRIX local = inBoneTransforms[index];
+                if (parent != InvalidIndex)
+                {
+                    local = XMMatrixMultiply(local, outBoneTransforms[parent]);
+                }
+                outBoneTransforms[index] = local;
+
+                if (outSkinTransforms)
+                {
+                    outSkinTransforms[index] = XMMatrixMultiply(invBindPoseTransforms[index], local);
+                }
+            }
+        }
+    }
+}
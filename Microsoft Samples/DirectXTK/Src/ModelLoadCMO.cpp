@@ -685,6 +685,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
 
             std::swap(model->bones, bones);
             std::swap(model->boneMatrices, transforms);
+            model->FlattenBones();
             std::swap(model->invBindPoseMatrices, invTransforms);
 
             // Animation Clips
@@ -958,9 +959,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
         *animsOffset = 0;
     }
 
-    size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile(szFileName, data, &dataSize);
+    MappedFile file;
+    HRESULT hr = file.Open(szFileName);
     if (FAILED(hr))
     {
         DebugTrace("ERROR: CreateFromCMO failed (%08X) loading '%ls'\n",
@@ -968,7 +968,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
         throw std::runtime_error("CreateFromCMO");
     }
 
-    auto model = CreateFromCMO(device, data.get(), dataSize, fxFactory, flags, animsOffset);
+    auto model = CreateFromCMO(device, file.GetData(), file.GetSize(), fxFactory, flags, animsOffset);
 
     model->name = szFileName;
 
@@ -13,8 +13,14 @@
 #include "Effects.h"
 #include "VertexTypes.h"
 #include "BinaryReader.h"
+#include "MeshOptimizer.h"
 #include "PlatformHelpers.h"
 #include "SDKMesh.h"
+#include "SDKMeshCore.h"
+
+#include <atomic>
+#include <thread>
+#include <utility>
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -358,118 +364,196 @@ namespace
 
         return flags;
     }
-}
 
 
-//======================================================================================
-// Model Loader
-//======================================================================================
+    //--------------------------------------------------------------------------------------
+    // Index reordering
+
+    // Reorders the triangles of each index range for the post-transform vertex cache. Ranges
+    // are sorted by start, and any that overlap another are left alone.
+    template<typename TIndex>
+    void OptimizeIndexRanges(
+        _Inout_updates_(indexCount) TIndex* indices,
+        size_t indexCount,
+        std::vector<std::pair<uint64_t, uint64_t>>& ranges)
+    {
+        ranges.erase(std::remove_if(ranges.begin(), ranges.end(), [indexCount](const std::pair<uint64_t, uint64_t>& range) noexcept
+            {
+                return range.first > indexCount || range.second > indexCount - range.first || range.second < 3;
+            }), ranges.end());
 
-_Use_decl_annotations_
-std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
-    ID3D11Device* d3dDevice,
-    const uint8_t* meshData,
-    size_t idataSize,
-    IEffectFactory& fxFactory,
-    ModelLoaderFlags flags)
-{
-    if (!d3dDevice || !meshData)
-        throw std::invalid_argument("Device and meshData cannot be null");
+        std::sort(ranges.begin(), ranges.end());
+        ranges.erase(std::unique(ranges.begin(), ranges.end()), ranges.end());
 
-    const uint64_t dataSize = idataSize;
+        for (size_t j = 0; j < ranges.size(); ++j)
+        {
+            const uint64_t start = ranges[j].first;
+            const uint64_t count = ranges[j].second;
 
-    // File Headers
-    if (dataSize < sizeof(DXUT::SDKMESH_HEADER))
-        throw std::runtime_error("End of file");
-    auto header = reinterpret_cast<const DXUT::SDKMESH_HEADER*>(meshData);
+            if (j > 0 && ranges[j - 1].first + ranges[j - 1].second > start)
+                continue;
 
-    const size_t headerSize = sizeof(DXUT::SDKMESH_HEADER)
-        + header->NumVertexBuffers * sizeof(DXUT::SDKMESH_VERTEX_BUFFER_HEADER)
-        + header->NumIndexBuffers * sizeof(DXUT::SDKMESH_INDEX_BUFFER_HEADER);
-    if (header->HeaderSize != headerSize)
-        throw std::runtime_error("Not a valid SDKMESH file");
+            if (j + 1 < ranges.size() && start + count > ranges[j + 1].first)
+                continue;
 
-    if (dataSize < header->HeaderSize)
-        throw std::runtime_error("End of file");
+            TIndex* first = indices + start;
+            const size_t vertexCount = size_t(*std::max_element(first, first + count)) + 1;
 
-    if (header->Version != DXUT::SDKMESH_FILE_VERSION && header->Version != DXUT::SDKMESH_FILE_VERSION_V2)
-        throw std::runtime_error("Not a supported SDKMESH version");
+        #ifdef _DEBUG
+            const auto before = MeshOptimizer::ComputeCacheStatistics(first, static_cast<size_t>(count), vertexCount);
+        #endif
 
-    if (header->IsBigEndian)
-        throw std::runtime_error("Loading BigEndian SDKMESH files not supported");
+            MeshOptimizer::OptimizeVertexCache(first, static_cast<size_t>(count), vertexCount);
 
-    if (!header->NumMeshes)
-        throw std::runtime_error("No meshes found");
+        #ifdef _DEBUG
+            const auto after = MeshOptimizer::ComputeCacheStatistics(first, static_cast<size_t>(count), vertexCount);
 
-    if (!header->NumVertexBuffers)
-        throw std::runtime_error("No vertex buffers found");
+            DebugTrace("INFO: CreateFromSDKMESH optimized %llu triangles (ACMR %.3f -> %.3f)\n",
+                count / 3, before.acmr, after.acmr);
+        #endif
+        }
+    }
 
-    if (!header->NumIndexBuffers)
-        throw std::runtime_error("No index buffers found");
 
-    if (!header->NumTotalSubsets)
-        throw std::runtime_error("No subsets found");
+    //--------------------------------------------------------------------------------------
+    // Vertex & index buffer creation
 
-    if (!header->NumMaterials)
-        throw std::runtime_error("No materials found");
+    struct BufferRequest
+    {
+        const uint8_t* data;
+        UINT sizeBytes;
+        UINT bindFlags;
+        ID3D11Buffer** buffer;
 
-    // Sub-headers
-    if (dataSize < header->VertexStreamHeadersOffset
-        || (dataSize < (header->VertexStreamHeadersOffset + uint64_t(header->NumVertexBuffers) * sizeof(DXUT::SDKMESH_VERTEX_BUFFER_HEADER))))
-        throw std::runtime_error("End of file");
-    auto vbArray = reinterpret_cast<const DXUT::SDKMESH_VERTEX_BUFFER_HEADER*>(meshData + header->VertexStreamHeadersOffset);
+        BufferRequest(const uint8_t* idata, UINT isizeBytes, UINT ibindFlags, ID3D11Buffer** ibuffer) noexcept :
+            data(idata), sizeBytes(isizeBytes), bindFlags(ibindFlags), buffer(ibuffer) {}
+    };
 
-    if (dataSize < header->IndexStreamHeadersOffset
-        || (dataSize < (header->IndexStreamHeadersOffset + uint64_t(header->NumIndexBuffers) * sizeof(DXUT::SDKMESH_INDEX_BUFFER_HEADER))))
-        throw std::runtime_error("End of file");
-    auto ibArray = reinterpret_cast<const DXUT::SDKMESH_INDEX_BUFFER_HEADER*>(meshData + header->IndexStreamHeadersOffset);
+    HRESULT CreateBuffer(_In_ ID3D11Device* d3dDevice, const BufferRequest& request) noexcept
+    {
+        D3D11_BUFFER_DESC desc = {};
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = request.sizeBytes;
+        desc.BindFlags = request.bindFlags;
 
-    if (dataSize < header->MeshDataOffset
-        || (dataSize < (header->MeshDataOffset + uint64_t(header->NumMeshes) * sizeof(DXUT::SDKMESH_MESH))))
-        throw std::runtime_error("End of file");
-    auto meshArray = reinterpret_cast<const DXUT::SDKMESH_MESH*>(meshData + header->MeshDataOffset);
+        D3D11_SUBRESOURCE_DATA initData = { request.data, 0, 0 };
 
-    if (dataSize < header->SubsetDataOffset
-        || (dataSize < (header->SubsetDataOffset + uint64_t(header->NumTotalSubsets) * sizeof(DXUT::SDKMESH_SUBSET))))
-        throw std::runtime_error("End of file");
-    auto subsetArray = reinterpret_cast<const DXUT::SDKMESH_SUBSET*>(meshData + header->SubsetDataOffset);
+        HRESULT hr = d3dDevice->CreateBuffer(&desc, &initData, request.buffer);
+        if (SUCCEEDED(hr))
+        {
+            SetDebugObjectName(*request.buffer, "ModelSDKMESH");
+        }
 
-    const DXUT::SDKMESH_FRAME* frameArray = nullptr;
-    if (header->NumFrames > 0)
+        return hr;
+    }
+
+    // Creates the buffers, spreading large models across worker threads. Resource creation on
+    // a Direct3D 11 device is free-threaded unless it was created single-threaded, and most of
+    // the cost is copying (and, for mapped files, paging in) the initial data.
+    void CreateBuffers(_In_ ID3D11Device* d3dDevice, const std::vector<BufferRequest>& requests)
     {
-        if (dataSize < header->FrameDataOffset
-            || (dataSize < (header->FrameDataOffset + uint64_t(header->NumFrames) * sizeof(DXUT::SDKMESH_FRAME))))
-            throw std::runtime_error("End of file");
+        constexpr uint64_t MinBytesPerThread = 4u * 1024u * 1024u;
 
-        if (flags & ModelLoader_IncludeBones)
+        uint64_t totalBytes = 0;
+        for (const auto& it : requests)
         {
-            frameArray = reinterpret_cast<const DXUT::SDKMESH_FRAME*>(meshData + header->FrameDataOffset);
+            totalBytes += it.sizeBytes;
         }
-    }
 
-    if (dataSize < header->MaterialDataOffset
-        || (dataSize < (header->MaterialDataOffset + uint64_t(header->NumMaterials) * sizeof(DXUT::SDKMESH_MATERIAL))))
-        throw std::runtime_error("End of file");
+        size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        threadCount = std::min<size_t>(threadCount, requests.size());
+        threadCount = std::min<size_t>(threadCount, static_cast<size_t>(totalBytes / MinBytesPerThread));
 
-    const DXUT::SDKMESH_MATERIAL* materialArray = nullptr;
-    const DXUT::SDKMESH_MATERIAL_V2* materialArray_v2 = nullptr;
-    if (header->Version == DXUT::SDKMESH_FILE_VERSION_V2)
-    {
-        materialArray_v2 = reinterpret_cast<const DXUT::SDKMESH_MATERIAL_V2*>(meshData + header->MaterialDataOffset);
+        if (d3dDevice->GetCreationFlags() & D3D11_CREATE_DEVICE_SINGLETHREADED)
+        {
+            threadCount = 1;
+        }
+
+        if (threadCount < 2)
+        {
+            for (const auto& it : requests)
+            {
+                ThrowIfFailed(CreateBuffer(d3dDevice, it));
+            }
+            return;
+        }
+
+        // Threads take requests in turn, so a few large buffers don't end up on one thread.
+        std::atomic<size_t> nextRequest(0);
+        std::vector<HRESULT> results(requests.size(), S_OK);
+
+        auto worker = [&]() noexcept
+        {
+            for (size_t j = nextRequest++; j < requests.size(); j = nextRequest++)
+            {
+                results[j] = CreateBuffer(d3dDevice, requests[j]);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount - 1);
+
+        try
+        {
+            for (size_t t = 0; t < threadCount - 1; ++t)
+            {
+                workers.emplace_back(worker);
+            }
+        }
+        catch (...)
+        {
+            // Fewer threads than requested is fine; the calling thread works too.
+        }
+
+        worker();
+
+        for (auto& it : workers)
+        {
+            it.join();
+        }
+
+        for (const HRESULT hr : results)
+        {
+            ThrowIfFailed(hr);
+        }
     }
-    else
+}
+
+
+//======================================================================================
+// Model Loader
+//======================================================================================
+
+_Use_decl_annotations_
+std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
+    ID3D11Device* d3dDevice,
+    const uint8_t* meshData,
+    size_t idataSize,
+    IEffectFactory& fxFactory,
+    ModelLoaderFlags flags)
+{
+    if (!d3dDevice || !meshData)
+        throw std::invalid_argument("Device and meshData cannot be null");
+
+    // Validate all headers, tables and buffer ranges before creating any resources
+    SDKMeshCore::FileLayout layout;
+    SDKMeshCore::Parse(meshData, idataSize, layout);
+
+    auto header = layout.header;
+    auto vbArray = layout.vertexBuffers;
+    auto ibArray = layout.indexBuffers;
+    auto meshArray = layout.meshes;
+    auto subsetArray = layout.subsets;
+    auto materialArray = layout.materials;
+    auto materialArray_v2 = layout.materialsV2;
+
+    const DXUT::SDKMESH_FRAME* frameArray = nullptr;
+    if (flags & ModelLoader_IncludeBones)
     {
-        materialArray = reinterpret_cast<const DXUT::SDKMESH_MATERIAL*>(meshData + header->MaterialDataOffset);
+        frameArray = layout.frames;
     }
 
-    // Buffer data
-    const uint64_t bufferDataOffset = header->HeaderSize + header->NonBufferDataSize;
-    if ((dataSize < bufferDataOffset)
-        || (dataSize < bufferDataOffset + header->BufferDataSize))
-        throw std::runtime_error("End of file");
-    const uint8_t* bufferData = meshData + bufferDataOffset;
-
-    // Create vertex buffers
+    // Describe vertex buffers
     std::vector<ComPtr<ID3D11Buffer>> vbs;
     vbs.resize(header->NumVertexBuffers);
 
@@ -479,24 +563,20 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
     std::vector<unsigned int> materialFlags;
     materialFlags.resize(header->NumVertexBuffers);
 
+    std::vector<BufferRequest> bufferRequests;
+    bufferRequests.reserve(size_t(header->NumVertexBuffers) + header->NumIndexBuffers);
+
     bool dec3nwarning = false;
     for (size_t j = 0; j < header->NumVertexBuffers; ++j)
     {
         auto& vh = vbArray[j];
 
-        if (vh.SizeBytes > UINT32_MAX)
-            throw std::runtime_error("VB too large");
-
         if (!(flags & ModelLoader_AllowLargeModels))
         {
             if (vh.SizeBytes > (D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024u * 1024u))
                 throw std::runtime_error("VB too large for DirectX 11");
         }
 
-        if (dataSize < vh.DataOffset
-            || (dataSize < vh.DataOffset + vh.SizeBytes))
-            throw std::runtime_error("End of file");
-
         vbDecls[j] = std::make_shared<ModelMeshPart::InputLayoutCollection>();
         unsigned int ilflags = GetInputLayoutDesc(vh.Decl, *vbDecls[j].get());
 
@@ -516,20 +596,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
 
         materialFlags[j] = ilflags;
 
-        auto verts = bufferData + (vh.DataOffset - bufferDataOffset);
-
-        D3D11_BUFFER_DESC desc = {};
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = static_cast<UINT>(vh.SizeBytes);
-        desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-
-        D3D11_SUBRESOURCE_DATA initData = { verts, 0, 0 };
-
-        ThrowIfFailed(
-            d3dDevice->CreateBuffer(&desc, &initData, &vbs[j])
-        );
-
-        SetDebugObjectName(vbs[j].Get(), "ModelSDKMESH");
+        bufferRequests.emplace_back(meshData + vh.DataOffset, static_cast<UINT>(vh.SizeBytes), D3D11_BIND_VERTEX_BUFFER, vbs[j].GetAddressOf());
     }
 
     if (dec3nwarning)
@@ -538,46 +605,73 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
                    "         (treating as DXGI_FORMAT_R10G10B10A2_UNORM which is not a signed format)\n");
     }
 
-    // Create index buffers
+    // Describe index buffers
     std::vector<ComPtr<ID3D11Buffer>> ibs;
     ibs.resize(header->NumIndexBuffers);
 
+    // Vertex buffers may be shared by several subsets, so only the triangle order is optimized
+    std::vector<std::vector<uint8_t>> optimizedIndices;
+    if (flags & ModelLoader_OptimizeMeshes)
+    {
+        optimizedIndices.resize(header->NumIndexBuffers);
+    }
+
     for (size_t j = 0; j < header->NumIndexBuffers; ++j)
     {
         auto& ih = ibArray[j];
 
-        if (ih.SizeBytes > UINT32_MAX)
-            throw std::runtime_error("IB too large");
-
         if (!(flags & ModelLoader_AllowLargeModels))
         {
             if (ih.SizeBytes > (D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024u * 1024u))
                 throw std::runtime_error("IB too large for DirectX 11");
         }
 
-        if (dataSize < ih.DataOffset
-            || (dataSize < ih.DataOffset + ih.SizeBytes))
-            throw std::runtime_error("End of file");
+        const uint8_t* indexData = meshData + ih.DataOffset;
 
-        if (ih.IndexType != DXUT::IT_16BIT && ih.IndexType != DXUT::IT_32BIT)
-            throw std::runtime_error("Invalid index buffer type found");
+        if (flags & ModelLoader_OptimizeMeshes)
+        {
+            std::vector<std::pair<uint64_t, uint64_t>> ranges;
+            for (size_t meshIndex = 0; meshIndex < header->NumMeshes; ++meshIndex)
+            {
+                auto& mh = meshArray[meshIndex];
+                if (mh.IndexBuffer != j)
+                    continue;
 
-        auto indices = bufferData + (ih.DataOffset - bufferDataOffset);
+                auto subsets = reinterpret_cast<const uint32_t*>(meshData + mh.SubsetOffset);
+                for (size_t k = 0; k < mh.NumSubsets; ++k)
+                {
+                    auto& subset = subsetArray[subsets[k]];
+                    if (subset.PrimitiveType == DXUT::PT_TRIANGLE_LIST)
+                    {
+                        ranges.emplace_back(subset.IndexStart, subset.IndexCount - (subset.IndexCount % 3));
+                    }
+                }
+            }
 
-        D3D11_BUFFER_DESC desc = {};
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = static_cast<UINT>(ih.SizeBytes);
-        desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+            if (!ranges.empty())
+            {
+                auto& copy = optimizedIndices[j];
+                copy.assign(indexData, indexData + ih.SizeBytes);
 
-        D3D11_SUBRESOURCE_DATA initData = { indices, 0, 0 };
+                if (ih.IndexType == DXUT::IT_32BIT)
+                {
+                    OptimizeIndexRanges(reinterpret_cast<uint32_t*>(copy.data()), copy.size() / sizeof(uint32_t), ranges);
+                }
+                else
+                {
+                    OptimizeIndexRanges(reinterpret_cast<uint16_t*>(copy.data()), copy.size() / sizeof(uint16_t), ranges);
+                }
 
-        ThrowIfFailed(
-            d3dDevice->CreateBuffer(&desc, &initData, &ibs[j])
-        );
+                indexData = copy.data();
+            }
+        }
 
-        SetDebugObjectName(ibs[j].Get(), "ModelSDKMESH");
+        bufferRequests.emplace_back(indexData, static_cast<UINT>(ih.SizeBytes), D3D11_BIND_INDEX_BUFFER, ibs[j].GetAddressOf());
     }
 
+    // Create vertex & index buffers
+    CreateBuffers(d3dDevice, bufferRequests);
+
     // Create meshes
     std::vector<MaterialRecordSDKMESH> materials;
     materials.resize(header->NumMaterials);
@@ -589,31 +683,12 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
     {
         auto& mh = meshArray[meshIndex];
 
-        if (!mh.NumSubsets
-            || !mh.NumVertexBuffers
-            || mh.IndexBuffer >= header->NumIndexBuffers
-            || mh.VertexBuffers[0] >= header->NumVertexBuffers)
-            throw std::out_of_range("Invalid mesh found");
-
-        // mh.NumVertexBuffers is sometimes not what you'd expect, so we skip validating it
-
-        if (dataSize < mh.SubsetOffset
-            || (dataSize < mh.SubsetOffset + uint64_t(mh.NumSubsets) * sizeof(uint32_t)))
-            throw std::runtime_error("End of file");
-
         auto subsets = reinterpret_cast<const uint32_t*>(meshData + mh.SubsetOffset);
 
         const uint32_t* influences = nullptr;
-        if (mh.NumFrameInfluences > 0)
+        if (mh.NumFrameInfluences > 0 && (flags & ModelLoader_IncludeBones))
         {
-            if (dataSize < mh.FrameInfluenceOffset
-                || (dataSize < mh.FrameInfluenceOffset + uint64_t(mh.NumFrameInfluences) * sizeof(uint32_t)))
-                throw std::runtime_error("End of file");
-
-            if (flags & ModelLoader_IncludeBones)
-            {
-                influences = reinterpret_cast<const uint32_t*>(meshData + mh.FrameInfluenceOffset);
-            }
+            influences = reinterpret_cast<const uint32_t*>(meshData + mh.FrameInfluenceOffset);
         }
 
         auto mesh = std::make_shared<ModelMesh>();
@@ -639,9 +714,6 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         for (size_t j = 0; j < mh.NumSubsets; ++j)
         {
             auto const sIndex = subsets[j];
-            if (sIndex >= header->NumTotalSubsets)
-                throw std::out_of_range("Invalid mesh found");
-
             auto& subset = subsetArray[sIndex];
 
             D3D11_PRIMITIVE_TOPOLOGY primType;
@@ -665,9 +737,6 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
                     throw std::runtime_error("Unknown primitive type");
             }
 
-            if (subset.MaterialID >= header->NumMaterials)
-                throw std::out_of_range("Invalid mesh found");
-
             auto& mat = materials[subset.MaterialID];
 
             if (!mat.effect)
@@ -762,6 +831,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         }
 
         std::swap(model->bones, bones);
+        model->FlattenBones();
 
         // Compute inverse bind pose matrices for the model
         auto bindPose = ModelBone::MakeArray(header->NumFrames);
@@ -789,9 +859,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
     IEffectFactory& fxFactory,
     ModelLoaderFlags flags)
 {
-    size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile(szFileName, data, &dataSize);
+    MappedFile file;
+    HRESULT hr = file.Open(szFileName);
     if (FAILED(hr))
     {
         DebugTrace("ERROR: CreateFromSDKMESH failed (%08X) loading '%ls'\n",
@@ -799,7 +868,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         throw std::runtime_error("CreateFromSDKMESH");
     }
 
-    auto model = CreateFromSDKMESH(device, data.get(), dataSize, fxFactory, flags);
+    auto model = CreateFromSDKMESH(device, file.GetData(), file.GetSize(), fxFactory, flags);
 
     model->name = szFileName;
 
@@ -13,6 +13,7 @@
 #include "Effects.h"
 #include "VertexTypes.h"
 #include "BinaryReader.h"
+#include "MeshOptimizer.h"
 #include "PlatformHelpers.h"
 
 #include "vbo.h"
@@ -100,6 +101,40 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
         throw std::runtime_error("End of file");
     auto indices = reinterpret_cast<const uint16_t*>(meshData + sizeof(VBO::header_t) + vertSize);
 
+    // Optionally reorder for the vertex cache, overdraw and vertex fetch
+    std::vector<VertexPositionNormalTexture> optimizedVerts;
+    std::vector<uint16_t> optimizedIndices;
+    if (flags & ModelLoader_OptimizeMeshes)
+    {
+        optimizedVerts.assign(verts, verts + header->numVertices);
+        optimizedIndices.assign(indices, indices + header->numIndices);
+
+    #ifdef _DEBUG
+        const auto before = MeshOptimizer::ComputeCacheStatistics(optimizedIndices.data(), optimizedIndices.size(), optimizedVerts.size());
+    #endif
+
+        std::vector<size_t> clusters;
+        MeshOptimizer::OptimizeVertexCache(optimizedIndices.data(), optimizedIndices.size(), optimizedVerts.size(),
+            MeshOptimizer::DefaultCacheSize, &clusters);
+
+        MeshOptimizer::OptimizeOverdraw(optimizedIndices.data(), optimizedIndices.size(),
+            &optimizedVerts.data()->position, sizeof(VertexPositionNormalTexture), optimizedVerts.size(), clusters);
+
+        std::vector<uint32_t> remap;
+        MeshOptimizer::OptimizeVertexFetch(optimizedIndices.data(), optimizedIndices.size(), optimizedVerts.size(), remap);
+        MeshOptimizer::RemapVertices(optimizedVerts, remap);
+
+    #ifdef _DEBUG
+        const auto after = MeshOptimizer::ComputeCacheStatistics(optimizedIndices.data(), optimizedIndices.size(), optimizedVerts.size());
+
+        DebugTrace("INFO: CreateFromVBO optimized mesh (ACMR %.3f -> %.3f, ATVR %.3f -> %.3f)\n",
+            before.acmr, after.acmr, before.atvr, after.atvr);
+    #endif
+
+        verts = optimizedVerts.data();
+        indices = optimizedIndices.data();
+    }
+
     // Create vertex buffer
     ComPtr<ID3D11Buffer> vb;
     {
@@ -184,9 +219,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
     std::shared_ptr<IEffect> ieffect,
     ModelLoaderFlags flags)
 {
-    size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile(szFileName, data, &dataSize);
+    MappedFile file;
+    HRESULT hr = file.Open(szFileName);
     if (FAILED(hr))
     {
         DebugTrace("ERROR: CreateFromVBO failed (%08X) loading '%ls'\n",
@@ -194,7 +228,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
         throw std::runtime_error("CreateFromVBO");
     }
 
-    auto model = CreateFromVBO(device, data.get(), dataSize, ieffect, flags);
+    auto model = CreateFromVBO(device, file.GetData(), file.GetSize(), ieffect, flags);
 
     model->name = szFileName;
 
@@ -0,0 +1,208 @@
+//--------------------------------------------------------------------------------------
+// File: SDKMeshCore.h
+//
+// Platform-neutral parsing and validation of SDKMESH files used by Model
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "SDKMesh.h"
+
+
+namespace DirectX
+{
+    namespace SDKMeshCore
+    {
+        //--------------------------------------------------------------------------------------
+        // Views into the tables of an SDKMESH file in memory.
+        //
+        // Once Parse has returned, every offset, count and index in these tables has been
+        // checked against the file size and table sizes, so device resources can be created
+        // from them (in any order, or in parallel) without further validation.
+        //--------------------------------------------------------------------------------------
+        struct FileLayout
+        {
+            const DXUT::SDKMESH_HEADER*                 header;
+            const DXUT::SDKMESH_VERTEX_BUFFER_HEADER*   vertexBuffers;
+            const DXUT::SDKMESH_INDEX_BUFFER_HEADER*    indexBuffers;
+            const DXUT::SDKMESH_MESH*                   meshes;
+            const DXUT::SDKMESH_SUBSET*                 subsets;
+            const DXUT::SDKMESH_FRAME*                  frames;         // nullptr if the file has no frames
+            const DXUT::SDKMESH_MATERIAL*               materials;      // Set for version 1 files
+            const DXUT::SDKMESH_MATERIAL_V2*            materialsV2;    // Set for version 2 files
+        };
+
+
+        // Returns true if [offset, offset + count * elementSize) lies within the file.
+        inline bool IsInFile(uint64_t dataSize, uint64_t offset, uint64_t count, uint64_t elementSize) noexcept
+        {
+            if (offset > dataSize)
+                return false;
+
+            if (elementSize && count > (dataSize - offset) / elementSize)
+                return false;
+
+            return true;
+        }
+
+
+        // Validates the headers, tables and buffer ranges of an SDKMESH file, throwing on failure.
+        inline void Parse(
+            _In_reads_bytes_(dataSize) const uint8_t* meshData,
+            uint64_t dataSize,
+            FileLayout& layout)
+        {
+            layout = {};
+
+            // File Headers
+            if (dataSize < sizeof(DXUT::SDKMESH_HEADER))
+                throw std::runtime_error("End of file");
+            auto header = reinterpret_cast<const DXUT::SDKMESH_HEADER*>(meshData);
+
+            const uint64_t headerSize = sizeof(DXUT::SDKMESH_HEADER)
+                + uint64_t(header->NumVertexBuffers) * sizeof(DXUT::SDKMESH_VERTEX_BUFFER_HEADER)
+                + uint64_t(header->NumIndexBuffers) * sizeof(DXUT::SDKMESH_INDEX_BUFFER_HEADER);
+            if (header->HeaderSize != headerSize)
+                throw std::runtime_error("Not a valid SDKMESH file");
+
+            if (dataSize < header->HeaderSize)
+                throw std::runtime_error("End of file");
+
+            if (header->Version != DXUT::SDKMESH_FILE_VERSION && header->Version != DXUT::SDKMESH_FILE_VERSION_V2)
+                throw std::runtime_error("Not a supported SDKMESH version");
+
+            if (header->IsBigEndian)
+                throw std::runtime_error("Loading BigEndian SDKMESH files not supported");
+
+            if (!header->NumMeshes)
+                throw std::runtime_error("No meshes found");
+
+            if (!header->NumVertexBuffers)
+                throw std::runtime_error("No vertex buffers found");
+
+            if (!header->NumIndexBuffers)
+                throw std::runtime_error("No index buffers found");
+
+            if (!header->NumTotalSubsets)
+                throw std::runtime_error("No subsets found");
+
+            if (!header->NumMaterials)
+                throw std::runtime_error("No materials found");
+
+            // Sub-headers
+            if (!IsInFile(dataSize, header->VertexStreamHeadersOffset, header->NumVertexBuffers, sizeof(DXUT::SDKMESH_VERTEX_BUFFER_HEADER)))
+                throw std::runtime_error("End of file");
+            auto vbArray = reinterpret_cast<const DXUT::SDKMESH_VERTEX_BUFFER_HEADER*>(meshData + header->VertexStreamHeadersOffset);
+
+            if (!IsInFile(dataSize, header->IndexStreamHeadersOffset, header->NumIndexBuffers, sizeof(DXUT::SDKMESH_INDEX_BUFFER_HEADER)))
+                throw std::runtime_error("End of file");
+            auto ibArray = reinterpret_cast<const DXUT::SDKMESH_INDEX_BUFFER_HEADER*>(meshData + header->IndexStreamHeadersOffset);
+
+            if (!IsInFile(dataSize, header->MeshDataOffset, header->NumMeshes, sizeof(DXUT::SDKMESH_MESH)))
+                throw std::runtime_error("End of file");
+            auto meshArray = reinterpret_cast<const DXUT::SDKMESH_MESH*>(meshData + header->MeshDataOffset);
+
+            if (!IsInFile(dataSize, header->SubsetDataOffset, header->NumTotalSubsets, sizeof(DXUT::SDKMESH_SUBSET)))
+                throw std::runtime_error("End of file");
+            auto subsetArray = reinterpret_cast<const DXUT::SDKMESH_SUBSET*>(meshData + header->SubsetDataOffset);
+
+            if (header->NumFrames > 0)
+            {
+                if (!IsInFile(dataSize, header->FrameDataOffset, header->NumFrames, sizeof(DXUT::SDKMESH_FRAME)))
+                    throw std::runtime_error("End of file");
+                layout.frames = reinterpret_cast<const DXUT::SDKMESH_FRAME*>(meshData + header->FrameDataOffset);
+            }
+
+            if (header->Version == DXUT::SDKMESH_FILE_VERSION_V2)
+            {
+                if (!IsInFile(dataSize, header->MaterialDataOffset, header->NumMaterials, sizeof(DXUT::SDKMESH_MATERIAL_V2)))
+                    throw std::runtime_error("End of file");
+                layout.materialsV2 = reinterpret_cast<const DXUT::SDKMESH_MATERIAL_V2*>(meshData + header->MaterialDataOffset);
+            }
+            else
+            {
+                if (!IsInFile(dataSize, header->MaterialDataOffset, header->NumMaterials, sizeof(DXUT::SDKMESH_MATERIAL)))
+                    throw std::runtime_error("End of file");
+                layout.materials = reinterpret_cast<const DXUT::SDKMESH_MATERIAL*>(meshData + header->MaterialDataOffset);
+            }
+
+            // Buffer data
+            const uint64_t bufferDataOffset = header->HeaderSize + header->NonBufferDataSize;
+            if (bufferDataOffset < header->HeaderSize
+                || !IsInFile(dataSize, bufferDataOffset, header->BufferDataSize, 1))
+                throw std::runtime_error("End of file");
+
+            for (size_t j = 0; j < header->NumVertexBuffers; ++j)
+            {
+                auto& vh = vbArray[j];
+
+                if (vh.SizeBytes > UINT32_MAX)
+                    throw std::runtime_error("VB too large");
+
+                if (!IsInFile(dataSize, vh.DataOffset, vh.SizeBytes, 1))
+                    throw std::runtime_error("End of file");
+            }
+
+            for (size_t j = 0; j < header->NumIndexBuffers; ++j)
+            {
+                auto& ih = ibArray[j];
+
+                if (ih.SizeBytes > UINT32_MAX)
+                    throw std::runtime_error("IB too large");
+
+                if (!IsInFile(dataSize, ih.DataOffset, ih.SizeBytes, 1))
+                    throw std::runtime_error("End of file");
+
+                if (ih.IndexType != DXUT::IT_16BIT && ih.IndexType != DXUT::IT_32BIT)
+                    throw std::runtime_error("Invalid index buffer type found");
+            }
+
+            for (size_t meshIndex = 0; meshIndex < header->NumMeshes; ++meshIndex)
+            {
+                auto& mh = meshArray[meshIndex];
+
+                if (!mh.NumSubsets
+                    || !mh.NumVertexBuffers
+                    || mh.IndexBuffer >= header->NumIndexBuffers
+                    || mh.VertexBuffers[0] >= header->NumVertexBuffers)
+                    throw std::out_of_range("Invalid mesh found");
+
+                // mh.NumVertexBuffers is sometimes not what you'd expect, so we skip validating it
+
+                if (!IsInFile(dataSize, mh.SubsetOffset, mh.NumSubsets, sizeof(uint32_t)))
+                    throw std::runtime_error("End of file");
+
+                if (mh.NumFrameInfluences > 0
+                    && !IsInFile(dataSize, mh.FrameInfluenceOffset, mh.NumFrameInfluences, sizeof(uint32_t)))
+                    throw std::runtime_error("End of file");
+
+                auto subsets = reinterpret_cast<const uint32_t*>(meshData + mh.SubsetOffset);
+
+                for (size_t j = 0; j < mh.NumSubsets; ++j)
+                {
+                    const uint32_t sIndex = subsets[j];
+                    if (sIndex >= header->NumTotalSubsets)
+                        throw std::out_of_range("Invalid mesh found");
+
+                    if (subsetArray[sIndex].MaterialID >= header->NumMaterials)
+                        throw std::out_of_range("Invalid mesh found");
+                }
+            }
+
+            layout.header = header;
+            layout.vertexBuffers = vbArray;
+            layout.indexBuffers = ibArray;
+            layout.meshes = meshArray;
+            layout.subsets = subsetArray;
+        }
+    }
+}
@@ -16,6 +16,10 @@
 #include "VertexTypes.h"
 #include "AlignedNew.h"
 #include "SharedResourcePool.h"
+#include "SpriteBatchCore.h"
+
+#include <atomic>
+#include <thread>
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -97,6 +101,8 @@ public:
         static constexpr unsigned int DestSizeInPixels = 8;
 
         static_assert((SpriteEffects_FlipBoth & (SourceInTexels | DestSizeInPixels)) == 0, "Flag bits must not overlap");
+        static_assert(SpriteEffects_FlipHorizontally == 1 &&
+                      SpriteEffects_FlipVertically == 2, "If you change these enum values, the mirroring implementation in SpriteBatchCore must be updated to match");
     };
 
     DXGI_MODE_ROTATION mRotation;
@@ -105,20 +111,38 @@ public:
     D3D11_VIEWPORT mViewPort;
 
 private:
+    // Queue of sprites submitted by a single thread, waiting to be drawn. Only the owning
+    // thread appends to it, so Draw needs no locking. Storage grows in fixed size chunks,
+    // which are never moved or freed until the SpriteBatch is destroyed, so queued sprites
+    // are never copied and pointers to them stay valid.
+    struct SpriteQueue
+    {
+        explicit SpriteQueue(std::thread::id id) noexcept : threadId(id), count(0) {}
+
+        SpriteInfo* Append();
+        void Reset() noexcept;
+
+        std::thread::id threadId;
+
+        std::vector<std::unique_ptr<SpriteInfo[]>> chunks;
+        size_t count;
+
+        // If each SpriteInfo instance held a refcount on its texture, could end up with
+        // many redundant AddRef/Release calls on the same object, so instead we use
+        // this separate list to hold just a single refcount each time we change texture.
+        std::vector<ComPtr<ID3D11ShaderResourceView>> textureReferences;
+    };
+
+
     // Implementation helper methods.
-    void GrowSpriteQueue();
+    SpriteQueue* GetThreadQueue();
     void PrepareForRendering();
     void FlushBatch();
-    void SortSprites();
-    void GrowSortedSprites();
+    size_t GatherSprites();
+    void SortSprites(size_t count);
 
     void RenderBatch(_In_ ID3D11ShaderResourceView* texture, _In_reads_(count) SpriteInfo const* const* sprites, size_t count);
 
-    static void XM_CALLCONV RenderSprite(_In_ SpriteInfo const* sprite,
-        _Out_writes_(VerticesPerSprite) VertexPositionColorTexture* vertices,
-        FXMVECTOR textureSize,
-        FXMVECTOR inverseTextureSize);
-
     static XMVECTOR GetTextureSize(_In_ ID3D11ShaderResourceView* texture);
     XMMATRIX GetViewportTransform(_In_ ID3D11DeviceContext* deviceContext, DXGI_MODE_ROTATION rotation );
 
@@ -126,29 +150,36 @@ private:
     // Constants.
     static constexpr size_t MaxBatchSize = 2048;
     static constexpr size_t MinBatchSize = 128;
-    static constexpr size_t InitialQueueSize = 64;
+    static constexpr size_t QueueChunkSize = 1024;
     static constexpr size_t VerticesPerSprite = 4;
     static constexpr size_t IndicesPerSprite = 6;
 
 
-    // Queue of sprites waiting to be drawn.
-    std::unique_ptr<SpriteInfo[]> mSpriteQueue;
+    // One queue per thread that has drawn using this SpriteBatch. The list only changes
+    // when a thread draws for the first time, which takes the mutex; after that, each
+    // thread finds its queue through a thread-local cache.
+    std::vector<std::unique_ptr<SpriteQueue>> mSpriteQueues;
+    std::mutex mSpriteQueuesMutex;
 
-    size_t mSpriteQueueCount;
-    size_t mSpriteQueueArraySize;
+    const uint64_t mInstanceId;
 
+    static std::atomic<uint64_t> nextInstanceId;
+    static thread_local uint64_t threadQueueOwner;
+    static thread_local SpriteQueue* threadQueue;
 
-    // To avoid needlessly copying around bulky SpriteInfo structures, we leave that
-    // actual data alone and just sort this array of pointers instead. But we want contiguous
-    // memory for cache efficiency, so these pointers are just shortcuts into the single
-    // mSpriteQueue array, and we take care to keep them in order when sorting is disabled.
-    std::vector<SpriteInfo const*> mSortedSprites;
 
+    // Scratch sprite used in immediate mode, which draws each sprite as soon as it is submitted.
+    SpriteInfo mImmediateSprite;
 
-    // If each SpriteInfo instance held a refcount on its texture, could end up with
-    // many redundant AddRef/Release calls on the same object, so instead we use
-    // this separate list to hold just a single refcount each time we change texture.
-    std::vector<ComPtr<ID3D11ShaderResourceView>> mSpriteTextureReferences;
+
+    // To avoid needlessly copying around bulky SpriteInfo structures, we leave that
+    // actual data alone and just sort this array of pointers into the queues instead.
+    // The sort keys and scratch space used by the radix sort are kept from one batch
+    // to the next to avoid reallocating them.
+    std::vector<SpriteInfo const*> mSortedSprites;
+    std::vector<SpriteInfo const*> mSortScratchSprites;
+    std::vector<uint64_t> mSortKeys;
+    std::vector<uint64_t> mSortScratchKeys;
 
 
     // Mode settings from the last Begin call.
@@ -221,6 +252,12 @@ SharedResourcePool<ID3D11Device*, SpriteBatch::Impl::DeviceResources> SpriteBatc
 SharedResourcePool<ID3D11DeviceContext*, SpriteBatch::Impl::ContextResources> SpriteBatch::Impl::contextResourcesPool;
 
 
+// Per-thread lookup of the sprite queue used by the last SpriteBatch this thread drew with.
+std::atomic<uint64_t> SpriteBatch::Impl::nextInstanceId(1);
+thread_local uint64_t SpriteBatch::Impl::threadQueueOwner = 0;
+thread_local SpriteBatch::Impl::SpriteQueue* SpriteBatch::Impl::threadQueue = nullptr;
+
+
 // Constants.
 const XMMATRIX SpriteBatch::MatrixIdentity = XMMatrixIdentity();
 const XMFLOAT2 SpriteBatch::Float2Zero(0, 0);
@@ -371,8 +408,7 @@ SpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
   : mRotation(DXGI_MODE_ROTATION_IDENTITY),
     mSetViewport(false),
     mViewPort{},
-    mSpriteQueueCount(0),
-    mSpriteQueueArraySize(0),
+    mInstanceId(nextInstanceId++),
     mInBeginEndPair(false),
     mSortMode(SpriteSortMode_Deferred),
     mTransformMatrix(MatrixIdentity),
@@ -463,12 +499,18 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
         throw std::logic_error("Begin must be called before Draw");
 
     // Get a pointer to the output sprite.
-    if (mSpriteQueueCount >= mSpriteQueueArraySize)
+    SpriteQueue* queue = nullptr;
+    SpriteInfo* sprite;
+
+    if (mSortMode == SpriteSortMode_Immediate)
     {
-        GrowSpriteQueue();
+        sprite = &mImmediateSprite;
+    }
+    else
+    {
+        queue = GetThreadQueue();
+        sprite = queue->Append();
     }
-
-    SpriteInfo* sprite = &mSpriteQueue[mSpriteQueueCount];
 
     XMVECTOR dest = destination;
 
@@ -503,49 +545,84 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
     sprite->texture = texture;
     sprite->flags = flags;
 
-    if (mSortMode == SpriteSortMode_Immediate)
+    if (!queue)
     {
         // If we are in immediate mode, draw this sprite straight away.
         RenderBatch(texture, &sprite, 1);
     }
     else
     {
-        // Queue this sprite for later sorting and batched rendering.
-        mSpriteQueueCount++;
+        // The sprite stays queued for later sorting and batched rendering.
 
         // Make sure we hold a refcount on this texture until the sprite has been drawn. Only checking the
         // back of the vector means we will add duplicate references if the caller switches back and forth
         // between multiple repeated textures, but calling AddRef more times than strictly necessary hurts
         // nothing, and is faster than scanning the whole list or using a map to detect all duplicates.
-        if (mSpriteTextureReferences.empty() || texture != mSpriteTextureReferences.back().Get())
+        auto& textureReferences = queue->textureReferences;
+
+        if (textureReferences.empty() || texture != textureReferences.back().Get())
         {
-            mSpriteTextureReferences.emplace_back(texture);
+            textureReferences.emplace_back(texture);
         }
     }
 }
 
 
-// Dynamically expands the array used to store pending sprite information.
-void SpriteBatch::Impl::GrowSpriteQueue()
+// Looks up the sprite queue of the calling thread, creating it on first use.
+SpriteBatch::Impl::SpriteQueue* SpriteBatch::Impl::GetThreadQueue()
 {
-    // Grow by a factor of 2.
-    const size_t newSize = std::max(InitialQueueSize, mSpriteQueueArraySize * 2);
+    // Fast path: this thread last drew using this SpriteBatch.
+    if (threadQueueOwner == mInstanceId)
+        return threadQueue;
+
+    const auto threadId = std::this_thread::get_id();
+
+    const std::lock_guard<std::mutex> lock(mSpriteQueuesMutex);
+
+    SpriteQueue* queue = nullptr;
+
+    for (auto& it : mSpriteQueues)
+    {
+        if (it->threadId == threadId)
+        {
+            queue = it.get();
+            break;
+        }
+    }
+
+    if (!queue)
+    {
+        mSpriteQueues.emplace_back(std::make_unique<SpriteQueue>(threadId));
 
-    // Allocate the new array.
-    auto newArray = std::make_unique<SpriteInfo[]>(newSize);
+        queue = mSpriteQueues.back().get();
+    }
 
-    // Copy over any existing sprites.
-    for (size_t i = 0; i < mSpriteQueueCount; i++)
+    threadQueueOwner = mInstanceId;
+    threadQueue = queue;
+
+    return queue;
+}
+
+
+// Reserves space for one more sprite at the end of the queue.
+SpriteBatch::Impl::SpriteInfo* SpriteBatch::Impl::SpriteQueue::Append()
+{
+    const size_t chunkIndex = count / QueueChunkSize;
+
+    if (chunkIndex >= chunks.size())
     {
-        newArray[i] = mSpriteQueue[i];
+        chunks.emplace_back(std::make_unique<SpriteInfo[]>(QueueChunkSize));
     }
 
-    // Replace the previous array with the new one.
-    mSpriteQueue = std::move(newArray);
-    mSpriteQueueArraySize = newSize;
+    return &chunks[chunkIndex][count++ % QueueChunkSize];
+}
 
-    // Clear any dangling SpriteInfo pointers left over from previous rendering.
-    mSortedSprites.clear();
+
+// Empties the queue, keeping its storage for the next batch.
+void SpriteBatch::Impl::SpriteQueue::Reset() noexcept
+{
+    count = 0;
+    textureReferences.clear();
 }
 
 
@@ -617,16 +694,18 @@ void SpriteBatch::Impl::PrepareForRendering()
 // Sends queued sprites to the graphics device.
 void SpriteBatch::Impl::FlushBatch()
 {
-    if (!mSpriteQueueCount)
+    const size_t spriteCount = GatherSprites();
+
+    if (!spriteCount)
         return;
 
-    SortSprites();
+    SortSprites(spriteCount);
 
     // Walk through the sorted sprite list, looking for adjacent entries that share a texture.
     ID3D11ShaderResourceView* batchTexture = nullptr;
     size_t batchStart = 0;
 
-    for (size_t pos = 0; pos < mSpriteQueueCount; pos++)
+    for (size_t pos = 0; pos < spriteCount; pos++)
     {
         ID3D11ShaderResourceView* texture = mSortedSprites[pos]->texture;
 
@@ -646,77 +725,95 @@ void SpriteBatch::Impl::FlushBatch()
     }
 
     // Flush the final batch.
-    RenderBatch(batchTexture, &mSortedSprites[batchStart], mSpriteQueueCount - batchStart);
-
-    // Reset the queue.
-    mSpriteQueueCount = 0;
-    mSpriteTextureReferences.clear();
+    RenderBatch(batchTexture, &mSortedSprites[batchStart], spriteCount - batchStart);
 
-    // When sorting is disabled, we persist mSortedSprites data from one batch to the next, to avoid
-    // uneccessary work in GrowSortedSprites. But we never reuse these when sorting, because re-sorting
-    // previously sorted items gives unstable ordering if some sprites have identical sort keys.
-    if (mSortMode != SpriteSortMode_Deferred)
+    // Reset the queues.
+    for (auto& queue : mSpriteQueues)
     {
-        mSortedSprites.clear();
+        queue->Reset();
     }
 }
 
 
-// Sorts the array of queued sprites.
-void SpriteBatch::Impl::SortSprites()
+// Merges the per-thread queues into the mSortedSprites vector, returning the number of queued sprites.
+// Sprites from each thread stay in submission order, and threads are visited in the order they first drew.
+size_t SpriteBatch::Impl::GatherSprites()
 {
-    // Fill the mSortedSprites vector.
-    if (mSortedSprites.size() < mSpriteQueueCount)
+    size_t spriteCount = 0;
+
+    for (auto const& queue : mSpriteQueues)
     {
-        GrowSortedSprites();
+        spriteCount += queue->count;
     }
 
-    switch (mSortMode)
+    if (mSortedSprites.size() < spriteCount)
     {
-        case SpriteSortMode_Texture:
-            // Sort by texture.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-                [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
-                {
-                    return x->texture < y->texture;
-                });
-            break;
+        mSortedSprites.resize(spriteCount);
+    }
 
-        case SpriteSortMode_BackToFront:
-            // Sort back to front.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-                [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
-                {
-                    return x->originRotationDepth.w > y->originRotationDepth.w;
-                });
-            break;
+    auto output = mSortedSprites.begin();
 
-        case SpriteSortMode_FrontToBack:
-            // Sort front to back.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-                [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
-                {
-                    return x->originRotationDepth.w < y->originRotationDepth.w;
-                });
-            break;
+    for (auto const& queue : mSpriteQueues)
+    {
+        for (size_t i = 0; i < queue->count; i += QueueChunkSize)
+        {
+            SpriteInfo const* chunk = queue->chunks[i / QueueChunkSize].get();
 
-        default:
-            break;
+            const size_t chunkCount = std::min(queue->count - i, QueueChunkSize);
+
+            for (size_t j = 0; j < chunkCount; j++)
+            {
+                *output++ = &chunk[j];
+            }
+        }
     }
+
+    return spriteCount;
 }
 
 
-// Populates the mSortedSprites vector with pointers to individual elements of the mSpriteQueue array.
-void SpriteBatch::Impl::GrowSortedSprites()
+// Sorts the array of queued sprites.
+void SpriteBatch::Impl::SortSprites(size_t count)
 {
-    const size_t previousSize = mSortedSprites.size();
+    if (mSortMode != SpriteSortMode_Texture &&
+        mSortMode != SpriteSortMode_BackToFront &&
+        mSortMode != SpriteSortMode_FrontToBack)
+    {
+        return;
+    }
 
-    mSortedSprites.resize(mSpriteQueueCount);
+    if (mSortKeys.size() < count)
+    {
+        mSortKeys.resize(count);
+        mSortScratchKeys.resize(count);
+        mSortScratchSprites.resize(count);
+    }
 
-    for (size_t i = previousSize; i < mSpriteQueueCount; i++)
+    // Build integer sort keys, so the sprites can be ordered using a stable radix sort.
+    for (size_t i = 0; i < count; i++)
     {
-        mSortedSprites[i] = &mSpriteQueue[i];
+        SpriteInfo const* sprite = mSortedSprites[i];
+
+        switch (mSortMode)
+        {
+            case SpriteSortMode_Texture:
+                // Sort by texture.
+                mSortKeys[i] = reinterpret_cast<uintptr_t>(sprite->texture);
+                break;
+
+            case SpriteSortMode_BackToFront:
+                // Sort back to front.
+                mSortKeys[i] = ~SpriteBatchCore::DepthSortKey(sprite->originRotationDepth.w);
+                break;
+
+            default:
+                // Sort front to back.
+                mSortKeys[i] = SpriteBatchCore::DepthSortKey(sprite->originRotationDepth.w);
+                break;
+        }
     }
+
+    SpriteBatchCore::RadixSort(mSortKeys.data(), mSortedSprites.data(), mSortScratchKeys.data(), mSortScratchSprites.data(), count);
 }
 
 
@@ -778,7 +875,7 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
         {
             assert(i < count);
             _Analysis_assume_(i < count);
-            RenderSprite(sprites[i], vertices, textureSize, inverseTextureSize);
+            SpriteBatchCore::RenderSprite(sprites[i], vertices, textureSize, inverseTextureSize);
 
             vertices += VerticesPerSprite;
         }
@@ -806,121 +903,6 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 }
 
 
-// Generates vertex data for drawing a single sprite.
-_Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Impl::RenderSprite(SpriteInfo const* sprite,
-    VertexPositionColorTexture* vertices,
-    FXMVECTOR textureSize,
-    FXMVECTOR inverseTextureSize)
-{
-    // Load sprite parameters into SIMD registers.
-    XMVECTOR source = XMLoadFloat4A(&sprite->source);
-    const XMVECTOR destination = XMLoadFloat4A(&sprite->destination);
-    const XMVECTOR color = XMLoadFloat4A(&sprite->color);
-    const XMVECTOR originRotationDepth = XMLoadFloat4A(&sprite->originRotationDepth);
-
-    const float rotation = sprite->originRotationDepth.z;
-    const unsigned int flags = sprite->flags;
-
-    // Extract the source and destination sizes into separate vectors.
-    XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
-    XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
-
-    // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
-    const XMVECTOR isZeroMask = XMVectorEqual(sourceSize, XMVectorZero());
-    const XMVECTOR nonZeroSourceSize = XMVectorSelect(sourceSize, g_XMEpsilon, isZeroMask);
-
-    XMVECTOR origin = XMVectorDivide(originRotationDepth, nonZeroSourceSize);
-
-    // Convert the source region from texels to mod-1 texture coordinate format.
-    if (flags & SpriteInfo::SourceInTexels)
-    {
-        source = XMVectorMultiply(source, inverseTextureSize);
-        sourceSize = XMVectorMultiply(sourceSize, inverseTextureSize);
-    }
-    else
-    {
-        origin = XMVectorMultiply(origin, inverseTextureSize);
-    }
-
-    // If the destination size is relative to the source region, convert it to pixels.
-    if (!(flags & SpriteInfo::DestSizeInPixels))
-    {
-        destinationSize = XMVectorMultiply(destinationSize, textureSize);
-    }
-
-    // Compute a 2x2 rotation matrix.
-    XMVECTOR rotationMatrix1;
-    XMVECTOR rotationMatrix2;
-
-    if (rotation != 0)
-    {
-        float sin, cos;
-
-        XMScalarSinCos(&sin, &cos, rotation);
-
-        const XMVECTOR sinV = XMLoadFloat(&sin);
-        const XMVECTOR cosV = XMLoadFloat(&cos);
-
-        rotationMatrix1 = XMVectorMergeXY(cosV, sinV);
-        rotationMatrix2 = XMVectorMergeXY(XMVectorNegate(sinV), cosV);
-    }
-    else
-    {
-        rotationMatrix1 = g_XMIdentityR0;
-        rotationMatrix2 = g_XMIdentityR1;
-    }
-
-    // The four corner vertices are computed by transforming these unit-square positions.
-    static XMVECTORF32 cornerOffsets[VerticesPerSprite] =
-    {
-        { { { 0, 0, 0, 0 } } },
-        { { { 1, 0, 0, 0 } } },
-        { { { 0, 1, 0, 0 } } },
-        { { { 1, 1, 0, 0 } } },
-    };
-
-    // Tricksy alert! Texture coordinates are computed from the same cornerOffsets
-    // table as vertex positions, but if the sprite is mirrored, this table
-    // must be indexed in a different order. This is done as follows:
-    //
-    //    position = cornerOffsets[i]
-    //    texcoord = cornerOffsets[i ^ SpriteEffects]
-
-    static_assert(SpriteEffects_FlipHorizontally == 1 &&
-                  SpriteEffects_FlipVertically == 2, "If you change these enum values, the mirroring implementation must be updated to match");
-
-    const unsigned int mirrorBits = flags & 3u;
-
-    // Generate the four output vertices.
-    for (size_t i = 0; i < VerticesPerSprite; i++)
-    {
-        // Calculate position.
-        const XMVECTOR cornerOffset = XMVectorMultiply(XMVectorSubtract(cornerOffsets[i], origin), destinationSize);
-
-        // Apply 2x2 rotation matrix.
-        const XMVECTOR position1 = XMVectorMultiplyAdd(XMVectorSplatX(cornerOffset), rotationMatrix1, destination);
-        const XMVECTOR position2 = XMVectorMultiplyAdd(XMVectorSplatY(cornerOffset), rotationMatrix2, position1);
-
-        // Set z = depth.
-        const XMVECTOR position = XMVectorPermute<0, 1, 7, 6>(position2, originRotationDepth);
-
-        // Write position as a Float4, even though VertexPositionColor::position is an XMFLOAT3.
-        // This is faster, and harmless as we are just clobbering the first element of the
-        // following color field, which will immediately be overwritten with its correct value.
-        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertices[i].position), position);
-
-        // Write the color.
-        XMStoreFloat4(&vertices[i].color, color);
-
-        // Compute and write the texture coordinate.
-        const XMVECTOR textureCoordinate = XMVectorMultiplyAdd(cornerOffsets[static_cast<unsigned int>(i) ^ mirrorBits], sourceSize, source);
-
-        XMStoreFloat2(&vertices[i].textureCoordinate, textureCoordinate);
-    }
-}
-
-
 // Helper looks up the size of the specified texture.
 XMVECTOR SpriteBatch::Impl::GetTextureSize(_In_ ID3D11ShaderResourceView* texture)
 {
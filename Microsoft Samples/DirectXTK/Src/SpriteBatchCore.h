@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteBatchCore.h
+//
+// Platform-neutral sprite sorting and vertex generation used by SpriteBatch
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <DirectXMath.h>
+
+
+namespace DirectX
+{
+    namespace SpriteBatchCore
+    {
+        //--------------------------------------------------------------------------------------
+        // Converts a sprite depth into an unsigned key with the same ordering, so that
+        // sprites can be sorted by depth using integer radix passes
+        //--------------------------------------------------------------------------------------
+        inline uint32_t DepthSortKey(float depth) noexcept
+        {
+            uint32_t bits;
+            memcpy(&bits, &depth, sizeof(bits));
+
+            // Negative zero sorts together with positive zero.
+            if (bits == 0x80000000u)
+                bits = 0;
+
+            // Positive values only need the sign bit set to sort above negative values,
+            // but negative values sort in reverse order of their magnitude bits.
+            return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        }
+
+
+        //--------------------------------------------------------------------------------------
+        // Stable LSD radix sort of values by 64-bit key, one byte per pass.
+        //
+        // The histograms for all passes are built with a single read of the keys, and passes
+        // over bytes that are the same for every key (such as the high bytes of depth keys or
+        // of texture pointers) are skipped. The scratch arrays must hold count elements each.
+        //--------------------------------------------------------------------------------------
+        template<typename TValue>
+        void RadixSort(
+            _Inout_updates_(count) uint64_t* keys,
+            _Inout_updates_(count) TValue* values,
+            _Out_writes_(count) uint64_t* scratchKeys,
+            _Out_writes_(count) TValue* scratchValues,
+            size_t count)
+        {
+            constexpr size_t RadixBits = 8;
+            constexpr size_t RadixSize = size_t(1) << RadixBits;
+            constexpr size_t PassCount = (sizeof(uint64_t) * 8) / RadixBits;
+
+            if (count < 2)
+                return;
+
+            std::array<std::array<size_t, RadixSize>, PassCount> histograms = {};
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint64_t key = keys[i];
+
+                for (size_t pass = 0; pass < PassCount; ++pass)
+                {
+                    ++histograms[pass][key & (RadixSize - 1)];
+                    key >>= RadixBits;
+                }
+            }
+
+            uint64_t* srcKeys = keys;
+            TValue* srcValues = values;
+            uint64_t* dstKeys = scratchKeys;
+            TValue* dstValues = scratchValues;
+
+            for (size_t pass = 0; pass < PassCount; ++pass)
+            {
+                auto& histogram = histograms[pass];
+                const size_t shift = pass * RadixBits;
+
+                // If every key has the same digit, this pass would not change the order.
+                if (histogram[(srcKeys[0] >> shift) & (RadixSize - 1)] == count)
+                    continue;
+
+                // Turn the digit counts into output offsets.
+                size_t offset = 0;
+                for (size_t digit = 0; digit < RadixSize; ++digit)
+                {
+                    const size_t digitCount = histogram[digit];
+                    histogram[digit] = offset;
+                    offset += digitCount;
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const size_t dstIndex = histogram[(srcKeys[i] >> shift) & (RadixSize - 1)]++;
+
+                    dstKeys[dstIndex] = srcKeys[i];
+                    dstValues[dstIndex] = srcValues[i];
+                }
+
+                std::swap(srcKeys, dstKeys);
+                std::swap(srcValues, dstValues);
+            }
+
+            // Make sure the result ends up in the caller's arrays.
+            if (srcKeys != keys)
+            {
+                std::copy(srcKeys, srcKeys + count, keys);
+                std::copy(srcValues, srcValues + count, values);
+            }
+        }
+
+
+        //--------------------------------------------------------------------------------------
+        // Generates vertex data for drawing a single sprite.
+        //
+        // TSprite must provide source, destination, color and originRotationDepth as XMFLOAT4A,
+        // plus flags using its SourceInTexels and DestSizeInPixels bits along with the two
+        // SpriteEffects mirroring bits. TVertex must provide position, color and textureCoordinate
+        // with the layout of VertexPositionColorTexture.
+        //--------------------------------------------------------------------------------------
+        template<typename TSprite, typename TVertex>
+        void XM_CALLCONV RenderSprite(
+            _In_ TSprite const* sprite,
+            _Out_writes_(4) TVertex* vertices,
+            FXMVECTOR textureSize,
+            FXMVECTOR inverseTextureSize) noexcept
+        {
+            constexpr size_t VerticesPerSprite = 4;
+
+            // Load sprite parameters into SIMD registers.
+            XMVECTOR source = XMLoadFloat4A(&sprite->source);
+            const XMVECTOR destination = XMLoadFloat4A(&sprite->destination);
+            const XMVECTOR color = XMLoadFloat4A(&sprite->color);
+            const XMVECTOR originRotationDepth = XMLoadFloat4A(&sprite->originRotationDepth);
+
+            const float rotation = sprite->originRotationDepth.z;
+            const unsigned int flags = sprite->flags;
+
+            // Extract the source and destination sizes into separate vectors.
+            XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
+            XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
+
+            // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+            const XMVECTOR isZeroMask = XMVectorEqual(sourceSize, XMVectorZero());
+            const XMVECTOR nonZeroSourceSize = XMVectorSelect(sourceSize, g_XMEpsilon, isZeroMask);
+
+            XMVECTOR origin = XMVectorDivide(originRotationDepth, nonZeroSourceSize);
+
+            // Convert the source region from texels to mod-1 texture coordinate format.
+            if (flags & TSprite::SourceInTexels)
+            {
+                source = XMVectorMultiply(source, inverseTextureSize);
+                sourceSize = XMVectorMultiply(sourceSize, inverseTextureSize);
+            }
+            else
+            {
+                origin = XMVectorMultiply(origin, inverseTextureSize);
+            }
+
+            // If the destination size is relative to the source region, convert it to pixels.
+            if (!(flags & TSprite::DestSizeInPixels))
+            {
+                destinationSize = XMVectorMultiply(destinationSize, textureSize);
+            }
+
+            // Compute a 2x2 rotation matrix.
+            XMVECTOR rotationMatrix1;
+            XMVECTOR rotationMatrix2;
+
+            if (rotation != 0)
+            {
+                float sin, cos;
+
+                XMScalarSinCos(&sin, &cos, rotation);
+
+                const XMVECTOR sinV = XMLoadFloat(&sin);
+                const XMVECTOR cosV = XMLoadFloat(&cos);
+
+                rotationMatrix1 = XMVectorMergeXY(cosV, sinV);
+                rotationMatrix2 = XMVectorMergeXY(XMVectorNegate(sinV), cosV);
+            }
+            else
+            {
+                rotationMatrix1 = g_XMIdentityR0;
+                rotationMatrix2 = g_XMIdentityR1;
+            }
+
+            // The four corner vertices are computed by transforming these unit-square positions.
+            static const XMVECTORF32 cornerOffsets[VerticesPerSprite] =
+            {
+                { { { 0, 0, 0, 0 } } },
+                { { { 1, 0, 0, 0 } } },
+                { { { 0, 1, 0, 0 } } },
+                { { { 1, 1, 0, 0 } } },
+            };
+
+            // Tricksy alert! Texture coordinates are computed from the same cornerOffsets
+            // table as vertex positions, but if the sprite is mirrored, this table
+            // must be indexed in a different order. This is done as follows:
+            //
+            //    position = cornerOffsets[i]
+            //    texcoord = cornerOffsets[i ^ SpriteEffects]
+            const unsigned int mirrorBits = flags & 3u;
+
+            // Generate the four output vertices.
+            for (size_t i = 0; i < VerticesPerSprite; i++)
+            {
+                // Calculate position.
+                const XMVECTOR cornerOffset = XMVectorMultiply(XMVectorSubtract(cornerOffsets[i], origin), destinationSize);
+
+                // Apply 2x2 rotation matrix.
+                const XMVECTOR position1 = XMVectorMultiplyAdd(XMVectorSplatX(cornerOffset), rotationMatrix1, destination);
+                const XMVECTOR position2 = XMVectorMultiplyAdd(XMVectorSplatY(cornerOffset), rotationMatrix2, position1);
+
+                // Set z = depth.
+                const XMVECTOR position = XMVectorPermute<0, 1, 7, 6>(position2, originRotationDepth);
+
+                // Write position as a Float4, even though VertexPositionColor::position is an XMFLOAT3.
+                // This is faster, and harmless as we are just clobbering the first element of the
+                // following color field, which will immediately be overwritten with its correct value.
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertices[i].position), position);
+
+                // Write the color.
+                XMStoreFloat4(&vertices[i].color, color);
+
+                // Compute and write the texture coordinate.
+                const XMVECTOR textureCoordinate = XMVectorMultiplyAdd(cornerOffsets[static_cast<unsigned int>(i) ^ mirrorBits], sourceSize, source);
+
+                XMStoreFloat2(&vertices[i].textureCoordinate, textureCoordinate);
+            }
+        }
+    }
+}
@@ -16,6 +16,9 @@
 #include "DirectXHelpers.h"
 #include "BinaryReader.h"
 #include "LoaderHelpers.h"
+#include "SpriteFontCore.h"
+
+#include <mutex>
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -36,10 +39,15 @@ public:
     Glyph const* FindGlyph(wchar_t character) const;
 
     void SetDefaultCharacter(wchar_t character);
+    void SetLineSpacing(float spacing);
+    void SetLayoutCacheSize(size_t maxStrings);
 
     template<typename TAction>
     void ForEachGlyph(_In_z_ wchar_t const* text, TAction action, bool ignoreWhitespace) const;
 
+    template<typename TAction>
+    void LayoutGlyphs(_In_z_ wchar_t const* text, TAction action, bool ignoreWhitespace) const;
+
     void CreateTextureResource(_In_ ID3D11Device* device,
         uint32_t width, uint32_t height,
         DXGI_FORMAT format,
@@ -51,13 +59,17 @@ public:
     // Fields.
     ComPtr<ID3D11ShaderResourceView> texture;
     std::vector<Glyph> glyphs;
-    std::vector<uint32_t> glyphsIndex;
+    SpriteFontCore::GlyphTable glyphTable;
     Glyph const* defaultGlyph;
     float lineSpacing;
 
 private:
     size_t utfBufferSize;
     std::unique_ptr<wchar_t[]> utfBuffer;
+
+    // Optional cache of laid out strings, disabled unless SetLayoutCacheSize is called.
+    mutable SpriteFontCore::LayoutCache<Glyph> layoutCache;
+    mutable std::mutex layoutCacheMutex;
 };
 
 
@@ -67,23 +79,13 @@ const XMFLOAT2 SpriteFont::Float2Zero(0, 0);
 static const char spriteFontMagic[] = "DXTKfont";
 
 
-// Comparison operators make our sorted glyph vector work with std::binary_search and lower_bound.
+// Comparison operator lets us validate that user specified glyphs are sorted with std::is_sorted.
 namespace DirectX
 {
     static inline bool operator< (SpriteFont::Glyph const& left, SpriteFont::Glyph const& right) noexcept
     {
         return left.Character < right.Character;
     }
-
-    static inline bool operator< (wchar_t left, SpriteFont::Glyph const& right) noexcept
-    {
-        return left < right.Character;
-    }
-
-    static inline bool operator< (SpriteFont::Glyph const& left, wchar_t right) noexcept
-    {
-        return left.Character < right;
-    }
 }
 
 
@@ -112,12 +114,7 @@ SpriteFont::Impl::Impl(
     auto glyphData = reader->ReadArray<Glyph>(glyphCount);
 
     glyphs.assign(glyphData, glyphData + glyphCount);
-    glyphsIndex.reserve(glyphs.size());
-
-    for (auto& glyph : glyphs)
-    {
-        glyphsIndex.emplace_back(glyph.Character);
-    }
+    glyphTable.Build(glyphs.data(), glyphs.size());
 
     // Read font properties.
     lineSpacing = reader->Read<float>();
@@ -173,51 +170,20 @@ SpriteFont::Impl::Impl(
         throw std::runtime_error("Glyphs must be in ascending codepoint order");
     }
 
-    glyphsIndex.reserve(glyphs.size());
-
-    for (auto& glyph : glyphs)
-    {
-        glyphsIndex.emplace_back(glyph.Character);
-    }
+    glyphTable.Build(glyphs.data(), glyphs.size());
 }
 
 
 // Looks up the requested glyph, falling back to the default character if it is not in the font.
 SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
 {
-    // Rather than use std::lower_bound (which includes a slow debug path when built for _DEBUG),
-    // we implement a binary search inline to ensure sufficient Debug build performance to be useful
-    // for text-heavy applications.
-
-    size_t lower = 0;
-    size_t higher = glyphs.size() - 1;
-    size_t index = higher / 2;
-    const size_t size = glyphs.size();
+    // The glyph table gives constant time lookups, which also keeps Debug builds fast enough
+    // to be useful for text-heavy applications.
+    const uint32_t index = glyphTable.Find(static_cast<uint32_t>(character));
 
-    while (index < size)
+    if (index != SpriteFontCore::GlyphTable::InvalidIndex)
     {
-        const auto curChar = glyphsIndex[index];
-        if (curChar == character) { return &glyphs[index]; }
-        if (curChar < character)
-        {
-            lower = index + 1;
-        }
-        else
-        {
-            higher = index - 1;
-        }
-        if (higher < lower) { break; }
-        else if (higher - lower <= 4)
-        {
-            for (index = lower; index <= higher; index++)
-            {
-                if (glyphsIndex[index] == character)
-                {
-                    return &glyphs[index];
-                }
-            }
-        }
-        index = lower + ((higher - lower) / 2);
+        return &glyphs[index];
     }
 
     if (defaultGlyph)
@@ -230,7 +196,7 @@ SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
 }
 
 
-// Sets the missing-character fallback glyph.
+// Sets the missing-character fallback glyph, which invalidates any cached layouts.
 void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
 {
     defaultGlyph = nullptr;
@@ -239,12 +205,74 @@ void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
     {
         defaultGlyph = FindGlyph(character);
     }
+
+    const std::lock_guard<std::mutex> lock(layoutCacheMutex);
+
+    layoutCache.Clear();
 }
 
 
-// The core glyph layout algorithm, shared between DrawString and MeasureString.
+// Sets the line spacing, which invalidates any cached layouts.
+void SpriteFont::Impl::SetLineSpacing(float spacing)
+{
+    lineSpacing = spacing;
+
+    const std::lock_guard<std::mutex> lock(layoutCacheMutex);
+
+    layoutCache.Clear();
+}
+
+
+// Sets the maximum number of strings whose layout is cached, or disables caching if zero.
+void SpriteFont::Impl::SetLayoutCacheSize(size_t maxStrings)
+{
+    const std::lock_guard<std::mutex> lock(layoutCacheMutex);
+
+    layoutCache.SetMaxEntries(maxStrings);
+}
+
+
+// Invokes the action for each glyph of the string, replaying a cached layout when one is available.
 template<typename TAction>
 void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action, bool ignoreWhitespace) const
+{
+    std::unique_lock<std::mutex> lock(layoutCacheMutex);
+
+    if (!layoutCache.GetMaxEntries())
+    {
+        lock.unlock();
+
+        LayoutGlyphs(text, action, ignoreWhitespace);
+        return;
+    }
+
+    size_t length;
+    const uint64_t hash = SpriteFontCore::LayoutCache<Glyph>::Hash(text, ignoreWhitespace, &length);
+
+    auto items = layoutCache.Find(hash, text, length, ignoreWhitespace);
+
+    if (!items)
+    {
+        SpriteFontCore::LayoutCache<Glyph>::Items newItems;
+
+        LayoutGlyphs(text, [&](Glyph const* glyph, float x, float y, float advance)
+        {
+            newItems.push_back({ glyph, x, y, advance });
+        }, ignoreWhitespace);
+
+        items = layoutCache.Insert(hash, text, length, ignoreWhitespace, std::move(newItems));
+    }
+
+    for (auto const& item : *items)
+    {
+        action(item.glyph, item.x, item.y, item.advance);
+    }
+}
+
+
+// The core glyph layout algorithm, shared between DrawString and MeasureString.
+template<typename TAction>
+void SpriteFont::Impl::LayoutGlyphs(_In_z_ wchar_t const* text, TAction action, bool ignoreWhitespace) const
 {
     float x = 0;
     float y = 0;
@@ -599,7 +627,7 @@ float SpriteFont::GetLineSpacing() const noexcept
 
 void SpriteFont::SetLineSpacing(float spacing)
 {
-    pImpl->lineSpacing = spacing;
+    pImpl->SetLineSpacing(spacing);
 }
 
 
@@ -618,7 +646,14 @@ void SpriteFont::SetDefaultCharacter(wchar_t character)
 
 bool SpriteFont::ContainsCharacter(wchar_t character) const
 {
-    return std::binary_search(pImpl->glyphs.begin(), pImpl->glyphs.end(), character);
+    return pImpl->glyphTable.Find(static_cast<uint32_t>(character)) != SpriteFontCore::GlyphTable::InvalidIndex;
+}
+
+
+// Layout caching
+void SpriteFont::SetLayoutCacheSize(size_t maxStrings)
+{
+    pImpl->SetLayoutCacheSize(maxStrings);
 }
 
 
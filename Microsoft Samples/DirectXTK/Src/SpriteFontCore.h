@@ -0,0 +1,218 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontCore.h
+//
+// Platform-neutral glyph lookup and text layout caching used by SpriteFont
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace SpriteFontCore
+    {
+        //--------------------------------------------------------------------------------------
+        // Maps character codes to glyph indices in constant time.
+        //
+        // Code points in the Basic Multilingual Plane are grouped into pages of 256. Pages
+        // holding enough glyphs to be worth it (such as ASCII, Latin-1 or a CJK block) are
+        // indexed directly, and the remaining code points go into a hash table.
+        //--------------------------------------------------------------------------------------
+        class GlyphTable
+        {
+        public:
+            static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+            GlyphTable() noexcept
+            {
+                mPageOffsets.fill(InvalidIndex);
+            }
+
+            template<typename TGlyph>
+            void Build(_In_reads_(count) TGlyph const* glyphs, size_t count)
+            {
+                mPageOffsets.fill(InvalidIndex);
+                mEntries.clear();
+                mSparseEntries.clear();
+
+                // Count the glyphs in each page to decide which pages get a direct table.
+                std::array<uint32_t, PageCount> pageGlyphCounts = {};
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const uint32_t character = glyphs[i].Character;
+
+                    if (character < DirectRange)
+                    {
+                        ++pageGlyphCounts[character >> PageBits];
+                    }
+                }
+
+                for (size_t page = 0; page < PageCount; ++page)
+                {
+                    if (pageGlyphCounts[page] >= MinGlyphsPerPage)
+                    {
+                        mPageOffsets[page] = static_cast<uint32_t>(mEntries.size());
+                        mEntries.resize(mEntries.size() + PageSize, InvalidIndex);
+                    }
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const uint32_t character = glyphs[i].Character;
+                    const uint32_t index = static_cast<uint32_t>(i);
+
+                    if (character < DirectRange && mPageOffsets[character >> PageBits] != InvalidIndex)
+                    {
+                        mEntries[mPageOffsets[character >> PageBits] + (character & (PageSize - 1))] = index;
+                    }
+                    else
+                    {
+                        mSparseEntries[character] = index;
+                    }
+                }
+            }
+
+            // Returns the index of the glyph for the given character, or InvalidIndex if the font does not contain it.
+            uint32_t Find(uint32_t character) const noexcept
+            {
+                if (character < DirectRange)
+                {
+                    const uint32_t pageOffset = mPageOffsets[character >> PageBits];
+
+                    if (pageOffset != InvalidIndex)
+                        return mEntries[pageOffset + (character & (PageSize - 1))];
+                }
+
+                if (mSparseEntries.empty())
+                    return InvalidIndex;
+
+                auto it = mSparseEntries.find(character);
+
+                return (it != mSparseEntries.end()) ? it->second : InvalidIndex;
+            }
+
+        private:
+            static constexpr uint32_t DirectRange = 0x10000;
+            static constexpr uint32_t PageBits = 8;
+            static constexpr uint32_t PageSize = 1u << PageBits;
+            static constexpr size_t PageCount = DirectRange >> PageBits;
+            static constexpr uint32_t MinGlyphsPerPage = 8;
+
+            std::array<uint32_t, PageCount> mPageOffsets;
+            std::vector<uint32_t> mEntries;
+            std::unordered_map<uint32_t, uint32_t> mSparseEntries;
+        };
+
+
+        //--------------------------------------------------------------------------------------
+        // Caches the result of laying out a string, so that text which does not change from
+        // frame to frame (HUD labels, menus) can be emitted without looking up and positioning
+        // each glyph again. Entries are keyed by a hash of the string, and hold a copy of it so
+        // hash collisions are detected. The cache is emptied when it reaches its maximum size.
+        //--------------------------------------------------------------------------------------
+        template<typename TGlyph>
+        class LayoutCache
+        {
+        public:
+            // A glyph positioned relative to the start of the string.
+            struct Item
+            {
+                TGlyph const* glyph;
+                float x;
+                float y;
+                float advance;
+            };
+
+            using Items = std::vector<Item>;
+
+            LayoutCache() noexcept : mMaxEntries(0) {}
+
+            size_t GetMaxEntries() const noexcept { return mMaxEntries; }
+
+            void SetMaxEntries(size_t maxEntries)
+            {
+                mMaxEntries = maxEntries;
+
+                if (mEntries.size() > mMaxEntries)
+                    mEntries.clear();
+            }
+
+            void Clear() noexcept { mEntries.clear(); }
+
+            // Hashes a null terminated string (FNV-1a), also returning its length.
+            static uint64_t Hash(_In_z_ wchar_t const* text, bool ignoreWhitespace, _Out_ size_t* length) noexcept
+            {
+                uint64_t hash = 14695981039346656037ull ^ (ignoreWhitespace ? 0u : 1u);
+                size_t count = 0;
+
+                for (; text[count]; ++count)
+                {
+                    hash ^= static_cast<uint64_t>(text[count]);
+                    hash *= 1099511628211ull;
+                }
+
+                *length = count;
+
+                return hash;
+            }
+
+            // Returns the cached layout of a string, or nullptr if it has not been cached.
+            Items const* Find(uint64_t hash, _In_reads_(length) wchar_t const* text, size_t length, bool ignoreWhitespace) const
+            {
+                auto it = mEntries.find(hash);
+
+                if (it == mEntries.end()
+                    || it->second.ignoreWhitespace != ignoreWhitespace
+                    || it->second.text.compare(0, std::wstring::npos, text, length) != 0)
+                {
+                    return nullptr;
+                }
+
+                return &it->second.items;
+            }
+
+            // Stores the layout of a string, replacing any entry with the same hash.
+            Items const* Insert(uint64_t hash, _In_reads_(length) wchar_t const* text, size_t length, bool ignoreWhitespace, Items&& items)
+            {
+                if (!mMaxEntries)
+                    return nullptr;
+
+                if (mEntries.size() >= mMaxEntries && mEntries.find(hash) == mEntries.end())
+                    mEntries.clear();
+
+                auto& entry = mEntries[hash];
+
+                entry.text.assign(text, length);
+                entry.ignoreWhitespace = ignoreWhitespace;
+                entry.items = std::move(items);
+
+                return &entry.items;
+            }
+
+        private:
+            struct Entry
+            {
+                std::wstring text;
+                bool ignoreWhitespace;
+                Items items;
+            };
+
+            size_t mMaxEntries;
+            std::unordered_map<uint64_t, Entry> mEntries;
+        };
+    }
+}
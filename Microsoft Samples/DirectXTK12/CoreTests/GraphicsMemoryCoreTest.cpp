@@ -0,0 +1,370 @@
+//--------------------------------------------------------------------------------------
+// File: GraphicsMemoryCoreTest.cpp
+//
+// Checks the per-thread page caches used by GraphicsMemory against a page source that
+// tracks every page, with many threads allocating while frames are committed, and compares
+// their speed with allocating from one locked page
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "GraphicsMemoryCore.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace DirectX::GraphicsMemoryCore;
+
+namespace
+{
+    constexpr size_t c_PageSize = 65536;
+
+    // Only pages the test writes to have memory behind them, so the benchmarks measure the
+    // allocators rather than the heap.
+    class TestPage
+    {
+    public:
+        explicit TestPage(bool backed) : mUsed(0), mWriters(0), mMemory(backed ? c_PageSize : 0) {}
+
+        size_t BytesUsed() const noexcept { return mUsed; }
+        size_t Size() const noexcept { return c_PageSize; }
+
+        size_t Suballocate(size_t size, size_t alignment)
+        {
+            const size_t offset = (mUsed + alignment - 1) & ~(alignment - 1);
+            if (offset + size > c_PageSize)
+                throw std::logic_error("Suballocate called without room in the page");
+            mUsed = offset + size;
+            return offset;
+        }
+
+        void Reset() noexcept { mUsed = 0; }
+
+        std::atomic<int>& Writers() noexcept { return mWriters; }
+        uint8_t* Memory() noexcept { return mMemory.data(); }
+
+    private:
+        size_t mUsed;
+        std::atomic<int> mWriters;
+        std::vector<uint8_t> mMemory;
+    };
+
+    // A shared page pool that checks every page it hands out comes back exactly once, and
+    // whose "GPU fence" completes as soon as a frame is committed.
+    class TestPageSource
+    {
+    public:
+        using Caches = ThreadPageCacheSet<TestPage, TestPageSource, 5, 4>;
+
+        explicit TestPageSource(size_t pageLimit = 0, bool backed = true) :
+            mPageLimit(pageLimit),
+            mBacked(backed),
+            mExchanges(0),
+            mErrors(0)
+        {
+        }
+
+        size_t ExchangePages(size_t, TestPage* const* retired, size_t retiredCount, TestPage** acquired, size_t acquireCount)
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+
+            ++mExchanges;
+
+            for (size_t j = 0; j < retiredCount; ++j)
+            {
+                if (mOutstanding.erase(retired[j]) != 1)
+                    ++mErrors;
+
+                if (retired[j]->BytesUsed())
+                    mPendingPages.push_back(retired[j]);
+                else
+                    mFreePages.push_back(retired[j]);
+            }
+
+            size_t count = 0;
+            for (; count < acquireCount; ++count)
+            {
+                TestPage* page;
+                if (!mFreePages.empty())
+                {
+                    page = mFreePages.back();
+                    mFreePages.pop_back();
+                }
+                else if (!mPageLimit || mPages.size() < mPageLimit)
+                {
+                    mPages.emplace_back(std::make_unique<TestPage>(mBacked));
+                    page = mPages.back().get();
+                }
+                else
+                {
+                    break;
+                }
+
+                if (page->BytesUsed() || !mOutstanding.insert(page).second)
+                    ++mErrors;
+
+                acquired[count] = page;
+            }
+
+            return count;
+        }
+
+        // Takes back the pages of idle caches and recycles everything used so far.
+        void Commit()
+        {
+            mCaches.FlushIdle(*this);
+
+            const std::lock_guard<std::mutex> lock(mMutex);
+            for (auto page : mPendingPages)
+            {
+                page->Reset();
+                mFreePages.push_back(page);
+            }
+            mPendingPages.clear();
+        }
+
+        Caches& GetCaches() noexcept { return mCaches; }
+
+        size_t OutstandingPages() const
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+            return mOutstanding.size();
+        }
+
+        size_t Errors() const
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+            return mErrors;
+        }
+
+        size_t Exchanges() const
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+            return mExchanges;
+        }
+
+    private:
+        mutable std::mutex mMutex;
+        std::vector<std::unique_ptr<TestPage>> mPages;
+        std::vector<TestPage*> mFreePages;
+        std::vector<TestPage*> mPendingPages;
+        std::set<TestPage*> mOutstanding;
+        size_t mPageLimit;
+        bool mBacked;
+        size_t mExchanges;
+        size_t mErrors;
+        Caches mCaches;
+    };
+
+    // Allocates and fills memory from the calling thread's cache until told to stop. Returns
+    // the number of allocations made, and counts anything that went wrong in failures.
+    size_t AllocateUntilStopped(TestPageSource& source, int id, const std::atomic<bool>& stop, std::atomic<size_t>& failures)
+    {
+        size_t count = 0;
+        uint32_t rng = 1234u + uint32_t(id);
+
+        while (!stop.load())
+        {
+            rng = rng * 1664525u + 1013904223u;
+            const size_t alignment = size_t(16) << (rng >> 30);
+            const size_t size = 16 + (rng >> 8) % 4000;
+
+            auto cache = source.GetCaches().Enter();
+            if (!cache)
+                continue;   // Being flushed by the committing thread
+
+            size_t offset = 0;
+            TestPage* page = cache->Allocate(source, size_t(id) % 5, size, alignment, offset);
+            if (!page || (offset % alignment) != 0 || offset + size > page->Size())
+            {
+                ++failures;
+                continue;
+            }
+
+            // No other thread may be writing to the same page.
+            if (page->Writers().fetch_add(1) != 0)
+                ++failures;
+
+            memset(page->Memory() + offset, id, size);
+            for (size_t k = 0; k < size; k += 97)
+            {
+                if (page->Memory()[offset + k] != uint8_t(id))
+                    ++failures;
+            }
+
+            page->Writers().fetch_sub(1);
+            ++count;
+        }
+
+        return count;
+    }
+
+    void TestConcurrentAllocation()
+    {
+        TestPageSource source;
+        std::atomic<bool> stop(false);
+        std::atomic<size_t> failures(0);
+        std::atomic<size_t> total(0);
+
+        std::vector<std::thread> threads;
+        for (int id = 0; id < 8; ++id)
+        {
+            threads.emplace_back([&, id]()
+                {
+                    total += AllocateUntilStopped(source, id, stop, failures);
+                });
+        }
+
+        for (int frame = 0; frame < 200; ++frame)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            source.Commit();
+        }
+
+        stop = true;
+        for (auto& thread : threads)
+            thread.join();
+
+        source.Commit();
+
+        CHECK(failures.load() == 0);
+        CHECK(source.Errors() == 0);
+        CHECK(source.OutstandingPages() == 0);
+        CHECK(total.load() > 0);
+        CHECK(source.GetCaches().AllocationCount() == total.load());
+    }
+
+    void TestExhaustion()
+    {
+        TestPageSource source(2);
+
+        {
+            auto cache = source.GetCaches().Enter();
+            if (!CHECK(cache != nullptr))
+                return;
+
+            // Each allocation fills most of a page, so the third has nowhere to go.
+            size_t offset;
+            int allocated = 0;
+            while (cache->Allocate(source, 0, 60000, 16, offset))
+                ++allocated;
+            CHECK(allocated == 2);
+
+            // A thread's cache cannot be entered twice.
+            CHECK(source.GetCaches().Enter() == nullptr);
+        }
+
+        source.Commit();
+        CHECK(source.OutstandingPages() == 0);
+        CHECK(source.Errors() == 0);
+
+        // A request larger than a page fails rather than retiring pages forever.
+        auto cache = source.GetCaches().Enter();
+        size_t offset;
+        CHECK(cache && cache->Allocate(source, 0, c_PageSize + 1, 16, offset) == nullptr);
+    }
+
+    // The baseline: every allocation locks the pool and carves from one shared page.
+    class LockedPageAllocator
+    {
+    public:
+        LockedPageAllocator() : mCurrent(nullptr) {}
+
+        TestPage* Allocate(size_t size, size_t alignment, size_t& offset)
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+
+            if (!mCurrent || ((mCurrent->BytesUsed() + alignment - 1) & ~(alignment - 1)) + size > mCurrent->Size())
+            {
+                mPages.emplace_back(std::make_unique<TestPage>(false));
+                mCurrent = mPages.back().get();
+            }
+
+            offset = mCurrent->Suballocate(size, alignment);
+            return mCurrent;
+        }
+
+    private:
+        std::mutex mMutex;
+        std::vector<std::unique_ptr<TestPage>> mPages;
+        TestPage* mCurrent;
+    };
+
+    template<typename TAllocate>
+    double TimeThreads(int threadCount, size_t allocationsPerThread, TAllocate allocate)
+    {
+        TestHelpers::Timer timer;
+
+        std::vector<std::thread> threads;
+        for (int id = 0; id < threadCount; ++id)
+        {
+            threads.emplace_back([&, id]()
+                {
+                    for (size_t j = 0; j < allocationsPerThread; ++j)
+                        allocate(id, 64 + (j % 8) * 32);
+                });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        return timer.ElapsedMilliseconds();
+    }
+
+    void BenchmarkAllocation()
+    {
+        const size_t allocationsPerThread = 200000;
+
+        for (const int threadCount : { 1, 4, 8 })
+        {
+            LockedPageAllocator locked;
+            const double lockedTime = TimeThreads(threadCount, allocationsPerThread, [&](int, size_t size)
+                {
+                    size_t offset;
+                    std::ignore = locked.Allocate(size, 16, offset);
+                });
+
+            TestPageSource source(0, false);
+            std::atomic<size_t> failures(0);
+            const double cachedTime = TimeThreads(threadCount, allocationsPerThread, [&](int, size_t size)
+                {
+                    auto cache = source.GetCaches().Enter();
+                    size_t offset;
+                    if (!cache || !cache->Allocate(source, 0, size, 16, offset))
+                        ++failures;
+                });
+
+            CHECK(failures.load() == 0);
+
+            printf("%d thread(s) x %zu allocations: locked page %.3f ms, thread caches %.3f ms (%zu exchanges)\n",
+                threadCount, allocationsPerThread, lockedTime, cachedTime, source.Exchanges());
+        }
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    TestConcurrentAllocation();
+    TestExhaustion();
+
+    if (TestHelpers::IsBenchmark(argc, argv))
+    {
+        BenchmarkAllocation();
+    }
+
+    return TestHelpers::Finish("GraphicsMemoryCoreTest");
+}
@@ -118,6 +118,9 @@ namespace DirectX
         size_t peakCommitedMemory;  // Peak commited memory value since last reset
         size_t peakTotalMemory;     // Peak total bytes
         size_t peakTotalPages;      // Peak total page count
+        size_t cachedAllocations;   // Allocations served from per-thread page caches since last reset
+        size_t sharedAllocations;   // Allocations served under the shared allocator lock since last reset
+        size_t lockContentions;     // Times the shared allocator lock was held by another thread since last reset
     };
 
     //----------------------------------------------------------------------------------
@@ -11,6 +11,7 @@
 #include "GraphicsMemory.h"
 #include "PlatformHelpers.h"
 #include "LinearAllocator.h"
+#include "GraphicsMemoryCore.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -23,11 +24,14 @@ namespace
     constexpr size_t AllocatorIndexShift = 12; // start block sizes at 4KB
     constexpr size_t AllocatorPoolCount = 21; // allocation sizes up to 2GB supported
     constexpr size_t PoolIndexScale = 1; // multiply the allocation size this amount to push large values into the next bucket
+    constexpr size_t CachedPoolCount = 5; // pools for allocations smaller than MinPageSize use per-thread page caches
+    constexpr size_t CacheBatchPages = 4; // pages a thread takes from a shared pool at a time
 
     static_assert((1 << AllocatorIndexShift) == MinAllocSize, "1 << AllocatorIndexShift must == MinPageSize (in KiB)");
     static_assert((MinPageSize & (MinPageSize - 1)) == 0, "MinPageSize size must be a power of 2");
     static_assert((MinAllocSize & (MinAllocSize - 1)) == 0, "MinAllocSize size must be a power of 2");
     static_assert(MinAllocSize >= (4 * 1024), "MinAllocSize size must be greater than 4K");
+    static_assert((MinAllocSize << (CachedPoolCount - 2)) < MinPageSize, "Cached pools must all use the minimum page size");
 
     constexpr size_t NextPow2(size_t x) noexcept
     {
@@ -84,12 +88,19 @@ namespace
 
     //--------------------------------------------------------------------------------------
     // DeviceAllocator : honors memory requests associated with a particular device
+    //
+    // Small allocations are carved from pages cached by each thread, which only take the
+    // shared lock to exchange a batch of pages. Larger allocations go straight to the pools.
     //--------------------------------------------------------------------------------------
     class DeviceAllocator
     {
     public:
+        using ThreadCaches = GraphicsMemoryCore::ThreadPageCacheSet<LinearAllocatorPage, DeviceAllocator, CachedPoolCount, CacheBatchPages>;
+
         DeviceAllocator(_In_ ID3D12Device* device) noexcept(false)
             : mDevice(device)
+            , mSharedAllocations(0)
+            , mLockContentions(0)
         {
             if (!device)
                 throw std::invalid_argument("Invalid device parameter");
@@ -112,6 +123,8 @@ namespace
         // Explicitly destroy LinearAllocators inside a critical section
         ~DeviceAllocator()
         {
+            mThreadCaches.FlushIdle(*this);
+
             const ScopedLock lock(mMutex);
 
             for (auto& allocator : mPools)
@@ -122,13 +135,37 @@ namespace
 
         GraphicsResource Alloc(_In_ size_t size, _In_ size_t alignment)
         {
-            ScopedLock lock(mMutex);
-
             // Which memory pool does it live in?
             const size_t poolSize = NextPow2((alignment + size) * PoolIndexScale);
             const size_t poolIndex = GetPoolIndexFromSize(poolSize);
             assert(poolIndex < mPools.size());
 
+            if (poolIndex < CachedPoolCount)
+            {
+                auto cache = mThreadCaches.Enter();
+                if (cache)
+                {
+                    size_t offset = 0;
+                    auto page = cache->Allocate(*this, poolIndex, size, alignment, offset);
+                    if (!page)
+                    {
+                        DebugTrace("GraphicsMemory failed to allocate page (%zu requested bytes, %zu alignment)\n", size, alignment);
+                        throw std::bad_alloc();
+                    }
+
+                    return GraphicsResource(
+                        page,
+                        page->GpuAddress() + offset,
+                        page->UploadResource(),
+                        static_cast<BYTE*>(page->BaseMemory()) + offset,
+                        offset,
+                        size);
+                }
+            }
+
+            auto lock = LockPools();
+            ++mSharedAllocations;
+
             // If the allocator isn't initialized yet, do so now
             auto& allocator = mPools[poolIndex];
             assert(allocator != nullptr);
@@ -153,10 +190,33 @@ namespace
                 size);
         }
 
+        // Called by the thread caches to hand back used pages and take clean ones
+        size_t ExchangePages(
+            size_t poolIndex,
+            _In_reads_(retiredCount) LinearAllocatorPage* const* retired, size_t retiredCount,
+            _Out_writes_to_opt_(acquireCount, return) LinearAllocatorPage** acquired, size_t acquireCount)
+        {
+            auto lock = LockPools();
+
+            auto& allocator = mPools[poolIndex];
+            assert(allocator != nullptr);
+
+            for (size_t j = 0; j < retiredCount; ++j)
+            {
+                allocator->ReturnPage(retired[j]);
+            }
+
+            return (acquireCount > 0) ? allocator->AcquirePages(acquired, acquireCount) : 0;
+        }
+
         // Submit page fences to the command queue
         void KickFences(_In_ ID3D12CommandQueue* commandQueue)
         {
-            ScopedLock lock(mMutex);
+            // Pages held by threads that are not allocating right now are fenced with this commit;
+            // any others are fenced by a later one.
+            mThreadCaches.FlushIdle(*this);
+
+            auto lock = LockPools();
 
             for (auto& i : mPools)
             {
@@ -170,7 +230,9 @@ namespace
 
         void GarbageCollect()
         {
-            ScopedLock lock(mMutex);
+            mThreadCaches.FlushIdle(*this);
+
+            auto lock = LockPools();
 
             for (auto& i : mPools)
             {
@@ -187,7 +249,7 @@ namespace
             size_t committedMemoryUsage = 0;
             size_t totalMemoryUsage = 0;
 
-            ScopedLock lock(mMutex);
+            std::unique_lock<std::mutex> lock(mMutex);
 
             for (auto& i : mPools)
             {
@@ -203,6 +265,12 @@ namespace
             stats.committedMemory = committedMemoryUsage;
             stats.totalMemory = totalMemoryUsage;
             stats.totalPages = totalPageCount;
+            stats.sharedAllocations = mSharedAllocations;
+            stats.lockContentions = mLockContentions.load();
+
+            lock.unlock();
+
+            stats.cachedAllocations = mThreadCaches.AllocationCount();
         }
 
     #if !(defined(_XBOX_ONE) && defined(_TITLE)) && !defined(_GAMING_XBOX)
@@ -213,6 +281,20 @@ namespace
         ComPtr<ID3D12Device> mDevice;
         std::array<std::unique_ptr<LinearAllocator>, AllocatorPoolCount> mPools;
         mutable std::mutex mMutex;
+        size_t mSharedAllocations;
+        std::atomic<size_t> mLockContentions;
+        ThreadCaches mThreadCaches;
+
+        std::unique_lock<std::mutex> LockPools()
+        {
+            std::unique_lock<std::mutex> lock(mMutex, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                mLockContentions.fetch_add(1, std::memory_order_relaxed);
+                lock.lock();
+            }
+            return lock;
+        }
     };
 } // anonymous namespace
 
@@ -229,6 +311,9 @@ public:
         , m_peakCommited(0)
         , m_peakBytes(0)
         , m_peakPages(0)
+        , m_baseCachedAllocations(0)
+        , m_baseSharedAllocations(0)
+        , m_baseLockContentions(0)
     {
     #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
         if (s_graphicsMemory)
@@ -308,6 +393,10 @@ public:
             m_peakPages = stats.totalPages;
         }
         stats.peakTotalPages = m_peakPages;
+
+        stats.cachedAllocations -= m_baseCachedAllocations;
+        stats.sharedAllocations -= m_baseSharedAllocations;
+        stats.lockContentions -= m_baseLockContentions;
     }
 
     void ResetStatistics()
@@ -315,7 +404,14 @@ public:
         m_peakCommited = 0;
         m_peakBytes = 0;
         m_peakPages = 0;
-}
+
+        // The allocation counters only ever grow, so remember where they were.
+        GraphicsMemoryStatistics stats;
+        mDeviceAllocator->GetStatistics(stats);
+        m_baseCachedAllocations = stats.cachedAllocations;
+        m_baseSharedAllocations = stats.sharedAllocations;
+        m_baseLockContentions = stats.lockContentions;
+    }
 
     GraphicsMemory* mOwner;
 #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
@@ -330,6 +426,9 @@ private:
     size_t  m_peakCommited;
     size_t  m_peakBytes;
     size_t  m_peakPages;
+    size_t  m_baseCachedAllocations;
+    size_t  m_baseSharedAllocations;
+    size_t  m_baseLockContentions;
 };
 
 #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
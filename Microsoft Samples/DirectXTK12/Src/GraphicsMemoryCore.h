@@ -0,0 +1,268 @@
+//--------------------------------------------------------------------------------------
+// File: GraphicsMemoryCore.h
+//
+// Platform-neutral per-thread page caching used by GraphicsMemory
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace GraphicsMemoryCore
+    {
+        //--------------------------------------------------------------------------------------
+        // Pages owned by one thread, one set per size class.
+        //
+        // Each size class has a current page that allocations are carved from, a few clean pages
+        // taken from the shared pool ahead of time, and the pages it has used up. When the clean
+        // pages run out, the used pages are handed back and a new batch is taken in a single
+        // call to the page source, so the shared pool is only locked once per batch of pages.
+        // Pages handed back are fenced by the shared pool like any other page it has used.
+        //
+        // TPage must provide BytesUsed(), Size() and Suballocate(size, alignment). TSource must
+        // provide ExchangePages(classIndex, retired, retiredCount, acquired, acquireCount), which
+        // takes back the retired pages and returns how many clean pages it stored in acquired.
+        //
+        // Only the thread holding the cache (see TryEnter) may call Allocate or Flush.
+        //--------------------------------------------------------------------------------------
+        template<typename TPage, typename TSource, size_t ClassCount, size_t BatchSize>
+        class ThreadPageCache
+        {
+        public:
+            explicit ThreadPageCache(std::thread::id owner) noexcept :
+                mOwner(owner),
+                mBusy(0),
+                mAllocations(0),
+                mClasses{}
+            {
+            }
+
+            ThreadPageCache(ThreadPageCache&&) = delete;
+            ThreadPageCache& operator= (ThreadPageCache&&) = delete;
+
+            ThreadPageCache(ThreadPageCache const&) = delete;
+            ThreadPageCache& operator= (ThreadPageCache const&) = delete;
+
+            std::thread::id Owner() const noexcept { return mOwner; }
+
+            bool TryEnter() noexcept
+            {
+                uint32_t expected = 0;
+                return mBusy.compare_exchange_strong(expected, 1u, std::memory_order_acquire);
+            }
+
+            void Leave() noexcept { mBusy.store(0, std::memory_order_release); }
+
+            // Returns the page holding the allocation, or nullptr if the source has no more pages.
+            // The alignment must be a power of two.
+            TPage* Allocate(TSource& source, size_t classIndex, size_t size, size_t alignment, size_t& offset)
+            {
+                auto& sizeClass = mClasses[classIndex];
+
+                for (;;)
+                {
+                    TPage* page = sizeClass.current;
+                    if (page)
+                    {
+                        const size_t aligned = (page->BytesUsed() + alignment - 1) & ~(alignment - 1);
+                        if (aligned + size <= page->Size())
+                        {
+                            offset = page->Suballocate(size, alignment);
+                            mAllocations.store(mAllocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                            return page;
+                        }
+
+                        // A request that does not fit in an empty page can never be satisfied.
+                        if (!page->BytesUsed())
+                            return nullptr;
+
+                        sizeClass.retired[sizeClass.retiredCount++] = page;
+                        sizeClass.current = nullptr;
+                    }
+
+                    if (!sizeClass.cleanCount)
+                    {
+                        // Hand back the used pages and take a new batch in one exchange.
+                        const size_t retiredCount = sizeClass.retiredCount;
+                        sizeClass.retiredCount = 0;
+
+                        sizeClass.cleanCount = source.ExchangePages(classIndex, sizeClass.retired, retiredCount, sizeClass.clean, BatchSize);
+                        if (!sizeClass.cleanCount)
+                            return nullptr;
+                    }
+
+                    sizeClass.current = sizeClass.clean[--sizeClass.cleanCount];
+                }
+            }
+
+            // Hands every page back to the source.
+            void Flush(TSource& source)
+            {
+                for (size_t classIndex = 0; classIndex < ClassCount; ++classIndex)
+                {
+                    auto& sizeClass = mClasses[classIndex];
+
+                    TPage* pages[BatchSize * 2 + 2];
+                    size_t count = 0;
+
+                    for (size_t j = 0; j < sizeClass.retiredCount; ++j)
+                        pages[count++] = sizeClass.retired[j];
+                    for (size_t j = 0; j < sizeClass.cleanCount; ++j)
+                        pages[count++] = sizeClass.clean[j];
+                    if (sizeClass.current)
+                        pages[count++] = sizeClass.current;
+
+                    sizeClass = {};
+
+                    if (count > 0)
+                    {
+                        std::ignore = source.ExchangePages(classIndex, pages, count, nullptr, 0);
+                    }
+                }
+            }
+
+            size_t AllocationCount() const noexcept { return mAllocations.load(std::memory_order_relaxed); }
+
+        private:
+            struct SizeClass
+            {
+                TPage*  current;
+                TPage*  clean[BatchSize];
+                TPage*  retired[BatchSize + 1];
+                size_t  cleanCount;
+                size_t  retiredCount;
+            };
+
+            const std::thread::id   mOwner;
+            std::atomic<uint32_t>   mBusy;
+            std::atomic<size_t>     mAllocations;   // Only written by the owning thread
+            SizeClass               mClasses[ClassCount];
+        };
+
+
+        //--------------------------------------------------------------------------------------
+        // The page caches of every thread that has allocated from one shared pool.
+        //
+        // Each thread finds its cache through a small thread-local table, so only the first
+        // allocation a thread makes from a pool takes the registry lock. Caches are flushed by
+        // other threads (for example when committing a frame) only while their owner is not
+        // using them, and a thread finding its cache being flushed falls back to the shared pool.
+        //--------------------------------------------------------------------------------------
+        template<typename TPage, typename TSource, size_t ClassCount, size_t BatchSize>
+        class ThreadPageCacheSet
+        {
+        public:
+            using Cache = ThreadPageCache<TPage, TSource, ClassCount, BatchSize>;
+
+            struct cache_leave { void operator()(Cache* cache) noexcept { if (cache) cache->Leave(); } };
+
+            using ScopedCache = std::unique_ptr<Cache, cache_leave>;
+
+            ThreadPageCacheSet() noexcept(false) :
+                mId(NextId().fetch_add(1) + 1)
+            {
+            }
+
+            ThreadPageCacheSet(ThreadPageCacheSet&&) = delete;
+            ThreadPageCacheSet& operator= (ThreadPageCacheSet&&) = delete;
+
+            ThreadPageCacheSet(ThreadPageCacheSet const&) = delete;
+            ThreadPageCacheSet& operator= (ThreadPageCacheSet const&) = delete;
+
+            // Returns the calling thread's cache, or nullptr if another thread is flushing it.
+            ScopedCache Enter()
+            {
+                struct LookupEntry
+                {
+                    uint64_t    id;
+                    Cache*      cache;
+                };
+
+                static thread_local LookupEntry s_lookup[LookupSize] = {};
+
+                auto& entry = s_lookup[mId % LookupSize];
+
+                if (entry.id != mId)
+                {
+                    entry.cache = FindOrCreate(std::this_thread::get_id());
+                    entry.id = mId;
+                }
+
+                return ScopedCache(entry.cache->TryEnter() ? entry.cache : nullptr);
+            }
+
+            // Flushes the caches not in use by their owners. Caches in use are skipped.
+            void FlushIdle(TSource& source)
+            {
+                const std::lock_guard<std::mutex> lock(mMutex);
+
+                for (auto& cache : mCaches)
+                {
+                    if (cache->TryEnter())
+                    {
+                        const ScopedCache entered(cache.get());
+                        cache->Flush(source);
+                    }
+                }
+            }
+
+            size_t AllocationCount() const
+            {
+                const std::lock_guard<std::mutex> lock(mMutex);
+
+                size_t count = 0;
+                for (auto& cache : mCaches)
+                {
+                    count += cache->AllocationCount();
+                }
+
+                return count;
+            }
+
+        private:
+            static constexpr size_t LookupSize = 4;
+
+            // A function-local static rather than an inline variable, as the projects build as C++14.
+            static std::atomic<uint64_t>& NextId() noexcept
+            {
+                static std::atomic<uint64_t> s_nextId{ 0 };
+                return s_nextId;
+            }
+
+            // Unique for every set, so a thread-local entry for a destroyed set never matches a new one.
+            const uint64_t mId;
+
+            mutable std::mutex mMutex;
+            std::vector<std::unique_ptr<Cache>> mCaches;
+
+            Cache* FindOrCreate(std::thread::id thread)
+            {
+                const std::lock_guard<std::mutex> lock(mMutex);
+
+                for (auto& cache : mCaches)
+                {
+                    if (cache->Owner() == thread)
+                        return cache.get();
+                }
+
+                mCaches.emplace_back(std::make_unique<Cache>(thread));
+                return mCaches.back().get();
+            }
+        };
+    }
+}
@@ -226,6 +226,38 @@ void LinearAllocator::Shrink() noexcept
 #endif
 }
 
+size_t LinearAllocator::AcquirePages(_Out_writes_to_(count, return) LinearAllocatorPage** pages, size_t count)
+{
+    size_t acquired = 0;
+    while (acquired < count)
+    {
+        auto page = m_unusedPages;
+        if (!page)
+        {
+            page = GetNewPage();
+            if (!page)
+                break;
+        }
+
+        // The page stays counted in the totals, but is not on any list until it is returned
+        UnlinkPage(page);
+
+        assert(page->mOffset == 0);
+
+        pages[acquired++] = page;
+    }
+
+    return acquired;
+}
+
+void LinearAllocator::ReturnPage(_In_ LinearAllocatorPage* page) noexcept
+{
+    assert(page != nullptr);
+    assert(page->pNextPage == nullptr && page->pPrevPage == nullptr);
+
+    LinkPage(page, (page->mOffset == 0) ? m_unusedPages : m_usedPages);
+}
+
 LinearAllocatorPage* LinearAllocator::GetCleanPageForAlloc()
 {
     // Grab the first unused page, if one exists. Else, allocate a new page.
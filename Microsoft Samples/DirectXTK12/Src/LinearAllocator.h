@@ -118,6 +118,12 @@ namespace DirectX
         // Throws away all currently unused pages
         void Shrink() noexcept;
 
+        // Removes up to count clean pages from the allocator for use by a single thread,
+        // returning how many were stored in pages. Each one must be handed back with ReturnPage,
+        // after which it is fenced (or reused, if nothing was allocated from it) as usual.
+        size_t AcquirePages(_Out_writes_to_(count, return) LinearAllocatorPage** pages, size_t count);
+        void ReturnPage(_In_ LinearAllocatorPage* page) noexcept;
+
         // Statistics
         size_t CommittedPageCount() const noexcept { return m_numPending; }
         size_t TotalPageCount() const noexcept { return m_totalPages; }
@@ -43,6 +43,49 @@ namespace nvrhi
         uint32_t dataSize;
     };
 
+    // Indexed permutation blobs start with a header followed by an open-addressing hash table
+    // of permutation entries, so that a permutation can be found without scanning the whole blob.
+    // All offsets are relative to the start of the blob, which allows using a memory-mapped file directly.
+    // Layout: header, hash table, permutation strings, binaries (each aligned to 4 bytes).
+    static const char* g_IndexedBlobSignature = "NVSI";
+    static size_t g_IndexedBlobSignatureSize = 4;
+    constexpr uint32_t c_IndexedBlobVersion = 1;
+
+    struct ShaderBlobIndexHeader
+    {
+        char signature[4];
+        uint32_t version;
+        uint32_t numPermutations;
+        uint32_t tableSize; // number of slots in the hash table, a power of 2
+    };
+
+    struct ShaderBlobIndexEntry
+    {
+        uint64_t hash; // hashShaderPermutation of the permutation string
+        uint64_t dataOffset;
+        uint32_t permutationOffset;
+        uint32_t permutationSize;
+        uint32_t dataSize; // 0 for empty slots
+        uint32_t reserved;
+    };
+
+    struct ShaderBlobPermutation
+    {
+        std::string permutation;
+        const void* data = nullptr;
+        size_t size = 0;
+    };
+
+    NVRHI_API uint64_t hashShaderPermutation(const char* permutation, size_t size);
+
+    // Builds an indexed permutation blob. Permutation strings must use the same format as the keys
+    // generated by findPermutationInBlob, i.e. "NAME=VALUE " for every constant.
+    // Returns false if any binary is empty or too large.
+    NVRHI_API bool buildIndexedShaderBlob(
+        const ShaderBlobPermutation* permutations,
+        size_t numPermutations,
+        std::vector<uint8_t>& blob);
+
     NVRHI_API bool findPermutationInBlob(
         const void* blob,
         size_t blobSize,
@@ -1981,6 +1981,39 @@ namespace nvrhi
 
     typedef RefCountPtr<IComputePipeline> ComputePipelineHandle;
 
+    enum class PipelineCompileStatus : uint8_t
+    {
+        Pending,
+        Ready,
+        Failed
+    };
+
+    // Graphics and compute pipelines created with IDevice::create...PipelineAsync expose this interface
+    // through getNativeObject(ObjectTypes::Nvrhi_AsyncPipeline). Other pipelines return nullptr for that type.
+    class IAsyncPipeline
+    {
+    public:
+        virtual ~IAsyncPipeline() = default;
+
+        [[nodiscard]] virtual PipelineCompileStatus getStatus() = 0;
+
+        // Blocks until the pipeline is compiled or the compilation has failed
+        virtual PipelineCompileStatus wait() = 0;
+    };
+
+    struct PipelineCompileStatistics
+    {
+        // Number of pipelines waiting for a worker thread
+        uint32_t queueDepth = 0;
+        // Number of pipelines being compiled right now
+        uint32_t compiling = 0;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        // Time from the create...PipelineAsync call to the end of compilation, in seconds
+        float averageLatency = 0.f;
+        float maxLatency = 0.f;
+    };
+
     struct MeshletPipelineDesc
     {
         PrimitiveType primType = PrimitiveType::TriangleList;
@@ -2297,6 +2330,12 @@ namespace nvrhi
     
     class IDevice;
 
+    enum class PipelineNotReadyPolicy : uint8_t
+    {
+        Wait,
+        SkipDraws
+    };
+
     struct CommandListParameters
     {
         // A command list with enableImmediateExecution = true maps to the immediate context on DX11.
@@ -2316,11 +2355,16 @@ namespace nvrhi
         // COPY and COMPUTE queues have limited subsets of methods available.
         CommandQueue queueType = CommandQueue::Graphics;
 
+        // What setGraphicsState and setComputeState do with an async pipeline that is still compiling.
+        // With SkipDraws, draw and dispatch calls are ignored until the next successful set...State call.
+        PipelineNotReadyPolicy pipelineNotReadyPolicy = PipelineNotReadyPolicy::Wait;
+
         CommandListParameters& setEnableImmediateExecution(bool value) { enableImmediateExecution = value; return *this; }
         CommandListParameters& setUploadChunkSize(size_t value) { uploadChunkSize = value; return *this; }
         CommandListParameters& setScratchChunkSize(size_t value) { scratchChunkSize = value; return *this; }
         CommandListParameters& setScratchMaxMemory(size_t value) { scratchMaxMemory = value; return *this; }
         CommandListParameters& setQueueType(CommandQueue value) { queueType = value; return *this; }
+        CommandListParameters& setPipelineNotReadyPolicy(PipelineNotReadyPolicy value) { pipelineNotReadyPolicy = value; return *this; }
     };
     
     //////////////////////////////////////////////////////////////////////////
@@ -2413,6 +2457,13 @@ namespace nvrhi
         virtual void setBufferState(IBuffer* buffer, ResourceStates stateBits) = 0;
         virtual void setAccelStructState(rt::IAccelStruct* as, ResourceStates stateBits) = 0;
 
+        // Aliasing barriers for placed resources that share heap memory with other resources.
+        // Call before the first use of a resource whose memory may have been used by another resource since its last use.
+        // The previous contents of the resource are discarded. A resource that is not tracked in the command list yet
+        // is assumed to be in its initialState. Like setTextureState, these go into the pending list.
+        virtual void placeTextureAliasingBarrier(ITexture* texture) = 0;
+        virtual void placeBufferAliasingBarrier(IBuffer* buffer) = 0;
+
         // Permanent resource state transitions - these make resource usage cheaper by excluding it from state tracking in the future.
         // Like setTexture/BufferState, these methods put barriers into the pending list. Call commitBarriers() after.
         virtual void setPermanentTextureState(ITexture* texture, ResourceStates stateBits) = 0;
@@ -2491,6 +2542,13 @@ namespace nvrhi
         
         virtual ComputePipelineHandle createComputePipeline(const ComputePipelineDesc& desc) = 0;
 
+        // Return a pipeline handle immediately and compile the pipeline on an internal worker thread.
+        // The handle can be used in graphics or compute states right away, see CommandListParameters::pipelineNotReadyPolicy.
+        // Use IAsyncPipeline to query the compilation status.
+        virtual GraphicsPipelineHandle createGraphicsPipelineAsync(const GraphicsPipelineDesc& desc, IFramebuffer* fb) = 0;
+        virtual ComputePipelineHandle createComputePipelineAsync(const ComputePipelineDesc& desc) = 0;
+        virtual PipelineCompileStatistics getPipelineCompileStatistics() = 0;
+
         virtual MeshletPipelineHandle createMeshletPipeline(const MeshletPipelineDesc& desc, IFramebuffer* fb) = 0;
 
         virtual rt::PipelineHandle createRayTracingPipeline(const rt::PipelineDesc& desc) = 0;
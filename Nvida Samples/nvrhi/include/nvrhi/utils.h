@@ -22,7 +22,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <vector>
 #include <nvrhi/nvrhi.h>
 
 namespace nvrhi::utils
@@ -108,19 +111,185 @@ namespace nvrhi::utils
     void NotSupported();
     void InvalidEnum();
 
+    // A bitmap of free slots with a hierarchy of 64-bit summary words on top of it.
+    // Every summary bit tells whether the corresponding word one level below has any free slots,
+    // so finding a free slot takes a few word reads per level instead of a scan over the whole bitmap.
+    // Allocation and release of single slots and ranges use atomic operations only and can be called
+    // from multiple threads concurrently. resize() is not thread-safe.
+    class HierarchicalBitmap
+    {
+    public:
+        static constexpr uint32_t c_Invalid = ~0u;
+
+        HierarchicalBitmap() = default;
+        explicit HierarchicalBitmap(uint32_t capacity);
+
+        // Changes the number of slots. New slots are free, existing slots keep their state.
+        void resize(uint32_t capacity);
+        [[nodiscard]] uint32_t capacity() const { return m_Capacity; }
+
+        // Allocates the free slot with the lowest index, or returns c_Invalid if all slots are taken.
+        uint32_t allocate();
+
+        // Allocates 'count' contiguous slots and returns the first one, or c_Invalid if no such run exists.
+        // Fully allocated regions of the bitmap are skipped through the summary words.
+        uint32_t allocateRange(uint32_t count);
+
+        void release(uint32_t index);
+        void releaseRange(uint32_t first, uint32_t count);
+
+        [[nodiscard]] bool isAllocated(uint32_t index) const;
+
+    private:
+        struct Level
+        {
+            std::unique_ptr<std::atomic<uint64_t>[]> words;
+            uint32_t numWords = 0;
+        };
+
+        // m_Levels[0] holds one bit per slot (1 = free), higher levels summarize the level below.
+        std::vector<Level> m_Levels;
+        uint32_t m_Capacity = 0;
+
+        uint32_t findNonEmptyWord(uint32_t level, uint32_t index) const;
+        bool tryClaim(uint32_t first, uint32_t count);
+        void releaseBits(uint32_t first, uint32_t count);
+        void markEmpty(uint32_t level, uint32_t index);
+        void markNonEmpty(uint32_t level, uint32_t index);
+    };
+
     class BitSetAllocator
     {
     public:
-        explicit BitSetAllocator(size_t capacity, bool multithreaded);
+        // Thread-safe: allocate and release may be called from any thread without a lock.
+        explicit BitSetAllocator(size_t capacity);
 
         int allocate();
         void release(int index);
 
     private:
-        int m_NextAvailable = 0;
-        std::vector<bool> m_Allocated;
-        bool m_MultiThreaded;
-        std::mutex m_Mutex;
+        HierarchicalBitmap m_Allocated;
+    };
+
+    // Places short-lived textures and buffers of a frame into a few shared heaps, so that resources
+    // that are never used at the same time share memory.
+    // The lifetime of a resource is a range of pass indices. Declare all resources, call compile() once,
+    // and then call beginPass(...) and endPass(...) every frame around recording each pass: beginPass places
+    // the aliasing barriers for the resources that start their lifetime in that pass, and endPass deactivates
+    // the resources whose lifetime ends there. The contents of the transient resources do not survive between
+    // passes outside of their lifetimes, or between frames. All passes of a frame are expected to be recorded
+    // into the same command list.
+    // On backends without placed resources (DX11), every resource gets a dedicated allocation.
+    class NVRHI_API TransientResourceAllocator
+    {
+    public:
+        static constexpr uint32_t c_Invalid = ~0u;
+        static constexpr uint64_t c_DefaultHeapSize = 256ull * 1024 * 1024;
+
+        struct Statistics
+        {
+            // Total size of the resources, as if each of them had a dedicated allocation
+            uint64_t dedicatedMemory = 0;
+            // Total size of the heaps that hold the placed resources
+            uint64_t heapMemory = 0;
+            uint32_t numHeaps = 0;
+            uint32_t numPlacedResources = 0;
+            uint32_t numDedicatedResources = 0;
+
+            [[nodiscard]] uint64_t getMemorySaved() const { return dedicatedMemory > heapMemory ? dedicatedMemory - heapMemory : 0; }
+        };
+
+        // Resources larger than heapSize get a heap of their own.
+        explicit TransientResourceAllocator(IDevice* device, uint64_t heapSize = c_DefaultHeapSize);
+
+        // Declares a resource used in passes firstPass...lastPass (inclusive) and returns its index.
+        // The resource is always virtual, and it never uses keepInitialState: command lists must not place barriers
+        // on it after its lifetime, when the memory belongs to another resource. When desc.initialState is Unknown,
+        // it is derived from the usage flags of the resource.
+        uint32_t declareTexture(const TextureDesc& desc, uint32_t firstPass, uint32_t lastPass);
+        uint32_t declareBuffer(const BufferDesc& desc, uint32_t firstPass, uint32_t lastPass);
+
+        // Creates the declared resources and heaps and binds the resources to the heaps.
+        // Returns false if some of the resources could not be created.
+        bool compile();
+
+        // Returns the resource created for a declaration, or nullptr if the index refers to a resource of the other kind.
+        [[nodiscard]] ITexture* getTexture(uint32_t index) const;
+        [[nodiscard]] IBuffer* getBuffer(uint32_t index) const;
+
+        // Places aliasing barriers for the resources whose lifetimes start at passIndex. Call commitBarriers() after,
+        // or let the automatic barriers of the next draw or dispatch do it.
+        void beginPass(ICommandList* commandList, uint32_t passIndex) const;
+
+        // Deactivates the resources whose lifetimes end at passIndex: they are returned to their initial states while
+        // they still own their memory, which is the state that the aliasing barrier in their next first pass expects.
+        void endPass(ICommandList* commandList, uint32_t passIndex) const;
+
+        // Releases all the declarations, resources and heaps.
+        void reset();
+
+        [[nodiscard]] const Statistics& getStatistics() const { return m_Statistics; }
+
+        // Memory requirements and lifetime of a resource for packResources(...), and the heap and offset it gets.
+        // Resources with size 0 are not placed, they get a dedicated allocation.
+        struct Placement
+        {
+            uint64_t size = 0;
+            uint64_t alignment = 0;
+            uint32_t memoryClass = 0; // resources of different classes never share heaps
+            uint32_t firstPass = 0;
+            uint32_t lastPass = 0;
+
+            uint32_t heapIndex = c_Invalid;
+            uint64_t offset = 0;
+
+            [[nodiscard]] bool overlaps(const Placement& other) const { return firstPass <= other.lastPass && other.firstPass <= lastPass; }
+        };
+
+        struct HeapLayout
+        {
+            uint32_t memoryClass = 0;
+            uint64_t capacity = 0; // at least heapSize, or the size of the first resource if that is larger
+            uint64_t size = 0; // end of the highest resource in the heap
+            std::vector<uint32_t> resources; // indices of the placements
+        };
+
+        // Assigns heaps and offsets to the placements, so that resources with overlapping lifetimes never share memory.
+        // This is the part of compile() that does not need a device, it runs after the memory requirements are known.
+        static void packResources(std::vector<Placement>& placements, uint64_t heapSize, std::vector<HeapLayout>& heaps);
+
+        // Returns the statistics of a packing, as if all of its heaps were created and all of the placed resources were bound.
+        [[nodiscard]] static Statistics getPackingStatistics(const std::vector<Placement>& placements, const std::vector<HeapLayout>& heaps);
+
+        // Size of the heap that compile() creates for a layout
+        [[nodiscard]] static uint64_t getHeapCapacity(const HeapLayout& heap);
+
+    private:
+        struct Resource
+        {
+            TextureDesc textureDesc;
+            BufferDesc bufferDesc;
+            bool isTexture = false;
+            uint32_t firstPass = 0;
+            uint32_t lastPass = 0;
+
+            TextureHandle texture;
+            BufferHandle buffer;
+            MemoryRequirements memoryRequirements;
+            uint32_t heapIndex = c_Invalid;
+            uint64_t offset = 0;
+        };
+
+        IDevice* m_Device;
+        uint64_t m_HeapSize;
+        std::vector<Resource> m_Resources;
+        std::vector<HeapHandle> m_Heaps;
+        std::vector<std::vector<uint32_t>> m_PlacedResourcesByFirstPass;
+        std::vector<std::vector<uint32_t>> m_PlacedResourcesByLastPass;
+        Statistics m_Statistics;
+
+        bool createVirtualResource(Resource& resource);
+        bool createDedicatedResource(Resource& resource);
     };
 
 }
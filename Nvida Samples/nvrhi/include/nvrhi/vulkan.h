@@ -39,6 +39,30 @@ namespace nvrhi
 
 namespace nvrhi::vulkan
 {
+    // Memory use of the upload or scratch managers of the command lists. Each command list publishes its numbers
+    // when it is executed, and IDevice::get...Statistics() returns the sums over the command lists that exist.
+    struct UploadStatistics
+    {
+        // Bytes handed out to the command lists that are not yet known to be consumed by the GPU
+        uint64_t bytesInFlight = 0;
+        // Sum of the peaks of the individual command lists
+        uint64_t peakBytesInFlight = 0;
+
+        // Total bytes lost to alignment padding, ring wrap-around and unused ends of standalone chunks
+        uint64_t wastedBytes = 0;
+
+        // Size of the buffers that exist now, including the ring buffers and the pooled chunks
+        uint64_t allocatedMemory = 0;
+        // Size of the standalone chunks that are waiting in the pools to be reused
+        uint64_t pooledMemory = 0;
+
+        uint64_t ringAllocations = 0;
+        uint64_t chunkAllocations = 0;
+        uint64_t chunksCreated = 0;
+        // Pooled chunks released because they were not reused for a while
+        uint64_t chunksReleased = 0;
+    };
+
     class IDevice : public nvrhi::IDevice
     {
     public:
@@ -49,6 +73,8 @@ namespace nvrhi::vulkan
         virtual uint64_t queueGetCompletedInstance(CommandQueue queue) = 0;
         virtual FramebufferHandle createHandleForNativeFramebuffer(vk::RenderPass renderPass, 
             vk::Framebuffer framebuffer, const FramebufferDesc& desc, bool transferOwnership) = 0;
+        virtual UploadStatistics getUploadStatistics() = 0;
+        virtual UploadStatistics getScratchStatistics() = 0;
     };
 
     typedef RefCountPtr<IDevice> DeviceHandle;
@@ -0,0 +1,191 @@
+/*
+* Copyright (c) 2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "async-pipeline.h"
+
+#include <algorithm>
+
+namespace nvrhi
+{
+    AsyncPipelineCompiler::AsyncPipelineCompiler(IDevice* device)
+        : AsyncPipelineCompiler(
+            [device](const GraphicsPipelineDesc& desc, IFramebuffer* fb) { return device->createGraphicsPipeline(desc, fb); },
+            [device](const ComputePipelineDesc& desc) { return device->createComputePipeline(desc); })
+    {
+    }
+
+    AsyncPipelineCompiler::AsyncPipelineCompiler(GraphicsCompileFunction compileGraphics, ComputeCompileFunction compileCompute, uint32_t threadCount)
+        : m_CompileGraphics(std::move(compileGraphics))
+        , m_CompileCompute(std::move(compileCompute))
+        , m_ThreadCount(threadCount)
+    {
+    }
+
+    AsyncPipelineCompiler::~AsyncPipelineCompiler()
+    {
+        shutdown();
+    }
+
+    GraphicsPipelineHandle AsyncPipelineCompiler::createGraphicsPipeline(const GraphicsPipelineDesc& desc, IFramebuffer* fb)
+    {
+        if (!fb)
+            return nullptr;
+
+        RefCountPtr<AsyncGraphicsPipeline> pipeline = RefCountPtr<AsyncGraphicsPipeline>::Create(new AsyncGraphicsPipeline());
+        pipeline->desc = desc;
+        pipeline->framebufferInfo = fb->getFramebufferInfo();
+        pipeline->framebuffer = fb;
+
+        enqueue([this, pipeline](bool execute)
+        {
+            GraphicsPipelineHandle compiled;
+            if (execute)
+                compiled = m_CompileGraphics(pipeline->desc, pipeline->framebuffer);
+
+            pipeline->framebuffer = nullptr;
+            pipeline->complete(compiled);
+            return compiled != nullptr;
+        });
+
+        return pipeline;
+    }
+
+    ComputePipelineHandle AsyncPipelineCompiler::createComputePipeline(const ComputePipelineDesc& desc)
+    {
+        RefCountPtr<AsyncComputePipeline> pipeline = RefCountPtr<AsyncComputePipeline>::Create(new AsyncComputePipeline());
+        pipeline->desc = desc;
+
+        enqueue([this, pipeline](bool execute)
+        {
+            ComputePipelineHandle compiled;
+            if (execute)
+                compiled = m_CompileCompute(pipeline->desc);
+
+            pipeline->complete(compiled);
+            return compiled != nullptr;
+        });
+
+        return pipeline;
+    }
+
+    PipelineCompileStatistics AsyncPipelineCompiler::getStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        PipelineCompileStatistics statistics = m_Statistics;
+        statistics.queueDepth = uint32_t(m_Queue.size());
+
+        const uint64_t finished = statistics.completed + statistics.failed;
+        if (finished > 0)
+            statistics.averageLatency = float(m_TotalLatency / double(finished));
+
+        return statistics;
+    }
+
+    void AsyncPipelineCompiler::enqueue(std::function<bool(bool execute)> run)
+    {
+        bool queued = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            if (!m_Shutdown)
+            {
+                if (m_Threads.empty())
+                {
+                    const uint32_t threadCount = m_ThreadCount ? m_ThreadCount : std::max(1u, std::thread::hardware_concurrency() / 2);
+                    for (uint32_t index = 0; index < threadCount; index++)
+                        m_Threads.emplace_back(&AsyncPipelineCompiler::workerThreadProc, this);
+                }
+
+                Task task;
+                task.run = std::move(run);
+                task.queueTime = std::chrono::steady_clock::now();
+                m_Queue.push_back(std::move(task));
+                queued = true;
+            }
+        }
+
+        if (!queued)
+        {
+            // The compiler has been shut down, fail the pipeline right away
+            run(false);
+            return;
+        }
+
+        m_Condition.notify_one();
+    }
+
+    void AsyncPipelineCompiler::workerThreadProc()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        while (true)
+        {
+            m_Condition.wait(lock, [this] { return m_Shutdown || !m_Queue.empty(); });
+
+            if (m_Shutdown)
+                return;
+
+            Task task = std::move(m_Queue.front());
+            m_Queue.pop_front();
+            m_Statistics.compiling++;
+
+            lock.unlock();
+            const bool success = task.run(true);
+            const std::chrono::duration<double> latency = std::chrono::steady_clock::now() - task.queueTime;
+            task.run = nullptr; // release the pipeline reference outside of the lock
+            lock.lock();
+
+            m_Statistics.compiling--;
+            if (success)
+                m_Statistics.completed++;
+            else
+                m_Statistics.failed++;
+
+            m_TotalLatency += latency.count();
+            m_Statistics.maxLatency = std::max(m_Statistics.maxLatency, float(latency.count()));
+        }
+    }
+
+    void AsyncPipelineCompiler::shutdown()
+    {
+        std::deque<Task> canceledTasks;
+        std::vector<std::thread> threads;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Shutdown = true;
+            canceledTasks.swap(m_Queue);
+            threads.swap(m_Threads);
+        }
+
+        m_Condition.notify_all();
+
+        for (std::thread& thread : threads)
+            thread.join();
+
+        for (Task& task : canceledTasks)
+            task.run(false);
+    }
+
+} // namespace nvrhi
@@ -0,0 +1,185 @@
+/*
+* Copyright (c) 2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace nvrhi
+{
+    // A pipeline handle returned by create...PipelineAsync before the real pipeline exists.
+    // The compile task completes it with the real pipeline, or with nullptr if the compilation failed.
+    template<typename TInterface>
+    class AsyncPipeline : public RefCounter<TInterface>, public IAsyncPipeline
+    {
+    public:
+        PipelineCompileStatus getStatus() override { return m_Status.load(); }
+
+        PipelineCompileStatus wait() override
+        {
+            if (m_Status.load() == PipelineCompileStatus::Pending)
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this] { return m_Status.load() != PipelineCompileStatus::Pending; });
+            }
+
+            return m_Status.load();
+        }
+
+        // Returns the compiled pipeline, or nullptr if it's not ready
+        TInterface* getPipeline() const
+        {
+            return m_Status.load() == PipelineCompileStatus::Ready ? m_Pipeline.Get() : nullptr;
+        }
+
+        void complete(RefCountPtr<TInterface> pipeline)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Pipeline = pipeline;
+                m_Status.store(pipeline ? PipelineCompileStatus::Ready : PipelineCompileStatus::Failed);
+            }
+
+            m_Condition.notify_all();
+        }
+
+        Object getNativeObject(ObjectType objectType) override
+        {
+            if (objectType == ObjectTypes::Nvrhi_AsyncPipeline)
+                return Object(static_cast<IAsyncPipeline*>(this));
+
+            if (TInterface* pipeline = getPipeline())
+                return pipeline->getNativeObject(objectType);
+
+            return nullptr;
+        }
+
+    private:
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::atomic<PipelineCompileStatus> m_Status = PipelineCompileStatus::Pending;
+        RefCountPtr<TInterface> m_Pipeline;
+    };
+
+    class AsyncGraphicsPipeline : public AsyncPipeline<IGraphicsPipeline>
+    {
+    public:
+        GraphicsPipelineDesc desc;
+        FramebufferInfo framebufferInfo;
+        FramebufferHandle framebuffer; // only kept until the pipeline is compiled
+
+        const GraphicsPipelineDesc& getDesc() const override { return desc; }
+        const FramebufferInfo& getFramebufferInfo() const override { return framebufferInfo; }
+    };
+
+    class AsyncComputePipeline : public AsyncPipeline<IComputePipeline>
+    {
+    public:
+        ComputePipelineDesc desc;
+
+        const ComputePipelineDesc& getDesc() const override { return desc; }
+    };
+
+    // Compiles pipelines on a pool of worker threads using the synchronous create...Pipeline methods of a device.
+    // The worker threads are started on the first request.
+    class AsyncPipelineCompiler
+    {
+    public:
+        typedef std::function<GraphicsPipelineHandle(const GraphicsPipelineDesc& desc, IFramebuffer* fb)> GraphicsCompileFunction;
+        typedef std::function<ComputePipelineHandle(const ComputePipelineDesc& desc)> ComputeCompileFunction;
+
+        explicit AsyncPipelineCompiler(IDevice* device);
+
+        // Compiles pipelines with the given functions instead of the device methods, which is used by the tests.
+        // A function returns nullptr when the compilation fails. 'threadCount' == 0 means half of the hardware threads.
+        AsyncPipelineCompiler(GraphicsCompileFunction compileGraphics, ComputeCompileFunction compileCompute, uint32_t threadCount = 0);
+        ~AsyncPipelineCompiler();
+
+        GraphicsPipelineHandle createGraphicsPipeline(const GraphicsPipelineDesc& desc, IFramebuffer* fb);
+        ComputePipelineHandle createComputePipeline(const ComputePipelineDesc& desc);
+        PipelineCompileStatistics getStatistics();
+
+        // Waits for the pipelines that are being compiled, fails the queued ones and stops the worker threads.
+        // Must be called before the device starts releasing its resources.
+        void shutdown();
+
+    private:
+        struct Task
+        {
+            // Compiles the pipeline if 'execute' is true, otherwise completes it as failed
+            std::function<bool(bool execute)> run;
+            std::chrono::steady_clock::time_point queueTime;
+        };
+
+        GraphicsCompileFunction m_CompileGraphics;
+        ComputeCompileFunction m_CompileCompute;
+        uint32_t m_ThreadCount;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::deque<Task> m_Queue;
+        std::vector<std::thread> m_Threads;
+        bool m_Shutdown = false;
+
+        PipelineCompileStatistics m_Statistics;
+        double m_TotalLatency = 0.0;
+
+        void enqueue(std::function<bool(bool execute)> run);
+        void workerThreadProc();
+    };
+
+    // Replaces an async pipeline in 'state' with the compiled pipeline, waiting for it depending on the policy.
+    // Returns 'state' itself when it doesn't use an async pipeline, a pointer to 'resolvedState' when it does,
+    // or nullptr when the pipeline is not available and draws or dispatches should be skipped.
+    template<typename TState>
+    const TState* resolveAsyncPipeline(const TState& state, TState& resolvedState, PipelineNotReadyPolicy policy)
+    {
+        typedef std::remove_pointer_t<decltype(state.pipeline)> PipelineInterface;
+
+        if (!state.pipeline)
+            return &state;
+
+        IAsyncPipeline* asyncPipeline = state.pipeline->getNativeObject(ObjectTypes::Nvrhi_AsyncPipeline);
+        if (!asyncPipeline)
+            return &state;
+
+        PipelineCompileStatus status = asyncPipeline->getStatus();
+        if (status == PipelineCompileStatus::Pending && policy == PipelineNotReadyPolicy::Wait)
+            status = asyncPipeline->wait();
+
+        if (status != PipelineCompileStatus::Ready)
+            return nullptr;
+
+        resolvedState = state;
+        resolvedState.pipeline = static_cast<AsyncPipeline<PipelineInterface>*>(asyncPipeline)->getPipeline();
+        return &resolvedState;
+    }
+
+} // namespace nvrhi
@@ -21,11 +21,104 @@
 */
 
 #include <nvrhi/common/shader-blob.h>
+#include <nvrhi/common/misc.h>
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 namespace nvrhi
 {
 
+    uint64_t hashShaderPermutation(const char* permutation, size_t size)
+    {
+        // 64-bit FNV-1a
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= uint8_t(permutation[i]);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    static std::string makePermutationKey(const ShaderConstant* constants, uint32_t numConstants)
+    {
+        std::string permutation;
+        for (uint32_t n = 0; n < numConstants; n++)
+        {
+            const ShaderConstant& constant = constants[n];
+
+            permutation += constant.name;
+            permutation += '=';
+            permutation += constant.value;
+            permutation += ' ';
+        }
+        return permutation;
+    }
+
+    static const ShaderBlobIndexHeader* getIndexHeader(const void* blob, size_t blobSize)
+    {
+        if (blobSize < sizeof(ShaderBlobIndexHeader))
+            return nullptr;
+
+        const ShaderBlobIndexHeader* header = static_cast<const ShaderBlobIndexHeader*>(blob);
+
+        if (header->version != c_IndexedBlobVersion)
+            return nullptr; // unknown version of the format
+
+        if (header->tableSize == 0 || (header->tableSize & (header->tableSize - 1)) != 0)
+            return nullptr;
+
+        if (blobSize < sizeof(ShaderBlobIndexHeader) + size_t(header->tableSize) * sizeof(ShaderBlobIndexEntry))
+            return nullptr; // insufficient bytes in the blob for the hash table
+
+        return header;
+    }
+
+    static bool isIndexEntryValid(const ShaderBlobIndexEntry& entry, size_t blobSize)
+    {
+        return size_t(entry.permutationOffset) + entry.permutationSize <= blobSize
+            && entry.dataOffset <= blobSize
+            && entry.dataSize <= blobSize - entry.dataOffset;
+    }
+
+    static bool findPermutationInIndexedBlob(const void* blob, size_t blobSize, const std::string& permutation, const void** pBinary, size_t* pSize)
+    {
+        const ShaderBlobIndexHeader* header = getIndexHeader(blob, blobSize);
+        if (!header)
+            return false;
+
+        const ShaderBlobIndexEntry* table = reinterpret_cast<const ShaderBlobIndexEntry*>(header + 1);
+        const uint32_t mask = header->tableSize - 1;
+        const uint64_t hash = hashShaderPermutation(permutation.data(), permutation.size());
+
+        // Linear probing, the table is never full
+        for (uint32_t probe = 0; probe < header->tableSize; probe++)
+        {
+            const ShaderBlobIndexEntry& entry = table[(uint32_t(hash) + probe) & mask];
+
+            if (entry.dataSize == 0)
+                return false; // reached an empty slot, permutation not found
+
+            if (entry.hash != hash || entry.permutationSize != permutation.size())
+                continue;
+
+            if (!isIndexEntryValid(entry, blobSize))
+                return false; // corrupted blob
+
+            const char* entryPermutation = static_cast<const char*>(blob) + entry.permutationOffset;
+
+            if ((permutation.size() == 0) || (memcmp(entryPermutation, permutation.data(), permutation.size()) == 0))
+            {
+                *pBinary = static_cast<const char*>(blob) + entry.dataOffset;
+                *pSize = entry.dataSize;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     bool findPermutationInBlob(const void* blob, size_t blobSize, const ShaderConstant* constants, uint32_t numConstants, const void** pBinary, size_t* pSize)
     {
         if (!blob || blobSize < g_BlobSignatureSize)
@@ -34,6 +127,12 @@ namespace nvrhi
         if (!pBinary || !pSize)
             return false;
 
+        if (memcmp(blob, g_IndexedBlobSignature, g_IndexedBlobSignatureSize) == 0)
+        {
+            std::string permutation = makePermutationKey(constants, numConstants);
+            return findPermutationInIndexedBlob(blob, blobSize, permutation, pBinary, pSize);
+        }
+
         if (memcmp(blob, g_BlobSignature, g_BlobSignatureSize) != 0)
         {
             if (numConstants == 0)
@@ -51,14 +150,7 @@ namespace nvrhi
         blob = static_cast<const char*>(blob) + g_BlobSignatureSize;
         blobSize -= g_BlobSignatureSize;
         
-        std::stringstream ss;
-        for (uint32_t n = 0; n < numConstants; n++)
-        {
-            const ShaderConstant& constant = constants[n];
-
-            ss << constant.name << "=" << constant.value << " ";
-        }
-        std::string permutation = ss.str();
+        std::string permutation = makePermutationKey(constants, numConstants);
 
         while (blobSize > sizeof(ShaderBlobEntry))
         {
@@ -89,11 +181,127 @@ namespace nvrhi
         return false; // went through the blob, permutation not found
     }
 
+    bool buildIndexedShaderBlob(const ShaderBlobPermutation* permutations, size_t numPermutations, std::vector<uint8_t>& blob)
+    {
+        // Keep the load factor at or below 1/2 so that probe sequences stay short
+        uint32_t tableSize = 1;
+        while (tableSize < numPermutations * 2)
+            tableSize *= 2;
+
+        std::vector<ShaderBlobIndexEntry> table(tableSize);
+        memset(table.data(), 0, table.size() * sizeof(ShaderBlobIndexEntry));
+
+        size_t stringsOffset = sizeof(ShaderBlobIndexHeader) + table.size() * sizeof(ShaderBlobIndexEntry);
+        size_t dataOffset = stringsOffset;
+        for (size_t index = 0; index < numPermutations; index++)
+            dataOffset += permutations[index].permutation.size();
+        dataOffset = align(dataOffset, size_t(4));
+
+        size_t stringOffset = stringsOffset;
+        uint32_t numUniquePermutations = 0;
+        std::vector<size_t> placedPermutations(tableSize);
+
+        for (size_t index = 0; index < numPermutations; index++)
+        {
+            const ShaderBlobPermutation& permutation = permutations[index];
+
+            if (permutation.size == 0 || permutation.size > size_t(std::numeric_limits<uint32_t>::max()))
+                return false;
+
+            if (stringOffset + permutation.permutation.size() > size_t(std::numeric_limits<uint32_t>::max()))
+                return false;
+
+            const uint64_t hash = hashShaderPermutation(permutation.permutation.data(), permutation.permutation.size());
+
+            uint32_t slot = uint32_t(hash) & (tableSize - 1);
+            bool duplicate = false;
+            while (table[slot].dataSize != 0)
+            {
+                if (table[slot].hash == hash && permutations[placedPermutations[slot]].permutation == permutation.permutation)
+                {
+                    duplicate = true; // the first permutation with a given key wins, same as in the linear format
+                    break;
+                }
+                slot = (slot + 1) & (tableSize - 1);
+            }
+
+            if (duplicate)
+                continue;
+
+            ShaderBlobIndexEntry& entry = table[slot];
+            entry.hash = hash;
+            entry.permutationOffset = uint32_t(stringOffset);
+            entry.permutationSize = uint32_t(permutation.permutation.size());
+            entry.dataOffset = dataOffset;
+            entry.dataSize = uint32_t(permutation.size);
+            placedPermutations[slot] = index;
+
+            stringOffset += permutation.permutation.size();
+            dataOffset = align(dataOffset + permutation.size, size_t(4));
+            ++numUniquePermutations;
+        }
+
+        blob.clear();
+        blob.resize(dataOffset, 0);
+
+        ShaderBlobIndexHeader header = {};
+        memcpy(header.signature, g_IndexedBlobSignature, g_IndexedBlobSignatureSize);
+        header.version = c_IndexedBlobVersion;
+        header.numPermutations = numUniquePermutations;
+        header.tableSize = tableSize;
+
+        memcpy(blob.data(), &header, sizeof(header));
+        memcpy(blob.data() + sizeof(header), table.data(), table.size() * sizeof(ShaderBlobIndexEntry));
+
+        for (const ShaderBlobIndexEntry& entry : table)
+        {
+            if (entry.dataSize == 0)
+                continue;
+
+            const ShaderBlobPermutation& permutation = permutations[placedPermutations[&entry - table.data()]];
+            memcpy(blob.data() + entry.permutationOffset, permutation.permutation.data(), entry.permutationSize);
+            memcpy(blob.data() + entry.dataOffset, permutation.data, entry.dataSize);
+        }
+
+        return true;
+    }
+
     void enumeratePermutationsInBlob(const void* blob, size_t blobSize, std::vector<std::string>& permutations)
     {
         if (!blob || blobSize < g_BlobSignatureSize)
             return;
 
+        if (memcmp(blob, g_IndexedBlobSignature, g_IndexedBlobSignatureSize) == 0)
+        {
+            const ShaderBlobIndexHeader* header = getIndexHeader(blob, blobSize);
+            if (!header)
+                return;
+
+            // Report the permutations in the order they are stored in the blob, not in hash table order
+            std::vector<const ShaderBlobIndexEntry*> entries;
+            const ShaderBlobIndexEntry* table = reinterpret_cast<const ShaderBlobIndexEntry*>(header + 1);
+            for (uint32_t slot = 0; slot < header->tableSize; slot++)
+            {
+                if (table[slot].dataSize != 0 && isIndexEntryValid(table[slot], blobSize))
+                    entries.push_back(&table[slot]);
+            }
+
+            std::sort(entries.begin(), entries.end(), [](const ShaderBlobIndexEntry* a, const ShaderBlobIndexEntry* b)
+            {
+                return a->dataOffset < b->dataOffset;
+            });
+
+            for (const ShaderBlobIndexEntry* entry : entries)
+            {
+                if (entry->permutationSize > 0)
+                    permutations.push_back(std::string(static_cast<const char*>(blob) + entry->permutationOffset, entry->permutationSize));
+                else
+                    permutations.push_back("<default>");
+            }
+
+            return;
+        }
+
         if (memcmp(blob, g_BlobSignature, g_BlobSignatureSize) != 0)
             return;
 
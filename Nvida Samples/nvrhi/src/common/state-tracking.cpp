@@ -134,6 +134,94 @@ namespace nvrhi
         }
     }
 
+    void CommandListResourceStateTracker::placeTextureAliasingBarrier(TextureStateExtension* texture)
+    {
+        const TextureDesc& desc = texture->descRef;
+
+        if (texture->permanentState != 0)
+        {
+            std::stringstream ss;
+            ss << "Cannot place an aliasing barrier for texture " << utils::DebugNameToString(desc.debugName)
+                << " because it is in a permanent state";
+            m_MessageCallback->message(MessageSeverity::Error, ss.str().c_str());
+            return;
+        }
+
+        TextureState* tracking = getTextureStateTracking(texture, true);
+
+        // The barriers keep the tracked states: on DX12, a resource keeps its state through an aliasing barrier,
+        // and on Vulkan, the image is transitioned from the undefined layout into the tracked layout.
+        // A resource that is not tracked in this command list yet is expected to be in its initial state,
+        // which is where it was created and where the previous owner of its lifetime should have left it.
+
+        if (tracking->subresourceStates.empty())
+        {
+            if (tracking->state == ResourceStates::Unknown)
+                tracking->state = desc.initialState;
+
+            TextureBarrier barrier;
+            barrier.texture = texture;
+            barrier.entireTexture = true;
+            barrier.stateBefore = tracking->state;
+            barrier.stateAfter = tracking->state;
+            barrier.aliasing = true;
+            m_TextureBarriers.push_back(barrier);
+        }
+        else
+        {
+            for (ArraySlice arraySlice = 0; arraySlice < desc.arraySize; arraySlice++)
+            {
+                for (MipLevel mipLevel = 0; mipLevel < desc.mipLevels; mipLevel++)
+                {
+                    ResourceStates& state = tracking->subresourceStates[calcSubresource(mipLevel, arraySlice, desc)];
+                    if (state == ResourceStates::Unknown)
+                        state = desc.initialState;
+
+                    TextureBarrier barrier;
+                    barrier.texture = texture;
+                    barrier.entireTexture = false;
+                    barrier.mipLevel = mipLevel;
+                    barrier.arraySlice = arraySlice;
+                    barrier.stateBefore = state;
+                    barrier.stateAfter = state;
+                    barrier.aliasing = true;
+                    m_TextureBarriers.push_back(barrier);
+                }
+            }
+        }
+
+        tracking->firstUavBarrierPlaced = false;
+    }
+
+    void CommandListResourceStateTracker::placeBufferAliasingBarrier(BufferStateExtension* buffer)
+    {
+        if (buffer->descRef.isVolatile || buffer->descRef.cpuAccess != CpuAccessMode::None)
+            return;
+
+        if (buffer->permanentState != 0)
+        {
+            std::stringstream ss;
+            ss << "Cannot place an aliasing barrier for buffer " << utils::DebugNameToString(buffer->descRef.debugName)
+                << " because it is in a permanent state";
+            m_MessageCallback->message(MessageSeverity::Error, ss.str().c_str());
+            return;
+        }
+
+        BufferState* tracking = getBufferStateTracking(buffer, true);
+
+        if (tracking->state == ResourceStates::Unknown)
+            tracking->state = buffer->descRef.initialState;
+
+        BufferBarrier barrier;
+        barrier.buffer = buffer;
+        barrier.stateBefore = tracking->state;
+        barrier.stateAfter = tracking->state;
+        barrier.aliasing = true;
+        m_BufferBarriers.push_back(barrier);
+
+        tracking->firstUavBarrierPlaced = false;
+    }
+
     ResourceStates CommandListResourceStateTracker::getTextureSubresourceState(TextureStateExtension* texture, ArraySlice arraySlice, MipLevel mipLevel)
     {
         TextureState* tracking = getTextureStateTracking(texture, false);
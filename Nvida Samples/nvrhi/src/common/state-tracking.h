@@ -74,6 +74,7 @@ namespace nvrhi
         bool entireTexture = false;
         ResourceStates stateBefore = ResourceStates::Unknown;
         ResourceStates stateAfter = ResourceStates::Unknown;
+        bool aliasing = false; // the memory of the texture was used by another resource before this barrier
     };
 
     struct BufferBarrier
@@ -81,6 +82,7 @@ namespace nvrhi
         BufferStateExtension* buffer = nullptr;
         ResourceStates stateBefore = ResourceStates::Unknown;
         ResourceStates stateAfter = ResourceStates::Unknown;
+        bool aliasing = false; // the memory of the buffer was used by another resource before this barrier
     };
 
     class CommandListResourceStateTracker
@@ -101,6 +103,9 @@ namespace nvrhi
         void endTrackingTextureState(TextureStateExtension* texture, TextureSubresourceSet subresources, ResourceStates stateBits, bool permanent);
         void endTrackingBufferState(BufferStateExtension* buffer, ResourceStates stateBits, bool permanent);
 
+        void placeTextureAliasingBarrier(TextureStateExtension* texture);
+        void placeBufferAliasingBarrier(BufferStateExtension* buffer);
+
         ResourceStates getTextureSubresourceState(TextureStateExtension* texture, ArraySlice arraySlice, MipLevel mipLevel);
         ResourceStates getBufferState(BufferStateExtension* buffer);
 
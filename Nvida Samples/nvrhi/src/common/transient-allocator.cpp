@@ -0,0 +1,435 @@
+/*
+* Copyright (c) 2014-2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include <nvrhi/utils.h>
+#include <nvrhi/common/misc.h>
+
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+namespace nvrhi::utils
+{
+    // Heap sizes are rounded up to the DX12 resource placement alignment
+    static constexpr uint64_t c_HeapSizeGranularity = 64 * 1024;
+
+    // Resources in different memory classes never share heaps: DX12 heap tier 1 only allows
+    // render target and depth-stencil textures to be placed in the heaps that nvrhi creates.
+    static constexpr uint32_t c_MemoryClassRenderTargets = 0;
+    static constexpr uint32_t c_MemoryClassOther = 1;
+
+    static ResourceStates getDefaultInitialState(const TextureDesc& desc)
+    {
+        if (desc.isRenderTarget)
+            return getFormatInfo(desc.format).hasDepth ? ResourceStates::DepthWrite : ResourceStates::RenderTarget;
+        if (desc.isUAV)
+            return ResourceStates::UnorderedAccess;
+        return ResourceStates::ShaderResource;
+    }
+
+    static ResourceStates getDefaultInitialState(const BufferDesc& desc)
+    {
+        if (desc.canHaveUAVs)
+            return ResourceStates::UnorderedAccess;
+        return ResourceStates::ShaderResource;
+    }
+
+    TransientResourceAllocator::TransientResourceAllocator(IDevice* device, uint64_t heapSize)
+        : m_Device(device)
+        , m_HeapSize(heapSize)
+    {
+    }
+
+    uint32_t TransientResourceAllocator::declareTexture(const TextureDesc& desc, uint32_t firstPass, uint32_t lastPass)
+    {
+        assert(firstPass <= lastPass);
+
+        Resource resource;
+        resource.isTexture = true;
+        resource.textureDesc = desc;
+        resource.textureDesc.isVirtual = true;
+        resource.textureDesc.keepInitialState = false;
+        if (resource.textureDesc.initialState == ResourceStates::Unknown)
+            resource.textureDesc.initialState = getDefaultInitialState(desc);
+        resource.firstPass = firstPass;
+        resource.lastPass = lastPass;
+
+        m_Resources.push_back(std::move(resource));
+        return uint32_t(m_Resources.size() - 1);
+    }
+
+    uint32_t TransientResourceAllocator::declareBuffer(const BufferDesc& desc, uint32_t firstPass, uint32_t lastPass)
+    {
+        assert(firstPass <= lastPass);
+
+        Resource resource;
+        resource.isTexture = false;
+        resource.bufferDesc = desc;
+        resource.bufferDesc.isVirtual = true;
+        resource.bufferDesc.keepInitialState = false;
+        if (resource.bufferDesc.initialState == ResourceStates::Unknown)
+            resource.bufferDesc.initialState = getDefaultInitialState(desc);
+        resource.firstPass = firstPass;
+        resource.lastPass = lastPass;
+
+        m_Resources.push_back(std::move(resource));
+        return uint32_t(m_Resources.size() - 1);
+    }
+
+    bool TransientResourceAllocator::createVirtualResource(Resource& resource)
+    {
+        if (resource.isTexture)
+        {
+            resource.texture = m_Device->createTexture(resource.textureDesc);
+            if (!resource.texture)
+                return false;
+
+            resource.memoryRequirements = m_Device->getTextureMemoryRequirements(resource.texture);
+        }
+        else
+        {
+            resource.buffer = m_Device->createBuffer(resource.bufferDesc);
+            if (!resource.buffer)
+                return false;
+
+            resource.memoryRequirements = m_Device->getBufferMemoryRequirements(resource.buffer);
+        }
+
+        return resource.memoryRequirements.size != 0;
+    }
+
+    bool TransientResourceAllocator::createDedicatedResource(Resource& resource)
+    {
+        resource.heapIndex = c_Invalid;
+        resource.offset = 0;
+
+        if (resource.isTexture)
+        {
+            // Dedicated resources never alias, so they can be restored to their initial states at the end of each command list
+            TextureDesc desc = resource.textureDesc;
+            desc.isVirtual = false;
+            desc.keepInitialState = true;
+            resource.texture = m_Device->createTexture(desc);
+            return resource.texture != nullptr;
+        }
+        
+        BufferDesc desc = resource.bufferDesc;
+        desc.isVirtual = false;
+        desc.keepInitialState = true;
+        resource.buffer = m_Device->createBuffer(desc);
+        return resource.buffer != nullptr;
+    }
+
+    static uint64_t findPlacement(const std::vector<TransientResourceAllocator::Placement>& placements,
+        const TransientResourceAllocator::HeapLayout& heap, const TransientResourceAllocator::Placement& placement)
+    {
+        // Collect the memory ranges used by resources that are alive at the same time as this one
+        std::vector<std::pair<uint64_t, uint64_t>> occupied;
+        for (uint32_t index : heap.resources)
+        {
+            const TransientResourceAllocator::Placement& other = placements[index];
+            if (other.overlaps(placement))
+                occupied.push_back(std::make_pair(other.offset, other.offset + other.size));
+        }
+
+        std::sort(occupied.begin(), occupied.end());
+
+        // Find the lowest gap that fits the resource
+        const uint64_t alignment = std::max<uint64_t>(placement.alignment, 1);
+        uint64_t offset = 0;
+        for (const auto& [begin, end] : occupied)
+        {
+            if (align(offset, alignment) + placement.size <= begin)
+                break;
+
+            offset = std::max(offset, end);
+        }
+
+        offset = align(offset, alignment);
+
+        if (offset + placement.size > heap.capacity)
+            return TransientResourceAllocator::c_Invalid;
+
+        return offset;
+    }
+
+    void TransientResourceAllocator::packResources(std::vector<Placement>& placements, uint64_t heapSize, std::vector<HeapLayout>& heaps)
+    {
+        std::vector<uint32_t> order;
+        for (uint32_t index = 0; index < uint32_t(placements.size()); index++)
+        {
+            placements[index].heapIndex = c_Invalid;
+            placements[index].offset = 0;
+
+            if (placements[index].size != 0)
+                order.push_back(index);
+        }
+
+        // Placing the large resources first leaves the small ones to fill the gaps between them
+        std::sort(order.begin(), order.end(), [&placements](uint32_t a, uint32_t b)
+        {
+            const Placement& pa = placements[a];
+            const Placement& pb = placements[b];
+            if (pa.size != pb.size)
+                return pa.size > pb.size;
+            return pa.firstPass < pb.firstPass;
+        });
+
+        for (uint32_t index : order)
+        {
+            Placement& placement = placements[index];
+
+            uint32_t heapIndex = c_Invalid;
+            uint64_t offset = 0;
+
+            for (uint32_t candidate = 0; candidate < uint32_t(heaps.size()); candidate++)
+            {
+                if (heaps[candidate].memoryClass != placement.memoryClass)
+                    continue;
+
+                offset = findPlacement(placements, heaps[candidate], placement);
+                if (offset != c_Invalid)
+                {
+                    heapIndex = candidate;
+                    break;
+                }
+            }
+
+            if (heapIndex == c_Invalid)
+            {
+                HeapLayout heap;
+                heap.memoryClass = placement.memoryClass;
+                heap.capacity = std::max(heapSize, placement.size);
+                heaps.push_back(std::move(heap));
+
+                heapIndex = uint32_t(heaps.size() - 1);
+                offset = 0;
+            }
+
+            HeapLayout& heap = heaps[heapIndex];
+            heap.resources.push_back(index);
+            heap.size = std::max(heap.size, offset + placement.size);
+
+            placement.heapIndex = heapIndex;
+            placement.offset = offset;
+        }
+    }
+
+    TransientResourceAllocator::Statistics TransientResourceAllocator::getPackingStatistics(const std::vector<Placement>& placements, const std::vector<HeapLayout>& heaps)
+    {
+        Statistics statistics;
+
+        for (const Placement& placement : placements)
+        {
+            statistics.dedicatedMemory += placement.size;
+
+            if (placement.heapIndex != c_Invalid)
+                statistics.numPlacedResources++;
+            else
+                statistics.numDedicatedResources++;
+        }
+
+        for (const HeapLayout& heap : heaps)
+        {
+            statistics.heapMemory += getHeapCapacity(heap);
+            statistics.numHeaps++;
+        }
+
+        return statistics;
+    }
+
+    uint64_t TransientResourceAllocator::getHeapCapacity(const HeapLayout& heap)
+    {
+        return align(heap.size, c_HeapSizeGranularity);
+    }
+
+    bool TransientResourceAllocator::compile()
+    {
+        m_Heaps.clear();
+        m_PlacedResourcesByFirstPass.clear();
+        m_PlacedResourcesByLastPass.clear();
+
+        bool success = true;
+
+        // DX11 has no placed resources, and its device reports an error when asked for memory requirements
+        const bool placementSupported = m_Device->getGraphicsAPI() != GraphicsAPI::D3D11;
+
+        std::vector<Placement> placements(m_Resources.size());
+
+        for (size_t index = 0; index < m_Resources.size(); index++)
+        {
+            Resource& resource = m_Resources[index];
+            resource.texture = nullptr;
+            resource.buffer = nullptr;
+            resource.memoryRequirements = MemoryRequirements();
+            resource.heapIndex = c_Invalid;
+
+            if (!placementSupported || !createVirtualResource(resource))
+            {
+                resource.memoryRequirements = MemoryRequirements();
+                success = createDedicatedResource(resource) && success;
+            }
+
+            Placement& placement = placements[index];
+            placement.size = resource.memoryRequirements.size;
+            placement.alignment = resource.memoryRequirements.alignment;
+            placement.memoryClass = (resource.isTexture && resource.textureDesc.isRenderTarget)
+                ? c_MemoryClassRenderTargets
+                : c_MemoryClassOther;
+            placement.firstPass = resource.firstPass;
+            placement.lastPass = resource.lastPass;
+        }
+
+        std::vector<HeapLayout> heapLayouts;
+        packResources(placements, m_HeapSize, heapLayouts);
+
+        for (size_t index = 0; index < m_Resources.size(); index++)
+        {
+            m_Resources[index].heapIndex = placements[index].heapIndex;
+            m_Resources[index].offset = placements[index].offset;
+        }
+
+        // The statistics describe the packing, and are corrected below for the heaps and bindings that fail
+        m_Statistics = getPackingStatistics(placements, heapLayouts);
+
+        for (uint32_t heapIndex = 0; heapIndex < uint32_t(heapLayouts.size()); heapIndex++)
+        {
+            const HeapLayout& layout = heapLayouts[heapIndex];
+
+            std::stringstream ss;
+            ss << "TransientHeap" << heapIndex;
+
+            HeapDesc heapDesc;
+            heapDesc.capacity = getHeapCapacity(layout);
+            heapDesc.type = HeapType::DeviceLocal;
+            heapDesc.debugName = ss.str();
+
+            HeapHandle heap = m_Device->createHeap(heapDesc);
+            if (!heap)
+            {
+                m_Statistics.heapMemory -= heapDesc.capacity;
+                m_Statistics.numHeaps--;
+            }
+            
+            m_Heaps.push_back(heap);
+
+            for (uint32_t index : layout.resources)
+            {
+                Resource& resource = m_Resources[index];
+
+                bool bound = false;
+                if (heap)
+                {
+                    bound = resource.isTexture
+                        ? m_Device->bindTextureMemory(resource.texture, heap, resource.offset)
+                        : m_Device->bindBufferMemory(resource.buffer, heap, resource.offset);
+                }
+
+                if (!bound)
+                {
+                    // Not placeable in this heap type, fall back to a dedicated allocation
+                    success = createDedicatedResource(resource) && success;
+                    m_Statistics.numPlacedResources--;
+                    m_Statistics.numDedicatedResources++;
+                }
+            }
+        }
+
+        for (uint32_t index = 0; index < uint32_t(m_Resources.size()); index++)
+        {
+            const Resource& resource = m_Resources[index];
+
+            if (resource.heapIndex == c_Invalid)
+                continue;
+
+            if (m_PlacedResourcesByFirstPass.size() <= resource.firstPass)
+                m_PlacedResourcesByFirstPass.resize(resource.firstPass + 1);
+
+            m_PlacedResourcesByFirstPass[resource.firstPass].push_back(index);
+
+            if (m_PlacedResourcesByLastPass.size() <= resource.lastPass)
+                m_PlacedResourcesByLastPass.resize(resource.lastPass + 1);
+
+            m_PlacedResourcesByLastPass[resource.lastPass].push_back(index);
+        }
+
+        return success;
+    }
+
+    ITexture* TransientResourceAllocator::getTexture(uint32_t index) const
+    {
+        if (index >= m_Resources.size())
+            return nullptr;
+
+        return m_Resources[index].texture;
+    }
+
+    IBuffer* TransientResourceAllocator::getBuffer(uint32_t index) const
+    {
+        if (index >= m_Resources.size())
+            return nullptr;
+
+        return m_Resources[index].buffer;
+    }
+
+    void TransientResourceAllocator::beginPass(ICommandList* commandList, uint32_t passIndex) const
+    {
+        if (passIndex >= m_PlacedResourcesByFirstPass.size())
+            return;
+
+        for (uint32_t index : m_PlacedResourcesByFirstPass[passIndex])
+        {
+            const Resource& resource = m_Resources[index];
+
+            if (resource.isTexture)
+                commandList->placeTextureAliasingBarrier(resource.texture);
+            else
+                commandList->placeBufferAliasingBarrier(resource.buffer);
+        }
+    }
+
+    void TransientResourceAllocator::endPass(ICommandList* commandList, uint32_t passIndex) const
+    {
+        if (passIndex >= m_PlacedResourcesByLastPass.size())
+            return;
+
+        for (uint32_t index : m_PlacedResourcesByLastPass[passIndex])
+        {
+            const Resource& resource = m_Resources[index];
+
+            if (resource.isTexture)
+                commandList->setTextureState(resource.texture, AllSubresources, resource.textureDesc.initialState);
+            else
+                commandList->setBufferState(resource.buffer, resource.bufferDesc.initialState);
+        }
+    }
+
+    void TransientResourceAllocator::reset()
+    {
+        m_Resources.clear();
+        m_Heaps.clear();
+        m_PlacedResourcesByFirstPass.clear();
+        m_PlacedResourcesByLastPass.clear();
+        m_Statistics = Statistics();
+    }
+
+} // namespace nvrhi::utils
@@ -0,0 +1,116 @@
+/*
+* Copyright (c) 2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+#include <nvrhi/common/misc.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+namespace nvrhi
+{
+    // Recycles the standalone chunks of an upload manager, which hold the allocations that don't fit into the ring.
+    // Chunk sizes are rounded up to c_Granularity rather than to a power of two, so a large upload wastes at most
+    // one granule. A request reuses the smallest pooled chunk that is large enough, as long as that chunk is not
+    // more than c_MaxOversize times larger than needed. Chunks that sit in the pool for more than 'maxIdleSubmissions'
+    // submissions are released by trim(...), so the memory of a one-time burst of uploads is returned eventually.
+    // The pool only looks at the 'bufferSize' member of a chunk, which keeps it testable without a device.
+    template<typename Chunk>
+    class UploadChunkPool
+    {
+    public:
+        static constexpr uint64_t c_Granularity = 64 * 1024;
+        static constexpr uint64_t c_MaxOversize = 2;
+
+        explicit UploadChunkPool(uint64_t maxIdleSubmissions) : m_MaxIdleSubmissions(maxIdleSubmissions) { }
+
+        // Size of the chunk to create for an allocation of 'size' bytes
+        [[nodiscard]] static uint64_t getChunkSize(uint64_t size, uint64_t minChunkSize)
+        {
+            return align(std::max(size, minChunkSize), c_Granularity);
+        }
+
+        // Returns a pooled chunk that can hold 'size' bytes, or nullptr if there is none.
+        // Pass the result of getChunkSize(...) so that chunks of the default size are reused by small allocations.
+        std::shared_ptr<Chunk> acquire(uint64_t size)
+        {
+            auto it = m_Chunks.lower_bound(size);
+            if (it == m_Chunks.end() || it->first > size * c_MaxOversize)
+                return nullptr;
+
+            std::shared_ptr<Chunk> chunk = std::move(it->second.chunk);
+            m_PooledBytes -= it->first;
+            m_Chunks.erase(it);
+            return chunk;
+        }
+
+        void release(std::shared_ptr<Chunk> chunk)
+        {
+            const uint64_t size = chunk->bufferSize;
+            m_PooledBytes += size;
+            m_Chunks.emplace(size, Entry{ std::move(chunk), m_Submission });
+        }
+
+        // Counts one submission and drops the chunks that were not used for too long.
+        // Returns the total size of the dropped chunks and adds their number to 'releasedChunks'.
+        uint64_t trim(uint64_t& releasedChunks)
+        {
+            ++m_Submission;
+
+            uint64_t releasedBytes = 0;
+            for (auto it = m_Chunks.begin(); it != m_Chunks.end(); )
+            {
+                if (m_Submission - it->second.releasedAt > m_MaxIdleSubmissions)
+                {
+                    releasedBytes += it->first;
+                    ++releasedChunks;
+                    it = m_Chunks.erase(it);
+                }
+                else
+                    ++it;
+            }
+
+            m_PooledBytes -= releasedBytes;
+            return releasedBytes;
+        }
+
+        [[nodiscard]] size_t getChunkCount() const { return m_Chunks.size(); }
+        [[nodiscard]] uint64_t getPooledBytes() const { return m_PooledBytes; }
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<Chunk> chunk;
+            uint64_t releasedAt = 0;
+        };
+
+        uint64_t m_MaxIdleSubmissions;
+        uint64_t m_Submission = 0;
+        uint64_t m_PooledBytes = 0;
+        std::multimap<uint64_t, Entry> m_Chunks;
+    };
+
+} // namespace nvrhi
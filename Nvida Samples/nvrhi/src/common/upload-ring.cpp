@@ -0,0 +1,117 @@
+/*
+* Copyright (c) 2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#include "upload-ring.h"
+#include <nvrhi/common/misc.h>
+
+#include <algorithm>
+
+namespace nvrhi
+{
+    bool UploadRing::allocate(uint64_t size, uint64_t alignment, uint64_t currentVersion, uint64_t* pOffset)
+    {
+        uint64_t offset = align(m_Head, alignment);
+
+        if (m_Used == 0 || m_Head > m_Tail)
+        {
+            // Free space is [head, size) and [0, tail)
+            if (offset + size > m_Size)
+            {
+                if (size > m_Tail)
+                    return false;
+
+                // Wrap around, the end of the ring is skipped
+                offset = 0;
+            }
+        }
+        else
+        {
+            // Free space is [head, tail), or nothing if the ring is full
+            if (offset + size > m_Tail)
+                return false;
+        }
+
+        const uint64_t newHead = offset + size;
+        const uint64_t consumed = (offset >= m_Head) ? newHead - m_Head : m_Size - m_Head + newHead;
+
+        if (!m_Regions.empty() && m_Regions.back().version == currentVersion)
+        {
+            Region& region = m_Regions.back();
+            region.end = newHead;
+            region.bytes += consumed;
+            region.usedBytes += size;
+        }
+        else
+        {
+            Region region;
+            region.version = currentVersion;
+            region.end = newHead;
+            region.bytes = consumed;
+            region.usedBytes = size;
+            m_Regions.push_back(region);
+        }
+
+        m_Head = newHead;
+        m_Used += consumed;
+
+        m_Statistics.wastedBytes += consumed - size;
+        m_Statistics.allocations++;
+        m_Statistics.bytesInFlight += size;
+        m_Statistics.peakBytesInFlight = std::max(m_Statistics.peakBytesInFlight, m_Statistics.bytesInFlight);
+
+        *pOffset = offset;
+        return true;
+    }
+
+    uint64_t UploadRing::reclaim(uint64_t currentVersion, uint64_t completedInstance)
+    {
+        uint64_t freedBytes = 0;
+
+        while (!m_Regions.empty() && VersionIsReclaimable(m_Regions.front().version, currentVersion, completedInstance))
+        {
+            const Region& region = m_Regions.front();
+            m_Tail = region.end;
+            m_Used -= region.bytes;
+            freedBytes += region.usedBytes;
+            m_Regions.pop_front();
+        }
+
+        if (m_Used == 0)
+        {
+            m_Head = 0;
+            m_Tail = 0;
+        }
+
+        m_Statistics.bytesInFlight -= freedBytes;
+        return freedBytes;
+    }
+
+    void UploadRing::submit(uint64_t currentVersion, uint64_t submittedVersion)
+    {
+        for (Region& region : m_Regions)
+        {
+            if (region.version == currentVersion)
+                region.version = submittedVersion;
+        }
+    }
+
+} // namespace nvrhi
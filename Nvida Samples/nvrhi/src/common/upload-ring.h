@@ -0,0 +1,87 @@
+/*
+* Copyright (c) 2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "versioning.h"
+
+#include <deque>
+
+namespace nvrhi
+{
+    // Bookkeeping for an upload ring buffer that is shared by the instances of a command list.
+    // Allocations are made at the head, and the tail advances past the regions of the instances that have
+    // completed on the GPU or were closed without being executed. The ring doesn't own any memory,
+    // the offsets refer to a buffer that the caller creates, which keeps this part testable without a device.
+    class UploadRing
+    {
+    public:
+        struct Statistics
+        {
+            // Sum of the allocation sizes that have not been reclaimed yet
+            uint64_t bytesInFlight = 0;
+            uint64_t peakBytesInFlight = 0;
+
+            // Total bytes lost to alignment padding and to the skipped ends of the ring when wrapping around
+            uint64_t wastedBytes = 0;
+
+            uint64_t allocations = 0;
+        };
+
+        explicit UploadRing(uint64_t size) : m_Size(size) { }
+
+        // Returns false if there is no contiguous free space for the allocation.
+        // The allocation belongs to 'currentVersion' until submit(...) replaces it with the submitted version.
+        bool allocate(uint64_t size, uint64_t alignment, uint64_t currentVersion, uint64_t* pOffset);
+
+        // Advances the tail past the regions whose versions are reclaimable, oldest first, see VersionIsReclaimable.
+        // Returns the number of allocated bytes (excluding waste) that were freed.
+        uint64_t reclaim(uint64_t currentVersion, uint64_t completedInstance);
+
+        // Replaces 'currentVersion' with 'submittedVersion' in the regions allocated by the instance being submitted
+        void submit(uint64_t currentVersion, uint64_t submittedVersion);
+
+        [[nodiscard]] uint64_t getSize() const { return m_Size; }
+        // Bytes between the tail and the head, including padding and wrap-around
+        [[nodiscard]] uint64_t getUsedBytes() const { return m_Used; }
+        [[nodiscard]] const Statistics& getStatistics() const { return m_Statistics; }
+
+    private:
+        // A contiguous part of the ring that was allocated by one command list instance,
+        // ending at 'end' and occupying 'bytes' including padding and wrap-around.
+        struct Region
+        {
+            uint64_t version = 0;
+            uint64_t end = 0;
+            uint64_t bytes = 0;
+            uint64_t usedBytes = 0;
+        };
+
+        uint64_t m_Size;
+        std::deque<Region> m_Regions;
+        uint64_t m_Head = 0;
+        uint64_t m_Tail = 0;
+        uint64_t m_Used = 0;
+        Statistics m_Statistics;
+    };
+
+} // namespace nvrhi
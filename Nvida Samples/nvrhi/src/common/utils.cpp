@@ -23,6 +23,10 @@
 #include <nvrhi/utils.h>
 #include <sstream>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace nvrhi::utils
 {
     BlendState::RenderTarget CreateAddBlendState(
@@ -375,52 +379,394 @@ namespace nvrhi::utils
         assert(!"Invalid Enumeration Value");  // NOLINT(clang-diagnostic-string-conversion)
     }
 
-    BitSetAllocator::BitSetAllocator(const size_t capacity, bool multithreaded)
-        : m_MultiThreaded(multithreaded)
+    static uint32_t countTrailingZeros(uint64_t value)
     {
-        m_Allocated.resize(capacity);
+        assert(value != 0);
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return uint32_t(index);
+#else
+        return uint32_t(__builtin_ctzll(value));
+#endif
     }
 
-    int BitSetAllocator::allocate()
+    static uint32_t countLeadingZeros(uint64_t value)
+    {
+        assert(value != 0);
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - uint32_t(index);
+#else
+        return uint32_t(__builtin_clzll(value));
+#endif
+    }
+
+    // Returns a mask with bits [first, first + count) set, count must be in [1, 64]
+    static uint64_t bitRangeMask(uint32_t first, uint32_t count)
+    {
+        uint64_t mask = (count == 64) ? ~0ull : ((1ull << count) - 1);
+        return mask << first;
+    }
+
+    // Returns a mask where bit i is set if bits [i, i + count) are all set in 'bits'
+    static uint64_t findBitRuns(uint64_t bits, uint32_t count)
+    {
+        uint32_t runLength = 1;
+        while (runLength < count && bits != 0)
+        {
+            uint32_t shift = std::min(runLength, count - runLength);
+            bits &= bits >> shift;
+            runLength += shift;
+        }
+        return bits;
+    }
+
+    HierarchicalBitmap::HierarchicalBitmap(uint32_t capacity)
     {
-        if (m_MultiThreaded)
-            m_Mutex.lock();
+        resize(capacity);
+    }
 
-        int result = -1;
+    void HierarchicalBitmap::resize(uint32_t capacity)
+    {
+        std::vector<Level> levels;
 
-        int capacity = static_cast<int>(m_Allocated.size());
-        for (int i = 0; i < capacity; i++)
+        uint32_t numBits = capacity;
+        do
+        {
+            Level level;
+            level.numWords = std::max((numBits + 63) / 64, 1u);
+            level.words = std::make_unique<std::atomic<uint64_t>[]>(level.numWords);
+            numBits = level.numWords;
+            levels.push_back(std::move(level));
+        } while (numBits > 1);
+
+        // Copy the existing slots and mark the new ones as free
+        Level& leaves = levels[0];
+        for (uint32_t word = 0; word < leaves.numWords; word++)
         {
-            int ii = (m_NextAvailable + i) % capacity;
+            const uint32_t firstSlot = word * 64;
+            uint64_t bits = 0;
 
-            if (!m_Allocated[ii])
+            if (firstSlot < capacity)
+                bits = bitRangeMask(0, std::min(capacity - firstSlot, 64u));
+
+            if (firstSlot < m_Capacity)
             {
-                result = ii;
-                m_NextAvailable = (ii + 1) % capacity;
-                m_Allocated[ii] = true;
-                break;
+                const uint64_t oldBits = m_Levels[0].words[word].load(std::memory_order_relaxed);
+                const uint64_t oldMask = bitRangeMask(0, std::min(m_Capacity - firstSlot, 64u));
+                bits = (bits & ~oldMask) | (oldBits & oldMask & bits);
             }
+
+            leaves.words[word].store(bits, std::memory_order_relaxed);
         }
 
-        if (m_MultiThreaded)
-            m_Mutex.unlock();
+        // Rebuild the summaries bottom-up
+        for (size_t levelIndex = 1; levelIndex < levels.size(); levelIndex++)
+        {
+            const Level& below = levels[levelIndex - 1];
+            Level& level = levels[levelIndex];
+
+            for (uint32_t word = 0; word < level.numWords; word++)
+                level.words[word].store(0, std::memory_order_relaxed);
 
-        return result;
+            for (uint32_t child = 0; child < below.numWords; child++)
+            {
+                if (below.words[child].load(std::memory_order_relaxed) != 0)
+                    level.words[child / 64].fetch_or(1ull << (child % 64), std::memory_order_relaxed);
+            }
+        }
+
+        m_Levels = std::move(levels);
+        m_Capacity = capacity;
     }
 
-    void BitSetAllocator::release(const int index)
+    // Returns the index of the first word at or after 'index' on the given level that has any bits set.
+    // The summary level above is used to skip over empty words 64 at a time.
+    uint32_t HierarchicalBitmap::findNonEmptyWord(uint32_t level, uint32_t index) const
+    {
+        const Level& current = m_Levels[level];
+        const bool isTopLevel = level + 1 == uint32_t(m_Levels.size());
+
+        while (index < current.numWords)
+        {
+            if (isTopLevel)
+            {
+                if (current.words[index].load() != 0)
+                    return index;
+
+                ++index;
+                continue;
+            }
+
+            const uint64_t summary = m_Levels[level + 1].words[index / 64].load() & (~0ull << (index % 64));
+
+            if (summary == 0)
+            {
+                const uint32_t parent = findNonEmptyWord(level + 1, index / 64 + 1);
+                if (parent == c_Invalid)
+                    return c_Invalid;
+
+                index = parent * 64;
+                continue;
+            }
+
+            index = (index & ~63u) + countTrailingZeros(summary);
+
+            // Summary bits are hints that may be briefly stale while other threads update them
+            if (index < current.numWords && current.words[index].load() != 0)
+                return index;
+
+            ++index;
+        }
+
+        return c_Invalid;
+    }
+
+    // Called after a word became empty: clears its summary bit and propagates up.
+    // The word is re-checked afterwards so that a concurrent release is never hidden from the search.
+    void HierarchicalBitmap::markEmpty(uint32_t level, uint32_t index)
+    {
+        if (level + 1 >= uint32_t(m_Levels.size()))
+            return;
+
+        const uint64_t bit = 1ull << (index % 64);
+        const uint64_t oldSummary = m_Levels[level + 1].words[index / 64].fetch_and(~bit);
+
+        if (m_Levels[level].words[index].load() != 0)
+        {
+            markNonEmpty(level, index);
+            return;
+        }
+
+        if (oldSummary == bit)
+            markEmpty(level + 1, index / 64);
+    }
+
+    // Called after a word went from empty to non-empty: sets its summary bit and propagates up.
+    void HierarchicalBitmap::markNonEmpty(uint32_t level, uint32_t index)
+    {
+        if (level + 1 >= uint32_t(m_Levels.size()))
+            return;
+
+        const uint64_t bit = 1ull << (index % 64);
+        const uint64_t oldSummary = m_Levels[level + 1].words[index / 64].fetch_or(bit);
+
+        if (oldSummary == 0)
+            markNonEmpty(level + 1, index / 64);
+    }
+
+    uint32_t HierarchicalBitmap::allocate()
+    {
+        if (m_Levels.empty())
+            return c_Invalid;
+
+        Level& leaves = m_Levels[0];
+
+        for (uint32_t word = findNonEmptyWord(0, 0); word != c_Invalid; word = findNonEmptyWord(0, word))
+        {
+            uint64_t bits = leaves.words[word].load();
+
+            while (bits != 0)
+            {
+                const uint64_t bit = bits & (~bits + 1);
+
+                if (leaves.words[word].compare_exchange_weak(bits, bits & ~bit))
+                {
+                    if ((bits & ~bit) == 0)
+                        markEmpty(0, word);
+
+                    return word * 64 + countTrailingZeros(bit);
+                }
+            }
+
+            // Another thread took the last free slot in this word, look further
+        }
+
+        return c_Invalid;
+    }
+
+    // Atomically takes the slots [first, first + count) if all of them are free.
+    bool HierarchicalBitmap::tryClaim(uint32_t first, uint32_t count)
     {
-        if (index >= 0 && index < static_cast<int>(m_Allocated.size()))
+        Level& leaves = m_Levels[0];
+        const uint32_t end = first + count;
+
+        uint32_t slot = first;
+        while (slot < end)
         {
-            if (m_MultiThreaded)
-                m_Mutex.lock();
+            const uint32_t word = slot / 64;
+            const uint32_t bitCount = std::min(end - slot, 64 - slot % 64);
+            const uint64_t mask = bitRangeMask(slot % 64, bitCount);
+
+            uint64_t bits = leaves.words[word].load();
+            bool claimed = false;
+
+            while ((bits & mask) == mask)
+            {
+                if (leaves.words[word].compare_exchange_weak(bits, bits & ~mask))
+                {
+                    claimed = true;
+                    break;
+                }
+            }
+
+            if (!claimed)
+            {
+                // Lost a race for some of the slots, give back what was taken so far
+                if (slot > first)
+                    releaseBits(first, slot - first);
+
+                return false;
+            }
+
+            if ((bits & ~mask) == 0)
+                markEmpty(0, word);
+
+            slot += bitCount;
+        }
 
-            m_Allocated[index] = false;
-            m_NextAvailable = std::min(m_NextAvailable, index);
+        return true;
+    }
+
+    uint32_t HierarchicalBitmap::allocateRange(uint32_t count)
+    {
+        if (count == 1)
+            return allocate();
+
+        if (count == 0 || count > m_Capacity)
+            return c_Invalid;
+
+        const Level& leaves = m_Levels[0];
+
+        uint32_t runStart = 0;
+        uint32_t runLength = 0;
+        uint32_t previousWord = c_Invalid;
+
+        uint32_t word = findNonEmptyWord(0, 0);
+        while (word != c_Invalid)
+        {
+            const uint64_t bits = leaves.words[word].load();
+            uint32_t candidate = c_Invalid;
+
+            // A run can only continue across words that are adjacent
+            if (previousWord == c_Invalid || word != previousWord + 1)
+                runLength = 0;
+
+            previousWord = word;
+
+            if (bits == ~0ull)
+            {
+                if (runLength == 0)
+                    runStart = word * 64;
+
+                runLength += 64;
+
+                if (runLength >= count)
+                    candidate = runStart;
+            }
+            else
+            {
+                // Free slots at the bottom of this word extend the run from the previous word
+                const uint32_t lowFree = countTrailingZeros(~bits);
+                if (runLength > 0 && runLength + lowFree >= count)
+                    candidate = runStart;
+
+                if (candidate == c_Invalid && count <= 64)
+                {
+                    const uint64_t runs = findBitRuns(bits, count);
+                    if (runs != 0)
+                        candidate = word * 64 + countTrailingZeros(runs);
+                }
+
+                // Free slots at the top of this word may start a new run
+                const uint32_t highFree = countLeadingZeros(~bits);
+                runLength = highFree;
+                runStart = word * 64 + 64 - highFree;
+            }
+
+            if (candidate != c_Invalid)
+            {
+                if (tryClaim(candidate, count))
+                    return candidate;
+
+                // The bitmap changed under us, restart the search from the beginning of the failed run
+                runLength = 0;
+                previousWord = c_Invalid;
+                word = findNonEmptyWord(0, candidate / 64);
+                continue;
+            }
 
-            if (m_MultiThreaded)
-                m_Mutex.unlock();
+            word = findNonEmptyWord(0, word + 1);
         }
+
+        return c_Invalid;
+    }
+
+    void HierarchicalBitmap::releaseBits(uint32_t first, uint32_t count)
+    {
+        Level& leaves = m_Levels[0];
+        const uint32_t end = first + count;
+
+        uint32_t slot = first;
+        while (slot < end)
+        {
+            const uint32_t word = slot / 64;
+            const uint32_t bitCount = std::min(end - slot, 64 - slot % 64);
+            const uint64_t mask = bitRangeMask(slot % 64, bitCount);
+
+            const uint64_t oldBits = leaves.words[word].fetch_or(mask);
+            assert((oldBits & mask) == 0); // double release
+
+            if (oldBits == 0)
+                markNonEmpty(0, word);
+
+            slot += bitCount;
+        }
+    }
+
+    void HierarchicalBitmap::release(uint32_t index)
+    {
+        if (index < m_Capacity)
+            releaseBits(index, 1);
+    }
+
+    void HierarchicalBitmap::releaseRange(uint32_t first, uint32_t count)
+    {
+        if (count == 0 || first >= m_Capacity)
+            return;
+
+        releaseBits(first, std::min(count, m_Capacity - first));
+    }
+
+    bool HierarchicalBitmap::isAllocated(uint32_t index) const
+    {
+        if (index >= m_Capacity)
+            return false;
+
+        return (m_Levels[0].words[index / 64].load() & (1ull << (index % 64))) == 0;
+    }
+
+    BitSetAllocator::BitSetAllocator(const size_t capacity)
+        : m_Allocated(static_cast<uint32_t>(capacity))
+    {
+    }
+
+    int BitSetAllocator::allocate()
+    {
+        const uint32_t index = m_Allocated.allocate();
+
+        if (index == HierarchicalBitmap::c_Invalid)
+            return -1;
+
+        return static_cast<int>(index);
+    }
+
+    void BitSetAllocator::release(const int index)
+    {
+        if (index >= 0)
+            m_Allocated.release(static_cast<uint32_t>(index));
     }
 
 }
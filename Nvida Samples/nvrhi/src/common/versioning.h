@@ -20,6 +20,10 @@
 * DEALINGS IN THE SOFTWARE.
 */
 
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
 namespace nvrhi
 {
     /*
@@ -59,4 +63,21 @@ namespace nvrhi
     {
         return (version & c_VersionSubmittedFlag) != 0;
     }
+
+    constexpr bool VersionIsCompleted(uint64_t version, uint64_t completedInstance)
+    {
+        return VersionGetSubmitted(version) && VersionGetInstance(version) <= completedInstance;
+    }
+
+    // A version that was never submitted and is not the one being recorded belongs to a command list
+    // instance that was closed without being executed, so its memory will never be used by the GPU.
+    constexpr bool VersionIsAbandoned(uint64_t version, uint64_t currentVersion)
+    {
+        return !VersionGetSubmitted(version) && version != currentVersion;
+    }
+
+    constexpr bool VersionIsReclaimable(uint64_t version, uint64_t currentVersion, uint64_t completedInstance)
+    {
+        return VersionIsCompleted(version, completedInstance) || VersionIsAbandoned(version, currentVersion);
+    }
 }
\ No newline at end of file
@@ -25,6 +25,7 @@
 #include <nvrhi/d3d11.h>
 #include <nvrhi/common/resourcebindingmap.h>
 #include "../common/dxgi-format.h"
+#include "../common/async-pipeline.h"
 
 #include <d3d11_1.h>
 #include <map>
@@ -340,6 +341,8 @@ namespace nvrhi::d3d11
         void setTextureState(ITexture* texture, TextureSubresourceSet subresources, ResourceStates stateBits) override { (void)texture; (void)subresources; (void)stateBits; }
         void setBufferState(IBuffer* buffer, ResourceStates stateBits) override { (void)buffer; (void)stateBits; }
         void setAccelStructState(rt::IAccelStruct* as, ResourceStates stateBits) override { (void)as; (void)stateBits; }
+        void placeTextureAliasingBarrier(ITexture* texture) override { (void)texture; }
+        void placeBufferAliasingBarrier(IBuffer* buffer) override { (void)buffer; }
 
         void setPermanentTextureState(ITexture* texture, ResourceStates stateBits) override { (void)texture; (void)stateBits; }
         void setPermanentBufferState(IBuffer* buffer, ResourceStates stateBits) override { (void)buffer; (void)stateBits; }
@@ -382,6 +385,10 @@ namespace nvrhi::d3d11
         Color m_CurrentBlendConstantColor{};
         bool m_CurrentGraphicsStateValid = false;
         bool m_CurrentComputeStateValid = false;
+        // Set when an async pipeline is skipped, see PipelineNotReadyPolicy. Kept per pipeline type because
+        // binding a compute pipeline does not affect the graphics pipeline that draws use, and vice versa.
+        bool m_GraphicsPipelineNotReady = false;
+        bool m_ComputePipelineNotReady = false;
 
         void copyTexture(ID3D11Resource* dst, const TextureDesc& dstDesc, const TextureSlice& dstSlice,
             ID3D11Resource* src, const TextureDesc& srcDesc, const TextureSlice& srcSlice);
@@ -403,6 +410,7 @@ namespace nvrhi::d3d11
     {
     public:
         explicit Device(const DeviceDesc& desc);
+        ~Device() override;
         
         // IResource implementation
 
@@ -459,6 +467,10 @@ namespace nvrhi::d3d11
 
         ComputePipelineHandle createComputePipeline(const ComputePipelineDesc& desc) override;
 
+        GraphicsPipelineHandle createGraphicsPipelineAsync(const GraphicsPipelineDesc& desc, IFramebuffer* fb) override;
+        ComputePipelineHandle createComputePipelineAsync(const ComputePipelineDesc& desc) override;
+        PipelineCompileStatistics getPipelineCompileStatistics() override;
+
         MeshletPipelineHandle createMeshletPipeline(const MeshletPipelineDesc& desc, IFramebuffer* fb) override;
 
         rt::PipelineHandle createRayTracingPipeline(const rt::PipelineDesc& desc) override;
@@ -494,6 +506,9 @@ namespace nvrhi::d3d11
         std::unordered_map<size_t, RefCountPtr<ID3D11BlendState>> m_BlendStates;
         std::unordered_map<size_t, RefCountPtr<ID3D11DepthStencilState>> m_DepthStencilStates;
         std::unordered_map<size_t, RefCountPtr<ID3D11RasterizerState>> m_RasterizerStates;
+        std::mutex m_StateCacheMutex;
+
+        AsyncPipelineCompiler m_AsyncPipelineCompiler;
 
         bool m_SinglePassStereoSupported = false;
         bool m_FastGeometryShaderSupported = false;
@@ -70,6 +70,8 @@ namespace nvrhi::d3d11
 
         m_CurrentGraphicsStateValid = false;
         m_CurrentComputeStateValid = false;
+        m_GraphicsPipelineNotReady = false;
+        m_ComputePipelineNotReady = false;
 
         // Release the strong references to pipeline objects
         m_CurrentGraphicsPipeline = nullptr;
@@ -37,8 +37,16 @@ namespace nvrhi::d3d11
         return ComputePipelineHandle::Create(pso);
     }
 
-    void CommandList::setComputeState(const ComputeState& state)
+    void CommandList::setComputeState(const ComputeState& _state)
     {
+        ComputeState resolvedState;
+        const ComputeState* pState = resolveAsyncPipeline(_state, resolvedState, m_Desc.pipelineNotReadyPolicy);
+        m_ComputePipelineNotReady = (pState == nullptr);
+        if (!pState)
+            return;
+
+        const ComputeState& state = *pState;
+
         ComputePipeline* pso = checked_cast<ComputePipeline*>(state.pipeline);
 
         if (m_CurrentGraphicsStateValid)
@@ -74,11 +82,17 @@ namespace nvrhi::d3d11
 
     void CommandList::dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
     {
+        if (m_ComputePipelineNotReady)
+            return;
+
         m_Context.immediateContext->Dispatch(groupsX, groupsY, groupsZ);
     }
 
     void CommandList::dispatchIndirect(uint32_t offsetBytes)
     {
+        if (m_ComputePipelineNotReady)
+            return;
+
         Buffer* indirectParams = checked_cast<Buffer*>(m_CurrentIndirectBuffer.Get());
         
         if (indirectParams) // validation layer will issue an error otherwise
@@ -45,6 +45,7 @@ namespace nvrhi::d3d11
     }
 
     Device::Device(const DeviceDesc& desc)
+        : m_AsyncPipelineCompiler(this)
     {
         m_Context.messageCallback = desc.messageCallback;
         m_Context.immediateContext = desc.context;
@@ -90,6 +91,12 @@ namespace nvrhi::d3d11
         m_ImmediateCommandList = CommandListHandle::Create(new CommandList(m_Context, this, CommandListParameters()));   
     }
 
+    Device::~Device()
+    {
+        // Stop the compiler threads before any of the state caches they use are destroyed
+        m_AsyncPipelineCompiler.shutdown();
+    }
+
     GraphicsAPI Device::getGraphicsAPI()
     {
         return GraphicsAPI::D3D11;
@@ -228,6 +235,21 @@ namespace nvrhi::d3d11
         return nullptr;
     }
 
+    GraphicsPipelineHandle Device::createGraphicsPipelineAsync(const GraphicsPipelineDesc& desc, IFramebuffer* fb)
+    {
+        return m_AsyncPipelineCompiler.createGraphicsPipeline(desc, fb);
+    }
+
+    ComputePipelineHandle Device::createComputePipelineAsync(const ComputePipelineDesc& desc)
+    {
+        return m_AsyncPipelineCompiler.createComputePipeline(desc);
+    }
+
+    PipelineCompileStatistics Device::getPipelineCompileStatistics()
+    {
+        return m_AsyncPipelineCompiler.getStatistics();
+    }
+
     void Device::waitForIdle()
     {
         if (!m_WaitForIdleQuery)
@@ -67,9 +67,13 @@ namespace nvrhi::d3d11
         pso->primitiveTopology = convertPrimType(desc.primType, desc.patchControlPoints);
         pso->inputLayout = checked_cast<InputLayout*>(desc.inputLayout.Get());
 
-        pso->pRS = getRasterizerState(renderState.rasterState);
-        pso->pBlendState = getBlendState(renderState.blendState);
-        pso->pDepthStencilState = getDepthStencilState(renderState.depthStencilState);
+        {
+            // The state caches are shared with the async pipeline compiler threads
+            std::lock_guard<std::mutex> lock(m_StateCacheMutex);
+            pso->pRS = getRasterizerState(renderState.rasterState);
+            pso->pBlendState = getBlendState(renderState.blendState);
+            pso->pDepthStencilState = getDepthStencilState(renderState.depthStencilState);
+        }
         pso->requiresBlendFactor = renderState.blendState.usesConstantColor(uint32_t(pso->framebufferInfo.colorFormats.size()));
         
         pso->stencilRef = renderState.depthStencilState.stencilRefValue;
@@ -148,8 +152,16 @@ namespace nvrhi::d3d11
         return ret;
     }
 
-    void CommandList::setGraphicsState(const GraphicsState& state)
+    void CommandList::setGraphicsState(const GraphicsState& _state)
     {
+        GraphicsState resolvedState;
+        const GraphicsState* pState = resolveAsyncPipeline(_state, resolvedState, m_Desc.pipelineNotReadyPolicy);
+        m_GraphicsPipelineNotReady = (pState == nullptr);
+        if (!pState)
+            return;
+
+        const GraphicsState& state = *pState;
+
         GraphicsPipeline* pipeline = checked_cast<GraphicsPipeline*>(state.pipeline);
         Framebuffer* framebuffer = checked_cast<Framebuffer*>(state.framebuffer);
 
@@ -349,16 +361,25 @@ namespace nvrhi::d3d11
 
     void CommandList::draw(const DrawArguments& args)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         m_Context.immediateContext->DrawInstanced(args.vertexCount, args.instanceCount, args.startVertexLocation, args.startInstanceLocation);
     }
 
     void CommandList::drawIndexed(const DrawArguments& args)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         m_Context.immediateContext->DrawIndexedInstanced(args.vertexCount, args.instanceCount, args.startIndexLocation, args.startVertexLocation, args.startInstanceLocation);
     }
 
     void CommandList::drawIndirect(uint32_t offsetBytes)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         Buffer* indirectParams = checked_cast<Buffer*>(m_CurrentIndirectBuffer.Get());
         
         if (indirectParams) // validation layer will issue an error otherwise
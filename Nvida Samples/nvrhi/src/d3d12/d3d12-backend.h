@@ -46,6 +46,7 @@
 #include "../common/state-tracking.h"
 #include "../common/dxgi-format.h"
 #include "../common/versioning.h"
+#include "../common/async-pipeline.h"
 
 #ifdef NVRHI_WITH_RTXMU
 #include <rtxmu/D3D12AccelStructManager.h>
@@ -111,8 +112,7 @@ namespace nvrhi::d3d12
         D3D12_GPU_DESCRIPTOR_HANDLE m_StartGpuHandleShaderVisible = { 0 };
         uint32_t m_Stride = 0;
         uint32_t m_NumDescriptors = 0;
-        std::vector<bool> m_AllocatedDescriptors;
-        DescriptorIndex m_SearchStart = 0;
+        utils::HierarchicalBitmap m_AllocatedDescriptors;
         uint32_t m_NumAllocatedDescriptors = 0;
         std::mutex m_Mutex;
 
@@ -147,8 +147,10 @@ namespace nvrhi::d3d12
         std::vector<uint64_t> asBuildsCompleted;
 #endif
 
-        // The cache does not own the RS objects, so store weak references
-        std::unordered_map<size_t, RootSignature*> rootsigCache;
+        // The cache holds a reference to each RS, so that a lookup on one thread can't race
+        // with the last release on another. Unused entries are dropped by runGarbageCollection.
+        std::unordered_map<size_t, RefCountPtr<RootSignature>> rootsigCache;
+        std::mutex rootsigCacheMutex; // pipelines can be created on the async compiler threads
 
         explicit DeviceResources(const Context& context, const DeviceDesc& desc);
 
@@ -436,16 +438,8 @@ namespace nvrhi::d3d12
         RefCountPtr<ID3D12RootSignature> handle;
         uint32_t pushConstantByteSize = 0;
         RootParameterIndex rootParameterPushConstants = ~0u;
-        
-        RootSignature(DeviceResources& resources)
-            : m_Resources(resources)
-        { }
 
-        ~RootSignature() override;
         Object getNativeObject(ObjectType objectType) override;
-
-    private:
-        DeviceResources& m_Resources;
     };
 
     class Framebuffer : public RefCounter<IFramebuffer>
@@ -889,6 +883,8 @@ namespace nvrhi::d3d12
         void setTextureState(ITexture* texture, TextureSubresourceSet subresources, ResourceStates stateBits) override;
         void setBufferState(IBuffer* buffer, ResourceStates stateBits) override;
         void setAccelStructState(rt::IAccelStruct* as, ResourceStates stateBits) override;
+        void placeTextureAliasingBarrier(ITexture* texture) override;
+        void placeBufferAliasingBarrier(IBuffer* buffer) override;
         
         void setPermanentTextureState(ITexture* texture, ResourceStates stateBits) override;
         void setPermanentBufferState(IBuffer* buffer, ResourceStates stateBits) override;
@@ -947,6 +943,10 @@ namespace nvrhi::d3d12
         bool m_CurrentComputeStateValid = false;
         bool m_CurrentMeshletStateValid = false;
         bool m_CurrentRayTracingStateValid = false;
+        // Set when an async pipeline is skipped, see PipelineNotReadyPolicy. Kept per pipeline type because
+        // binding a compute pipeline does not affect the graphics pipeline that draws use, and vice versa.
+        bool m_GraphicsPipelineNotReady = false;
+        bool m_ComputePipelineNotReady = false;
 
         // Cache for internal state
 
@@ -1040,6 +1040,10 @@ namespace nvrhi::d3d12
         
         ComputePipelineHandle createComputePipeline(const ComputePipelineDesc& desc) override;
 
+        GraphicsPipelineHandle createGraphicsPipelineAsync(const GraphicsPipelineDesc& desc, IFramebuffer* fb) override;
+        ComputePipelineHandle createComputePipelineAsync(const ComputePipelineDesc& desc) override;
+        PipelineCompileStatistics getPipelineCompileStatistics() override;
+
         MeshletPipelineHandle createMeshletPipeline(const MeshletPipelineDesc& desc, IFramebuffer* fb) override;
 
         rt::PipelineHandle createRayTracingPipeline(const rt::PipelineDesc& desc) override;
@@ -1085,6 +1089,8 @@ namespace nvrhi::d3d12
         HANDLE m_FenceEvent;
 
         std::vector<ID3D12CommandList*> m_CommandListsToExecute; // used locally in executeCommandLists, member to avoid re-allocations
+
+        AsyncPipelineCompiler m_AsyncPipelineCompiler;
         
         bool m_NvapiIsInitialized = false;
         bool m_SinglePassStereoSupported = false;
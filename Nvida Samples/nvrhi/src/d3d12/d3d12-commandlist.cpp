@@ -233,6 +233,8 @@ namespace nvrhi::d3d12
         m_CurrentComputeStateValid = false;
         m_CurrentMeshletStateValid = false;
         m_CurrentRayTracingStateValid = false;
+        m_GraphicsPipelineNotReady = false;
+        m_ComputePipelineNotReady = false;
         m_CurrentHeapSRVetc = nullptr;
         m_CurrentHeapSamplers = nullptr;
         m_CurrentGraphicsVolatileCBs.resize(0);
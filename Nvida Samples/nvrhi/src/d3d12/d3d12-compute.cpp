@@ -81,6 +81,8 @@ namespace nvrhi::d3d12
     ComputePipelineHandle Device::createComputePipeline(const ComputePipelineDesc& desc)
     {
         RefCountPtr<RootSignature> pRS = getRootSignature(desc.bindingLayouts, false);
+        if (!pRS)
+            return nullptr;
         RefCountPtr<ID3D12PipelineState> pPSO = createPipelineState(desc, pRS);
 
         if (pPSO == nullptr)
@@ -96,8 +98,16 @@ namespace nvrhi::d3d12
         return ComputePipelineHandle::Create(pso);
     }
 
-    void CommandList::setComputeState(const ComputeState& state)
+    void CommandList::setComputeState(const ComputeState& _state)
     {
+        ComputeState resolvedState;
+        const ComputeState* pState = resolveAsyncPipeline(_state, resolvedState, m_Desc.pipelineNotReadyPolicy);
+        m_ComputePipelineNotReady = (pState == nullptr);
+        if (!pState)
+            return;
+
+        const ComputeState& state = *pState;
+
         ComputePipeline* pso = checked_cast<ComputePipeline*>(state.pipeline);
 
         const bool updateRootSignature = !m_CurrentComputeStateValid || m_CurrentComputeState.pipeline == nullptr ||
@@ -164,6 +174,9 @@ namespace nvrhi::d3d12
 
     void CommandList::dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
     {
+        if (m_ComputePipelineNotReady)
+            return;
+
         updateComputeVolatileBuffers();
 
         m_ActiveCommandList->commandList->Dispatch(groupsX, groupsY, groupsZ);
@@ -171,6 +184,9 @@ namespace nvrhi::d3d12
 
     void CommandList::dispatchIndirect(uint32_t offsetBytes)
     {
+        if (m_ComputePipelineNotReady)
+            return;
+
         Buffer* indirectParams = checked_cast<Buffer*>(m_CurrentComputeState.indirectParams);
         assert(indirectParams); // validation layer handles this
 
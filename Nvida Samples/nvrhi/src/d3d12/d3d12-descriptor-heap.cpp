@@ -108,46 +108,27 @@ namespace nvrhi::d3d12
     {
         std::lock_guard lockGuard(m_Mutex);
 
-        DescriptorIndex foundIndex = 0;
-        uint32_t freeCount = 0;
-        bool found = false;
+        if (count == 0)
+            return 0;
 
-        // Find a contiguous range of 'count' indices for which m_AllocatedDescriptors[index] is false
+        // Find a contiguous range of 'count' free descriptors, skipping fully allocated regions of the heap
 
-        for (DescriptorIndex index = m_SearchStart; index < m_NumDescriptors; index++)
-        {
-            if (m_AllocatedDescriptors[index])
-                freeCount = 0;
-            else
-                freeCount += 1;
+        DescriptorIndex foundIndex = m_AllocatedDescriptors.allocateRange(count);
 
-            if (freeCount >= count)
-            {
-                foundIndex = index - count + 1;
-                found = true;
-                break;
-            }
-        }
-
-        if (!found)
+        if (foundIndex == utils::HierarchicalBitmap::c_Invalid)
         {
-            foundIndex = m_NumDescriptors;
-
             if (FAILED(Grow(m_NumDescriptors + count)))
             {
                 m_Context.error("Failed to grow a descriptor heap!");
                 return c_InvalidDescriptorIndex;
             }
-        }
 
-        for (DescriptorIndex index = foundIndex; index < foundIndex + count; index++)
-        {
-            m_AllocatedDescriptors[index] = true;
+            // The grown heap has at least 'count' free descriptors at the end
+            foundIndex = m_AllocatedDescriptors.allocateRange(count);
         }
 
         m_NumAllocatedDescriptors += count;
 
-        m_SearchStart = foundIndex + count;
         return foundIndex;
     }
 
@@ -163,22 +144,19 @@ namespace nvrhi::d3d12
         if (count == 0)
             return;
 
+#ifdef _DEBUG
         for (DescriptorIndex index = baseIndex; index < baseIndex + count; index++)
         {
-#ifdef _DEBUG
-            if (!m_AllocatedDescriptors[index])
+            if (!m_AllocatedDescriptors.isAllocated(index))
             {
                 m_Context.error("Attempted to release an un-allocated descriptor");
             }
+        }
 #endif
 
-            m_AllocatedDescriptors[index] = false;
-        }
+        m_AllocatedDescriptors.releaseRange(baseIndex, count);
 
         m_NumAllocatedDescriptors -= count;
-
-        if (m_SearchStart > baseIndex)
-            m_SearchStart = baseIndex;
     }
 
     void StaticDescriptorHeap::releaseDescriptor(DescriptorIndex index)
@@ -62,7 +62,7 @@ namespace nvrhi::d3d12
         , depthStencilViewHeap(context)
         , shaderResourceViewHeap(context)
         , samplerHeap(context)
-        , timerQueries(desc.timerQueryHeapSize, true)
+        , timerQueries(desc.timerQueryHeapSize)
         , m_Context(context)
     {
     }
@@ -86,6 +86,7 @@ namespace nvrhi::d3d12
 
     Device::Device(const DeviceDesc& desc)
         : m_Resources(m_Context, desc)
+        , m_AsyncPipelineCompiler(this)
     {
         m_Context.device = desc.pDevice;
         m_Context.messageCallback = desc.errorCB;
@@ -191,6 +192,8 @@ namespace nvrhi::d3d12
 
     Device::~Device()
     {
+        m_AsyncPipelineCompiler.shutdown();
+
         waitForIdle();
 
         if (m_FenceEvent)
@@ -200,6 +203,21 @@ namespace nvrhi::d3d12
         }
     }
 
+    GraphicsPipelineHandle Device::createGraphicsPipelineAsync(const GraphicsPipelineDesc& desc, IFramebuffer* fb)
+    {
+        return m_AsyncPipelineCompiler.createGraphicsPipeline(desc, fb);
+    }
+
+    ComputePipelineHandle Device::createComputePipelineAsync(const ComputePipelineDesc& desc)
+    {
+        return m_AsyncPipelineCompiler.createComputePipeline(desc);
+    }
+
+    PipelineCompileStatistics Device::getPipelineCompileStatistics()
+    {
+        return m_AsyncPipelineCompiler.getStatistics();
+    }
+
     void Device::waitForIdle()
     {
         // Wait for every queue to reach its last submitted instance
@@ -378,6 +396,25 @@ namespace nvrhi::d3d12
                 }
             }
         }
+
+        // Drop the cached root signatures that no pipeline uses anymore. A reference can only
+        // be taken from the cache under the lock, so a count of 1 there means it's the cache's.
+        std::vector<RefCountPtr<RootSignature>> unusedRootSignatures;
+        {
+            std::lock_guard<std::mutex> lock(m_Resources.rootsigCacheMutex);
+
+            for (auto it = m_Resources.rootsigCache.begin(); it != m_Resources.rootsigCache.end(); )
+            {
+                it->second->AddRef();
+                if (it->second->Release() == 1)
+                {
+                    unusedRootSignatures.push_back(std::move(it->second));
+                    it = m_Resources.rootsigCache.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
     }
 
     bool Device::queryFeatureSupport(Feature feature, void* pInfo, size_t infoSize)
@@ -178,6 +178,8 @@ namespace nvrhi::d3d12
     GraphicsPipelineHandle Device::createGraphicsPipeline(const GraphicsPipelineDesc& desc, IFramebuffer* fb)
     {
         RefCountPtr<RootSignature> pRS = getRootSignature(desc.bindingLayouts, desc.inputLayout != nullptr);
+        if (!pRS)
+            return nullptr;
 
         RefCountPtr<ID3D12PipelineState> pPSO = createPipelineState(desc, pRS, fb->getFramebufferInfo());
 
@@ -284,8 +286,16 @@ namespace nvrhi::d3d12
         m_ActiveCommandList->commandList->OMSetRenderTargets(UINT(RTVs.size()), RTVs.data(), false, fb->desc.depthAttachment.valid() ? &DSV : nullptr);
     }
 
-    void CommandList::setGraphicsState(const GraphicsState& state)
+    void CommandList::setGraphicsState(const GraphicsState& _state)
     {
+        GraphicsState resolvedState;
+        const GraphicsState* pState = resolveAsyncPipeline(_state, resolvedState, m_Desc.pipelineNotReadyPolicy);
+        m_GraphicsPipelineNotReady = (pState == nullptr);
+        if (!pState)
+            return;
+
+        const GraphicsState& state = *pState;
+
         GraphicsPipeline* pso = checked_cast<GraphicsPipeline*>(state.pipeline);
         Framebuffer* framebuffer = checked_cast<Framebuffer*>(state.framebuffer);
 
@@ -526,6 +536,9 @@ namespace nvrhi::d3d12
 
     void CommandList::draw(const DrawArguments& args)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         updateGraphicsVolatileBuffers();
 
         m_ActiveCommandList->commandList->DrawInstanced(args.vertexCount, args.instanceCount, args.startVertexLocation, args.startInstanceLocation);
@@ -533,6 +546,9 @@ namespace nvrhi::d3d12
 
     void CommandList::drawIndexed(const DrawArguments& args)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         updateGraphicsVolatileBuffers();
 
         m_ActiveCommandList->commandList->DrawIndexedInstanced(args.vertexCount, args.instanceCount, args.startIndexLocation, args.startVertexLocation, args.startInstanceLocation);
@@ -540,6 +556,9 @@ namespace nvrhi::d3d12
 
     void CommandList::drawIndirect(uint32_t offsetBytes)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         Buffer* indirectParams = checked_cast<Buffer*>(m_CurrentGraphicsState.indirectParams);
         assert(indirectParams); // validation layer handles this
 
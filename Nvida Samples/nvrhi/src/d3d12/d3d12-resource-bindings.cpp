@@ -617,7 +617,7 @@ namespace nvrhi::d3d12
     {
         HRESULT res;
 
-        RootSignature* rootsig = new RootSignature(m_Resources);
+        RootSignature* rootsig = new RootSignature();
         
         // Assemble the root parameter table from the pipeline binding layouts
         // Also attach the root parameter offsets to the pipeline layouts
@@ -721,28 +721,25 @@ namespace nvrhi::d3d12
         
         hash_combine(hash, allowInputLayout ? 1u : 0u);
         
+        std::lock_guard<std::mutex> lock(m_Resources.rootsigCacheMutex);
+
         // Get a cached RS and AddRef it (if it exists)
-        RefCountPtr<RootSignature> rootsig = m_Resources.rootsigCache[hash];
+        const auto it = m_Resources.rootsigCache.find(hash);
+        if (it != m_Resources.rootsigCache.end())
+            return it->second;
 
-        if (!rootsig)
-        {
-            // Does not exist - build a new one, take ownership
-            rootsig = checked_cast<RootSignature*>(buildRootSignature(pipelineLayouts, allowInputLayout, false).Get());
-            rootsig->hash = hash;
+        // Does not exist - build a new one
+        RootSignatureHandle newRootsig = buildRootSignature(pipelineLayouts, allowInputLayout, false);
+        if (!newRootsig)
+            return nullptr;
 
-            m_Resources.rootsigCache[hash] = rootsig;
-        }
+        RefCountPtr<RootSignature> rootsig = checked_cast<RootSignature*>(newRootsig.Get());
+        rootsig->hash = hash;
 
-        // Pass ownership of the RS to caller
-        return rootsig;
-    }
+        m_Resources.rootsigCache[hash] = rootsig;
 
-    RootSignature::~RootSignature()
-    {
-        // Remove the root signature from the cache
-        const auto it = m_Resources.rootsigCache.find(hash);
-        if (it != m_Resources.rootsigCache.end())
-            m_Resources.rootsigCache.erase(it);
+        // Pass a reference to the RS to caller, the cache keeps its own
+        return rootsig;
     }
 
     bool Device::writeDescriptorTable(IDescriptorTable* _descriptorTable, const BindingSetItem& binding)
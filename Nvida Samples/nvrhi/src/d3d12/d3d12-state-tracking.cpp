@@ -109,6 +109,24 @@ namespace nvrhi::d3d12
             D3D12_RESOURCE_BARRIER d3dbarrier{};
             const D3D12_RESOURCE_STATES stateBefore = convertResourceStates(barrier.stateBefore);
             const D3D12_RESOURCE_STATES stateAfter = convertResourceStates(barrier.stateAfter);
+
+            if (barrier.aliasing)
+            {
+                // Subresource-level aliasing barriers come in groups that cover the whole texture, place only one
+                if (barrier.entireTexture || (barrier.mipLevel == 0 && barrier.arraySlice == 0))
+                {
+                    d3dbarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+                    d3dbarrier.Aliasing.pResourceBefore = nullptr;
+                    d3dbarrier.Aliasing.pResourceAfter = texture->resource;
+                    m_D3DBarriers.push_back(d3dbarrier);
+                }
+
+                if (stateBefore == stateAfter)
+                    continue;
+
+                d3dbarrier = {};
+            }
+
             if (stateBefore != stateAfter)
             {
                 d3dbarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -145,6 +163,20 @@ namespace nvrhi::d3d12
             D3D12_RESOURCE_BARRIER d3dbarrier{};
             const D3D12_RESOURCE_STATES stateBefore = convertResourceStates(barrier.stateBefore);
             const D3D12_RESOURCE_STATES stateAfter = convertResourceStates(barrier.stateAfter);
+
+            if (barrier.aliasing)
+            {
+                d3dbarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+                d3dbarrier.Aliasing.pResourceBefore = nullptr;
+                d3dbarrier.Aliasing.pResourceAfter = buffer->resource;
+                m_D3DBarriers.push_back(d3dbarrier);
+
+                if (stateBefore == stateAfter)
+                    continue;
+
+                d3dbarrier = {};
+            }
+
             if (stateBefore != stateAfter && 
                 (stateBefore & D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE) == 0 &&
                 (stateAfter & D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE) == 0)
@@ -237,6 +269,20 @@ namespace nvrhi::d3d12
         m_StateTracker.endTrackingBufferState(buffer, stateBits, false);
     }
 
+    void CommandList::placeTextureAliasingBarrier(ITexture* _texture)
+    {
+        Texture* texture = checked_cast<Texture*>(_texture);
+
+        m_StateTracker.placeTextureAliasingBarrier(texture);
+    }
+
+    void CommandList::placeBufferAliasingBarrier(IBuffer* _buffer)
+    {
+        Buffer* buffer = checked_cast<Buffer*>(_buffer);
+
+        m_StateTracker.placeBufferAliasingBarrier(buffer);
+    }
+
     void CommandList::setAccelStructState(rt::IAccelStruct* _as, ResourceStates stateBits)
     {
         AccelStruct* as = checked_cast<AccelStruct*>(_as);
@@ -205,6 +205,8 @@ namespace nvrhi::validation
         void setTextureState(ITexture* texture, TextureSubresourceSet subresources, ResourceStates stateBits) override;
         void setBufferState(IBuffer* buffer, ResourceStates stateBits) override;
         void setAccelStructState(rt::IAccelStruct* as, ResourceStates stateBits) override;
+        void placeTextureAliasingBarrier(ITexture* texture) override;
+        void placeBufferAliasingBarrier(IBuffer* buffer) override;
 
         void setPermanentTextureState(ITexture* texture, ResourceStates stateBits) override;
         void setPermanentBufferState(IBuffer* buffer, ResourceStates stateBits) override;
@@ -237,6 +239,8 @@ namespace nvrhi::validation
         bool validatePipelineBindingLayouts(const static_vector<BindingLayoutHandle, c_MaxBindingLayouts>& bindingLayouts, const std::vector<IShader*>& shaders, GraphicsAPI api) const;
         bool validateShaderType(ShaderType expected, const ShaderDesc& shaderDesc, const char* function) const;
         bool validateRenderState(const RenderState& renderState, IFramebuffer* fb) const;
+        bool validateGraphicsPipelineDesc(const GraphicsPipelineDesc& pipelineDesc, IFramebuffer* fb, const char* function) const;
+        bool validateComputePipelineDesc(const ComputePipelineDesc& pipelineDesc, const char* function) const;
 
     public:
 
@@ -295,6 +299,10 @@ namespace nvrhi::validation
 
         ComputePipelineHandle createComputePipeline(const ComputePipelineDesc& desc) override;
 
+        GraphicsPipelineHandle createGraphicsPipelineAsync(const GraphicsPipelineDesc& desc, IFramebuffer* fb) override;
+        ComputePipelineHandle createComputePipelineAsync(const ComputePipelineDesc& desc) override;
+        PipelineCompileStatistics getPipelineCompileStatistics() override;
+
         MeshletPipelineHandle createMeshletPipeline(const MeshletPipelineDesc& desc, IFramebuffer* fb) override;
 
         rt::PipelineHandle createRayTracingPipeline(const rt::PipelineDesc& desc) override;
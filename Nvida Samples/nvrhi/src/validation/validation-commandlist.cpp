@@ -962,6 +962,40 @@ namespace nvrhi::validation
         m_CommandList->setBufferState(buffer, stateBits);
     }
 
+    void CommandListWrapper::placeTextureAliasingBarrier(ITexture* texture)
+    {
+        if (!requireOpenState())
+            return;
+
+        if (!texture->getDesc().isVirtual)
+        {
+            std::stringstream ss;
+            ss << "placeTextureAliasingBarrier: texture " << utils::DebugNameToString(texture->getDesc().debugName)
+                << " is not a virtual texture, it cannot share memory with other resources";
+            error(ss.str());
+            return;
+        }
+
+        m_CommandList->placeTextureAliasingBarrier(texture);
+    }
+
+    void CommandListWrapper::placeBufferAliasingBarrier(IBuffer* buffer)
+    {
+        if (!requireOpenState())
+            return;
+
+        if (!buffer->getDesc().isVirtual)
+        {
+            std::stringstream ss;
+            ss << "placeBufferAliasingBarrier: buffer " << utils::DebugNameToString(buffer->getDesc().debugName)
+                << " is not a virtual buffer, it cannot share memory with other resources";
+            error(ss.str());
+            return;
+        }
+
+        m_CommandList->placeBufferAliasingBarrier(buffer);
+    }
+
     void CommandListWrapper::setAccelStructState(rt::IAccelStruct* as, ResourceStates stateBits)
     {
         if (!requireOpenState())
@@ -1007,7 +1007,7 @@ namespace nvrhi::validation
         return true;
     }
 
-    GraphicsPipelineHandle DeviceWrapper::createGraphicsPipeline(const GraphicsPipelineDesc& pipelineDesc, IFramebuffer* fb)
+    bool DeviceWrapper::validateGraphicsPipelineDesc(const GraphicsPipelineDesc& pipelineDesc, IFramebuffer* fb, const char* function) const
     {
         std::vector<IShader*> shaders;
 
@@ -1018,39 +1018,78 @@ namespace nvrhi::validation
             {
                 shaders.push_back(shader);
 
-                if (!validateShaderType(stage, shader->getDesc(), "createGraphicsPipeline"))
-                    return nullptr;
+                if (!validateShaderType(stage, shader->getDesc(), function))
+                    return false;
             }
         }
 
         if (!validatePipelineBindingLayouts(pipelineDesc.bindingLayouts, shaders, m_Device->getGraphicsAPI()))
-            return nullptr;
+            return false;
 
         if (!validateRenderState(pipelineDesc.renderState, fb))
-            return nullptr;
+            return false;
 
-        return m_Device->createGraphicsPipeline(pipelineDesc, fb);
+        return true;
     }
 
-    ComputePipelineHandle DeviceWrapper::createComputePipeline(const ComputePipelineDesc& pipelineDesc)
+    bool DeviceWrapper::validateComputePipelineDesc(const ComputePipelineDesc& pipelineDesc, const char* function) const
     {
         if (!pipelineDesc.CS)
         {
-            error("createComputePipeline: CS = NULL");
-            return nullptr;
+            std::stringstream ss;
+            ss << function << ": CS = NULL";
+            error(ss.str());
+            return false;
         }
 
         std::vector<IShader*> shaders = { pipelineDesc.CS };
         
         if (!validatePipelineBindingLayouts(pipelineDesc.bindingLayouts, shaders, m_Device->getGraphicsAPI()))
+            return false;
+
+        if (!validateShaderType(ShaderType::Compute, pipelineDesc.CS->getDesc(), function))
+            return false;
+
+        return true;
+    }
+
+    GraphicsPipelineHandle DeviceWrapper::createGraphicsPipeline(const GraphicsPipelineDesc& pipelineDesc, IFramebuffer* fb)
+    {
+        if (!validateGraphicsPipelineDesc(pipelineDesc, fb, "createGraphicsPipeline"))
             return nullptr;
 
-        if (!validateShaderType(ShaderType::Compute, pipelineDesc.CS->getDesc(), "createComputePipeline"))
+        return m_Device->createGraphicsPipeline(pipelineDesc, fb);
+    }
+
+    ComputePipelineHandle DeviceWrapper::createComputePipeline(const ComputePipelineDesc& pipelineDesc)
+    {
+        if (!validateComputePipelineDesc(pipelineDesc, "createComputePipeline"))
             return nullptr;
 
         return m_Device->createComputePipeline(pipelineDesc);
     }
 
+    GraphicsPipelineHandle DeviceWrapper::createGraphicsPipelineAsync(const GraphicsPipelineDesc& pipelineDesc, IFramebuffer* fb)
+    {
+        if (!validateGraphicsPipelineDesc(pipelineDesc, fb, "createGraphicsPipelineAsync"))
+            return nullptr;
+
+        return m_Device->createGraphicsPipelineAsync(pipelineDesc, fb);
+    }
+
+    ComputePipelineHandle DeviceWrapper::createComputePipelineAsync(const ComputePipelineDesc& pipelineDesc)
+    {
+        if (!validateComputePipelineDesc(pipelineDesc, "createComputePipelineAsync"))
+            return nullptr;
+
+        return m_Device->createComputePipelineAsync(pipelineDesc);
+    }
+
+    PipelineCompileStatistics DeviceWrapper::getPipelineCompileStatistics()
+    {
+        return m_Device->getPipelineCompileStatistics();
+    }
+
     MeshletPipelineHandle DeviceWrapper::createMeshletPipeline(const MeshletPipelineDesc& pipelineDesc, IFramebuffer* fb)
     {
         std::vector<IShader*> shaders;
@@ -25,9 +25,14 @@
 #include <nvrhi/vulkan.h>
 #include <nvrhi/utils.h>
 #include "../common/state-tracking.h"
+#include "../common/upload-chunk-pool.h"
+#include "../common/upload-ring.h"
 #include "../common/versioning.h"
+#include "../common/async-pipeline.h"
 #include <mutex>
 #include <list>
+#include <array>
+#include <deque>
 
 #ifdef NVRHI_WITH_RTXMU
 #include <rtxmu/VkAccelStructManager.h>
@@ -900,35 +905,66 @@ namespace nvrhi::vulkan
         uint64_t version = 0;
         uint64_t bufferSize = 0;
         uint64_t writePointer = 0;
+        uint64_t usedBytes = 0; // sum of the sizes of all suballocations, excluding alignment padding
         void* mappedMemory = nullptr;
 
         static constexpr uint64_t c_sizeAlignment = 4096; // GPU page size
     };
 
+    // Sub-allocates upload or scratch memory for a command list.
+    // Most allocations are placed into a persistent ring buffer whose tail is reclaimed as the command list
+    // instances that used it complete on the GPU. Allocations that are too large for the ring, or that are made
+    // while the ring is full, go into standalone chunks, which are recycled through an UploadChunkPool.
+    // The manager registers with the device, which sums the statistics that each manager publishes on submission.
     class UploadManager
     {
     public:
-        UploadManager(Device* pParent, uint64_t defaultChunkSize, uint64_t memoryLimit, bool isScratchBuffer)
-            : m_Device(pParent)
-            , m_DefaultChunkSize(defaultChunkSize)
-            , m_MemoryLimit(memoryLimit)
-            , m_IsScratchBuffer(isScratchBuffer)
-        { }
+        UploadManager(Device* pParent, uint64_t defaultChunkSize, uint64_t memoryLimit, bool isScratchBuffer);
+        ~UploadManager();
+
+        UploadManager(const UploadManager&) = delete;
+        UploadManager& operator=(const UploadManager&) = delete;
 
         std::shared_ptr<BufferChunk> CreateChunk(uint64_t size);
 
         bool suballocateBuffer(uint64_t size, Buffer** pBuffer, uint64_t* pOffset, void** pCpuVA, uint64_t currentVersion, uint32_t alignment = 256);
         void submitChunks(uint64_t currentVersion, uint64_t submittedVersion);
 
+        [[nodiscard]] UploadStatistics getStatistics() const;
+        // Statistics as of the last submitChunks(...), safe to call from any thread
+        [[nodiscard]] UploadStatistics getPublishedStatistics() const;
+        [[nodiscard]] bool isScratchBuffer() const { return m_IsScratchBuffer; }
+
     private:
+        // Pooled chunks that were not reused by this many submissions of the command list are released
+        static constexpr uint64_t c_MaxIdleSubmissions = 64;
+
         Device* m_Device;
         uint64_t m_DefaultChunkSize = 0;
         uint64_t m_MemoryLimit = 0;
-        uint64_t m_AllocatedMemory = 0;
         bool m_IsScratchBuffer = false;
 
-        std::list<std::shared_ptr<BufferChunk>> m_ChunkPool;
+        // The ring buffer and the bookkeeping of its free space
+        std::shared_ptr<BufferChunk> m_Ring;
+        std::unique_ptr<UploadRing> m_RingAllocator;
+
+        // Standalone chunks: the one being filled, the ones waiting for the GPU (oldest first), and the available ones
         std::shared_ptr<BufferChunk> m_CurrentChunk;
+        std::deque<std::shared_ptr<BufferChunk>> m_RetiredChunks;
+        UploadChunkPool<BufferChunk> m_ChunkPool;
+
+        // Statistics of the standalone chunks, getStatistics() adds the ones of the ring.
+        // peakBytesInFlight covers both and is updated after every allocation.
+        UploadStatistics m_Statistics;
+
+        mutable std::mutex m_PublishedStatisticsMutex;
+        UploadStatistics m_PublishedStatistics;
+
+        void reclaim(uint64_t currentVersion);
+        std::shared_ptr<BufferChunk> acquireChunk(uint64_t size);
+        void retireChunk(std::shared_ptr<BufferChunk> chunk);
+        void addBytesInFlight(uint64_t bytes);
+        void updatePeakBytesInFlight();
     };
 
     class AccelStruct : public RefCounter<rt::IAccelStruct>
@@ -1028,6 +1064,10 @@ namespace nvrhi::vulkan
 
         ComputePipelineHandle createComputePipeline(const ComputePipelineDesc& desc) override;
 
+        GraphicsPipelineHandle createGraphicsPipelineAsync(const GraphicsPipelineDesc& desc, IFramebuffer* fb) override;
+        ComputePipelineHandle createComputePipelineAsync(const ComputePipelineDesc& desc) override;
+        PipelineCompileStatistics getPipelineCompileStatistics() override;
+
         MeshletPipelineHandle createMeshletPipeline(const MeshletPipelineDesc& desc, IFramebuffer* fb) override;
 
         rt::PipelineHandle createRayTracingPipeline(const rt::PipelineDesc& desc) override;
@@ -1062,6 +1102,12 @@ namespace nvrhi::vulkan
         uint64_t queueGetCompletedInstance(CommandQueue queue) override;
         FramebufferHandle createHandleForNativeFramebuffer(vk::RenderPass renderPass, vk::Framebuffer framebuffer,
             const FramebufferDesc& desc, bool transferOwnership) override;
+        UploadStatistics getUploadStatistics() override;
+        UploadStatistics getScratchStatistics() override;
+
+        // Internal methods
+        void registerUploadManager(UploadManager* manager);
+        void unregisterUploadManager(UploadManager* manager);
 
     private:
         VulkanContext m_Context;
@@ -1071,8 +1117,16 @@ namespace nvrhi::vulkan
         vk::QueryPool m_TimerQueryPool = nullptr;
         utils::BitSetAllocator m_TimerQueryAllocator;
 
+        // Declared before the queues, which can hold the last references to command lists and their upload managers
+        std::mutex m_UploadManagersMutex;
+        std::vector<UploadManager*> m_UploadManagers;
+
         // array of submission queues
         std::array<std::unique_ptr<Queue>, uint32_t(CommandQueue::Count)> m_Queues;
+
+        AsyncPipelineCompiler m_AsyncPipelineCompiler;
+
+        UploadStatistics sumUploadStatistics(bool scratch);
         
         void *mapBuffer(IBuffer* b, CpuAccessMode flags, uint64_t offset, size_t size) const;
     };
@@ -1151,6 +1205,8 @@ namespace nvrhi::vulkan
         void setTextureState(ITexture* texture, TextureSubresourceSet subresources, ResourceStates stateBits) override;
         void setBufferState(IBuffer* buffer, ResourceStates stateBits) override;
         void setAccelStructState(rt::IAccelStruct* _as, ResourceStates stateBits) override;
+        void placeTextureAliasingBarrier(ITexture* texture) override;
+        void placeBufferAliasingBarrier(IBuffer* buffer) override;
 
         void setPermanentTextureState(ITexture* texture, ResourceStates stateBits) override;
         void setPermanentBufferState(IBuffer* buffer, ResourceStates stateBits) override;
@@ -1184,6 +1240,10 @@ namespace nvrhi::vulkan
         MeshletState m_CurrentMeshletState{};
         rt::State m_CurrentRayTracingState;
         bool m_AnyVolatileBufferWrites = false;
+        // Set when an async pipeline is skipped, see PipelineNotReadyPolicy. Kept per pipeline type because
+        // binding a compute pipeline does not affect the graphics pipeline that draws use, and vice versa.
+        bool m_GraphicsPipelineNotReady = false;
+        bool m_ComputePipelineNotReady = false;
 
         struct ShaderTableState
         {
@@ -1200,6 +1260,7 @@ namespace nvrhi::vulkan
         std::unique_ptr<UploadManager> m_ScratchManager;
         
         void clearTexture(ITexture* texture, TextureSubresourceSet subresources, const vk::ClearColorValue& clearValue);
+        void commitAliasingBarriers();
 
         void bindBindingSets(vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, const BindingSetVector& bindings);
 
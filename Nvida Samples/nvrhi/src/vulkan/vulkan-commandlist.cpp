@@ -95,6 +95,8 @@ namespace nvrhi::vulkan
         m_CurrentShaderTablePointers = ShaderTableState();
 
         m_AnyVolatileBufferWrites = false;
+        m_GraphicsPipelineNotReady = false;
+        m_ComputePipelineNotReady = false;
 
         // TODO: add real context clearing code here 
     }
@@ -146,8 +146,16 @@ namespace nvrhi::vulkan
         }
     }
 
-    void CommandList::setComputeState(const ComputeState& state)
+    void CommandList::setComputeState(const ComputeState& _state)
     {
+        ComputeState resolvedState;
+        const ComputeState* pState = resolveAsyncPipeline(_state, resolvedState, m_CommandListParameters.pipelineNotReadyPolicy);
+        m_ComputePipelineNotReady = (pState == nullptr);
+        if (!pState)
+            return;
+
+        const ComputeState& state = *pState;
+
         endRenderPass();
 
         assert(m_CurrentCmdBuf);
@@ -220,6 +228,9 @@ namespace nvrhi::vulkan
 
     void CommandList::dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
     {
+        if (m_ComputePipelineNotReady)
+            return;
+
         assert(m_CurrentCmdBuf);
 
         updateComputeVolatileBuffers();
@@ -229,6 +240,9 @@ namespace nvrhi::vulkan
 
     void CommandList::dispatchIndirect(uint32_t offsetBytes)
     {
+        if (m_ComputePipelineNotReady)
+            return;
+
         assert(m_CurrentCmdBuf);
 
         updateComputeVolatileBuffers();
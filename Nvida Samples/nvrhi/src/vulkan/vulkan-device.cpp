@@ -21,6 +21,7 @@
 */
 
 #include "vulkan-backend.h"
+#include <algorithm>
 #include <unordered_map>
 
 #include <nvrhi/common/misc.h>
@@ -50,7 +51,8 @@ namespace nvrhi::vulkan
     Device::Device(const DeviceDesc& desc)
         : m_Context(desc.instance, desc.physicalDevice, desc.device, desc.allocationCallbacks)
         , m_Allocator(m_Context)
-        , m_TimerQueryAllocator(c_NumTimerQueries, true)
+        , m_TimerQueryAllocator(c_NumTimerQueries)
+        , m_AsyncPipelineCompiler(this)
     {
         if (desc.graphicsQueue)
         {
@@ -170,6 +172,9 @@ namespace nvrhi::vulkan
 
     Device::~Device()
     {
+        // Stop the compiler threads before the pipeline cache is destroyed
+        m_AsyncPipelineCompiler.shutdown();
+
         if (m_TimerQueryPool)
         {
             m_Context.device.destroyQueryPool(m_TimerQueryPool);
@@ -183,6 +188,70 @@ namespace nvrhi::vulkan
         }
     }
 
+    GraphicsPipelineHandle Device::createGraphicsPipelineAsync(const GraphicsPipelineDesc& desc, IFramebuffer* fb)
+    {
+        return m_AsyncPipelineCompiler.createGraphicsPipeline(desc, fb);
+    }
+
+    ComputePipelineHandle Device::createComputePipelineAsync(const ComputePipelineDesc& desc)
+    {
+        return m_AsyncPipelineCompiler.createComputePipeline(desc);
+    }
+
+    PipelineCompileStatistics Device::getPipelineCompileStatistics()
+    {
+        return m_AsyncPipelineCompiler.getStatistics();
+    }
+
+    UploadStatistics Device::getUploadStatistics()
+    {
+        return sumUploadStatistics(false);
+    }
+
+    UploadStatistics Device::getScratchStatistics()
+    {
+        return sumUploadStatistics(true);
+    }
+
+    UploadStatistics Device::sumUploadStatistics(bool scratch)
+    {
+        UploadStatistics result;
+
+        std::lock_guard lockGuard(m_UploadManagersMutex);
+        for (const UploadManager* manager : m_UploadManagers)
+        {
+            if (manager->isScratchBuffer() != scratch)
+                continue;
+
+            const UploadStatistics statistics = manager->getPublishedStatistics();
+            result.bytesInFlight += statistics.bytesInFlight;
+            result.peakBytesInFlight += statistics.peakBytesInFlight;
+            result.wastedBytes += statistics.wastedBytes;
+            result.allocatedMemory += statistics.allocatedMemory;
+            result.pooledMemory += statistics.pooledMemory;
+            result.ringAllocations += statistics.ringAllocations;
+            result.chunkAllocations += statistics.chunkAllocations;
+            result.chunksCreated += statistics.chunksCreated;
+            result.chunksReleased += statistics.chunksReleased;
+        }
+
+        return result;
+    }
+
+    void Device::registerUploadManager(UploadManager* manager)
+    {
+        std::lock_guard lockGuard(m_UploadManagersMutex);
+        m_UploadManagers.push_back(manager);
+    }
+
+    void Device::unregisterUploadManager(UploadManager* manager)
+    {
+        std::lock_guard lockGuard(m_UploadManagersMutex);
+        auto it = std::find(m_UploadManagers.begin(), m_UploadManagers.end(), manager);
+        if (it != m_UploadManagers.end())
+            m_UploadManagers.erase(it);
+    }
+
     Object Device::getNativeObject(ObjectType objectType)
     {
         switch (objectType)
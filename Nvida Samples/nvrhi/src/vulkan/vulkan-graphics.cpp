@@ -639,8 +639,16 @@ namespace nvrhi::vulkan
         return vk::Viewport(v.minX, v.maxY, v.maxX - v.minX, -(v.maxY - v.minY), v.minZ, v.maxZ);
     }
 
-    void CommandList::setGraphicsState(const GraphicsState& state)
+    void CommandList::setGraphicsState(const GraphicsState& _state)
     {
+        GraphicsState resolvedState;
+        const GraphicsState* pState = resolveAsyncPipeline(_state, resolvedState, m_CommandListParameters.pipelineNotReadyPolicy);
+        m_GraphicsPipelineNotReady = (pState == nullptr);
+        if (!pState)
+            return;
+
+        const GraphicsState& state = *pState;
+
         assert(m_CurrentCmdBuf);
 
         GraphicsPipeline* pso = checked_cast<GraphicsPipeline*>(state.pipeline);
@@ -784,6 +792,9 @@ namespace nvrhi::vulkan
 
     void CommandList::draw(const DrawArguments& args)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         assert(m_CurrentCmdBuf);
 
         updateGraphicsVolatileBuffers();
@@ -796,6 +807,9 @@ namespace nvrhi::vulkan
 
     void CommandList::drawIndexed(const DrawArguments& args)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         assert(m_CurrentCmdBuf);
 
         updateGraphicsVolatileBuffers();
@@ -809,6 +823,9 @@ namespace nvrhi::vulkan
 
     void CommandList::drawIndirect(uint32_t offsetBytes)
     {
+        if (m_GraphicsPipelineNotReady)
+            return;
+
         assert(m_CurrentCmdBuf);
 
         updateGraphicsVolatileBuffers();
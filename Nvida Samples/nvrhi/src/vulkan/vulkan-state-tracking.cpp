@@ -149,6 +149,70 @@ namespace nvrhi::vulkan
         return !m_StateTracker.getBufferBarriers().empty() || !m_StateTracker.getTextureBarriers().empty();
     }
 
+    void CommandList::commitAliasingBarriers()
+    {
+        // Vulkan has no aliasing barriers as such. The new resource must wait for all prior accesses to the memory,
+        // which is a full memory dependency, and its image contents become undefined.
+
+        bool anyAliasing = false;
+        std::vector<vk::ImageMemoryBarrier> imageBarriers;
+
+        for (const TextureBarrier& barrier : m_StateTracker.getTextureBarriers())
+        {
+            if (!barrier.aliasing)
+                continue;
+
+            anyAliasing = true;
+
+            // Textures tracked in a state without a layout (Common) will be transitioned out of it later
+            ResourceStateMapping after = convertResourceState(barrier.stateAfter);
+            if (after.imageLayout == vk::ImageLayout::eUndefined)
+                continue;
+
+            Texture* texture = static_cast<Texture*>(barrier.texture);
+
+            const FormatInfo& formatInfo = getFormatInfo(texture->desc.format);
+
+            vk::ImageAspectFlags aspectMask = (vk::ImageAspectFlagBits)0;
+            if (formatInfo.hasDepth) aspectMask |= vk::ImageAspectFlagBits::eDepth;
+            if (formatInfo.hasStencil) aspectMask |= vk::ImageAspectFlagBits::eStencil;
+            if (!aspectMask) aspectMask = vk::ImageAspectFlagBits::eColor;
+
+            vk::ImageSubresourceRange subresourceRange = vk::ImageSubresourceRange()
+                .setBaseArrayLayer(barrier.entireTexture ? 0 : barrier.arraySlice)
+                .setLayerCount(barrier.entireTexture ? texture->desc.arraySize : 1)
+                .setBaseMipLevel(barrier.entireTexture ? 0 : barrier.mipLevel)
+                .setLevelCount(barrier.entireTexture ? texture->desc.mipLevels : 1)
+                .setAspectMask(aspectMask);
+
+            imageBarriers.push_back(vk::ImageMemoryBarrier()
+                .setSrcAccessMask(vk::AccessFlagBits::eMemoryWrite)
+                .setDstAccessMask(after.accessMask)
+                .setOldLayout(vk::ImageLayout::eUndefined)
+                .setNewLayout(after.imageLayout)
+                .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+                .setImage(texture->image)
+                .setSubresourceRange(subresourceRange));
+        }
+
+        for (const BufferBarrier& barrier : m_StateTracker.getBufferBarriers())
+        {
+            if (barrier.aliasing)
+                anyAliasing = true;
+        }
+
+        if (!anyAliasing)
+            return;
+
+        auto memoryBarrier = vk::MemoryBarrier()
+            .setSrcAccessMask(vk::AccessFlagBits::eMemoryWrite)
+            .setDstAccessMask(vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite);
+
+        m_CurrentCmdBuf->cmdBuf.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands,
+            vk::DependencyFlags(), { memoryBarrier }, {}, imageBarriers);
+    }
+
     void CommandList::commitBarriers()
     {
         if (m_StateTracker.getBufferBarriers().empty() && m_StateTracker.getTextureBarriers().empty())
@@ -161,8 +225,13 @@ namespace nvrhi::vulkan
         vk::PipelineStageFlags beforeStageFlags = vk::PipelineStageFlags(0);
         vk::PipelineStageFlags afterStageFlags = vk::PipelineStageFlags(0);
 
+        commitAliasingBarriers();
+
         for (const TextureBarrier& barrier : m_StateTracker.getTextureBarriers())
         {
+            if (barrier.aliasing && barrier.stateBefore == barrier.stateAfter)
+                continue; // handled by commitAliasingBarriers
+
             ResourceStateMapping before = convertResourceState(barrier.stateBefore);
             ResourceStateMapping after = convertResourceState(barrier.stateAfter);
 
@@ -218,6 +287,9 @@ namespace nvrhi::vulkan
 
         for (const BufferBarrier& barrier : m_StateTracker.getBufferBarriers())
         {
+            if (barrier.aliasing && barrier.stateBefore == barrier.stateAfter)
+                continue; // handled by commitAliasingBarriers
+
             ResourceStateMapping before = convertResourceState(barrier.stateBefore);
             ResourceStateMapping after = convertResourceState(barrier.stateAfter);
 
@@ -282,6 +354,20 @@ namespace nvrhi::vulkan
         m_StateTracker.endTrackingBufferState(buffer, stateBits, false);
     }
     
+    void CommandList::placeTextureAliasingBarrier(ITexture* _texture)
+    {
+        Texture* texture = checked_cast<Texture*>(_texture);
+
+        m_StateTracker.placeTextureAliasingBarrier(texture);
+    }
+
+    void CommandList::placeBufferAliasingBarrier(IBuffer* _buffer)
+    {
+        Buffer* buffer = checked_cast<Buffer*>(_buffer);
+
+        m_StateTracker.placeBufferAliasingBarrier(buffer);
+    }
+
     void CommandList::setAccelStructState(rt::IAccelStruct* _as, ResourceStates stateBits)
     {
         AccelStruct* as = checked_cast<AccelStruct*>(_as);
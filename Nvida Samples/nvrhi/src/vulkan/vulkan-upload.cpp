@@ -26,6 +26,21 @@
 namespace nvrhi::vulkan
 {
 
+    UploadManager::UploadManager(Device* pParent, uint64_t defaultChunkSize, uint64_t memoryLimit, bool isScratchBuffer)
+        : m_Device(pParent)
+        , m_DefaultChunkSize(defaultChunkSize)
+        , m_MemoryLimit(memoryLimit)
+        , m_IsScratchBuffer(isScratchBuffer)
+        , m_ChunkPool(c_MaxIdleSubmissions)
+    {
+        m_Device->registerUploadManager(this);
+    }
+
+    UploadManager::~UploadManager()
+    {
+        m_Device->unregisterUploadManager(this);
+    }
+
     std::shared_ptr<BufferChunk> UploadManager::CreateChunk(uint64_t size)
     {
         std::shared_ptr<BufferChunk> chunk = std::make_shared<BufferChunk>();
@@ -57,73 +72,183 @@ namespace nvrhi::vulkan
             chunk->bufferSize = size;
         }
 
+        m_Statistics.allocatedMemory += size;
+        m_Statistics.chunksCreated++;
+
         return chunk;
     }
 
-    bool UploadManager::suballocateBuffer(uint64_t size, Buffer** pBuffer, uint64_t* pOffset, void** pCpuVA,
-        uint64_t currentVersion, uint32_t alignment)
+    // Allocations larger than this fraction of the ring go into standalone chunks,
+    // so that a single large upload cannot block the ring for everything else.
+    static constexpr uint64_t c_RingMaxAllocationFraction = 4;
+
+    UploadStatistics UploadManager::getStatistics() const
     {
-        std::shared_ptr<BufferChunk> chunkToRetire;
+        UploadStatistics statistics = m_Statistics;
+        statistics.pooledMemory = m_ChunkPool.getPooledBytes();
 
-        if (m_CurrentChunk)
+        if (m_RingAllocator)
         {
-            uint64_t alignedOffset = align(m_CurrentChunk->writePointer, (uint64_t)alignment);
-            uint64_t endOfDataInChunk = alignedOffset + size;
+            const UploadRing::Statistics& ringStatistics = m_RingAllocator->getStatistics();
+            statistics.bytesInFlight += ringStatistics.bytesInFlight;
+            statistics.wastedBytes += ringStatistics.wastedBytes;
+            statistics.ringAllocations = ringStatistics.allocations;
+        }
 
-            if (endOfDataInChunk <= m_CurrentChunk->bufferSize)
-            {
-                m_CurrentChunk->writePointer = endOfDataInChunk;
+        return statistics;
+    }
 
-                *pBuffer = checked_cast<Buffer*>(m_CurrentChunk->buffer.Get());
-                *pOffset = alignedOffset;
-                if (pCpuVA && m_CurrentChunk->mappedMemory)
-                    *pCpuVA = (char*)m_CurrentChunk->mappedMemory + alignedOffset;
+    UploadStatistics UploadManager::getPublishedStatistics() const
+    {
+        std::lock_guard lockGuard(m_PublishedStatisticsMutex);
+        return m_PublishedStatistics;
+    }
 
-                return true;
-            }
+    void UploadManager::updatePeakBytesInFlight()
+    {
+        uint64_t bytesInFlight = m_Statistics.bytesInFlight;
+        if (m_RingAllocator)
+            bytesInFlight += m_RingAllocator->getStatistics().bytesInFlight;
 
-            chunkToRetire = m_CurrentChunk;
-            m_CurrentChunk.reset();
-        }
+        m_Statistics.peakBytesInFlight = std::max(m_Statistics.peakBytesInFlight, bytesInFlight);
+    }
+
+    void UploadManager::addBytesInFlight(uint64_t bytes)
+    {
+        m_Statistics.bytesInFlight += bytes;
+        updatePeakBytesInFlight();
+    }
 
+    void UploadManager::reclaim(uint64_t currentVersion)
+    {
         CommandQueue queue = VersionGetQueue(currentVersion);
         uint64_t completedInstance = m_Device->queueGetCompletedInstance(queue);
 
-        for (auto it = m_ChunkPool.begin(); it != m_ChunkPool.end(); ++it)
+        // Advance the ring tail past all regions whose command list instances have finished or were abandoned
+        if (m_RingAllocator)
+            m_RingAllocator->reclaim(currentVersion, completedInstance);
+
+        // Return finished standalone chunks to the pool
+        while (!m_RetiredChunks.empty() && VersionIsReclaimable(m_RetiredChunks.front()->version, currentVersion, completedInstance))
+        {
+            std::shared_ptr<BufferChunk> chunk = std::move(m_RetiredChunks.front());
+            m_RetiredChunks.pop_front();
+
+            m_Statistics.bytesInFlight -= chunk->usedBytes;
+            chunk->version = 0;
+            chunk->writePointer = 0;
+            chunk->usedBytes = 0;
+
+            m_ChunkPool.release(std::move(chunk));
+        }
+    }
+
+    std::shared_ptr<BufferChunk> UploadManager::acquireChunk(uint64_t size)
+    {
+        const uint64_t sizeToAllocate = UploadChunkPool<BufferChunk>::getChunkSize(size, m_DefaultChunkSize);
+
+        if (std::shared_ptr<BufferChunk> chunk = m_ChunkPool.acquire(sizeToAllocate))
+            return chunk;
+
+        if ((m_MemoryLimit > 0) && (m_Statistics.allocatedMemory + sizeToAllocate > m_MemoryLimit))
+            return nullptr;
+
+        return CreateChunk(sizeToAllocate);
+    }
+
+    void UploadManager::retireChunk(std::shared_ptr<BufferChunk> chunk)
+    {
+        m_Statistics.wastedBytes += chunk->bufferSize - chunk->writePointer;
+        m_RetiredChunks.push_back(std::move(chunk));
+    }
+
+    bool UploadManager::suballocateBuffer(uint64_t size, Buffer** pBuffer, uint64_t* pOffset, void** pCpuVA,
+        uint64_t currentVersion, uint32_t alignment)
+    {
+        if (!m_Ring && m_DefaultChunkSize > 0)
+        {
+            uint64_t ringSize = align(m_DefaultChunkSize, BufferChunk::c_sizeAlignment);
+
+            if ((m_MemoryLimit == 0) || (m_Statistics.allocatedMemory + ringSize <= m_MemoryLimit))
+            {
+                m_Ring = CreateChunk(ringSize);
+                m_RingAllocator = std::make_unique<UploadRing>(ringSize);
+            }
+        }
+
+        if (m_Ring && size <= m_Ring->bufferSize / c_RingMaxAllocationFraction)
         {
-            std::shared_ptr<BufferChunk> chunk = *it;
+            uint64_t offset = 0;
 
-            if (VersionGetSubmitted(chunk->version)
-                && VersionGetInstance(chunk->version) <= completedInstance)
+            // Only query the queue for completed instances when the ring looks full
+            bool allocated = m_RingAllocator->allocate(size, alignment, currentVersion, &offset);
+            if (!allocated)
             {
-                chunk->version = 0;
+                reclaim(currentVersion);
+                allocated = m_RingAllocator->allocate(size, alignment, currentVersion, &offset);
             }
 
-            if (chunk->version == 0 && chunk->bufferSize >= size)
+            if (allocated)
             {
-                m_ChunkPool.erase(it);
-                m_CurrentChunk = chunk;
-                break;
+                updatePeakBytesInFlight();
+
+                *pBuffer = checked_cast<Buffer*>(m_Ring->buffer.Get());
+                *pOffset = offset;
+                if (pCpuVA && m_Ring->mappedMemory)
+                    *pCpuVA = (char*)m_Ring->mappedMemory + offset;
+
+                return true;
             }
         }
 
-        if (chunkToRetire)
+        // The allocation is too large for the ring or the ring is full, use a standalone chunk
+
+        if (m_CurrentChunk && VersionIsAbandoned(m_CurrentChunk->version, currentVersion))
         {
-            m_ChunkPool.push_back(chunkToRetire);
+            // Left over from an instance that was never executed, so its contents are dead
+            m_Statistics.bytesInFlight -= m_CurrentChunk->usedBytes;
+            m_CurrentChunk->version = currentVersion;
+            m_CurrentChunk->writePointer = 0;
+            m_CurrentChunk->usedBytes = 0;
         }
 
-        if (!m_CurrentChunk)
+        if (m_CurrentChunk)
         {
-            uint64_t sizeToAllocate = align(std::max(size, m_DefaultChunkSize), BufferChunk::c_sizeAlignment);
+            uint64_t alignedOffset = align(m_CurrentChunk->writePointer, (uint64_t)alignment);
+            uint64_t endOfDataInChunk = alignedOffset + size;
 
-            if ((m_MemoryLimit > 0) && (m_AllocatedMemory + sizeToAllocate > m_MemoryLimit))
-                return false;
+            if (endOfDataInChunk <= m_CurrentChunk->bufferSize)
+            {
+                m_Statistics.wastedBytes += alignedOffset - m_CurrentChunk->writePointer;
+                m_CurrentChunk->writePointer = endOfDataInChunk;
+                m_CurrentChunk->usedBytes += size;
+                m_Statistics.chunkAllocations++;
+                addBytesInFlight(size);
 
-            m_CurrentChunk = CreateChunk(sizeToAllocate);
+                *pBuffer = checked_cast<Buffer*>(m_CurrentChunk->buffer.Get());
+                *pOffset = alignedOffset;
+                if (pCpuVA && m_CurrentChunk->mappedMemory)
+                    *pCpuVA = (char*)m_CurrentChunk->mappedMemory + alignedOffset;
+
+                return true;
+            }
+
+            retireChunk(std::move(m_CurrentChunk));
+            m_CurrentChunk.reset();
         }
 
+        reclaim(currentVersion);
+
+        m_CurrentChunk = acquireChunk(size);
+
+        if (!m_CurrentChunk)
+            return false;
+
         m_CurrentChunk->version = currentVersion;
         m_CurrentChunk->writePointer = size;
+        m_CurrentChunk->usedBytes = size;
+        m_Statistics.chunkAllocations++;
+        addBytesInFlight(size);
 
         *pBuffer = checked_cast<Buffer*>(m_CurrentChunk->buffer.Get());
         *pOffset = 0;
@@ -137,15 +262,26 @@ namespace nvrhi::vulkan
     {
         if (m_CurrentChunk)
         {
-            m_ChunkPool.push_back(m_CurrentChunk);
+            retireChunk(std::move(m_CurrentChunk));
             m_CurrentChunk.reset();
         }
 
-        for (const auto& chunk : m_ChunkPool)
+        for (const auto& chunk : m_RetiredChunks)
         {
             if (chunk->version == currentVersion)
                 chunk->version = submittedVersion;
         }
+
+        if (m_RingAllocator)
+            m_RingAllocator->submit(currentVersion, submittedVersion);
+
+        // Pooled chunks are already finished on the GPU, so the ones that stay unused can be destroyed right away
+        const uint64_t releasedBytes = m_ChunkPool.trim(m_Statistics.chunksReleased);
+        m_Statistics.allocatedMemory -= releasedBytes;
+
+        UploadStatistics statistics = getStatistics();
+        std::lock_guard lockGuard(m_PublishedStatisticsMutex);
+        m_PublishedStatistics = statistics;
     }
 
-}
\ No newline at end of file
+}
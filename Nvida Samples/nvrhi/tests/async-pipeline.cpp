@@ -0,0 +1,293 @@
+/*
+* Copyright (c) 2014-2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests AsyncPipelineCompiler and resolveAsyncPipeline with fake compile functions that can be held back,
+// so that every pipeline state - pending, ready and failed - can be observed, together with the statistics.
+
+#include "../src/common/async-pipeline.h"
+#include "test-utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace nvrhi;
+
+class FakeComputePipeline : public RefCounter<IComputePipeline>
+{
+public:
+    ComputePipelineDesc desc;
+
+    const ComputePipelineDesc& getDesc() const override { return desc; }
+};
+
+// Compile function that blocks until it's released, then succeeds or fails in the order of setResults.
+// The tests use a single worker thread, so the compilations run in the order of the requests.
+class FakeCompiler
+{
+public:
+    ComputePipelineHandle compile(const ComputePipelineDesc& desc)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Started++;
+        m_Condition.notify_all();
+        m_Condition.wait(lock, [this] { return m_Released > 0; });
+        m_Released--;
+
+        const bool success = m_Results.empty() || m_Results.front();
+        if (!m_Results.empty())
+            m_Results.pop_front();
+
+        if (!success)
+            return nullptr;
+
+        RefCountPtr<FakeComputePipeline> pipeline = RefCountPtr<FakeComputePipeline>::Create(new FakeComputePipeline());
+        pipeline->desc = desc;
+        return pipeline;
+    }
+
+    void setResults(std::initializer_list<bool> results)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Results.assign(results);
+    }
+
+    // Lets 'count' compilations finish
+    void release(int count)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Released += count;
+        m_Condition.notify_all();
+    }
+
+    // Waits until 'count' compilations have been started by the worker thread
+    void waitForStarted(int count)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this, count] { return m_Started >= count; });
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::deque<bool> m_Results;
+    int m_Started = 0;
+    int m_Released = 0;
+};
+
+static AsyncPipelineCompiler::GraphicsCompileFunction noGraphics()
+{
+    return [](const GraphicsPipelineDesc&, IFramebuffer*) { return GraphicsPipelineHandle(); };
+}
+
+static AsyncPipelineCompiler::ComputeCompileFunction fakeCompute(FakeCompiler& fake)
+{
+    return [&fake](const ComputePipelineDesc& desc) { return fake.compile(desc); };
+}
+
+static PipelineCompileStatus getStatus(IComputePipeline* pipeline)
+{
+    IAsyncPipeline* asyncPipeline = pipeline->getNativeObject(ObjectTypes::Nvrhi_AsyncPipeline);
+    return asyncPipeline ? asyncPipeline->getStatus() : PipelineCompileStatus::Ready;
+}
+
+static void testReadyAndSkip()
+{
+    FakeCompiler fake;
+    AsyncPipelineCompiler compiler(noGraphics(), fakeCompute(fake), 1);
+
+    ComputePipelineHandle pipeline = compiler.createComputePipeline(ComputePipelineDesc());
+    CHECK(pipeline != nullptr);
+    CHECK(getStatus(pipeline) == PipelineCompileStatus::Pending);
+
+    ComputeState state;
+    state.setPipeline(pipeline);
+    ComputeState resolvedState;
+
+    // A pending pipeline skips the dispatches with SkipDraws
+    CHECK(resolveAsyncPipeline(state, resolvedState, PipelineNotReadyPolicy::SkipDraws) == nullptr);
+
+    fake.release(1);
+    IAsyncPipeline* asyncPipeline = pipeline->getNativeObject(ObjectTypes::Nvrhi_AsyncPipeline);
+    CHECK(asyncPipeline != nullptr);
+    CHECK(asyncPipeline->wait() == PipelineCompileStatus::Ready);
+
+    // A ready pipeline is replaced with the compiled one, under both policies
+    for (PipelineNotReadyPolicy policy : { PipelineNotReadyPolicy::SkipDraws, PipelineNotReadyPolicy::Wait })
+    {
+        resolvedState = ComputeState();
+        const ComputeState* resolved = resolveAsyncPipeline(state, resolvedState, policy);
+        CHECK(resolved == &resolvedState);
+        CHECK(resolved && resolved->pipeline != nullptr && resolved->pipeline != pipeline.Get());
+        CHECK(resolved && static_cast<IAsyncPipeline*>(resolved->pipeline->getNativeObject(ObjectTypes::Nvrhi_AsyncPipeline)) == nullptr);
+    }
+
+    // States without an async pipeline are passed through
+    RefCountPtr<FakeComputePipeline> plainPipeline = RefCountPtr<FakeComputePipeline>::Create(new FakeComputePipeline());
+    ComputeState plainState;
+    plainState.setPipeline(plainPipeline);
+    CHECK(resolveAsyncPipeline(plainState, resolvedState, PipelineNotReadyPolicy::SkipDraws) == &plainState);
+
+    ComputeState emptyState;
+    CHECK(resolveAsyncPipeline(emptyState, resolvedState, PipelineNotReadyPolicy::SkipDraws) == &emptyState);
+}
+
+static void testWait()
+{
+    FakeCompiler fake;
+    AsyncPipelineCompiler compiler(noGraphics(), fakeCompute(fake), 1);
+
+    ComputePipelineHandle pipeline = compiler.createComputePipeline(ComputePipelineDesc());
+    ComputeState state;
+    state.setPipeline(pipeline);
+    ComputeState resolvedState;
+
+    fake.waitForStarted(1);
+    std::thread releaser([&fake]
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        fake.release(1);
+    });
+
+    // The Wait policy blocks until the compilation is finished instead of skipping
+    const ComputeState* resolved = resolveAsyncPipeline(state, resolvedState, PipelineNotReadyPolicy::Wait);
+    CHECK(resolved == &resolvedState);
+    CHECK(getStatus(pipeline) == PipelineCompileStatus::Ready);
+
+    releaser.join();
+}
+
+static void testFailure()
+{
+    FakeCompiler fake;
+    fake.setResults({ false });
+    AsyncPipelineCompiler compiler(noGraphics(), fakeCompute(fake), 1);
+
+    ComputePipelineHandle pipeline = compiler.createComputePipeline(ComputePipelineDesc());
+    fake.release(1);
+
+    IAsyncPipeline* asyncPipeline = pipeline->getNativeObject(ObjectTypes::Nvrhi_AsyncPipeline);
+    CHECK(asyncPipeline->wait() == PipelineCompileStatus::Failed);
+
+    // A failed pipeline is never used, whatever the policy
+    ComputeState state;
+    state.setPipeline(pipeline);
+    ComputeState resolvedState;
+    CHECK(resolveAsyncPipeline(state, resolvedState, PipelineNotReadyPolicy::SkipDraws) == nullptr);
+    CHECK(resolveAsyncPipeline(state, resolvedState, PipelineNotReadyPolicy::Wait) == nullptr);
+
+    // Graphics pipelines without a framebuffer are rejected right away
+    CHECK(compiler.createGraphicsPipeline(GraphicsPipelineDesc(), nullptr) == nullptr);
+}
+
+static void testStatistics()
+{
+    FakeCompiler fake;
+    fake.setResults({ true, false, true });
+    AsyncPipelineCompiler compiler(noGraphics(), fakeCompute(fake), 1);
+
+    PipelineCompileStatistics statistics = compiler.getStatistics();
+    CHECK(statistics.queueDepth == 0 && statistics.compiling == 0);
+    CHECK(statistics.completed == 0 && statistics.failed == 0);
+    CHECK(statistics.averageLatency == 0.f && statistics.maxLatency == 0.f);
+
+    ComputePipelineHandle pipelines[3];
+    for (ComputePipelineHandle& pipeline : pipelines)
+        pipeline = compiler.createComputePipeline(ComputePipelineDesc());
+
+    // One pipeline is held by the worker thread, the other two are waiting in the queue
+    fake.waitForStarted(1);
+    statistics = compiler.getStatistics();
+    CHECK(statistics.compiling == 1);
+    CHECK(statistics.queueDepth == 2);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    fake.release(3);
+    for (ComputePipelineHandle& pipeline : pipelines)
+    {
+        IAsyncPipeline* asyncPipeline = pipeline->getNativeObject(ObjectTypes::Nvrhi_AsyncPipeline);
+        asyncPipeline->wait();
+    }
+
+    // The statistics are updated after the pipeline is completed, so they can lag behind wait() for a moment
+    for (int attempt = 0; attempt < 1000; ++attempt)
+    {
+        statistics = compiler.getStatistics();
+        if (statistics.completed + statistics.failed == 3)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    CHECK(getStatus(pipelines[0]) == PipelineCompileStatus::Ready);
+    CHECK(getStatus(pipelines[1]) == PipelineCompileStatus::Failed);
+    CHECK(getStatus(pipelines[2]) == PipelineCompileStatus::Ready);
+    CHECK(statistics.queueDepth == 0 && statistics.compiling == 0);
+    CHECK(statistics.completed == 2);
+    CHECK(statistics.failed == 1);
+    CHECK(statistics.maxLatency >= 0.01f);
+    CHECK(statistics.averageLatency > 0.f && statistics.averageLatency <= statistics.maxLatency);
+}
+
+static void testShutdown()
+{
+    FakeCompiler fake;
+    AsyncPipelineCompiler compiler(noGraphics(), fakeCompute(fake), 1);
+
+    ComputePipelineHandle compiling = compiler.createComputePipeline(ComputePipelineDesc());
+    ComputePipelineHandle queued = compiler.createComputePipeline(ComputePipelineDesc());
+    fake.waitForStarted(1);
+
+    // Shutdown waits for the compilation in progress and fails the queued pipeline.
+    // The compilation is released once shutdown has taken the queue, so the worker can't pick up the second one.
+    std::thread releaser([&fake, &compiler]
+    {
+        while (compiler.getStatistics().queueDepth != 0)
+            std::this_thread::yield();
+        fake.release(1);
+    });
+    compiler.shutdown();
+    releaser.join();
+
+    CHECK(getStatus(compiling) == PipelineCompileStatus::Ready);
+    CHECK(getStatus(queued) == PipelineCompileStatus::Failed);
+
+    // Requests after shutdown fail right away, without calling the compile function
+    ComputePipelineHandle late = compiler.createComputePipeline(ComputePipelineDesc());
+    CHECK(getStatus(late) == PipelineCompileStatus::Failed);
+
+    const PipelineCompileStatistics statistics = compiler.getStatistics();
+    CHECK(statistics.completed == 1);
+    CHECK(statistics.queueDepth == 0);
+}
+
+int main()
+{
+    testReadyAndSkip();
+    testWait();
+    testFailure();
+    testStatistics();
+    testShutdown();
+
+    return finishTests();
+}
@@ -0,0 +1,320 @@
+/*
+* Copyright (c) 2014-2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests utils::HierarchicalBitmap and utils::BitSetAllocator against a plain std::vector<bool> model,
+// and from several threads at once. With --benchmark, also compares the allocator with a mutex-protected
+// linear scan over a std::vector<bool>, which is how BitSetAllocator used to work.
+
+#include <nvrhi/utils.h>
+#include "test-utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using nvrhi::utils::HierarchicalBitmap;
+
+// Returns the lowest index of 'count' free slots in a row, or c_Invalid.
+static uint32_t findFirstFit(const std::vector<bool>& allocated, uint32_t count)
+{
+    uint32_t runLength = 0;
+
+    for (uint32_t index = 0; index < uint32_t(allocated.size()); ++index)
+    {
+        runLength = allocated[index] ? 0 : runLength + 1;
+
+        if (runLength == count)
+            return index + 1 - count;
+    }
+
+    return HierarchicalBitmap::c_Invalid;
+}
+
+static bool matchesModel(const HierarchicalBitmap& bitmap, const std::vector<bool>& allocated)
+{
+    for (uint32_t index = 0; index < uint32_t(allocated.size()); ++index)
+    {
+        if (bitmap.isAllocated(index) != allocated[index])
+            return false;
+    }
+
+    return true;
+}
+
+static void testSingleSlots()
+{
+    HierarchicalBitmap empty;
+    CHECK(empty.allocate() == HierarchicalBitmap::c_Invalid);
+    CHECK(empty.allocateRange(2) == HierarchicalBitmap::c_Invalid);
+
+    // Not a multiple of 64, and large enough for three levels
+    const uint32_t capacity = 64 * 64 * 2 + 13;
+    HierarchicalBitmap bitmap(capacity);
+
+    for (uint32_t index = 0; index < capacity; ++index)
+        CHECK(bitmap.allocate() == index);
+
+    CHECK(bitmap.allocate() == HierarchicalBitmap::c_Invalid);
+
+    // Released slots are handed out again, lowest first
+    bitmap.release(capacity - 1);
+    bitmap.release(4100);
+    bitmap.release(7);
+
+    CHECK(!bitmap.isAllocated(7));
+    CHECK(bitmap.allocate() == 7);
+    CHECK(bitmap.allocate() == 4100);
+    CHECK(bitmap.allocate() == capacity - 1);
+    CHECK(bitmap.allocate() == HierarchicalBitmap::c_Invalid);
+
+    // Growing keeps the state of existing slots
+    bitmap.resize(capacity + 100);
+    CHECK(bitmap.capacity() == capacity + 100);
+    CHECK(bitmap.isAllocated(0));
+    CHECK(bitmap.allocate() == capacity);
+}
+
+// Random single-slot and range operations, checked against the model after each step.
+static void testRandomRanges()
+{
+    const uint32_t capacity = 10000;
+    HierarchicalBitmap bitmap(capacity);
+    std::vector<bool> allocated(capacity, false);
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    std::mt19937 rng(1);
+    int mismatches = 0;
+
+    for (int step = 0; step < 20000; ++step)
+    {
+        if (ranges.empty() || rng() % 3 != 0)
+        {
+            // Mostly short ranges, sometimes ones that span several words
+            const uint32_t count = (rng() % 8 == 0) ? 1 + rng() % 300 : 1 + rng() % 40;
+            const uint32_t expected = findFirstFit(allocated, count);
+            const uint32_t first = bitmap.allocateRange(count);
+
+            if (first != expected)
+                ++mismatches;
+
+            if (first != HierarchicalBitmap::c_Invalid)
+            {
+                std::fill(allocated.begin() + first, allocated.begin() + first + count, true);
+                ranges.emplace_back(first, count);
+            }
+        }
+        else
+        {
+            const size_t victim = rng() % ranges.size();
+            const auto [first, count] = ranges[victim];
+
+            bitmap.releaseRange(first, count);
+            std::fill(allocated.begin() + first, allocated.begin() + first + count, false);
+
+            ranges[victim] = ranges.back();
+            ranges.pop_back();
+        }
+
+        if (step % 500 == 0 && !matchesModel(bitmap, allocated))
+            ++mismatches;
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(matchesModel(bitmap, allocated));
+
+    for (const auto& [first, count] : ranges)
+        bitmap.releaseRange(first, count);
+
+    CHECK(bitmap.allocateRange(capacity) == 0);
+}
+
+// Several threads allocate and release slots at the same time. No slot may be handed out twice.
+static void testConcurrentAllocation()
+{
+    const uint32_t threadCount = 4;
+    const uint32_t slotsPerThread = 5000;
+    HierarchicalBitmap bitmap(threadCount * slotsPerThread);
+    std::vector<std::vector<uint32_t>> slots(threadCount);
+    std::vector<std::thread> threads;
+
+    for (uint32_t thread = 0; thread < threadCount; ++thread)
+    {
+        threads.emplace_back([&bitmap, &slots, thread]()
+        {
+            std::vector<uint32_t>& owned = slots[thread];
+
+            for (int round = 0; round < 10; ++round)
+            {
+                for (uint32_t i = 0; i < slotsPerThread; ++i)
+                    owned.push_back(bitmap.allocate());
+
+                // Keep the last round's slots, so the final check can see them
+                if (round < 9)
+                {
+                    for (uint32_t slot : owned)
+                        bitmap.release(slot);
+                    owned.clear();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<uint32_t> all;
+    for (const auto& owned : slots)
+        all.insert(all.end(), owned.begin(), owned.end());
+
+    std::sort(all.begin(), all.end());
+
+    CHECK(all.size() == threadCount * slotsPerThread);
+    CHECK(all.front() == 0);
+    CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+    CHECK(bitmap.allocate() == HierarchicalBitmap::c_Invalid);
+}
+
+static void testBitSetAllocator()
+{
+    nvrhi::utils::BitSetAllocator allocator(3);
+
+    CHECK(allocator.allocate() == 0);
+    CHECK(allocator.allocate() == 1);
+    CHECK(allocator.allocate() == 2);
+    CHECK(allocator.allocate() == -1);
+
+    allocator.release(1);
+    allocator.release(-1);
+    CHECK(allocator.allocate() == 1);
+}
+
+// The allocator BitSetAllocator used before the hierarchical bitmap: a linear scan under a mutex.
+class LinearScanAllocator
+{
+public:
+    explicit LinearScanAllocator(uint32_t capacity)
+        : m_Allocated(capacity, false)
+    { }
+
+    int allocate()
+    {
+        std::lock_guard lock(m_Mutex);
+
+        for (size_t index = m_NextAvailable; index < m_Allocated.size(); ++index)
+        {
+            if (!m_Allocated[index])
+            {
+                m_Allocated[index] = true;
+                m_NextAvailable = index + 1;
+                return int(index);
+            }
+        }
+
+        return -1;
+    }
+
+    void release(int index)
+    {
+        std::lock_guard lock(m_Mutex);
+
+        m_Allocated[index] = false;
+        m_NextAvailable = std::min(m_NextAvailable, size_t(index));
+    }
+
+private:
+    std::vector<bool> m_Allocated;
+    size_t m_NextAvailable = 0;
+    std::mutex m_Mutex;
+};
+
+// Every thread keeps a window of live slots in a mostly full allocator, and allocates and releases one
+// slot per step, in random order.
+template<typename Allocator>
+static double runStress(Allocator& allocator, uint32_t threadCount, uint32_t liveSlotsPerThread, uint32_t steps)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+
+    for (uint32_t thread = 0; thread < threadCount; ++thread)
+    {
+        threads.emplace_back([&allocator, thread, liveSlotsPerThread, steps]()
+        {
+            std::mt19937 rng(thread);
+            std::vector<int> live;
+
+            for (uint32_t i = 0; i < liveSlotsPerThread; ++i)
+                live.push_back(allocator.allocate());
+
+            for (uint32_t step = 0; step < steps; ++step)
+            {
+                const size_t victim = rng() % live.size();
+                allocator.release(live[victim]);
+                live[victim] = allocator.allocate();
+            }
+
+            for (int slot : live)
+                allocator.release(slot);
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void runBenchmark()
+{
+    const uint32_t capacity = 1 << 18;
+    const uint32_t threadCount = std::max(2u, std::thread::hardware_concurrency());
+    const uint32_t liveSlotsPerThread = capacity / threadCount * 9 / 10;
+    const uint32_t steps = 20000;
+
+    {
+        nvrhi::utils::BitSetAllocator allocator(capacity);
+        const double time = runStress(allocator, threadCount, liveSlotsPerThread, steps);
+        printf("BitSetAllocator:     %8.1f ms, %u threads, %u slots, %u steps per thread\n", time, threadCount, capacity, steps);
+    }
+
+    {
+        LinearScanAllocator allocator(capacity);
+        const double time = runStress(allocator, threadCount, liveSlotsPerThread, steps);
+        printf("Linear scan:         %8.1f ms, %u threads, %u slots, %u steps per thread\n", time, threadCount, capacity, steps);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testSingleSlots();
+    testRandomRanges();
+    testConcurrentAllocation();
+    testBitSetAllocator();
+
+    if (isBenchmark(argc, argv))
+        runBenchmark();
+
+    return finishTests();
+}
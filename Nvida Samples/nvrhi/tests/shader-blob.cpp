@@ -0,0 +1,316 @@
+/*
+* Copyright (c) 2014-2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the indexed shader permutation blobs built by buildIndexedShaderBlob: lookups through
+// findPermutationInBlob and enumeratePermutationsInBlob, the legacy linear "NVSP" format that must
+// keep working, and blobs with corrupted or truncated headers that must be rejected without reading
+// outside of the blob.
+
+#include <nvrhi/common/shader-blob.h>
+#include "test-utils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace nvrhi;
+
+// Keeps the binaries alive for the ShaderBlobPermutation pointers
+struct TestPermutation
+{
+    std::string key;
+    std::vector<uint8_t> binary;
+};
+
+static std::vector<uint8_t> makeBinary(uint32_t seed, size_t size)
+{
+    std::vector<uint8_t> binary(size);
+    for (size_t i = 0; i < size; i++)
+        binary[i] = uint8_t(seed * 31 + i);
+    return binary;
+}
+
+static bool buildBlob(const std::vector<TestPermutation>& source, std::vector<uint8_t>& blob)
+{
+    std::vector<ShaderBlobPermutation> permutations(source.size());
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        permutations[i].permutation = source[i].key;
+        permutations[i].data = source[i].binary.data();
+        permutations[i].size = source[i].binary.size();
+    }
+
+    return buildIndexedShaderBlob(permutations.data(), permutations.size(), blob);
+}
+
+// Writes the legacy linear format: signature, then a ShaderBlobEntry, the key and the binary for each permutation
+static std::vector<uint8_t> buildLinearBlob(const std::vector<TestPermutation>& source)
+{
+    std::vector<uint8_t> blob(g_BlobSignature, g_BlobSignature + g_BlobSignatureSize);
+    for (const TestPermutation& permutation : source)
+    {
+        ShaderBlobEntry entry;
+        entry.permutationSize = uint32_t(permutation.key.size());
+        entry.dataSize = uint32_t(permutation.binary.size());
+
+        const uint8_t* entryBytes = reinterpret_cast<const uint8_t*>(&entry);
+        blob.insert(blob.end(), entryBytes, entryBytes + sizeof(entry));
+        blob.insert(blob.end(), permutation.key.begin(), permutation.key.end());
+        blob.insert(blob.end(), permutation.binary.begin(), permutation.binary.end());
+    }
+    return blob;
+}
+
+// Looks up the permutation with constants A=a and B=b, or the default permutation if both are null
+static bool find(const std::vector<uint8_t>& blob, const char* a, const char* b, const void** pBinary, size_t* pSize)
+{
+    ShaderConstant constants[] = { { "A", a }, { "B", b } };
+    return findPermutationInBlob(blob.data(), blob.size(), constants, a ? 2 : 0, pBinary, pSize);
+}
+
+static bool findsBinary(const std::vector<uint8_t>& blob, const char* a, const char* b, const std::vector<uint8_t>& expected)
+{
+    const void* binary = nullptr;
+    size_t size = 0;
+    if (!find(blob, a, b, &binary, &size))
+        return false;
+
+    return size == expected.size() && memcmp(binary, expected.data(), size) == 0;
+}
+
+static std::vector<TestPermutation> makePermutations(uint32_t count)
+{
+    std::vector<TestPermutation> permutations;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        TestPermutation permutation;
+        permutation.key = "A=" + std::to_string(i % 7) + " B=" + std::to_string(i / 7) + " ";
+        permutation.binary = makeBinary(i, 1 + (i * 13) % 61);
+        permutations.push_back(permutation);
+    }
+    return permutations;
+}
+
+static void testRoundTrip()
+{
+    for (uint32_t count : { 1u, 2u, 3u, 17u, 200u })
+    {
+        const std::vector<TestPermutation> permutations = makePermutations(count);
+
+        std::vector<uint8_t> blob;
+        CHECK(buildBlob(permutations, blob));
+        CHECK(memcmp(blob.data(), g_IndexedBlobSignature, g_IndexedBlobSignatureSize) == 0);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const std::string a = std::to_string(i % 7);
+            const std::string b = std::to_string(i / 7);
+            CHECK(findsBinary(blob, a.c_str(), b.c_str(), permutations[i].binary));
+        }
+
+        const void* binary = nullptr;
+        size_t size = 0;
+        CHECK(!find(blob, "7", "0", &binary, &size));
+        CHECK(!find(blob, nullptr, nullptr, &binary, &size));
+
+        // Enumeration reports the permutations in the order they were added
+        std::vector<std::string> keys;
+        enumeratePermutationsInBlob(blob.data(), blob.size(), keys);
+        CHECK(keys.size() == count);
+        for (uint32_t i = 0; i < count && i < keys.size(); i++)
+            CHECK(keys[i] == permutations[i].key);
+    }
+
+    // Empty and oversized binaries can't be stored
+    std::vector<TestPermutation> permutations = makePermutations(2);
+    permutations[1].binary.clear();
+    std::vector<uint8_t> blob;
+    CHECK(!buildBlob(permutations, blob));
+}
+
+static void testDuplicates()
+{
+    std::vector<TestPermutation> permutations = makePermutations(5);
+    TestPermutation duplicate = permutations[2];
+    duplicate.binary = makeBinary(100, 8);
+    permutations.push_back(duplicate);
+
+    std::vector<uint8_t> blob;
+    CHECK(buildBlob(permutations, blob));
+
+    // The first permutation with a given key wins, same as in the linear format
+    CHECK(findsBinary(blob, "2", "0", permutations[2].binary));
+    CHECK(findsBinary(buildLinearBlob(permutations), "2", "0", permutations[2].binary));
+
+    std::vector<std::string> keys;
+    enumeratePermutationsInBlob(blob.data(), blob.size(), keys);
+    CHECK(keys.size() == 5);
+}
+
+static void testEmptyPermutation()
+{
+    std::vector<TestPermutation> permutations = makePermutations(3);
+    TestPermutation defaultPermutation;
+    defaultPermutation.binary = makeBinary(42, 12);
+    permutations.insert(permutations.begin() + 1, defaultPermutation);
+
+    std::vector<uint8_t> blob;
+    CHECK(buildBlob(permutations, blob));
+
+    CHECK(findsBinary(blob, nullptr, nullptr, defaultPermutation.binary));
+    CHECK(findsBinary(blob, "0", "0", permutations[0].binary));
+
+    std::vector<std::string> keys;
+    enumeratePermutationsInBlob(blob.data(), blob.size(), keys);
+    CHECK(keys.size() == 4);
+    CHECK(keys.size() > 1 && keys[1] == "<default>");
+
+    // A blob without any permutations is valid and finds nothing
+    CHECK(buildBlob({}, blob));
+    const void* binary = nullptr;
+    size_t size = 0;
+    CHECK(!find(blob, nullptr, nullptr, &binary, &size));
+    keys.clear();
+    enumeratePermutationsInBlob(blob.data(), blob.size(), keys);
+    CHECK(keys.empty());
+}
+
+static void testLinearFormat()
+{
+    std::vector<TestPermutation> permutations = makePermutations(20);
+    TestPermutation defaultPermutation;
+    defaultPermutation.binary = makeBinary(42, 12);
+    permutations.push_back(defaultPermutation);
+
+    const std::vector<uint8_t> blob = buildLinearBlob(permutations);
+
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        const std::string a = std::to_string(i % 7);
+        const std::string b = std::to_string(i / 7);
+        CHECK(findsBinary(blob, a.c_str(), b.c_str(), permutations[i].binary));
+    }
+    CHECK(findsBinary(blob, nullptr, nullptr, defaultPermutation.binary));
+
+    const void* binary = nullptr;
+    size_t size = 0;
+    CHECK(!find(blob, "7", "0", &binary, &size));
+
+    std::vector<std::string> keys;
+    enumeratePermutationsInBlob(blob.data(), blob.size(), keys);
+    CHECK(keys.size() == 21);
+    CHECK(keys.size() == 21 && keys[20] == "<default>");
+
+    // A blob that is not a permutation blob at all is only returned when no permutation is requested
+    const std::vector<uint8_t> plain = makeBinary(7, 64);
+    CHECK(findsBinary(plain, nullptr, nullptr, plain));
+    CHECK(!find(plain, "0", "0", &binary, &size));
+}
+
+static void testCorruptedBlobs()
+{
+    const std::vector<TestPermutation> permutations = makePermutations(10);
+    std::vector<uint8_t> blob;
+    CHECK(buildBlob(permutations, blob));
+
+    ShaderBlobIndexHeader header;
+    memcpy(&header, blob.data(), sizeof(header));
+
+    auto rejects = [](const std::vector<uint8_t>& corrupted)
+    {
+        const void* binary = nullptr;
+        size_t size = 0;
+        const bool found = find(corrupted, "3", "1", &binary, &size);
+
+        std::vector<std::string> keys;
+        enumeratePermutationsInBlob(corrupted.data(), corrupted.size(), keys);
+
+        return !found && keys.empty();
+    };
+
+    auto withHeader = [&blob](const ShaderBlobIndexHeader& corruptedHeader)
+    {
+        std::vector<uint8_t> corrupted = blob;
+        memcpy(corrupted.data(), &corruptedHeader, sizeof(corruptedHeader));
+        return corrupted;
+    };
+
+    ShaderBlobIndexHeader badVersion = header;
+    badVersion.version = c_IndexedBlobVersion + 1;
+    CHECK(rejects(withHeader(badVersion)));
+
+    ShaderBlobIndexHeader zeroTable = header;
+    zeroTable.tableSize = 0;
+    CHECK(rejects(withHeader(zeroTable)));
+
+    ShaderBlobIndexHeader notPowerOfTwo = header;
+    notPowerOfTwo.tableSize = header.tableSize + 1;
+    CHECK(rejects(withHeader(notPowerOfTwo)));
+
+    ShaderBlobIndexHeader hugeTable = header;
+    hugeTable.tableSize = 0x80000000u;
+    CHECK(rejects(withHeader(hugeTable)));
+
+    // Truncated inside the header and inside the hash table
+    CHECK(rejects(std::vector<uint8_t>(blob.begin(), blob.begin() + g_IndexedBlobSignatureSize)));
+    CHECK(rejects(std::vector<uint8_t>(blob.begin(), blob.begin() + sizeof(ShaderBlobIndexHeader) - 1)));
+    CHECK(rejects(std::vector<uint8_t>(blob.begin(), blob.begin() + sizeof(ShaderBlobIndexHeader) + sizeof(ShaderBlobIndexEntry))));
+
+    // Truncated after the hash table: entries that point past the end are not used
+    const size_t tableEnd = sizeof(ShaderBlobIndexHeader) + size_t(header.tableSize) * sizeof(ShaderBlobIndexEntry);
+    CHECK(rejects(std::vector<uint8_t>(blob.begin(), blob.begin() + tableEnd)));
+
+    // Binaries are padded to 4 bytes, so cutting 4 bytes always cuts into the last one
+    const std::vector<uint8_t> truncated(blob.begin(), blob.end() - 4);
+    const void* binary = nullptr;
+    size_t size = 0;
+    CHECK(!find(truncated, "2", "1", &binary, &size)); // the last permutation in the blob
+    CHECK(findsBinary(truncated, "0", "0", permutations[0].binary));
+
+    // An entry with offsets outside of the blob
+    std::vector<uint8_t> badEntry = blob;
+    ShaderBlobIndexEntry* table = reinterpret_cast<ShaderBlobIndexEntry*>(badEntry.data() + sizeof(ShaderBlobIndexHeader));
+    for (uint32_t slot = 0; slot < header.tableSize; slot++)
+    {
+        if (table[slot].dataSize != 0)
+            table[slot].dataOffset = uint64_t(-1) - 1;
+    }
+    CHECK(rejects(badEntry));
+
+    // A truncated linear blob stops at the last complete permutation
+    const std::vector<uint8_t> linear = buildLinearBlob(permutations);
+    const std::vector<uint8_t> truncatedLinear(linear.begin(), linear.end() - 1);
+    CHECK(!find(truncatedLinear, "2", "1", &binary, &size));
+    CHECK(findsBinary(truncatedLinear, "1", "1", permutations[8].binary));
+}
+
+int main()
+{
+    testRoundTrip();
+    testDuplicates();
+    testEmptyPermutation();
+    testLinearFormat();
+    testCorruptedBlobs();
+
+    return finishTests();
+}
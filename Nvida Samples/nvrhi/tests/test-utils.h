@@ -0,0 +1,53 @@
+/*
+* Copyright (c) 2014-2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Checks shared by the NVRHI tests. Each test is a separate executable that calls the CHECK macro as often as it
+// likes and returns finishTests() from main.
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+
+inline int g_FailedChecks = 0;
+
+#define CHECK(condition) \
+    do { if (!(condition)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); ++g_FailedChecks; } } while (false)
+
+// Tests that measure performance only do so when run with --benchmark, see tests/CMakeLists.txt
+inline bool isBenchmark(int argc, char** argv)
+{
+    return argc > 1 && strcmp(argv[1], "--benchmark") == 0;
+}
+
+// Prints the result and returns the exit code of the test
+inline int finishTests()
+{
+    if (g_FailedChecks != 0)
+    {
+        fprintf(stderr, "%d check(s) failed\n", g_FailedChecks);
+        return 1;
+    }
+
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,278 @@
+/*
+* Copyright (c) 2014-2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the placement step of utils::TransientResourceAllocator, which runs without a device:
+// resources with overlapping lifetimes must never share memory, resources with disjoint lifetimes must,
+// and the statistics must report the memory saved by the packing.
+
+#include <nvrhi/utils.h>
+#include "test-utils.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using Allocator = nvrhi::utils::TransientResourceAllocator;
+using Placement = Allocator::Placement;
+using HeapLayout = Allocator::HeapLayout;
+
+static constexpr uint64_t c_KB = 1024;
+static constexpr uint64_t c_MB = 1024 * 1024;
+static constexpr uint64_t c_HeapGranularity = 64 * c_KB;
+
+static Placement makePlacement(uint64_t size, uint32_t firstPass, uint32_t lastPass, uint32_t memoryClass = 0, uint64_t alignment = c_HeapGranularity)
+{
+    Placement placement;
+    placement.size = size;
+    placement.alignment = alignment;
+    placement.memoryClass = memoryClass;
+    placement.firstPass = firstPass;
+    placement.lastPass = lastPass;
+    return placement;
+}
+
+// Checks the invariants of a packing: every resource is placed in a heap of its class, aligned, inside the heap,
+// listed by the heap, and never overlapping in memory with a resource that is alive at the same time.
+static void checkPacking(const std::vector<Placement>& placements, const std::vector<HeapLayout>& heaps, uint64_t heapSize)
+{
+    std::vector<uint32_t> listedIn(placements.size(), Allocator::c_Invalid);
+    for (uint32_t heapIndex = 0; heapIndex < uint32_t(heaps.size()); heapIndex++)
+    {
+        const HeapLayout& heap = heaps[heapIndex];
+        CHECK(!heap.resources.empty());
+        CHECK(heap.size <= heap.capacity);
+        CHECK(heap.capacity >= heapSize);
+
+        uint64_t end = 0;
+        for (uint32_t index : heap.resources)
+        {
+            CHECK(listedIn[index] == Allocator::c_Invalid);
+            listedIn[index] = heapIndex;
+            end = std::max(end, placements[index].offset + placements[index].size);
+        }
+        CHECK(heap.size == end);
+    }
+
+    for (uint32_t index = 0; index < uint32_t(placements.size()); index++)
+    {
+        const Placement& placement = placements[index];
+
+        if (placement.size == 0)
+        {
+            CHECK(placement.heapIndex == Allocator::c_Invalid);
+            CHECK(listedIn[index] == Allocator::c_Invalid);
+            continue;
+        }
+
+        CHECK(placement.heapIndex < heaps.size());
+        if (placement.heapIndex >= heaps.size())
+            continue;
+
+        const HeapLayout& heap = heaps[placement.heapIndex];
+        CHECK(listedIn[index] == placement.heapIndex);
+        CHECK(heap.memoryClass == placement.memoryClass);
+        CHECK(placement.alignment == 0 || placement.offset % placement.alignment == 0);
+        CHECK(placement.offset + placement.size <= heap.capacity);
+
+        for (uint32_t otherIndex = index + 1; otherIndex < uint32_t(placements.size()); otherIndex++)
+        {
+            const Placement& other = placements[otherIndex];
+            if (other.size == 0 || other.heapIndex != placement.heapIndex || !other.overlaps(placement))
+                continue;
+
+            const bool memoryOverlaps = placement.offset < other.offset + other.size && other.offset < placement.offset + placement.size;
+            CHECK(!memoryOverlaps);
+        }
+    }
+}
+
+static void testDisjointLifetimesAlias()
+{
+    // A chain of resources where each one starts after the previous one ends
+    std::vector<Placement> placements;
+    for (uint32_t pass = 0; pass < 8; pass++)
+        placements.push_back(makePlacement(4 * c_MB, pass * 2, pass * 2 + 1));
+
+    std::vector<HeapLayout> heaps;
+    Allocator::packResources(placements, 16 * c_MB, heaps);
+    checkPacking(placements, heaps, 16 * c_MB);
+
+    CHECK(heaps.size() == 1);
+    for (const Placement& placement : placements)
+        CHECK(placement.heapIndex == 0 && placement.offset == 0);
+
+    const Allocator::Statistics statistics = Allocator::getPackingStatistics(placements, heaps);
+    CHECK(statistics.numHeaps == 1);
+    CHECK(statistics.numPlacedResources == 8);
+    CHECK(statistics.numDedicatedResources == 0);
+    CHECK(statistics.dedicatedMemory == 32 * c_MB);
+    CHECK(statistics.heapMemory == 4 * c_MB);
+    CHECK(statistics.getMemorySaved() == 28 * c_MB);
+}
+
+static void testOverlappingLifetimesDoNotAlias()
+{
+    // All resources are alive in pass 3
+    std::vector<Placement> placements;
+    placements.push_back(makePlacement(3 * c_MB, 0, 3));
+    placements.push_back(makePlacement(1 * c_MB, 3, 5));
+    placements.push_back(makePlacement(2 * c_MB, 2, 3));
+    placements.push_back(makePlacement(100 * c_KB, 3, 3, 0, 4 * c_KB));
+
+    std::vector<HeapLayout> heaps;
+    Allocator::packResources(placements, 16 * c_MB, heaps);
+    checkPacking(placements, heaps, 16 * c_MB);
+    CHECK(heaps.size() == 1);
+
+    // Nothing is shared, so the heap is at least as large as all resources together and nothing is saved
+    const Allocator::Statistics statistics = Allocator::getPackingStatistics(placements, heaps);
+    CHECK(statistics.dedicatedMemory == 6 * c_MB + 100 * c_KB);
+    CHECK(statistics.heapMemory >= statistics.dedicatedMemory);
+    CHECK(statistics.heapMemory == Allocator::getHeapCapacity(heaps[0]));
+    CHECK(statistics.getMemorySaved() == 0);
+
+    // Lifetimes that only touch at one pass still overlap
+    std::vector<Placement> touching = { makePlacement(c_MB, 0, 2), makePlacement(c_MB, 2, 4) };
+    heaps.clear();
+    Allocator::packResources(touching, 16 * c_MB, heaps);
+    checkPacking(touching, heaps, 16 * c_MB);
+    CHECK(touching[0].offset != touching[1].offset);
+}
+
+static void testGapFilling()
+{
+    // The small resource fits into the gap left by the short resource while the long ones are alive
+    std::vector<Placement> placements;
+    placements.push_back(makePlacement(4 * c_MB, 0, 9)); // long
+    placements.push_back(makePlacement(4 * c_MB, 0, 1)); // short
+    placements.push_back(makePlacement(4 * c_MB, 0, 9)); // long
+    placements.push_back(makePlacement(2 * c_MB, 5, 9)); // fits where 'short' was
+
+    std::vector<HeapLayout> heaps;
+    Allocator::packResources(placements, 16 * c_MB, heaps);
+    checkPacking(placements, heaps, 16 * c_MB);
+
+    CHECK(heaps.size() == 1);
+    CHECK(placements[3].offset == placements[1].offset);
+    CHECK(heaps[0].size == 12 * c_MB);
+
+    const Allocator::Statistics statistics = Allocator::getPackingStatistics(placements, heaps);
+    CHECK(statistics.getMemorySaved() == 2 * c_MB);
+}
+
+static void testMemoryClassesAndHeapSize()
+{
+    // Disjoint lifetimes, but different memory classes never share a heap
+    std::vector<Placement> placements;
+    placements.push_back(makePlacement(c_MB, 0, 0, 0));
+    placements.push_back(makePlacement(c_MB, 1, 1, 1));
+
+    std::vector<HeapLayout> heaps;
+    Allocator::packResources(placements, 16 * c_MB, heaps);
+    checkPacking(placements, heaps, 16 * c_MB);
+    CHECK(heaps.size() == 2);
+    CHECK(placements[0].heapIndex != placements[1].heapIndex);
+
+    // Resources that don't fit next to each other go to new heaps, and resources larger than the heap size get their own
+    placements.clear();
+    placements.push_back(makePlacement(10 * c_MB, 0, 1));
+    placements.push_back(makePlacement(10 * c_MB, 0, 1));
+    placements.push_back(makePlacement(40 * c_MB, 0, 1));
+
+    heaps.clear();
+    Allocator::packResources(placements, 16 * c_MB, heaps);
+    checkPacking(placements, heaps, 16 * c_MB);
+    CHECK(heaps.size() == 3);
+    CHECK(heaps.size() == 3 && heaps[0].capacity == 40 * c_MB);
+
+    // Resources without memory requirements are left for dedicated allocations
+    placements.push_back(makePlacement(0, 0, 1));
+    heaps.clear();
+    Allocator::packResources(placements, 16 * c_MB, heaps);
+    checkPacking(placements, heaps, 16 * c_MB);
+
+    const Allocator::Statistics statistics = Allocator::getPackingStatistics(placements, heaps);
+    CHECK(statistics.numPlacedResources == 3);
+    CHECK(statistics.numDedicatedResources == 1);
+    CHECK(statistics.numHeaps == 3);
+    CHECK(statistics.dedicatedMemory == 60 * c_MB);
+    CHECK(statistics.heapMemory == 60 * c_MB);
+}
+
+static void testRandomPacking()
+{
+    std::mt19937 random(1234);
+    const uint64_t alignments[] = { 256, 4 * c_KB, 64 * c_KB };
+
+    for (uint32_t iteration = 0; iteration < 200; iteration++)
+    {
+        const uint32_t numPasses = 1 + random() % 20;
+        const uint64_t heapSize = (1 + random() % 32) * c_MB;
+
+        std::vector<Placement> placements(1 + random() % 60);
+        for (Placement& placement : placements)
+        {
+            const uint32_t a = random() % numPasses;
+            const uint32_t b = random() % numPasses;
+            const uint64_t alignment = alignments[random() % 3];
+            const uint64_t size = (random() % 8 == 0) ? 0 : ((1 + random() % (4 * c_MB)) + alignment - 1) / alignment * alignment;
+            placement = makePlacement(size, std::min(a, b), std::max(a, b), random() % 2, alignment);
+        }
+
+        std::vector<HeapLayout> heaps;
+        Allocator::packResources(placements, heapSize, heaps);
+        checkPacking(placements, heaps, heapSize);
+
+        // The heaps are never larger than the sum of the resources that they hold, rounded up to the heap granularity
+        const Allocator::Statistics statistics = Allocator::getPackingStatistics(placements, heaps);
+        uint64_t expectedHeapMemory = 0;
+        for (const HeapLayout& heap : heaps)
+        {
+            uint64_t heldMemory = 0;
+            for (uint32_t index : heap.resources)
+                heldMemory += placements[index].size + placements[index].alignment;
+            CHECK(heap.size <= heldMemory);
+            expectedHeapMemory += (heap.size + c_HeapGranularity - 1) / c_HeapGranularity * c_HeapGranularity;
+        }
+        CHECK(statistics.heapMemory == expectedHeapMemory);
+        CHECK(statistics.numPlacedResources + statistics.numDedicatedResources == placements.size());
+
+        // Packing is deterministic
+        std::vector<Placement> repacked = placements;
+        std::vector<HeapLayout> repackedHeaps;
+        Allocator::packResources(repacked, heapSize, repackedHeaps);
+        CHECK(repackedHeaps.size() == heaps.size());
+        for (size_t index = 0; index < placements.size(); index++)
+            CHECK(repacked[index].heapIndex == placements[index].heapIndex && repacked[index].offset == placements[index].offset);
+    }
+}
+
+int main()
+{
+    testDisjointLifetimesAlias();
+    testOverlappingLifetimesDoNotAlias();
+    testGapFilling();
+    testMemoryClassesAndHeapSize();
+    testRandomPacking();
+
+    return finishTests();
+}
@@ -0,0 +1,132 @@
+/*
+* Copyright (c) 2014-2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the pool of standalone chunks used by the Vulkan upload manager: the chunk size granularity,
+// best-fit reuse with a bound on the oversize, releasing chunks that stay unused, and the pooled bytes counter.
+
+#include "../src/common/upload-chunk-pool.h"
+#include "test-utils.h"
+
+#include <cstdio>
+
+struct TestChunk
+{
+    uint64_t bufferSize = 0;
+};
+
+using ChunkPool = nvrhi::UploadChunkPool<TestChunk>;
+
+static constexpr uint64_t KB = 1024;
+static constexpr uint64_t MB = 1024 * KB;
+
+static std::shared_ptr<TestChunk> makeChunk(uint64_t size)
+{
+    auto chunk = std::make_shared<TestChunk>();
+    chunk->bufferSize = size;
+    return chunk;
+}
+
+static void testChunkSize()
+{
+    // Small allocations get the default chunk size, rounded up to the granularity
+    CHECK(ChunkPool::getChunkSize(100, 0) == 64 * KB);
+    CHECK(ChunkPool::getChunkSize(100, 1 * MB) == 1 * MB);
+    CHECK(ChunkPool::getChunkSize(100, 1 * MB + 1) == 1 * MB + 64 * KB);
+
+    // Large allocations are not rounded up to a power of two
+    CHECK(ChunkPool::getChunkSize(17 * MB + 1, 1 * MB) == 17 * MB + 64 * KB);
+    CHECK(ChunkPool::getChunkSize(33 * MB, 1 * MB) == 33 * MB);
+}
+
+static void testBestFit()
+{
+    ChunkPool pool(64);
+
+    pool.release(makeChunk(1 * MB));
+    pool.release(makeChunk(4 * MB));
+    pool.release(makeChunk(2 * MB));
+    CHECK(pool.getChunkCount() == 3);
+    CHECK(pool.getPooledBytes() == 7 * MB);
+
+    // The smallest chunk that is large enough
+    std::shared_ptr<TestChunk> chunk = pool.acquire(1 * MB + 1);
+    CHECK(chunk && chunk->bufferSize == 2 * MB);
+    CHECK(pool.getPooledBytes() == 5 * MB);
+
+    // The 4 MB chunk is more than twice as large as needed, so a new chunk should be created instead
+    CHECK(!pool.acquire(1 * MB + 1));
+    CHECK(pool.acquire(2 * MB)->bufferSize == 4 * MB);
+
+    // Nothing is large enough
+    CHECK(!pool.acquire(2 * MB));
+
+    CHECK(pool.acquire(1 * MB)->bufferSize == 1 * MB);
+    CHECK(pool.getChunkCount() == 0);
+    CHECK(pool.getPooledBytes() == 0);
+}
+
+static void testTrim()
+{
+    ChunkPool pool(2);
+    uint64_t releasedChunks = 0;
+
+    pool.release(makeChunk(1 * MB));
+
+    // Released after more than 2 submissions without being reused
+    CHECK(pool.trim(releasedChunks) == 0);
+    CHECK(pool.trim(releasedChunks) == 0);
+
+    pool.release(makeChunk(2 * MB));
+    CHECK(pool.trim(releasedChunks) == 1 * MB);
+    CHECK(releasedChunks == 1);
+    CHECK(pool.getChunkCount() == 1);
+    CHECK(pool.getPooledBytes() == 2 * MB);
+
+    // Reusing a chunk resets its idle time
+    std::shared_ptr<TestChunk> chunk = pool.acquire(2 * MB);
+    CHECK(chunk != nullptr);
+    CHECK(pool.trim(releasedChunks) == 0);
+    pool.release(std::move(chunk));
+    CHECK(pool.trim(releasedChunks) == 0);
+    CHECK(pool.trim(releasedChunks) == 0);
+    CHECK(pool.trim(releasedChunks) == 2 * MB);
+    CHECK(releasedChunks == 2);
+    CHECK(pool.getChunkCount() == 0);
+    CHECK(pool.getPooledBytes() == 0);
+
+    // The pool doesn't hold on to the chunks it releases
+    std::shared_ptr<TestChunk> released = makeChunk(1 * MB);
+    std::weak_ptr<TestChunk> weak = released;
+    pool.release(std::move(released));
+    for (int submission = 0; submission < 3; submission++)
+        pool.trim(releasedChunks);
+    CHECK(weak.expired());
+}
+
+int main()
+{
+    testChunkSize();
+    testBestFit();
+    testTrim();
+
+    return finishTests();
+}
@@ -0,0 +1,187 @@
+/*
+* Copyright (c) 2014-2021, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the ring buffer bookkeeping used by the Vulkan upload manager: wrap-around, a full ring,
+// reclaiming the memory of command list instances that complete or are never executed,
+// and the bytes in flight, peak and waste counters.
+
+#include "../src/common/upload-ring.h"
+#include "test-utils.h"
+
+#include <cstdio>
+
+using nvrhi::UploadRing;
+
+// Version of a command list instance being recorded
+static uint64_t recording(uint64_t instance)
+{
+    return nvrhi::MakeVersion(instance, nvrhi::CommandQueue::Graphics, false);
+}
+
+// Version of a command list instance after it has been executed
+static uint64_t submitted(uint64_t instance)
+{
+    return nvrhi::MakeVersion(instance, nvrhi::CommandQueue::Graphics, true);
+}
+
+static bool allocateAt(UploadRing& ring, uint64_t size, uint64_t alignment, uint64_t version, uint64_t expectedOffset)
+{
+    uint64_t offset = ~0ull;
+    return ring.allocate(size, alignment, version, &offset) && offset == expectedOffset;
+}
+
+static void testAllocationAndCounters()
+{
+    UploadRing ring(1024);
+
+    CHECK(allocateAt(ring, 100, 64, recording(1), 0));
+    CHECK(allocateAt(ring, 100, 64, recording(1), 128)); // 28 bytes of padding
+    CHECK(allocateAt(ring, 10, 1, recording(1), 228));
+
+    const UploadRing::Statistics& statistics = ring.getStatistics();
+    CHECK(statistics.allocations == 3);
+    CHECK(statistics.bytesInFlight == 210);
+    CHECK(statistics.peakBytesInFlight == 210);
+    CHECK(statistics.wastedBytes == 28);
+    CHECK(ring.getUsedBytes() == 238);
+
+    ring.submit(recording(1), submitted(1));
+
+    // Not completed yet
+    CHECK(ring.reclaim(recording(2), 0) == 0);
+    CHECK(statistics.bytesInFlight == 210);
+
+    CHECK(ring.reclaim(recording(2), 1) == 210);
+    CHECK(statistics.bytesInFlight == 0);
+    CHECK(statistics.peakBytesInFlight == 210);
+    CHECK(ring.getUsedBytes() == 0);
+
+    // An empty ring starts over at offset 0
+    CHECK(allocateAt(ring, 300, 256, recording(2), 0));
+    CHECK(statistics.bytesInFlight == 300);
+    CHECK(statistics.peakBytesInFlight == 300);
+    CHECK(statistics.wastedBytes == 28);
+}
+
+static void testWrapAroundAtTail()
+{
+    UploadRing ring(1024);
+
+    CHECK(allocateAt(ring, 256, 1, recording(1), 0));
+    ring.submit(recording(1), submitted(1));
+    CHECK(allocateAt(ring, 512, 1, recording(2), 256));
+    CHECK(allocateAt(ring, 200, 1, recording(2), 768));
+    ring.submit(recording(2), submitted(2));
+
+    // Instance 1 is done: tail = 256, head = 968
+    CHECK(ring.reclaim(recording(3), 1) == 256);
+    CHECK(ring.getUsedBytes() == 712);
+
+    // 257 bytes fit neither at the end nor before the tail
+    uint64_t offset = 0;
+    CHECK(!ring.allocate(257, 1, recording(3), &offset));
+
+    // Exactly the size of the space before the tail: wraps around and fills the ring, the last 56 bytes are skipped
+    const uint64_t wastedBefore = ring.getStatistics().wastedBytes;
+    CHECK(allocateAt(ring, 256, 1, recording(3), 0));
+    CHECK(ring.getUsedBytes() == 1024);
+    CHECK(ring.getStatistics().wastedBytes == wastedBefore + 56);
+
+    // The ring is full, the head is at the tail
+    CHECK(!ring.allocate(1, 1, recording(3), &offset));
+
+    // Once instance 2 completes, the space between the wrapped head and the end of instance 2 is free
+    ring.submit(recording(3), submitted(3));
+    CHECK(ring.reclaim(recording(4), 2) == 712);
+    CHECK(ring.getUsedBytes() == 312);
+    CHECK(allocateAt(ring, 700, 1, recording(4), 256));
+    CHECK(!ring.allocate(100, 1, recording(4), &offset));
+
+    CHECK(ring.reclaim(recording(4), 3) == 256);
+    CHECK(ring.getStatistics().bytesInFlight == 700);
+}
+
+static void testFullRing()
+{
+    UploadRing ring(1024);
+
+    for (uint64_t index = 0; index < 4; index++)
+        CHECK(allocateAt(ring, 256, 256, recording(1), index * 256));
+
+    uint64_t offset = 0;
+    CHECK(ring.getUsedBytes() == 1024);
+    CHECK(!ring.allocate(1, 1, recording(1), &offset));
+
+    // The instance that is being recorded can't be reclaimed
+    CHECK(ring.reclaim(recording(1), 0) == 0);
+    CHECK(!ring.allocate(1, 1, recording(1), &offset));
+
+    // Submitted but not completed
+    ring.submit(recording(1), submitted(1));
+    CHECK(ring.reclaim(recording(2), 0) == 0);
+    CHECK(!ring.allocate(1, 1, recording(2), &offset));
+
+    CHECK(ring.reclaim(recording(2), 1) == 1024);
+    CHECK(allocateAt(ring, 1024, 1, recording(2), 0));
+    CHECK(ring.getStatistics().peakBytesInFlight == 1024);
+    CHECK(ring.getStatistics().wastedBytes == 0);
+}
+
+static void testNeverExecutedInstances()
+{
+    UploadRing ring(1024);
+
+    // Instance 1 is closed without being executed, instance 2 is executed
+    CHECK(allocateAt(ring, 300, 1, recording(1), 0));
+    CHECK(allocateAt(ring, 300, 1, recording(2), 300));
+    ring.submit(recording(2), submitted(2));
+
+    // While instance 1 is still being recorded, its memory is live
+    CHECK(ring.reclaim(recording(1), 0) == 0);
+
+    // Once another instance is being recorded, instance 1 is abandoned and its memory is reclaimed
+    // without waiting for the GPU, but the submitted instance 2 still has to complete
+    CHECK(ring.reclaim(recording(3), 0) == 300);
+    CHECK(ring.getStatistics().bytesInFlight == 300);
+    CHECK(ring.getUsedBytes() == 300);
+
+    // An abandoned instance behind a pending one waits for its turn, the ring is reclaimed in order
+    CHECK(allocateAt(ring, 300, 1, recording(3), 600));
+    CHECK(ring.reclaim(recording(4), 0) == 0);
+    CHECK(ring.reclaim(recording(4), 2) == 600);
+    CHECK(ring.getStatistics().bytesInFlight == 0);
+    CHECK(ring.getUsedBytes() == 0);
+    CHECK(ring.getStatistics().peakBytesInFlight == 600);
+
+    // Abandoned memory is reused right away
+    CHECK(allocateAt(ring, 1000, 1, recording(4), 0));
+}
+
+int main()
+{
+    testAllocationAndCounters();
+    testWrapAroundAtTail();
+    testFullRing();
+    testNeverExecutedInstances();
+
+    return finishTests();
+}
@@ -73,6 +73,7 @@ bool CommandLineOptions::parse(int argc, char** argv)
 		("v,verbose", "Print commands before executing them", value(verbose))
 		("f,force", "Treat all source files as modified", value(force))
 		("k,keep", "Keep intermediate files", value(keep))
+		("indexed", "Write permutation blobs with a hashed permutation index (NVSI format)", value(indexed))
 		("c,compiler", "Path to the compiler executable (FXC or DXC)", value(compilerPath))
 		("I,include", "Include paths", value(includePaths))
 		("D,define", "Additional defines", value(additionalDefines))
@@ -46,6 +46,7 @@ struct CommandLineOptions
 	bool force = false;
 	bool help = false;
 	bool keep = false;
+	bool indexed = false;
 	int vulkanTextureShift = 0;
 	int vulkanSamplerShift = 128;
 	int vulkanConstantShift = 256;
@@ -480,6 +480,81 @@ bool WriteShaderBlob(const string& compiledShaderName, const vector<BlobEntry>&
 	return true;
 }
 
+bool WriteIndexedShaderBlob(const string& compiledShaderName, const vector<BlobEntry>& entries)
+{
+	fs::path outputFilePath = fs::path(g_Options.outputPath) / compiledShaderName;
+	string outputFileName = path_string(outputFilePath);
+
+	vector<vector<char>> binaries;
+	vector<nvrhi::ShaderBlobPermutation> permutations;
+	binaries.reserve(entries.size());
+	permutations.reserve(entries.size());
+
+	for (const BlobEntry& entry : entries)
+	{
+		string inputFileName = path_string(entry.compiledPermutationFile);
+
+		ifstream inputFile(inputFileName, ios::binary | ios::ate);
+		if (!inputFile.is_open())
+		{
+			cout << "ERROR: cannot read " << inputFileName << endl;
+			return false;
+		}
+
+		size_t fileSize = size_t(inputFile.tellg());
+		inputFile.seekg(0, ios::beg);
+
+		if (fileSize == 0)
+			continue;
+
+		if (fileSize > size_t(std::numeric_limits<uint32_t>::max()))
+		{
+			cout << "ERROR: binary shader file too big: " << inputFileName << endl;
+			continue;
+		}
+
+		vector<char> buffer(fileSize);
+		inputFile.read(buffer.data(), fileSize);
+		inputFile.close();
+
+		if (!g_Options.keep)
+		{
+			fs::remove(inputFileName);
+		}
+
+		binaries.push_back(std::move(buffer));
+
+		nvrhi::ShaderBlobPermutation permutation;
+		permutation.permutation = entry.permutation;
+		permutation.data = binaries.back().data();
+		permutation.size = binaries.back().size();
+		permutations.push_back(permutation);
+	}
+
+	vector<uint8_t> blob;
+	if (!nvrhi::buildIndexedShaderBlob(permutations.data(), permutations.size(), blob))
+	{
+		cout << "ERROR: cannot build the permutation index for " << outputFileName << endl;
+		return false;
+	}
+
+	if (g_Options.verbose)
+	{
+		cout << "INFO: writing " << outputFileName << " (" << permutations.size() << " permutations, indexed)" << endl;
+	}
+
+	ofstream outputFile(outputFileName, ios::binary);
+	if (!outputFile.is_open())
+	{
+		cout << "ERROR: cannot write " << outputFileName << endl;
+		return false;
+	}
+
+	outputFile.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+
+	return true;
+}
+
 void compileThreadProc()
 {
 	while (!g_Terminate)
@@ -646,7 +721,11 @@ int main(int argc, char** argv)
 
 	for (const pair<const string, vector<BlobEntry>>& it : g_ShaderBlobs)
 	{
-		if (!WriteShaderBlob(it.first, it.second))
+		bool written = g_Options.indexed
+			? WriteIndexedShaderBlob(it.first, it.second)
+			: WriteShaderBlob(it.first, it.second);
+
+		if (!written)
 			return 1;
 	}
 